@@ -0,0 +1,209 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONTROLLER_INTERFACE__ASYNC_CONTROLLER_HPP_
+#define CONTROLLER_INTERFACE__ASYNC_CONTROLLER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+
+#include "controller_interface/async_solver_pool.hpp"
+#include "controller_interface/controller_interface.hpp"
+
+namespace controller_interface
+{
+
+struct AsyncControllerOptions
+{
+  /// Age of an output, from the cycle its inputs were captured in, beyond which it is not applied
+  /// any more, the fallback is applied instead
+  std::chrono::nanoseconds max_output_age = std::chrono::milliseconds(10);
+  /// Pool running the solves, AsyncSolverPool::get_default() if null
+  std::shared_ptr<AsyncSolverPool> pool;
+};
+
+/**
+ * @brief The AsyncController class is the base of the controllers whose computation takes longer
+ * than a control cycle, e.g. a model predictive controller solving in a few milliseconds at 1 kHz
+ *
+ * update() runs in the real-time thread and never waits for a solve. When no solve is in flight,
+ * it captures the inputs of the next one with capture_inputs() and submits it to the pool, which
+ * runs solve() off the cycle. Once the solve is done, a later update() picks its output up and
+ * applies it with apply_output() on every cycle, until the next output is picked up. An output
+ * older than max_output_age, counted from the cycle its inputs were captured in, is not applied
+ * any more: apply_fallback() is, as before the first output, e.g. to hold the last command.
+ *
+ * The inputs and the outputs are kept in preallocated instances, which capture_inputs() and
+ * solve() overwrite, and the outputs are handed over with std::swap, so that update() does not
+ * allocate as long as swapping OutputT does not, as for the standard containers.
+ *
+ * @warning A derived class calls wait_for_solve() in its destructor, so that solve() is not
+ * called on a partly destroyed controller
+ */
+template<typename InputT, typename OutputT>
+class AsyncController : public ControllerInterface
+{
+public:
+  explicit AsyncController(const AsyncControllerOptions & options = AsyncControllerOptions())
+  : max_output_age_ns_(options.max_output_age.count()),
+    pool_(options.pool ? options.pool : AsyncSolverPool::get_default())
+  {
+  }
+
+  ~AsyncController() override
+  {
+    wait_for_solve();
+  }
+
+  /// Picks up the output of a finished solve, starts the next one, and applies the latest output
+  return_type update(const rclcpp::Time & time, const rclcpp::Duration & period) final
+  {
+    if (state_.load(std::memory_order_acquire) == SOLVED) {
+      if (solve_result_ == return_type::SUCCESS) {
+        std::swap(output_, solved_output_);
+        output_time_ = solving_time_;
+        has_output_ = true;
+        solve_count_.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        failed_solve_count_.fetch_add(1, std::memory_order_relaxed);
+      }
+      state_.store(IDLE, std::memory_order_relaxed);
+    }
+
+    if (state_.load(std::memory_order_relaxed) == IDLE &&
+      capture_inputs(time, input_) == return_type::SUCCESS)
+    {
+      solving_time_ = time;
+      state_.store(SOLVING, std::memory_order_release);
+      if (!pool_->try_submit(&AsyncController::run_solve, this)) {
+        // submitted again on the next cycle
+        state_.store(IDLE, std::memory_order_relaxed);
+      }
+    }
+
+    if (has_output_) {
+      const auto age = time - output_time_;
+      if (age.nanoseconds() <= max_output_age_ns_) {
+        return apply_output(output_, age, time, period);
+      }
+    }
+    fallback_count_.fetch_add(1, std::memory_order_relaxed);
+    return apply_fallback(time, period);
+  }
+
+  /// Number of outputs picked up
+  uint64_t get_solve_count() const
+  {
+    return solve_count_.load(std::memory_order_relaxed);
+  }
+
+  /// Number of solves which returned ERROR, or threw, their output was dropped
+  uint64_t get_failed_solve_count() const
+  {
+    return failed_solve_count_.load(std::memory_order_relaxed);
+  }
+
+  /// Number of updates which applied the fallback, without an output fresh enough
+  uint64_t get_fallback_count() const
+  {
+    return fallback_count_.load(std::memory_order_relaxed);
+  }
+
+  /// Blocks until no solve is queued nor running, not real-time safe
+  void wait_for_solve()
+  {
+    while (state_.load(std::memory_order_acquire) == SOLVING) {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+  }
+
+protected:
+  /**
+   * @brief capture_inputs Copies the inputs of the next solve, e.g. the joint states and the
+   * references, called by update() when no solve is in flight, real-time safe
+   * @param time Time of the cycle, the age of the output of the solve is counted from it
+   * @param input The inputs of the previous solve, overwritten without allocating
+   * @return ERROR to not start a solve in this cycle
+   */
+  virtual return_type capture_inputs(const rclcpp::Time & time, InputT & input) = 0;
+
+  /**
+   * @brief solve Computes an output from inputs, called in a thread of the pool, off the cycle
+   * @param output The output of an earlier solve, overwritten
+   * @return ERROR to drop the output
+   */
+  virtual return_type solve(const InputT & input, OutputT & output) = 0;
+
+  /**
+   * @brief apply_output Writes the commands from the latest output, called by update() on each
+   * cycle while the output is fresh enough, real-time safe
+   * @param age Time elapsed since the cycle the inputs of the output were captured in
+   */
+  virtual return_type apply_output(
+    const OutputT & output, const rclcpp::Duration & age, const rclcpp::Time & time,
+    const rclcpp::Duration & period) = 0;
+
+  /**
+   * @brief apply_fallback Writes the commands without an output fresh enough, before the first
+   * one or when the solves take longer than max_output_age, real-time safe
+   */
+  virtual return_type apply_fallback(const rclcpp::Time & time, const rclcpp::Duration & period)
+  = 0;
+
+private:
+  enum State : int
+  {
+    IDLE,
+    SOLVING,
+    SOLVED,
+  };
+
+  static void run_solve(void * context)
+  {
+    auto self = static_cast<AsyncController *>(context);
+    try {
+      self->solve_result_ = self->solve(self->input_, self->solved_output_);
+    } catch (...) {
+      self->solve_result_ = return_type::ERROR;
+    }
+    self->state_.store(SOLVED, std::memory_order_release);
+  }
+
+  const int64_t max_output_age_ns_;
+  std::shared_ptr<AsyncSolverPool> pool_;
+
+  /// Owned by the pool while SOLVING, by update() otherwise
+  std::atomic<int> state_{IDLE};
+  InputT input_;
+  OutputT solved_output_;
+  return_type solve_result_ = return_type::SUCCESS;
+  rclcpp::Time solving_time_;
+
+  // only used by update()
+  OutputT output_;
+  rclcpp::Time output_time_;
+  bool has_output_ = false;
+
+  std::atomic<uint64_t> solve_count_{0};
+  std::atomic<uint64_t> failed_solve_count_{0};
+  std::atomic<uint64_t> fallback_count_{0};
+};
+
+}  // namespace controller_interface
+
+#endif  // CONTROLLER_INTERFACE__ASYNC_CONTROLLER_HPP_
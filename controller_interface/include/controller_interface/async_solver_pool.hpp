@@ -0,0 +1,95 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONTROLLER_INTERFACE__ASYNC_SOLVER_POOL_HPP_
+#define CONTROLLER_INTERFACE__ASYNC_SOLVER_POOL_HPP_
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "controller_interface/visibility_control.h"
+
+namespace controller_interface
+{
+
+/**
+ * @brief The AsyncSolverPool class runs the long computations of controllers, e.g. the solves of
+ * a model predictive controller, on threads out of the control cycle, see AsyncController
+ *
+ * The tasks are queued in a ring of fixed capacity, and run in the order they are submitted by
+ * the first idle thread. Submitting is real-time safe: it never waits for the queue nor
+ * allocates, and fails instead when the queue is full or busy.
+ */
+class AsyncSolverPool
+{
+public:
+  using Task = void (*)(void * context);
+
+  /**
+   * @param thread_count Number of threads running the tasks, at least one
+   * @param capacity Number of tasks queued at most
+   * @param priority SCHED_FIFO priority of the threads, 0 to keep the default scheduling
+   */
+  CONTROLLER_INTERFACE_PUBLIC
+  explicit AsyncSolverPool(size_t thread_count = 1, size_t capacity = 64, int priority = 0);
+
+  /// Runs the tasks still queued, then joins the threads
+  CONTROLLER_INTERFACE_PUBLIC
+  ~AsyncSolverPool();
+
+  AsyncSolverPool(const AsyncSolverPool &) = delete;
+  AsyncSolverPool & operator=(const AsyncSolverPool &) = delete;
+
+  /// Pool shared by the controllers not given one, with a single thread, created on first use
+  CONTROLLER_INTERFACE_PUBLIC
+  static std::shared_ptr<AsyncSolverPool> get_default();
+
+  CONTROLLER_INTERFACE_PUBLIC
+  size_t get_thread_count() const;
+
+  /**
+   * @brief try_submit Queues task(context) to be run by a thread of the pool, real-time safe
+   * @return false if the queue is full, or locked by another thread in that instant, the task is
+   * then not queued
+   */
+  CONTROLLER_INTERFACE_PUBLIC
+  bool try_submit(Task task, void * context);
+
+private:
+  struct QueuedTask
+  {
+    Task task;
+    void * context;
+  };
+
+  void worker_loop();
+
+  std::mutex mutex_;
+  std::condition_variable queued_cv_;
+  /// Ring of queued tasks, protected by mutex_
+  std::vector<QueuedTask> queue_;
+  size_t head_ = 0;
+  size_t size_ = 0;
+  bool stop_ = false;
+
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace controller_interface
+
+#endif  // CONTROLLER_INTERFACE__ASYNC_SOLVER_POOL_HPP_
@@ -0,0 +1,166 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONTROLLER_INTERFACE__BATCH_PID_HPP_
+#define CONTROLLER_INTERFACE__BATCH_PID_HPP_
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "controller_interface/controller_interface.hpp"
+#include "controller_interface/visibility_control.h"
+
+#include "hardware_interface/span.hpp"
+
+namespace controller_interface
+{
+
+/// The gains and the limits of the PID loop of one joint
+struct PidGains
+{
+  double p = 0.0;
+  double i = 0.0;
+  double d = 0.0;
+  /// Bounds of the integral term, the integral is clamped to them
+  double i_min = -std::numeric_limits<double>::infinity();
+  double i_max = std::numeric_limits<double>::infinity();
+  /// Gain of the feed-forward value added to the output
+  double feed_forward = 0.0;
+  /// Time constant of the low-pass filter of the derivative, in seconds, 0 for no filter
+  double derivative_time_constant = 0.0;
+  double output_min = -std::numeric_limits<double>::infinity();
+  double output_max = std::numeric_limits<double>::infinity();
+};
+
+/**
+ * @brief The BatchPid class runs the PID loops of many joints in a single pass
+ *
+ * For each joint, the output is p * e + integral + d * filtered de/dt + feed_forward * ff,
+ * saturated to the output bounds, where e is the setpoint minus the measurement. The integral
+ * accumulates i * e * dt, clamped to its bounds, and stops accumulating while the output saturates
+ * in the direction it would grow, the anti-windup. The derivative of the error is filtered by a
+ * first-order low-pass filter of its time constant.
+ *
+ * The gains and the state of the joints are stored as structure of arrays, and update() computes
+ * all the outputs in one plain loop over setpoints, measurements and outputs given as arrays, e.g.
+ * the values of InterfaceValueGroup copied with RobotHardware::get_joint_values(). The loop has
+ * selects instead of branches, so that the compiler can vectorize it and process several joints
+ * per instruction.
+ *
+ * The gains may be scheduled, interpolated per joint from a table of gains along a scheduling
+ * variable, e.g. the position of the joint, see set_gain_schedule().
+ *
+ * The joints and the schedules are set up in a non real-time context. set_gains(),
+ * schedule_gains(), update() and reset() are real-time safe.
+ */
+class BatchPid
+{
+public:
+  /**
+   * @param joint_count The number of joints, the size of all the arrays
+   * @param gains The gains of all the joints
+   */
+  CONTROLLER_INTERFACE_PUBLIC
+  explicit BatchPid(size_t joint_count = 0, const PidGains & gains = PidGains());
+
+  CONTROLLER_INTERFACE_PUBLIC
+  size_t size() const;
+
+  /// Set the gains of one joint, kept until the next call or the next schedule_gains()
+  CONTROLLER_INTERFACE_PUBLIC
+  void set_gains(size_t joint, const PidGains & gains);
+
+  CONTROLLER_INTERFACE_PUBLIC
+  PidGains get_gains(size_t joint) const;
+
+  /**
+   * @brief set_gain_schedule Sets the gains of one joint along its scheduling variable
+   * The gains are interpolated linearly between the breakpoints, and the first or the last gains
+   * are taken outside of them.
+   * @param joint The index of the joint
+   * @param breakpoints The values of the scheduling variable, strictly increasing
+   * @param gains The gains at each breakpoint, each bound either finite in all of them or the
+   * same infinity in all of them
+   * @throws std::invalid_argument if the schedule is empty or inconsistent
+   */
+  CONTROLLER_INTERFACE_PUBLIC
+  void set_gain_schedule(
+    size_t joint, const std::vector<double> & breakpoints, const std::vector<PidGains> & gains);
+
+  /**
+   * @brief schedule_gains Interpolates the gains of the joints with a schedule
+   * @param scheduling_values The scheduling variable of each joint, ignored for the joints
+   * without schedule
+   * @return ERROR if there are not as many values as joints
+   */
+  CONTROLLER_INTERFACE_PUBLIC
+  return_type schedule_gains(hardware_interface::Span<const double> scheduling_values);
+
+  /**
+   * @brief update Computes the outputs of all the joints for one control period
+   * @param setpoints The setpoint of each joint
+   * @param measurements The measurement of each joint
+   * @param feed_forwards The feed-forward value of each joint, or empty for none
+   * @param dt The control period, in seconds
+   * @param outputs The outputs of the joints
+   * @return ERROR, with the outputs and the state unchanged, if the period is not positive or an
+   * array does not have as many values as joints
+   */
+  CONTROLLER_INTERFACE_PUBLIC
+  return_type update(
+    hardware_interface::Span<const double> setpoints,
+    hardware_interface::Span<const double> measurements,
+    hardware_interface::Span<const double> feed_forwards,
+    double dt,
+    hardware_interface::Span<double> outputs);
+
+  /// Clear the integrals and the derivatives, e.g. when the controller is started
+  CONTROLLER_INTERFACE_PUBLIC
+  void reset();
+
+  CONTROLLER_INTERFACE_PUBLIC
+  double get_integral(size_t joint) const;
+
+private:
+  struct GainSchedule
+  {
+    std::vector<double> breakpoints;
+    std::vector<PidGains> gains;
+  };
+
+  // gains
+  std::vector<double> p_;
+  std::vector<double> i_;
+  std::vector<double> d_;
+  std::vector<double> i_min_;
+  std::vector<double> i_max_;
+  std::vector<double> feed_forward_;
+  std::vector<double> derivative_time_constant_;
+  std::vector<double> output_min_;
+  std::vector<double> output_max_;
+  // state, the flags are as wide as the values to use the same vector lanes
+  std::vector<double> integral_;
+  std::vector<double> previous_error_;
+  std::vector<double> derivative_;
+  std::vector<double> has_previous_error_;
+  /// Feed-forward values of the updates without any
+  std::vector<double> zeros_;
+  /// Empty for the joints without schedule
+  std::vector<GainSchedule> schedules_;
+};
+
+}  // namespace controller_interface
+
+#endif  // CONTROLLER_INTERFACE__BATCH_PID_HPP_
@@ -15,9 +15,14 @@
 #ifndef CONTROLLER_INTERFACE__CONTROLLER_INTERFACE_HPP_
 #define CONTROLLER_INTERFACE__CONTROLLER_INTERFACE_HPP_
 
+#include <atomic>
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "controller_interface/parameter_snapshot.hpp"
+#include "controller_interface/realtime_publisher.hpp"
 #include "controller_interface/visibility_control.h"
 
 #include "hardware_interface/robot_hardware.hpp"
@@ -40,9 +45,10 @@ public:
   CONTROLLER_INTERFACE_PUBLIC
   ControllerInterface() = default;
 
+  /// Unregisters the reference interfaces, if they are still exported
   CONTROLLER_INTERFACE_PUBLIC
   virtual
-  ~ControllerInterface() = default;
+  ~ControllerInterface();
 
   CONTROLLER_INTERFACE_PUBLIC
   virtual
@@ -51,18 +57,206 @@ public:
     std::weak_ptr<hardware_interface::RobotHardware> robot_hardware,
     const std::string & controller_name);
 
+  /**
+   * @brief update Updates the controller, without the time of the cycle
+   * Kept for the controllers which query their clock themselves, the other ones override
+   * update(time, period) instead. Fails by default.
+   */
   CONTROLLER_INTERFACE_PUBLIC
   virtual
   return_type
-  update() = 0;
+  update();
+
+  /**
+   * @brief update Updates the controller with the time sampled once per control cycle
+   * All the controllers updated in the same cycle are given the same time, and the period
+   * matches the one expected by the enforceLimits() of the joint limits handles. Calls update()
+   * by default.
+   * @param time Time at the start of the control cycle
+   * @param period Time elapsed since the previous update of this controller
+   */
+  CONTROLLER_INTERFACE_PUBLIC
+  virtual
+  return_type
+  update(const rclcpp::Time & time, const rclcpp::Duration & period);
+
+  /**
+   * @brief update_standby Shadow update of the controller in standby, active but not running
+   * Keeps the state of the controller, e.g. its filters and the time of its last update, in step
+   * with the robot so that it can be promoted within a cycle. Must not write any command
+   * interface nor reference, which belong to the running controllers. Does nothing by default.
+   */
+  CONTROLLER_INTERFACE_PUBLIC
+  virtual
+  return_type
+  update_standby(const rclcpp::Time & time, const rclcpp::Duration & period);
+
+  /**
+   * @brief warm_up Dry-run update of the controller, called in the thread activating it, once
+   * active and before the real-time thread first updates it
+   * Runs the code of update() on its buffers, e.g. against copies of its command interfaces, so
+   * that its caches are filled, its buffers paged in and its symbols bound by the time of its
+   * first update. Must not write any command interface nor reference, which belong to the running
+   * controllers, and must leave the state of the controller as its first update expects it.
+   * Called as configured by the <controller_name>.warm_up_updates parameter of the controller
+   * manager, and calls update_standby() by default.
+   */
+  CONTROLLER_INTERFACE_PUBLIC
+  virtual
+  return_type
+  warm_up(const rclcpp::Time & time, const rclcpp::Duration & period);
+
+  /**
+   * @brief on_takeover Called in the real-time thread in the cycle the controller is promoted
+   * from standby to running, before its first update, real-time safe
+   * The command interfaces still hold the last commands of the controllers stopped by the same
+   * switch, for the controller to start from them rather than jump. Does nothing by default.
+   */
+  CONTROLLER_INTERFACE_PUBLIC
+  virtual
+  void
+  on_takeover();
 
   CONTROLLER_INTERFACE_PUBLIC
   std::shared_ptr<rclcpp_lifecycle::LifecycleNode>
   get_lifecycle_node();
 
+  /**
+   * @brief get_claimed_resources Resources written by the controller in update(), grouped by the
+   * interface they belong to, e.g. {"position_command": {"joint1", "joint2"}}
+   * Called once the controller is configured. Controllers which do not claim any resource
+   * are considered to use all of them, and are never updated in parallel with other controllers.
+   */
+  CONTROLLER_INTERFACE_PUBLIC
+  virtual
+  std::map<std::string, std::vector<std::string>>
+  get_claimed_resources() const;
+
+  /**
+   * @brief get_read_state_interfaces State interfaces read by the controller in update(), grouped
+   * as the claimed resources, e.g. {"position": {"joint1", "joint2"}}
+   * Called once the controller is configured. The hardware may skip reading the states no active
+   * controller reads, the controllers which do not declare them are considered to read all of
+   * them.
+   */
+  CONTROLLER_INTERFACE_PUBLIC
+  virtual
+  std::map<std::string, std::vector<std::string>>
+  get_read_state_interfaces() const;
+
+  /**
+   * @brief is_deterministic Whether update() computes the same commands from the same read state
+   * interfaces and reference interfaces, and depends on nothing else but what request_update()
+   * signals, e.g. a hold controller
+   * Called once the controller is configured. The controller manager then skips the updates of
+   * the running controller in which none of these interfaces changed since its last update, its
+   * commands keeping the values it last wrote. Only the controllers declaring their read state
+   * interfaces are skipped, and they are always updated once after being started. False by
+   * default.
+   */
+  CONTROLLER_INTERFACE_PUBLIC
+  virtual
+  bool
+  is_deterministic() const;
+
+  /// Whether request_update() was called since the previous call, which clears the request,
+  /// real-time safe
+  CONTROLLER_INTERFACE_PUBLIC
+  bool take_update_request();
+
+  /**
+   * @brief get_reference_interfaces Interfaces, grouped as the claimed resources, which other
+   * controllers write for this one to read them in the same control cycle, e.g. the position
+   * references of a trajectory controller written by an admittance controller
+   * Called once the controller is configured. The references are exported to the robot hardware
+   * as "<controller name>/<name>" and claimed under this name by the controllers writing them,
+   * which the controller manager then updates before this one. None by default.
+   */
+  CONTROLLER_INTERFACE_PUBLIC
+  virtual
+  std::map<std::string, std::vector<std::string>>
+  get_reference_interfaces() const;
+
+  /**
+   * @brief export_reference_interfaces Allocates the values of the reference interfaces, set to
+   * NaN until written, and registers them in the robot hardware
+   * Called by the controller manager once the controller is configured, in a non real-time thread.
+   * @return ERROR if the robot hardware is gone or a reference could not be registered, none is
+   * exported then
+   */
+  CONTROLLER_INTERFACE_PUBLIC
+  return_type export_reference_interfaces();
+
+  /// Unregisters the reference interfaces, the controllers writing them must be unloaded before
+  CONTROLLER_INTERFACE_PUBLIC
+  void unexport_reference_interfaces();
+
+  /// The exported reference interfaces, grouped by interface, with their full names
+  CONTROLLER_INTERFACE_PUBLIC
+  const std::map<std::string, std::vector<std::string>> &
+  get_exported_reference_interfaces() const;
+
 protected:
+  /**
+   * @brief request_update Has the next update of a deterministic controller run even if its
+   * interfaces did not change, e.g. when a new goal or new parameters are received
+   * Thread-safe and real-time safe.
+   */
+  CONTROLLER_INTERFACE_PUBLIC
+  void request_update();
+
+  /**
+   * @brief get_reference_value The storage of an exported reference interface, to be resolved
+   * once and then read in update()
+   * @param name The name of the reference without the controller name, as returned by
+   * get_reference_interfaces()
+   * @return null if it is not exported
+   */
+  CONTROLLER_INTERFACE_PUBLIC
+  const double *
+  get_reference_value(const std::string & interface_name, const std::string & name) const;
+
+  /**
+   * @brief make_parameter_snapshot Creates a struct mirroring parameters of the controller node,
+   * to be read in update() without locking nor allocating, see ParameterSnapshot
+   * Called once initialized, e.g. in on_configure(), the fields are then bound to parameters
+   * with ParameterSnapshot::declare_parameter().
+   * @param defaults Initial values of the struct
+   */
+  template<typename ParamsT>
+  std::shared_ptr<ParameterSnapshot<ParamsT>>
+  make_parameter_snapshot(const ParamsT & defaults = ParamsT())
+  {
+    return std::make_shared<ParameterSnapshot<ParamsT>>(lifecycle_node_, defaults);
+  }
+
+  /**
+   * @brief make_realtime_publisher Creates a publisher on the controller node, through which
+   * update() publishes without serializing nor allocating, see RealtimePublisher
+   * Called once initialized, e.g. in on_configure(). The publisher is not a lifecycle publisher,
+   * it does not need to be activated.
+   * @param prototype Initial value of the message, with its arrays sized as they are published
+   */
+  template<typename MessageT>
+  std::shared_ptr<RealtimePublisher<MessageT>>
+  make_realtime_publisher(
+    const std::string & topic_name, const rclcpp::QoS & qos,
+    const MessageT & prototype = MessageT())
+  {
+    return std::make_shared<RealtimePublisher<MessageT>>(
+      rclcpp::create_publisher<MessageT>(*lifecycle_node_, topic_name, qos), prototype);
+  }
+
   std::weak_ptr<hardware_interface::RobotHardware> robot_hardware_;
   std::shared_ptr<rclcpp_lifecycle::LifecycleNode> lifecycle_node_;
+
+private:
+  /// Full names of the exported references, by interface
+  std::map<std::string, std::vector<std::string>> exported_references_;
+  /// Values of the exported references, in the order of exported_references_, never reallocated
+  /// while they are exported
+  std::vector<double> reference_values_;
+  std::atomic<bool> update_requested_{false};
 };
 
 using ControllerInterfaceSharedPtr = std::shared_ptr<ControllerInterface>;
@@ -0,0 +1,189 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONTROLLER_INTERFACE__PARAMETER_SNAPSHOT_HPP_
+#define CONTROLLER_INTERFACE__PARAMETER_SNAPSHOT_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp_lifecycle/lifecycle_node.hpp"
+
+namespace controller_interface
+{
+
+/**
+ * @brief The ParameterSnapshot class mirrors parameters of a controller node in a typed struct,
+ * which update() reads without locking nor allocating
+ *
+ * Each field of the struct is bound to a parameter with declare_parameter(). When parameters are
+ * set, the parameter callback, in a non real-time thread, applies them to a copy of the latest
+ * struct and publishes it at once, so update() never sees a partially applied change.
+ *
+ * The structs are kept in three preallocated slots, handed over with an atomic exchange of the
+ * slot indices: the writer fills its own slot and swaps it with the published one, the reader
+ * swaps the published slot with its own when it is newer. Neither side ever waits for the other.
+ *
+ * @tparam ParamsT A default constructible and copyable struct, only copied by the writer
+ */
+template<typename ParamsT>
+class ParameterSnapshot
+{
+public:
+  /**
+   * @param node The node the parameters are declared on
+   * @param defaults Initial values of the struct, also the default values of the parameters
+   */
+  explicit ParameterSnapshot(
+    const std::shared_ptr<rclcpp_lifecycle::LifecycleNode> & node,
+    const ParamsT & defaults = ParamsT())
+  : node_(node), published_(defaults)
+  {
+    for (auto & slot : slots_) {
+      slot = defaults;
+    }
+    callback_handle_ = node_->add_on_set_parameters_callback(
+      std::bind(&ParameterSnapshot::on_set_parameters, this, std::placeholders::_1));
+  }
+
+  ParameterSnapshot(const ParameterSnapshot &) = delete;
+  ParameterSnapshot & operator=(const ParameterSnapshot &) = delete;
+
+  /**
+   * @brief declare_parameter Declares a parameter mirrored in a field of the struct, its default
+   * value is the current value of the field
+   * Called in a non real-time thread, e.g. in on_configure().
+   * @return The value of the parameter, which may have been overridden when the node was created
+   */
+  template<typename FieldT>
+  FieldT declare_parameter(const std::string & name, FieldT ParamsT::* field)
+  {
+    FieldT default_value;
+    {
+      std::lock_guard<std::mutex> guard(writer_mutex_);
+      setters_[name] = [field](const rclcpp::Parameter & parameter, ParamsT & params) {
+          params.*field = parameter.get_value<FieldT>();
+        };
+      default_value = published_.*field;
+    }
+    const auto value = node_->declare_parameter<FieldT>(name, default_value);
+    update([field, &value](ParamsT & params) {params.*field = value;});
+    return value;
+  }
+
+  /**
+   * @brief get The latest published struct
+   * Real-time safe and wait-free. The reference stays valid, and the struct unchanged, until the
+   * next call.
+   * @warning Should only be called from one thread at a time, the one updating the controller
+   */
+  const ParamsT & get()
+  {
+    if (middle_.load(std::memory_order_acquire) & kFresh) {
+      front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+    }
+    return slots_[front_];
+  }
+
+  /// A copy of the latest published struct, for non real-time threads
+  ParamsT get_published() const
+  {
+    std::lock_guard<std::mutex> guard(writer_mutex_);
+    return published_;
+  }
+
+  /**
+   * @brief update Modifies a copy of the latest published struct and publishes it
+   * Called in a non real-time thread, the parameters are not changed.
+   * @param modify Called with the copy to modify
+   */
+  template<typename F>
+  void update(F && modify)
+  {
+    std::lock_guard<std::mutex> guard(writer_mutex_);
+    ParamsT params = published_;
+    modify(params);
+    publish(params);
+  }
+
+private:
+  static constexpr uint8_t kFresh = 0x4;
+  static constexpr uint8_t kIndexMask = 0x3;
+
+  /// Called with writer_mutex_ held
+  void publish(const ParamsT & params)
+  {
+    published_ = params;
+    slots_[back_] = params;
+    back_ = middle_.exchange(static_cast<uint8_t>(back_ | kFresh), std::memory_order_acq_rel) &
+      kIndexMask;
+  }
+
+  rcl_interfaces::msg::SetParametersResult
+  on_set_parameters(const std::vector<rclcpp::Parameter> & parameters)
+  {
+    rcl_interfaces::msg::SetParametersResult result;
+    result.successful = true;
+    std::lock_guard<std::mutex> guard(writer_mutex_);
+    ParamsT params = published_;
+    bool changed = false;
+    for (const auto & parameter : parameters) {
+      const auto setter = setters_.find(parameter.get_name());
+      if (setter == setters_.end()) {
+        continue;
+      }
+      try {
+        setter->second(parameter, params);
+      } catch (const rclcpp::ParameterTypeException & e) {
+        result.successful = false;
+        result.reason = "parameter '" + parameter.get_name() + "': " + e.what();
+        return result;
+      }
+      changed = true;
+    }
+    if (changed) {
+      publish(params);
+    }
+    return result;
+  }
+
+  std::shared_ptr<rclcpp_lifecycle::LifecycleNode> node_;
+
+  /// Protects the writer side, latest published struct and setters included
+  mutable std::mutex writer_mutex_;
+  ParamsT published_;
+  std::map<std::string, std::function<void(const rclcpp::Parameter &, ParamsT &)>> setters_;
+
+  ParamsT slots_[3];
+  /// Slot written by the writer, protected by writer_mutex_
+  uint8_t back_ = 0;
+  /// Slot last published, with kFresh set until the reader takes it
+  std::atomic<uint8_t> middle_{1};
+  /// Slot read by the reader, only used by the reader
+  uint8_t front_ = 2;
+
+  /// Removes the parameter callback once destroyed, so destroyed first
+  rclcpp::node_interfaces::OnSetParametersCallbackHandle::SharedPtr callback_handle_;
+};
+
+}  // namespace controller_interface
+
+#endif  // CONTROLLER_INTERFACE__PARAMETER_SNAPSHOT_HPP_
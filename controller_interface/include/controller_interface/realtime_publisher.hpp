@@ -0,0 +1,204 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONTROLLER_INTERFACE__REALTIME_PUBLISHER_HPP_
+#define CONTROLLER_INTERFACE__REALTIME_PUBLISHER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace controller_interface
+{
+
+/**
+ * @brief The RealtimePublisher class publishes messages filled in update() from a background
+ * thread, so that the real-time thread neither serializes nor allocates them
+ *
+ * The real-time thread fills a preallocated message, taken with try_lock() and handed over with
+ * unlock_and_publish(). The publishing thread polls for a handed over message, copies it, into a
+ * message loaned by the middleware when it supports it, and publishes it.
+ * The message is handed over with atomic state changes only: the real-time thread never waits,
+ * try_lock() fails while the publishing thread copies the message. A message handed over but not
+ * yet taken by the publishing thread is replaced by the next one, and counted as dropped.
+ */
+template<typename MessageT>
+class RealtimePublisher
+{
+public:
+  using PublisherSharedPtr = typename rclcpp::Publisher<MessageT>::SharedPtr;
+
+  /**
+   * @param publisher The publisher used by the publishing thread
+   * @param prototype Initial value of the message, with its arrays sized as they are published,
+   * so that filling the message does not allocate
+   * @param poll_period Period at which the publishing thread checks for a handed over message
+   */
+  explicit RealtimePublisher(
+    PublisherSharedPtr publisher,
+    const MessageT & prototype = MessageT(),
+    std::chrono::nanoseconds poll_period = std::chrono::microseconds(500))
+  : publisher_(std::move(publisher)), message_(prototype), outgoing_(prototype),
+    poll_period_(poll_period)
+  {
+    publishing_thread_ = std::thread(&RealtimePublisher::publishing_loop, this);
+  }
+
+  /// Stops the publishing thread, a message handed over but not yet published is dropped
+  ~RealtimePublisher()
+  {
+    {
+      std::lock_guard<std::mutex> guard(stop_mutex_);
+      stop_ = true;
+    }
+    stop_cv_.notify_all();
+    publishing_thread_.join();
+  }
+
+  RealtimePublisher(const RealtimePublisher &) = delete;
+  RealtimePublisher & operator=(const RealtimePublisher &) = delete;
+
+  /**
+   * @brief try_lock Takes the message to fill it, real-time safe
+   * @return The message, to be handed over with unlock_and_publish(), or null if the publishing
+   * thread is copying it
+   */
+  MessageT * try_lock()
+  {
+    auto state = State::PENDING;
+    if (state_.compare_exchange_strong(state, State::FILLING, std::memory_order_acquire)) {
+      // the previous message was not published yet
+      dropped_count_.fetch_add(1, std::memory_order_relaxed);
+      return &message_;
+    }
+    if (state == State::IDLE &&
+      state_.compare_exchange_strong(state, State::FILLING, std::memory_order_acquire))
+    {
+      return &message_;
+    }
+    dropped_count_.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  /// Hands the message taken with try_lock() over to the publishing thread, real-time safe
+  void unlock_and_publish()
+  {
+    state_.store(State::PENDING, std::memory_order_release);
+  }
+
+  /**
+   * @brief try_publish Copies a message and hands it over to the publishing thread, real-time safe
+   * as long as copying the message does not allocate
+   * @return false if the message was dropped, the publishing thread was copying the previous one
+   */
+  bool try_publish(const MessageT & message)
+  {
+    auto locked_message = try_lock();
+    if (!locked_message) {
+      return false;
+    }
+    *locked_message = message;
+    unlock_and_publish();
+    return true;
+  }
+
+  /// Number of messages published by the publishing thread
+  uint64_t get_published_count() const
+  {
+    return published_count_.load(std::memory_order_relaxed);
+  }
+
+  /// Number of messages which could not be handed over, or were replaced before being published
+  uint64_t get_dropped_count() const
+  {
+    return dropped_count_.load(std::memory_order_relaxed);
+  }
+
+  PublisherSharedPtr get_publisher() const
+  {
+    return publisher_;
+  }
+
+private:
+  enum class State : uint8_t
+  {
+    /// Free to be filled by the real-time thread
+    IDLE,
+    /// Being filled by the real-time thread
+    FILLING,
+    /// Handed over, waiting for the publishing thread
+    PENDING,
+    /// Being copied by the publishing thread
+    COPYING,
+  };
+
+  /// Publishes the message if one was handed over, only called from the publishing thread
+  bool publish_pending()
+  {
+    auto state = State::PENDING;
+    if (!state_.compare_exchange_strong(state, State::COPYING, std::memory_order_acquire)) {
+      return false;
+    }
+    if (publisher_->can_loan_messages()) {
+      auto loaned_message = publisher_->borrow_loaned_message();
+      loaned_message.get() = message_;
+      state_.store(State::IDLE, std::memory_order_release);
+      publisher_->publish(std::move(loaned_message));
+    } else {
+      outgoing_ = message_;
+      state_.store(State::IDLE, std::memory_order_release);
+      publisher_->publish(outgoing_);
+    }
+    published_count_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  void publishing_loop()
+  {
+    std::unique_lock<std::mutex> lock(stop_mutex_);
+    while (!stop_) {
+      lock.unlock();
+      publish_pending();
+      lock.lock();
+      // never notified by the real-time thread, which would have to take the mutex
+      stop_cv_.wait_for(lock, poll_period_, [this] {return stop_;});
+    }
+  }
+
+  PublisherSharedPtr publisher_;
+  std::atomic<State> state_{State::IDLE};
+  /// Filled by the real-time thread, copied by the publishing thread, as told by state_
+  MessageT message_;
+  /// Copy of the message published when the middleware does not loan messages
+  MessageT outgoing_;
+  std::atomic<uint64_t> published_count_{0};
+  std::atomic<uint64_t> dropped_count_{0};
+
+  const std::chrono::nanoseconds poll_period_;
+  std::mutex stop_mutex_;
+  std::condition_variable stop_cv_;
+  bool stop_ = false;
+  std::thread publishing_thread_;
+};
+
+}  // namespace controller_interface
+
+#endif  // CONTROLLER_INTERFACE__REALTIME_PUBLISHER_HPP_
@@ -0,0 +1,116 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "controller_interface/async_solver_pool.hpp"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace controller_interface
+{
+
+static constexpr const char * kLoggerName = "async_solver_pool";
+
+AsyncSolverPool::AsyncSolverPool(size_t thread_count, size_t capacity, int priority)
+: queue_(std::max<size_t>(capacity, 1))
+{
+  thread_count = std::max<size_t>(thread_count, 1);
+  threads_.reserve(thread_count);
+  for (size_t i = 0; i < thread_count; ++i) {
+    threads_.emplace_back(&AsyncSolverPool::worker_loop, this);
+    if (priority <= 0) {
+      continue;
+    }
+#ifdef __linux__
+    sched_param param;
+    param.sched_priority = priority;
+    if (pthread_setschedparam(threads_.back().native_handle(), SCHED_FIFO, &param) != 0) {
+      RCLCPP_WARN(
+        rclcpp::get_logger(kLoggerName),
+        "Could not set the priority of the async solver threads to %d", priority);
+    }
+#else
+    RCLCPP_WARN(
+      rclcpp::get_logger(kLoggerName),
+      "Setting the priority of the async solver threads is not supported on this platform");
+#endif
+  }
+}
+
+AsyncSolverPool::~AsyncSolverPool()
+{
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stop_ = true;
+  }
+  queued_cv_.notify_all();
+  for (auto & thread : threads_) {
+    thread.join();
+  }
+}
+
+std::shared_ptr<AsyncSolverPool> AsyncSolverPool::get_default()
+{
+  static const auto pool = std::make_shared<AsyncSolverPool>();
+  return pool;
+}
+
+size_t AsyncSolverPool::get_thread_count() const
+{
+  return threads_.size();
+}
+
+bool AsyncSolverPool::try_submit(Task task, void * context)
+{
+  {
+    std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+    if (!lock.owns_lock() || size_ == queue_.size()) {
+      return false;
+    }
+    queue_[(head_ + size_) % queue_.size()] = {task, context};
+    ++size_;
+  }
+  queued_cv_.notify_one();
+  return true;
+}
+
+void AsyncSolverPool::worker_loop()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    queued_cv_.wait(lock, [this] {return stop_ || size_ > 0;});
+    if (size_ == 0) {
+      return;
+    }
+    const auto queued = queue_[head_];
+    head_ = (head_ + 1) % queue_.size();
+    --size_;
+    lock.unlock();
+
+    queued.task(queued.context);
+
+    lock.lock();
+  }
+}
+
+}  // namespace controller_interface
@@ -0,0 +1,244 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "controller_interface/batch_pid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using hardware_interface::Span;
+
+namespace
+{
+/// Interpolate exactly the values which are the same at both ends, infinite bounds included
+double interpolate(double a, double b, double t)
+{
+  return a == b ? a : a + t * (b - a);
+}
+
+controller_interface::PidGains interpolate(
+  const controller_interface::PidGains & a, const controller_interface::PidGains & b, double t)
+{
+  controller_interface::PidGains gains;
+  gains.p = interpolate(a.p, b.p, t);
+  gains.i = interpolate(a.i, b.i, t);
+  gains.d = interpolate(a.d, b.d, t);
+  gains.i_min = interpolate(a.i_min, b.i_min, t);
+  gains.i_max = interpolate(a.i_max, b.i_max, t);
+  gains.feed_forward = interpolate(a.feed_forward, b.feed_forward, t);
+  gains.derivative_time_constant =
+    interpolate(a.derivative_time_constant, b.derivative_time_constant, t);
+  gains.output_min = interpolate(a.output_min, b.output_min, t);
+  gains.output_max = interpolate(a.output_max, b.output_max, t);
+  return gains;
+}
+
+/// Whether a bound is finite in all the gains, or the same in all of them
+bool is_interpolable(
+  const std::vector<controller_interface::PidGains> & gains,
+  double controller_interface::PidGains::* bound)
+{
+  const auto first = gains.front().*bound;
+  return std::all_of(
+    gains.begin(), gains.end(), [&](const controller_interface::PidGains & g) {
+      return std::isfinite(g.*bound) ? std::isfinite(first) : g.*bound == first;
+    });
+}
+
+/// The loop of BatchPid::update(), the arrays are distinct so that it is vectorized without
+/// run-time alias checks. There are no branches, the selects and the non short-circuit operators
+/// keep the loop vectorizable.
+void update_joints(
+  size_t n, const double * __restrict setpoint, const double * __restrict measurement,
+  const double * __restrict ff, double dt, const double * __restrict p,
+  const double * __restrict i, const double * __restrict d, const double * __restrict i_min,
+  const double * __restrict i_max, const double * __restrict feed_forward,
+  const double * __restrict derivative_time_constant, const double * __restrict output_min,
+  const double * __restrict output_max, double * __restrict integral,
+  double * __restrict previous_error, double * __restrict derivative,
+  double * __restrict has_previous_error, double * __restrict output)
+{
+  const double inv_dt = 1.0 / dt;
+  for (size_t j = 0; j < n; ++j) {
+    const double error = setpoint[j] - measurement[j];
+
+    // low-pass filtered derivative, zero until there is a previous error
+    const double raw_derivative = has_previous_error[j] * (error - previous_error[j]) * inv_dt;
+    const double alpha = dt / (derivative_time_constant[j] + dt);
+    const double next_derivative = derivative[j] + alpha * (raw_derivative - derivative[j]);
+
+    const double next_integral =
+      std::min(std::max(integral[j] + i[j] * error * dt, i_min[j]), i_max[j]);
+    const double unsaturated =
+      p[j] * error + next_integral + d[j] * next_derivative + feed_forward[j] * ff[j];
+
+    // anti-windup: the integral does not grow while the output saturates in its direction
+    const double growth = i[j] * error;
+    const bool winding_up = ((unsaturated > output_max[j]) & (growth > 0.0)) |
+      ((unsaturated < output_min[j]) & (growth < 0.0));
+    integral[j] = winding_up ? integral[j] : next_integral;
+
+    derivative[j] = next_derivative;
+    previous_error[j] = error;
+    has_previous_error[j] = 1.0;
+    output[j] = std::min(std::max(unsaturated, output_min[j]), output_max[j]);
+  }
+}
+}  // namespace
+
+namespace controller_interface
+{
+
+BatchPid::BatchPid(size_t joint_count, const PidGains & gains)
+: p_(joint_count), i_(joint_count), d_(joint_count), i_min_(joint_count), i_max_(joint_count),
+  feed_forward_(joint_count), derivative_time_constant_(joint_count), output_min_(joint_count),
+  output_max_(joint_count), integral_(joint_count), previous_error_(joint_count),
+  derivative_(joint_count), has_previous_error_(joint_count), zeros_(joint_count, 0.0),
+  schedules_(joint_count)
+{
+  for (size_t joint = 0; joint < joint_count; ++joint) {
+    set_gains(joint, gains);
+  }
+  reset();
+}
+
+size_t BatchPid::size() const
+{
+  return p_.size();
+}
+
+void BatchPid::set_gains(size_t joint, const PidGains & gains)
+{
+  p_[joint] = gains.p;
+  i_[joint] = gains.i;
+  d_[joint] = gains.d;
+  i_min_[joint] = gains.i_min;
+  i_max_[joint] = gains.i_max;
+  feed_forward_[joint] = gains.feed_forward;
+  derivative_time_constant_[joint] = gains.derivative_time_constant;
+  output_min_[joint] = gains.output_min;
+  output_max_[joint] = gains.output_max;
+}
+
+PidGains BatchPid::get_gains(size_t joint) const
+{
+  PidGains gains;
+  gains.p = p_[joint];
+  gains.i = i_[joint];
+  gains.d = d_[joint];
+  gains.i_min = i_min_[joint];
+  gains.i_max = i_max_[joint];
+  gains.feed_forward = feed_forward_[joint];
+  gains.derivative_time_constant = derivative_time_constant_[joint];
+  gains.output_min = output_min_[joint];
+  gains.output_max = output_max_[joint];
+  return gains;
+}
+
+void BatchPid::set_gain_schedule(
+  size_t joint, const std::vector<double> & breakpoints, const std::vector<PidGains> & gains)
+{
+  if (joint >= size()) {
+    throw std::invalid_argument("no joint " + std::to_string(joint) + " in the batch");
+  }
+  if (breakpoints.empty() || breakpoints.size() != gains.size()) {
+    throw std::invalid_argument("a gain schedule needs as many gains as breakpoints");
+  }
+  for (size_t k = 1; k < breakpoints.size(); ++k) {
+    if (!(breakpoints[k] > breakpoints[k - 1])) {
+      throw std::invalid_argument("the breakpoints of a gain schedule must be increasing");
+    }
+  }
+  for (const auto bound : {&PidGains::i_min, &PidGains::i_max, &PidGains::output_min,
+      &PidGains::output_max})
+  {
+    if (!is_interpolable(gains, bound)) {
+      throw std::invalid_argument(
+              "the bounds of a gain schedule must be finite or the same in all its gains");
+    }
+  }
+  schedules_[joint] = {breakpoints, gains};
+  set_gains(joint, gains.front());
+}
+
+return_type BatchPid::schedule_gains(Span<const double> scheduling_values)
+{
+  if (scheduling_values.size() != size()) {
+    return return_type::ERROR;
+  }
+  for (size_t joint = 0; joint < size(); ++joint) {
+    const auto & schedule = schedules_[joint];
+    if (schedule.breakpoints.empty()) {
+      continue;
+    }
+    const double value = scheduling_values[joint];
+    const auto & breakpoints = schedule.breakpoints;
+    if (!(value > breakpoints.front())) {
+      set_gains(joint, schedule.gains.front());
+      continue;
+    }
+    if (value >= breakpoints.back()) {
+      set_gains(joint, schedule.gains.back());
+      continue;
+    }
+    // the schedules have a handful of breakpoints, a linear search is the fastest
+    size_t k = 1;
+    while (breakpoints[k] < value) {
+      ++k;
+    }
+    const double t = (value - breakpoints[k - 1]) / (breakpoints[k] - breakpoints[k - 1]);
+    set_gains(joint, interpolate(schedule.gains[k - 1], schedule.gains[k], t));
+  }
+  return return_type::SUCCESS;
+}
+
+return_type BatchPid::update(
+  Span<const double> setpoints,
+  Span<const double> measurements,
+  Span<const double> feed_forwards,
+  double dt,
+  Span<double> outputs)
+{
+  const size_t n = size();
+  if (!(dt > 0.0) || setpoints.size() != n || measurements.size() != n ||
+    (!feed_forwards.empty() && feed_forwards.size() != n) || outputs.size() != n)
+  {
+    return return_type::ERROR;
+  }
+  update_joints(
+    n, setpoints.data(), measurements.data(),
+    feed_forwards.empty() ? zeros_.data() : feed_forwards.data(), dt, p_.data(), i_.data(),
+    d_.data(), i_min_.data(), i_max_.data(), feed_forward_.data(),
+    derivative_time_constant_.data(), output_min_.data(), output_max_.data(), integral_.data(),
+    previous_error_.data(), derivative_.data(), has_previous_error_.data(), outputs.data());
+  return return_type::SUCCESS;
+}
+
+void BatchPid::reset()
+{
+  std::fill(integral_.begin(), integral_.end(), 0.0);
+  std::fill(previous_error_.begin(), previous_error_.end(), 0.0);
+  std::fill(derivative_.begin(), derivative_.end(), 0.0);
+  std::fill(has_previous_error_.begin(), has_previous_error_.end(), 0.0);
+}
+
+double BatchPid::get_integral(size_t joint) const
+{
+  return integral_[joint];
+}
+
+}  // namespace controller_interface
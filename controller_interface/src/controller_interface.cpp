@@ -14,12 +14,20 @@
 
 #include "controller_interface/controller_interface.hpp"
 
+#include <limits>
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace controller_interface
 {
 
+ControllerInterface::~ControllerInterface()
+{
+  unexport_reference_interfaces();
+}
+
 return_type
 ControllerInterface::init(
   std::weak_ptr<hardware_interface::RobotHardware> robot_hardware,
@@ -49,10 +57,160 @@ ControllerInterface::init(
   return return_type::SUCCESS;
 }
 
+return_type
+ControllerInterface::update()
+{
+  return return_type::ERROR;
+}
+
+return_type
+ControllerInterface::update(const rclcpp::Time &, const rclcpp::Duration &)
+{
+  return update();
+}
+
+return_type
+ControllerInterface::update_standby(const rclcpp::Time &, const rclcpp::Duration &)
+{
+  return return_type::SUCCESS;
+}
+
+return_type
+ControllerInterface::warm_up(const rclcpp::Time & time, const rclcpp::Duration & period)
+{
+  return update_standby(time, period);
+}
+
+void
+ControllerInterface::on_takeover()
+{
+}
+
 std::shared_ptr<rclcpp_lifecycle::LifecycleNode>
 ControllerInterface::get_lifecycle_node()
 {
   return lifecycle_node_;
 }
 
+std::map<std::string, std::vector<std::string>>
+ControllerInterface::get_claimed_resources() const
+{
+  return {};
+}
+
+std::map<std::string, std::vector<std::string>>
+ControllerInterface::get_read_state_interfaces() const
+{
+  return {};
+}
+
+bool
+ControllerInterface::is_deterministic() const
+{
+  return false;
+}
+
+bool
+ControllerInterface::take_update_request()
+{
+  return update_requested_.exchange(false, std::memory_order_acq_rel);
+}
+
+void
+ControllerInterface::request_update()
+{
+  update_requested_.store(true, std::memory_order_release);
+}
+
+std::map<std::string, std::vector<std::string>>
+ControllerInterface::get_reference_interfaces() const
+{
+  return {};
+}
+
+return_type
+ControllerInterface::export_reference_interfaces()
+{
+  unexport_reference_interfaces();
+  const auto references = get_reference_interfaces();
+  if (references.empty()) {
+    return return_type::SUCCESS;
+  }
+  auto robot_hardware = robot_hardware_.lock();
+  if (!robot_hardware) {
+    return return_type::ERROR;
+  }
+
+  size_t reference_count = 0;
+  for (const auto & interface : references) {
+    reference_count += interface.second.size();
+  }
+  // allocated once, the registered storage must not move
+  reference_values_.assign(reference_count, std::numeric_limits<double>::quiet_NaN());
+  const std::string prefix = std::string(lifecycle_node_->get_name()) + "/";
+  size_t index = 0;
+  for (const auto & interface : references) {
+    auto & exported_names = exported_references_[interface.first];
+    for (const auto & name : interface.second) {
+      const auto full_name = prefix + name;
+      if (robot_hardware->register_reference_interface(
+          full_name, interface.first, &reference_values_[index]) !=
+        hardware_interface::return_type::OK)
+      {
+        unexport_reference_interfaces();
+        return return_type::ERROR;
+      }
+      exported_names.push_back(full_name);
+      ++index;
+    }
+  }
+  return return_type::SUCCESS;
+}
+
+void
+ControllerInterface::unexport_reference_interfaces()
+{
+  auto robot_hardware = robot_hardware_.lock();
+  if (robot_hardware) {
+    for (const auto & interface : exported_references_) {
+      for (const auto & name : interface.second) {
+        robot_hardware->unregister_reference_interface(name, interface.first);
+      }
+    }
+  }
+  exported_references_.clear();
+  reference_values_.clear();
+}
+
+const std::map<std::string, std::vector<std::string>> &
+ControllerInterface::get_exported_reference_interfaces() const
+{
+  return exported_references_;
+}
+
+const double *
+ControllerInterface::get_reference_value(
+  const std::string & interface_name, const std::string & name) const
+{
+  const auto interface = exported_references_.find(interface_name);
+  if (interface == exported_references_.end()) {
+    return nullptr;
+  }
+  const std::string full_name = std::string(lifecycle_node_->get_name()) + "/" + name;
+  size_t index = 0;
+  for (const auto & exported : exported_references_) {
+    if (exported.first == interface_name) {
+      break;
+    }
+    index += exported.second.size();
+  }
+  for (const auto & exported_name : interface->second) {
+    if (exported_name == full_name) {
+      return &reference_values_[index];
+    }
+    ++index;
+  }
+  return nullptr;
+}
+
 }  // namespace controller_interface
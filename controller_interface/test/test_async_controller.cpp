@@ -0,0 +1,209 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "controller_interface/async_controller.hpp"
+#include "controller_interface/async_solver_pool.hpp"
+
+using controller_interface::AsyncControllerOptions;
+using controller_interface::AsyncSolverPool;
+using controller_interface::return_type;
+
+namespace
+{
+/// Solves for twice its input, each solve held until released by the test
+class DoublingController : public controller_interface::AsyncController<double, std::vector<double>>
+{
+public:
+  explicit DoublingController(const AsyncControllerOptions & options)
+  : AsyncController(options)
+  {
+  }
+
+  ~DoublingController() override
+  {
+    released = true;
+    wait_for_solve();
+  }
+
+  double measurement = 1.0;
+  double command = 0.0;
+  int64_t applied_age_ns = -1;
+  std::atomic<bool> released{false};
+  std::atomic<bool> failing{false};
+
+protected:
+  return_type capture_inputs(const rclcpp::Time &, double & input) override
+  {
+    input = measurement;
+    return return_type::SUCCESS;
+  }
+
+  return_type solve(const double & input, std::vector<double> & output) override
+  {
+    while (!released) {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    output.assign(1, 2.0 * input);
+    return failing ? return_type::ERROR : return_type::SUCCESS;
+  }
+
+  return_type apply_output(
+    const std::vector<double> & output, const rclcpp::Duration & age, const rclcpp::Time &,
+    const rclcpp::Duration &) override
+  {
+    command = output[0];
+    applied_age_ns = age.nanoseconds();
+    return return_type::SUCCESS;
+  }
+
+  return_type apply_fallback(const rclcpp::Time &, const rclcpp::Duration &) override
+  {
+    command = -1.0;
+    return return_type::SUCCESS;
+  }
+};
+
+rclcpp::Time at_ms(int64_t ms)
+{
+  return rclcpp::Time(ms * 1000000);
+}
+
+const rclcpp::Duration kPeriod(0, 1000000);
+
+class TestAsyncController : public ::testing::Test
+{
+public:
+  void SetUp() override
+  {
+    AsyncControllerOptions options;
+    options.max_output_age = std::chrono::milliseconds(5);
+    options.pool = std::make_shared<AsyncSolverPool>(1);
+    controller_ = std::make_unique<DoublingController>(options);
+  }
+
+  void update(int64_t ms)
+  {
+    ASSERT_EQ(return_type::SUCCESS, controller_->update(at_ms(ms), kPeriod));
+  }
+
+  /// Lets the solve in flight finish, and blocks the next one
+  void finish_solve()
+  {
+    controller_->released = true;
+    controller_->wait_for_solve();
+    controller_->released = false;
+  }
+
+  std::unique_ptr<DoublingController> controller_;
+};
+}  // namespace
+
+TEST(AsyncSolverPool, runs_the_submitted_tasks) {
+  AsyncSolverPool pool(2, 4);
+  EXPECT_EQ(2u, pool.get_thread_count());
+  std::atomic<int> count{0};
+  auto increment = [](void * context) {++*static_cast<std::atomic<int> *>(context);};
+  int submitted = 0;
+  for (int i = 0; i < 100; ++i) {
+    // the queue may be full or locked, never waited for
+    if (pool.try_submit(increment, &count)) {
+      ++submitted;
+    }
+  }
+  EXPECT_LT(0, submitted);
+  while (count < submitted) {
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(submitted, count);
+}
+
+TEST(AsyncSolverPool, fails_to_submit_to_a_full_queue) {
+  std::atomic<bool> released{false};
+  auto blocked = [](void * context) {
+      while (!*static_cast<std::atomic<bool> *>(context)) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+      }
+    };
+  AsyncSolverPool pool(1, 2);
+  ASSERT_TRUE(pool.try_submit(blocked, &released));
+  // the thread takes the first task out of the queue
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_TRUE(pool.try_submit(blocked, &released));
+  EXPECT_TRUE(pool.try_submit(blocked, &released));
+  EXPECT_FALSE(pool.try_submit(blocked, &released));
+  released = true;
+}
+
+TEST_F(TestAsyncController, falls_back_until_the_first_output) {
+  // the solve is held, the updates go on without waiting for it
+  for (int64_t ms = 0; ms < 4; ++ms) {
+    update(ms);
+    EXPECT_EQ(-1.0, controller_->command);
+  }
+  EXPECT_EQ(4u, controller_->get_fallback_count());
+  EXPECT_EQ(0u, controller_->get_solve_count());
+
+  // the solve of the inputs of the first cycle, picked up by the next update
+  controller_->measurement = 3.0;
+  finish_solve();
+  update(4);
+  EXPECT_EQ(2.0, controller_->command);
+  EXPECT_EQ(4000000, controller_->applied_age_ns);
+  EXPECT_EQ(1u, controller_->get_solve_count());
+
+  // the next solve started with the inputs of that update
+  finish_solve();
+  update(5);
+  EXPECT_EQ(6.0, controller_->command);
+  EXPECT_EQ(1000000, controller_->applied_age_ns);
+}
+
+TEST_F(TestAsyncController, falls_back_on_stale_outputs) {
+  update(0);
+  finish_solve();
+  update(1);
+  EXPECT_EQ(2.0, controller_->command);
+  // the next solve is held, the output applied until older than 5 ms
+  for (int64_t ms = 2; ms <= 5; ++ms) {
+    update(ms);
+    EXPECT_EQ(2.0, controller_->command);
+  }
+  const auto fallbacks = controller_->get_fallback_count();
+  update(6);
+  EXPECT_EQ(-1.0, controller_->command);
+  EXPECT_EQ(fallbacks + 1, controller_->get_fallback_count());
+}
+
+TEST_F(TestAsyncController, drops_the_outputs_of_failed_solves) {
+  controller_->failing = true;
+  update(0);
+  finish_solve();
+  update(1);
+  EXPECT_EQ(-1.0, controller_->command);
+  EXPECT_EQ(1u, controller_->get_failed_solve_count());
+  EXPECT_EQ(0u, controller_->get_solve_count());
+
+  controller_->failing = false;
+  finish_solve();
+  update(2);
+  EXPECT_EQ(2.0, controller_->command);
+}
@@ -0,0 +1,172 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "controller_interface/batch_pid.hpp"
+
+using controller_interface::BatchPid;
+using controller_interface::PidGains;
+using controller_interface::return_type;
+
+namespace
+{
+constexpr double kDt = 0.001;
+
+/// The same PID loop, written as scalar code for one joint
+struct ScalarPid
+{
+  double update(double setpoint, double measurement, double feed_forward)
+  {
+    const double error = setpoint - measurement;
+    const double raw_derivative = first ? 0.0 : (error - previous_error) / kDt;
+    const double alpha = kDt / (gains.derivative_time_constant + kDt);
+    derivative += alpha * (raw_derivative - derivative);
+    double next_integral =
+      std::min(std::max(integral + gains.i * error * kDt, gains.i_min), gains.i_max);
+    const double unsaturated = gains.p * error + next_integral + gains.d * derivative +
+      gains.feed_forward * feed_forward;
+    const double output = std::min(std::max(unsaturated, gains.output_min), gains.output_max);
+    if ((unsaturated > gains.output_max && gains.i * error > 0.0) ||
+      (unsaturated < gains.output_min && gains.i * error < 0.0))
+    {
+      next_integral = integral;
+    }
+    integral = next_integral;
+    previous_error = error;
+    first = false;
+    return output;
+  }
+
+  PidGains gains;
+  double integral = 0.0;
+  double previous_error = 0.0;
+  double derivative = 0.0;
+  bool first = true;
+};
+}  // namespace
+
+TEST(TestBatchPid, matches_the_scalar_loop_of_each_joint)
+{
+  const size_t joint_count = 13;
+  BatchPid pid(joint_count);
+  std::vector<ScalarPid> scalar(joint_count);
+  for (size_t j = 0; j < joint_count; ++j) {
+    PidGains gains;
+    gains.p = 10.0 + j;
+    gains.i = 2.0 * j;
+    gains.d = 0.1 * j;
+    gains.i_min = -0.5;
+    gains.i_max = 0.5;
+    gains.feed_forward = j % 2 ? 1.0 : 0.0;
+    gains.derivative_time_constant = j % 3 ? 0.01 : 0.0;
+    gains.output_min = -3.0;
+    gains.output_max = 3.0;
+    pid.set_gains(j, gains);
+    scalar[j].gains = gains;
+  }
+
+  std::vector<double> setpoints(joint_count), measurements(joint_count);
+  std::vector<double> feed_forwards(joint_count), outputs(joint_count);
+  for (int cycle = 0; cycle < 500; ++cycle) {
+    for (size_t j = 0; j < joint_count; ++j) {
+      setpoints[j] = std::sin(0.01 * cycle + j);
+      measurements[j] = 0.5 * std::sin(0.01 * cycle - 0.2 + j);
+      feed_forwards[j] = 0.1 * j;
+    }
+    ASSERT_EQ(
+      return_type::SUCCESS, pid.update(setpoints, measurements, feed_forwards, kDt, outputs));
+    for (size_t j = 0; j < joint_count; ++j) {
+      ASSERT_NEAR(
+        scalar[j].update(setpoints[j], measurements[j], feed_forwards[j]), outputs[j], 1e-12);
+      ASSERT_LE(std::abs(outputs[j]), 3.0);
+      ASSERT_LE(std::abs(pid.get_integral(j)), 0.5);
+    }
+  }
+
+  // a mismatch of the sizes changes nothing
+  std::vector<double> too_few(joint_count - 1);
+  EXPECT_EQ(return_type::ERROR, pid.update(setpoints, too_few, {}, kDt, outputs));
+  EXPECT_EQ(return_type::ERROR, pid.update(setpoints, measurements, {}, 0.0, outputs));
+}
+
+TEST(TestBatchPid, integral_does_not_wind_up_while_saturated)
+{
+  PidGains gains;
+  gains.p = 1.0;
+  gains.i = 100.0;
+  gains.output_min = -1.0;
+  gains.output_max = 1.0;
+  BatchPid pid(1, gains);
+  std::vector<double> setpoint{5.0};
+  std::vector<double> measurement{0.0};
+  std::vector<double> output(1);
+  // a large error saturates the output, the integral stops growing
+  for (int cycle = 0; cycle < 1000; ++cycle) {
+    ASSERT_EQ(return_type::SUCCESS, pid.update(setpoint, measurement, {}, kDt, output));
+    EXPECT_EQ(1.0, output[0]);
+  }
+  EXPECT_DOUBLE_EQ(0.0, pid.get_integral(0));
+
+  // and the output leaves the saturation as soon as the error changes sign
+  setpoint[0] = 0.0;
+  measurement[0] = 0.1;
+  ASSERT_EQ(return_type::SUCCESS, pid.update(setpoint, measurement, {}, kDt, output));
+  EXPECT_NEAR(-0.11, output[0], 1e-12);
+
+  pid.reset();
+  EXPECT_EQ(0.0, pid.get_integral(0));
+}
+
+TEST(TestBatchPid, interpolates_the_scheduled_gains)
+{
+  BatchPid pid(2);
+  PidGains low;
+  low.p = 10.0;
+  low.output_max = 5.0;
+  PidGains high = low;
+  high.p = 30.0;
+  high.output_max = 15.0;
+  pid.set_gain_schedule(0, {0.0, 1.0}, {low, high});
+  EXPECT_EQ(10.0, pid.get_gains(0).p);
+
+  std::vector<double> positions{0.25, 7.0};
+  ASSERT_EQ(return_type::SUCCESS, pid.schedule_gains(positions));
+  EXPECT_DOUBLE_EQ(15.0, pid.get_gains(0).p);
+  EXPECT_DOUBLE_EQ(7.5, pid.get_gains(0).output_max);
+  EXPECT_TRUE(std::isinf(pid.get_gains(0).output_min));
+  // the joints without schedule keep their gains
+  EXPECT_EQ(0.0, pid.get_gains(1).p);
+  positions[0] = 2.0;
+  ASSERT_EQ(return_type::SUCCESS, pid.schedule_gains(positions));
+  EXPECT_EQ(30.0, pid.get_gains(0).p);
+  positions[0] = -2.0;
+  ASSERT_EQ(return_type::SUCCESS, pid.schedule_gains(positions));
+  EXPECT_EQ(10.0, pid.get_gains(0).p);
+  positions.pop_back();
+  EXPECT_EQ(return_type::ERROR, pid.schedule_gains(positions));
+
+  EXPECT_THROW(pid.set_gain_schedule(0, {1.0, 0.0}, {low, high}), std::invalid_argument);
+  EXPECT_THROW(pid.set_gain_schedule(0, {0.0}, {low, high}), std::invalid_argument);
+  EXPECT_THROW(pid.set_gain_schedule(2, {0.0}, {low}), std::invalid_argument);
+  PidGains unbounded = high;
+  unbounded.output_max = std::numeric_limits<double>::infinity();
+  EXPECT_THROW(pid.set_gain_schedule(1, {0.0, 1.0}, {low, unbounded}), std::invalid_argument);
+}
@@ -0,0 +1,168 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "controller_interface/controller_interface.hpp"
+#include "controller_interface/parameter_snapshot.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace
+{
+struct Gains
+{
+  double p = 1.0;
+  double d = 0.1;
+  int64_t filter_length = 4;
+  bool feed_forward = false;
+};
+
+/// Reads its gains in update() from a snapshot of its parameters
+class GainsController : public controller_interface::ControllerInterface
+{
+public:
+  controller_interface::return_type
+  init(
+    std::weak_ptr<hardware_interface::RobotHardware> robot_hardware,
+    const std::string & controller_name) override
+  {
+    const auto ret = ControllerInterface::init(robot_hardware, controller_name);
+    gains = make_parameter_snapshot<Gains>();
+    gains->declare_parameter("p", &Gains::p);
+    gains->declare_parameter("d", &Gains::d);
+    gains->declare_parameter("filter_length", &Gains::filter_length);
+    gains->declare_parameter("feed_forward", &Gains::feed_forward);
+    return ret;
+  }
+
+  controller_interface::return_type update() override
+  {
+    const auto & current = gains->get();
+    command = current.p + current.d;
+    return controller_interface::return_type::SUCCESS;
+  }
+
+  std::shared_ptr<controller_interface::ParameterSnapshot<Gains>> gains;
+  double command = 0.0;
+};
+}  // namespace
+
+class TestParameterSnapshot : public ::testing::Test
+{
+public:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+
+  void SetUp()
+  {
+    controller_ = std::make_shared<GainsController>();
+    ASSERT_EQ(
+      controller_interface::return_type::SUCCESS,
+      controller_->init(std::weak_ptr<hardware_interface::RobotHardware>(), "gains_controller"));
+    node_ = controller_->get_lifecycle_node();
+  }
+
+  std::shared_ptr<GainsController> controller_;
+  std::shared_ptr<rclcpp_lifecycle::LifecycleNode> node_;
+};
+
+TEST_F(TestParameterSnapshot, declares_parameters_with_the_defaults)
+{
+  double p = 0.0;
+  ASSERT_TRUE(node_->get_parameter("p", p));
+  EXPECT_EQ(1.0, p);
+  const auto & gains = controller_->gains->get();
+  EXPECT_EQ(1.0, gains.p);
+  EXPECT_EQ(0.1, gains.d);
+  EXPECT_EQ(4, gains.filter_length);
+  EXPECT_FALSE(gains.feed_forward);
+}
+
+TEST_F(TestParameterSnapshot, publishes_set_parameters_at_once)
+{
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, controller_->update());
+  EXPECT_DOUBLE_EQ(1.1, controller_->command);
+
+  const auto result = node_->set_parameters_atomically(
+    {rclcpp::Parameter("p", 2.0), rclcpp::Parameter("d", 0.5),
+      rclcpp::Parameter("feed_forward", true)});
+  ASSERT_TRUE(result.successful) << result.reason;
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, controller_->update());
+  EXPECT_DOUBLE_EQ(2.5, controller_->command);
+
+  const auto gains = controller_->gains->get_published();
+  EXPECT_EQ(2.0, gains.p);
+  EXPECT_EQ(0.5, gains.d);
+  EXPECT_EQ(4, gains.filter_length);
+  EXPECT_TRUE(gains.feed_forward);
+}
+
+TEST_F(TestParameterSnapshot, rejects_parameters_of_another_type)
+{
+  const auto result = node_->set_parameter(rclcpp::Parameter("p", "high"));
+  EXPECT_FALSE(result.successful);
+  EXPECT_EQ(1.0, controller_->gains->get().p);
+
+  // the snapshot is unchanged until a valid value is set
+  EXPECT_TRUE(node_->set_parameters_atomically({rclcpp::Parameter("p", 3.0)}).successful);
+  EXPECT_EQ(3.0, controller_->gains->get().p);
+}
+
+TEST_F(TestParameterSnapshot, reader_never_sees_partial_updates)
+{
+  constexpr int64_t kUpdates = 20000;
+  controller_->gains->update(
+    [](Gains & gains) {
+      gains.p = 0.0;
+      gains.filter_length = 0;
+    });
+  std::atomic<bool> done{false};
+  std::thread writer([this, &done]() {
+      for (int64_t i = 1; i <= kUpdates; ++i) {
+        controller_->gains->update(
+          [i](Gains & gains) {
+            gains.p = static_cast<double>(i);
+            gains.filter_length = i;
+          });
+      }
+      done = true;
+    });
+
+  int64_t last_update = 0;
+  size_t partial_updates = 0;
+  while (!done) {
+    const auto & gains = controller_->gains->get();
+    if (static_cast<double>(gains.filter_length) != gains.p || gains.filter_length < last_update) {
+      ++partial_updates;
+    }
+    last_update = gains.filter_length;
+  }
+  writer.join();
+  EXPECT_EQ(0u, partial_updates);
+  EXPECT_EQ(kUpdates, controller_->gains->get().filter_length);
+}
@@ -0,0 +1,190 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "builtin_interfaces/msg/time.hpp"
+
+#include "controller_interface/controller_interface.hpp"
+#include "controller_interface/realtime_publisher.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+
+using builtin_interfaces::msg::Time;
+using controller_interface::RealtimePublisher;
+
+namespace
+{
+constexpr auto kTimeout = std::chrono::seconds(5);
+
+/// Publishes the number of its updates, as both the seconds and nanoseconds of a time message
+class CountingController : public controller_interface::ControllerInterface
+{
+public:
+  controller_interface::return_type
+  init(
+    std::weak_ptr<hardware_interface::RobotHardware> robot_hardware,
+    const std::string & controller_name) override
+  {
+    const auto ret = ControllerInterface::init(robot_hardware, controller_name);
+    publisher = make_realtime_publisher<Time>("~/updates", rclcpp::QoS(10));
+    return ret;
+  }
+
+  controller_interface::return_type update() override
+  {
+    ++updates;
+    auto message = publisher->try_lock();
+    if (message) {
+      message->sec = static_cast<int32_t>(updates);
+      message->nanosec = updates;
+      publisher->unlock_and_publish();
+    }
+    return controller_interface::return_type::SUCCESS;
+  }
+
+  std::shared_ptr<RealtimePublisher<Time>> publisher;
+  uint32_t updates = 0;
+};
+}  // namespace
+
+class TestRealtimePublisher : public ::testing::Test
+{
+public:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+
+  void SetUp()
+  {
+    node_ = std::make_shared<rclcpp::Node>("test_realtime_publisher");
+  }
+
+  /// Subscribes to the topic, the messages are checked and recorded when the node is spun
+  void subscribe(const std::string & topic_name)
+  {
+    subscription_ = node_->create_subscription<Time>(
+      topic_name, rclcpp::QoS(10), [this](const Time & message) {
+        if (static_cast<uint32_t>(message.sec) != message.nanosec) {
+          ++torn_messages_;
+        }
+        last_received_ = message.nanosec;
+        ++received_;
+      });
+  }
+
+  /// Waits for the subscription to be discovered, messages published before would be lost
+  bool wait_for_subscription(const rclcpp::Publisher<Time>::SharedPtr & publisher)
+  {
+    const auto deadline = std::chrono::steady_clock::now() + kTimeout;
+    while (publisher->get_subscription_count() == 0 &&
+      std::chrono::steady_clock::now() < deadline)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return publisher->get_subscription_count() > 0;
+  }
+
+  /// Spins the node until the last received message is the expected one
+  bool spin_until_received(uint32_t expected)
+  {
+    const auto deadline = std::chrono::steady_clock::now() + kTimeout;
+    while (last_received_ != expected && std::chrono::steady_clock::now() < deadline) {
+      rclcpp::spin_some(node_);
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return last_received_ == expected;
+  }
+
+  std::shared_ptr<rclcpp::Node> node_;
+  rclcpp::Subscription<Time>::SharedPtr subscription_;
+  std::atomic<uint32_t> last_received_{0};
+  std::atomic<size_t> received_{0};
+  std::atomic<size_t> torn_messages_{0};
+};
+
+TEST_F(TestRealtimePublisher, publishes_from_controller_update)
+{
+  CountingController controller;
+  ASSERT_EQ(
+    controller_interface::return_type::SUCCESS,
+    controller.init(std::weak_ptr<hardware_interface::RobotHardware>(), "counting_controller"));
+  subscribe("/counting_controller/updates");
+  ASSERT_TRUE(wait_for_subscription(controller.publisher->get_publisher()));
+
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, controller.update());
+  EXPECT_TRUE(spin_until_received(1));
+  EXPECT_EQ(1u, controller.publisher->get_published_count());
+  EXPECT_EQ(0u, controller.publisher->get_dropped_count());
+
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, controller.update());
+  EXPECT_TRUE(spin_until_received(2));
+  EXPECT_EQ(0u, torn_messages_);
+}
+
+TEST_F(TestRealtimePublisher, counts_every_message_once)
+{
+  constexpr uint32_t kMessages = 2000;
+  subscribe("rt_messages");
+  RealtimePublisher<Time> publisher(
+    node_->create_publisher<Time>("rt_messages", rclcpp::QoS(10)), Time(),
+    std::chrono::microseconds(100));
+  ASSERT_TRUE(wait_for_subscription(publisher.get_publisher()));
+
+  // handed over faster than published, so most of them replace a pending one
+  std::thread rt_thread([&publisher]() {
+      for (uint32_t i = 1; i <= kMessages; ++i) {
+        Time message;
+        message.sec = static_cast<int32_t>(i);
+        message.nanosec = i;
+        publisher.try_publish(message);
+        if (i % 100 == 0) {
+          std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+      }
+    });
+  rt_thread.join();
+
+  // the last message is handed over, and published once the publishing thread takes it
+  EXPECT_TRUE(spin_until_received(kMessages));
+  EXPECT_EQ(
+    kMessages, publisher.get_published_count() + publisher.get_dropped_count());
+  EXPECT_GT(publisher.get_published_count(), 0u);
+  EXPECT_EQ(0u, torn_messages_);
+}
+
+TEST_F(TestRealtimePublisher, try_lock_fails_while_filling)
+{
+  RealtimePublisher<Time> publisher(
+    node_->create_publisher<Time>("rt_locked", rclcpp::QoS(10)));
+  auto message = publisher.try_lock();
+  ASSERT_NE(nullptr, message);
+  EXPECT_EQ(nullptr, publisher.try_lock());
+  EXPECT_FALSE(publisher.try_publish(Time()));
+  EXPECT_EQ(2u, publisher.get_dropped_count());
+  publisher.unlock_and_publish();
+}
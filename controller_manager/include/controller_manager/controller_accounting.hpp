@@ -0,0 +1,92 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONTROLLER_MANAGER__CONTROLLER_ACCOUNTING_HPP_
+#define CONTROLLER_MANAGER__CONTROLLER_ACCOUNTING_HPP_
+
+#include <atomic>
+#include <cstdint>
+
+#include "controller_manager/visibility_control.h"
+
+#include "hardware_interface/realtime_memory_pool.hpp"
+
+namespace controller_manager
+{
+
+/**
+ * @brief The ControllerAccounting class accumulates the CPU time of the updates of a controller
+ * and the blocks they take from the realtime memory pools, to tell which controller the growth of
+ * the cycle time or of the memory comes from
+ *
+ * The CPU time is measured with the CPU clock of the thread updating the controller, see
+ * ControllerCpuBudget::thread_cpu_time_ns(). Everything is only written by that thread, with
+ * atomic stores, and read by the controller manager when the controllers are listed.
+ */
+class ControllerAccounting
+{
+public:
+  /// Default number of updates the recent CPU time is averaged over
+  static constexpr uint64_t RECENT_WINDOW = 1000;
+
+  /// @param recent_window Number of updates the recent CPU time is averaged over, at least 1
+  CONTROLLER_MANAGER_PUBLIC
+  explicit ControllerAccounting(uint64_t recent_window = RECENT_WINDOW);
+
+  ControllerAccounting(const ControllerAccounting &) = delete;
+  ControllerAccounting & operator=(const ControllerAccounting &) = delete;
+
+  /// Records the CPU time of an update, real-time safe
+  CONTROLLER_MANAGER_PUBLIC
+  void record_update(int64_t cpu_time_ns);
+
+  CONTROLLER_MANAGER_PUBLIC
+  uint64_t get_update_count() const;
+
+  CONTROLLER_MANAGER_PUBLIC
+  int64_t get_total_cpu_time_ns() const;
+
+  /**
+   * @brief get_recent_cpu_time_ns Mean CPU time of an update over the last complete window of
+   * updates, or over the updates so far until the first window is complete
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  int64_t get_recent_cpu_time_ns() const;
+
+  CONTROLLER_MANAGER_PUBLIC
+  uint64_t get_recent_window() const;
+
+  /// The account the updates charge their pool blocks to, see ScopedPoolAllocationAccount
+  CONTROLLER_MANAGER_PUBLIC
+  hardware_interface::PoolAllocationAccount & get_pool_account();
+
+  CONTROLLER_MANAGER_PUBLIC
+  const hardware_interface::PoolAllocationAccount & get_pool_account() const;
+
+private:
+  const uint64_t recent_window_;
+
+  /// Only touched by the thread updating the controller
+  int64_t window_cpu_time_ns_ = 0;
+  uint64_t window_count_ = 0;
+
+  std::atomic<uint64_t> update_count_{0};
+  std::atomic<int64_t> total_cpu_time_ns_{0};
+  std::atomic<int64_t> recent_cpu_time_ns_{0};
+  hardware_interface::PoolAllocationAccount pool_account_;
+};
+
+}  // namespace controller_manager
+
+#endif  // CONTROLLER_MANAGER__CONTROLLER_ACCOUNTING_HPP_
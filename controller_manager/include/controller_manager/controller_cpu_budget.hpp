@@ -0,0 +1,176 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONTROLLER_MANAGER__CONTROLLER_CPU_BUDGET_HPP_
+#define CONTROLLER_MANAGER__CONTROLLER_CPU_BUDGET_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "controller_manager/visibility_control.h"
+
+namespace controller_manager
+{
+
+/// What is done to a controller whose updates overrun their CPU budget in a sustained way
+enum class OverrunPolicy : uint8_t
+{
+  /// Skip its next update
+  SKIP,
+  /// Halve its update rate, down to 1 / ControllerCpuBudget::MAX_RATE_DIVIDER of it
+  DECIMATE,
+  /// Stop updating it, its command interfaces hold the last commands it wrote until it is
+  /// started again
+  DEACTIVATE,
+};
+
+struct ControllerCpuBudgetOptions
+{
+  /// CPU time allowed for one update, 0 to not budget the updates
+  int64_t budget_ns = 0;
+  OverrunPolicy policy = OverrunPolicy::SKIP;
+  /// Number of consecutive updates over the budget which make a sustained overrun
+  unsigned int overrun_limit = 3;
+  /// When the controllers overrun the CPU budget of the whole update, the ones with the lowest
+  /// priority are degraded first; in a stage, the ones with the highest priority are updated first
+  int priority = 0;
+};
+
+/**
+ * @brief The ControllerCpuBudget class measures the CPU time of the updates of a controller with
+ * the CPU clock of the thread updating it, and applies the overrun policy of the controller when
+ * its updates overrun their budget in a sustained way
+ *
+ * The CPU time leaves out the time the thread was preempted, so a controller is not degraded for
+ * the load of the others. Everything but the options is only written by the thread updating the
+ * controller, with atomic stores, and read by the controller manager when the controllers are
+ * listed.
+ */
+class ControllerCpuBudget
+{
+public:
+  static constexpr uint32_t MAX_RATE_DIVIDER = 64;
+
+  CONTROLLER_MANAGER_PUBLIC
+  explicit ControllerCpuBudget(
+    const ControllerCpuBudgetOptions & options = ControllerCpuBudgetOptions());
+
+  ControllerCpuBudget(const ControllerCpuBudget &) = delete;
+  ControllerCpuBudget & operator=(const ControllerCpuBudget &) = delete;
+
+  CONTROLLER_MANAGER_PUBLIC
+  const ControllerCpuBudgetOptions & get_options() const;
+
+  /// Whether the updates are measured against a budget
+  CONTROLLER_MANAGER_PUBLIC
+  bool is_budgeted() const;
+
+  /**
+   * @brief begin_update Whether an update due is done, or left out by the policy applied
+   * Real-time safe, counts the updates left out.
+   * @param update_index Number of updates due before this one
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  bool begin_update(uint64_t update_index);
+
+  /**
+   * @brief get_update_span Number of updates due the update begun last spans, for its period
+   * 1 plus the updates left out since the previous update done, or since reset(). Only called by
+   * the thread updating the controller.
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  uint64_t get_update_span() const;
+
+  /**
+   * @brief end_update Records the CPU time of an update against the budget, real-time safe
+   * @return Whether the update made a sustained overrun, the policy was then applied
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  bool end_update(int64_t cpu_time_ns);
+
+  /**
+   * @brief degrade Applies the policy, real-time safe
+   * @return false if the policy was already applied as far as it goes
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  bool degrade();
+
+  /// Whether degrade() would change anything
+  CONTROLLER_MANAGER_PUBLIC
+  bool can_degrade() const;
+
+  /// Restores the full rate of a controller about to be started, its counters are kept
+  CONTROLLER_MANAGER_PUBLIC
+  void reset();
+
+  CONTROLLER_MANAGER_PUBLIC
+  uint64_t get_overrun_count() const;
+
+  /// Number of times the policy was applied
+  CONTROLLER_MANAGER_PUBLIC
+  uint64_t get_degradation_count() const;
+
+  /// Number of updates due which were left out
+  CONTROLLER_MANAGER_PUBLIC
+  uint64_t get_skipped_count() const;
+
+  /// The controller is updated once every rate divider of its updates due
+  CONTROLLER_MANAGER_PUBLIC
+  uint32_t get_rate_divider() const;
+
+  CONTROLLER_MANAGER_PUBLIC
+  bool is_suspended() const;
+
+  CONTROLLER_MANAGER_PUBLIC
+  int64_t get_last_cpu_time_ns() const;
+
+  CONTROLLER_MANAGER_PUBLIC
+  int64_t get_max_cpu_time_ns() const;
+
+  /// CPU time consumed by the calling thread, real-time safe
+  CONTROLLER_MANAGER_PUBLIC
+  static int64_t thread_cpu_time_ns();
+
+  CONTROLLER_MANAGER_PUBLIC
+  static const char * to_string(OverrunPolicy policy);
+
+  /**
+   * @brief from_string Parses "skip", "decimate" or "deactivate"
+   * @return false if the name is not one of these, policy is then left unchanged
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  static bool from_string(const std::string & name, OverrunPolicy & policy);
+
+private:
+  const ControllerCpuBudgetOptions options_;
+
+  /// Only touched by the thread updating the controller
+  unsigned int consecutive_overruns_ = 0;
+  uint64_t left_out_updates_ = 0;
+  uint64_t update_span_ = 1;
+  std::atomic<bool> skip_next_{false};
+  std::atomic<uint32_t> rate_divider_{1};
+  std::atomic<bool> suspended_{false};
+
+  std::atomic<uint64_t> overrun_count_{0};
+  std::atomic<uint64_t> degradation_count_{0};
+  std::atomic<uint64_t> skipped_count_{0};
+  std::atomic<int64_t> last_cpu_time_ns_{0};
+  std::atomic<int64_t> max_cpu_time_ns_{0};
+};
+
+}  // namespace controller_manager
+
+#endif  // CONTROLLER_MANAGER__CONTROLLER_CPU_BUDGET_HPP_
@@ -0,0 +1,121 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONTROLLER_MANAGER__CONTROLLER_GROUP_THREAD_HPP_
+#define CONTROLLER_MANAGER__CONTROLLER_GROUP_THREAD_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "controller_manager/visibility_control.h"
+
+namespace controller_manager
+{
+
+/// Placement of the worker thread of a controller group, and of the group in the cycle
+struct ControllerGroupOptions
+{
+  /// CPUs the worker thread may run on, empty for any CPU
+  std::vector<int> cpus;
+  /// SCHED_FIFO priority of the worker thread, 0 to keep the default scheduling
+  int priority = 0;
+  /// The groups are updated by increasing order, the groups of the same order in parallel. The
+  /// controllers out of any group have the order 0.
+  int order = 0;
+};
+
+/**
+ * @brief The ControllerGroupThread class is the worker thread updating the controllers of a
+ * controller group, e.g. the safety controllers on an isolated CPU
+ *
+ * The thread calling start() goes on with its own work, and joins the group thread with wait().
+ * Starting and waiting do not allocate nor take any lock: the task is published with an atomic
+ * sequence number and the group thread signals its end by clearing an atomic flag, both woken
+ * with futex wakes, so that a group thread of lower priority never holds a lock wait() waits for.
+ */
+class ControllerGroupThread
+{
+public:
+  using Task = void (*)(void * context, size_t group);
+
+  /**
+   * @param index Index of the group, given to the tasks
+   * @param name Name of the group, for the logs
+   * @param options Placement of the thread
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  ControllerGroupThread(
+    size_t index, const std::string & name, const ControllerGroupOptions & options);
+
+  CONTROLLER_MANAGER_PUBLIC
+  ~ControllerGroupThread();
+
+  ControllerGroupThread(const ControllerGroupThread &) = delete;
+  ControllerGroupThread & operator=(const ControllerGroupThread &) = delete;
+
+  CONTROLLER_MANAGER_PUBLIC
+  size_t get_index() const;
+
+  CONTROLLER_MANAGER_PUBLIC
+  const std::string & get_name() const;
+
+  CONTROLLER_MANAGER_PUBLIC
+  const ControllerGroupOptions & get_options() const;
+
+  /**
+   * @brief start Calls task(index of the group) in the group thread, and returns right away
+   * @warning The task should outlive the call to wait(), which should be made before the next
+   * start(), from the same thread
+   */
+  template<typename F>
+  void start(F & task)
+  {
+    start([](void * context, size_t group) {(*static_cast<F *>(context))(group);}, &task);
+  }
+
+  CONTROLLER_MANAGER_PUBLIC
+  void start(Task task, void * context);
+
+  /// Returns once the task started last is done, right away if there is none
+  CONTROLLER_MANAGER_PUBLIC
+  void wait();
+
+private:
+  void worker_loop(uint32_t task_sequence);
+
+  size_t index_;
+  std::string name_;
+  ControllerGroupOptions options_;
+
+  /// Incremented each time a task starts, the group thread sleeps on it between the tasks
+  std::atomic<uint32_t> task_sequence_{0};
+  /// Set before a last increment of task_sequence_, to stop the group thread
+  std::atomic<bool> stop_{false};
+
+  // Current task, written before it is started
+  Task task_ = nullptr;
+  void * context_ = nullptr;
+  /// 1 while the current task runs, wait() sleeps on it
+  std::atomic<uint32_t> running_{0};
+
+  std::thread thread_;
+};
+
+}  // namespace controller_manager
+
+#endif  // CONTROLLER_MANAGER__CONTROLLER_GROUP_THREAD_HPP_
@@ -0,0 +1,72 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONTROLLER_MANAGER__CONTROLLER_INPUT_TRACKER_HPP_
+#define CONTROLLER_MANAGER__CONTROLLER_INPUT_TRACKER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "controller_manager/visibility_control.h"
+
+namespace controller_manager
+{
+
+/**
+ * @brief The ControllerInputTracker class tells whether the inputs of a deterministic controller
+ * changed since its last update, for the controller manager to skip the updates which would
+ * compute the same commands again
+ *
+ * The inputs are the interface values the controller reads, tracked through their storage in the
+ * arenas of the robot hardware or in the controller exporting them. Their values are recorded at
+ * each update and compared bit for bit with the ones of the next, so that a NaN reference which is
+ * not written yet does not change either. The comparison costs as much as reading the inputs, and
+ * is done by the thread updating the controller only.
+ */
+class ControllerInputTracker
+{
+public:
+  /// @param inputs The storage of the inputs, which must outlive the tracker
+  CONTROLLER_MANAGER_PUBLIC
+  explicit ControllerInputTracker(std::vector<const double *> inputs = {});
+
+  ControllerInputTracker(const ControllerInputTracker &) = delete;
+  ControllerInputTracker & operator=(const ControllerInputTracker &) = delete;
+
+  CONTROLLER_MANAGER_PUBLIC
+  size_t size() const;
+
+  /**
+   * @brief update Records the current values of the inputs, real-time safe
+   * @return Whether an input changed since the previous call, true on the first call and on the
+   * first one after reset()
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  bool update();
+
+  /// Forgets the recorded values, e.g. when the controller is started, real-time safe
+  CONTROLLER_MANAGER_PUBLIC
+  void reset();
+
+private:
+  std::vector<const double *> inputs_;
+  /// Bits of the values of the last update
+  std::vector<uint64_t> values_;
+  bool recorded_ = false;
+};
+
+}  // namespace controller_manager
+
+#endif  // CONTROLLER_MANAGER__CONTROLLER_INPUT_TRACKER_HPP_
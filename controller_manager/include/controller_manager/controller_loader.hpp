@@ -0,0 +1,95 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONTROLLER_MANAGER__CONTROLLER_LOADER_HPP_
+#define CONTROLLER_MANAGER__CONTROLLER_LOADER_HPP_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "controller_interface/controller_interface.hpp"
+
+#include "controller_manager/visibility_control.h"
+
+#include "pluginlib/class_loader.hpp"
+
+namespace controller_manager
+{
+
+/**
+ * @brief The ControllerLoader class creates controllers from their plugins, serializing the use
+ * of the pluginlib loader, which is not thread-safe
+ *
+ * A single loader may be shared by the controller managers of a process, so that the plugin
+ * manifests are parsed and the libraries opened once for all of them.
+ */
+class ControllerLoader
+{
+public:
+  CONTROLLER_MANAGER_PUBLIC
+  ControllerLoader();
+
+  /// Closes the libraries opened by bind_library_now()
+  CONTROLLER_MANAGER_PUBLIC
+  ~ControllerLoader();
+
+  /**
+   * @brief create Creates a controller of the given type
+   * @return null if the type is not declared by any plugin
+   * @throw pluginlib::PluginlibException if the library of the type could not be loaded
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  controller_interface::ControllerInterfaceSharedPtr create(const std::string & controller_type);
+
+  CONTROLLER_MANAGER_PUBLIC
+  std::vector<std::string> get_declared_classes();
+
+  /**
+   * @brief load_library_for_class Opens the library of a type, which stays open until reload()
+   * @throw pluginlib::PluginlibException if the library could not be loaded
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  void load_library_for_class(const std::string & controller_type);
+
+  /**
+   * @brief bind_library_now Opens the library of a type with its symbols bound immediately,
+   * rather than on their first call, e.g. in the first update of the controller
+   * Must be called before the library is first opened, by create() or load_library_for_class(),
+   * the binding of an already opened library does not change. The library stays open until
+   * reload().
+   * @return false if the library could not be found or opened, it is then bound lazily
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  bool bind_library_now(const std::string & controller_type);
+
+  /**
+   * @brief reload Recreates the pluginlib loader, closing the libraries no controller uses
+   * @warning The controllers created by the previous loader should be destroyed before
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  void reload();
+
+private:
+  std::mutex mutex_;
+  std::shared_ptr<pluginlib::ClassLoader<controller_interface::ControllerInterface>> loader_;
+  /// Handles of the libraries opened by bind_library_now(), by path
+  std::map<std::string, void *> bound_libraries_;
+};
+
+}  // namespace controller_manager
+
+#endif  // CONTROLLER_MANAGER__CONTROLLER_LOADER_HPP_
@@ -15,17 +15,37 @@
 #ifndef CONTROLLER_MANAGER__CONTROLLER_MANAGER_HPP_
 #define CONTROLLER_MANAGER__CONTROLLER_MANAGER_HPP_
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 
 #include "controller_interface/controller_interface.hpp"
 
+#include "controller_manager/controller_group_thread.hpp"
+#include "controller_manager/controller_loader.hpp"
+#include "controller_manager/controller_node_executor.hpp"
 #include "controller_manager/controller_spec.hpp"
+#include "controller_manager/controller_worker_pool.hpp"
+#include "controller_manager/cycle_timing.hpp"
+#include "controller_manager/dynamic_joint_state_broadcaster.hpp"
+#include "controller_manager/flight_recorder.hpp"
+#include "controller_manager/resource_conflict_checker.hpp"
 #include "controller_manager/visibility_control.h"
+#include "controller_manager_msgs/msg/controller_list.hpp"
+#include "controller_manager_msgs/msg/controller_state.hpp"
+#include "controller_manager_msgs/srv/dump_flight_record.hpp"
 #include "controller_manager_msgs/srv/list_controllers.hpp"
 #include "controller_manager_msgs/srv/list_controller_types.hpp"
+#include "controller_manager_msgs/srv/load_and_start_controllers.hpp"
 #include "controller_manager_msgs/srv/load_controller.hpp"
 #include "controller_manager_msgs/srv/reload_controller_libraries.hpp"
 #include "controller_manager_msgs/srv/switch_controller.hpp"
@@ -33,8 +53,6 @@
 
 #include "hardware_interface/robot_hardware.hpp"
 
-#include "pluginlib/class_loader.hpp"
-
 #include "rclcpp/executor.hpp"
 #include "rclcpp/node.hpp"
 
@@ -47,11 +65,17 @@ public:
   static constexpr bool WAIT_FOR_ALL_RESOURCES = false;
   static constexpr double INFINITE_TIMEOUT = 0.0;
 
+  /**
+   * @param loader Loader of the controller plugins, which may be shared with the other controller
+   * managers of the process, null to create one for this controller manager only. The libraries
+   * of a shared loader are not reloaded by the reload_controller_libraries service.
+   */
   CONTROLLER_MANAGER_PUBLIC
   ControllerManager(
     std::shared_ptr<hardware_interface::RobotHardware> hw,
     std::shared_ptr<rclcpp::Executor> executor,
-    const std::string & name = "controller_manager");
+    const std::string & name = "controller_manager",
+    std::shared_ptr<ControllerLoader> loader = nullptr);
 
   CONTROLLER_MANAGER_PUBLIC
   virtual
@@ -71,6 +95,42 @@ public:
   load_controller(
     const std::string & controller_name);
 
+  /**
+   * @brief load_controllers loads several controllers by name, the types must be defined in the
+   * parameter server. The controllers are created and configured in parallel, and then added to
+   * the controllers list in a single update
+   * @return The loaded controllers in the order of controller_names, null if one failed to load
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  std::vector<controller_interface::ControllerInterfaceSharedPtr>
+  load_controllers(const std::vector<std::string> & controller_names);
+
+  /**
+   * @brief preload_controller_libraries Opens the libraries of all the declared controller types,
+   * which stay open until the libraries are reloaded, so that loading a controller does not wait
+   * for its library to be opened
+   * Also done when constructed and after reloading the libraries if the
+   * preload_controller_libraries parameter is set.
+   * @return ERROR if the library of a declared type could not be opened
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  controller_interface::return_type preload_controller_libraries();
+
+  /**
+   * @brief load_and_start_controllers Loads several controllers with load_controllers() and
+   * starts them with a single switch_controller(), so bringing up a set of controllers takes a
+   * single update of the controllers list and a single switch in the real-time thread
+   * With STRICT, no controller is started if any of them fails to load.
+   * @see Documentation in controller_manager_msgs/LoadAndStartControllers.srv
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  controller_interface::return_type
+  load_and_start_controllers(
+    const std::vector<std::string> & controller_names,
+    int strictness,
+    bool start_asap = WAIT_FOR_ALL_RESOURCES,
+    const rclcpp::Duration & timeout = rclcpp::Duration(INFINITE_TIMEOUT));
+
   CONTROLLER_MANAGER_PUBLIC
   controller_interface::return_type unload_controller(
     const std::string & controller_name);
@@ -78,6 +138,30 @@ public:
   CONTROLLER_MANAGER_PUBLIC
   std::vector<ControllerSpec> get_loaded_controllers() const;
 
+  /// Metadata of the loaded controllers, as listed by the ListControllers service
+  struct ControllersSnapshot
+  {
+    /// Incremented each time the snapshot is rebuilt
+    uint64_t version = 0;
+    /// The loaded controllers, their update timing is not filled in
+    std::vector<controller_manager_msgs::msg::ControllerState> controllers;
+    /// The timing of the updates of each controller, to be aggregated when listed
+    std::vector<std::shared_ptr<TimingProbe>> update_timing;
+    /// The CPU budget of each controller, its counters read when listed
+    std::vector<std::shared_ptr<ControllerCpuBudget>> cpu_budget;
+    /// The accounting of each controller, its counters read when listed
+    std::vector<std::shared_ptr<ControllerAccounting>> accounting;
+  };
+
+  /**
+   * @brief get_controllers_snapshot Immutable snapshot of the loaded controllers, rebuilt and
+   * published on the ~/controllers topic each time a controller is loaded, unloaded, started or
+   * stopped by the controller manager
+   * Does not lock the controllers, so monitors polling it do not contend with the switches.
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  std::shared_ptr<const ControllersSnapshot> get_controllers_snapshot() const;
+
   template<
     typename T,
     typename std::enable_if<std::is_convertible<
@@ -107,26 +191,360 @@ public:
     bool start_asap = WAIT_FOR_ALL_RESOURCES,
     const rclcpp::Duration & timeout = rclcpp::Duration(INFINITE_TIMEOUT));
 
+  /**
+   * @brief set_controllers_standby Puts inactive controllers in standby, or takes them out of it
+   * A controller in standby is activated, and then its update_standby() is called in each cycle
+   * after the updates of the running controllers, which keeps its state and its memory warm
+   * without writing any command. Starting it with switch_controller() then does not activate it:
+   * it is promoted from standby to running by the cycle applying the switch, which stops the
+   * outgoing controllers and calls its on_takeover() at once, so that it is updated with their
+   * last commands on the next cycle. A controller stopped afterwards is deactivated, not put back
+   * in standby.
+   * @param controller_names The controllers to put in standby, or to take out of it
+   * @param standby Whether to put them in standby, or to deactivate them
+   * @return ERROR if a controller is not loaded, is running or could not be activated, the other
+   * controllers are still put in or taken out of standby
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  controller_interface::return_type
+  set_controllers_standby(const std::vector<std::string> & controller_names, bool standby);
+
+  /**
+   * @brief update Updates the running controllers, sampling the time of the cycle itself
+   * The time is taken from the steady clock, and the period is the time elapsed since the previous
+   * call, zero on the first one. Prefer update(time, period) when the caller samples the time.
+   */
   CONTROLLER_MANAGER_PUBLIC
   controller_interface::return_type
   update();
 
+  /**
+   * @brief update Updates the running controllers with the time sampled once for the whole cycle
+   * @param time Time at the start of the control cycle, given as is to every controller
+   * @param period Time elapsed since the previous cycle, multiplied by the update period of the
+   * controllers updated less often than the controller manager
+   * The updates of the controllers with a CPU budget are measured with the CPU clock of the
+   * thread updating them, and their overrun policy is applied on a sustained overrun, see
+   * get_cpu_budget_options().
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  controller_interface::return_type
+  update(const rclcpp::Time & time, const rclcpp::Duration & period);
+
+  /**
+   * @brief enable_stepping Switches to the stepped mode, in which the thread calling step() runs
+   * the whole control cycle, reading and writing the hardware included, at the simulated time it
+   * advances, e.g. to run simulations faster than real time
+   * The switches, loads and unloads are then applied right away in the calling thread instead of
+   * waiting for the next cycle, and the controllers are updated in the calling thread.
+   * @param start_time Simulated time the first step() advances from
+   * @warning Should be called before the first cycle, the calls to the controller manager should
+   * then never be concurrent, e.g. all come from the same thread, which neither sleeps nor polls
+   * for another one
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  void enable_stepping(const rclcpp::Time & start_time);
+
+  CONTROLLER_MANAGER_PUBLIC
+  bool is_stepping() const;
+
+  /**
+   * @brief step Advances the simulated time by dt and runs one control cycle at the new time: reads
+   * the hardware, updates the running controllers with period dt and writes the hardware
+   * @return ERROR if not in the stepped mode, or if the hardware or a controller failed
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  controller_interface::return_type step(const rclcpp::Duration & dt);
+
+  /// Simulated time of the last cycle run by step(), the start time before the first one
+  CONTROLLER_MANAGER_PUBLIC
+  rclcpp::Time get_step_time() const;
+
+  /**
+   * @brief set_update_threads Sets the number of worker threads updating, in parallel with the
+   * thread calling update(), the running controllers which do not claim any common resource
+   * Also set from the update_threads and update_threads_priority parameters when constructed.
+   * @param thread_count Number of worker threads, 0 to update all the controllers in update()
+   * @param priority SCHED_FIFO priority of the worker threads, 0 to keep the default scheduling
+   * @warning Should not be called while update() is running
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  void set_update_threads(size_t thread_count, int priority = 0);
+
+  /**
+   * @brief add_controller_group Adds a controller group, whose controllers are updated by a
+   * worker thread of its own, in parallel with the other groups of the same order and with the
+   * thread calling update(), which updates the controllers out of any group
+   * A controller is put in a group by its <controller_name>.group parameter when loaded. In a
+   * group, the controllers are updated in turn. The groups of an order are all done before the
+   * groups of the next order start, and all the groups are done before update() returns, so
+   * before the hardware is written. The order of the groups comes before the order of the chained
+   * controllers. In the stepped mode, the controllers are all updated in the calling thread.
+   * Also set from the controller_groups parameter, and the <group_name>.cpus,
+   * <group_name>.priority and <group_name>.order parameters, when constructed.
+   * @param name Name of the group
+   * @param options Placement of the worker thread of the group, and of the group in the cycle
+   * @return ERROR if there is a group of that name, or if a controller is loaded
+   * @warning Should not be called while update() is running
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  controller_interface::return_type
+  add_controller_group(const std::string & name, const ControllerGroupOptions & options);
+
+  /**
+   * @brief set_controller_executor Serves the callbacks of the controller nodes on a dedicated
+   * multi-threaded executor, instead of the executor given when constructed, which keeps serving
+   * the services of the controller manager
+   * Also set from the controller_executor_threads and controller_executor_cpus parameters when
+   * constructed.
+   * @param thread_count Number of threads of the dedicated executor, 0 to add the controller
+   * nodes to the executor given when constructed
+   * @param cpus CPUs the threads of the dedicated executor may run on, empty for any CPU
+   * @return ERROR if a controller is loaded, its node would be left on the previous executor
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  controller_interface::return_type
+  set_controller_executor(size_t thread_count, const std::vector<int> & cpus = {});
+
+  /**
+   * @brief get_controller_executor The executor the controller nodes are added to, either the
+   * dedicated one or the one given when constructed
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  std::shared_ptr<rclcpp::Executor> get_controller_executor() const;
+
+  /**
+   * @brief get_cycle_timing Timing of the phases of the control cycle, the update and
+   * manage_switch phases are recorded by update(), the read and write phases and the overruns
+   * by the thread driving the cycle, e.g. a RealtimeControlLoop
+   * Only recorded if the controller manager is built with CONTROLLER_MANAGER_CYCLE_TIMING.
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  CycleTiming & get_cycle_timing();
+
+  /**
+   * @brief set_flight_recorder Records each cycle, at the end of update(), into a flight recorder,
+   * which is dumped when a controller fails and when the dump_flight_record service is called
+   * Also set from the flight_recorder_cycles and flight_recorder_directory parameters when
+   * constructed.
+   * @param recorder The recorder, configured with the hardware if it is not yet, null to stop
+   * recording
+   * @return ERROR if the recorder could not be configured, it is then not set
+   * @warning Should not be called while update() is running
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  controller_interface::return_type
+  set_flight_recorder(std::shared_ptr<FlightRecorder> recorder);
+
+  CONTROLLER_MANAGER_PUBLIC
+  std::shared_ptr<FlightRecorder> get_flight_recorder() const;
+
+  /**
+   * @brief set_joint_state_broadcaster Broadcasts the state interfaces of the joints, captured at
+   * the end of update(), on the ~/joint_state_layout and ~/joint_state_values topics
+   * Also set from the joint_state_broadcast_decimation, joint_state_broadcast_threshold and
+   * joint_state_broadcast_keyframe_interval parameters when constructed.
+   * @param broadcaster The broadcaster, configured with the hardware and the publishers of this
+   * node if it is not yet, null to stop broadcasting
+   * @return ERROR if the broadcaster could not be configured, it is then not set
+   * @warning Should not be called while update() is running
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  controller_interface::return_type
+  set_joint_state_broadcaster(std::shared_ptr<DynamicJointStateBroadcaster> broadcaster);
+
+  CONTROLLER_MANAGER_PUBLIC
+  std::shared_ptr<DynamicJointStateBroadcaster> get_joint_state_broadcaster() const;
+
+  /**
+   * @brief set_update_cpu_budget Sets the CPU time allowed for the updates of all the controllers
+   * of a cycle, summed over the threads updating them
+   * When the updates overrun it in a sustained way, the policy of the controller of the lowest
+   * priority with a CPU budget of its own is applied, one controller per sustained overrun, so
+   * that the controllers of higher priority keep running. Controllers without a budget of their
+   * own are never degraded.
+   * Also set from the update_cpu_budget_us parameter when constructed.
+   * @param budget The budget, 0 to not budget the updates as a whole
+   * @warning Should not be called while update() is running
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  void set_update_cpu_budget(std::chrono::nanoseconds budget);
+
+  /**
+   * @brief set_controller_accounting Sets whether the CPU time of each update and the blocks it
+   * takes from the realtime memory pools are accounted to its controller, as listed in the
+   * resource_usage of the ListControllers service
+   * Measuring the CPU time reads the CPU clock of the thread twice per update.
+   * Also set from the controller_accounting parameter when constructed, on by default.
+   * @warning Should not be called while update() is running
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  void set_controller_accounting(bool enabled);
+
 protected:
+  /**
+   * @brief A switch request queued by switch_controller() and applied by the real-time thread
+   * in manage_switch(), all the requests queued are applied in the same update cycle
+   */
+  struct SwitchRequest
+  {
+    /// Controllers to stop and to start, resolved and validated when the switch is requested, so
+    /// that the real-time thread only flips their running flags
+    std::vector<ControllerSpec> stop_controllers;
+    std::vector<ControllerSpec> start_controllers;
+    /// Running controllers both stopped and started, stopped by the real-time thread and started
+    /// again by a second request, once their lifecycle went through deactivate and activate
+    std::vector<ControllerSpec> restart_controllers;
+    /// Controllers put in and taken out of standby, their standby flag flipped by the real-time
+    /// thread
+    std::vector<ControllerSpec> enter_standby_controllers;
+    std::vector<ControllerSpec> leave_standby_controllers;
+    bool done = {false};
+    bool started = {false};
+    /// Set in the stepped mode when the hardware did not finish switching in the cycle the switch
+    /// was applied in, nothing would advance it, so it is aborted as timed out
+    bool expired = {false};
+    rclcpp::Time init_time = {rclcpp::Time::max()};
+
+    // Switch options
+    int strictness = {0};
+    bool start_asap = {false};
+    rclcpp::Duration timeout = rclcpp::Duration{0, 0};
+
+    /// Controllers actually started and stopped, for the hardware to switch their interfaces
+    std::vector<hardware_interface::ControllerInfo> switch_start_list;
+    std::vector<hardware_interface::ControllerInfo> switch_stop_list;
+    /// Joint values claimed by the controllers active once the switch is done, handed to the
+    /// hardware when it switched, empty if they are not known
+    std::vector<uint64_t> claimed_joint_values;
+    /// Set by the real-time thread, ERROR if the hardware failed to switch
+    controller_interface::return_type result = controller_interface::return_type::SUCCESS;
+    /// Controllers of start_controllers started or aborted, when starting them as soon as possible
+    std::vector<bool> start_finished;
+
+    /// Phases of the switch, for latency reporting
+    std::chrono::steady_clock::time_point requested_time;
+    std::chrono::steady_clock::time_point applied_time;
+    /// Set by the real-time thread once the switch is done, the requesting thread is then woken
+    /// through applied_switch_requests_: a promise would make the real-time thread take a lock
+    std::atomic<bool> applied{false};
+
+    /// Whether the hardware took longer than the timeout to switch, never if the timeout is 0
+    bool timed_out(std::chrono::steady_clock::time_point now) const
+    {
+      return expired || (timeout.nanoseconds() > 0 &&
+             now - requested_time > std::chrono::nanoseconds(timeout.nanoseconds()));
+    }
+  };
+
   CONTROLLER_MANAGER_PUBLIC
   controller_interface::ControllerInterfaceSharedPtr
   add_controller_impl(const ControllerSpec & controller);
 
+  /**
+   * @brief add_configured_controllers Adds controllers already initialized and configured to the
+   * controllers list, with a single switch of the list used by the real-time thread
+   * @return The added controllers, null for the ones with the name of a loaded controller
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  std::vector<controller_interface::ControllerInterfaceSharedPtr>
+  add_configured_controllers(const std::vector<ControllerSpec> & controllers);
+
+  /**
+   * @brief get_update_period Number of updates of the controller manager between two updates of
+   * the controller, from the <controller_name>.update_rate and update_rate parameters in Hz
+   * @return 1 if the controller is updated on every update of the controller manager
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  unsigned int get_update_period(const std::string & controller_name);
+
+  /**
+   * @brief get_update_phase Chooses the phase of a controller updated every update_period updates
+   * of the controller manager, so that it is updated along as few of the other controllers
+   * as possible
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  static unsigned int get_update_phase(
+    const std::vector<ControllerSpec> & controllers, unsigned int update_period);
+
+  /**
+   * @brief get_cpu_budget_options CPU budget of the updates of a controller, from the
+   * <controller_name>.cpu_budget_us, <controller_name>.overrun_policy,
+   * <controller_name>.overrun_limit and <controller_name>.priority parameters
+   * @return Options without a budget if <controller_name>.cpu_budget_us is not set
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  ControllerCpuBudgetOptions get_cpu_budget_options(const std::string & controller_name);
+
+  /**
+   * @brief get_controller_group Controller group of a controller, from the
+   * <controller_name>.group parameter
+   * @return Index of the group plus one, 0 if the parameter is not set or names no group
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  size_t get_controller_group(const std::string & controller_name);
+
+  /**
+   * @brief get_warm_up_updates Dry-run updates of a controller each time it is started, from the
+   * <controller_name>.warm_up_updates parameter
+   * @return 0 if the parameter is not set, the controller is then not warmed up
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  unsigned int get_warm_up_updates(const std::string & controller_name);
+
+  /**
+   * @brief bind_controller_library Opens the library of a controller warmed up with its symbols
+   * bound immediately, before the controller is created from it
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  void bind_controller_library(
+    const std::string & controller_name, const std::string & controller_type);
+
+  /**
+   * @brief warm_up_controller Runs the dry-run updates of an activated controller, spaced by its
+   * update period, before the real-time thread starts updating it
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  void warm_up_controller(const ControllerSpec & controller);
+
+  /**
+   * @brief get_claimed_joint_values Joint values read and written by the controllers active once
+   * a switch is done
+   * @return The bits of the joint arena of the hardware, empty if the values claimed by some of
+   * the controllers are not known
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  std::vector<uint64_t> get_claimed_joint_values(const SwitchRequest & request);
+
+  /**
+   * @brief queue_switch_request Queues a switch for the real-time thread and waits until it is
+   * applied
+   * @return The result of the switch, ERROR if the context is shut down while waiting
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  controller_interface::return_type queue_switch_request(
+    const std::shared_ptr<SwitchRequest> & switch_request);
+
+  /**
+   * @brief complete_switch Runs, in the thread which requested it, the lifecycle transitions left
+   * over by a switch applied by the real-time thread: deactivates the stopped controllers and the
+   * ones which failed to start, and deactivates and activates the restarted ones
+   * @return The request starting the restarted controllers again, null if there is none
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  std::shared_ptr<SwitchRequest> complete_switch(const SwitchRequest & switch_request);
+
   CONTROLLER_MANAGER_PUBLIC
   void manage_switch();
 
   CONTROLLER_MANAGER_PUBLIC
-  void stop_controllers();
+  void stop_controllers(SwitchRequest & request);
 
   CONTROLLER_MANAGER_PUBLIC
-  void start_controllers();
+  void start_controllers(SwitchRequest & request);
 
   CONTROLLER_MANAGER_PUBLIC
-  void start_controllers_asap();
+  void start_controllers_asap(SwitchRequest & request);
 
   CONTROLLER_MANAGER_PUBLIC
   void list_controllers_srv_cb(
@@ -138,6 +556,11 @@ protected:
     const std::shared_ptr<controller_manager_msgs::srv::ListControllerTypes::Request> request,
     std::shared_ptr<controller_manager_msgs::srv::ListControllerTypes::Response> response);
 
+  CONTROLLER_MANAGER_PUBLIC
+  void load_and_start_controllers_service_cb(
+    const std::shared_ptr<controller_manager_msgs::srv::LoadAndStartControllers::Request> request,
+    std::shared_ptr<controller_manager_msgs::srv::LoadAndStartControllers::Response> response);
+
   CONTROLLER_MANAGER_PUBLIC
   void load_controller_service_cb(
     const std::shared_ptr<controller_manager_msgs::srv::LoadController::Request> request,
@@ -158,12 +581,80 @@ protected:
     const std::shared_ptr<controller_manager_msgs::srv::UnloadController::Request> request,
     std::shared_ptr<controller_manager_msgs::srv::UnloadController::Response> response);
 
+  CONTROLLER_MANAGER_PUBLIC
+  void dump_flight_record_service_cb(
+    const std::shared_ptr<controller_manager_msgs::srv::DumpFlightRecord::Request> request,
+    std::shared_ptr<controller_manager_msgs::srv::DumpFlightRecord::Response> response);
+
 private:
   std::vector<std::string> get_controller_names();
 
+  /// Rebuilds the snapshot of the loaded controllers and publishes it
+  void update_controllers_snapshot();
+
+  /// The <controller_name>.type parameter, empty if it is not defined
+  std::string get_controller_type(const std::string & controller_name);
+
   std::shared_ptr<hardware_interface::RobotHardware> hw_;
   std::shared_ptr<rclcpp::Executor> executor_;
-  std::shared_ptr<pluginlib::ClassLoader<controller_interface::ControllerInterface>> loader_;
+  /// Serves the controller nodes when set, protected by the controllers lock
+  std::unique_ptr<ControllerNodeExecutor> controller_executor_;
+  /// Serializes its own use, when loading in parallel or shared with other controller managers
+  std::shared_ptr<ControllerLoader> loader_;
+  /// Whether the controller libraries are opened when constructed and reloaded
+  bool preload_libraries_ = false;
+
+  /// A running controller in the schedule of the real-time thread
+  struct ScheduledController
+  {
+    controller_interface::ControllerInterface * controller;
+    const hardware_interface::ControllerInfo * info;
+    unsigned int update_period;
+    unsigned int update_phase;
+    TimingProbe * update_timing;
+    ControllerCpuBudget * cpu_budget;
+    ControllerAccounting * accounting;
+    /// Null if the controller is updated even when its inputs do not change
+    ControllerInputTracker * input_tracker;
+    /// Index of the controller group updating the controller plus one, 0 for none
+    size_t group;
+    /// Order of the controller group in the cycle
+    int group_order;
+    /// Duration of the last update, only measured for the flight recorder
+    int64_t update_duration_ns;
+    /// CPU time of the last update, only measured against a budget or for the accounting
+    int64_t cpu_time_ns;
+    /// Whether the last update due was left out by the CPU budget policy
+    bool skipped;
+    /// Whether the last update due was left out as the inputs of the controller did not change
+    bool unchanged;
+    /// Whether the controller is in standby, and shadow updated
+    bool standby;
+    /// Controllers of the same stage do not claim common resources and are updated in parallel
+    size_t stage;
+    controller_interface::return_type result;
+  };
+
+  /**
+   * @brief degrade_overrunning_update Applies the policy of the budgeted controller of lowest
+   * priority when the CPU time of the updates of the controllers overran update_cpu_budget_ns_
+   * for a few cycles in a row, real-time safe
+   */
+  void degrade_overrunning_update(std::vector<ScheduledController> & active_controllers);
+
+  /**
+   * @brief update_hardware_freshness Determines the stale hardware components of the cycle, for
+   * the controllers to test their inputs, and warns about the components turning stale,
+   * real-time safe
+   */
+  void update_hardware_freshness(hardware_interface::HardwareFreshness & freshness);
+
+  /**
+   * @brief claims_conflict Whether two controllers claim a common resource, or at least one of
+   * them does not declare its claimed resources, and may use any resource
+   */
+  static bool claims_conflict(
+    const hardware_interface::ControllerInfo & a, const hardware_interface::ControllerInfo & b);
 
   /**
    * @brief The RTControllerListWrapper class wraps a double-buffered list of controllers
@@ -175,12 +666,21 @@ private:
    *
    * The updated state changes on the switch_updated_list()
    * The rt usage state changes on the update_and_get_used_by_rt_list()
+   *
+   * The RT thread never blocks, it claims the updated list with a bounded number of atomic
+   * operations and wakes up the non-RT thread waiting for it to release the other list.
+   * Retired lists are destroyed in a background reclaimer thread, so the non-RT thread does not
+   * pay for the destruction of unloaded controllers.
    */
   class RTControllerListWrapper
   {
 // *INDENT-OFF*
   public:
 // *INDENT-ON*
+    RTControllerListWrapper();
+
+    ~RTControllerListWrapper();
+
     /**
      * @brief update_and_get_used_by_rt_list Makes the "updated" list the "used by rt" list
      * @warning Should only be called by the RT thread, no one should modify the
@@ -189,6 +689,26 @@ private:
      */
     std::vector<ControllerSpec> & update_and_get_used_by_rt_list();
 
+    /**
+     * @brief get_rt_active_controllers Returns the flat schedule of running controllers
+     * of the "used by rt" list, rebuilding it only if the "used by rt" list changed
+     * or the schedule was invalidated since the last call.
+     * The schedule is sorted by stage: a controller is in a later stage than all the controllers
+     * loaded before it it conflicts with, so conflicting controllers are updated in load order.
+     * The rebuild does not allocate, the capacity is reserved by switch_updated_list()
+     * @warning Should only be called by the RT thread
+     * @return reference to the schedule of running controllers
+     */
+    std::vector<ScheduledController> & get_rt_active_controllers();
+
+    /**
+     * @brief invalidate_rt_active_controllers Forces a rebuild of the schedule of running
+     * controllers in the next get_rt_active_controllers() call, needed after starting or
+     * stopping controllers
+     * @warning Should only be called by the RT thread
+     */
+    void invalidate_rt_active_controllers();
+
     /**
      * @brief get_unused_list Waits until the "outdated" and "unused by rt"
      * lists match and returns a reference to it
@@ -214,6 +734,25 @@ private:
      */
     void switch_updated_list(const std::lock_guard<std::recursive_mutex> & guard);
 
+    /**
+     * @brief retire_unused_list Hands the contents of the "unused by rt" list over to the
+     * reclaimer thread, which destroys them in the background
+     * @param guard Guard needed to make sure the caller is the only one accessing the unused by rt list
+     */
+    void retire_unused_list(const std::lock_guard<std::recursive_mutex> & guard);
+
+    /**
+     * @brief wait_until_reclaimed Blocks until the reclaimer thread has destroyed all the
+     * retired lists, e.g. before unloading the libraries the controllers were created from
+     */
+    void wait_until_reclaimed();
+
+    /**
+     * @brief set_stepped In the stepped mode, the RT thread is the non-RT one, so it takes the
+     * updated list over itself instead of waiting for the next cycle
+     */
+    void set_stepped(bool stepped);
+
     // Mutex protecting the controllers list
     // must be acquired before using any list other than the "used by rt"
     mutable std::recursive_mutex controllers_lock_;
@@ -226,15 +765,41 @@ private:
      */
     int get_other_list(int index) const;
 
+    /**
+     * @brief wait_until_rt_not_using Blocks until the RT thread switches away from the list
+     * @param index List the RT thread should not be using
+     * @param wakeup_period Upper bound to re-check the RT thread usage in case a notification
+     * from the RT thread is missed, it does not lock the mutex when notifying
+     */
     void wait_until_rt_not_using(
       int index,
-      std::chrono::microseconds sleep_delay = std::chrono::microseconds(200)) const;
+      std::chrono::microseconds wakeup_period = std::chrono::microseconds(1000));
+
+    void reclaimer_loop();
 
     std::vector<ControllerSpec> controllers_lists_[2];
+    /// Schedule of the running controllers of each list, only used in the real-time thread.
+    std::vector<ScheduledController> active_controllers_lists_[2];
     /// The index of the controller list with the most updated information
-    int updated_controllers_index_ = 0;
+    std::atomic<int> updated_controllers_index_{0};
     /// The index of the controllers list being used in the real-time thread.
-    int used_by_realtime_controllers_index_ = -1;
+    std::atomic<int> used_by_realtime_controllers_index_{-1};
+    /// The index of the list the active controllers schedule was built from, -1 if outdated.
+    int active_controllers_index_ = -1;
+    /// Set once before the first cycle, see ControllerManager::enable_stepping()
+    bool stepped_ = false;
+
+    /// Notified by the RT thread when it starts using a different list
+    mutable std::mutex rt_switch_mutex_;
+    mutable std::condition_variable rt_switch_cv_;
+
+    /// Lists removed from the double buffer, waiting to be destroyed by the reclaimer thread
+    std::list<std::vector<ControllerSpec>> retired_lists_;
+    bool reclaiming_ = false;
+    bool stop_reclaimer_ = false;
+    std::mutex reclaimer_mutex_;
+    std::condition_variable reclaimer_cv_;
+    std::thread reclaimer_thread_;
   };
 
   RTControllerListWrapper rt_controllers_wrapper_;
@@ -245,6 +810,8 @@ private:
     list_controllers_service_;
   rclcpp::Service<controller_manager_msgs::srv::ListControllerTypes>::SharedPtr
     list_controller_types_service_;
+  rclcpp::Service<controller_manager_msgs::srv::LoadAndStartControllers>::SharedPtr
+    load_and_start_controllers_service_;
   rclcpp::Service<controller_manager_msgs::srv::LoadController>::SharedPtr
     load_controller_service_;
   rclcpp::Service<controller_manager_msgs::srv::ReloadControllerLibraries>::SharedPtr
@@ -253,25 +820,58 @@ private:
     switch_controller_service_;
   rclcpp::Service<controller_manager_msgs::srv::UnloadController>::SharedPtr
     unload_controller_service_;
-
-  std::vector<std::string> start_request_, stop_request_;
-#ifdef TODO_IMPLEMENT_RESOURCE_CHECKING
-//  std::list<hardware_interface::ControllerInfo> switch_start_list_, switch_stop_list_;
-#endif
-
-  struct SwitchParams
-  {
-    bool do_switch = {false};
-    bool started = {false};
-    rclcpp::Time init_time = {rclcpp::Time::max()};
-
-    // Switch options
-    int strictness = {0};
-    bool start_asap = {false};
-    rclcpp::Duration timeout = rclcpp::Duration{0, 0};
-  };
-
-  SwitchParams switch_params_;
+  rclcpp::Service<controller_manager_msgs::srv::DumpFlightRecord>::SharedPtr
+    dump_flight_record_service_;
+
+  /// Only accessed through the atomic operations on shared pointers, rebuilt with the
+  /// controllers lock held so that the versions are published in order
+  std::shared_ptr<const ControllersSnapshot> controllers_snapshot_;
+  rclcpp::Publisher<controller_manager_msgs::msg::ControllerList>::SharedPtr
+    controllers_publisher_;
+
+  /// Interns the interfaces claimed by the controllers, protected by the controllers lock
+  ResourceConflictChecker resource_conflict_checker_;
+
+  /// Switch requests queued by switch_controller(), protected by switch_requests_lock_
+  std::mutex switch_requests_lock_;
+  std::vector<std::shared_ptr<SwitchRequest>> pending_switch_requests_;
+  std::atomic<bool> has_pending_switch_requests_{false};
+  /// Switch requests the requesting thread stopped waiting for at shutdown, kept until they are
+  /// applied so that the real-time thread never destroys them, protected by switch_requests_lock_
+  std::vector<std::shared_ptr<SwitchRequest>> abandoned_switch_requests_;
+  /// Switch requests being applied, only used in the real-time thread
+  std::vector<std::shared_ptr<SwitchRequest>> rt_switch_requests_;
+  /// Incremented by the real-time thread once it set some switch requests applied, and woken with
+  /// a futex, the requesting threads sleep on it
+  std::atomic<uint32_t> applied_switch_requests_{0};
+  /// Number of queued switch requests starting each controller, by name, protected by the
+  /// controllers lock. A stopped controller is not deactivated while another request starts it.
+  std::unordered_map<std::string, size_t> pending_starts_;
+  /// Number of update() calls, only used in the real-time thread to schedule the controllers
+  uint64_t update_count_ = 0;
+  /// Time of the previous update() without time, only used in the real-time thread
+  rclcpp::Time last_update_time_;
+  bool has_last_update_time_ = false;
+  /// Whether step() drives the cycles, and the simulated time of the last one
+  bool stepping_ = false;
+  rclcpp::Time step_time_;
+  /// Workers updating the controllers of the same stage in parallel, null to update them in turn
+  std::unique_ptr<ControllerWorkerPool> update_pool_;
+  /// Threads of the controller groups, only added while no controller is loaded
+  std::vector<std::unique_ptr<ControllerGroupThread>> controller_groups_;
+  CycleTiming cycle_timing_;
+  /// Records the cycles at the end of update() when set
+  std::shared_ptr<FlightRecorder> flight_recorder_;
+  /// Captures the state values at the end of update() when set
+  std::shared_ptr<DynamicJointStateBroadcaster> joint_state_broadcaster_;
+  /// CPU time allowed for the updates of all the controllers of a cycle, 0 if not budgeted
+  int64_t update_cpu_budget_ns_ = 0;
+  /// Whether the CPU time and the pool blocks of each update are accounted to its controller
+  bool controller_accounting_ = true;
+  /// Number of consecutive cycles over update_cpu_budget_ns_, only touched by update()
+  unsigned int update_cpu_overruns_ = 0;
+  /// Stale hardware components as of the previous update(), only touched by update()
+  hardware_interface::HardwareFreshness::ComponentMask stale_hardware_ = 0;
 };
 
 }  // namespace controller_manager
@@ -0,0 +1,96 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONTROLLER_MANAGER__CONTROLLER_MANAGER_GROUP_HPP_
+#define CONTROLLER_MANAGER__CONTROLLER_MANAGER_GROUP_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "controller_manager/controller_loader.hpp"
+#include "controller_manager/controller_manager.hpp"
+#include "controller_manager/controller_worker_pool.hpp"
+#include "controller_manager/visibility_control.h"
+
+#include "rclcpp/duration.hpp"
+#include "rclcpp/time.hpp"
+
+namespace controller_manager
+{
+
+/**
+ * @brief The ControllerManagerGroup class steps many controller managers of a process, e.g. one
+ * per simulated robot, on a single set of threads
+ *
+ * The controller managers are in the stepped mode. Each step of the group steps all of them once,
+ * the threads taking the next controller manager not stepped yet as soon as they are done with
+ * the previous one. The controller managers are meant to be constructed with the loader of the
+ * group, so that the controller plugins are loaded once for all of them.
+ */
+class ControllerManagerGroup
+{
+public:
+  /**
+   * @param thread_count Number of worker threads, in addition to the thread calling step()
+   * @param priority SCHED_FIFO priority of the worker threads, 0 to keep the default scheduling
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  explicit ControllerManagerGroup(size_t thread_count, int priority = 0);
+
+  /// The loader shared by the controller managers of the group
+  CONTROLLER_MANAGER_PUBLIC
+  std::shared_ptr<ControllerLoader> get_loader() const;
+
+  /**
+   * @brief add Adds a controller manager, switching it to the stepped mode
+   * @param start_time Simulated time its first step advances from
+   * @return false if it is already in the group
+   * @warning Should not be called while step() is running
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  bool add(
+    const std::shared_ptr<ControllerManager> & controller_manager,
+    const rclcpp::Time & start_time);
+
+  /**
+   * @brief remove Removes a controller manager, which stays in the stepped mode
+   * @return false if it is not in the group
+   * @warning Should not be called while step() is running
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  bool remove(const std::shared_ptr<ControllerManager> & controller_manager);
+
+  CONTROLLER_MANAGER_PUBLIC
+  const std::vector<std::shared_ptr<ControllerManager>> & get_controller_managers() const;
+
+  /**
+   * @brief step Steps every controller manager of the group once by dt, in parallel
+   * The controller managers should not be called from other threads meanwhile.
+   * @return ERROR if any of them failed to step
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  controller_interface::return_type step(const rclcpp::Duration & dt);
+
+private:
+  std::shared_ptr<ControllerLoader> loader_;
+  ControllerWorkerPool pool_;
+  std::vector<std::shared_ptr<ControllerManager>> controller_managers_;
+  /// Result of the last step of each controller manager, sized when they are added
+  std::vector<controller_interface::return_type> results_;
+};
+
+}  // namespace controller_manager
+
+#endif  // CONTROLLER_MANAGER__CONTROLLER_MANAGER_GROUP_HPP_
@@ -0,0 +1,78 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONTROLLER_MANAGER__CONTROLLER_NODE_EXECUTOR_HPP_
+#define CONTROLLER_MANAGER__CONTROLLER_NODE_EXECUTOR_HPP_
+
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "controller_manager/visibility_control.h"
+
+#include "rclcpp/executor.hpp"
+
+namespace controller_manager
+{
+
+/**
+ * @brief The ControllerNodeExecutor class serves the parameter, topic and service callbacks of
+ * the controller nodes on its own threads, so that they neither run in the real-time thread nor
+ * compete with the services of the controller manager.
+ *
+ * A multi-threaded executor is spun from a background thread, restricted to a set of CPUs before
+ * spinning so that all the threads of the executor inherit it.
+ */
+class ControllerNodeExecutor
+{
+public:
+  /**
+   * @param thread_count Number of threads serving the callbacks, at least 1
+   * @param cpus CPUs the threads may run on, empty to keep the affinity of the calling thread
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  ControllerNodeExecutor(size_t thread_count, const std::vector<int> & cpus);
+
+  /// Cancels the executor and waits for its threads to finish the callbacks they are running
+  CONTROLLER_MANAGER_PUBLIC
+  ~ControllerNodeExecutor();
+
+  ControllerNodeExecutor(const ControllerNodeExecutor &) = delete;
+  ControllerNodeExecutor & operator=(const ControllerNodeExecutor &) = delete;
+
+  CONTROLLER_MANAGER_PUBLIC
+  std::shared_ptr<rclcpp::Executor> get_executor() const;
+
+  CONTROLLER_MANAGER_PUBLIC
+  size_t get_thread_count() const;
+
+  CONTROLLER_MANAGER_PUBLIC
+  const std::vector<int> & get_cpus() const;
+
+private:
+  void spin(std::promise<void> finished);
+
+  size_t thread_count_;
+  std::vector<int> cpus_;
+  std::shared_ptr<rclcpp::Executor> executor_;
+  /// Ready once the executor stopped spinning
+  std::future<void> spin_finished_;
+  std::thread spinner_;
+};
+
+}  // namespace controller_manager
+
+#endif  // CONTROLLER_MANAGER__CONTROLLER_NODE_EXECUTOR_HPP_
@@ -19,10 +19,17 @@
 #ifndef CONTROLLER_MANAGER__CONTROLLER_SPEC_HPP_
 #define CONTROLLER_MANAGER__CONTROLLER_SPEC_HPP_
 
+#include <atomic>
+#include <cstdint>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include "controller_interface/controller_interface.hpp"
+#include "controller_manager/controller_accounting.hpp"
+#include "controller_manager/controller_cpu_budget.hpp"
+#include "controller_manager/controller_input_tracker.hpp"
+#include "controller_manager/cycle_timing.hpp"
 #include "hardware_interface/controller_info.hpp"
 
 namespace controller_manager
@@ -38,6 +45,38 @@ struct ControllerSpec
 {
   hardware_interface::ControllerInfo info;
   controller_interface::ControllerInterfaceSharedPtr c;
+  /// Number of controller manager updates between two updates of the controller
+  unsigned int update_period = 1;
+  /// Update of the controller manager, modulo update_period, on which the controller is updated
+  unsigned int update_phase = 0;
+  /// Index of the controller group updating the controller plus one, 0 for none
+  size_t group = 0;
+  /// Order of the controller group in the cycle, 0 for none
+  int group_order = 0;
+  /// Dry-run updates of the controller each time it is started, 0 for none
+  unsigned int warm_up_updates = 0;
+  /// Duration of the updates of the controller, shared by the copies of the spec
+  std::shared_ptr<TimingProbe> update_timing;
+  /// CPU time of the updates of the controller against its budget, shared by the copies of the
+  /// spec
+  std::shared_ptr<ControllerCpuBudget> cpu_budget;
+  /// CPU time and pool blocks of the updates of the controller, shared by the copies of the spec
+  std::shared_ptr<ControllerAccounting> accounting;
+  /// Inputs of a deterministic controller, whose updates are skipped while they do not change,
+  /// null if the controller is updated in every cycle, shared by the copies of the spec
+  std::shared_ptr<ControllerInputTracker> input_tracker;
+  /// Whether the controller is updated, shared by the copies of the spec and only flipped by the
+  /// real-time thread when switching, so that it never queries nor changes the lifecycle state.
+  /// The lifecycle is activated before the flag is set and deactivated after it is cleared.
+  std::shared_ptr<std::atomic<bool>> running;
+  /// Whether the controller is in standby, active and shadow updated without being running,
+  /// shared by the copies of the spec and only flipped by the real-time thread
+  std::shared_ptr<std::atomic<bool>> standby;
+  /// Interfaces claimed by the controller, as bits interned by the controller manager
+  std::vector<uint64_t> claim_mask;
+  /// Joint values read and written by the controller, as bits of the joint arena of the robot
+  /// hardware, empty if its registration was not frozen when the controller was loaded
+  std::vector<uint64_t> joint_value_mask;
 };
 
 }  // namespace controller_manager
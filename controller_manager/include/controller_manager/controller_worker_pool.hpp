@@ -0,0 +1,98 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONTROLLER_MANAGER__CONTROLLER_WORKER_POOL_HPP_
+#define CONTROLLER_MANAGER__CONTROLLER_WORKER_POOL_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "controller_manager/visibility_control.h"
+
+namespace controller_manager
+{
+
+/**
+ * @brief The ControllerWorkerPool class runs batches of independent tasks, such as the updates
+ * of controllers which do not share any resource, on a fixed set of threads.
+ *
+ * The calling thread takes part in each batch, and all the threads take the next task of the
+ * batch from a shared index as soon as they are done with the previous one, so that a long task
+ * does not hold back the others. The shared atomic index stands in for per-thread work-stealing
+ * queues: the batches are a few controllers long, and taking a task is a single fetch_add.
+ * Running a batch does not allocate, and the calling thread does not take any lock: the batch is
+ * published with an atomic sequence number, and both the start and the end of the batch are
+ * signalled with futex wakes, so that workers of lower priority never hold a lock it waits for.
+ */
+class ControllerWorkerPool
+{
+public:
+  using Task = void (*)(void * context, size_t index);
+
+  /**
+   * @param thread_count Number of worker threads, in addition to the calling thread
+   * @param priority SCHED_FIFO priority of the worker threads, 0 to keep the default scheduling
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  ControllerWorkerPool(size_t thread_count, int priority);
+
+  CONTROLLER_MANAGER_PUBLIC
+  ~ControllerWorkerPool();
+
+  ControllerWorkerPool(const ControllerWorkerPool &) = delete;
+  ControllerWorkerPool & operator=(const ControllerWorkerPool &) = delete;
+
+  CONTROLLER_MANAGER_PUBLIC
+  size_t get_thread_count() const;
+
+  /**
+   * @brief run Calls task(index) for every index in [0, count), returns once all the calls are done
+   * @warning Should only be called from one thread at a time
+   */
+  template<typename F>
+  void run(size_t count, F & task)
+  {
+    run(count, [](void * context, size_t index) {(*static_cast<F *>(context))(index);}, &task);
+  }
+
+  CONTROLLER_MANAGER_PUBLIC
+  void run(size_t count, Task task, void * context);
+
+private:
+  void worker_loop(uint32_t batch_sequence);
+  void run_tasks();
+
+  std::vector<std::thread> workers_;
+
+  /// Incremented each time a batch starts, the workers sleep on it between the batches
+  std::atomic<uint32_t> batch_sequence_{0};
+  /// Set before a last increment of batch_sequence_, to stop the workers
+  std::atomic<bool> stop_{false};
+
+  // Current batch, written before the batch is started
+  Task task_ = nullptr;
+  void * context_ = nullptr;
+  size_t task_count_ = 0;
+  std::atomic<size_t> next_task_{0};
+  /// Workers done with the current batch, every worker takes part in every batch. run() sleeps on
+  /// it, and is woken by the last worker
+  std::atomic<uint32_t> finished_workers_{0};
+};
+
+}  // namespace controller_manager
+
+#endif  // CONTROLLER_MANAGER__CONTROLLER_WORKER_POOL_HPP_
@@ -0,0 +1,137 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONTROLLER_MANAGER__CYCLE_TIMING_HPP_
+#define CONTROLLER_MANAGER__CYCLE_TIMING_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "controller_manager/visibility_control.h"
+
+namespace controller_manager
+{
+
+struct TimingStatistics
+{
+  /// Number of samples recorded since the probe was created
+  uint64_t count = 0;
+  /// Number of most recent samples the statistics below are computed over
+  uint64_t window = 0;
+  std::chrono::nanoseconds min{0};
+  std::chrono::nanoseconds mean{0};
+  std::chrono::nanoseconds p99{0};
+  std::chrono::nanoseconds max{0};
+};
+
+/**
+ * @brief The TimingProbe class records durations measured in the real-time thread into a
+ * lock-free ring of the most recent samples, which are aggregated on request in a non real-time
+ * thread.
+ *
+ * Recording a sample is wait-free and does not allocate. The oldest samples are overwritten when
+ * the ring is full, so the statistics always cover the latest ones.
+ */
+class TimingProbe
+{
+public:
+  /**
+   * @param capacity Number of most recent samples kept, rounded up to a power of two
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  explicit TimingProbe(size_t capacity = 1024);
+
+  TimingProbe(const TimingProbe &) = delete;
+  TimingProbe & operator=(const TimingProbe &) = delete;
+
+  /**
+   * @brief record Adds a sample to the ring
+   * @warning Should only be called from one thread at a time
+   */
+  void record(std::chrono::nanoseconds duration)
+  {
+    const uint64_t written = written_.load(std::memory_order_relaxed);
+    samples_[written & mask_].store(duration.count(), std::memory_order_relaxed);
+    written_.store(written + 1, std::memory_order_release);
+  }
+
+  /**
+   * @brief get_statistics Aggregates the most recent samples, can be called from any thread
+   * but allocates on the first call
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  TimingStatistics get_statistics();
+
+private:
+  std::vector<std::atomic<int64_t>> samples_;
+  uint64_t mask_;
+  /// Number of samples recorded, the next one is written at written_ & mask_
+  std::atomic<uint64_t> written_{0};
+
+  /// Protects the copy of the samples aggregated by get_statistics()
+  std::mutex window_mutex_;
+  std::vector<int64_t> window_;
+};
+
+/// Probes of the phases of a control cycle, recorded by the thread driving the cycle
+struct CycleTiming
+{
+  TimingProbe read;
+  /// Update of all the running controllers
+  TimingProbe update;
+  TimingProbe manage_switch;
+  TimingProbe write;
+  /// Cycles which ended after the start of the next one
+  std::atomic<uint64_t> overruns{0};
+};
+
+/// Records the lifetime of the scope into a probe, which may be null
+class ScopedTimingProbe
+{
+public:
+  explicit ScopedTimingProbe(TimingProbe * probe)
+  : probe_(probe), start_(std::chrono::steady_clock::now())
+  {
+  }
+
+  ~ScopedTimingProbe()
+  {
+    if (probe_) {
+      probe_->record(std::chrono::steady_clock::now() - start_);
+    }
+  }
+
+  ScopedTimingProbe(const ScopedTimingProbe &) = delete;
+  ScopedTimingProbe & operator=(const ScopedTimingProbe &) = delete;
+
+private:
+  TimingProbe * probe_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace controller_manager
+
+/// Times the rest of the enclosing scope, compiled out without CONTROLLER_MANAGER_CYCLE_TIMING
+#ifdef CONTROLLER_MANAGER_CYCLE_TIMING
+#define CONTROLLER_MANAGER_TIMING_PROBE(probe) \
+  ::controller_manager::ScopedTimingProbe controller_manager_timing_probe(probe)
+#else
+#define CONTROLLER_MANAGER_TIMING_PROBE(probe)
+#endif
+
+#endif  // CONTROLLER_MANAGER__CYCLE_TIMING_HPP_
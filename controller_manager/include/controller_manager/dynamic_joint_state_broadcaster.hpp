@@ -0,0 +1,169 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONTROLLER_MANAGER__DYNAMIC_JOINT_STATE_BROADCASTER_HPP_
+#define CONTROLLER_MANAGER__DYNAMIC_JOINT_STATE_BROADCASTER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "control_msgs/msg/dynamic_joint_state.hpp"
+
+#include "controller_manager/visibility_control.h"
+#include "controller_manager_msgs/msg/interface_values.hpp"
+
+#include "hardware_interface/robot_hardware.hpp"
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+
+#include "rclcpp/publisher.hpp"
+
+namespace controller_manager
+{
+
+struct DynamicJointStateBroadcasterOptions
+{
+  /// Number of cycles per snapshot of the values, e.g. 10 to broadcast at 100 Hz from 1 kHz
+  size_t decimation = 10;
+  /// Only the values which changed by more than this since they were last sent are sent, 0 to
+  /// send all the values of each snapshot
+  double change_threshold = 0.0;
+  /// Number of snapshots per keyframe, which sends all the values whatever the threshold, so that
+  /// late subscribers and lost messages catch up. 0 to only send a keyframe first.
+  size_t keyframe_interval = 100;
+  /// Period at which the publishing thread checks for a new snapshot
+  std::chrono::nanoseconds poll_period = std::chrono::milliseconds(1);
+};
+
+/**
+ * @brief The DynamicJointStateBroadcaster class publishes the state interfaces of the joints of
+ * the hardware without the real-time thread copying a message
+ *
+ * The names of the joints and of their state interfaces are published once, as a latched
+ * control_msgs::msg::DynamicJointState with the values of when it was configured. Then, every
+ * decimation cycles, capture() copies the state values into a seqlocked snapshot, with atomic
+ * stores only. A background thread picks the snapshots up and publishes their values, as
+ * controller_manager_msgs::msg::InterfaceValues in the order of the layout, or only the ones which
+ * changed by more than the change threshold between two keyframes.
+ */
+class DynamicJointStateBroadcaster
+{
+public:
+  using LayoutPublisher = rclcpp::Publisher<control_msgs::msg::DynamicJointState>;
+  using ValuesPublisher = rclcpp::Publisher<controller_manager_msgs::msg::InterfaceValues>;
+
+  CONTROLLER_MANAGER_PUBLIC
+  explicit DynamicJointStateBroadcaster(
+    const DynamicJointStateBroadcasterOptions & options = DynamicJointStateBroadcasterOptions());
+
+  /// Stops the publishing thread, a snapshot not yet published is dropped
+  CONTROLLER_MANAGER_PUBLIC
+  ~DynamicJointStateBroadcaster();
+
+  DynamicJointStateBroadcaster(const DynamicJointStateBroadcaster &) = delete;
+  DynamicJointStateBroadcaster & operator=(const DynamicJointStateBroadcaster &) = delete;
+
+  /**
+   * @brief configure Publishes the layout of the state values of the joints and starts the
+   * publishing thread
+   * Called in a non real-time thread, before the first capture().
+   * @param hardware The hardware broadcast, its registration must be frozen and it must outlive
+   * this broadcaster
+   * @param layout_publisher The publisher of the layout, latched with a transient local QoS
+   * @param values_publisher The publisher of the values
+   * @return ERROR if the registration of the hardware is not frozen, if a publisher is null or if
+   * the broadcaster is already configured
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  hardware_interface::return_type configure(
+    hardware_interface::RobotHardware & hardware, std::shared_ptr<LayoutPublisher> layout_publisher,
+    std::shared_ptr<ValuesPublisher> values_publisher);
+
+  CONTROLLER_MANAGER_PUBLIC
+  bool is_configured() const;
+
+  CONTROLLER_MANAGER_PUBLIC
+  const DynamicJointStateBroadcasterOptions & get_options() const;
+
+  /// Names of the broadcast values, "joint/interface", in the order of the values
+  CONTROLLER_MANAGER_PUBLIC
+  const std::vector<std::string> & get_value_names() const;
+
+  /**
+   * @brief capture Counts a cycle and takes a snapshot of the state values of the joints every
+   * decimation cycles
+   * Real-time safe, to be called by the thread driving the cycle once the states are read. Does
+   * nothing if the broadcaster is not configured.
+   * @warning Should only be called from one thread at a time
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  void capture(int64_t time_ns);
+
+  /// Number of snapshots taken so far
+  CONTROLLER_MANAGER_PUBLIC
+  uint64_t get_snapshot_count() const;
+
+  /// Number of value messages published so far, keyframes included
+  CONTROLLER_MANAGER_PUBLIC
+  uint64_t get_published_count() const;
+
+  /// Number of keyframes published so far
+  CONTROLLER_MANAGER_PUBLIC
+  uint64_t get_keyframe_count() const;
+
+private:
+  void publish_loop();
+  /// Copies the latest snapshot, false if it is being written or is not newer than snapshot_count
+  bool read_snapshot(
+    uint64_t & snapshot_count, int64_t & time_ns, std::vector<double> & values) const;
+  void publish(uint64_t snapshot_count, int64_t time_ns, const std::vector<double> & values);
+
+  const DynamicJointStateBroadcasterOptions options_;
+
+  const double * state_values_ = nullptr;
+  size_t value_count_ = 0;
+  std::vector<std::string> value_names_;
+  std::shared_ptr<ValuesPublisher> values_publisher_;
+
+  /// Only touched by the capturing thread
+  uint64_t cycle_count_ = 0;
+  /// Odd while the snapshot is being written, the number of snapshots taken is sequence_ / 2
+  std::atomic<uint64_t> sequence_{0};
+  std::atomic<int64_t> snapshot_time_ns_{0};
+  /// The bits of the snapshot values
+  std::unique_ptr<std::atomic<uint64_t>[]> snapshot_;
+
+  /// Only touched by the publishing thread
+  std::vector<double> last_sent_values_;
+  uint64_t published_snapshot_count_ = 0;
+  controller_manager_msgs::msg::InterfaceValues message_;
+  std::atomic<uint64_t> published_count_{0};
+  std::atomic<uint64_t> keyframe_count_{0};
+
+  std::mutex stop_mutex_;
+  std::condition_variable stop_cv_;
+  bool stop_ = false;
+  std::thread publish_thread_;
+};
+
+}  // namespace controller_manager
+
+#endif  // CONTROLLER_MANAGER__DYNAMIC_JOINT_STATE_BROADCASTER_HPP_
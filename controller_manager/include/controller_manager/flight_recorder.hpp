@@ -0,0 +1,196 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONTROLLER_MANAGER__FLIGHT_RECORDER_HPP_
+#define CONTROLLER_MANAGER__FLIGHT_RECORDER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "controller_manager/visibility_control.h"
+
+#include "hardware_interface/flight_record.hpp"
+#include "hardware_interface/robot_hardware.hpp"
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+
+namespace controller_manager
+{
+
+struct FlightRecorderOptions
+{
+  /// Number of most recent cycles kept, e.g. 5000 for the last 5 seconds at 1 kHz
+  size_t cycle_capacity = 5000;
+  /// Number of running controllers recorded in each cycle, the following ones are not recorded
+  size_t controller_capacity = 16;
+  /// Directory of the files dumped without a path
+  std::string directory = ".";
+  /// Minimum interval between two dumps on fault or overrun, the requests in between are ignored
+  std::chrono::nanoseconds min_automatic_dump_interval = std::chrono::seconds(10);
+  /// Period at which the dump thread checks for the dumps requested by request_dump()
+  std::chrono::nanoseconds poll_period = std::chrono::milliseconds(10);
+};
+
+/**
+ * @brief The FlightRecorder class keeps the values of the hardware and the timing of the
+ * controllers of the latest control cycles in a preallocated ring, to dump them to a file on a
+ * fault, an overrun or a request
+ *
+ * Recording a cycle copies the arenas of the hardware and the timing of the running controllers
+ * with memcpy only: it is real-time safe, and never waits for the dumps. Cycles are not recorded
+ * while a dump copies the ring out, which takes about a millisecond for a few seconds of cycles;
+ * the file is then written from the copy while the cycles are recorded again.
+ * Dumps requested from the real-time thread are written by a background thread, which polls for
+ * them, so that the real-time thread never takes a mutex nor makes a system call.
+ * The files are read back with a hardware_interface::FlightRecordReader, the flight_record_dump
+ * tool or the flight_record.py Python module.
+ */
+class FlightRecorder
+{
+public:
+  CONTROLLER_MANAGER_PUBLIC
+  explicit FlightRecorder(const FlightRecorderOptions & options = FlightRecorderOptions());
+
+  /// Stops the dump thread, a dump requested but not yet written is dropped
+  CONTROLLER_MANAGER_PUBLIC
+  ~FlightRecorder();
+
+  FlightRecorder(const FlightRecorder &) = delete;
+  FlightRecorder & operator=(const FlightRecorder &) = delete;
+
+  /**
+   * @brief configure Lays the ring out after the arenas of the hardware and allocates it, and its
+   * copy for the dumps
+   * Called in a non real-time thread, before the first cycle is recorded. The ring is touched
+   * here, so that recording does not page fault.
+   * @param hardware The hardware recorded, its registration must be frozen and it must outlive
+   * this recorder
+   * @return ERROR if the registration of the hardware is not frozen
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  hardware_interface::return_type configure(hardware_interface::RobotHardware & hardware);
+
+  CONTROLLER_MANAGER_PUBLIC
+  bool is_configured() const;
+
+  CONTROLLER_MANAGER_PUBLIC
+  const FlightRecorderOptions & get_options() const;
+
+  /**
+   * @brief begin_cycle Starts recording a cycle, copies the values of the hardware
+   * Real-time safe, to be called by the thread driving the cycle once the controllers updated.
+   * @return The cycle to fill and to pass to end_cycle(), null if the recorder is not configured
+   * or is dumping, the cycle is then not recorded
+   * @warning Should only be called from one thread at a time
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  hardware_interface::FlightRecordCycle * begin_cycle(int64_t time_ns, int64_t period_ns);
+
+  /**
+   * @brief add_controller Records the update of a controller in the cycle, real-time safe
+   * Does nothing once controller_capacity controllers are recorded in the cycle.
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  void add_controller(
+    hardware_interface::FlightRecordCycle * cycle, const std::string & name,
+    int64_t update_duration_ns, uint32_t flags);
+
+  /// Ends recording the cycle, real-time safe
+  CONTROLLER_MANAGER_PUBLIC
+  void end_cycle(hardware_interface::FlightRecordCycle * cycle);
+
+  /**
+   * @brief request_dump Requests a dump, written by the dump thread into the directory of the
+   * options, real-time safe and callable from any thread
+   * The dumps requested on fault or overrun are limited by min_automatic_dump_interval. Only the
+   * first request is kept until the dump thread picks it up.
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  void request_dump(hardware_interface::FlightRecordDumpReason reason);
+
+  /**
+   * @brief dump Writes the recorded cycles to a file, from the calling thread
+   * Called in a non real-time thread, the cycles are not recorded while the ring is copied.
+   * @param path The file, empty for a file named after the current time and the reason in the
+   * directory of the options
+   * @return The path of the file written, empty if it could not be written or if the recorder is
+   * not configured
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  std::string dump(
+    hardware_interface::FlightRecordDumpReason reason, const std::string & path = "");
+
+  /// Number of cycles recorded since configured, the overwritten ones included
+  CONTROLLER_MANAGER_PUBLIC
+  uint64_t get_recorded_cycle_count() const;
+
+  /// Number of files written, by dump() and by the dump thread
+  CONTROLLER_MANAGER_PUBLIC
+  uint64_t get_dump_count() const;
+
+  /// The file last written, empty if none was written yet
+  CONTROLLER_MANAGER_PUBLIC
+  std::string get_last_dump_path() const;
+
+private:
+  void dump_loop();
+  std::string write_file(
+    hardware_interface::FlightRecordDumpReason reason, const std::string & path,
+    uint64_t first_cycle_index, uint64_t cycle_count) const;
+
+  const FlightRecorderOptions options_;
+
+  const double * actuator_values_ = nullptr;
+  size_t actuator_value_count_ = 0;
+  const double * joint_values_ = nullptr;
+  size_t joint_value_count_ = 0;
+  /// Names of the values, as laid out in the files
+  std::string value_names_;
+  size_t cycle_size_ = 0;
+  /// The cycles, 8 byte aligned, cycle written_cycles_ % cycle_capacity is recorded next
+  std::vector<uint64_t> ring_;
+
+  /// Only written by the recording thread
+  std::atomic<uint64_t> written_cycles_{0};
+  /// Set by the recording thread between begin_cycle() and end_cycle(), unless frozen_ is set
+  std::atomic<bool> recording_{false};
+  /// Set while a dump copies the ring, the cycles are then not recorded
+  std::atomic<bool> frozen_{false};
+
+  /// Dump requested by request_dump(), as 1 + hardware_interface::FlightRecordDumpReason, 0 if none
+  std::atomic<uint32_t> requested_dump_{0};
+  std::atomic<int64_t> last_automatic_dump_ns_;
+
+  /// Serializes the dumps and protects last_dump_path_ and dump_ring_
+  mutable std::mutex dump_mutex_;
+  std::string last_dump_path_;
+  /// Copy of the ring written to the file, so that the cycles are recorded meanwhile
+  std::vector<uint64_t> dump_ring_;
+  std::atomic<uint64_t> dump_count_{0};
+
+  std::mutex stop_mutex_;
+  std::condition_variable stop_cv_;
+  bool stop_ = false;
+  std::thread dump_thread_;
+};
+
+}  // namespace controller_manager
+
+#endif  // CONTROLLER_MANAGER__FLIGHT_RECORDER_HPP_
@@ -0,0 +1,54 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONTROLLER_MANAGER__FUTEX_HPP_
+#define CONTROLLER_MANAGER__FUTEX_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "controller_manager/visibility_control.h"
+
+namespace controller_manager
+{
+
+/**
+ * @brief futex_wait Sleeps while word is expected, until futex_wake() is called on it
+ *
+ * May return spuriously, callers check their own condition again. The check of the word and
+ * the sleep are atomic, so that a wake between the last check of the caller and the sleep is not
+ * lost. On other platforms than Linux, yields instead of sleeping.
+ */
+CONTROLLER_MANAGER_PUBLIC
+void futex_wait(const std::atomic<uint32_t> & word, uint32_t expected);
+
+/// Same as futex_wait(), for at most timeout
+CONTROLLER_MANAGER_PUBLIC
+void futex_wait_for(
+  const std::atomic<uint32_t> & word, uint32_t expected, std::chrono::nanoseconds timeout);
+
+/**
+ * @brief futex_wake Wakes the threads sleeping on word, to be called after changing it
+ *
+ * Does not take any lock nor block, so that the real-time thread may wake threads of lower
+ * priority without sharing a mutex with them.
+ * @param all Wakes all the threads, one of them otherwise
+ */
+CONTROLLER_MANAGER_PUBLIC
+void futex_wake(std::atomic<uint32_t> & word, bool all);
+
+}  // namespace controller_manager
+
+#endif  // CONTROLLER_MANAGER__FUTEX_HPP_
@@ -0,0 +1,167 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONTROLLER_MANAGER__REALTIME_CONTROL_LOOP_HPP_
+#define CONTROLLER_MANAGER__REALTIME_CONTROL_LOOP_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "controller_manager/controller_manager.hpp"
+#include "controller_manager/sync_phase_lock.hpp"
+#include "controller_manager/visibility_control.h"
+
+#include "hardware_interface/robot_hardware.hpp"
+#include "hardware_interface/shared_memory_state_exporter.hpp"
+#include "hardware_interface/sync_event_source.hpp"
+
+namespace controller_manager
+{
+
+struct RealtimeControlLoopOptions
+{
+  /// Period of the read/update/write cycle
+  std::chrono::nanoseconds period = std::chrono::milliseconds(10);
+  /// SCHED_FIFO priority of the loop thread, 0 to keep the default scheduling
+  int priority = 0;
+  /// CPU the loop thread is pinned to, -1 to not pin it
+  int cpu = -1;
+  /// Lock all the current and future memory of the process, to avoid page faults in the loop
+  bool lock_memory = false;
+  /// Size of the stack of the loop thread touched before the first cycle
+  size_t stack_prefault_size = 0;
+  /// Shared memory segment the interface values are exported to after each cycle, empty to not
+  /// export them, see hardware_interface::SharedMemoryStateExporter
+  std::string state_export_segment;
+  /// Phase-lock the cycles to the sync events of the hardware bus, when the robot hardware has a
+  /// source of them, see hardware_interface::RobotHardware::get_sync_event_source(). The events
+  /// have the period of the loop.
+  bool sync_to_hardware = true;
+  SyncPhaseLockOptions sync;
+  /// Called in the loop thread between the update of the controllers and the write of the
+  /// hardware, with the period of the cycle, e.g. to enforce the joint limits with the
+  /// enforceLimits() of a joint_limits_interface::JointLimitsInterface. Has to be real-time safe.
+  std::function<void(const rclcpp::Duration & period)> enforce_limits;
+  /// Called in the loop thread at the end of each cycle, with the delay of its wake up and the
+  /// duration of its read, update and write, e.g. to fill histograms. Has to be real-time safe.
+  std::function<void(std::chrono::nanoseconds jitter, std::chrono::nanoseconds cycle_duration)>
+  on_cycle_end;
+};
+
+struct RealtimeControlLoopStatistics
+{
+  std::chrono::nanoseconds period{0};
+  uint64_t cycles = 0;
+  /// Cycles which ended after the start of the next one, the missed cycles are skipped
+  uint64_t overruns = 0;
+  /// Cycles in which the hardware read or write, or the update of the controllers, failed
+  uint64_t errors = 0;
+  /// Delay between the deadline of a cycle and the wake up of the loop
+  std::chrono::nanoseconds last_jitter{0};
+  std::chrono::nanoseconds max_jitter{0};
+  /// Duration of the read, update and write of a cycle
+  std::chrono::nanoseconds last_cycle_duration{0};
+  std::chrono::nanoseconds max_cycle_duration{0};
+  /// Whether the cycles are phase-locked to the sync events of the hardware
+  bool synchronized = false;
+  /// Deadline of the cycle minus the latest sync event and the offset
+  std::chrono::nanoseconds sync_phase_error{0};
+  /// Correction of the period tracking the rate of the sync events
+  std::chrono::nanoseconds sync_period_correction{0};
+};
+
+/**
+ * @brief The RealtimeControlLoop class reads the hardware, updates the controller manager and
+ * writes the hardware on a dedicated thread, waking up on absolute deadlines so that the period
+ * does not drift, or phase-locked to the sync events of the hardware bus so that the states are
+ * read and the commands written at a fixed offset of the bus cycle.
+ *
+ * The loop thread is set up as requested in the options before the first cycle, failures to do so
+ * are reported and the loop runs without them. The same goes for the export of the interface
+ * values to shared memory, which needs the registration of the hardware to be frozen.
+ * The services of the controller manager are not served by the loop, the executor has to be spun
+ * in another thread.
+ */
+class RealtimeControlLoop
+{
+public:
+  CONTROLLER_MANAGER_PUBLIC
+  RealtimeControlLoop(
+    std::shared_ptr<hardware_interface::RobotHardware> hw,
+    std::shared_ptr<ControllerManager> cm,
+    const RealtimeControlLoopOptions & options = RealtimeControlLoopOptions());
+
+  CONTROLLER_MANAGER_PUBLIC
+  ~RealtimeControlLoop();
+
+  RealtimeControlLoop(const RealtimeControlLoop &) = delete;
+  RealtimeControlLoop & operator=(const RealtimeControlLoop &) = delete;
+
+  /**
+   * @brief start Starts the loop thread
+   * @return false if the loop is already running or the options are invalid
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  bool start();
+
+  /**
+   * @brief stop Stops the loop thread after the current cycle
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  void stop();
+
+  CONTROLLER_MANAGER_PUBLIC
+  bool is_running() const;
+
+  /**
+   * @brief get_statistics Timing of the loop, can be called from any thread
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  RealtimeControlLoopStatistics get_statistics() const;
+
+private:
+  void configure_thread();
+  void loop();
+
+  std::shared_ptr<hardware_interface::RobotHardware> hw_;
+  std::shared_ptr<ControllerManager> cm_;
+  RealtimeControlLoopOptions options_;
+  hardware_interface::SharedMemoryStateExporter state_exporter_;
+  std::shared_ptr<hardware_interface::SyncEventSource> sync_event_source_;
+  SyncPhaseLock sync_phase_lock_;
+
+  std::thread thread_;
+  std::atomic<bool> running_{false};
+
+  std::atomic<uint64_t> cycles_{0};
+  std::atomic<uint64_t> overruns_{0};
+  std::atomic<uint64_t> errors_{0};
+  std::atomic<int64_t> last_jitter_ns_{0};
+  std::atomic<int64_t> max_jitter_ns_{0};
+  std::atomic<int64_t> last_cycle_duration_ns_{0};
+  std::atomic<int64_t> max_cycle_duration_ns_{0};
+  std::atomic<bool> synchronized_{false};
+  std::atomic<int64_t> sync_phase_error_ns_{0};
+  std::atomic<int64_t> sync_period_correction_ns_{0};
+};
+
+}  // namespace controller_manager
+
+#endif  // CONTROLLER_MANAGER__REALTIME_CONTROL_LOOP_HPP_
@@ -0,0 +1,79 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONTROLLER_MANAGER__RESOURCE_CONFLICT_CHECKER_HPP_
+#define CONTROLLER_MANAGER__RESOURCE_CONFLICT_CHECKER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "controller_manager/visibility_control.h"
+
+#include "hardware_interface/controller_info.hpp"
+
+namespace controller_manager
+{
+
+/**
+ * @brief The ResourceConflictChecker class interns the interfaces claimed by the controllers,
+ * i.e. the resources of each hardware interface, to bit indices, so that the claims of a set of
+ * controllers are checked against each other with a few word operations per controller.
+ */
+class ResourceConflictChecker
+{
+public:
+  /// One bit per interned interface, missing words are zero
+  using ClaimMask = std::vector<uint64_t>;
+
+  /**
+   * @brief get_claim_mask Bits of the interfaces claimed by a controller, the interfaces not
+   * claimed before are interned
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  ClaimMask get_claim_mask(const hardware_interface::ControllerInfo & info);
+
+  /**
+   * @brief find_conflict Finds the first controller claiming an interface also claimed by one of
+   * the controllers before it
+   * @param claim_masks Claims of the controllers
+   * @param first Index of the controller which claimed the interface first
+   * @param second Index of the controller which claimed it again
+   * @param claim Bit of the interface claimed twice
+   * @return true if a conflict was found
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  static bool find_conflict(
+    const std::vector<const ClaimMask *> & claim_masks, size_t & first, size_t & second,
+    size_t & claim);
+
+  /**
+   * @brief get_claim_name Name of an interned interface, as resource/hardware_interface
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  const std::string & get_claim_name(size_t claim) const;
+
+  CONTROLLER_MANAGER_PUBLIC
+  size_t get_claim_count() const;
+
+private:
+  std::unordered_map<std::string, size_t> claims_;
+  std::vector<std::string> claim_names_;
+};
+
+}  // namespace controller_manager
+
+#endif  // CONTROLLER_MANAGER__RESOURCE_CONFLICT_CHECKER_HPP_
@@ -0,0 +1,243 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONTROLLER_MANAGER__RESOURCE_MANAGER_HPP_
+#define CONTROLLER_MANAGER__RESOURCE_MANAGER_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "controller_manager/visibility_control.h"
+
+#include "hardware_interface/actuator_hardware.hpp"
+#include "hardware_interface/actuator_hardware_interface.hpp"
+#include "hardware_interface/clock_domain_map.hpp"
+#include "hardware_interface/hardware_freshness.hpp"
+#include "hardware_interface/hardware_info.hpp"
+#include "hardware_interface/sensor_hardware.hpp"
+#include "hardware_interface/sensor_hardware_interface.hpp"
+#include "hardware_interface/system_hardware.hpp"
+#include "hardware_interface/system_hardware_interface.hpp"
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+
+#include "pluginlib/class_loader.hpp"
+
+namespace controller_manager
+{
+
+/**
+ * @brief The HardwareStartupResult struct tells how the configure and start of one hardware
+ * component went
+ */
+struct HardwareStartupResult
+{
+  std::string name;
+  hardware_interface::return_type configure_result = hardware_interface::return_type::ERROR;
+  /// ERROR as well when the component was not started because its configure failed
+  hardware_interface::return_type start_result = hardware_interface::return_type::ERROR;
+  /// The component did not finish configuring and starting within the timeout
+  bool timed_out = false;
+  /// Time spent configuring and starting the component, up to the timeout if it timed out
+  std::chrono::nanoseconds duration{0};
+};
+
+/**
+ * @brief The ResourceManager class instantiates the hardware components described by the
+ * HardwareInfo parsed from the URDF, through pluginlib, and configures and starts them in
+ * parallel.
+ *
+ * Each component is configured then started by its own thread, so that the startup takes as long
+ * as the slowest component rather than the sum of all of them. configure() and start() cannot be
+ * interrupted: a component missing the timeout is reported as timed out while its thread keeps
+ * running, it is then left out of stop() and waited for by the destructor.
+ *
+ * The successful reads of the components are recorded in a freshness tracker, against the
+ * staleness threshold given by the staleness_threshold_ms parameter of their hardware, see
+ * HardwareFreshness.
+ *
+ * The hardware given a clock_domain parameter feeds the ClockDomainMap domain of that name with
+ * the pairs of device and steady times of its components, the hardware on the same device clock
+ * naming the same domain.
+ */
+class ResourceManager
+{
+public:
+  CONTROLLER_MANAGER_PUBLIC
+  ResourceManager();
+
+  /// Waits for the components which are still configuring or starting.
+  CONTROLLER_MANAGER_PUBLIC
+  ~ResourceManager();
+
+  ResourceManager(const ResourceManager &) = delete;
+  ResourceManager & operator=(const ResourceManager &) = delete;
+
+  /**
+   * @brief load_hardware Instantiate a component for each hardware, from its
+   * hardware_class_type, as an actuator, a sensor or a system depending on its type
+   * @return ERROR if one of the classes is not available or a type is unknown, the other
+   * components are loaded anyway
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  hardware_interface::return_type load_hardware(
+    const std::vector<hardware_interface::HardwareInfo> & hardware_infos);
+
+  CONTROLLER_MANAGER_PUBLIC
+  void add_actuator(
+    const hardware_interface::HardwareInfo & info,
+    std::unique_ptr<hardware_interface::ActuatorHardwareInterface> impl);
+
+  CONTROLLER_MANAGER_PUBLIC
+  void add_sensor(
+    const hardware_interface::HardwareInfo & info,
+    std::unique_ptr<hardware_interface::SensorHardwareInterface> impl);
+
+  CONTROLLER_MANAGER_PUBLIC
+  void add_system(
+    const hardware_interface::HardwareInfo & info,
+    std::unique_ptr<hardware_interface::SystemHardwareInterface> impl);
+
+  CONTROLLER_MANAGER_PUBLIC
+  size_t get_hardware_count() const;
+
+  /**
+   * @brief configure_and_start Configure then start all the components in parallel
+   * @param timeout Time given to each component to be configured and started
+   * @return OK once all the components are configured and started, ERROR as soon as all of them
+   * either succeeded, failed or timed out and one did not succeed, or if components are still
+   * starting from a previous call
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  hardware_interface::return_type configure_and_start(std::chrono::nanoseconds timeout);
+
+  /**
+   * @brief reload_hardware Apply a new description of the hardware, e.g. parsed from an edited
+   * URDF, without restarting the components whose description did not change
+   *
+   * The components whose HardwareInfo changed, see hardware_interface::diff_control_resources(),
+   * are stopped, configured with their new HardwareInfo and started again, and the new hardware is
+   * loaded and started, all of them in parallel as in configure_and_start(). The other components
+   * keep running. The freshness and the clock domain of a reconfigured component keep tracking
+   * the joints and sensors it had when it was added.
+   * @param hardware_infos The new description of all the hardware
+   * @param timeout Time given to each component to be configured and started
+   * @return ERROR, with nothing reloaded, if a hardware was removed or changed type or class, which
+   * requires a restart, or if components are still starting, and ERROR as well if a component
+   * could not be stopped, loaded, configured or started
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  hardware_interface::return_type reload_hardware(
+    const std::vector<hardware_interface::HardwareInfo> & hardware_infos,
+    std::chrono::nanoseconds timeout);
+
+  /**
+   * @brief get_startup_results Results of the last configure_and_start, in the order the
+   * components were added, updated by the components finishing after a timeout
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  std::vector<HardwareStartupResult> get_startup_results() const;
+
+  /**
+   * @brief stop Stop the started components, one after the other
+   * @return ERROR if one of them failed to stop or is still starting
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  hardware_interface::return_type stop();
+
+  CONTROLLER_MANAGER_PUBLIC
+  const std::vector<std::shared_ptr<hardware_interface::ActuatorHardware>> &
+  get_actuators() const;
+
+  CONTROLLER_MANAGER_PUBLIC
+  const std::vector<std::shared_ptr<hardware_interface::SensorHardware>> & get_sensors() const;
+
+  CONTROLLER_MANAGER_PUBLIC
+  const std::vector<std::shared_ptr<hardware_interface::SystemHardware>> & get_systems() const;
+
+  /**
+   * @brief get_hardware_freshness The tracker the components record their reads in, one
+   * component per hardware in the order they were added, to be shared with the robot hardware
+   * through RobotHardware::set_hardware_freshness()
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  const std::shared_ptr<hardware_interface::HardwareFreshness> & get_hardware_freshness() const;
+
+  /**
+   * @brief get_clock_domains The clock domains the components feed, to be shared with the robot
+   * hardware through RobotHardware::set_clock_domains()
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  const std::shared_ptr<hardware_interface::ClockDomainMap> & get_clock_domains() const;
+
+private:
+  using HardwareCall = std::function<hardware_interface::return_type()>;
+  using ConfigureCall =
+    std::function<hardware_interface::return_type(const hardware_interface::HardwareInfo &)>;
+
+  struct Hardware
+  {
+    /// The description the component is configured with, replaced by reload_hardware()
+    hardware_interface::HardwareInfo info;
+    ConfigureCall configure;
+    HardwareCall start;
+    HardwareCall stop;
+    std::thread worker;
+    /// The worker is done configuring and starting, protected by mutex_
+    bool done = true;
+  };
+
+  void add_hardware(
+    const hardware_interface::HardwareInfo & info, ConfigureCall configure, HardwareCall start,
+    HardwareCall stop);
+  /// Whether none of the components is configuring or starting, logging the first one which is
+  bool is_startup_done() const;
+  /// Configures and starts some of the components in parallel, with mutex_ locked by lock
+  hardware_interface::return_type start_hardware(
+    const std::vector<size_t> & indices, std::chrono::nanoseconds timeout,
+    std::unique_lock<std::mutex> & lock);
+  void startup(size_t index);
+  /// Adds the hardware to the freshness tracker, and has the component record its reads there
+  template<typename ComponentT>
+  void track_freshness(const hardware_interface::HardwareInfo & info, ComponentT & component);
+  /// Adds the hardware to its clock domain, if any, and has the component feed it
+  template<typename ComponentT>
+  void track_clock_domain(const hardware_interface::HardwareInfo & info, ComponentT & component);
+
+  // the loaders outlive the components created from their libraries
+  pluginlib::ClassLoader<hardware_interface::ActuatorHardwareInterface> actuator_loader_;
+  pluginlib::ClassLoader<hardware_interface::SensorHardwareInterface> sensor_loader_;
+  pluginlib::ClassLoader<hardware_interface::SystemHardwareInterface> system_loader_;
+
+  std::vector<std::shared_ptr<hardware_interface::ActuatorHardware>> actuators_;
+  std::vector<std::shared_ptr<hardware_interface::SensorHardware>> sensors_;
+  std::vector<std::shared_ptr<hardware_interface::SystemHardware>> systems_;
+  std::shared_ptr<hardware_interface::HardwareFreshness> freshness_;
+  std::shared_ptr<hardware_interface::ClockDomainMap> clock_domains_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable done_cv_;
+  std::vector<Hardware> hardware_;
+  std::vector<HardwareStartupResult> results_;
+};
+
+}  // namespace controller_manager
+
+#endif  // CONTROLLER_MANAGER__RESOURCE_MANAGER_HPP_
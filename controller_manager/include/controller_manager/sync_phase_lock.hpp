@@ -0,0 +1,106 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONTROLLER_MANAGER__SYNC_PHASE_LOCK_HPP_
+#define CONTROLLER_MANAGER__SYNC_PHASE_LOCK_HPP_
+
+#include <chrono>
+#include <cstdint>
+
+#include "controller_manager/visibility_control.h"
+
+namespace controller_manager
+{
+
+struct SyncPhaseLockOptions
+{
+  /// Deadline of the cycles relative to the sync events, e.g. negative to wake up before the
+  /// frames are exchanged with the bus, positive to read the states right after they arrived
+  std::chrono::nanoseconds offset{0};
+  /// Fraction of the phase error corrected in the next cycle
+  double proportional_gain = 0.3;
+  /// Fraction of the phase error accumulated in the period correction, which tracks the rate of
+  /// the sync events so that the phase error settles to zero
+  double integral_gain = 0.02;
+  /// Largest correction of one period, 0 for a tenth of the period
+  std::chrono::nanoseconds max_correction{0};
+  /// Largest phase error of a locked loop, 0 for a hundredth of the period
+  std::chrono::nanoseconds lock_window{0};
+  /// Cycles without any sync event after which the lock is lost, the period correction is kept
+  /// meanwhile and the phase is aligned again on the next event
+  unsigned int holdover_cycles = 10;
+};
+
+/**
+ * @brief The SyncPhaseLock class is the phase-locked loop locking the deadlines of a periodic
+ * loop to external sync events of the same period, e.g. of an EtherCAT distributed clock
+ *
+ * The phase error of a cycle is its deadline minus the latest event and the offset, wrapped to
+ * half a period. The phase is aligned in one step on the first event, then the error is corrected
+ * by a proportional-integral controller on the period of the cycles, so that the deadlines follow
+ * the drift of the event clock without jumping. Only used by the loop thread, real-time safe.
+ */
+class SyncPhaseLock
+{
+public:
+  CONTROLLER_MANAGER_PUBLIC
+  SyncPhaseLock(
+    std::chrono::nanoseconds period,
+    const SyncPhaseLockOptions & options = SyncPhaseLockOptions());
+
+  /**
+   * @brief next_period Gets the time from a deadline to the next one
+   * @param deadline Steady time of the deadline of the cycle
+   * @param latest_event Steady time of the latest sync event, zero if there was none yet;
+   * considered a new event when it differs from the one of the previous call
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  std::chrono::nanoseconds next_period(
+    std::chrono::nanoseconds deadline, std::chrono::nanoseconds latest_event);
+
+  /// Whether the phase error of the latest event is within the lock window
+  CONTROLLER_MANAGER_PUBLIC
+  bool is_locked() const;
+
+  CONTROLLER_MANAGER_PUBLIC
+  std::chrono::nanoseconds get_phase_error() const;
+
+  /// Correction of the period tracking the rate of the sync events
+  CONTROLLER_MANAGER_PUBLIC
+  std::chrono::nanoseconds get_period_correction() const;
+
+  /// Forgets the events, the phase is aligned again on the next one
+  CONTROLLER_MANAGER_PUBLIC
+  void reset();
+
+private:
+  int64_t period_ns_;
+  int64_t offset_ns_;
+  double proportional_gain_;
+  double integral_gain_;
+  double max_correction_ns_;
+  int64_t lock_window_ns_;
+  unsigned int holdover_cycles_;
+
+  bool acquired_ = false;
+  bool locked_ = false;
+  unsigned int cycles_without_event_ = 0;
+  int64_t last_event_ns_ = 0;
+  int64_t phase_error_ns_ = 0;
+  double period_correction_ns_ = 0.0;
+};
+
+}  // namespace controller_manager
+
+#endif  // CONTROLLER_MANAGER__SYNC_PHASE_LOCK_HPP_
@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+# Copyright 2020 Open Source Robotics Foundation, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Load the flight records dumped by the controller manager.
+
+The layout is the one of hardware_interface/flight_record.hpp. The file is memory mapped with
+numpy, the values of all the cycles are exposed as a (cycle count, value count) array without
+being copied:
+
+    record = FlightRecord('flight_record_20200101-120000_0_fault.bin')
+    position = record.joint_values[:, record.joint_value_names.index('joint1/position')]
+
+Run as a script, prints the layout of a file.
+"""
+
+import struct
+import sys
+
+import numpy as np
+
+MAGIC = 0x72326672
+LAYOUT_VERSION = 1
+DUMP_REASONS = {0: 'requested', 1: 'fault', 2: 'overrun'}
+
+# in the byte order of the recording machine, assumed to be the one of the reading machine
+_HEADER = struct.Struct('=IIIIQQQQQQQQ')
+_CONTROLLER_NAME_SIZE = 32
+
+
+class FlightRecord:
+
+    def __init__(self, path):
+        self._file = np.memmap(path, dtype=np.uint8, mode='r')
+        if self._file.size < _HEADER.size:
+            raise ValueError(f"'{path}' is too small to be a flight record")
+        (magic, layout_version, dump_reason, controller_capacity, actuator_value_count,
+         joint_value_count, cycle_size, cycle_count, first_cycle_index, names_offset,
+         names_size, cycles_offset) = _HEADER.unpack_from(self._file, 0)
+        if magic != MAGIC or layout_version != LAYOUT_VERSION:
+            raise ValueError(f"'{path}' was not written by a compatible flight recorder")
+
+        self.dump_reason = DUMP_REASONS.get(dump_reason, str(dump_reason))
+        self.first_cycle_index = first_cycle_index
+        names = bytes(self._file[names_offset:names_offset + names_size]).split(b'\0')
+        names = [name.decode() for name in names[:actuator_value_count + joint_value_count]]
+        self.actuator_value_names = names[:actuator_value_count]
+        self.joint_value_names = names[actuator_value_count:]
+
+        controller = np.dtype([
+            ('name', f'S{_CONTROLLER_NAME_SIZE}'),
+            ('update_duration_ns', '=i8'),
+            ('flags', '=u4'),
+            ('reserved', '=u4'),
+        ])
+        cycle = np.dtype([
+            ('time_ns', '=i8'),
+            ('period_ns', '=i8'),
+            ('update_duration_ns', '=i8'),
+            ('controller_count', '=u4'),
+            ('flags', '=u4'),
+            ('actuator_values', '=f8', (actuator_value_count,)),
+            ('joint_values', '=f8', (joint_value_count,)),
+            ('controllers', controller, (controller_capacity,)),
+        ])
+        if cycle.itemsize != cycle_size:
+            raise ValueError(f"'{path}' has an unknown layout")
+        self.cycles = np.ndarray(
+            (cycle_count,), dtype=cycle, buffer=self._file, offset=cycles_offset)
+
+    @property
+    def time_ns(self):
+        return self.cycles['time_ns']
+
+    @property
+    def update_duration_ns(self):
+        return self.cycles['update_duration_ns']
+
+    @property
+    def actuator_values(self):
+        """Actuator values of the cycles, the columns of the padding are included."""
+        return self.cycles['actuator_values']
+
+    @property
+    def joint_values(self):
+        """Joint values of the cycles, the columns of the padding are included."""
+        return self.cycles['joint_values']
+
+    def controllers(self, index):
+        """Controllers updated in the cycle at index, as (name, duration in ns, flags)."""
+        cycle = self.cycles[index]
+        return [
+            (controller['name'].decode(), int(controller['update_duration_ns']),
+             int(controller['flags']))
+            for controller in cycle['controllers'][:cycle['controller_count']]]
+
+
+def main(argv):
+    if len(argv) != 2:
+        print(f'usage: {argv[0]} <flight record file>', file=sys.stderr)
+        return 2
+    record = FlightRecord(argv[1])
+    print(f'dump reason: {record.dump_reason}')
+    print(f'cycles: {len(record.cycles)}, from cycle {record.first_cycle_index}')
+    if len(record.cycles) > 0:
+        print(f'time: {record.time_ns[0]} ns to {record.time_ns[-1]} ns')
+        print(f'longest update: {record.update_duration_ns.max()} ns')
+    print('actuator values: ' + ', '.join(name for name in record.actuator_value_names if name))
+    print('joint values: ' + ', '.join(name for name in record.joint_value_names if name))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
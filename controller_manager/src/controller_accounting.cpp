@@ -0,0 +1,79 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "controller_manager/controller_accounting.hpp"
+
+#include <algorithm>
+
+namespace controller_manager
+{
+
+constexpr uint64_t ControllerAccounting::RECENT_WINDOW;
+
+ControllerAccounting::ControllerAccounting(uint64_t recent_window)
+: recent_window_(std::max<uint64_t>(recent_window, 1))
+{
+}
+
+void ControllerAccounting::record_update(int64_t cpu_time_ns)
+{
+  const auto update_count = update_count_.load(std::memory_order_relaxed) + 1;
+  update_count_.store(update_count, std::memory_order_relaxed);
+  total_cpu_time_ns_.store(
+    total_cpu_time_ns_.load(std::memory_order_relaxed) + cpu_time_ns, std::memory_order_relaxed);
+
+  window_cpu_time_ns_ += cpu_time_ns;
+  ++window_count_;
+  // the first window is published as it fills, then each window once complete
+  if (window_count_ == recent_window_ || update_count < recent_window_) {
+    recent_cpu_time_ns_.store(
+      window_cpu_time_ns_ / static_cast<int64_t>(window_count_), std::memory_order_relaxed);
+  }
+  if (window_count_ == recent_window_) {
+    window_cpu_time_ns_ = 0;
+    window_count_ = 0;
+  }
+}
+
+uint64_t ControllerAccounting::get_update_count() const
+{
+  return update_count_.load(std::memory_order_relaxed);
+}
+
+int64_t ControllerAccounting::get_total_cpu_time_ns() const
+{
+  return total_cpu_time_ns_.load(std::memory_order_relaxed);
+}
+
+int64_t ControllerAccounting::get_recent_cpu_time_ns() const
+{
+  return recent_cpu_time_ns_.load(std::memory_order_relaxed);
+}
+
+uint64_t ControllerAccounting::get_recent_window() const
+{
+  return recent_window_;
+}
+
+hardware_interface::PoolAllocationAccount & ControllerAccounting::get_pool_account()
+{
+  return pool_account_;
+}
+
+const hardware_interface::PoolAllocationAccount & ControllerAccounting::get_pool_account() const
+{
+  return pool_account_;
+}
+
+}  // namespace controller_manager
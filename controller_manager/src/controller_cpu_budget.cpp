@@ -0,0 +1,203 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "controller_manager/controller_cpu_budget.hpp"
+
+#ifdef __linux__
+#include <time.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+namespace controller_manager
+{
+
+constexpr uint32_t ControllerCpuBudget::MAX_RATE_DIVIDER;
+
+ControllerCpuBudget::ControllerCpuBudget(const ControllerCpuBudgetOptions & options)
+: options_(options)
+{
+}
+
+const ControllerCpuBudgetOptions & ControllerCpuBudget::get_options() const
+{
+  return options_;
+}
+
+bool ControllerCpuBudget::is_budgeted() const
+{
+  return options_.budget_ns > 0;
+}
+
+bool ControllerCpuBudget::begin_update(uint64_t update_index)
+{
+  if (suspended_.load(std::memory_order_relaxed) ||
+    skip_next_.exchange(false, std::memory_order_relaxed) ||
+    update_index % rate_divider_.load(std::memory_order_relaxed) != 0)
+  {
+    skipped_count_.fetch_add(1, std::memory_order_relaxed);
+    ++left_out_updates_;
+    return false;
+  }
+  update_span_ = left_out_updates_ + 1;
+  left_out_updates_ = 0;
+  return true;
+}
+
+uint64_t ControllerCpuBudget::get_update_span() const
+{
+  return update_span_;
+}
+
+bool ControllerCpuBudget::end_update(int64_t cpu_time_ns)
+{
+  last_cpu_time_ns_.store(cpu_time_ns, std::memory_order_relaxed);
+  if (cpu_time_ns > max_cpu_time_ns_.load(std::memory_order_relaxed)) {
+    max_cpu_time_ns_.store(cpu_time_ns, std::memory_order_relaxed);
+  }
+  if (!is_budgeted() || cpu_time_ns <= options_.budget_ns) {
+    consecutive_overruns_ = 0;
+    return false;
+  }
+  overrun_count_.fetch_add(1, std::memory_order_relaxed);
+  if (++consecutive_overruns_ < std::max(options_.overrun_limit, 1u)) {
+    return false;
+  }
+  consecutive_overruns_ = 0;
+  degrade();
+  return true;
+}
+
+bool ControllerCpuBudget::degrade()
+{
+  if (!can_degrade()) {
+    return false;
+  }
+  switch (options_.policy) {
+    case OverrunPolicy::SKIP:
+      skip_next_.store(true, std::memory_order_relaxed);
+      break;
+    case OverrunPolicy::DECIMATE:
+      rate_divider_.store(
+        std::min(2 * rate_divider_.load(std::memory_order_relaxed), MAX_RATE_DIVIDER),
+        std::memory_order_relaxed);
+      break;
+    case OverrunPolicy::DEACTIVATE:
+      suspended_.store(true, std::memory_order_relaxed);
+      break;
+  }
+  degradation_count_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+bool ControllerCpuBudget::can_degrade() const
+{
+  switch (options_.policy) {
+    case OverrunPolicy::SKIP:
+      return !skip_next_.load(std::memory_order_relaxed);
+    case OverrunPolicy::DECIMATE:
+      return rate_divider_.load(std::memory_order_relaxed) < MAX_RATE_DIVIDER;
+    case OverrunPolicy::DEACTIVATE:
+      return !suspended_.load(std::memory_order_relaxed);
+  }
+  return false;
+}
+
+void ControllerCpuBudget::reset()
+{
+  consecutive_overruns_ = 0;
+  // a started controller has no previous update to span from
+  left_out_updates_ = 0;
+  update_span_ = 1;
+  skip_next_.store(false, std::memory_order_relaxed);
+  rate_divider_.store(1, std::memory_order_relaxed);
+  suspended_.store(false, std::memory_order_relaxed);
+}
+
+uint64_t ControllerCpuBudget::get_overrun_count() const
+{
+  return overrun_count_.load(std::memory_order_relaxed);
+}
+
+uint64_t ControllerCpuBudget::get_degradation_count() const
+{
+  return degradation_count_.load(std::memory_order_relaxed);
+}
+
+uint64_t ControllerCpuBudget::get_skipped_count() const
+{
+  return skipped_count_.load(std::memory_order_relaxed);
+}
+
+uint32_t ControllerCpuBudget::get_rate_divider() const
+{
+  return rate_divider_.load(std::memory_order_relaxed);
+}
+
+bool ControllerCpuBudget::is_suspended() const
+{
+  return suspended_.load(std::memory_order_relaxed);
+}
+
+int64_t ControllerCpuBudget::get_last_cpu_time_ns() const
+{
+  return last_cpu_time_ns_.load(std::memory_order_relaxed);
+}
+
+int64_t ControllerCpuBudget::get_max_cpu_time_ns() const
+{
+  return max_cpu_time_ns_.load(std::memory_order_relaxed);
+}
+
+int64_t ControllerCpuBudget::thread_cpu_time_ns()
+{
+#ifdef __linux__
+  timespec time;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) == 0) {
+    return static_cast<int64_t>(time.tv_sec) * 1000000000 + time.tv_nsec;
+  }
+#endif
+  // the wall time, preemptions included, where the thread CPU clock is not available
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char * ControllerCpuBudget::to_string(OverrunPolicy policy)
+{
+  switch (policy) {
+    case OverrunPolicy::DECIMATE:
+      return "decimate";
+    case OverrunPolicy::DEACTIVATE:
+      return "deactivate";
+    default:
+      return "skip";
+  }
+}
+
+bool ControllerCpuBudget::from_string(const std::string & name, OverrunPolicy & policy)
+{
+  for (const auto candidate :
+    {OverrunPolicy::SKIP, OverrunPolicy::DECIMATE, OverrunPolicy::DEACTIVATE})
+  {
+    if (name == to_string(candidate)) {
+      policy = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace controller_manager
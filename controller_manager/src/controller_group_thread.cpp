@@ -0,0 +1,144 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "controller_manager/controller_group_thread.hpp"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <string>
+#include <thread>
+
+#include "controller_manager/futex.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+namespace controller_manager
+{
+
+static constexpr const char * kLoggerName = "controller_group_thread";
+/// Checks of the end of the task before wait() goes to sleep
+static constexpr int kWaitSpinCount = 1000;
+
+ControllerGroupThread::ControllerGroupThread(
+  size_t index, const std::string & name, const ControllerGroupOptions & options)
+: index_(index), name_(name), options_(options)
+{
+  thread_ = std::thread(
+    &ControllerGroupThread::worker_loop, this, task_sequence_.load(std::memory_order_relaxed));
+#ifdef __linux__
+  if (!options_.cpus.empty()) {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (const auto cpu : options_.cpus) {
+      if (cpu >= 0 && cpu < CPU_SETSIZE) {
+        CPU_SET(cpu, &cpu_set);
+      }
+    }
+    if (pthread_setaffinity_np(thread_.native_handle(), sizeof(cpu_set), &cpu_set) != 0) {
+      RCLCPP_WARN(
+        rclcpp::get_logger(kLoggerName),
+        "Could not restrict the thread of controller group '%s' to the requested CPUs",
+        name_.c_str());
+    }
+  }
+  if (options_.priority > 0) {
+    sched_param param;
+    param.sched_priority = options_.priority;
+    if (pthread_setschedparam(thread_.native_handle(), SCHED_FIFO, &param) != 0) {
+      RCLCPP_WARN(
+        rclcpp::get_logger(kLoggerName),
+        "Could not set the priority of the thread of controller group '%s' to %d",
+        name_.c_str(), options_.priority);
+    }
+  }
+#else
+  if (!options_.cpus.empty() || options_.priority > 0) {
+    RCLCPP_WARN(
+      rclcpp::get_logger(kLoggerName),
+      "Setting the CPUs and the priority of the controller group threads is not supported on "
+      "this platform");
+  }
+#endif
+}
+
+ControllerGroupThread::~ControllerGroupThread()
+{
+  stop_.store(true, std::memory_order_relaxed);
+  task_sequence_.fetch_add(1, std::memory_order_release);
+  futex_wake(task_sequence_, false);
+  thread_.join();
+}
+
+size_t ControllerGroupThread::get_index() const
+{
+  return index_;
+}
+
+const std::string & ControllerGroupThread::get_name() const
+{
+  return name_;
+}
+
+const ControllerGroupOptions & ControllerGroupThread::get_options() const
+{
+  return options_;
+}
+
+void ControllerGroupThread::start(Task task, void * context)
+{
+  task_ = task;
+  context_ = context;
+  running_.store(1, std::memory_order_relaxed);
+  // publishes the task written above to the group thread
+  task_sequence_.fetch_add(1, std::memory_order_release);
+  futex_wake(task_sequence_, false);
+}
+
+void ControllerGroupThread::wait()
+{
+  // the task is usually about to finish, spin a little before going to sleep. Spinning longer
+  // would starve a group thread of lower priority on the same CPU, which yielding does not help
+  for (int i = 0; i < kWaitSpinCount; ++i) {
+    if (running_.load(std::memory_order_acquire) == 0) {
+      return;
+    }
+  }
+  while (running_.load(std::memory_order_acquire) != 0) {
+    futex_wait(running_, 1);
+  }
+}
+
+void ControllerGroupThread::worker_loop(uint32_t task_sequence)
+{
+  while (true) {
+    const auto last_task_sequence = task_sequence;
+    for (task_sequence = task_sequence_.load(std::memory_order_acquire);
+      task_sequence == last_task_sequence;
+      task_sequence = task_sequence_.load(std::memory_order_acquire))
+    {
+      futex_wait(task_sequence_, task_sequence);
+    }
+    if (stop_.load(std::memory_order_relaxed)) {
+      return;
+    }
+
+    task_(context_, index_);
+    running_.store(0, std::memory_order_release);
+    futex_wake(running_, false);
+  }
+}
+
+}  // namespace controller_manager
@@ -0,0 +1,52 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "controller_manager/controller_input_tracker.hpp"
+
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace controller_manager
+{
+
+ControllerInputTracker::ControllerInputTracker(std::vector<const double *> inputs)
+: inputs_(std::move(inputs)), values_(inputs_.size(), 0u)
+{
+}
+
+size_t ControllerInputTracker::size() const
+{
+  return inputs_.size();
+}
+
+bool ControllerInputTracker::update()
+{
+  bool changed = !recorded_;
+  for (size_t i = 0; i < inputs_.size(); ++i) {
+    uint64_t bits;
+    std::memcpy(&bits, inputs_[i], sizeof(bits));
+    changed |= bits != values_[i];
+    values_[i] = bits;
+  }
+  recorded_ = true;
+  return changed;
+}
+
+void ControllerInputTracker::reset()
+{
+  recorded_ = false;
+}
+
+}  // namespace controller_manager
@@ -0,0 +1,107 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "controller_manager/controller_loader.hpp"
+
+#include <dlfcn.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "hardware_interface/tracing.hpp"
+
+namespace controller_manager
+{
+
+static constexpr const char * kControllerInterfaceName = "controller_interface";
+static constexpr const char * kControllerInterface = "controller_interface::ControllerInterface";
+
+ControllerLoader::ControllerLoader()
+: loader_(std::make_shared<pluginlib::ClassLoader<controller_interface::ControllerInterface>>(
+      kControllerInterfaceName, kControllerInterface))
+{
+}
+
+ControllerLoader::~ControllerLoader()
+{
+  for (const auto & library : bound_libraries_) {
+    dlclose(library.second);
+  }
+}
+
+controller_interface::ControllerInterfaceSharedPtr
+ControllerLoader::create(const std::string & controller_type)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (!loader_->isClassAvailable(controller_type)) {
+    return nullptr;
+  }
+  HARDWARE_INTERFACE_TRACE_SCOPE("load_controller", controller_type.c_str());
+  return loader_->createSharedInstance(controller_type);
+}
+
+std::vector<std::string> ControllerLoader::get_declared_classes()
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  return loader_->getDeclaredClasses();
+}
+
+void ControllerLoader::load_library_for_class(const std::string & controller_type)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  loader_->loadLibraryForClass(controller_type);
+}
+
+bool ControllerLoader::bind_library_now(const std::string & controller_type)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  std::string library_path;
+  try {
+    if (!loader_->isClassAvailable(controller_type)) {
+      return false;
+    }
+    library_path = loader_->getClassLibraryPath(controller_type);
+  } catch (const std::exception &) {
+    return false;
+  }
+  if (library_path.empty()) {
+    return false;
+  }
+  if (bound_libraries_.count(library_path) > 0) {
+    return true;
+  }
+  // the reference keeps the symbols bound while pluginlib opens and closes the library
+  void * library = dlopen(library_path.c_str(), RTLD_NOW);
+  if (library == nullptr) {
+    return false;
+  }
+  bound_libraries_.emplace(library_path, library);
+  return true;
+}
+
+void ControllerLoader::reload()
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (const auto & library : bound_libraries_) {
+    dlclose(library.second);
+  }
+  bound_libraries_.clear();
+  loader_ = std::make_shared<pluginlib::ClassLoader<controller_interface::ControllerInterface>>(
+    kControllerInterfaceName, kControllerInterface);
+}
+
+}  // namespace controller_manager
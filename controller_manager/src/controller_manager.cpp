@@ -14,29 +14,147 @@
 
 #include "controller_manager/controller_manager.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <list>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "controller_interface/controller_interface.hpp"
 
+#include "controller_manager/futex.hpp"
+#include "controller_manager/resource_conflict_checker.hpp"
+
+#include "controller_manager_msgs/msg/controller_list.hpp"
+#include "controller_manager_msgs/msg/controller_resource_usage.hpp"
+#include "controller_manager_msgs/msg/cpu_budget_statistics.hpp"
+#include "controller_manager_msgs/msg/hardware_interface_resources.hpp"
+#include "controller_manager_msgs/msg/timing_statistics.hpp"
 #include "controller_manager_msgs/srv/switch_controller.hpp"
 
+#include "hardware_interface/realtime_logger.hpp"
+#include "hardware_interface/realtime_memory_pool.hpp"
+#include "hardware_interface/realtime_section.hpp"
+#include "hardware_interface/tracing.hpp"
+
 #include "lifecycle_msgs/msg/state.hpp"
 
 #include "rclcpp/rclcpp.hpp"
 
+using hardware_interface::FlightRecordController;
+using hardware_interface::FlightRecordCycle;
+using hardware_interface::FlightRecordDumpReason;
+
 namespace controller_manager
 {
 
+namespace
+{
+controller_manager_msgs::msg::TimingStatistics to_msg(
+  const std::string & name, const TimingStatistics & statistics)
+{
+  controller_manager_msgs::msg::TimingStatistics msg;
+  msg.name = name;
+  msg.count = statistics.count;
+  msg.window = statistics.window;
+  msg.min_ns = statistics.min.count();
+  msg.mean_ns = statistics.mean.count();
+  msg.p99_ns = statistics.p99.count();
+  msg.max_ns = statistics.max.count();
+  return msg;
+}
+
+controller_manager_msgs::msg::CpuBudgetStatistics to_msg(const ControllerCpuBudget & budget)
+{
+  controller_manager_msgs::msg::CpuBudgetStatistics msg;
+  const auto & options = budget.get_options();
+  msg.budget_ns = options.budget_ns;
+  msg.overrun_policy = ControllerCpuBudget::to_string(options.policy);
+  msg.priority = options.priority;
+  msg.last_cpu_time_ns = budget.get_last_cpu_time_ns();
+  msg.max_cpu_time_ns = budget.get_max_cpu_time_ns();
+  msg.overrun_count = budget.get_overrun_count();
+  msg.degradation_count = budget.get_degradation_count();
+  msg.skipped_count = budget.get_skipped_count();
+  msg.update_rate_divider = budget.get_rate_divider();
+  msg.suspended = budget.is_suspended();
+  return msg;
+}
+
+controller_manager_msgs::msg::ControllerResourceUsage to_msg(
+  const ControllerAccounting & accounting)
+{
+  controller_manager_msgs::msg::ControllerResourceUsage msg;
+  msg.update_count = accounting.get_update_count();
+  msg.total_cpu_time_ns = accounting.get_total_cpu_time_ns();
+  msg.recent_cpu_time_ns = accounting.get_recent_cpu_time_ns();
+  msg.recent_window = accounting.get_recent_window();
+  const auto & pool_account = accounting.get_pool_account();
+  msg.pool_allocation_count = pool_account.allocation_count.load(std::memory_order_relaxed);
+  msg.pool_allocated_bytes = pool_account.allocated_bytes.load(std::memory_order_relaxed);
+  msg.pool_deallocation_count = pool_account.deallocation_count.load(std::memory_order_relaxed);
+  msg.pool_deallocated_bytes = pool_account.deallocated_bytes.load(std::memory_order_relaxed);
+  return msg;
+}
+}  // namespace
+
 static constexpr const char * kControllerInterfaceName = "controller_interface";
 static constexpr const char * kControllerInterface = "controller_interface::ControllerInterface";
+static constexpr const char * kUpdateRateParam = "update_rate";
+static constexpr const char * kUpdateThreadsParam = "update_threads";
+static constexpr const char * kUpdateThreadsPriorityParam = "update_threads_priority";
+static constexpr const char * kControllerExecutorThreadsParam = "controller_executor_threads";
+static constexpr const char * kControllerExecutorCpusParam = "controller_executor_cpus";
+static constexpr const char * kPreloadControllerLibrariesParam = "preload_controller_libraries";
+static constexpr const char * kFlightRecorderCyclesParam = "flight_recorder_cycles";
+static constexpr const char * kFlightRecorderDirectoryParam = "flight_recorder_directory";
+static constexpr const char * kJointStateBroadcastDecimationParam =
+  "joint_state_broadcast_decimation";
+static constexpr const char * kJointStateBroadcastThresholdParam =
+  "joint_state_broadcast_threshold";
+static constexpr const char * kJointStateBroadcastKeyframeIntervalParam =
+  "joint_state_broadcast_keyframe_interval";
+static constexpr const char * kUpdateCpuBudgetParam = "update_cpu_budget_us";
+static constexpr const char * kCpuBudgetParam = "cpu_budget_us";
+static constexpr const char * kControllerAccountingParam = "controller_accounting";
+static constexpr const char * kOverrunPolicyParam = "overrun_policy";
+static constexpr const char * kOverrunLimitParam = "overrun_limit";
+static constexpr const char * kPriorityParam = "priority";
+static constexpr const char * kControllerGroupsParam = "controller_groups";
+static constexpr const char * kGroupParam = "group";
+static constexpr const char * kCpusParam = "cpus";
+static constexpr const char * kOrderParam = "order";
+static constexpr const char * kWarmUpUpdatesParam = "warm_up_updates";
+/// Number of consecutive cycles over the CPU budget of the update which make a sustained overrun
+static constexpr unsigned int kUpdateOverrunLimit = 3;
+/// Upper bound of the ticks looked at to stagger the controllers updated at a lower rate
+static constexpr uint64_t kMaxUpdateHyperperiod = 10000;
+
+inline bool is_controller_running(const ControllerSpec & controller)
+{
+  return controller.running && controller.running->load(std::memory_order_acquire);
+}
+
+inline bool is_controller_standby(const ControllerSpec & controller)
+{
+  return controller.standby && controller.standby->load(std::memory_order_acquire);
+}
 
-inline bool is_controller_running(controller_interface::ControllerInterface & controller)
+/// Start updating a controller, promoting it if it is in standby, real-time safe
+void run_controller(const ControllerSpec & controller)
 {
-  return controller.get_lifecycle_node()->get_current_state().id() ==
-         lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE;
+  controller.cpu_budget->reset();
+  if (controller.input_tracker) {
+    controller.input_tracker->reset();
+  }
+  if (controller.standby && controller.standby->exchange(false, std::memory_order_acq_rel)) {
+    controller.c->on_takeover();
+  }
+  controller.running->store(true, std::memory_order_release);
 }
 
 bool controller_name_compare(const ControllerSpec & a, const std::string & name)
@@ -44,6 +162,145 @@ bool controller_name_compare(const ControllerSpec & a, const std::string & name)
   return a.info.name == name;
 }
 
+bool contains(const std::vector<ControllerSpec> & controllers, const ControllerSpec & controller)
+{
+  return std::any_of(
+    controllers.begin(), controllers.end(),
+    std::bind(controller_name_compare, std::placeholders::_1, controller.info.name));
+}
+
+/// Joint values read and written by a controller, all the states or all the commands if it did
+/// not declare them, empty if the registration of the hardware is not frozen
+std::vector<uint64_t> get_joint_value_mask(
+  const hardware_interface::RobotHardware & hw, const hardware_interface::ControllerInfo & info)
+{
+  std::vector<uint64_t> mask;
+  if (!hw.is_registration_frozen()) {
+    return mask;
+  }
+  if (info.resources.empty()) {
+    hw.get_joint_value_mask(true, mask);
+  } else {
+    hw.get_joint_value_mask(info.resources, mask);
+  }
+  if (info.read_states.empty()) {
+    hw.get_joint_value_mask(false, mask);
+  } else {
+    hw.get_joint_value_mask(info.read_states, mask);
+  }
+  return mask;
+}
+
+/// Tracker of the inputs of a deterministic controller, null if its updates may not be skipped
+std::shared_ptr<ControllerInputTracker> make_input_tracker(
+  hardware_interface::RobotHardware & hw, controller_interface::ControllerInterface & controller,
+  const hardware_interface::ControllerInfo & info)
+{
+  if (!controller.is_deterministic() || info.read_states.empty() ||
+    !hw.is_registration_frozen())
+  {
+    return nullptr;
+  }
+  std::vector<const double *> inputs;
+  for (const auto & interface : info.read_states) {
+    for (const auto & joint_name : interface.second) {
+      hardware_interface::JointHandle handle(joint_name, interface.first);
+      if (hw.get_joint_handle(handle) != hardware_interface::return_type::OK) {
+        return nullptr;
+      }
+      inputs.push_back(handle.get_value_ptr());
+    }
+  }
+  for (const auto & interface : info.references) {
+    for (const auto & reference_name : interface.second) {
+      hardware_interface::JointHandle handle(reference_name, interface.first);
+      if (hw.get_reference_handle(handle) != hardware_interface::return_type::OK) {
+        return nullptr;
+      }
+      inputs.push_back(handle.get_value_ptr());
+    }
+  }
+  return std::make_shared<ControllerInputTracker>(std::move(inputs));
+}
+
+/// Activate the lifecycle of a controller, before the real-time thread starts updating it
+bool activate_controller(const ControllerSpec & controller, const rclcpp::Logger & logger)
+{
+  HARDWARE_INTERFACE_TRACE_SCOPE("activate_controller", controller.info.name.c_str());
+  const auto new_state = controller.c->get_lifecycle_node()->activate();
+  if (new_state.id() != lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE) {
+    RCLCPP_ERROR(
+      logger, "After activating, controller %s is in state %s, expected Active",
+      controller.info.name.c_str(), new_state.label().c_str());
+    return false;
+  }
+  return true;
+}
+
+/// Deactivate the lifecycle of a controller, once the real-time thread stopped updating it
+void deactivate_controller(const ControllerSpec & controller, const rclcpp::Logger & logger)
+{
+  const auto new_state = controller.c->get_lifecycle_node()->deactivate();
+  if (new_state.id() != lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE) {
+    RCLCPP_ERROR(
+      logger, "After deactivating, controller %s is in state %s, expected Inactive",
+      controller.info.name.c_str(), new_state.label().c_str());
+  }
+}
+
+/// Whether a controller claims reference interfaces exported by another one, updated after it
+bool writes_references_of(
+  const hardware_interface::ControllerInfo & writer,
+  const hardware_interface::ControllerInfo & exporter)
+{
+  for (const auto & references : exporter.references) {
+    const auto claimed = writer.resources.find(references.first);
+    if (claimed == writer.resources.end()) {
+      continue;
+    }
+    for (const auto & reference : references.second) {
+      if (std::find(claimed->second.begin(), claimed->second.end(), reference) !=
+        claimed->second.end())
+      {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/// Orders chained controllers, the ones writing reference interfaces before the ones exporting
+/// them, keeping the order of the other ones. Returns false, leaving the order as is, on a cycle.
+bool order_chained_controllers(std::vector<ControllerSpec> & controllers)
+{
+  std::vector<ControllerSpec> ordered;
+  ordered.reserve(controllers.size());
+  std::vector<bool> placed(controllers.size(), false);
+  while (ordered.size() < controllers.size()) {
+    bool progress = false;
+    for (size_t i = 0; i < controllers.size() && !progress; ++i) {
+      if (placed[i]) {
+        continue;
+      }
+      bool ready = true;
+      for (size_t j = 0; j < controllers.size() && ready; ++j) {
+        ready = placed[j] || j == i ||
+          !writes_references_of(controllers[j].info, controllers[i].info);
+      }
+      if (ready) {
+        ordered.push_back(controllers[i]);
+        placed[i] = true;
+        progress = true;
+      }
+    }
+    if (!progress) {
+      return false;
+    }
+  }
+  controllers = std::move(ordered);
+  return true;
+}
+
 rclcpp::NodeOptions get_cm_node_options()
 {
   rclcpp::NodeOptions node_options;
@@ -55,12 +312,12 @@ rclcpp::NodeOptions get_cm_node_options()
 ControllerManager::ControllerManager(
   std::shared_ptr<hardware_interface::RobotHardware> hw,
   std::shared_ptr<rclcpp::Executor> executor,
-  const std::string & manager_node_name)
+  const std::string & manager_node_name,
+  std::shared_ptr<ControllerLoader> loader)
 : rclcpp::Node(manager_node_name, get_cm_node_options()),
   hw_(hw),
   executor_(executor),
-  loader_(std::make_shared<pluginlib::ClassLoader<controller_interface::ControllerInterface>>(
-      kControllerInterfaceName, kControllerInterface))
+  loader_(loader ? loader : std::make_shared<ControllerLoader>())
 {
   using namespace std::placeholders;
   list_controllers_service_ = create_service<controller_manager_msgs::srv::ListControllers>(
@@ -72,6 +329,11 @@ ControllerManager::ControllerManager(
     "~/list_controller_types", std::bind(
       &ControllerManager::list_controller_types_srv_cb, this, _1,
       _2));
+  load_and_start_controllers_service_ =
+    create_service<controller_manager_msgs::srv::LoadAndStartControllers>(
+    "~/load_and_start_controllers", std::bind(
+      &ControllerManager::load_and_start_controllers_service_cb, this, _1,
+      _2));
   load_controller_service_ = create_service<controller_manager_msgs::srv::LoadController>(
     "~/load_controller", std::bind(
       &ControllerManager::load_controller_service_cb, this, _1,
@@ -89,6 +351,79 @@ ControllerManager::ControllerManager(
     "~/unload_controller", std::bind(
       &ControllerManager::unload_controller_service_cb, this, _1,
       _2));
+  dump_flight_record_service_ = create_service<controller_manager_msgs::srv::DumpFlightRecord>(
+    "~/dump_flight_record", std::bind(
+      &ControllerManager::dump_flight_record_service_cb, this, _1,
+      _2));
+  // latched, so monitors get the current controllers when they subscribe
+  controllers_publisher_ = create_publisher<controller_manager_msgs::msg::ControllerList>(
+    "~/controllers", rclcpp::QoS(1).transient_local());
+  update_controllers_snapshot();
+
+  // started here rather than on the first message logged from the real-time thread
+  hardware_interface::get_realtime_logger();
+
+  const int update_threads = declare_parameter<int>(kUpdateThreadsParam, 0);
+  const int update_threads_priority = declare_parameter<int>(kUpdateThreadsPriorityParam, 0);
+  if (update_threads > 0) {
+    set_update_threads(static_cast<size_t>(update_threads), update_threads_priority);
+  }
+
+  for (const auto & group_name :
+    declare_parameter<std::vector<std::string>>(kControllerGroupsParam, std::vector<std::string>()))
+  {
+    ControllerGroupOptions options;
+    const auto cpus = declare_parameter<std::vector<int64_t>>(
+      group_name + "." + kCpusParam, std::vector<int64_t>());
+    options.cpus.assign(cpus.begin(), cpus.end());
+    options.priority = declare_parameter<int>(group_name + "." + kPriorityParam, 0);
+    options.order = declare_parameter<int>(group_name + "." + kOrderParam, 0);
+    add_controller_group(group_name, options);
+  }
+
+  const int controller_executor_threads =
+    declare_parameter<int>(kControllerExecutorThreadsParam, 0);
+  const auto controller_executor_cpus =
+    declare_parameter<std::vector<int64_t>>(kControllerExecutorCpusParam, std::vector<int64_t>());
+  if (controller_executor_threads > 0) {
+    set_controller_executor(
+      static_cast<size_t>(controller_executor_threads),
+      std::vector<int>(controller_executor_cpus.begin(), controller_executor_cpus.end()));
+  }
+
+  preload_libraries_ = declare_parameter<bool>(kPreloadControllerLibrariesParam, false);
+  if (preload_libraries_) {
+    preload_controller_libraries();
+  }
+
+  const int flight_recorder_cycles = declare_parameter<int>(kFlightRecorderCyclesParam, 0);
+  const auto flight_recorder_directory =
+    declare_parameter<std::string>(kFlightRecorderDirectoryParam, ".");
+  if (flight_recorder_cycles > 0) {
+    FlightRecorderOptions options;
+    options.cycle_capacity = static_cast<size_t>(flight_recorder_cycles);
+    options.directory = flight_recorder_directory;
+    set_flight_recorder(std::make_shared<FlightRecorder>(options));
+  }
+
+  const int joint_state_broadcast_decimation =
+    declare_parameter<int>(kJointStateBroadcastDecimationParam, 0);
+  const double joint_state_broadcast_threshold =
+    declare_parameter<double>(kJointStateBroadcastThresholdParam, 0.0);
+  const int joint_state_broadcast_keyframe_interval =
+    declare_parameter<int>(kJointStateBroadcastKeyframeIntervalParam, 100);
+  if (joint_state_broadcast_decimation > 0) {
+    DynamicJointStateBroadcasterOptions options;
+    options.decimation = static_cast<size_t>(joint_state_broadcast_decimation);
+    options.change_threshold = joint_state_broadcast_threshold;
+    options.keyframe_interval =
+      static_cast<size_t>(std::max(joint_state_broadcast_keyframe_interval, 0));
+    set_joint_state_broadcaster(std::make_shared<DynamicJointStateBroadcaster>(options));
+  }
+
+  const int update_cpu_budget_us = declare_parameter<int>(kUpdateCpuBudgetParam, 0);
+  set_update_cpu_budget(std::chrono::microseconds(std::max(update_cpu_budget_us, 0)));
+  set_controller_accounting(declare_parameter<bool>(kControllerAccountingParam, true));
 }
 
 controller_interface::ControllerInterfaceSharedPtr ControllerManager::load_controller(
@@ -97,13 +432,14 @@ controller_interface::ControllerInterfaceSharedPtr ControllerManager::load_contr
 {
   RCLCPP_INFO(get_logger(), "Loading controller '%s'\n", controller_name.c_str());
 
-  if (!loader_->isClassAvailable(controller_type)) {
+  bind_controller_library(controller_name, controller_type);
+  controller_interface::ControllerInterfaceSharedPtr controller;
+  controller = loader_->create(controller_type);
+  if (!controller) {
     const std::string error_msg("Loader for controller '" + controller_name + "' not found\n");
     RCLCPP_ERROR(get_logger(), "%s", error_msg.c_str());
     throw std::runtime_error(error_msg);
   }
-
-  auto controller = loader_->createSharedInstance(controller_type);
   ControllerSpec controller_spec;
   controller_spec.c = controller;
   controller_spec.info.name = controller_name;
@@ -115,25 +451,151 @@ controller_interface::ControllerInterfaceSharedPtr ControllerManager::load_contr
 controller_interface::ControllerInterfaceSharedPtr ControllerManager::load_controller(
   const std::string & controller_name)
 {
-  const std::string param_name = controller_name + ".type";
-  std::string controller_type;
-
-  // We cannot declare the parameters for the controllers that will be loaded in the future,
-  // because they are plugins and we cannot be aware of all of them.
-  // So when we're told to load a controller by name, we need to declare the parameter if
-  // we haven't done so, and then read it.
-
-  // Check if parameter has been declared
-  if (!has_parameter(param_name)) {
-    declare_parameter(param_name, rclcpp::ParameterValue());
-  }
-  if (!get_parameter(param_name, controller_type)) {
+  const std::string controller_type = get_controller_type(controller_name);
+  if (controller_type.empty()) {
     RCLCPP_ERROR(get_logger(), "'type' param not defined for %s", controller_name.c_str());
     return nullptr;
   }
   return load_controller(controller_name, controller_type);
 }
 
+std::vector<controller_interface::ControllerInterfaceSharedPtr>
+ControllerManager::load_controllers(const std::vector<std::string> & controller_names)
+{
+  if (controller_names.empty()) {
+    return {};
+  }
+  std::vector<ControllerSpec> controllers(controller_names.size());
+  {
+    // the types are read here, as the parameters are declared on demand
+    std::lock_guard<std::recursive_mutex> guard(rt_controllers_wrapper_.controllers_lock_);
+    const auto & loaded_controllers = rt_controllers_wrapper_.get_updated_list(guard);
+    for (size_t i = 0; i < controller_names.size(); ++i) {
+      const auto & controller_name = controller_names[i];
+      const bool loaded =
+        std::find_if(
+        loaded_controllers.begin(), loaded_controllers.end(),
+        std::bind(controller_name_compare, std::placeholders::_1, controller_name)) !=
+        loaded_controllers.end() ||
+        std::find(controller_names.begin(), controller_names.begin() + i, controller_name) !=
+        controller_names.begin() + i;
+      if (loaded) {
+        RCLCPP_ERROR(
+          get_logger(),
+          "A controller named '%s' was already loaded inside the controller manager",
+          controller_name.c_str());
+        continue;
+      }
+      controllers[i].info.name = controller_name;
+      controllers[i].info.type = get_controller_type(controller_name);
+      if (controllers[i].info.type.empty()) {
+        RCLCPP_ERROR(get_logger(), "'type' param not defined for %s", controller_name.c_str());
+        continue;
+      }
+      bind_controller_library(controller_name, controllers[i].info.type);
+    }
+  }
+
+  // creating and configuring the controllers takes most of the loading time
+  auto initialize_controller = [this, &controllers](size_t index) {
+      auto & controller = controllers[index];
+      if (controller.info.type.empty()) {
+        return;
+      }
+      try {
+        controller.c = loader_->create(controller.info.type);
+        if (!controller.c) {
+          RCLCPP_ERROR(
+            get_logger(), "Loader for controller '%s' not found",
+            controller.info.name.c_str());
+          return;
+        }
+        controller.c->init(hw_, controller.info.name);
+        HARDWARE_INTERFACE_TRACE_SCOPE("configure_controller", controller.info.name.c_str());
+        controller.c->get_lifecycle_node()->configure();
+      } catch (const std::exception & e) {
+        RCLCPP_ERROR(
+          get_logger(), "Could not load controller '%s': %s",
+          controller.info.name.c_str(), e.what());
+        controller.c.reset();
+      }
+    };
+  const size_t hardware_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  const size_t worker_count = std::min(controllers.size(), hardware_threads) - 1;
+  if (worker_count > 0) {
+    ControllerWorkerPool load_pool(worker_count, 0);
+    load_pool.run(controllers.size(), initialize_controller);
+  } else {
+    for (size_t i = 0; i < controllers.size(); ++i) {
+      initialize_controller(i);
+    }
+  }
+
+  std::vector<ControllerSpec> initialized_controllers;
+  for (const auto & controller : controllers) {
+    if (controller.c) {
+      RCLCPP_INFO(get_logger(), "Loading controller '%s'", controller.info.name.c_str());
+      initialized_controllers.push_back(controller);
+    }
+  }
+  const auto added_controllers = add_configured_controllers(initialized_controllers);
+
+  std::vector<controller_interface::ControllerInterfaceSharedPtr> loaded_controllers;
+  loaded_controllers.reserve(controllers.size());
+  auto added_it = added_controllers.begin();
+  for (const auto & controller : controllers) {
+    loaded_controllers.push_back(controller.c ? *added_it++ : nullptr);
+  }
+  return loaded_controllers;
+}
+
+controller_interface::return_type ControllerManager::load_and_start_controllers(
+  const std::vector<std::string> & controller_names,
+  int strictness,
+  bool start_asap,
+  const rclcpp::Duration & timeout)
+{
+  const auto controllers = load_controllers(controller_names);
+
+  std::vector<std::string> start_controllers;
+  for (size_t i = 0; i < controllers.size(); ++i) {
+    if (controllers[i]) {
+      start_controllers.push_back(controller_names[i]);
+    }
+  }
+  const bool all_loaded = start_controllers.size() == controller_names.size();
+  if (!all_loaded &&
+    strictness == controller_manager_msgs::srv::SwitchController::Request::STRICT)
+  {
+    RCLCPP_ERROR(
+      get_logger(), "Could not load all the controllers, not starting any of them");
+    return controller_interface::return_type::ERROR;
+  }
+
+  const auto ret = switch_controller(start_controllers, {}, strictness, start_asap, timeout);
+  if (ret != controller_interface::return_type::SUCCESS) {
+    return ret;
+  }
+  return all_loaded ?
+         controller_interface::return_type::SUCCESS : controller_interface::return_type::ERROR;
+}
+
+controller_interface::return_type ControllerManager::preload_controller_libraries()
+{
+  auto ret = controller_interface::return_type::SUCCESS;
+  for (const auto & controller_type : loader_->get_declared_classes()) {
+    try {
+      loader_->load_library_for_class(controller_type);
+    } catch (const std::exception & e) {
+      RCLCPP_WARN(
+        get_logger(), "Could not preload the library of controller type '%s': %s",
+        controller_type.c_str(), e.what());
+      ret = controller_interface::return_type::ERROR;
+    }
+  }
+  return ret;
+}
+
 controller_interface::return_type ControllerManager::unload_controller(
   const std::string & controller_name)
 {
@@ -159,7 +621,11 @@ controller_interface::return_type ControllerManager::unload_controller(
 
   auto & controller = *found_it;
 
-  if (is_controller_running(*controller.c)) {
+  // also while a switch is starting it, or did not deactivate it yet
+  if (is_controller_running(controller) || pending_starts_.count(controller_name) > 0 ||
+    controller.c->get_lifecycle_node()->get_current_state().id() ==
+    lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE)
+  {
     to.clear();
     RCLCPP_ERROR(
       get_logger(),
@@ -168,19 +634,31 @@ controller_interface::return_type ControllerManager::unload_controller(
     return controller_interface::return_type::ERROR;
   }
 
+  // the controllers writing its reference interfaces hold handles to them
+  for (const auto & other : to) {
+    if (&other != &controller && writes_references_of(other.info, controller.info)) {
+      RCLCPP_ERROR(
+        get_logger(),
+        "Could not unload controller with name '%s' because controller '%s' writes its reference "
+        "interfaces", controller_name.c_str(), other.info.name.c_str());
+      to.clear();
+      return controller_interface::return_type::ERROR;
+    }
+  }
+
   RCLCPP_DEBUG(get_logger(), "Cleanup controller");
   controller.c->get_lifecycle_node()->cleanup();
-  executor_->remove_node(controller.c->get_lifecycle_node()->get_node_base_interface());
+  controller.c->unexport_reference_interfaces();
+  get_controller_executor()->remove_node(
+    controller.c->get_lifecycle_node()->get_node_base_interface());
   to.erase(found_it);
 
   // Destroys the old controllers list when the realtime thread is finished with it.
   RCLCPP_DEBUG(get_logger(), "Realtime switches over to new controller list");
   rt_controllers_wrapper_.switch_updated_list(guard);
-  std::vector<ControllerSpec> & new_unused_list = rt_controllers_wrapper_.get_unused_list(
-    guard);
-  RCLCPP_DEBUG(get_logger(), "Destruct controller");
-  new_unused_list.clear();
-  RCLCPP_DEBUG(get_logger(), "Destruct controller finished");
+  RCLCPP_DEBUG(get_logger(), "Retire old controllers list, destroyed in the background");
+  rt_controllers_wrapper_.retire_unused_list(guard);
+  update_controllers_snapshot();
 
   RCLCPP_DEBUG(get_logger(), "Successfully unloaded controller '%s'", controller_name.c_str());
   return controller_interface::return_type::SUCCESS;
@@ -192,6 +670,51 @@ std::vector<ControllerSpec> ControllerManager::get_loaded_controllers() const
   return rt_controllers_wrapper_.get_updated_list(guard);
 }
 
+std::shared_ptr<const ControllerManager::ControllersSnapshot>
+ControllerManager::get_controllers_snapshot() const
+{
+  return std::atomic_load(&controllers_snapshot_);
+}
+
+void ControllerManager::update_controllers_snapshot()
+{
+  auto snapshot = std::make_shared<ControllersSnapshot>();
+
+  // lock controllers, the snapshots are built and published in order
+  std::lock_guard<std::recursive_mutex> guard(rt_controllers_wrapper_.controllers_lock_);
+  const std::vector<ControllerSpec> & controllers =
+    rt_controllers_wrapper_.get_updated_list(guard);
+  snapshot->controllers.resize(controllers.size());
+  snapshot->update_timing.reserve(controllers.size());
+
+  for (size_t i = 0; i < controllers.size(); ++i) {
+    controller_manager_msgs::msg::ControllerState & cs = snapshot->controllers[i];
+    cs.name = controllers[i].info.name;
+    cs.type = controllers[i].info.type;
+    cs.state = controllers[i].c->get_lifecycle_node()->get_current_state().label();
+    cs.standby = is_controller_standby(controllers[i]);
+    for (const auto & claimed : controllers[i].info.resources) {
+      controller_manager_msgs::msg::HardwareInterfaceResources interface_resources;
+      interface_resources.hardware_interface = claimed.first;
+      interface_resources.resources = claimed.second;
+      cs.claimed_resources.push_back(interface_resources);
+    }
+    snapshot->update_timing.push_back(controllers[i].update_timing);
+    snapshot->cpu_budget.push_back(controllers[i].cpu_budget);
+    snapshot->accounting.push_back(controllers[i].accounting);
+  }
+
+  const auto previous_snapshot = std::atomic_load(&controllers_snapshot_);
+  snapshot->version = previous_snapshot ? previous_snapshot->version + 1 : 0;
+  std::atomic_store(
+    &controllers_snapshot_, std::shared_ptr<const ControllersSnapshot>(snapshot));
+
+  controller_manager_msgs::msg::ControllerList controller_list;
+  controller_list.version = snapshot->version;
+  controller_list.controller = snapshot->controllers;
+  controllers_publisher_->publish(controller_list);
+}
+
 controller_interface::return_type ControllerManager::switch_controller(
   const std::vector<std::string> & start_controllers,
   const std::vector<std::string> & stop_controllers,
@@ -199,14 +722,10 @@ controller_interface::return_type ControllerManager::switch_controller(
   bool start_asap,
   const rclcpp::Duration & timeout)
 {
-  switch_params_ = SwitchParams();
-
-  if (!stop_request_.empty() || !start_request_.empty()) {
-    RCLCPP_FATAL(
-      get_logger(),
-      "The internal stop and start request lists are not empty at the beginning of the "
-      "switchController() call. This should not happen.");
-  }
+  auto switch_request = std::make_shared<SwitchRequest>();
+  // names of the controllers to start and stop, resolved to their specs once validated
+  std::vector<std::string> start_request;
+  std::vector<std::string> stop_request;
 
   if (strictness == 0) {
     RCLCPP_WARN(
@@ -272,175 +791,374 @@ controller_interface::return_type ControllerManager::switch_controller(
     };
 
   // list all controllers to stop
-  auto ret = list_controllers(stop_controllers, stop_request_, "stop");
+  auto ret = list_controllers(stop_controllers, stop_request, "stop");
   if (ret != controller_interface::return_type::SUCCESS) {
-    stop_request_.clear();
     return ret;
   }
 
   // list all controllers to start
-  ret = list_controllers(start_controllers, start_request_, "start");
+  ret = list_controllers(start_controllers, start_request, "start");
   if (ret != controller_interface::return_type::SUCCESS) {
-    stop_request_.clear();
-    start_request_.clear();
     return ret;
   }
 
-#ifdef TODO_IMPLEMENT_RESOURCE_CHECKING
-  // Do the resource management checking
-  std::list<hardware_interface::ControllerInfo> info_list;
-  switch_start_list_.clear();
-  switch_stop_list_.clear();
-#endif
-
-  // lock controllers
-  std::lock_guard<std::recursive_mutex> guard(rt_controllers_wrapper_.controllers_lock_);
+  {
+    // lock controllers only while checking the request, not while waiting for the switch
+    std::lock_guard<std::recursive_mutex> guard(rt_controllers_wrapper_.controllers_lock_);
 
-  const std::vector<ControllerSpec> & controllers =
-    rt_controllers_wrapper_.get_updated_list(guard);
+    const std::vector<ControllerSpec> & controllers =
+      rt_controllers_wrapper_.get_updated_list(guard);
+    // claims of the controllers running once the switch is done
+    std::vector<const ControllerSpec *> claiming_controllers;
+    std::vector<const ResourceConflictChecker::ClaimMask *> claim_masks;
 
-  for (const auto & controller : controllers) {
-    auto stop_list_it = std::find(
-      stop_request_.begin(), stop_request_.end(), controller.info.name);
-    bool in_stop_list = stop_list_it != stop_request_.end();
+    for (const auto & controller : controllers) {
+      auto stop_list_it = std::find(
+        stop_request.begin(), stop_request.end(), controller.info.name);
+      bool in_stop_list = stop_list_it != stop_request.end();
 
-    auto start_list_it = std::find(
-      start_request_.begin(), start_request_.end(), controller.info.name);
-    bool in_start_list = start_list_it != start_request_.end();
+      auto start_list_it = std::find(
+        start_request.begin(), start_request.end(), controller.info.name);
+      bool in_start_list = start_list_it != start_request.end();
 
-    const bool is_running = is_controller_running(*controller.c);
+      const bool is_running = is_controller_running(controller);
 
-    auto handle_conflict = [&](const std::string & msg)
-      {
-        if (strictness == controller_manager_msgs::srv::SwitchController::Request::STRICT) {
-          RCLCPP_ERROR_STREAM(
+      auto handle_conflict = [&](const std::string & msg)
+        {
+          if (strictness == controller_manager_msgs::srv::SwitchController::Request::STRICT) {
+            RCLCPP_ERROR_STREAM(
+              get_logger(),
+              msg);
+            return controller_interface::return_type::ERROR;
+          }
+          RCLCPP_DEBUG_STREAM(
             get_logger(),
-            msg);
-          stop_request_.clear();
-          start_request_.clear();
-          return controller_interface::return_type::ERROR;
+            "Could not stop controller '" << controller.info.name <<
+              "' since it is not running");
+          return controller_interface::return_type::SUCCESS;
+        };
+      if (!is_running && in_stop_list) {      // check for double stop
+        auto ret = handle_conflict(
+          "Could not stop controller '" + controller.info.name +
+          "' since it is not running");
+        if (ret != controller_interface::return_type::SUCCESS) {
+          return ret;
         }
-        RCLCPP_DEBUG_STREAM(
-          get_logger(),
-          "Could not stop controller '" << controller.info.name <<
-            "' since it is not running");
-        return controller_interface::return_type::SUCCESS;
-      };
-    if (!is_running && in_stop_list) {      // check for double stop
-      auto ret = handle_conflict(
-        "Could not stop controller '" + controller.info.name +
-        "' since it is not running");
-      if (ret != controller_interface::return_type::SUCCESS) {
-        return ret;
+        in_stop_list = false;
+        stop_request.erase(stop_list_it);
       }
-      in_stop_list = false;
-      stop_request_.erase(stop_list_it);
-    }
 
-    if (is_running && !in_stop_list && in_start_list) {  // check for doubled start
-      auto ret = handle_conflict(
-        "Could not start controller '" + controller.info.name +
-        "' since it is already running");
-      if (ret != controller_interface::return_type::SUCCESS) {
-        return ret;
+      if (is_running && !in_stop_list && in_start_list) {  // check for doubled start
+        auto ret = handle_conflict(
+          "Could not start controller '" + controller.info.name +
+          "' since it is already running");
+        if (ret != controller_interface::return_type::SUCCESS) {
+          return ret;
+        }
+        in_start_list = false;
+        start_request.erase(start_list_it);
       }
-      in_start_list = false;
-      start_request_.erase(start_list_it);
-    }
 
-#ifdef TODO_IMPLEMENT_RESOURCE_CHECKING
-    if (is_running && in_stop_list && !in_start_list) {  // running and real stop
-      switch_stop_list_.push_back(info);
-    } else if (!is_running && !in_stop_list && in_start_list) {  // start, but no restart
-      switch_start_list_.push_back(info);
-    }
+      if (is_running && in_stop_list && !in_start_list) {  // running and real stop
+        switch_request->switch_stop_list.push_back(controller.info);
+      } else if (!is_running && !in_stop_list && in_start_list) {  // start, but no restart
+        switch_request->switch_start_list.push_back(controller.info);
+      }
 
-    bool add_to_list = is_running;
-    if (in_stop_list) {
-      add_to_list = false;
-    }
-    if (in_start_list) {
-      add_to_list = true;
+      // controllers which did not declare their claims are not checked
+      const bool running_after_switch = in_start_list || (is_running && !in_stop_list);
+      if (running_after_switch && !controller.claim_mask.empty()) {
+        claiming_controllers.push_back(&controller);
+        claim_masks.push_back(&controller.claim_mask);
+      }
     }
 
-    if (add_to_list) {
-      info_list.push_back(info);
+    size_t first, second, claim;
+    if (ResourceConflictChecker::find_conflict(claim_masks, first, second, claim)) {
+      RCLCPP_ERROR(
+        get_logger(),
+        "Could not switch controllers, due to resource conflict: '%s' is claimed by both "
+        "controllers '%s' and '%s'", resource_conflict_checker_.get_claim_name(claim).c_str(),
+        claiming_controllers[first]->info.name.c_str(),
+        claiming_controllers[second]->info.name.c_str());
+      return controller_interface::return_type::ERROR;
     }
-#endif
-  }
 
-#ifdef TODO_IMPLEMENT_RESOURCE_CHECKING
-  bool in_conflict = robot_hw_->checkForConflict(info_list);
-  if (in_conflict) {
-    RCLCPP_ERROR(get_logger(), "Could not switch controllers, due to resource conflict");
-    stop_request_.clear();
-    start_request_.clear();
-    return controller_interface::return_type::ERROR;
-  }
+    if (hw_->prepare_switch(switch_request->switch_start_list, switch_request->switch_stop_list) !=
+      hardware_interface::return_type::OK)
+    {
+      RCLCPP_ERROR(
+        get_logger(),
+        "Could not switch controllers. The hardware interface combination "
+        "for the requested controllers is unfeasible.");
+      return controller_interface::return_type::ERROR;
+    }
 
-  if (!robot_hw_->prepareSwitch(switch_start_list_, switch_stop_list_)) {
-    RCLCPP_ERROR(
-      get_logger(),
-      "Could not switch controllers. The hardware interface combination "
-      "for the requested controllers is unfeasible.");
-    stop_request_.clear();
-    start_request_.clear();
-    return controller_interface::return_type::ERROR;
-  }
-#endif
+    if (start_request.empty() && stop_request.empty()) {
+      RCLCPP_INFO(get_logger(), "Empty start and stop list, not requesting switch");
+      return controller_interface::return_type::SUCCESS;
+    }
 
-  if (start_request_.empty() && stop_request_.empty()) {
-    RCLCPP_INFO(get_logger(), "Empty start and stop list, not requesting switch");
-    return controller_interface::return_type::SUCCESS;
+    // resolve the controllers once here, the real-time thread only flips their running flags.
+    // The started controllers are activated before the real-time thread updates them
+    for (const auto & controller : controllers) {
+      const bool in_stop_list =
+        std::find(stop_request.begin(), stop_request.end(), controller.info.name) !=
+        stop_request.end();
+      const bool in_start_list =
+        std::find(start_request.begin(), start_request.end(), controller.info.name) !=
+        start_request.end();
+      if (in_stop_list) {
+        switch_request->stop_controllers.push_back(controller);
+      }
+      if (!in_start_list) {
+        continue;
+      }
+      const bool is_running = is_controller_running(controller);
+      if (in_stop_list && is_running) {
+        switch_request->restart_controllers.push_back(controller);
+      } else if (is_running || is_controller_standby(controller)) {
+        switch_request->start_controllers.push_back(controller);
+      } else if (activate_controller(controller, get_logger())) {
+        warm_up_controller(controller);
+        switch_request->start_controllers.push_back(controller);
+      } else {
+        // not started, the switch of the other controllers goes on
+        continue;
+      }
+      ++pending_starts_[controller.info.name];
+    }
   }
 
-  // start the atomic controller switching
-  switch_params_.strictness = strictness;
-  switch_params_.start_asap = start_asap;
-  switch_params_.init_time = rclcpp::Clock().now();
-  switch_params_.timeout = timeout;
-  switch_params_.do_switch = true;
-
-  // wait until switch is finished
+  // queue the atomic controller switching
+  switch_request->strictness = strictness;
+  switch_request->start_asap = start_asap;
+  switch_request->init_time = rclcpp::Clock().now();
+  switch_request->timeout = timeout;
   RCLCPP_DEBUG(get_logger(), "Request atomic controller switch from realtime loop");
-  while (rclcpp::ok() && switch_params_.do_switch) {
-    if (!rclcpp::ok()) {
-      return controller_interface::return_type::ERROR;
+  auto result = queue_switch_request(switch_request);
+  auto restart_request = complete_switch(*switch_request);
+  if (restart_request) {
+    RCLCPP_DEBUG(get_logger(), "Request the start of the restarted controllers");
+    if (queue_switch_request(restart_request) != controller_interface::return_type::SUCCESS) {
+      result = controller_interface::return_type::ERROR;
     }
-    std::this_thread::sleep_for(std::chrono::microseconds(100));
+    complete_switch(*restart_request);
   }
-  start_request_.clear();
-  stop_request_.clear();
+  update_controllers_snapshot();
 
-  RCLCPP_DEBUG(get_logger(), "Successfully switched controllers");
+  if (result != controller_interface::return_type::SUCCESS) {
+    RCLCPP_ERROR(
+      get_logger(), "Could not switch controllers, the hardware failed to switch or timed out");
+    return result;
+  }
+  RCLCPP_DEBUG(
+    get_logger(), "Successfully switched controllers, requested -> applied in %ld us",
+    static_cast<long>(std::chrono::duration_cast<std::chrono::microseconds>(
+      switch_request->applied_time - switch_request->requested_time).count()));
   return controller_interface::return_type::SUCCESS;
 }
 
-controller_interface::ControllerInterfaceSharedPtr
-ControllerManager::add_controller_impl(
-  const ControllerSpec & controller)
+controller_interface::return_type ControllerManager::set_controllers_standby(
+  const std::vector<std::string> & controller_names, bool standby)
 {
-  // lock controllers
-  std::lock_guard<std::recursive_mutex> guard(rt_controllers_wrapper_.controllers_lock_);
-
-  std::vector<ControllerSpec> & to = rt_controllers_wrapper_.get_unused_list(guard);
-  const std::vector<ControllerSpec> & from = rt_controllers_wrapper_.get_updated_list(guard);
-
-  // Copy all controllers from the 'from' list to the 'to' list
-  to = from;
-
-  auto found_it = std::find_if(
-    to.begin(), to.end(),
-    std::bind(controller_name_compare, std::placeholders::_1, controller.info.name));
-  // Checks that we're not duplicating controllers
-  if (found_it != to.end()) {
-    to.clear();
-    RCLCPP_ERROR(
-      get_logger(),
-      "A controller named '%s' was already loaded inside the controller manager",
-      controller.info.name.c_str());
+  auto result = controller_interface::return_type::SUCCESS;
+  auto switch_request = std::make_shared<SwitchRequest>();
+  {
+    std::lock_guard<std::recursive_mutex> guard(rt_controllers_wrapper_.controllers_lock_);
+    const auto & controllers = rt_controllers_wrapper_.get_updated_list(guard);
+    for (const auto & controller_name : controller_names) {
+      auto found_it = std::find_if(
+        controllers.begin(), controllers.end(),
+        std::bind(controller_name_compare, std::placeholders::_1, controller_name));
+      if (found_it == controllers.end()) {
+        RCLCPP_ERROR(
+          get_logger(), "Could not change the standby of controller '%s', it is not loaded",
+          controller_name.c_str());
+        result = controller_interface::return_type::ERROR;
+        continue;
+      }
+      const auto & controller = *found_it;
+      if (is_controller_running(controller) || pending_starts_.count(controller_name) > 0) {
+        RCLCPP_ERROR(
+          get_logger(), "Could not change the standby of controller '%s', it is running",
+          controller_name.c_str());
+        result = controller_interface::return_type::ERROR;
+        continue;
+      }
+      if (is_controller_standby(controller) == standby) {
+        continue;
+      }
+      if (!standby) {
+        switch_request->leave_standby_controllers.push_back(controller);
+      } else if (activate_controller(controller, get_logger())) {
+        switch_request->enter_standby_controllers.push_back(controller);
+      } else {
+        result = controller_interface::return_type::ERROR;
+      }
+    }
+  }
+  if (switch_request->enter_standby_controllers.empty() &&
+    switch_request->leave_standby_controllers.empty())
+  {
+    return result;
+  }
+
+  // flipped by the real-time thread, which then updates the controllers in standby
+  if (queue_switch_request(switch_request) != controller_interface::return_type::SUCCESS) {
+    result = controller_interface::return_type::ERROR;
+  }
+  {
+    std::lock_guard<std::recursive_mutex> guard(rt_controllers_wrapper_.controllers_lock_);
+    for (const auto & controller : switch_request->enter_standby_controllers) {
+      if (!is_controller_standby(controller)) {
+        deactivate_controller(controller, get_logger());
+      }
+    }
+    // unless a switch started it in between
+    for (const auto & controller : switch_request->leave_standby_controllers) {
+      if (!is_controller_standby(controller) && !is_controller_running(controller) &&
+        pending_starts_.count(controller.info.name) == 0)
+      {
+        deactivate_controller(controller, get_logger());
+      }
+    }
+  }
+  update_controllers_snapshot();
+  return result;
+}
+
+controller_interface::return_type ControllerManager::queue_switch_request(
+  const std::shared_ptr<SwitchRequest> & switch_request)
+{
+  switch_request->claimed_joint_values = get_claimed_joint_values(*switch_request);
+  switch_request->requested_time = std::chrono::steady_clock::now();
+  switch_request->start_finished.assign(switch_request->start_controllers.size(), false);
+  {
+    std::lock_guard<std::mutex> guard(switch_requests_lock_);
+    // destroyed here once applied, out of the real-time thread
+    abandoned_switch_requests_.erase(
+      std::remove_if(
+        abandoned_switch_requests_.begin(), abandoned_switch_requests_.end(),
+        [](const std::shared_ptr<SwitchRequest> & request) {
+          return request->applied.load(std::memory_order_acquire);
+        }), abandoned_switch_requests_.end());
+    pending_switch_requests_.push_back(switch_request);
+    has_pending_switch_requests_ = true;
+  }
+
+  if (stepping_) {
+    // this thread runs the cycles, so it applies the switch itself
+    manage_switch();
+    if (!switch_request->applied) {
+      for (auto & request : rt_switch_requests_) {
+        request->expired = true;
+      }
+      manage_switch();
+    }
+    rt_controllers_wrapper_.invalidate_rt_active_controllers();
+    return switch_request->result;
+  }
+
+  // wait until switch is finished, woken by the real-time thread, and at times to check for the
+  // shutdown. The count is read before the flag so that an increment in between is not missed
+  while (true) {
+    const auto applied_switch_requests = applied_switch_requests_.load(std::memory_order_acquire);
+    if (switch_request->applied.load(std::memory_order_acquire)) {
+      return switch_request->result;
+    }
+    if (!rclcpp::ok()) {
+      // the real-time thread may still apply it, and must not release the last reference
+      std::lock_guard<std::mutex> guard(switch_requests_lock_);
+      abandoned_switch_requests_.push_back(switch_request);
+      return controller_interface::return_type::ERROR;
+    }
+    futex_wait_for(
+      applied_switch_requests_, applied_switch_requests, std::chrono::milliseconds(100));
+  }
+}
+
+std::shared_ptr<ControllerManager::SwitchRequest>
+ControllerManager::complete_switch(const SwitchRequest & switch_request)
+{
+  std::lock_guard<std::recursive_mutex> guard(rt_controllers_wrapper_.controllers_lock_);
+  const auto release_pending_start = [this](const ControllerSpec & controller) {
+      auto pending_it = pending_starts_.find(controller.info.name);
+      if (pending_it != pending_starts_.end() && --pending_it->second == 0) {
+        pending_starts_.erase(pending_it);
+      }
+    };
+  // a controller is left active while another queued request is about to start it
+  const auto is_pending_start = [this](const ControllerSpec & controller) {
+      return pending_starts_.count(controller.info.name) > 0;
+    };
+
+  for (const auto & controller : switch_request.start_controllers) {
+    release_pending_start(controller);
+  }
+  for (const auto & controller : switch_request.stop_controllers) {
+    if (!is_controller_running(controller) && !is_pending_start(controller)) {
+      deactivate_controller(controller, get_logger());
+    }
+  }
+  for (const auto & controller : switch_request.start_controllers) {
+    // the hardware failed to switch or took too long, a controller in standby stays in standby
+    if (!is_controller_running(controller) && !is_controller_standby(controller) &&
+      !is_pending_start(controller))
+    {
+      deactivate_controller(controller, get_logger());
+    }
+  }
+
+  if (switch_request.restart_controllers.empty()) {
     return nullptr;
   }
+  auto restart_request = std::make_shared<SwitchRequest>();
+  restart_request->strictness = switch_request.strictness;
+  restart_request->start_asap = switch_request.start_asap;
+  restart_request->init_time = switch_request.init_time;
+  restart_request->timeout = switch_request.timeout;
+  for (const auto & controller : switch_request.restart_controllers) {
+    // still counted as pending, so the request stopping it did not deactivate it
+    if (controller.c->get_lifecycle_node()->get_current_state().id() ==
+      lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE)
+    {
+      deactivate_controller(controller, get_logger());
+    }
+    if (activate_controller(controller, get_logger())) {
+      restart_request->start_controllers.push_back(controller);
+    } else {
+      release_pending_start(controller);
+    }
+  }
+  if (restart_request->start_controllers.empty()) {
+    return nullptr;
+  }
+  return restart_request;
+}
+
+controller_interface::ControllerInterfaceSharedPtr
+ControllerManager::add_controller_impl(
+  const ControllerSpec & controller)
+{
+  {
+    // lock controllers
+    std::lock_guard<std::recursive_mutex> guard(rt_controllers_wrapper_.controllers_lock_);
+    const std::vector<ControllerSpec> & from = rt_controllers_wrapper_.get_updated_list(guard);
+
+    // Checks that we're not duplicating controllers
+    if (std::find_if(
+        from.begin(), from.end(),
+        std::bind(controller_name_compare, std::placeholders::_1, controller.info.name)) !=
+      from.end())
+    {
+      RCLCPP_ERROR(
+        get_logger(),
+        "A controller named '%s' was already loaded inside the controller manager",
+        controller.info.name.c_str());
+      return nullptr;
+    }
+  }
 
   controller.c->init(hw_, controller.info.name);
 
@@ -448,213 +1166,521 @@ ControllerManager::add_controller_impl(
   // Probably the whole load_controller part should fail if the controller_manager
   // is not configured, should it implement a LifecycleNodeInterface
   // https://github.com/ros-controls/ros2_control/issues/152
-  controller.c->get_lifecycle_node()->configure();
-  executor_->add_node(controller.c->get_lifecycle_node()->get_node_base_interface());
-  to.emplace_back(controller);
+  {
+    HARDWARE_INTERFACE_TRACE_SCOPE("configure_controller", controller.info.name.c_str());
+    controller.c->get_lifecycle_node()->configure();
+  }
+
+  return add_configured_controllers({controller}).front();
+}
+
+std::vector<controller_interface::ControllerInterfaceSharedPtr>
+ControllerManager::add_configured_controllers(const std::vector<ControllerSpec> & controllers)
+{
+  std::vector<controller_interface::ControllerInterfaceSharedPtr> added_controllers;
+  added_controllers.reserve(controllers.size());
+
+  // lock controllers
+  std::lock_guard<std::recursive_mutex> guard(rt_controllers_wrapper_.controllers_lock_);
+
+  std::vector<ControllerSpec> & to = rt_controllers_wrapper_.get_unused_list(guard);
+  const std::vector<ControllerSpec> & from = rt_controllers_wrapper_.get_updated_list(guard);
+
+  // Copy all controllers from the 'from' list to the 'to' list
+  to = from;
+
+  for (const auto & controller : controllers) {
+    auto found_it = std::find_if(
+      to.begin(), to.end(),
+      std::bind(controller_name_compare, std::placeholders::_1, controller.info.name));
+    // Checks that we're not duplicating controllers
+    if (found_it != to.end()) {
+      RCLCPP_ERROR(
+        get_logger(),
+        "A controller named '%s' was already loaded inside the controller manager",
+        controller.info.name.c_str());
+      added_controllers.push_back(nullptr);
+      continue;
+    }
+
+    get_controller_executor()->add_node(
+      controller.c->get_lifecycle_node()->get_node_base_interface());
+    const auto update_period = get_update_period(controller.info.name);
+    const auto update_phase = get_update_phase(to, update_period);
+    if (controller.c->export_reference_interfaces() != controller_interface::return_type::SUCCESS) {
+      RCLCPP_ERROR(
+        get_logger(), "Could not export the reference interfaces of controller '%s'",
+        controller.info.name.c_str());
+      get_controller_executor()->remove_node(
+        controller.c->get_lifecycle_node()->get_node_base_interface());
+      added_controllers.push_back(nullptr);
+      continue;
+    }
+    to.emplace_back(controller);
+    to.back().info.resources = controller.c->get_claimed_resources();
+    to.back().info.read_states = controller.c->get_read_state_interfaces();
+    to.back().info.references = controller.c->get_exported_reference_interfaces();
+    // chained controllers are updated in the order of the list
+    if (!order_chained_controllers(to)) {
+      RCLCPP_ERROR(
+        get_logger(),
+        "Could not load controller '%s', its reference interfaces would chain it to itself",
+        controller.info.name.c_str());
+      to.pop_back();
+      controller.c->unexport_reference_interfaces();
+      get_controller_executor()->remove_node(
+        controller.c->get_lifecycle_node()->get_node_base_interface());
+      added_controllers.push_back(nullptr);
+      continue;
+    }
+    auto & added = *std::find_if(
+      to.begin(), to.end(),
+      std::bind(controller_name_compare, std::placeholders::_1, controller.info.name));
+    added.claim_mask = resource_conflict_checker_.get_claim_mask(added.info);
+    added.joint_value_mask = get_joint_value_mask(*hw_, added.info);
+    added.update_period = update_period;
+    added.update_phase = update_phase;
+    added.warm_up_updates = get_warm_up_updates(controller.info.name);
+    added.group = get_controller_group(controller.info.name);
+    added.group_order =
+      added.group > 0 ? controller_groups_[added.group - 1]->get_options().order : 0;
+    added.update_timing = std::make_shared<TimingProbe>();
+    added.cpu_budget =
+      std::make_shared<ControllerCpuBudget>(get_cpu_budget_options(controller.info.name));
+    added.accounting = std::make_shared<ControllerAccounting>();
+    added.input_tracker = make_input_tracker(*hw_, *added.c, added.info);
+    added.running = std::make_shared<std::atomic<bool>>(
+      controller.c->get_lifecycle_node()->get_current_state().id() ==
+      lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE);
+    added.standby = std::make_shared<std::atomic<bool>>(false);
+    added_controllers.push_back(added.c);
+  }
+
+  if (to.size() == from.size()) {
+    to.clear();
+    return added_controllers;
+  }
 
   // Destroys the old controllers list when the realtime thread is finished with it.
   RCLCPP_DEBUG(get_logger(), "Realtime switches over to new controller list");
   rt_controllers_wrapper_.switch_updated_list(guard);
-  RCLCPP_DEBUG(get_logger(), "Destruct controller");
-  std::vector<ControllerSpec> & new_unused_list = rt_controllers_wrapper_.get_unused_list(
-    guard);
-  new_unused_list.clear();
-  RCLCPP_DEBUG(get_logger(), "Destruct controller finished");
+  RCLCPP_DEBUG(get_logger(), "Retire old controllers list, destroyed in the background");
+  rt_controllers_wrapper_.retire_unused_list(guard);
+  update_controllers_snapshot();
 
-  return to.back().c;
+  return added_controllers;
 }
 
-void ControllerManager::manage_switch()
+unsigned int ControllerManager::get_update_period(const std::string & controller_name)
 {
-#ifdef TODO_IMPLEMENT_RESOURCE_CHECKING
-  // switch hardware interfaces (if any)
-  if (!switch_params_.started) {
-    robot_hw_->doSwitch(switch_start_list_, switch_stop_list_);
-    switch_params_.started = true;
+  // declared on demand, as the type of the controllers, to pick up the parameter overrides
+  const std::string param_name = controller_name + "." + kUpdateRateParam;
+  if (!has_parameter(param_name)) {
+    declare_parameter(param_name, rclcpp::ParameterValue());
+  }
+  int controller_rate = 0;
+  if (!get_parameter(param_name, controller_rate) || controller_rate <= 0) {
+    return 1;
   }
-#endif
 
-  stop_controllers();
+  if (!has_parameter(kUpdateRateParam)) {
+    declare_parameter(kUpdateRateParam, rclcpp::ParameterValue());
+  }
+  int manager_rate = 0;
+  if (!get_parameter(kUpdateRateParam, manager_rate) || manager_rate <= 0) {
+    RCLCPP_WARN(
+      get_logger(),
+      "'%s' param not defined for the controller manager, controller '%s' is updated on every "
+      "update", kUpdateRateParam, controller_name.c_str());
+    return 1;
+  }
+  if (controller_rate >= manager_rate) {
+    if (controller_rate > manager_rate) {
+      RCLCPP_WARN(
+        get_logger(),
+        "Controller '%s' update rate %d Hz is higher than the controller manager update rate "
+        "%d Hz, it is updated on every update", controller_name.c_str(), controller_rate,
+        manager_rate);
+    }
+    return 1;
+  }
 
-  // start controllers once the switch is fully complete
-  if (!switch_params_.start_asap) {
-    start_controllers();
-  } else {
-    // start controllers as soon as their required joints are done switching
-    start_controllers_asap();
+  const auto update_period = static_cast<unsigned int>(
+    std::lround(static_cast<double>(manager_rate) / controller_rate));
+  if (manager_rate % controller_rate != 0) {
+    RCLCPP_WARN(
+      get_logger(),
+      "Controller '%s' update rate %d Hz does not divide the controller manager update rate "
+      "%d Hz, it is updated at %.2f Hz", controller_name.c_str(), controller_rate, manager_rate,
+      static_cast<double>(manager_rate) / update_period);
   }
+  return update_period;
 }
 
-void ControllerManager::stop_controllers()
+unsigned int ControllerManager::get_update_phase(
+  const std::vector<ControllerSpec> & controllers, unsigned int update_period)
 {
-  std::vector<ControllerSpec> & rt_controller_list =
-    rt_controllers_wrapper_.update_and_get_used_by_rt_list();
-  // stop controllers
-  for (const auto & request : stop_request_) {
-    auto found_it = std::find_if(
-      rt_controller_list.begin(), rt_controller_list.end(),
-      std::bind(controller_name_compare, std::placeholders::_1, request));
-    if (found_it == rt_controller_list.end()) {
-      RCLCPP_ERROR(
-        get_logger(),
-        "Got request to stop controller %s but it is not in the realtime controller list",
-        request.c_str());
-      continue;
+  if (update_period <= 1) {
+    return 0;
+  }
+
+  // the updates repeat with the least common multiple of the periods
+  uint64_t hyperperiod = update_period;
+  for (const auto & controller : controllers) {
+    if (controller.update_period > 1) {
+      const auto period = static_cast<uint64_t>(controller.update_period);
+      uint64_t a = hyperperiod, b = period;
+      while (b != 0) {
+        const auto r = a % b;
+        a = b;
+        b = r;
+      }
+      hyperperiod = hyperperiod / a * period;
+      if (hyperperiod > kMaxUpdateHyperperiod) {
+        hyperperiod = update_period;
+        break;
+      }
     }
-    auto controller = found_it->c;
-    if (is_controller_running(*controller)) {
-      const auto new_state = controller->get_lifecycle_node()->deactivate();
-      if (new_state.id() != lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE) {
-        RCLCPP_ERROR(
-          get_logger(),
-          "After deactivating, controller %s is in state %s, expected Inactive",
-          request.c_str(),
-          new_state.label().c_str());
+  }
+
+  // count the controllers updated at a lower rate on each tick, the ones updated on every tick
+  // add the same load to all the phases
+  std::vector<unsigned int> load(hyperperiod, 0u);
+  for (const auto & controller : controllers) {
+    if (controller.update_period > 1) {
+      for (uint64_t tick = controller.update_phase; tick < hyperperiod;
+        tick += controller.update_period)
+      {
+        ++load[tick];
       }
     }
   }
+
+  // pick the phase with the fewest coinciding updates, the lowest in case of a tie
+  unsigned int best_phase = 0;
+  uint64_t best_load = std::numeric_limits<uint64_t>::max();
+  for (unsigned int phase = 0; phase < update_period; ++phase) {
+    uint64_t phase_load = 0;
+    for (uint64_t tick = phase; tick < hyperperiod; tick += update_period) {
+      phase_load += load[tick];
+    }
+    if (phase_load < best_load) {
+      best_load = phase_load;
+      best_phase = phase;
+    }
+  }
+  return best_phase;
 }
 
-void ControllerManager::start_controllers()
+ControllerCpuBudgetOptions
+ControllerManager::get_cpu_budget_options(const std::string & controller_name)
 {
-#ifdef TODO_IMPLEMENT_RESOURCE_CHECKING
-  // start controllers
-  if (robot_hw_->switchResult() == hardware_interface::RobotHW::SwitchState::DONE) {
-    for (const auto & request : start_request_) {
-      request->startRequest(time);
-    }
+  // declared on demand, as the update rate of the controllers
+  auto get_controller_parameter = [this, &controller_name](const char * name, auto & value) {
+      const std::string param_name = controller_name + "." + name;
+      if (!has_parameter(param_name)) {
+        declare_parameter(param_name, rclcpp::ParameterValue());
+      }
+      return get_parameter(param_name, value);
+    };
 
-    switch_params_.do_switch = false;
-  } else if (// NOLINT
-    (robot_hw_->switchResult() == hardware_interface::RobotHW::SwitchState::ERROR) ||
-    (switch_params_.timeout > 0.0 &&
-    (time - switch_params_.init_time).toSec() > switch_params_.timeout))
+  ControllerCpuBudgetOptions options;
+  int priority = 0;
+  if (get_controller_parameter(kPriorityParam, priority)) {
+    options.priority = priority;
+  }
+  int budget_us = 0;
+  if (!get_controller_parameter(kCpuBudgetParam, budget_us) || budget_us <= 0) {
+    return options;
+  }
+  options.budget_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::microseconds(budget_us)).count();
+  std::string policy;
+  if (get_controller_parameter(kOverrunPolicyParam, policy) &&
+    !ControllerCpuBudget::from_string(policy, options.policy))
   {
-    // abort controllers in case of error or timeout (if set)
-    for (const auto & request : start_request_) {
-      request->abortRequest(time);
+    RCLCPP_WARN(
+      get_logger(), "Unknown overrun policy '%s' of controller '%s', its updates are skipped",
+      policy.c_str(), controller_name.c_str());
+  }
+  int overrun_limit = 0;
+  if (get_controller_parameter(kOverrunLimitParam, overrun_limit) && overrun_limit > 0) {
+    options.overrun_limit = static_cast<unsigned int>(overrun_limit);
+  }
+  return options;
+}
+
+size_t ControllerManager::get_controller_group(const std::string & controller_name)
+{
+  // declared on demand, as the update rate of the controllers
+  const std::string param_name = controller_name + "." + kGroupParam;
+  if (!has_parameter(param_name)) {
+    declare_parameter(param_name, rclcpp::ParameterValue());
+  }
+  std::string group_name;
+  if (!get_parameter(param_name, group_name) || group_name.empty()) {
+    return 0;
+  }
+  for (const auto & group : controller_groups_) {
+    if (group->get_name() == group_name) {
+      return group->get_index() + 1;
     }
+  }
+  RCLCPP_WARN(
+    get_logger(), "Unknown group '%s' of controller '%s', it is updated out of any group",
+    group_name.c_str(), controller_name.c_str());
+  return 0;
+}
 
-    switch_params_.do_switch = false;
-  } else {
-    // wait controllers
-    for (const auto & request : start_request_) {
-      request->waitRequest(time);
+unsigned int ControllerManager::get_warm_up_updates(const std::string & controller_name)
+{
+  // declared on demand, as the update rate of the controllers
+  const std::string param_name = controller_name + "." + kWarmUpUpdatesParam;
+  if (!has_parameter(param_name)) {
+    declare_parameter(param_name, rclcpp::ParameterValue());
+  }
+  int warm_up_updates = 0;
+  if (!get_parameter(param_name, warm_up_updates) || warm_up_updates <= 0) {
+    return 0;
+  }
+  return static_cast<unsigned int>(warm_up_updates);
+}
+
+void ControllerManager::bind_controller_library(
+  const std::string & controller_name, const std::string & controller_type)
+{
+  if (get_warm_up_updates(controller_name) == 0) {
+    return;
+  }
+  // the symbols of an already opened library are bound by the dry-run updates instead
+  if (!loader_->bind_library_now(controller_type)) {
+    RCLCPP_DEBUG(
+      get_logger(), "Could not bind the library of controller '%s' immediately",
+      controller_name.c_str());
+  }
+}
+
+void ControllerManager::warm_up_controller(const ControllerSpec & controller)
+{
+  if (controller.warm_up_updates == 0) {
+    return;
+  }
+  HARDWARE_INTERFACE_TRACE_SCOPE("warm_up_controller", controller.info.name.c_str());
+  // the period the controller is updated with, or the one of a 1 kHz loop if it is not known
+  int manager_rate = 0;
+  if (!get_parameter(kUpdateRateParam, manager_rate) || manager_rate <= 0) {
+    manager_rate = 1000;
+  }
+  const rclcpp::Duration period(
+    std::chrono::nanoseconds(
+      static_cast<int64_t>(controller.update_period) * 1000000000 / manager_rate));
+  // the time of the cycles is only known to the thread running them, the steady clock stands in
+  rclcpp::Time time = is_stepping() ? get_step_time() : rclcpp::Time(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count(),
+    RCL_STEADY_TIME);
+  for (unsigned int i = 0; i < controller.warm_up_updates; ++i) {
+    time = time + period;
+    if (controller.c->warm_up(time, period) != controller_interface::return_type::SUCCESS) {
+      RCLCPP_WARN(
+        get_logger(), "The warm up of controller '%s' failed after %u dry-run updates",
+        controller.info.name.c_str(), i);
+      return;
     }
   }
-#else
-  //  Dummy implementation, replace with the code above when migrated
-  std::vector<ControllerSpec> & rt_controller_list =
-    rt_controllers_wrapper_.update_and_get_used_by_rt_list();
-  for (const auto & request : start_request_) {
-    auto found_it = std::find_if(
-      rt_controller_list.begin(), rt_controller_list.end(),
-      std::bind(controller_name_compare, std::placeholders::_1, request));
-    if (found_it == rt_controller_list.end()) {
-      RCLCPP_ERROR(
-        get_logger(),
-        "Got request to start controller %s but it is not in the realtime controller list",
-        request.c_str());
-      continue;
+}
+
+void ControllerManager::manage_switch()
+{
+  if (rt_switch_requests_.empty()) {
+    // never block the real-time thread, requests being queued are picked up in the next cycle
+    std::unique_lock<std::mutex> lock(switch_requests_lock_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+      return;
     }
-    auto controller = found_it->c;
-    const auto new_state = controller->get_lifecycle_node()->activate();
-    if (new_state.id() != lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE) {
-      RCLCPP_ERROR(
-        get_logger(),
-        "After activating, controller %s is in state %s, expected Active",
-        controller->get_lifecycle_node()->get_name(),
-        new_state.label().c_str());
-    }
-  }
-  // All controllers started, switching done
-  switch_params_.do_switch = false;
-#endif
-}
-
-void ControllerManager::start_controllers_asap()
-{
-#ifdef TODO_IMPLEMENT_RESOURCE_CHECKING
-  // start controllers if possible
-  for (const auto & request : start_request_) {
-    if (!isControllerRunning(*request)) {
-      // find the info from this controller
-      for (const auto & controller : controllers_lists_[current_controllers_list_]) {
-        if (request == controller.c.get()) {
-          // ready to start
-          if (robot_hw_->switchResult(controller.info) ==
-            hardware_interface::RobotHW::SwitchState::DONE)
-          {
-            request->startRequest(time);
-          } else if ((robot_hw_->switchResult(controller.info) == // NOLINT
-            hardware_interface::RobotHW::SwitchState::ERROR) ||
-            (switch_params_.timeout > 0.0 &&
-            (time - switch_params_.init_time).toSec() > switch_params_.timeout)) // NOLINT
-          {
-            // abort on error or timeout (if set)
-            request->abortRequest(time);
-          } else {
-            // controller is waiting
-            request->waitRequest(time);
-          }
+    rt_switch_requests_.swap(pending_switch_requests_);
+    has_pending_switch_requests_ = false;
+  }
+
+  // apply the requests in order, one that is not done yet blocks the ones queued after it
+  auto request_it = rt_switch_requests_.begin();
+  for (; request_it != rt_switch_requests_.end(); ++request_it) {
+    auto & request = **request_it;
+    if (!request.started) {
+      request.started = true;
+      // switch hardware interfaces (if any)
+      if (hw_->perform_switch(request.switch_start_list, request.switch_stop_list) !=
+        hardware_interface::return_type::OK)
+      {
+        HARDWARE_INTERFACE_RT_LOG_ERROR(
+          get_logger().get_name(),
+          "The hardware failed to switch, no controller is started nor stopped");
+        request.result = controller_interface::return_type::ERROR;
+        request.done = true;
+      } else {
+        // the stopped controllers stop now, the started ones once the hardware is done switching
+        if (!request.claimed_joint_values.empty()) {
+          hw_->set_claimed_joint_values(request.claimed_joint_values);
         }
-        continue;
+        stop_controllers(request);
+      }
+    }
+
+    if (!request.done) {
+      if (!request.start_asap) {
+        // start controllers once the switch is fully complete
+        start_controllers(request);
+      } else {
+        // start controllers as soon as their required joints are done switching
+        start_controllers_asap(request);
       }
     }
+
+    if (!request.done) {
+      break;
+    }
+    request.applied_time = std::chrono::steady_clock::now();
+    // the requesting thread holds the last reference until it sees the request applied, or hands
+    // it to abandoned_switch_requests_ when it stops waiting, so the request is never destroyed
+    // in the real-time thread
+    request_it->reset();
+    request.applied.store(true, std::memory_order_release);
   }
+  if (request_it != rt_switch_requests_.begin()) {
+    // wakes the requesting threads without taking a lock
+    applied_switch_requests_.fetch_add(1, std::memory_order_release);
+    futex_wake(applied_switch_requests_, true);
+  }
+  rt_switch_requests_.erase(rt_switch_requests_.begin(), request_it);
+}
 
-  // all needed controllers started or aborted, switch done
-  if (std::all_of(
-      start_request_.begin(), start_request_.end(),
-      [](controller_interface::ControllerBase * request) {
-        return request->isRunning() || request->isAborted();
-      }))
+std::vector<uint64_t> ControllerManager::get_claimed_joint_values(const SwitchRequest & request)
+{
+  std::vector<uint64_t> claimed(hw_->get_joint_value_mask_size(), 0);
+  if (claimed.empty()) {
+    return claimed;
+  }
+  std::lock_guard<std::recursive_mutex> guard(rt_controllers_wrapper_.controllers_lock_);
+  for (const auto & controller : rt_controllers_wrapper_.get_updated_list(guard)) {
+    // the restarted controllers are started again by the next request
+    const bool stopped = contains(request.stop_controllers, controller) &&
+      !contains(request.restart_controllers, controller);
+    const bool active = (is_controller_running(controller) && !stopped) ||
+      contains(request.start_controllers, controller) ||
+      (is_controller_standby(controller) &&
+      !contains(request.leave_standby_controllers, controller)) ||
+      contains(request.enter_standby_controllers, controller);
+    if (!active) {
+      continue;
+    }
+    if (controller.joint_value_mask.size() != claimed.size()) {
+      // loaded before the registration was frozen
+      return {};
+    }
+    for (size_t word = 0; word < claimed.size(); ++word) {
+      claimed[word] |= controller.joint_value_mask[word];
+    }
+  }
+  return claimed;
+}
+
+void ControllerManager::stop_controllers(SwitchRequest & request)
+{
+  // the lifecycle is deactivated by the thread which requested the switch
+  for (const auto & controller : request.stop_controllers) {
+    controller.running->store(false, std::memory_order_release);
+  }
+  for (const auto & controller : request.enter_standby_controllers) {
+    controller.standby->store(true, std::memory_order_release);
+  }
+  for (const auto & controller : request.leave_standby_controllers) {
+    controller.standby->store(false, std::memory_order_release);
+  }
+}
+
+void ControllerManager::start_controllers(SwitchRequest & request)
+{
+  // poll the hardware, never wait for it in the real-time thread
+  const auto hw_switch_state = hw_->get_switch_state();
+  if (hw_switch_state == hardware_interface::switch_state::ONGOING &&
+    !request.timed_out(std::chrono::steady_clock::now()))
   {
-    switch_params_.do_switch = false;
+    // wait controllers, the request stays queued until the next cycle
+    return;
+  }
+  request.done = true;
+
+  if (hw_switch_state != hardware_interface::switch_state::DONE) {
+    // abort controllers in case of error or timeout
+    HARDWARE_INTERFACE_RT_LOG_ERROR(
+      get_logger().get_name(), "The hardware %s to switch, no controller is started",
+      hw_switch_state == hardware_interface::switch_state::ERROR ? "failed" : "took too long");
+    request.result = controller_interface::return_type::ERROR;
+    return;
+  }
+
+  // the lifecycle was activated by the thread which requested the switch
+  for (const auto & controller : request.start_controllers) {
+    run_controller(controller);
   }
-#else
-  //  Dummy implementation, replace with the code above when migrated
-  start_controllers();
-#endif
+}
+
+void ControllerManager::start_controllers_asap(SwitchRequest & request)
+{
+  const bool timed_out = request.timed_out(std::chrono::steady_clock::now());
+  bool all_finished = true;
+  // start each controller as soon as the hardware is done switching its interfaces
+  for (size_t i = 0; i < request.start_controllers.size(); ++i) {
+    if (request.start_finished[i]) {
+      continue;
+    }
+    const auto & controller = request.start_controllers[i];
+    const auto hw_switch_state = hw_->get_switch_state(controller.info);
+    if (hw_switch_state == hardware_interface::switch_state::DONE) {
+      run_controller(controller);
+      request.start_finished[i] = true;
+    } else if (hw_switch_state == hardware_interface::switch_state::ERROR || timed_out) {
+      // abort on error or timeout, the other controllers are still started
+      HARDWARE_INTERFACE_RT_LOG_ERROR(
+        get_logger().get_name(), "The hardware %s to switch, controller %s is not started",
+        hw_switch_state == hardware_interface::switch_state::ERROR ? "failed" : "took too long",
+        controller.info.name.c_str());
+      request.result = controller_interface::return_type::ERROR;
+      request.start_finished[i] = true;
+    } else {
+      // controller is waiting
+      all_finished = false;
+    }
+  }
+
+  // all needed controllers started or aborted, switch done
+  request.done = all_finished;
 }
 
 void ControllerManager::list_controllers_srv_cb(
   const std::shared_ptr<controller_manager_msgs::srv::ListControllers::Request>,
   std::shared_ptr<controller_manager_msgs::srv::ListControllers::Response> response)
 {
-  // lock services
+  // neither the services nor the controllers are locked, the snapshot is immutable
   RCLCPP_DEBUG(get_logger(), "list controller service called");
-  std::lock_guard<std::mutex> services_guard(services_lock_);
-  RCLCPP_DEBUG(get_logger(), "list controller service locked");
-
-  // lock controllers
-  std::lock_guard<std::recursive_mutex> guard(rt_controllers_wrapper_.controllers_lock_);
-  const std::vector<ControllerSpec> & controllers =
-    rt_controllers_wrapper_.get_updated_list(guard);
-  response->controller.resize(controllers.size());
-
-  for (size_t i = 0; i < controllers.size(); ++i) {
-    controller_manager_msgs::msg::ControllerState & cs = response->controller[i];
-    cs.name = controllers[i].info.name;
-    cs.type = controllers[i].info.type;
-    cs.state = controllers[i].c->get_lifecycle_node()->get_current_state().label();
-
-#ifdef TODO_IMPLEMENT_RESOURCE_CHECKING
-    cs.claimed_resources.clear();
-    typedef std::vector<hardware_interface::InterfaceResources> ClaimedResVec;
-    typedef ClaimedResVec::const_iterator ClaimedResIt;
-    const ClaimedResVec & c_resources = controllers[i].info.claimed_resources;
-    for (const auto & c_resource : c_resources) {
-      controller_manager_msgs::HardwareInterfaceResources iface_res;
-      iface_res.hardware_interface = c_resource.hardware_interface;
-      std::copy(
-        c_resource.resources.begin(), c_resource.resources.end(),
-        std::back_inserter(iface_res.resources));
-      cs.claimed_resources.push_back(iface_res);
-    }
-#endif
+  const auto snapshot = get_controllers_snapshot();
+  response->version = snapshot->version;
+  response->controller = snapshot->controllers;
+  for (size_t i = 0; i < response->controller.size(); ++i) {
+    auto & cs = response->controller[i];
+    cs.update_timing = to_msg(cs.name, snapshot->update_timing[i]->get_statistics());
+    cs.cpu_budget = to_msg(*snapshot->cpu_budget[i]);
+    cs.resource_usage = to_msg(*snapshot->accounting[i]);
   }
 
+  // aggregated here, in the service thread, the real-time thread only records the samples
+  response->cycle_timing = {
+    to_msg("read", cycle_timing_.read.get_statistics()),
+    to_msg("update", cycle_timing_.update.get_statistics()),
+    to_msg("manage_switch", cycle_timing_.manage_switch.get_statistics()),
+    to_msg("write", cycle_timing_.write.get_statistics())};
+  response->overruns = cycle_timing_.overruns.load(std::memory_order_relaxed);
+
   RCLCPP_DEBUG(get_logger(), "list controller service finished");
 }
 
@@ -667,7 +1693,7 @@ void ControllerManager::list_controller_types_srv_cb(
   std::lock_guard<std::mutex> guard(services_lock_);
   RCLCPP_DEBUG(get_logger(), "list types service locked");
 
-  auto cur_types = loader_->getDeclaredClasses();
+  const std::vector<std::string> cur_types = loader_->get_declared_classes();
   for (const auto & cur_type : cur_types) {
     response->types.push_back(cur_type);
     response->base_classes.push_back(kControllerInterface);
@@ -677,6 +1703,27 @@ void ControllerManager::list_controller_types_srv_cb(
   RCLCPP_DEBUG(get_logger(), "list types service finished");
 }
 
+void ControllerManager::load_and_start_controllers_service_cb(
+  const std::shared_ptr<controller_manager_msgs::srv::LoadAndStartControllers::Request> request,
+  std::shared_ptr<controller_manager_msgs::srv::LoadAndStartControllers::Response> response)
+{
+  // lock services
+  RCLCPP_DEBUG(get_logger(), "load and start service called");
+  std::lock_guard<std::mutex> guard(services_lock_);
+  RCLCPP_DEBUG(get_logger(), "load and start service locked");
+
+  if (request->names.empty()) {
+    RCLCPP_WARN(get_logger(), "No controller to load and start, the request is ignored");
+    response->ok = false;
+    return;
+  }
+  response->ok = load_and_start_controllers(
+    request->names, request->strictness, request->start_asap, request->timeout) ==
+    controller_interface::return_type::SUCCESS;
+
+  RCLCPP_DEBUG(get_logger(), "load and start service finished");
+}
+
 void ControllerManager::load_controller_service_cb(
   const std::shared_ptr<controller_manager_msgs::srv::LoadController::Request> request,
   std::shared_ptr<controller_manager_msgs::srv::LoadController::Response> response)
@@ -702,6 +1749,15 @@ void ControllerManager::reload_controller_libraries_service_cb(
   std::lock_guard<std::mutex> guard(services_lock_);
   RCLCPP_DEBUG(get_logger(), "reload libraries service locked");
 
+  // the controllers of the other controller managers would outlive their libraries
+  if (loader_.use_count() > 1) {
+    RCLCPP_ERROR(
+      get_logger(), "Controller manager: Cannot reload controller libraries because"
+      " they are shared with other controller managers");
+    response->ok = false;
+    return;
+  }
+
   // only reload libraries if no controllers are running
   std::vector<std::string> loaded_controllers, running_controllers;
   loaded_controllers = get_controller_names();
@@ -709,7 +1765,7 @@ void ControllerManager::reload_controller_libraries_service_cb(
     // lock controllers
     std::lock_guard<std::recursive_mutex> guard(rt_controllers_wrapper_.controllers_lock_);
     for (const auto & controller : rt_controllers_wrapper_.get_updated_list(guard)) {
-      if (is_controller_running(*controller.c)) {
+      if (is_controller_running(controller)) {
         running_controllers.push_back(controller.info.name);
       }
     }
@@ -752,10 +1808,14 @@ void ControllerManager::reload_controller_libraries_service_cb(
     loaded_controllers = get_controller_names();
   }
   assert(loaded_controllers.empty());
+  // Retired controllers must be gone before their libraries get unloaded
+  rt_controllers_wrapper_.wait_until_reclaimed();
 
   // Force a reload on all the PluginLoaders (internally, this recreates the plugin loaders)
-  loader_ = std::make_shared<pluginlib::ClassLoader<controller_interface::ControllerInterface>>(
-    kControllerInterfaceName, kControllerInterface);
+  loader_->reload();
+  if (preload_libraries_) {
+    preload_controller_libraries();
+  }
   RCLCPP_INFO(
     get_logger(), "Controller manager: reloaded controller libraries for '%s'",
     kControllerInterfaceName);
@@ -799,6 +1859,42 @@ void ControllerManager::unload_controller_service_cb(
     request->name.c_str());
 }
 
+void ControllerManager::dump_flight_record_service_cb(
+  const std::shared_ptr<controller_manager_msgs::srv::DumpFlightRecord::Request> request,
+  std::shared_ptr<controller_manager_msgs::srv::DumpFlightRecord::Response> response)
+{
+  // the recorder serializes its dumps, the other services are not locked
+  const auto recorder = flight_recorder_;
+  if (!recorder) {
+    response->ok = false;
+    response->message = "no flight recorder is set";
+    return;
+  }
+  const auto path = recorder->dump(FlightRecordDumpReason::REQUESTED, request->path);
+  response->ok = !path.empty();
+  response->message = response->ok ? path : "could not write the flight record";
+}
+
+std::string ControllerManager::get_controller_type(const std::string & controller_name)
+{
+  const std::string param_name = controller_name + ".type";
+  std::string controller_type;
+
+  // We cannot declare the parameters for the controllers that will be loaded in the future,
+  // because they are plugins and we cannot be aware of all of them.
+  // So when we're told to load a controller by name, we need to declare the parameter if
+  // we haven't done so, and then read it.
+
+  // Check if parameter has been declared
+  if (!has_parameter(param_name)) {
+    declare_parameter(param_name, rclcpp::ParameterValue());
+  }
+  if (!get_parameter(param_name, controller_type)) {
+    return "";
+  }
+  return controller_type;
+}
+
 std::vector<std::string> ControllerManager::get_controller_names()
 {
   std::vector<std::string> names;
@@ -814,33 +1910,544 @@ std::vector<std::string> ControllerManager::get_controller_names()
 controller_interface::return_type
 ControllerManager::update()
 {
-  std::vector<ControllerSpec> & rt_controller_list =
-    rt_controllers_wrapper_.update_and_get_used_by_rt_list();
+  const rclcpp::Time time(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count(),
+    RCL_STEADY_TIME);
+  const auto period = has_last_update_time_ ? time - last_update_time_ : rclcpp::Duration(0, 0);
+  last_update_time_ = time;
+  has_last_update_time_ = true;
+  return update(time, period);
+}
 
-  auto ret = controller_interface::return_type::SUCCESS;
-  for (auto loaded_controller : rt_controller_list) {
-    // TODO(v-lopez) we could cache this information
-    // https://github.com/ros-controls/ros2_control/issues/153
-    if (is_controller_running(*loaded_controller.c)) {
-      auto controller_ret = loaded_controller.c->update();
-      if (controller_ret != controller_interface::return_type::SUCCESS) {
-        ret = controller_ret;
+controller_interface::return_type
+ControllerManager::update(const rclcpp::Time & time, const rclcpp::Duration & period)
+{
+  hardware_interface::RealtimeSection realtime_section;
+  // the hardware was read before this update, the controllers test the freshness of their inputs
+  if (hw_->get_hardware_freshness()) {
+    update_hardware_freshness(*hw_->get_hardware_freshness());
+  }
+  rt_controllers_wrapper_.update_and_get_used_by_rt_list();
+  auto & active_controllers = rt_controllers_wrapper_.get_rt_active_controllers();
+  const auto update_count = update_count_++;
+  const bool recording = flight_recorder_ != nullptr;
+  const auto update_start =
+    recording ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+
+  const bool update_budgeted = update_cpu_budget_ns_ > 0;
+
+  auto update_controller =
+    [this, &active_controllers, update_count, recording, update_budgeted, &time,
+      &period](size_t index) {
+      auto & scheduled = active_controllers[index];
+      scheduled.result = controller_interface::return_type::SUCCESS;
+      scheduled.update_duration_ns = 0;
+      scheduled.cpu_time_ns = 0;
+      scheduled.skipped = true;
+      scheduled.unchanged = false;
+      if (update_count % scheduled.update_period != scheduled.update_phase ||
+        !scheduled.cpu_budget->begin_update(update_count / scheduled.update_period))
+      {
+        return;
+      }
+      scheduled.skipped = false;
+      if (scheduled.input_tracker && !scheduled.standby) {
+        // both taken in every update, a request is not left over for a later unchanged one
+        const bool requested = scheduled.controller->take_update_request();
+        const bool changed = scheduled.input_tracker->update();
+        if (!requested && !changed) {
+          scheduled.unchanged = true;
+          return;
+        }
+      }
+      // also in the worker threads
+      hardware_interface::RealtimeSection realtime_section;
+      CONTROLLER_MANAGER_TIMING_PROBE(scheduled.update_timing);
+      HARDWARE_INTERFACE_TRACE_SCOPE("update_controller", scheduled.info->name.c_str());
+      const bool measured =
+        controller_accounting_ || update_budgeted || scheduled.cpu_budget->is_budgeted();
+      const auto cpu_start = measured ? ControllerCpuBudget::thread_cpu_time_ns() : 0;
+      const auto start =
+        recording ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+      {
+        hardware_interface::ScopedPoolAllocationAccount pool_account(
+          controller_accounting_ ? &scheduled.accounting->get_pool_account() : nullptr);
+        // the period spans the updates the CPU budget left out since the previous one
+        const auto update_periods =
+          scheduled.update_period * scheduled.cpu_budget->get_update_span();
+        const auto controller_period =
+          update_periods == 1 ? period : period * static_cast<double>(update_periods);
+        scheduled.result = scheduled.standby ?
+          scheduled.controller->update_standby(time, controller_period) :
+          scheduled.controller->update(time, controller_period);
+      }
+      if (scheduled.input_tracker &&
+        scheduled.result != controller_interface::return_type::SUCCESS)
+      {
+        // retried in the next update, even if the inputs do not change
+        scheduled.input_tracker->reset();
+      }
+      if (recording) {
+        scheduled.update_duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start).count();
+      }
+      if (measured) {
+        scheduled.cpu_time_ns = ControllerCpuBudget::thread_cpu_time_ns() - cpu_start;
+        if (controller_accounting_) {
+          scheduled.accounting->record_update(scheduled.cpu_time_ns);
+        }
+        if (scheduled.cpu_budget->end_update(scheduled.cpu_time_ns)) {
+          HARDWARE_INTERFACE_RT_LOG_WARN(
+            get_logger().get_name(),
+            "Controller %s overran its CPU budget %u times in a row, policy %s applied",
+            scheduled.info->name.c_str(),
+            scheduled.cpu_budget->get_options().overrun_limit,
+            ControllerCpuBudget::to_string(scheduled.cpu_budget->get_options().policy));
+        }
+      }
+    };
+  {  // timing of the update of all the running controllers
+    CONTROLLER_MANAGER_TIMING_PROBE(&cycle_timing_.update);
+    HARDWARE_INTERFACE_TRACE_SCOPE("update", "");
+    // the controllers of the groups are updated by the group threads, the others here
+    const bool grouped = !controller_groups_.empty() && !stepping_;
+    for (size_t stage_begin = 0; stage_begin < active_controllers.size(); ) {
+      size_t stage_end = stage_begin + 1;
+      while (stage_end < active_controllers.size() &&
+        active_controllers[stage_end].standby == active_controllers[stage_begin].standby &&
+        active_controllers[stage_end].group_order == active_controllers[stage_begin].group_order &&
+        active_controllers[stage_end].stage == active_controllers[stage_begin].stage)
+      {
+        ++stage_end;
       }
+      auto update_group_controllers =
+        [&update_controller, &active_controllers, stage_begin, stage_end](size_t group) {
+          for (size_t index = stage_begin; index < stage_end; ++index) {
+            if (active_controllers[index].group == group + 1) {
+              update_controller(index);
+            }
+          }
+        };
+      if (grouped) {
+        for (auto & group : controller_groups_) {
+          for (size_t index = stage_begin; index < stage_end; ++index) {
+            if (active_controllers[index].group == group->get_index() + 1) {
+              group->start(update_group_controllers);
+              break;
+            }
+          }
+        }
+      }
+      auto update_stage_controller =
+        [&update_controller, &active_controllers, grouped, stage_begin](size_t index) {
+          if (!grouped || active_controllers[stage_begin + index].group == 0) {
+            update_controller(stage_begin + index);
+          }
+        };
+      if (update_pool_) {
+        update_pool_->run(stage_end - stage_begin, update_stage_controller);
+      } else {
+        for (size_t index = 0; index < stage_end - stage_begin; ++index) {
+          update_stage_controller(index);
+        }
+      }
+      if (grouped) {
+        for (auto & group : controller_groups_) {
+          group->wait();
+        }
+      }
+      stage_begin = stage_end;
+    }
+  }
+
+  auto ret = controller_interface::return_type::SUCCESS;
+  for (const auto & scheduled : active_controllers) {
+    if (scheduled.result != controller_interface::return_type::SUCCESS) {
+      ret = scheduled.result;
     }
   }
 
+  if (update_budgeted) {
+    degrade_overrunning_update(active_controllers);
+  }
+
   // there are controllers to start/stop
-  if (switch_params_.do_switch) {
+  if (has_pending_switch_requests_ || !rt_switch_requests_.empty()) {
+    CONTROLLER_MANAGER_TIMING_PROBE(&cycle_timing_.manage_switch);
+    HARDWARE_INTERFACE_TRACE_SCOPE("manage_switch", "");
     manage_switch();
+    rt_controllers_wrapper_.invalidate_rt_active_controllers();
+  }
+
+  // the hardware reads the commands of this cycle from now on, all at once
+  hw_->publish_commands();
+
+  if (joint_state_broadcaster_) {
+    joint_state_broadcaster_->capture(time.nanoseconds());
+  }
+
+  if (recording) {
+    auto cycle = flight_recorder_->begin_cycle(time.nanoseconds(), period.nanoseconds());
+    if (cycle) {
+      for (const auto & scheduled : active_controllers) {
+        uint32_t flags = 0;
+        if (scheduled.skipped) {
+          flags |= FlightRecordController::SKIPPED;
+        }
+        if (scheduled.unchanged) {
+          flags |= FlightRecordController::UNCHANGED;
+        }
+        if (scheduled.result != controller_interface::return_type::SUCCESS) {
+          flags |= FlightRecordController::FAILED;
+        }
+        flight_recorder_->add_controller(
+          cycle, scheduled.info->name, scheduled.update_duration_ns, flags);
+      }
+      if (ret != controller_interface::return_type::SUCCESS) {
+        cycle->flags |= FlightRecordCycle::FAILED;
+      }
+      cycle->update_duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - update_start).count();
+      flight_recorder_->end_cycle(cycle);
+    }
+    if (ret != controller_interface::return_type::SUCCESS) {
+      flight_recorder_->request_dump(FlightRecordDumpReason::FAULT);
+    }
   }
   return ret;
 }
 
+void ControllerManager::enable_stepping(const rclcpp::Time & start_time)
+{
+  std::lock_guard<std::recursive_mutex> guard(rt_controllers_wrapper_.controllers_lock_);
+  stepping_ = true;
+  step_time_ = start_time;
+  rt_controllers_wrapper_.set_stepped(true);
+  // the controllers are updated in the calling thread
+  update_pool_.reset();
+}
+
+bool ControllerManager::is_stepping() const
+{
+  return stepping_;
+}
+
+controller_interface::return_type ControllerManager::step(const rclcpp::Duration & dt)
+{
+  if (!stepping_) {
+    RCLCPP_ERROR(get_logger(), "Could not step, the stepped mode is not enabled");
+    return controller_interface::return_type::ERROR;
+  }
+  step_time_ = step_time_ + dt;
+
+  hardware_interface::RealtimeSection realtime_section;
+  bool failed = false;
+  {
+    CONTROLLER_MANAGER_TIMING_PROBE(&cycle_timing_.read);
+    HARDWARE_INTERFACE_TRACE_SCOPE("read", "");
+    failed |= hw_->read() != hardware_interface::return_type::OK;
+  }
+  failed |= update(step_time_, dt) != controller_interface::return_type::SUCCESS;
+  {
+    CONTROLLER_MANAGER_TIMING_PROBE(&cycle_timing_.write);
+    HARDWARE_INTERFACE_TRACE_SCOPE("write", "");
+    failed |= hw_->write() != hardware_interface::return_type::OK;
+  }
+  return failed ? controller_interface::return_type::ERROR :
+         controller_interface::return_type::SUCCESS;
+}
+
+rclcpp::Time ControllerManager::get_step_time() const
+{
+  return step_time_;
+}
+
+void ControllerManager::set_update_threads(size_t thread_count, int priority)
+{
+  update_pool_.reset();
+  if (stepping_ && thread_count > 0) {
+    RCLCPP_WARN(get_logger(), "No update threads in the stepped mode, updating in step()");
+    return;
+  }
+  if (thread_count > 0) {
+    update_pool_ = std::make_unique<ControllerWorkerPool>(thread_count, priority);
+  }
+}
+
+controller_interface::return_type ControllerManager::add_controller_group(
+  const std::string & name, const ControllerGroupOptions & options)
+{
+  std::lock_guard<std::recursive_mutex> guard(rt_controllers_wrapper_.controllers_lock_);
+  if (!rt_controllers_wrapper_.get_updated_list(guard).empty()) {
+    RCLCPP_ERROR(
+      get_logger(), "Could not add controller group '%s' while controllers are loaded",
+      name.c_str());
+    return controller_interface::return_type::ERROR;
+  }
+  for (const auto & group : controller_groups_) {
+    if (group->get_name() == name) {
+      RCLCPP_ERROR(get_logger(), "Controller group '%s' already exists", name.c_str());
+      return controller_interface::return_type::ERROR;
+    }
+  }
+  controller_groups_.push_back(
+    std::make_unique<ControllerGroupThread>(controller_groups_.size(), name, options));
+  return controller_interface::return_type::SUCCESS;
+}
+
+controller_interface::return_type ControllerManager::set_controller_executor(
+  size_t thread_count, const std::vector<int> & cpus)
+{
+  std::lock_guard<std::recursive_mutex> guard(rt_controllers_wrapper_.controllers_lock_);
+  if (!rt_controllers_wrapper_.get_updated_list(guard).empty()) {
+    RCLCPP_ERROR(
+      get_logger(),
+      "Could not change the executor of the controller nodes while controllers are loaded");
+    return controller_interface::return_type::ERROR;
+  }
+  controller_executor_.reset();
+  if (thread_count > 0) {
+    controller_executor_ = std::make_unique<ControllerNodeExecutor>(thread_count, cpus);
+  }
+  return controller_interface::return_type::SUCCESS;
+}
+
+std::shared_ptr<rclcpp::Executor> ControllerManager::get_controller_executor() const
+{
+  std::lock_guard<std::recursive_mutex> guard(rt_controllers_wrapper_.controllers_lock_);
+  return controller_executor_ ? controller_executor_->get_executor() : executor_;
+}
+
+CycleTiming & ControllerManager::get_cycle_timing()
+{
+  return cycle_timing_;
+}
+
+controller_interface::return_type
+ControllerManager::set_flight_recorder(std::shared_ptr<FlightRecorder> recorder)
+{
+  if (recorder && !recorder->is_configured() &&
+    recorder->configure(*hw_) != hardware_interface::return_type::OK)
+  {
+    RCLCPP_ERROR(get_logger(), "Could not configure the flight recorder");
+    return controller_interface::return_type::ERROR;
+  }
+  flight_recorder_ = std::move(recorder);
+  return controller_interface::return_type::SUCCESS;
+}
+
+std::shared_ptr<FlightRecorder> ControllerManager::get_flight_recorder() const
+{
+  return flight_recorder_;
+}
+
+void ControllerManager::set_update_cpu_budget(std::chrono::nanoseconds budget)
+{
+  update_cpu_budget_ns_ = budget.count();
+  update_cpu_overruns_ = 0;
+}
+
+void ControllerManager::set_controller_accounting(bool enabled)
+{
+  controller_accounting_ = enabled;
+}
+
+void ControllerManager::degrade_overrunning_update(
+  std::vector<ScheduledController> & active_controllers)
+{
+  int64_t cpu_time_ns = 0;
+  for (const auto & scheduled : active_controllers) {
+    cpu_time_ns += scheduled.cpu_time_ns;
+  }
+  if (cpu_time_ns <= update_cpu_budget_ns_) {
+    update_cpu_overruns_ = 0;
+    return;
+  }
+  if (++update_cpu_overruns_ < kUpdateOverrunLimit) {
+    return;
+  }
+  update_cpu_overruns_ = 0;
+
+  // the budgeted controller of lowest priority, the latest updated on a tie
+  ScheduledController * degraded = nullptr;
+  for (auto & scheduled : active_controllers) {
+    if (!scheduled.standby && scheduled.cpu_budget->is_budgeted() &&
+      scheduled.cpu_budget->can_degrade() &&
+      (!degraded || scheduled.cpu_budget->get_options().priority <=
+      degraded->cpu_budget->get_options().priority))
+    {
+      degraded = &scheduled;
+    }
+  }
+  if (degraded && degraded->cpu_budget->degrade()) {
+    HARDWARE_INTERFACE_RT_LOG_WARN(
+      get_logger().get_name(), "The controllers overran the CPU budget of the update, policy %s "
+      "applied to controller %s",
+      ControllerCpuBudget::to_string(degraded->cpu_budget->get_options().policy),
+      degraded->info->name.c_str());
+  }
+}
+
+void ControllerManager::update_hardware_freshness(hardware_interface::HardwareFreshness & freshness)
+{
+  const auto stale = freshness.update();
+  const auto turned_stale = stale & ~stale_hardware_;
+  stale_hardware_ = stale;
+  if (turned_stale == 0) {
+    return;
+  }
+  for (size_t i = 0; i < freshness.get_component_count(); ++i) {
+    if (turned_stale & hardware_interface::HardwareFreshness::get_component_mask(i)) {
+      HARDWARE_INTERFACE_RT_LOG_WARN(
+        get_logger().get_name(), "The data of hardware %s is stale, not read within %.3f s",
+        freshness.get_component_name(i).c_str(),
+        std::chrono::duration<double>(freshness.get_staleness_threshold(i)).count());
+    }
+  }
+}
+
+controller_interface::return_type
+ControllerManager::set_joint_state_broadcaster(
+  std::shared_ptr<DynamicJointStateBroadcaster> broadcaster)
+{
+  if (broadcaster && !broadcaster->is_configured()) {
+    // latched, so subscribers get the layout whenever they subscribe
+    auto layout_publisher = create_publisher<control_msgs::msg::DynamicJointState>(
+      "~/joint_state_layout", rclcpp::QoS(1).transient_local());
+    auto values_publisher = create_publisher<controller_manager_msgs::msg::InterfaceValues>(
+      "~/joint_state_values", rclcpp::QoS(10));
+    if (broadcaster->configure(*hw_, layout_publisher, values_publisher) !=
+      hardware_interface::return_type::OK)
+    {
+      RCLCPP_ERROR(get_logger(), "Could not configure the joint state broadcaster");
+      return controller_interface::return_type::ERROR;
+    }
+  }
+  joint_state_broadcaster_ = std::move(broadcaster);
+  return controller_interface::return_type::SUCCESS;
+}
+
+std::shared_ptr<DynamicJointStateBroadcaster>
+ControllerManager::get_joint_state_broadcaster() const
+{
+  return joint_state_broadcaster_;
+}
+
+bool ControllerManager::claims_conflict(
+  const hardware_interface::ControllerInfo & a, const hardware_interface::ControllerInfo & b)
+{
+  if (a.resources.empty() || b.resources.empty()) {
+    return true;
+  }
+  for (const auto & a_interface : a.resources) {
+    const auto b_interface = b.resources.find(a_interface.first);
+    if (b_interface == b.resources.end()) {
+      continue;
+    }
+    for (const auto & resource : a_interface.second) {
+      if (std::find(b_interface->second.begin(), b_interface->second.end(), resource) !=
+        b_interface->second.end())
+      {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+ControllerManager::RTControllerListWrapper::RTControllerListWrapper()
+: reclaimer_thread_(&RTControllerListWrapper::reclaimer_loop, this)
+{}
+
+ControllerManager::RTControllerListWrapper::~RTControllerListWrapper()
+{
+  {
+    std::lock_guard<std::mutex> guard(reclaimer_mutex_);
+    stop_reclaimer_ = true;
+  }
+  reclaimer_cv_.notify_all();
+  reclaimer_thread_.join();
+}
+
 std::vector<ControllerSpec> &
 ControllerManager::RTControllerListWrapper::update_and_get_used_by_rt_list()
 {
-  used_by_realtime_controllers_index_ = updated_controllers_index_;
-  return controllers_lists_[used_by_realtime_controllers_index_];
+  // Sequentially consistent operations are required: the non-RT thread publishes a list and then
+  // checks which one is used, the RT thread claims a list and then checks it is still the
+  // updated one. Claiming again if the list was switched in between never takes more than one
+  // extra iteration, the non-RT thread cannot switch again until this thread released the list.
+  int index = updated_controllers_index_.load();
+  const int previous_index = used_by_realtime_controllers_index_.exchange(index);
+  while (index != updated_controllers_index_.load()) {
+    index = updated_controllers_index_.load();
+    used_by_realtime_controllers_index_.store(index);
+  }
+  if (index != previous_index) {
+    rt_switch_cv_.notify_all();
+  }
+  return controllers_lists_[index];
+}
+
+std::vector<ControllerManager::ScheduledController> &
+ControllerManager::RTControllerListWrapper::get_rt_active_controllers()
+{
+  const int index = used_by_realtime_controllers_index_.load();
+  auto & active_controllers = active_controllers_lists_[index];
+  if (active_controllers_index_ != index) {
+    // capacity was reserved for the whole list in switch_updated_list(), no allocation here
+    active_controllers.clear();
+    for (const auto & controller : controllers_lists_[index]) {
+      const bool standby = is_controller_standby(controller);
+      if (is_controller_running(controller) || standby) {
+        active_controllers.push_back(
+          ScheduledController{controller.c.get(), &controller.info, controller.update_period,
+            controller.update_phase, controller.update_timing.get(), controller.cpu_budget.get(),
+            controller.accounting.get(), controller.input_tracker.get(), controller.group,
+            controller.group_order, 0, 0, false, false, standby, 0,
+            controller_interface::return_type::SUCCESS});
+      }
+    }
+    // a controller goes in the stage after all the stages of the conflicting ones loaded before,
+    // and of the ones writing its reference interfaces, which the list order puts before
+    for (size_t j = 0; j < active_controllers.size(); ++j) {
+      for (size_t i = 0; i < j; ++i) {
+        if (active_controllers[i].stage >= active_controllers[j].stage &&
+          (claims_conflict(*active_controllers[i].info, *active_controllers[j].info) ||
+          writes_references_of(*active_controllers[i].info, *active_controllers[j].info)))
+        {
+          active_controllers[j].stage = active_controllers[i].stage + 1;
+        }
+      }
+    }
+    // stable insertion sort, the controllers in standby after the running ones, then by group
+    // order and stage, and in a stage by decreasing priority so that the controllers of highest
+    // priority are updated first, std::stable_sort may allocate
+    auto updated_before = [](const ScheduledController & a, const ScheduledController & b) {
+        if (a.standby != b.standby) {
+          return b.standby;
+        }
+        if (a.group_order != b.group_order) {
+          return a.group_order < b.group_order;
+        }
+        return a.stage < b.stage || (a.stage == b.stage &&
+               a.cpu_budget->get_options().priority > b.cpu_budget->get_options().priority);
+      };
+    for (size_t j = 1; j < active_controllers.size(); ++j) {
+      for (size_t i = j; i > 0 && updated_before(active_controllers[i], active_controllers[i - 1]);
+        --i)
+      {
+        std::swap(active_controllers[i - 1], active_controllers[i]);
+      }
+    }
+    active_controllers_index_ = index;
+  }
+  return active_controllers;
+}
+
+void ControllerManager::RTControllerListWrapper::invalidate_rt_active_controllers()
+{
+  active_controllers_index_ = -1;
 }
 
 std::vector<ControllerSpec> &
@@ -871,7 +2478,11 @@ void ControllerManager::RTControllerListWrapper::switch_updated_list(
   assert(controllers_lock_.try_lock());
   controllers_lock_.unlock();
   int former_current_controllers_list_ = updated_controllers_index_;
-  updated_controllers_index_ = get_other_list(former_current_controllers_list_);
+  int new_current_controllers_list_ = get_other_list(former_current_controllers_list_);
+  // Not used by the RT thread yet, make room so the RT schedule rebuild never allocates
+  active_controllers_lists_[new_current_controllers_list_].reserve(
+    controllers_lists_[new_current_controllers_list_].size());
+  updated_controllers_index_ = new_current_controllers_list_;
   wait_until_rt_not_using(former_current_controllers_list_);
 }
 
@@ -880,16 +2491,66 @@ int ControllerManager::RTControllerListWrapper::get_other_list(int index) const
   return (index + 1) % 2;
 }
 
+void ControllerManager::RTControllerListWrapper::retire_unused_list(
+  const std::lock_guard<std::recursive_mutex> & guard)
+{
+  std::vector<ControllerSpec> & unused_list = get_unused_list(guard);
+  {
+    std::lock_guard<std::mutex> reclaimer_guard(reclaimer_mutex_);
+    retired_lists_.emplace_back();
+    retired_lists_.back().swap(unused_list);
+  }
+  reclaimer_cv_.notify_one();
+}
+
+void ControllerManager::RTControllerListWrapper::wait_until_reclaimed()
+{
+  std::unique_lock<std::mutex> lock(reclaimer_mutex_);
+  reclaimer_cv_.wait(lock, [this] {return retired_lists_.empty() && !reclaiming_;});
+}
+
+void ControllerManager::RTControllerListWrapper::reclaimer_loop()
+{
+  std::unique_lock<std::mutex> lock(reclaimer_mutex_);
+  while (true) {
+    reclaimer_cv_.wait(lock, [this] {return stop_reclaimer_ || !retired_lists_.empty();});
+    if (retired_lists_.empty()) {
+      return;
+    }
+    std::list<std::vector<ControllerSpec>> to_destroy;
+    to_destroy.swap(retired_lists_);
+    reclaiming_ = true;
+    lock.unlock();
+    to_destroy.clear();
+    lock.lock();
+    reclaiming_ = false;
+    reclaimer_cv_.notify_all();
+  }
+}
+
+void ControllerManager::RTControllerListWrapper::set_stepped(bool stepped)
+{
+  stepped_ = stepped;
+}
+
 void ControllerManager::RTControllerListWrapper::wait_until_rt_not_using(
   int index,
-  std::chrono::microseconds sleep_period)
-const
+  std::chrono::microseconds wakeup_period)
 {
-  while (used_by_realtime_controllers_index_ == index) {
+  if (stepped_) {
+    // the calling thread runs the cycles, and is not in one
+    if (used_by_realtime_controllers_index_.load() == index) {
+      update_and_get_used_by_rt_list();
+      invalidate_rt_active_controllers();
+    }
+    return;
+  }
+  std::unique_lock<std::mutex> lock(rt_switch_mutex_);
+  while (used_by_realtime_controllers_index_.load() == index) {
     if (!rclcpp::ok()) {
       throw std::runtime_error("rclcpp interrupted");
     }
-    std::this_thread::sleep_for(sleep_period);
+    rt_switch_cv_.wait_for(lock, wakeup_period);
   }
 }
 
@@ -0,0 +1,83 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "controller_manager/controller_manager_group.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace controller_manager
+{
+
+ControllerManagerGroup::ControllerManagerGroup(size_t thread_count, int priority)
+: loader_(std::make_shared<ControllerLoader>()),
+  pool_(thread_count, priority)
+{
+}
+
+std::shared_ptr<ControllerLoader> ControllerManagerGroup::get_loader() const
+{
+  return loader_;
+}
+
+bool ControllerManagerGroup::add(
+  const std::shared_ptr<ControllerManager> & controller_manager,
+  const rclcpp::Time & start_time)
+{
+  if (std::find(
+      controller_managers_.begin(), controller_managers_.end(),
+      controller_manager) != controller_managers_.end())
+  {
+    return false;
+  }
+  controller_manager->enable_stepping(start_time);
+  controller_managers_.push_back(controller_manager);
+  results_.resize(controller_managers_.size());
+  return true;
+}
+
+bool ControllerManagerGroup::remove(const std::shared_ptr<ControllerManager> & controller_manager)
+{
+  auto it = std::find(controller_managers_.begin(), controller_managers_.end(), controller_manager);
+  if (it == controller_managers_.end()) {
+    return false;
+  }
+  controller_managers_.erase(it);
+  results_.resize(controller_managers_.size());
+  return true;
+}
+
+const std::vector<std::shared_ptr<ControllerManager>> &
+ControllerManagerGroup::get_controller_managers() const
+{
+  return controller_managers_;
+}
+
+controller_interface::return_type ControllerManagerGroup::step(const rclcpp::Duration & dt)
+{
+  auto step_controller_manager = [this, &dt](size_t index) {
+      results_[index] = controller_managers_[index]->step(dt);
+    };
+  pool_.run(controller_managers_.size(), step_controller_manager);
+
+  for (const auto result : results_) {
+    if (result != controller_interface::return_type::SUCCESS) {
+      return controller_interface::return_type::ERROR;
+    }
+  }
+  return controller_interface::return_type::SUCCESS;
+}
+
+}  // namespace controller_manager
@@ -0,0 +1,98 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "controller_manager/controller_node_executor.hpp"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace controller_manager
+{
+
+static constexpr const char * kLoggerName = "controller_node_executor";
+
+ControllerNodeExecutor::ControllerNodeExecutor(size_t thread_count, const std::vector<int> & cpus)
+: thread_count_(std::max<size_t>(thread_count, 1)),
+  cpus_(cpus),
+  executor_(std::make_shared<rclcpp::executors::MultiThreadedExecutor>(
+      rclcpp::ExecutorOptions(), thread_count_))
+{
+  std::promise<void> spin_finished;
+  spin_finished_ = spin_finished.get_future();
+  spinner_ = std::thread(&ControllerNodeExecutor::spin, this, std::move(spin_finished));
+}
+
+ControllerNodeExecutor::~ControllerNodeExecutor()
+{
+  // a cancel before the executor started spinning is lost, so cancel until it stopped
+  do {
+    executor_->cancel();
+  } while (spin_finished_.wait_for(std::chrono::milliseconds(10)) != std::future_status::ready);
+  spinner_.join();
+}
+
+std::shared_ptr<rclcpp::Executor> ControllerNodeExecutor::get_executor() const
+{
+  return executor_;
+}
+
+size_t ControllerNodeExecutor::get_thread_count() const
+{
+  return thread_count_;
+}
+
+const std::vector<int> & ControllerNodeExecutor::get_cpus() const
+{
+  return cpus_;
+}
+
+void ControllerNodeExecutor::spin(std::promise<void> finished)
+{
+  if (!cpus_.empty()) {
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (const auto cpu : cpus_) {
+      if (cpu >= 0 && cpu < CPU_SETSIZE) {
+        CPU_SET(cpu, &cpu_set);
+      }
+    }
+    // inherited by the threads the executor starts
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) != 0) {
+      RCLCPP_WARN(
+        rclcpp::get_logger(kLoggerName),
+        "Could not restrict the controller node executor to the requested CPUs");
+    }
+#else
+    RCLCPP_WARN(
+      rclcpp::get_logger(kLoggerName),
+      "Setting the CPUs of the controller node executor is not supported on this platform");
+#endif
+  }
+  executor_->spin();
+  finished.set_value();
+}
+
+}  // namespace controller_manager
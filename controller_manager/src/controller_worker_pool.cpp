@@ -0,0 +1,141 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "controller_manager/controller_worker_pool.hpp"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <thread>
+
+#include "controller_manager/futex.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+namespace controller_manager
+{
+
+static constexpr const char * kLoggerName = "controller_worker_pool";
+/// Checks of the end of the batch before run() goes to sleep
+static constexpr int kWaitSpinCount = 1000;
+
+ControllerWorkerPool::ControllerWorkerPool(size_t thread_count, int priority)
+{
+  workers_.reserve(thread_count);
+  for (size_t i = 0; i < thread_count; ++i) {
+    workers_.emplace_back(
+      &ControllerWorkerPool::worker_loop, this, batch_sequence_.load(std::memory_order_relaxed));
+    if (priority <= 0) {
+      continue;
+    }
+#ifdef __linux__
+    sched_param param;
+    param.sched_priority = priority;
+    if (pthread_setschedparam(workers_.back().native_handle(), SCHED_FIFO, &param) != 0) {
+      RCLCPP_WARN(
+        rclcpp::get_logger(kLoggerName),
+        "Could not set the priority of the controller worker threads to %d", priority);
+    }
+#else
+    RCLCPP_WARN(
+      rclcpp::get_logger(kLoggerName),
+      "Setting the priority of the controller worker threads is not supported on this platform");
+#endif
+  }
+}
+
+ControllerWorkerPool::~ControllerWorkerPool()
+{
+  stop_.store(true, std::memory_order_relaxed);
+  batch_sequence_.fetch_add(1, std::memory_order_release);
+  futex_wake(batch_sequence_, true);
+  for (auto & worker : workers_) {
+    worker.join();
+  }
+}
+
+size_t ControllerWorkerPool::get_thread_count() const
+{
+  return workers_.size();
+}
+
+void ControllerWorkerPool::run(size_t count, Task task, void * context)
+{
+  if (count == 0) {
+    return;
+  }
+
+  task_ = task;
+  context_ = context;
+  task_count_ = count;
+  next_task_ = 0;
+  if (workers_.empty() || count == 1) {
+    run_tasks();
+    return;
+  }
+
+  finished_workers_.store(0, std::memory_order_relaxed);
+  // publishes the batch written above to the workers
+  batch_sequence_.fetch_add(1, std::memory_order_release);
+  futex_wake(batch_sequence_, true);
+
+  run_tasks();
+  const auto worker_count = static_cast<uint32_t>(workers_.size());
+  // the workers still running a task are usually about to finish, spin a little before going to
+  // sleep. Spinning longer would starve the workers of lower priority on the same CPU
+  for (int i = 0; i < kWaitSpinCount; ++i) {
+    if (finished_workers_.load(std::memory_order_acquire) == worker_count) {
+      return;
+    }
+  }
+  for (auto finished = finished_workers_.load(std::memory_order_acquire);
+    finished != worker_count; finished = finished_workers_.load(std::memory_order_acquire))
+  {
+    futex_wait(finished_workers_, finished);
+  }
+}
+
+void ControllerWorkerPool::worker_loop(uint32_t batch_sequence)
+{
+  while (true) {
+    const auto last_batch_sequence = batch_sequence;
+    for (batch_sequence = batch_sequence_.load(std::memory_order_acquire);
+      batch_sequence == last_batch_sequence;
+      batch_sequence = batch_sequence_.load(std::memory_order_acquire))
+    {
+      futex_wait(batch_sequence_, batch_sequence);
+    }
+    if (stop_.load(std::memory_order_relaxed)) {
+      return;
+    }
+
+    run_tasks();
+    // only the last worker wakes run(), which sleeps until all the workers are done
+    if (finished_workers_.fetch_add(1, std::memory_order_acq_rel) + 1 == workers_.size()) {
+      futex_wake(finished_workers_, false);
+    }
+  }
+}
+
+void ControllerWorkerPool::run_tasks()
+{
+  for (size_t index = next_task_.fetch_add(1); index < task_count_;
+    index = next_task_.fetch_add(1))
+  {
+    task_(context_, index);
+  }
+}
+
+}  // namespace controller_manager
@@ -0,0 +1,82 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "controller_manager/cycle_timing.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace controller_manager
+{
+
+namespace
+{
+size_t round_up_to_power_of_two(size_t value)
+{
+  size_t power = 1;
+  while (power < value) {
+    power <<= 1;
+  }
+  return power;
+}
+}  // namespace
+
+TimingProbe::TimingProbe(size_t capacity)
+: samples_(round_up_to_power_of_two(std::max<size_t>(capacity, 1))),
+  mask_(samples_.size() - 1)
+{}
+
+TimingStatistics TimingProbe::get_statistics()
+{
+  std::lock_guard<std::mutex> guard(window_mutex_);
+  const uint64_t capacity = samples_.size();
+
+  TimingStatistics statistics;
+  const uint64_t end = written_.load(std::memory_order_acquire);
+  const uint64_t begin = end > capacity ? end - capacity : 0;
+  window_.resize(end - begin);
+  for (uint64_t index = begin; index < end; ++index) {
+    window_[index - begin] = samples_[index & mask_].load(std::memory_order_relaxed);
+  }
+  // drop the samples the real-time thread overwrote, or may be overwriting, while they were copied
+  const uint64_t written = written_.load(std::memory_order_acquire);
+  if (written + 1 > begin + capacity) {
+    const uint64_t overwritten = std::min(written + 1 - capacity - begin, end - begin);
+    window_.erase(window_.begin(), window_.begin() + overwritten);
+  }
+
+  statistics.count = end;
+  statistics.window = window_.size();
+  if (window_.empty()) {
+    return statistics;
+  }
+  int64_t sum = 0;
+  int64_t min = window_.front();
+  int64_t max = window_.front();
+  for (const auto sample : window_) {
+    sum += sample;
+    min = std::min(min, sample);
+    max = std::max(max, sample);
+  }
+  const size_t p99_index = (window_.size() * 99 + 99) / 100 - 1;
+  std::nth_element(window_.begin(), window_.begin() + p99_index, window_.end());
+  statistics.min = std::chrono::nanoseconds(min);
+  statistics.max = std::chrono::nanoseconds(max);
+  statistics.mean = std::chrono::nanoseconds(sum / static_cast<int64_t>(window_.size()));
+  statistics.p99 = std::chrono::nanoseconds(window_[p99_index]);
+  return statistics;
+}
+
+}  // namespace controller_manager
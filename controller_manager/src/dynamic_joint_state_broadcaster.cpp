@@ -0,0 +1,257 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "controller_manager/dynamic_joint_state_broadcaster.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "hardware_interface/interface_value_arena.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+
+using hardware_interface::InterfaceValueArena;
+
+namespace
+{
+constexpr auto kLoggerName = "dynamic_joint_state_broadcaster";
+/// Copies of the snapshot to try before waiting for the next poll
+constexpr size_t kMaxReadAttempts = 10;
+
+uint64_t to_bits(double value)
+{
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+double from_bits(uint64_t bits)
+{
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+}  // namespace
+
+namespace controller_manager
+{
+
+DynamicJointStateBroadcaster::DynamicJointStateBroadcaster(
+  const DynamicJointStateBroadcasterOptions & options)
+: options_(options)
+{
+}
+
+DynamicJointStateBroadcaster::~DynamicJointStateBroadcaster()
+{
+  {
+    std::lock_guard<std::mutex> guard(stop_mutex_);
+    stop_ = true;
+  }
+  stop_cv_.notify_all();
+  if (publish_thread_.joinable()) {
+    publish_thread_.join();
+  }
+}
+
+hardware_interface::return_type DynamicJointStateBroadcaster::configure(
+  hardware_interface::RobotHardware & hardware, std::shared_ptr<LayoutPublisher> layout_publisher,
+  std::shared_ptr<ValuesPublisher> values_publisher)
+{
+  const auto logger = rclcpp::get_logger(kLoggerName);
+  if (is_configured()) {
+    RCLCPP_ERROR(logger, "already configured");
+    return hardware_interface::return_type::ERROR;
+  }
+  if (!hardware.is_registration_frozen()) {
+    RCLCPP_ERROR(logger, "cannot broadcast the hardware before its registration is frozen");
+    return hardware_interface::return_type::ERROR;
+  }
+  if (options_.decimation == 0) {
+    RCLCPP_ERROR(logger, "cannot broadcast with a decimation of 0");
+    return hardware_interface::return_type::ERROR;
+  }
+  if (!layout_publisher || !values_publisher) {
+    RCLCPP_ERROR(logger, "cannot broadcast without publishers");
+    return hardware_interface::return_type::ERROR;
+  }
+
+  // the state region is laid out joint by joint, in the order of the registered interfaces
+  const auto & arena = hardware.get_joint_values();
+  state_values_ = arena.get_state_values();
+  value_count_ = arena.get_state_size();
+  control_msgs::msg::DynamicJointState layout;
+  value_names_.clear();
+  for (const auto & joint_name : hardware.get_registered_joint_names()) {
+    control_msgs::msg::InterfaceValue interface_values;
+    for (const auto & interface_name : hardware.get_registered_joint_interface_names(joint_name)) {
+      if (InterfaceValueArena::is_command_interface(interface_name)) {
+        continue;
+      }
+      interface_values.interface_names.push_back(interface_name);
+      interface_values.values.push_back(
+        value_names_.size() < value_count_ ? state_values_[value_names_.size()] : 0.0);
+      value_names_.push_back(joint_name + "/" + interface_name);
+    }
+    layout.joint_names.push_back(joint_name);
+    layout.interface_values.push_back(std::move(interface_values));
+  }
+  if (value_names_.size() != value_count_) {
+    RCLCPP_ERROR(logger, "the state values of the joints do not match their interfaces");
+    return hardware_interface::return_type::ERROR;
+  }
+
+  snapshot_.reset(new std::atomic<uint64_t>[value_count_]);
+  for (size_t i = 0; i < value_count_; ++i) {
+    snapshot_[i].store(to_bits(state_values_[i]), std::memory_order_relaxed);
+  }
+  last_sent_values_.assign(value_count_, 0.0);
+  message_.indices.reserve(value_count_);
+  message_.values.reserve(value_count_);
+  layout_publisher->publish(layout);
+  values_publisher_ = std::move(values_publisher);
+  publish_thread_ = std::thread(&DynamicJointStateBroadcaster::publish_loop, this);
+  return hardware_interface::return_type::OK;
+}
+
+bool DynamicJointStateBroadcaster::is_configured() const
+{
+  return values_publisher_ != nullptr;
+}
+
+const DynamicJointStateBroadcasterOptions & DynamicJointStateBroadcaster::get_options() const
+{
+  return options_;
+}
+
+const std::vector<std::string> & DynamicJointStateBroadcaster::get_value_names() const
+{
+  return value_names_;
+}
+
+void DynamicJointStateBroadcaster::capture(int64_t time_ns)
+{
+  if (!snapshot_ || cycle_count_++ % options_.decimation != 0) {
+    return;
+  }
+  const auto sequence = sequence_.load(std::memory_order_relaxed);
+  sequence_.store(sequence + 1, std::memory_order_relaxed);
+  // the odd sequence has to be visible before any of the values
+  std::atomic_thread_fence(std::memory_order_release);
+  snapshot_time_ns_.store(time_ns, std::memory_order_relaxed);
+  for (size_t i = 0; i < value_count_; ++i) {
+    snapshot_[i].store(to_bits(state_values_[i]), std::memory_order_relaxed);
+  }
+  sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+uint64_t DynamicJointStateBroadcaster::get_snapshot_count() const
+{
+  return sequence_.load() / 2;
+}
+
+uint64_t DynamicJointStateBroadcaster::get_published_count() const
+{
+  return published_count_.load();
+}
+
+uint64_t DynamicJointStateBroadcaster::get_keyframe_count() const
+{
+  return keyframe_count_.load();
+}
+
+void DynamicJointStateBroadcaster::publish_loop()
+{
+  std::vector<double> values(value_count_);
+  uint64_t snapshot_count = 0;
+  std::unique_lock<std::mutex> lock(stop_mutex_);
+  while (!stop_) {
+    int64_t time_ns = 0;
+    if (read_snapshot(snapshot_count, time_ns, values)) {
+      lock.unlock();
+      publish(snapshot_count, time_ns, values);
+      lock.lock();
+      continue;
+    }
+    // never notified by the real-time thread, which would have to take the mutex
+    stop_cv_.wait_for(lock, options_.poll_period, [this] {return stop_;});
+  }
+}
+
+bool DynamicJointStateBroadcaster::read_snapshot(
+  uint64_t & snapshot_count, int64_t & time_ns, std::vector<double> & values) const
+{
+  for (size_t attempt = 0; attempt < kMaxReadAttempts; ++attempt) {
+    const auto sequence = sequence_.load(std::memory_order_acquire);
+    if (sequence / 2 <= snapshot_count) {
+      return false;
+    }
+    if (sequence % 2 != 0) {
+      continue;
+    }
+    time_ns = snapshot_time_ns_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < value_count_; ++i) {
+      values[i] = from_bits(snapshot_[i].load(std::memory_order_relaxed));
+    }
+    // the copies have to complete before the sequence is checked again
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (sequence_.load(std::memory_order_relaxed) == sequence) {
+      snapshot_count = sequence / 2;
+      return true;
+    }
+  }
+  return false;
+}
+
+void DynamicJointStateBroadcaster::publish(
+  uint64_t snapshot_count, int64_t time_ns, const std::vector<double> & values)
+{
+  const bool keyframe = options_.change_threshold <= 0.0 || published_snapshot_count_ == 0 ||
+    (options_.keyframe_interval > 0 &&
+    snapshot_count / options_.keyframe_interval !=
+    published_snapshot_count_ / options_.keyframe_interval);
+  message_.indices.clear();
+  message_.values.clear();
+  if (keyframe) {
+    message_.values = values;
+    last_sent_values_ = values;
+  } else {
+    for (size_t i = 0; i < value_count_; ++i) {
+      // NaN compares unequal to everything, its changes are always sent
+      if (!(std::abs(values[i] - last_sent_values_[i]) <= options_.change_threshold)) {
+        message_.indices.push_back(static_cast<uint32_t>(i));
+        message_.values.push_back(values[i]);
+        last_sent_values_[i] = values[i];
+      }
+    }
+    if (message_.values.empty()) {
+      // nothing changed, the gap in the sequence tells so
+      return;
+    }
+  }
+  published_snapshot_count_ = snapshot_count;
+  message_.stamp = rclcpp::Time(time_ns);
+  message_.sequence = snapshot_count;
+  values_publisher_->publish(message_);
+  published_count_.fetch_add(1);
+  if (keyframe) {
+    keyframe_count_.fetch_add(1);
+  }
+}
+
+}  // namespace controller_manager
@@ -0,0 +1,121 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Prints a flight record as CSV, one line per cycle, or its layout with --info.
+// The controllers updated in a cycle are listed in the last column, as name:duration_ns:flags
+// separated by spaces.
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "hardware_interface/flight_record.hpp"
+
+using hardware_interface::FlightRecordController;
+using hardware_interface::FlightRecordReader;
+
+namespace
+{
+void print_info(const FlightRecordReader & reader)
+{
+  const auto & header = reader.get_header();
+  std::printf("dump reason: %" PRIu32 "\n", header.dump_reason);
+  std::printf(
+    "cycles: %" PRIu64 ", from cycle %" PRIu64 "\n", header.cycle_count,
+    header.first_cycle_index);
+  if (header.cycle_count > 0) {
+    const auto & first = reader.get_cycle(0);
+    const auto & last = reader.get_cycle(reader.get_cycle_count() - 1);
+    std::printf(
+      "time: %" PRId64 " ns to %" PRId64 " ns\n", first.time_ns, last.time_ns);
+  }
+  std::printf("controller slots: %" PRIu32 "\n", header.controller_capacity);
+  std::printf("actuator values:\n");
+  for (const auto & name : reader.get_actuator_value_names()) {
+    std::printf("  %s\n", name.empty() ? "(padding)" : name.c_str());
+  }
+  std::printf("joint values:\n");
+  for (const auto & name : reader.get_joint_value_names()) {
+    std::printf("  %s\n", name.empty() ? "(padding)" : name.c_str());
+  }
+}
+
+void print_csv(const FlightRecordReader & reader)
+{
+  const auto & actuator_names = reader.get_actuator_value_names();
+  const auto & joint_names = reader.get_joint_value_names();
+  std::printf("cycle,time_ns,period_ns,update_duration_ns,flags");
+  for (const auto & name : actuator_names) {
+    if (!name.empty()) {
+      std::printf(",%s", name.c_str());
+    }
+  }
+  for (const auto & name : joint_names) {
+    if (!name.empty()) {
+      std::printf(",%s", name.c_str());
+    }
+  }
+  std::printf(",controllers\n");
+
+  const auto first_cycle_index = reader.get_header().first_cycle_index;
+  for (size_t i = 0; i < reader.get_cycle_count(); ++i) {
+    const auto & cycle = reader.get_cycle(i);
+    std::printf(
+      "%" PRIu64 ",%" PRId64 ",%" PRId64 ",%" PRId64 ",%" PRIu32, first_cycle_index + i,
+      cycle.time_ns, cycle.period_ns, cycle.update_duration_ns, cycle.flags);
+    const double * actuator_values = reader.get_actuator_values(i);
+    for (size_t j = 0; j < actuator_names.size(); ++j) {
+      if (!actuator_names[j].empty()) {
+        std::printf(",%.17g", actuator_values[j]);
+      }
+    }
+    const double * joint_values = reader.get_joint_values(i);
+    for (size_t j = 0; j < joint_names.size(); ++j) {
+      if (!joint_names[j].empty()) {
+        std::printf(",%.17g", joint_values[j]);
+      }
+    }
+    std::printf(",");
+    const auto controllers = reader.get_controllers(i);
+    for (uint32_t j = 0; j < cycle.controller_count; ++j) {
+      std::printf(
+        "%s%.*s:%" PRId64 ":%" PRIu32, j > 0 ? " " : "",
+        static_cast<int>(FlightRecordController::NAME_SIZE),
+        controllers[j].name, controllers[j].update_duration_ns, controllers[j].flags);
+    }
+    std::printf("\n");
+  }
+}
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+  const bool info = argc == 3 && std::strcmp(argv[2], "--info") == 0;
+  if (argc != 2 && !info) {
+    std::fprintf(stderr, "usage: %s <flight record file> [--info]\n", argv[0]);
+    return 2;
+  }
+  FlightRecordReader reader;
+  if (reader.open(argv[1]) != hardware_interface::return_type::OK) {
+    return 1;
+  }
+  if (info) {
+    print_info(reader);
+  } else {
+    print_csv(reader);
+  }
+  return 0;
+}
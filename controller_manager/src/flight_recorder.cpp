@@ -0,0 +1,330 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "controller_manager/flight_recorder.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+
+using hardware_interface::FlightRecordController;
+using hardware_interface::FlightRecordCycle;
+using hardware_interface::FlightRecordDumpReason;
+using hardware_interface::FlightRecordHeader;
+
+namespace
+{
+constexpr auto kLoggerName = "flight_recorder";
+/// The cycles of a file start on a cache line
+constexpr size_t kCyclesAlignment = 64;
+constexpr int64_t kNoDumpYet = std::numeric_limits<int64_t>::min();
+
+static_assert(
+  sizeof(FlightRecordCycle) % sizeof(double) == 0,
+  "the values have to be aligned after the cycle");
+static_assert(
+  sizeof(FlightRecordController) % sizeof(double) == 0,
+  "the controllers have to stay aligned");
+
+size_t align_up(size_t size, size_t alignment)
+{
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+int64_t steady_now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char * to_string(FlightRecordDumpReason reason)
+{
+  switch (reason) {
+    case FlightRecordDumpReason::FAULT:
+      return "fault";
+    case FlightRecordDumpReason::OVERRUN:
+      return "overrun";
+    default:
+      return "requested";
+  }
+}
+}  // namespace
+
+namespace controller_manager
+{
+
+FlightRecorder::FlightRecorder(const FlightRecorderOptions & options)
+: options_(options), last_automatic_dump_ns_(kNoDumpYet)
+{
+  dump_thread_ = std::thread(&FlightRecorder::dump_loop, this);
+}
+
+FlightRecorder::~FlightRecorder()
+{
+  {
+    std::lock_guard<std::mutex> guard(stop_mutex_);
+    stop_ = true;
+  }
+  stop_cv_.notify_all();
+  dump_thread_.join();
+}
+
+hardware_interface::return_type FlightRecorder::configure(
+  hardware_interface::RobotHardware & hardware)
+{
+  std::lock_guard<std::mutex> guard(dump_mutex_);
+  if (!hardware.is_registration_frozen()) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger(kLoggerName),
+      "cannot record the hardware before its registration is frozen");
+    return hardware_interface::return_type::ERROR;
+  }
+  if (options_.cycle_capacity == 0) {
+    RCLCPP_ERROR(rclcpp::get_logger(kLoggerName), "cannot record without any cycle");
+    return hardware_interface::return_type::ERROR;
+  }
+
+  const auto actuator_names = hardware.get_actuator_value_names();
+  const auto joint_names = hardware.get_joint_value_names();
+  value_names_.clear();
+  for (const auto & name : actuator_names) {
+    value_names_.append(name).push_back('\0');
+  }
+  for (const auto & name : joint_names) {
+    value_names_.append(name).push_back('\0');
+  }
+  actuator_values_ = hardware.get_actuator_values().data();
+  actuator_value_count_ = actuator_names.size();
+  joint_values_ = hardware.get_joint_values().data();
+  joint_value_count_ = joint_names.size();
+  cycle_size_ = sizeof(FlightRecordCycle) +
+    (actuator_value_count_ + joint_value_count_) * sizeof(double) +
+    options_.controller_capacity * sizeof(FlightRecordController);
+
+  // zeroing the ring also touches all of its pages
+  ring_.assign(options_.cycle_capacity * cycle_size_ / sizeof(uint64_t), 0);
+  dump_ring_.assign(ring_.size(), 0);
+  written_cycles_ = 0;
+  return hardware_interface::return_type::OK;
+}
+
+bool FlightRecorder::is_configured() const
+{
+  return !ring_.empty();
+}
+
+const FlightRecorderOptions & FlightRecorder::get_options() const
+{
+  return options_;
+}
+
+FlightRecordCycle * FlightRecorder::begin_cycle(int64_t time_ns, int64_t period_ns)
+{
+  if (ring_.empty()) {
+    return nullptr;
+  }
+  // pairs with the dump, which sets frozen_ before checking recording_
+  recording_.store(true);
+  if (frozen_.load()) {
+    recording_.store(false, std::memory_order_release);
+    return nullptr;
+  }
+
+  const auto index = written_cycles_.load(std::memory_order_relaxed) % options_.cycle_capacity;
+  auto data = reinterpret_cast<char *>(ring_.data()) + index * cycle_size_;
+  auto cycle = reinterpret_cast<FlightRecordCycle *>(data);
+  cycle->time_ns = time_ns;
+  cycle->period_ns = period_ns;
+  cycle->update_duration_ns = 0;
+  cycle->controller_count = 0;
+  cycle->flags = 0;
+  data += sizeof(FlightRecordCycle);
+  if (actuator_value_count_ > 0) {
+    std::memcpy(data, actuator_values_, actuator_value_count_ * sizeof(double));
+  }
+  data += actuator_value_count_ * sizeof(double);
+  if (joint_value_count_ > 0) {
+    std::memcpy(data, joint_values_, joint_value_count_ * sizeof(double));
+  }
+  return cycle;
+}
+
+void FlightRecorder::add_controller(
+  FlightRecordCycle * cycle, const std::string & name, int64_t update_duration_ns,
+  uint32_t flags)
+{
+  if (!cycle || cycle->controller_count >= options_.controller_capacity) {
+    return;
+  }
+  auto controllers = reinterpret_cast<FlightRecordController *>(
+    reinterpret_cast<char *>(cycle) + sizeof(FlightRecordCycle) +
+    (actuator_value_count_ + joint_value_count_) * sizeof(double));
+  auto & controller = controllers[cycle->controller_count++];
+  const size_t length = std::min(name.size(), FlightRecordController::NAME_SIZE - 1);
+  std::memcpy(controller.name, name.data(), length);
+  std::memset(controller.name + length, 0, FlightRecordController::NAME_SIZE - length);
+  controller.update_duration_ns = update_duration_ns;
+  controller.flags = flags;
+  controller.reserved = 0;
+}
+
+void FlightRecorder::end_cycle(FlightRecordCycle * cycle)
+{
+  if (!cycle) {
+    return;
+  }
+  written_cycles_.store(
+    written_cycles_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  recording_.store(false, std::memory_order_release);
+}
+
+void FlightRecorder::request_dump(FlightRecordDumpReason reason)
+{
+  if (reason != FlightRecordDumpReason::REQUESTED) {
+    const auto now_ns = steady_now_ns();
+    auto last_ns = last_automatic_dump_ns_.load(std::memory_order_relaxed);
+    if (last_ns != kNoDumpYet && now_ns - last_ns < options_.min_automatic_dump_interval.count()) {
+      return;
+    }
+    // another thread requested one in the meantime
+    if (!last_automatic_dump_ns_.compare_exchange_strong(last_ns, now_ns)) {
+      return;
+    }
+  }
+  uint32_t none = 0;
+  requested_dump_.compare_exchange_strong(none, 1 + static_cast<uint32_t>(reason));
+}
+
+std::string FlightRecorder::dump(FlightRecordDumpReason reason, const std::string & path)
+{
+  std::lock_guard<std::mutex> guard(dump_mutex_);
+  if (ring_.empty()) {
+    RCLCPP_ERROR(rclcpp::get_logger(kLoggerName), "cannot dump before being configured");
+    return "";
+  }
+
+  // the cycle being recorded, if any, is finished before the ring is read
+  frozen_.store(true);
+  while (recording_.load()) {
+    std::this_thread::yield();
+  }
+  const auto written_cycles = written_cycles_.load(std::memory_order_acquire);
+  const auto cycle_count = std::min<uint64_t>(written_cycles, options_.cycle_capacity);
+  // the cycles are recorded again once copied, while the copy is written to the file
+  std::copy(ring_.begin(), ring_.end(), dump_ring_.begin());
+  frozen_.store(false, std::memory_order_release);
+  const auto written_path =
+    write_file(reason, path, written_cycles - cycle_count, cycle_count);
+
+  if (!written_path.empty()) {
+    last_dump_path_ = written_path;
+    dump_count_.fetch_add(1, std::memory_order_relaxed);
+    RCLCPP_INFO(
+      rclcpp::get_logger(kLoggerName), "dumped %lu cycles to '%s' (%s)",
+      static_cast<unsigned long>(cycle_count), written_path.c_str(), to_string(reason));
+  }
+  return written_path;
+}
+
+uint64_t FlightRecorder::get_recorded_cycle_count() const
+{
+  return written_cycles_.load(std::memory_order_acquire);
+}
+
+uint64_t FlightRecorder::get_dump_count() const
+{
+  return dump_count_.load(std::memory_order_relaxed);
+}
+
+std::string FlightRecorder::get_last_dump_path() const
+{
+  std::lock_guard<std::mutex> guard(dump_mutex_);
+  return last_dump_path_;
+}
+
+void FlightRecorder::dump_loop()
+{
+  std::unique_lock<std::mutex> lock(stop_mutex_);
+  while (!stop_) {
+    const auto requested = requested_dump_.exchange(0);
+    if (requested != 0) {
+      lock.unlock();
+      dump(static_cast<FlightRecordDumpReason>(requested - 1));
+      lock.lock();
+      continue;
+    }
+    // never notified by the real-time thread, which would have to take the mutex
+    stop_cv_.wait_for(lock, options_.poll_period, [this] {return stop_;});
+  }
+}
+
+std::string FlightRecorder::write_file(
+  FlightRecordDumpReason reason, const std::string & path, uint64_t first_cycle_index,
+  uint64_t cycle_count) const
+{
+  std::string file_path = path;
+  if (file_path.empty()) {
+    const auto now = std::time(nullptr);
+    std::tm local_time;
+    localtime_r(&now, &local_time);
+    char time_string[32];
+    std::strftime(time_string, sizeof(time_string), "%Y%m%d-%H%M%S", &local_time);
+    file_path = options_.directory + "/flight_record_" + time_string + "_" +
+      std::to_string(dump_count_.load(std::memory_order_relaxed)) + "_" + to_string(reason) +
+      ".bin";
+  }
+
+  FlightRecordHeader header;
+  std::memset(&header, 0, sizeof(header));
+  header.magic = FlightRecordHeader::MAGIC;
+  header.layout_version = FlightRecordHeader::LAYOUT_VERSION;
+  header.dump_reason = static_cast<uint32_t>(reason);
+  header.controller_capacity = static_cast<uint32_t>(options_.controller_capacity);
+  header.actuator_value_count = actuator_value_count_;
+  header.joint_value_count = joint_value_count_;
+  header.cycle_size = cycle_size_;
+  header.cycle_count = cycle_count;
+  header.first_cycle_index = first_cycle_index;
+  header.names_offset = sizeof(FlightRecordHeader);
+  header.names_size = value_names_.size();
+  header.cycles_offset = align_up(header.names_offset + header.names_size, kCyclesAlignment);
+
+  std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  file.write(value_names_.data(), static_cast<std::streamsize>(value_names_.size()));
+  const std::string padding(header.cycles_offset - header.names_offset - header.names_size, '\0');
+  file.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+  // oldest first, the ring wraps around at most once
+  const auto ring = reinterpret_cast<const char *>(dump_ring_.data());
+  const auto first = first_cycle_index % options_.cycle_capacity;
+  const auto until_end = std::min<uint64_t>(cycle_count, options_.cycle_capacity - first);
+  file.write(ring + first * cycle_size_, static_cast<std::streamsize>(until_end * cycle_size_));
+  file.write(ring, static_cast<std::streamsize>((cycle_count - until_end) * cycle_size_));
+  file.close();
+  if (!file) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger(kLoggerName), "could not write the flight record '%s'",
+      file_path.c_str());
+    return "";
+  }
+  return file_path;
+}
+
+}  // namespace controller_manager
@@ -0,0 +1,88 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "controller_manager/futex.hpp"
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+namespace controller_manager
+{
+
+// the kernel reads the word of an atomic as a plain integer
+static_assert(
+  sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "std::atomic<uint32_t> is not a futex word");
+
+#ifdef __linux__
+namespace
+{
+void futex(
+  const std::atomic<uint32_t> & word, int operation, uint32_t value, const timespec * timeout)
+{
+  syscall(
+    SYS_futex, reinterpret_cast<const uint32_t *>(&word), operation, value, timeout, nullptr, 0);
+}
+}  // namespace
+#endif
+
+void futex_wait(const std::atomic<uint32_t> & word, uint32_t expected)
+{
+#ifdef __linux__
+  futex(word, FUTEX_WAIT_PRIVATE, expected, nullptr);
+#else
+  if (word.load(std::memory_order_relaxed) == expected) {
+    std::this_thread::yield();
+  }
+#endif
+}
+
+void futex_wait_for(
+  const std::atomic<uint32_t> & word, uint32_t expected, std::chrono::nanoseconds timeout)
+{
+#ifdef __linux__
+  // relative to the time of the call for FUTEX_WAIT
+  const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+  timespec relative_timeout;
+  relative_timeout.tv_sec = seconds.count();
+  relative_timeout.tv_nsec = (timeout - seconds).count();
+  futex(word, FUTEX_WAIT_PRIVATE, expected, &relative_timeout);
+#else
+  if (word.load(std::memory_order_relaxed) == expected) {
+    std::this_thread::sleep_for(
+      std::min<std::chrono::nanoseconds>(timeout, std::chrono::microseconds(100)));
+  }
+#endif
+}
+
+void futex_wake(std::atomic<uint32_t> & word, bool all)
+{
+#ifdef __linux__
+  futex(word, FUTEX_WAKE_PRIVATE, all ? INT32_MAX : 1, nullptr);
+#else
+  (void)word;
+  (void)all;
+#endif
+}
+
+}  // namespace controller_manager
@@ -0,0 +1,304 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "controller_manager/realtime_control_loop.hpp"
+
+#ifdef __linux__
+#include <alloca.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <time.h>
+#endif
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+#include "hardware_interface/realtime_section.hpp"
+#include "hardware_interface/tracing.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+
+using hardware_interface::FlightRecordDumpReason;
+
+namespace controller_manager
+{
+
+static constexpr const char * kRealtimeControlLoopLoggerName = "realtime_control_loop";
+
+namespace
+{
+int64_t now_ns()
+{
+#ifdef __linux__
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<int64_t>(now.tv_sec) * 1000000000LL + now.tv_nsec;
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+void sleep_until_ns(int64_t deadline_ns)
+{
+#ifdef __linux__
+  timespec deadline;
+  deadline.tv_sec = static_cast<time_t>(deadline_ns / 1000000000LL);
+  deadline.tv_nsec = static_cast<long>(deadline_ns % 1000000000LL);  // NOLINT(runtime/int)
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR) {
+  }
+#else
+  std::this_thread::sleep_until(
+    std::chrono::steady_clock::time_point(std::chrono::nanoseconds(deadline_ns)));
+#endif
+}
+
+void update_max(std::atomic<int64_t> & max, int64_t value)
+{
+  // only written by the loop thread, no compare and swap needed
+  if (value > max.load(std::memory_order_relaxed)) {
+    max.store(value, std::memory_order_relaxed);
+  }
+}
+}  // namespace
+
+RealtimeControlLoop::RealtimeControlLoop(
+  std::shared_ptr<hardware_interface::RobotHardware> hw,
+  std::shared_ptr<ControllerManager> cm,
+  const RealtimeControlLoopOptions & options)
+: hw_(hw),
+  cm_(cm),
+  options_(options),
+  sync_phase_lock_(options.period, options.sync)
+{}
+
+RealtimeControlLoop::~RealtimeControlLoop()
+{
+  stop();
+}
+
+bool RealtimeControlLoop::start()
+{
+  if (thread_.joinable()) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger(kRealtimeControlLoopLoggerName), "The control loop is already running");
+    return false;
+  }
+  if (options_.period.count() <= 0) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger(kRealtimeControlLoopLoggerName),
+      "The period of the control loop must be positive");
+    return false;
+  }
+
+  if (options_.lock_memory) {
+#ifdef __linux__
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+      RCLCPP_WARN(
+        rclcpp::get_logger(kRealtimeControlLoopLoggerName),
+        "Could not lock the memory of the process: %s", std::strerror(errno));
+    }
+#else
+    RCLCPP_WARN(
+      rclcpp::get_logger(kRealtimeControlLoopLoggerName),
+      "Locking the memory is not supported on this platform");
+#endif
+  }
+
+  if (!options_.state_export_segment.empty() &&
+    state_exporter_.open(options_.state_export_segment, *hw_) !=
+    hardware_interface::return_type::OK)
+  {
+    RCLCPP_WARN(
+      rclcpp::get_logger(kRealtimeControlLoopLoggerName),
+      "Could not export the interface values to '%s'", options_.state_export_segment.c_str());
+  }
+
+  sync_event_source_ = options_.sync_to_hardware ? hw_->get_sync_event_source() : nullptr;
+  if (sync_event_source_ &&
+    (!(options_.sync.proportional_gain > 0.0) || options_.sync.integral_gain < 0.0))
+  {
+    RCLCPP_ERROR(
+      rclcpp::get_logger(kRealtimeControlLoopLoggerName),
+      "The gains of the sync phase lock must be positive");
+    return false;
+  }
+  sync_phase_lock_.reset();
+  synchronized_.store(false, std::memory_order_relaxed);
+
+  running_ = true;
+  thread_ = std::thread(&RealtimeControlLoop::loop, this);
+  return true;
+}
+
+void RealtimeControlLoop::stop()
+{
+  running_ = false;
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  state_exporter_.close();
+}
+
+bool RealtimeControlLoop::is_running() const
+{
+  return running_;
+}
+
+RealtimeControlLoopStatistics RealtimeControlLoop::get_statistics() const
+{
+  RealtimeControlLoopStatistics statistics;
+  statistics.period = options_.period;
+  statistics.cycles = cycles_.load(std::memory_order_relaxed);
+  statistics.overruns = overruns_.load(std::memory_order_relaxed);
+  statistics.errors = errors_.load(std::memory_order_relaxed);
+  statistics.last_jitter =
+    std::chrono::nanoseconds(last_jitter_ns_.load(std::memory_order_relaxed));
+  statistics.max_jitter = std::chrono::nanoseconds(max_jitter_ns_.load(std::memory_order_relaxed));
+  statistics.last_cycle_duration =
+    std::chrono::nanoseconds(last_cycle_duration_ns_.load(std::memory_order_relaxed));
+  statistics.max_cycle_duration =
+    std::chrono::nanoseconds(max_cycle_duration_ns_.load(std::memory_order_relaxed));
+  statistics.synchronized = synchronized_.load(std::memory_order_relaxed);
+  statistics.sync_phase_error =
+    std::chrono::nanoseconds(sync_phase_error_ns_.load(std::memory_order_relaxed));
+  statistics.sync_period_correction =
+    std::chrono::nanoseconds(sync_period_correction_ns_.load(std::memory_order_relaxed));
+  return statistics;
+}
+
+void RealtimeControlLoop::configure_thread()
+{
+#ifdef __linux__
+  if (options_.cpu >= 0) {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(options_.cpu, &cpu_set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) != 0) {
+      RCLCPP_WARN(
+        rclcpp::get_logger(kRealtimeControlLoopLoggerName),
+        "Could not pin the control loop to CPU %d", options_.cpu);
+    }
+  }
+  if (options_.priority > 0) {
+    sched_param param;
+    param.sched_priority = options_.priority;
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0) {
+      RCLCPP_WARN(
+        rclcpp::get_logger(kRealtimeControlLoopLoggerName),
+        "Could not set the control loop priority to %d", options_.priority);
+    }
+  }
+  if (options_.stack_prefault_size > 0) {
+    // touch the stack once, so that its pages are mapped (and locked) before the first cycle
+    auto stack = static_cast<unsigned char *>(alloca(options_.stack_prefault_size));
+    std::memset(stack, 0, options_.stack_prefault_size);
+    asm volatile ("" : : "r" (stack) : "memory");
+  }
+#else
+  if (options_.cpu >= 0 || options_.priority > 0 || options_.stack_prefault_size > 0) {
+    RCLCPP_WARN(
+      rclcpp::get_logger(kRealtimeControlLoopLoggerName),
+      "Real-time options of the control loop are not supported on this platform");
+  }
+#endif
+}
+
+void RealtimeControlLoop::loop()
+{
+  configure_thread();
+
+  const int64_t period_ns = options_.period.count();
+  auto & cycle_timing = cm_->get_cycle_timing();
+  // records the cycles in update(), dumped here on the failures of the hardware and on overruns
+  const auto flight_recorder = cm_->get_flight_recorder();
+  int64_t deadline_ns = now_ns() + period_ns;
+  int64_t last_wake_up_ns = deadline_ns - period_ns;
+  while (running_) {
+    sleep_until_ns(deadline_ns);
+    // the one time sample of the cycle, given to all the controllers
+    const int64_t wake_up_ns = now_ns();
+    const rclcpp::Time time(wake_up_ns, RCL_STEADY_TIME);
+    const auto period = rclcpp::Duration(std::chrono::nanoseconds(wake_up_ns - last_wake_up_ns));
+    last_wake_up_ns = wake_up_ns;
+
+    bool failed = false;
+    {
+      hardware_interface::RealtimeSection realtime_section;
+      {
+        CONTROLLER_MANAGER_TIMING_PROBE(&cycle_timing.read);
+        HARDWARE_INTERFACE_TRACE_SCOPE("read", "");
+        failed |= hw_->read() != hardware_interface::return_type::OK;
+      }
+      failed |= cm_->update(time, period) != controller_interface::return_type::SUCCESS;
+      if (options_.enforce_limits) {
+        options_.enforce_limits(period);
+        // publish again, the controller manager published the commands before they were limited
+        hw_->publish_commands();
+      }
+      {
+        CONTROLLER_MANAGER_TIMING_PROBE(&cycle_timing.write);
+        HARDWARE_INTERFACE_TRACE_SCOPE("write", "");
+        failed |= hw_->write() != hardware_interface::return_type::OK;
+      }
+      state_exporter_.export_values();
+    }
+
+    const int64_t end_ns = now_ns();
+    const int64_t jitter_ns = wake_up_ns - deadline_ns;
+    const int64_t cycle_duration_ns = end_ns - wake_up_ns;
+    last_jitter_ns_.store(jitter_ns, std::memory_order_relaxed);
+    update_max(max_jitter_ns_, jitter_ns);
+    last_cycle_duration_ns_.store(cycle_duration_ns, std::memory_order_relaxed);
+    update_max(max_cycle_duration_ns_, cycle_duration_ns);
+    if (failed) {
+      errors_.fetch_add(1, std::memory_order_relaxed);
+      if (flight_recorder) {
+        flight_recorder->request_dump(FlightRecordDumpReason::FAULT);
+      }
+    }
+    cycles_.fetch_add(1, std::memory_order_relaxed);
+    if (options_.on_cycle_end) {
+      options_.on_cycle_end(
+        std::chrono::nanoseconds(jitter_ns), std::chrono::nanoseconds(cycle_duration_ns));
+    }
+
+    if (sync_event_source_) {
+      deadline_ns += sync_phase_lock_.next_period(
+        std::chrono::nanoseconds(deadline_ns), sync_event_source_->get_latest_event()).count();
+      synchronized_.store(sync_phase_lock_.is_locked(), std::memory_order_relaxed);
+      sync_phase_error_ns_.store(
+        sync_phase_lock_.get_phase_error().count(), std::memory_order_relaxed);
+      sync_period_correction_ns_.store(
+        sync_phase_lock_.get_period_correction().count(), std::memory_order_relaxed);
+    } else {
+      deadline_ns += period_ns;
+    }
+    if (end_ns > deadline_ns) {
+      // skip the missed cycles instead of running them back to back
+      overruns_.fetch_add(1, std::memory_order_relaxed);
+      cycle_timing.overruns.fetch_add(1, std::memory_order_relaxed);
+      if (flight_recorder) {
+        flight_recorder->request_dump(FlightRecordDumpReason::OVERRUN);
+      }
+      deadline_ns += (end_ns - deadline_ns) / period_ns * period_ns + period_ns;
+    }
+  }
+}
+
+}  // namespace controller_manager
@@ -0,0 +1,103 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "controller_manager/resource_conflict_checker.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace controller_manager
+{
+
+static constexpr size_t kBitsPerWord = 64;
+
+namespace
+{
+bool has_bit(const ResourceConflictChecker::ClaimMask & mask, size_t bit)
+{
+  const size_t word = bit / kBitsPerWord;
+  return word < mask.size() && (mask[word] >> (bit % kBitsPerWord)) & 1u;
+}
+
+size_t lowest_bit(uint64_t word)
+{
+  size_t bit = 0;
+  while (!(word & 1u)) {
+    word >>= 1;
+    ++bit;
+  }
+  return bit;
+}
+}  // namespace
+
+ResourceConflictChecker::ClaimMask ResourceConflictChecker::get_claim_mask(
+  const hardware_interface::ControllerInfo & info)
+{
+  ClaimMask mask;
+  for (const auto & interface : info.resources) {
+    for (const auto & resource : interface.second) {
+      const std::string name = resource + "/" + interface.first;
+      const size_t claim = claims_.emplace(name, claim_names_.size()).first->second;
+      if (claim == claim_names_.size()) {
+        claim_names_.push_back(name);
+      }
+      const size_t word = claim / kBitsPerWord;
+      if (mask.size() <= word) {
+        mask.resize(word + 1, 0);
+      }
+      mask[word] |= uint64_t(1) << (claim % kBitsPerWord);
+    }
+  }
+  return mask;
+}
+
+bool ResourceConflictChecker::find_conflict(
+  const std::vector<const ClaimMask *> & claim_masks, size_t & first, size_t & second,
+  size_t & claim)
+{
+  ClaimMask claimed;
+  for (size_t index = 0; index < claim_masks.size(); ++index) {
+    const auto & mask = *claim_masks[index];
+    if (claimed.size() < mask.size()) {
+      claimed.resize(mask.size(), 0);
+    }
+    for (size_t word = 0; word < mask.size(); ++word) {
+      const uint64_t conflicts = claimed[word] & mask[word];
+      if (conflicts) {
+        claim = word * kBitsPerWord + lowest_bit(conflicts);
+        second = index;
+        first = 0;
+        while (!has_bit(*claim_masks[first], claim)) {
+          ++first;
+        }
+        return true;
+      }
+      claimed[word] |= mask[word];
+    }
+  }
+  return false;
+}
+
+const std::string & ResourceConflictChecker::get_claim_name(size_t claim) const
+{
+  return claim_names_.at(claim);
+}
+
+size_t ResourceConflictChecker::get_claim_count() const
+{
+  return claim_names_.size();
+}
+
+}  // namespace controller_manager
@@ -0,0 +1,488 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "controller_manager/resource_manager.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "hardware_interface/control_resources_diff.hpp"
+#include "hardware_interface/tracing.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace controller_manager
+{
+
+static constexpr const char * kLoggerName = "resource_manager";
+static constexpr const char * kActuatorType = "actuator";
+static constexpr const char * kSensorType = "sensor";
+static constexpr const char * kSystemType = "system";
+static constexpr const char * kStalenessThresholdParam = "staleness_threshold_ms";
+static constexpr const char * kClockDomainParam = "clock_domain";
+
+using hardware_interface::return_type;
+
+/// The joints and the sensors of a hardware
+static std::vector<std::string> get_component_names(const hardware_interface::HardwareInfo & info)
+{
+  std::vector<std::string> names;
+  for (const auto & joint : info.joints) {
+    names.push_back(joint.name);
+  }
+  for (const auto & sensor : info.sensors) {
+    names.push_back(sensor.name);
+  }
+  return names;
+}
+
+template<typename ComponentT>
+void ResourceManager::track_freshness(
+  const hardware_interface::HardwareInfo & info, ComponentT & component)
+{
+  double threshold_ms = 0.0;
+  const auto param = info.hardware_parameters.find(kStalenessThresholdParam);
+  if (param != info.hardware_parameters.end()) {
+    try {
+      threshold_ms = std::stod(param->second);
+    } catch (const std::exception &) {
+      RCLCPP_ERROR(
+        rclcpp::get_logger(kLoggerName), "Invalid %s '%s' for hardware '%s', never stale",
+        kStalenessThresholdParam, param->second.c_str(), info.name.c_str());
+    }
+  }
+  size_t index = 0;
+  if (freshness_->add_component(
+      info.name, get_component_names(info),
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::duration<double, std::milli>(threshold_ms)),
+      index) != return_type::OK)
+  {
+    RCLCPP_WARN(
+      rclcpp::get_logger(kLoggerName), "Cannot track the freshness of hardware '%s'",
+      info.name.c_str());
+    return;
+  }
+  component.set_freshness(freshness_, index);
+}
+
+template<typename ComponentT>
+void ResourceManager::track_clock_domain(
+  const hardware_interface::HardwareInfo & info, ComponentT & component)
+{
+  const auto param = info.hardware_parameters.find(kClockDomainParam);
+  if (param == info.hardware_parameters.end()) {
+    return;
+  }
+  size_t domain = 0;
+  if (clock_domains_->add_domain(param->second, get_component_names(info), domain) !=
+    return_type::OK)
+  {
+    RCLCPP_WARN(
+      rclcpp::get_logger(kLoggerName), "Cannot add the clock domain '%s' of hardware '%s'",
+      param->second.c_str(), info.name.c_str());
+    return;
+  }
+  component.set_clock_domain(clock_domains_, domain);
+}
+
+ResourceManager::ResourceManager()
+: actuator_loader_("hardware_interface", "hardware_interface::ActuatorHardwareInterface"),
+  sensor_loader_("hardware_interface", "hardware_interface::SensorHardwareInterface"),
+  system_loader_("hardware_interface", "hardware_interface::SystemHardwareInterface"),
+  freshness_(std::make_shared<hardware_interface::HardwareFreshness>()),
+  clock_domains_(std::make_shared<hardware_interface::ClockDomainMap>())
+{
+}
+
+ResourceManager::~ResourceManager()
+{
+  for (auto & hardware : hardware_) {
+    if (hardware.worker.joinable()) {
+      hardware.worker.join();
+    }
+  }
+  // the components are destroyed before the loaders, by the order of the members
+}
+
+return_type ResourceManager::load_hardware(
+  const std::vector<hardware_interface::HardwareInfo> & hardware_infos)
+{
+  auto ret = return_type::OK;
+  for (const auto & info : hardware_infos) {
+    const auto & class_type = info.hardware_class_type;
+    try {
+      if (info.type == kActuatorType && actuator_loader_.isClassAvailable(class_type)) {
+        add_actuator(
+          info, std::unique_ptr<hardware_interface::ActuatorHardwareInterface>(
+            actuator_loader_.createUnmanagedInstance(class_type)));
+      } else if (info.type == kSensorType && sensor_loader_.isClassAvailable(class_type)) {
+        add_sensor(
+          info, std::unique_ptr<hardware_interface::SensorHardwareInterface>(
+            sensor_loader_.createUnmanagedInstance(class_type)));
+      } else if (info.type == kSystemType && system_loader_.isClassAvailable(class_type)) {
+        add_system(
+          info, std::unique_ptr<hardware_interface::SystemHardwareInterface>(
+            system_loader_.createUnmanagedInstance(class_type)));
+      } else {
+        RCLCPP_ERROR(
+          rclcpp::get_logger(kLoggerName), "No %s class '%s' available for hardware '%s'",
+          info.type.c_str(), class_type.c_str(), info.name.c_str());
+        ret = return_type::ERROR;
+      }
+    } catch (const std::exception & e) {
+      RCLCPP_ERROR(
+        rclcpp::get_logger(kLoggerName), "Could not load hardware '%s': %s", info.name.c_str(),
+        e.what());
+      ret = return_type::ERROR;
+    }
+  }
+  return ret;
+}
+
+void ResourceManager::add_actuator(
+  const hardware_interface::HardwareInfo & info,
+  std::unique_ptr<hardware_interface::ActuatorHardwareInterface> impl)
+{
+  auto actuator = std::make_shared<hardware_interface::ActuatorHardware>(std::move(impl));
+  track_freshness(info, *actuator);
+  track_clock_domain(info, *actuator);
+  actuators_.push_back(actuator);
+  add_hardware(
+    info,
+    [actuator](const hardware_interface::HardwareInfo & new_info) {
+      return actuator->configure(new_info);
+    },
+    [actuator] {return actuator->start();}, [actuator] {return actuator->stop();});
+}
+
+void ResourceManager::add_sensor(
+  const hardware_interface::HardwareInfo & info,
+  std::unique_ptr<hardware_interface::SensorHardwareInterface> impl)
+{
+  auto sensor = std::make_shared<hardware_interface::SensorHardware>(std::move(impl));
+  track_freshness(info, *sensor);
+  track_clock_domain(info, *sensor);
+  sensors_.push_back(sensor);
+  add_hardware(
+    info,
+    [sensor](const hardware_interface::HardwareInfo & new_info) {
+      return sensor->configure(new_info);
+    },
+    [sensor] {return sensor->start();}, [sensor] {return sensor->stop();});
+}
+
+void ResourceManager::add_system(
+  const hardware_interface::HardwareInfo & info,
+  std::unique_ptr<hardware_interface::SystemHardwareInterface> impl)
+{
+  auto system = std::make_shared<hardware_interface::SystemHardware>(std::move(impl));
+  track_freshness(info, *system);
+  track_clock_domain(info, *system);
+  systems_.push_back(system);
+  add_hardware(
+    info,
+    [system](const hardware_interface::HardwareInfo & new_info) {
+      return system->configure(new_info);
+    },
+    [system] {return system->start();}, [system] {return system->stop();});
+}
+
+size_t ResourceManager::get_hardware_count() const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  return hardware_.size();
+}
+
+return_type ResourceManager::configure_and_start(std::chrono::nanoseconds timeout)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!is_startup_done()) {
+    return return_type::ERROR;
+  }
+  std::vector<size_t> indices(hardware_.size());
+  for (size_t i = 0; i < indices.size(); ++i) {
+    indices[i] = i;
+  }
+  return start_hardware(indices, timeout, lock);
+}
+
+return_type ResourceManager::reload_hardware(
+  const std::vector<hardware_interface::HardwareInfo> & hardware_infos,
+  std::chrono::nanoseconds timeout)
+{
+  std::vector<size_t> changed;
+  std::vector<HardwareCall> stop_calls;
+  std::vector<hardware_interface::HardwareInfo> added;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (!is_startup_done()) {
+      return return_type::ERROR;
+    }
+    std::vector<hardware_interface::HardwareInfo> current_infos;
+    for (const auto & hardware : hardware_) {
+      current_infos.push_back(hardware.info);
+    }
+    const auto diff = hardware_interface::diff_control_resources(current_infos, hardware_infos);
+    for (const auto & name : diff.removed) {
+      RCLCPP_ERROR(
+        rclcpp::get_logger(kLoggerName), "Hardware '%s' was removed, it needs a restart",
+        name.c_str());
+    }
+    if (!diff.removed.empty()) {
+      return return_type::ERROR;
+    }
+
+    const auto find_info = [&hardware_infos](const std::string & name) {
+        return *std::find_if(
+          hardware_infos.begin(), hardware_infos.end(),
+          [&name](const hardware_interface::HardwareInfo & info) {return info.name == name;});
+      };
+    for (const auto & name : diff.changed) {
+      const auto & info = find_info(name);
+      for (size_t i = 0; i < hardware_.size(); ++i) {
+        if (hardware_[i].info.name != name) {
+          continue;
+        }
+        if (hardware_[i].info.type != info.type ||
+          hardware_[i].info.hardware_class_type != info.hardware_class_type)
+        {
+          RCLCPP_ERROR(
+            rclcpp::get_logger(kLoggerName), "Hardware '%s' changed type or class, it needs a "
+            "restart", name.c_str());
+          return return_type::ERROR;
+        }
+        changed.push_back(i);
+      }
+    }
+    for (const auto index : changed) {
+      if (results_[index].start_result == return_type::OK) {
+        stop_calls.push_back(hardware_[index].stop);
+      }
+      hardware_[index].info = find_info(hardware_[index].info.name);
+    }
+    for (const auto & name : diff.added) {
+      added.push_back(find_info(name));
+    }
+  }
+
+  auto ret = return_type::OK;
+  // without the lock, as in stop()
+  for (const auto & stop_call : stop_calls) {
+    if (stop_call() != return_type::OK) {
+      ret = return_type::ERROR;
+    }
+  }
+  const size_t first_added = get_hardware_count();
+  if (load_hardware(added) != return_type::OK) {
+    ret = return_type::ERROR;
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (size_t i = first_added; i < hardware_.size(); ++i) {
+    changed.push_back(i);
+  }
+  RCLCPP_INFO(
+    rclcpp::get_logger(kLoggerName), "Reloading %zu hardware, %zu left running", changed.size(),
+    hardware_.size() - changed.size());
+  if (start_hardware(changed, timeout, lock) != return_type::OK) {
+    ret = return_type::ERROR;
+  }
+  return ret;
+}
+
+std::vector<HardwareStartupResult> ResourceManager::get_startup_results() const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  return results_;
+}
+
+return_type ResourceManager::stop()
+{
+  std::vector<HardwareCall> stop_calls;
+  auto ret = return_type::OK;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (size_t i = 0; i < hardware_.size(); ++i) {
+      if (!hardware_[i].done) {
+        RCLCPP_ERROR(
+          rclcpp::get_logger(kLoggerName), "Cannot stop hardware '%s' while it is starting",
+          results_[i].name.c_str());
+        ret = return_type::ERROR;
+      } else if (results_[i].start_result == return_type::OK) {
+        stop_calls.push_back(hardware_[i].stop);
+      }
+    }
+  }
+  // without the lock, for the components still starting to report
+  for (const auto & stop_call : stop_calls) {
+    if (stop_call() != return_type::OK) {
+      ret = return_type::ERROR;
+    }
+  }
+  return ret;
+}
+
+const std::vector<std::shared_ptr<hardware_interface::ActuatorHardware>> &
+ResourceManager::get_actuators() const
+{
+  return actuators_;
+}
+
+const std::vector<std::shared_ptr<hardware_interface::SensorHardware>> &
+ResourceManager::get_sensors() const
+{
+  return sensors_;
+}
+
+const std::vector<std::shared_ptr<hardware_interface::SystemHardware>> &
+ResourceManager::get_systems() const
+{
+  return systems_;
+}
+
+const std::shared_ptr<hardware_interface::HardwareFreshness> &
+ResourceManager::get_hardware_freshness() const
+{
+  return freshness_;
+}
+
+const std::shared_ptr<hardware_interface::ClockDomainMap> &
+ResourceManager::get_clock_domains() const
+{
+  return clock_domains_;
+}
+
+void ResourceManager::add_hardware(
+  const hardware_interface::HardwareInfo & info, ConfigureCall configure, HardwareCall start,
+  HardwareCall stop)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  Hardware hardware;
+  hardware.info = info;
+  hardware.configure = std::move(configure);
+  hardware.start = std::move(start);
+  hardware.stop = std::move(stop);
+  hardware_.push_back(std::move(hardware));
+  HardwareStartupResult result;
+  result.name = info.name;
+  results_.push_back(result);
+}
+
+bool ResourceManager::is_startup_done() const
+{
+  for (size_t i = 0; i < hardware_.size(); ++i) {
+    if (!hardware_[i].done) {
+      RCLCPP_ERROR(
+        rclcpp::get_logger(kLoggerName), "Hardware '%s' is still configuring or starting",
+        results_[i].name.c_str());
+      return false;
+    }
+  }
+  return true;
+}
+
+return_type ResourceManager::start_hardware(
+  const std::vector<size_t> & indices, std::chrono::nanoseconds timeout,
+  std::unique_lock<std::mutex> & lock)
+{
+  const auto begin = std::chrono::steady_clock::now();
+  for (const auto i : indices) {
+    auto & hardware = hardware_[i];
+    // the previous worker is done, only its thread is left to join
+    if (hardware.worker.joinable()) {
+      hardware.worker.join();
+    }
+    results_[i] = HardwareStartupResult{results_[i].name};
+    hardware.done = false;
+    hardware.worker = std::thread(&ResourceManager::startup, this, i);
+  }
+
+  const auto all_done = [this, &indices] {
+      for (const auto i : indices) {
+        if (!hardware_[i].done) {
+          return false;
+        }
+      }
+      return true;
+    };
+  done_cv_.wait_until(lock, begin + timeout, all_done);
+
+  auto ret = return_type::OK;
+  for (const auto i : indices) {
+    auto & result = results_[i];
+    if (!hardware_[i].done) {
+      RCLCPP_ERROR(
+        rclcpp::get_logger(kLoggerName), "Hardware '%s' did not start within %.3f s",
+        result.name.c_str(), std::chrono::duration<double>(timeout).count());
+      result.timed_out = true;
+      result.duration = timeout;
+      ret = return_type::ERROR;
+    } else if (result.configure_result != return_type::OK) {
+      RCLCPP_ERROR(
+        rclcpp::get_logger(kLoggerName), "Could not configure hardware '%s'", result.name.c_str());
+      ret = return_type::ERROR;
+    } else if (result.start_result != return_type::OK) {
+      RCLCPP_ERROR(
+        rclcpp::get_logger(kLoggerName), "Could not start hardware '%s'", result.name.c_str());
+      ret = return_type::ERROR;
+    }
+  }
+  return ret;
+}
+
+void ResourceManager::startup(size_t index)
+{
+  ConfigureCall configure;
+  HardwareCall start;
+  hardware_interface::HardwareInfo info;
+  std::chrono::steady_clock::time_point begin;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    configure = hardware_[index].configure;
+    info = hardware_[index].info;
+    start = hardware_[index].start;
+    begin = std::chrono::steady_clock::now();
+  }
+  return_type configure_result;
+  {
+    HARDWARE_INTERFACE_TRACE_SCOPE("configure_hardware", info.name.c_str());
+    configure_result = configure(info);
+  }
+  auto start_result = return_type::ERROR;
+  if (configure_result == return_type::OK) {
+    HARDWARE_INTERFACE_TRACE_SCOPE("start_hardware", info.name.c_str());
+    start_result = start();
+  }
+  const auto duration = std::chrono::steady_clock::now() - begin;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto & result = results_[index];
+    result.configure_result = configure_result;
+    result.start_result = start_result;
+    if (!result.timed_out) {
+      result.duration = duration;
+    }
+    hardware_[index].done = true;
+  }
+  done_cv_.notify_all();
+}
+
+}  // namespace controller_manager
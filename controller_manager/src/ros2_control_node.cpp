@@ -0,0 +1,105 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "controller_manager/controller_manager.hpp"
+#include "controller_manager/realtime_control_loop.hpp"
+#include "hardware_interface/robot_hardware.hpp"
+#include "hardware_interface/tracing.hpp"
+#include "pluginlib/class_loader.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+  auto node = std::make_shared<rclcpp::Node>("ros2_control_node");
+  const auto logger = node->get_logger();
+
+  // the robot hardware is a plugin exported for the hardware_interface::RobotHardware base class,
+  // e.g. test_robot_hardware/TestRobotHardware
+  const auto robot_hardware = node->declare_parameter<std::string>("robot_hardware", "");
+  const auto update_rate = node->declare_parameter<int>("update_rate", 100);
+  controller_manager::RealtimeControlLoopOptions options;
+  options.priority = node->declare_parameter<int>("rt_priority", 0);
+  options.cpu = node->declare_parameter<int>("cpu_affinity", -1);
+  options.lock_memory = node->declare_parameter<bool>("lock_memory", false);
+  options.stack_prefault_size =
+    static_cast<size_t>(node->declare_parameter<int>("stack_prefault_size", 0));
+  options.state_export_segment =
+    node->declare_parameter<std::string>("state_export_segment", "");
+  // phase-locks the loop to the sync events of the robot hardware, if it has a source of them
+  options.sync_to_hardware = node->declare_parameter<bool>("sync_to_hardware", true);
+  options.sync.offset =
+    std::chrono::nanoseconds(node->declare_parameter<int64_t>("sync_offset_ns", 0));
+  if (update_rate <= 0) {
+    RCLCPP_FATAL(logger, "'update_rate' param must be positive, got %d", update_rate);
+    return 1;
+  }
+  options.period = std::chrono::nanoseconds(1000000000LL / update_rate);
+
+  pluginlib::ClassLoader<hardware_interface::RobotHardware> hardware_loader(
+    "hardware_interface", "hardware_interface::RobotHardware");
+  if (robot_hardware.empty() || !hardware_loader.isClassAvailable(robot_hardware)) {
+    RCLCPP_FATAL(
+      logger, "'robot_hardware' param must name an available robot hardware, got '%s'",
+      robot_hardware.c_str());
+    return 1;
+  }
+  auto hw = hardware_loader.createSharedInstance(robot_hardware);
+  hardware_interface::return_type init_result;
+  {
+    HARDWARE_INTERFACE_TRACE_SCOPE("configure_hardware", robot_hardware.c_str());
+    init_result = hw->init();
+  }
+  if (init_result != hardware_interface::return_type::OK) {
+    RCLCPP_FATAL(logger, "Could not initialize robot hardware '%s'", robot_hardware.c_str());
+    return 1;
+  }
+
+  // the executor serves the services of the controller manager, and the controllers unless the
+  // controller_executor_threads param gives them their own, in the main thread, while the control
+  // loop runs in its own thread
+  auto executor = std::make_shared<rclcpp::executors::MultiThreadedExecutor>();
+  auto cm = std::make_shared<controller_manager::ControllerManager>(hw, executor);
+  cm->set_parameter(rclcpp::Parameter("update_rate", update_rate));
+  executor->add_node(node);
+  executor->add_node(cm);
+
+  controller_manager::RealtimeControlLoop control_loop(hw, cm, options);
+  bool started;
+  {
+    HARDWARE_INTERFACE_TRACE_SCOPE("start_hardware", robot_hardware.c_str());
+    started = control_loop.start();
+  }
+  if (!started) {
+    return 1;
+  }
+  RCLCPP_INFO(logger, "Control loop running at %d Hz", update_rate);
+
+  executor->spin();
+
+  control_loop.stop();
+  const auto statistics = control_loop.get_statistics();
+  RCLCPP_INFO(
+    logger, "Control loop stopped after %lu cycles, %lu overruns, max jitter %ld us",
+    static_cast<unsigned long>(statistics.cycles),  // NOLINT(runtime/int)
+    static_cast<unsigned long>(statistics.overruns),  // NOLINT(runtime/int)
+    static_cast<long>(  // NOLINT(runtime/int)
+      std::chrono::duration_cast<std::chrono::microseconds>(statistics.max_jitter).count()));
+  rclcpp::shutdown();
+  return 0;
+}
@@ -0,0 +1,105 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "controller_manager/sync_phase_lock.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+namespace controller_manager
+{
+
+SyncPhaseLock::SyncPhaseLock(
+  std::chrono::nanoseconds period, const SyncPhaseLockOptions & options)
+: period_ns_(period.count()),
+  offset_ns_(options.offset.count()),
+  proportional_gain_(options.proportional_gain),
+  integral_gain_(options.integral_gain),
+  max_correction_ns_(
+    static_cast<double>(
+      options.max_correction.count() > 0 ? options.max_correction.count() : period_ns_ / 10)),
+  lock_window_ns_(options.lock_window.count() > 0 ? options.lock_window.count() : period_ns_ / 100),
+  holdover_cycles_(options.holdover_cycles)
+{
+}
+
+std::chrono::nanoseconds SyncPhaseLock::next_period(
+  std::chrono::nanoseconds deadline, std::chrono::nanoseconds latest_event)
+{
+  const int64_t event_ns = latest_event.count();
+  if (event_ns == 0 || event_ns == last_event_ns_) {
+    // holds the rate of the events over
+    if (acquired_ && ++cycles_without_event_ > holdover_cycles_) {
+      acquired_ = false;
+      locked_ = false;
+    }
+    return std::chrono::nanoseconds(period_ns_ + std::llround(period_correction_ns_));
+  }
+  last_event_ns_ = event_ns;
+  cycles_without_event_ = 0;
+
+  // the events before and after the deadline give the same error, modulo the period
+  int64_t error_ns = (deadline.count() - event_ns - offset_ns_) % period_ns_;
+  if (error_ns < 0) {
+    error_ns += period_ns_;
+  }
+  if (error_ns >= period_ns_ / 2) {
+    error_ns -= period_ns_;
+  }
+  phase_error_ns_ = error_ns;
+  if (!acquired_) {
+    acquired_ = true;
+    locked_ = false;
+    return std::chrono::nanoseconds(period_ns_ - error_ns);
+  }
+
+  const double error = static_cast<double>(error_ns);
+  period_correction_ns_ = std::max(
+    -max_correction_ns_,
+    std::min(max_correction_ns_, period_correction_ns_ - integral_gain_ * error));
+  const double correction = std::max(
+    -max_correction_ns_,
+    std::min(max_correction_ns_, period_correction_ns_ - proportional_gain_ * error));
+  locked_ = std::llabs(error_ns) <= lock_window_ns_;
+  return std::chrono::nanoseconds(period_ns_ + std::llround(correction));
+}
+
+bool SyncPhaseLock::is_locked() const
+{
+  return locked_;
+}
+
+std::chrono::nanoseconds SyncPhaseLock::get_phase_error() const
+{
+  return std::chrono::nanoseconds(phase_error_ns_);
+}
+
+std::chrono::nanoseconds SyncPhaseLock::get_period_correction() const
+{
+  return std::chrono::nanoseconds(std::llround(period_correction_ns_));
+}
+
+void SyncPhaseLock::reset()
+{
+  acquired_ = false;
+  locked_ = false;
+  cycles_without_event_ = 0;
+  last_event_ns_ = 0;
+  phase_error_ns_ = 0;
+  period_correction_ns_ = 0.0;
+}
+
+}  // namespace controller_manager
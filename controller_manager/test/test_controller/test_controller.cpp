@@ -14,8 +14,10 @@
 
 #include "./test_controller.hpp"
 
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "lifecycle_msgs/msg/transition.hpp"
 
@@ -40,6 +42,18 @@ TestController::on_configure(const rclcpp_lifecycle::State & previous_state)
   return rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn::SUCCESS;
 }
 
+std::map<std::string, std::vector<std::string>>
+TestController::get_claimed_resources() const
+{
+  return claimed_resources;
+}
+
+std::map<std::string, std::vector<std::string>>
+TestController::get_read_state_interfaces() const
+{
+  return read_states;
+}
+
 }  // namespace test_controller
 
 #include "pluginlib/class_list_macros.hpp"
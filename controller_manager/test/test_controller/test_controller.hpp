@@ -15,8 +15,10 @@
 #ifndef TEST_CONTROLLER__TEST_CONTROLLER_HPP_
 #define TEST_CONTROLLER__TEST_CONTROLLER_HPP_
 
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "controller_manager/controller_manager.hpp"
 #include "controller_interface/visibility_control.h"
@@ -44,7 +46,17 @@ public:
   rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn
   on_configure(const rclcpp_lifecycle::State & previous_state) override;
 
+  CONTROLLER_MANAGER_PUBLIC
+  std::map<std::string, std::vector<std::string>>
+  get_claimed_resources() const override;
+
+  CONTROLLER_MANAGER_PUBLIC
+  std::map<std::string, std::vector<std::string>>
+  get_read_state_interfaces() const override;
+
   size_t internal_counter = 0;
+  std::map<std::string, std::vector<std::string>> claimed_resources;
+  std::map<std::string, std::vector<std::string>> read_states;
 };
 
 }  // namespace test_controller
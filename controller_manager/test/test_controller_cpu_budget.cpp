@@ -0,0 +1,423 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "controller_manager/controller_accounting.hpp"
+#include "controller_manager/controller_cpu_budget.hpp"
+#include "controller_manager_msgs/srv/list_controllers.hpp"
+#include "controller_manager_test_common.hpp"
+
+using controller_manager::ControllerAccounting;
+using controller_manager::ControllerCpuBudget;
+using controller_manager::ControllerCpuBudgetOptions;
+using controller_manager::OverrunPolicy;
+
+namespace
+{
+/// Burns the CPU for a given time in each update
+class BusyController : public test_controller::TestController
+{
+public:
+  controller_interface::return_type update() override
+  {
+    const auto start = ControllerCpuBudget::thread_cpu_time_ns();
+    while (ControllerCpuBudget::thread_cpu_time_ns() - start < busy_ns) {
+    }
+    return TestController::update();
+  }
+
+  int64_t busy_ns = 0;
+};
+
+/// Records the period of its updates
+class PeriodController : public test_controller::TestController
+{
+public:
+  using TestController::update;
+
+  controller_interface::return_type update(
+    const rclcpp::Time &, const rclcpp::Duration & period) override
+  {
+    last_period = period;
+    return TestController::update();
+  }
+
+  rclcpp::Duration last_period{0, 0};
+};
+
+/// Takes a block from a realtime memory pool and gives it back in each update
+class PoolController : public test_controller::TestController
+{
+public:
+  controller_interface::return_type update() override
+  {
+    pool.deallocate(pool.allocate(24), 24);
+    return TestController::update();
+  }
+
+  hardware_interface::RealtimeMemoryPool pool{1 << 12, false};
+};
+
+/// Exposes the service callbacks
+class ListingControllerManager : public controller_manager::ControllerManager
+{
+public:
+  using ControllerManager::ControllerManager;
+  using ControllerManager::list_controllers_srv_cb;
+};
+
+ControllerCpuBudgetOptions make_options(OverrunPolicy policy, unsigned int overrun_limit = 2)
+{
+  ControllerCpuBudgetOptions options;
+  options.budget_ns = 1000;
+  options.policy = policy;
+  options.overrun_limit = overrun_limit;
+  return options;
+}
+
+class TestControllerCpuBudget : public TestControllerManager
+{
+public:
+  void SetUp() override
+  {
+    TestControllerManager::SetUp();
+    cm_ = std::make_shared<ListingControllerManager>(robot_, executor_, "test_controller_manager");
+  }
+
+  std::shared_ptr<BusyController> add_controller(const std::string & name, int64_t busy_ns)
+  {
+    auto controller = std::make_shared<BusyController>();
+    controller->busy_ns = busy_ns;
+    // distinct resources, so that the controllers are updated in the same stage
+    controller->claimed_resources = {{"position", {name + "_joint"}}};
+    cm_->add_controller(controller, name, test_controller::TEST_CONTROLLER_TYPE);
+    return controller;
+  }
+
+  /// Switches the controllers, updating until the switch is applied
+  void switch_controllers(
+    const std::vector<std::string> & start_controllers,
+    const std::vector<std::string> & stop_controllers)
+  {
+    auto switch_future = std::async(
+      std::launch::async, &controller_manager::ControllerManager::switch_controller, cm_,
+      start_controllers, stop_controllers, STRICT, true, rclcpp::Duration(0, 0));
+    while (switch_future.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready) {
+      cm_->update();
+    }
+    ASSERT_EQ(controller_interface::return_type::SUCCESS, switch_future.get());
+  }
+
+  void update(size_t count)
+  {
+    for (size_t i = 0; i < count; ++i) {
+      ASSERT_EQ(controller_interface::return_type::SUCCESS, cm_->update());
+    }
+  }
+
+  /// The controllers as listed by the ListControllers service
+  std::vector<controller_manager_msgs::msg::ControllerState> list_controllers()
+  {
+    auto request = std::make_shared<controller_manager_msgs::srv::ListControllers::Request>();
+    auto response = std::make_shared<controller_manager_msgs::srv::ListControllers::Response>();
+    cm_->list_controllers_srv_cb(request, response);
+    return response->controller;
+  }
+
+  std::shared_ptr<ListingControllerManager> cm_;
+};
+}  // namespace
+
+TEST(ControllerCpuBudget, not_budgeted) {
+  ControllerCpuBudget budget;
+  EXPECT_FALSE(budget.is_budgeted());
+  for (uint64_t i = 0; i < 10; ++i) {
+    EXPECT_TRUE(budget.begin_update(i));
+    EXPECT_FALSE(budget.end_update(1000000));
+  }
+  EXPECT_EQ(0u, budget.get_overrun_count());
+  EXPECT_EQ(1000000, budget.get_last_cpu_time_ns());
+  EXPECT_EQ(1000000, budget.get_max_cpu_time_ns());
+}
+
+TEST(ControllerCpuBudget, skips_the_next_update_on_a_sustained_overrun) {
+  ControllerCpuBudget budget(make_options(OverrunPolicy::SKIP));
+  EXPECT_TRUE(budget.is_budgeted());
+  EXPECT_FALSE(budget.end_update(2000));
+  // an update within the budget ends the overrun
+  EXPECT_FALSE(budget.end_update(1000));
+  EXPECT_FALSE(budget.end_update(2000));
+  EXPECT_TRUE(budget.end_update(2000));
+  EXPECT_EQ(3u, budget.get_overrun_count());
+  EXPECT_EQ(1u, budget.get_degradation_count());
+  EXPECT_FALSE(budget.can_degrade());
+
+  EXPECT_FALSE(budget.begin_update(0));
+  EXPECT_TRUE(budget.begin_update(1));
+  EXPECT_TRUE(budget.begin_update(2));
+  EXPECT_EQ(1u, budget.get_skipped_count());
+  EXPECT_TRUE(budget.can_degrade());
+}
+
+TEST(ControllerCpuBudget, halves_the_rate_on_each_sustained_overrun) {
+  ControllerCpuBudget budget(make_options(OverrunPolicy::DECIMATE, 1));
+  EXPECT_TRUE(budget.end_update(2000));
+  EXPECT_TRUE(budget.end_update(2000));
+  EXPECT_EQ(4u, budget.get_rate_divider());
+  size_t updated = 0;
+  for (uint64_t i = 0; i < 16; ++i) {
+    updated += budget.begin_update(i) ? 1 : 0;
+  }
+  EXPECT_EQ(4u, updated);
+  EXPECT_EQ(12u, budget.get_skipped_count());
+
+  while (budget.can_degrade()) {
+    EXPECT_TRUE(budget.degrade());
+  }
+  EXPECT_EQ(ControllerCpuBudget::MAX_RATE_DIVIDER, budget.get_rate_divider());
+  EXPECT_FALSE(budget.degrade());
+
+  budget.reset();
+  EXPECT_EQ(1u, budget.get_rate_divider());
+  // the counters are kept
+  EXPECT_EQ(2u, budget.get_overrun_count());
+}
+
+TEST(ControllerCpuBudget, spans_the_updates_left_out) {
+  ControllerCpuBudget budget(make_options(OverrunPolicy::SKIP, 1));
+  EXPECT_TRUE(budget.begin_update(0));
+  EXPECT_EQ(1u, budget.get_update_span());
+  EXPECT_TRUE(budget.degrade());
+  EXPECT_FALSE(budget.begin_update(1));
+  EXPECT_TRUE(budget.begin_update(2));
+  EXPECT_EQ(2u, budget.get_update_span());
+  EXPECT_TRUE(budget.begin_update(3));
+  EXPECT_EQ(1u, budget.get_update_span());
+
+  EXPECT_TRUE(budget.degrade());
+  EXPECT_FALSE(budget.begin_update(4));
+  budget.reset();
+  EXPECT_TRUE(budget.begin_update(5));
+  EXPECT_EQ(1u, budget.get_update_span());
+}
+
+TEST(ControllerCpuBudget, suspends_the_updates_until_reset) {
+  ControllerCpuBudget budget(make_options(OverrunPolicy::DEACTIVATE));
+  EXPECT_FALSE(budget.end_update(2000));
+  EXPECT_TRUE(budget.end_update(2000));
+  EXPECT_TRUE(budget.is_suspended());
+  EXPECT_FALSE(budget.can_degrade());
+  for (uint64_t i = 0; i < 5; ++i) {
+    EXPECT_FALSE(budget.begin_update(i));
+  }
+  budget.reset();
+  EXPECT_FALSE(budget.is_suspended());
+  EXPECT_TRUE(budget.begin_update(5));
+}
+
+TEST(ControllerCpuBudget, measures_the_cpu_time_of_the_thread) {
+  auto start = ControllerCpuBudget::thread_cpu_time_ns();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_LT(ControllerCpuBudget::thread_cpu_time_ns() - start, 25000000);
+
+  start = ControllerCpuBudget::thread_cpu_time_ns();
+  const auto wall_start = std::chrono::steady_clock::now();
+  while (std::chrono::steady_clock::now() - wall_start < std::chrono::milliseconds(5)) {
+  }
+  EXPECT_LT(0, ControllerCpuBudget::thread_cpu_time_ns() - start);
+}
+
+TEST(ControllerAccounting, averages_the_recent_updates) {
+  ControllerAccounting accounting(4);
+  accounting.record_update(100);
+  accounting.record_update(300);
+  EXPECT_EQ(2u, accounting.get_update_count());
+  EXPECT_EQ(400, accounting.get_total_cpu_time_ns());
+  // the first window as it fills
+  EXPECT_EQ(200, accounting.get_recent_cpu_time_ns());
+  accounting.record_update(200);
+  accounting.record_update(200);
+  EXPECT_EQ(200, accounting.get_recent_cpu_time_ns());
+
+  // the next windows once complete
+  for (int i = 0; i < 3; ++i) {
+    accounting.record_update(1000);
+  }
+  EXPECT_EQ(200, accounting.get_recent_cpu_time_ns());
+  accounting.record_update(1000);
+  EXPECT_EQ(1000, accounting.get_recent_cpu_time_ns());
+  EXPECT_EQ(8u, accounting.get_update_count());
+  EXPECT_EQ(4800, accounting.get_total_cpu_time_ns());
+  EXPECT_EQ(4u, accounting.get_recent_window());
+}
+
+TEST(ControllerCpuBudget, policy_names) {
+  OverrunPolicy policy = OverrunPolicy::SKIP;
+  EXPECT_TRUE(ControllerCpuBudget::from_string("decimate", policy));
+  EXPECT_EQ(OverrunPolicy::DECIMATE, policy);
+  EXPECT_STREQ("decimate", ControllerCpuBudget::to_string(policy));
+  EXPECT_TRUE(ControllerCpuBudget::from_string("deactivate", policy));
+  EXPECT_EQ(OverrunPolicy::DEACTIVATE, policy);
+  EXPECT_FALSE(ControllerCpuBudget::from_string("abort", policy));
+  EXPECT_EQ(OverrunPolicy::DEACTIVATE, policy);
+}
+
+TEST_F(TestControllerCpuBudget, budgets_are_read_from_the_parameters) {
+  cm_->set_parameter(rclcpp::Parameter("budgeted.cpu_budget_us", 100));
+  cm_->set_parameter(rclcpp::Parameter("budgeted.overrun_policy", "decimate"));
+  cm_->set_parameter(rclcpp::Parameter("budgeted.overrun_limit", 5));
+  cm_->set_parameter(rclcpp::Parameter("budgeted.priority", 2));
+  cm_->set_parameter(rclcpp::Parameter("unbudgeted.priority", 1));
+  add_controller("budgeted", 0);
+  add_controller("unbudgeted", 0);
+
+  const auto controllers = cm_->get_loaded_controllers();
+  ASSERT_EQ(2u, controllers.size());
+  const auto & budgeted = controllers[0].cpu_budget->get_options();
+  EXPECT_EQ(100000, budgeted.budget_ns);
+  EXPECT_EQ(OverrunPolicy::DECIMATE, budgeted.policy);
+  EXPECT_EQ(5u, budgeted.overrun_limit);
+  EXPECT_EQ(2, budgeted.priority);
+  EXPECT_FALSE(controllers[1].cpu_budget->is_budgeted());
+  EXPECT_EQ(1, controllers[1].cpu_budget->get_options().priority);
+}
+
+TEST_F(TestControllerCpuBudget, deactivates_an_overrunning_controller_until_restarted) {
+  cm_->set_parameter(rclcpp::Parameter("busy.cpu_budget_us", 100));
+  cm_->set_parameter(rclcpp::Parameter("busy.overrun_policy", "deactivate"));
+  cm_->set_parameter(rclcpp::Parameter("busy.overrun_limit", 2));
+  auto busy = add_controller("busy", 1000000);
+  auto idle = add_controller("idle", 0);
+  switch_controllers({"busy", "idle"}, {});
+
+  update(5);
+  const auto busy_updates = busy->internal_counter;
+  EXPECT_LE(2u, busy_updates);
+  update(5);
+  // suspended, the other controller goes on
+  EXPECT_EQ(busy_updates, busy->internal_counter);
+  EXPECT_LE(10u, idle->internal_counter);
+
+  auto request = std::make_shared<controller_manager_msgs::srv::ListControllers::Request>();
+  auto response = std::make_shared<controller_manager_msgs::srv::ListControllers::Response>();
+  cm_->list_controllers_srv_cb(request, response);
+  ASSERT_EQ(2u, response->controller.size());
+  const auto & budget = response->controller[0].cpu_budget;
+  EXPECT_EQ(100000, budget.budget_ns);
+  EXPECT_EQ("deactivate", budget.overrun_policy);
+  EXPECT_TRUE(budget.suspended);
+  EXPECT_EQ(1u, budget.degradation_count);
+  EXPECT_LE(2u, budget.overrun_count);
+  EXPECT_LE(5u, budget.skipped_count);
+  EXPECT_LE(1000000, budget.max_cpu_time_ns);
+  EXPECT_FALSE(response->controller[1].cpu_budget.suspended);
+
+  switch_controllers({}, {"busy"});
+  busy->busy_ns = 0;
+  switch_controllers({"busy"}, {});
+  update(5);
+  EXPECT_LE(busy_updates + 5, busy->internal_counter);
+}
+
+TEST_F(TestControllerCpuBudget, period_spans_the_updates_left_out_by_decimation) {
+  cm_->set_parameter(rclcpp::Parameter("decimated.cpu_budget_us", 1000));
+  cm_->set_parameter(rclcpp::Parameter("decimated.overrun_policy", "decimate"));
+  auto controller = std::make_shared<PeriodController>();
+  cm_->add_controller(controller, "decimated", test_controller::TEST_CONTROLLER_TYPE);
+  switch_controllers({"decimated"}, {});
+
+  const rclcpp::Duration period(std::chrono::milliseconds(1));
+  rclcpp::Time time(1000000000LL);
+  for (int i = 0; i < 2; ++i) {
+    time = time + period;
+    ASSERT_EQ(controller_interface::return_type::SUCCESS, cm_->update(time, period));
+  }
+  EXPECT_EQ(period, controller->last_period);
+
+  // updated once every 4 updates due from now on
+  auto & budget = *cm_->get_loaded_controllers()[0].cpu_budget;
+  EXPECT_TRUE(budget.degrade());
+  EXPECT_TRUE(budget.degrade());
+  ASSERT_EQ(4u, budget.get_rate_divider());
+  const auto updates = controller->internal_counter;
+  for (int i = 0; i < 12; ++i) {
+    time = time + period;
+    ASSERT_EQ(controller_interface::return_type::SUCCESS, cm_->update(time, period));
+  }
+  EXPECT_EQ(updates + 3, controller->internal_counter);
+  EXPECT_EQ(rclcpp::Duration(std::chrono::milliseconds(4)), controller->last_period);
+}
+
+TEST_F(TestControllerCpuBudget, sheds_the_controllers_of_lowest_priority_first) {
+  for (const auto & name : {"critical", "optional"}) {
+    const std::string prefix(name);
+    cm_->set_parameter(rclcpp::Parameter(prefix + ".cpu_budget_us", 10000));
+    cm_->set_parameter(rclcpp::Parameter(prefix + ".overrun_policy", "deactivate"));
+  }
+  cm_->set_parameter(rclcpp::Parameter("critical.priority", 10));
+  // loaded first, but of a lower priority
+  auto optional = add_controller("optional", 300000);
+  auto critical = add_controller("critical", 300000);
+  switch_controllers({"optional", "critical"}, {});
+  cm_->set_update_cpu_budget(std::chrono::microseconds(400));
+
+  update(10);
+  const auto controllers = cm_->get_loaded_controllers();
+  EXPECT_TRUE(controllers[0].cpu_budget->is_suspended());
+  EXPECT_FALSE(controllers[1].cpu_budget->is_suspended());
+  EXPECT_LE(10u, critical->internal_counter);
+  // neither overran its own budget
+  EXPECT_EQ(0u, controllers[0].cpu_budget->get_overrun_count());
+  EXPECT_EQ(0u, controllers[1].cpu_budget->get_overrun_count());
+}
+
+TEST_F(TestControllerCpuBudget, accounts_the_updates_to_their_controller) {
+  add_controller("busy", 100000);
+  auto pooled = std::make_shared<PoolController>();
+  pooled->claimed_resources = {{"position", {"pooled_joint"}}};
+  cm_->add_controller(pooled, "pooled", test_controller::TEST_CONTROLLER_TYPE);
+  switch_controllers({"busy", "pooled"}, {});
+  update(5);
+
+  auto controllers = list_controllers();
+  ASSERT_EQ(2u, controllers.size());
+  const auto & busy = controllers[0].resource_usage;
+  EXPECT_LE(5u, busy.update_count);
+  EXPECT_LE(static_cast<int64_t>(busy.update_count) * 100000, busy.total_cpu_time_ns);
+  EXPECT_LE(100000, busy.recent_cpu_time_ns);
+  EXPECT_EQ(ControllerAccounting::RECENT_WINDOW, busy.recent_window);
+  EXPECT_EQ(0u, busy.pool_allocation_count);
+
+  // rounded up to the size class of 32 bytes
+  const auto & usage = controllers[1].resource_usage;
+  EXPECT_LE(5u, usage.update_count);
+  EXPECT_EQ(usage.update_count, usage.pool_allocation_count);
+  EXPECT_EQ(32 * usage.update_count, usage.pool_allocated_bytes);
+  EXPECT_EQ(usage.update_count, usage.pool_deallocation_count);
+  EXPECT_EQ(usage.pool_allocated_bytes, usage.pool_deallocated_bytes);
+
+  cm_->set_controller_accounting(false);
+  const auto update_count = usage.update_count;
+  update(5);
+  controllers = list_controllers();
+  EXPECT_EQ(update_count, controllers[1].resource_usage.update_count);
+  EXPECT_EQ(update_count, controllers[1].resource_usage.pool_allocation_count);
+  EXPECT_LE(5u + update_count, pooled->internal_counter);
+}
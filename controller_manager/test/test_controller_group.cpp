@@ -0,0 +1,221 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "controller_manager/controller_group_thread.hpp"
+#include "controller_manager_test_common.hpp"
+
+using controller_manager::ControllerGroupOptions;
+using controller_manager::ControllerGroupThread;
+
+namespace
+{
+/// Records the thread and the position in the cycle of its last update
+class RecordingController : public test_controller::TestController
+{
+public:
+  explicit RecordingController(std::atomic<int> & sequence)
+  : sequence_(sequence)
+  {
+  }
+
+  controller_interface::return_type update() override
+  {
+    thread_id = std::this_thread::get_id();
+    position = sequence_++;
+    return TestController::update();
+  }
+
+  std::thread::id thread_id;
+  int position = -1;
+
+private:
+  std::atomic<int> & sequence_;
+};
+
+ControllerGroupOptions make_options(int order)
+{
+  ControllerGroupOptions options;
+  options.order = order;
+  return options;
+}
+
+class TestControllerGroup : public TestControllerManager
+{
+public:
+  void SetUp() override
+  {
+    TestControllerManager::SetUp();
+    cm_ = std::make_shared<controller_manager::ControllerManager>(
+      robot_, executor_, "test_controller_manager");
+  }
+
+  std::shared_ptr<RecordingController> add_controller(
+    const std::string & name, const std::string & group)
+  {
+    if (!group.empty()) {
+      cm_->set_parameter(rclcpp::Parameter(name + ".group", group));
+    }
+    auto controller = std::make_shared<RecordingController>(sequence_);
+    // distinct resources, so that the controllers are updated in the same stage
+    controller->claimed_resources = {{"position", {name + "_joint"}}};
+    cm_->add_controller(controller, name, test_controller::TEST_CONTROLLER_TYPE);
+    return controller;
+  }
+
+  /// Starts the controllers, updating until the switch is applied
+  void start_controllers(const std::vector<std::string> & start_controllers)
+  {
+    auto switch_future = std::async(
+      std::launch::async, &controller_manager::ControllerManager::switch_controller, cm_,
+      start_controllers, std::vector<std::string>(), STRICT, true, rclcpp::Duration(0, 0));
+    while (switch_future.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready) {
+      cm_->update();
+    }
+    ASSERT_EQ(controller_interface::return_type::SUCCESS, switch_future.get());
+  }
+
+  std::atomic<int> sequence_{0};
+  std::shared_ptr<controller_manager::ControllerManager> cm_;
+};
+}  // namespace
+
+TEST(ControllerGroupThread, runs_the_task_in_its_thread) {
+  ControllerGroupOptions options;
+  options.cpus = {0};
+  ControllerGroupThread group(3, "group", options);
+  EXPECT_EQ(3u, group.get_index());
+  EXPECT_EQ("group", group.get_name());
+  // nothing started yet
+  group.wait();
+
+  for (int i = 0; i < 10; ++i) {
+    std::thread::id thread_id;
+    size_t index = 0;
+    int cpu = -1;
+    auto task = [&](size_t group_index) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        thread_id = std::this_thread::get_id();
+        index = group_index;
+        cpu = sched_getcpu();
+      };
+    group.start(task);
+    group.wait();
+    EXPECT_NE(std::this_thread::get_id(), thread_id);
+    EXPECT_EQ(3u, index);
+    EXPECT_EQ(0, cpu);
+  }
+}
+
+TEST(ControllerGroupThread, waits_for_a_group_of_lower_priority_on_the_same_cpu) {
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(0, &cpu_set);
+  sched_param param;
+  param.sched_priority = 20;
+  if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) != 0 ||
+    pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0)
+  {
+    GTEST_SKIP() << "Cannot run the test thread with a real-time priority";
+  }
+
+  {
+    ControllerGroupOptions options;
+    options.cpus = {0};
+    options.priority = 10;
+    ControllerGroupThread group(0, "group", options);
+    // the group thread only runs once the waiting thread sleeps
+    for (int i = 0; i < 10; ++i) {
+      int updates = 0;
+      auto task = [&updates](size_t) {
+          std::this_thread::sleep_for(std::chrono::microseconds(100));
+          ++updates;
+        };
+      group.start(task);
+      group.wait();
+      EXPECT_EQ(1, updates);
+    }
+  }
+
+  param.sched_priority = 0;
+  pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+  CPU_ZERO(&cpu_set);
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    CPU_SET(cpu, &cpu_set);
+  }
+  pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+}
+
+TEST_F(TestControllerGroup, updates_the_groups_by_order_in_their_threads) {
+  ASSERT_EQ(
+    controller_interface::return_type::SUCCESS,
+    cm_->add_controller_group("late", make_options(1)));
+  ASSERT_EQ(
+    controller_interface::return_type::SUCCESS,
+    cm_->add_controller_group("early", make_options(0)));
+  ASSERT_EQ(
+    controller_interface::return_type::ERROR,
+    cm_->add_controller_group("early", make_options(0)));
+
+  auto late = add_controller("late_controller", "late");
+  auto early = add_controller("early_controller", "early");
+  auto ungrouped = add_controller("ungrouped_controller", "");
+  auto unknown = add_controller("unknown_controller", "unknown");
+  start_controllers(
+    {"late_controller", "early_controller", "ungrouped_controller", "unknown_controller"});
+  // the groups are only added before the controllers are loaded
+  EXPECT_EQ(
+    controller_interface::return_type::ERROR,
+    cm_->add_controller_group("other", make_options(0)));
+
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_EQ(controller_interface::return_type::SUCCESS, cm_->update());
+    const auto this_thread = std::this_thread::get_id();
+    EXPECT_EQ(this_thread, ungrouped->thread_id);
+    EXPECT_EQ(this_thread, unknown->thread_id);
+    EXPECT_NE(this_thread, early->thread_id);
+    EXPECT_NE(this_thread, late->thread_id);
+    EXPECT_NE(early->thread_id, late->thread_id);
+    // order 0 for the early group and the controllers out of any group
+    EXPECT_GT(late->position, early->position);
+    EXPECT_GT(late->position, ungrouped->position);
+    EXPECT_GT(late->position, unknown->position);
+  }
+}
+
+TEST_F(TestControllerGroup, updates_in_the_calling_thread_when_stepped) {
+  ASSERT_EQ(
+    controller_interface::return_type::SUCCESS,
+    cm_->add_controller_group("late", make_options(1)));
+  auto late = add_controller("late_controller", "late");
+  auto ungrouped = add_controller("ungrouped_controller", "");
+  start_controllers({"late_controller", "ungrouped_controller"});
+
+  cm_->enable_stepping(rclcpp::Time(0, 0));
+  ASSERT_EQ(
+    controller_interface::return_type::SUCCESS,
+    cm_->step(rclcpp::Duration(std::chrono::milliseconds(1))));
+  EXPECT_EQ(std::this_thread::get_id(), late->thread_id);
+  EXPECT_GT(late->position, ungrouped->position);
+}
@@ -0,0 +1,133 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "controller_manager/controller_input_tracker.hpp"
+#include "controller_manager_test_common.hpp"
+#include "hardware_interface/types/hardware_interface_type_values.hpp"
+
+using controller_manager::ControllerInputTracker;
+
+namespace
+{
+/// Holds joint1 in place, computing its command from the position of joint1 only
+class HoldController : public test_controller::TestController
+{
+public:
+  explicit HoldController(bool deterministic = true)
+  : deterministic(deterministic)
+  {
+    claimed_resources = {{hardware_interface::HW_IF_POSITION_COMMAND, {"joint1"}}};
+    read_states = {{hardware_interface::HW_IF_POSITION, {"joint1"}}};
+  }
+
+  bool is_deterministic() const override
+  {
+    return deterministic;
+  }
+
+  using ControllerInterface::request_update;
+
+  bool deterministic;
+};
+}  // namespace
+
+TEST(TestControllerInputTracker, reports_the_changes_since_the_previous_update) {
+  std::vector<double> values = {1.0, std::numeric_limits<double>::quiet_NaN()};
+  ControllerInputTracker tracker({&values[0], &values[1]});
+  EXPECT_EQ(2u, tracker.size());
+  EXPECT_TRUE(tracker.update());
+  // compared bit for bit, the NaN of a reference not written yet does not change
+  EXPECT_FALSE(tracker.update());
+
+  values[0] = 2.0;
+  EXPECT_TRUE(tracker.update());
+  EXPECT_FALSE(tracker.update());
+  values[1] = 0.0;
+  EXPECT_TRUE(tracker.update());
+
+  tracker.reset();
+  EXPECT_TRUE(tracker.update());
+  EXPECT_FALSE(tracker.update());
+
+  ControllerInputTracker no_inputs;
+  EXPECT_TRUE(no_inputs.update());
+  EXPECT_FALSE(no_inputs.update());
+}
+
+TEST_F(TestControllerManager, unchanged_deterministic_controllers_are_skipped) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_, "test_controller_manager");
+  cm->enable_stepping(rclcpp::Time(1, 0));
+  auto hold = std::make_shared<HoldController>();
+  auto nondeterministic = std::make_shared<HoldController>(false);
+  nondeterministic->claimed_resources = {{hardware_interface::HW_IF_VELOCITY_COMMAND, {"joint1"}}};
+  auto undeclared = std::make_shared<HoldController>();
+  undeclared->claimed_resources = {{hardware_interface::HW_IF_EFFORT_COMMAND, {"joint1"}}};
+  undeclared->read_states.clear();
+  cm->add_controller(hold, "hold", test_controller::TEST_CONTROLLER_TYPE);
+  cm->add_controller(nondeterministic, "nondeterministic", test_controller::TEST_CONTROLLER_TYPE);
+  cm->add_controller(undeclared, "undeclared", test_controller::TEST_CONTROLLER_TYPE);
+  ASSERT_EQ(
+    controller_interface::return_type::SUCCESS,
+    cm->switch_controller({"hold", "nondeterministic", "undeclared"}, {}, STRICT));
+
+  const rclcpp::Duration dt(0, 1000000);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->step(dt));
+  }
+  // updated once after being started
+  EXPECT_EQ(1u, hold->internal_counter);
+  EXPECT_EQ(3u, nondeterministic->internal_counter);
+  EXPECT_EQ(3u, undeclared->internal_counter);
+
+  // the test hardware writes the commands back to the states, moved together
+  const auto move_joint1 = [this](const std::string & state, const std::string & command) {
+      hardware_interface::JointHandle state_handle("joint1", state);
+      hardware_interface::JointHandle command_handle("joint1", command);
+      ASSERT_EQ(hardware_interface::return_type::OK, robot_->get_joint_handle(state_handle));
+      ASSERT_EQ(hardware_interface::return_type::OK, robot_->get_joint_handle(command_handle));
+      command_handle.set_value(state_handle.get_value() + 0.1);
+      state_handle.set_value(command_handle.get_value());
+    };
+  move_joint1(hardware_interface::HW_IF_POSITION, hardware_interface::HW_IF_POSITION_COMMAND);
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->step(dt));
+  EXPECT_EQ(2u, hold->internal_counter);
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->step(dt));
+  EXPECT_EQ(2u, hold->internal_counter);
+
+  // the other state interfaces are not inputs of the controller
+  move_joint1(hardware_interface::HW_IF_VELOCITY, hardware_interface::HW_IF_VELOCITY_COMMAND);
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->step(dt));
+  EXPECT_EQ(2u, hold->internal_counter);
+
+  hold->request_update();
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->step(dt));
+  EXPECT_EQ(3u, hold->internal_counter);
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->step(dt));
+  EXPECT_EQ(3u, hold->internal_counter);
+
+  // updated again once restarted
+  ASSERT_EQ(
+    controller_interface::return_type::SUCCESS, cm->switch_controller({}, {"hold"}, STRICT));
+  ASSERT_EQ(
+    controller_interface::return_type::SUCCESS, cm->switch_controller({"hold"}, {}, STRICT));
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->step(dt));
+  EXPECT_EQ(4u, hold->internal_counter);
+  EXPECT_EQ(9u, nondeterministic->internal_counter);
+}
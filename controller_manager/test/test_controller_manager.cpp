@@ -13,17 +13,307 @@
 // limitations under the License.
 
 #include <gtest/gtest.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "controller_manager/controller_manager.hpp"
+#include "controller_manager/controller_worker_pool.hpp"
 #include "controller_manager_msgs/srv/list_controllers.hpp"
 #include "controller_manager_test_common.hpp"
+#include "hardware_interface/hardware_freshness.hpp"
+#include "hardware_interface/realtime_section.hpp"
 #include "lifecycle_msgs/msg/state.hpp"
 #include "test_robot_hardware/test_robot_hardware.hpp"
 #include "./test_controller/test_controller.hpp"
 
+namespace
+{
+/// Records the order of the updates, and waits in update() for count controllers to be updating
+class ConcurrencyTestController : public test_controller::TestController
+{
+public:
+  struct Shared
+  {
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t in_update = 0;
+    size_t max_in_update = 0;
+    size_t wait_for_count = 1;
+    std::vector<std::string> update_order;
+  };
+
+  ConcurrencyTestController(const std::string & name, Shared & shared)
+  : name_(name), shared_(shared)
+  {
+  }
+
+  controller_interface::return_type update() override
+  {
+    std::unique_lock<std::mutex> lock(shared_.mutex);
+    shared_.update_order.push_back(name_);
+    ++shared_.in_update;
+    shared_.max_in_update = std::max(shared_.max_in_update, shared_.in_update);
+    shared_.cv.notify_all();
+    const bool all_updating = shared_.cv.wait_for(
+      lock, std::chrono::milliseconds(500),
+      [this] {return shared_.max_in_update >= shared_.wait_for_count;});
+    --shared_.in_update;
+    ++internal_counter;
+    return all_updating ?
+           controller_interface::return_type::SUCCESS : controller_interface::return_type::ERROR;
+  }
+
+private:
+  std::string name_;
+  Shared & shared_;
+};
+
+/// Fails to activate, so it stays inactive when started
+class FailingActivationController : public test_controller::TestController
+{
+public:
+  rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn
+  on_activate(const rclcpp_lifecycle::State &) override
+  {
+    return rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn::FAILURE;
+  }
+};
+
+/// Records the threads and the number of updates of its lifecycle transitions
+class LifecycleRecordingController : public test_controller::TestController
+{
+public:
+  rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn
+  on_activate(const rclcpp_lifecycle::State &) override
+  {
+    activate_threads.push_back(std::this_thread::get_id());
+    updates_when_activated.push_back(internal_counter);
+    return rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn::SUCCESS;
+  }
+
+  rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn
+  on_deactivate(const rclcpp_lifecycle::State &) override
+  {
+    deactivate_threads.push_back(std::this_thread::get_id());
+    updates_when_deactivated.push_back(internal_counter);
+    return rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn::SUCCESS;
+  }
+
+  std::vector<std::thread::id> activate_threads;
+  std::vector<std::thread::id> deactivate_threads;
+  std::vector<size_t> updates_when_activated;
+  std::vector<size_t> updates_when_deactivated;
+};
+
+/// Records the time and period of its updates
+class TimedTestController : public test_controller::TestController
+{
+public:
+  using TestController::update;
+
+  controller_interface::return_type update(
+    const rclcpp::Time & time, const rclcpp::Duration & period) override
+  {
+    last_time = time;
+    last_period = period;
+    return TestController::update();
+  }
+
+  rclcpp::Time last_time;
+  rclcpp::Duration last_period{0, 0};
+};
+
+/// Records its dry-run updates, and whether it was active and not yet updated during them
+class WarmUpTestController : public TimedTestController
+{
+public:
+  controller_interface::return_type warm_up(
+    const rclcpp::Time & time, const rclcpp::Duration & period) override
+  {
+    ++warm_up_count;
+    warmed_up_active = get_lifecycle_node()->get_current_state().id() ==
+      lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE;
+    updates_when_warmed_up = internal_counter;
+    warm_up_time = time;
+    warm_up_period = period;
+    return controller_interface::return_type::SUCCESS;
+  }
+
+  size_t warm_up_count = 0;
+  bool warmed_up_active = false;
+  size_t updates_when_warmed_up = 0;
+  rclcpp::Time warm_up_time;
+  rclcpp::Duration warm_up_period{0, 0};
+};
+
+/// Exports a position reference of joint1, and records the value it reads in update()
+class ChainedDownstreamController : public test_controller::TestController
+{
+public:
+  std::map<std::string, std::vector<std::string>> get_reference_interfaces() const override
+  {
+    return {{"position_reference", {"joint1"}}};
+  }
+
+  rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn
+  on_activate(const rclcpp_lifecycle::State &) override
+  {
+    reference_ = get_reference_value("position_reference", "joint1");
+    return reference_ ?
+           rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn::SUCCESS :
+           rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn::FAILURE;
+  }
+
+  controller_interface::return_type update() override
+  {
+    read_references.push_back(*reference_);
+    return TestController::update();
+  }
+
+  std::vector<double> read_references;
+
+private:
+  const double * reference_ = nullptr;
+};
+
+/// Writes its update count to the position reference of joint1 of the downstream controller
+class ChainedUpstreamController : public test_controller::TestController
+{
+public:
+  ChainedUpstreamController()
+  {
+    claimed_resources["position_reference"] = {"downstream_controller/joint1"};
+  }
+
+  rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn
+  on_activate(const rclcpp_lifecycle::State &) override
+  {
+    if (robot_hardware_.lock()->get_reference_handle(reference_) !=
+      hardware_interface::return_type::OK)
+    {
+      return rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn::FAILURE;
+    }
+    return rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn::SUCCESS;
+  }
+
+  controller_interface::return_type update() override
+  {
+    auto ret = TestController::update();
+    reference_.set_value(static_cast<double>(internal_counter));
+    return ret;
+  }
+
+private:
+  hardware_interface::JointHandle reference_{
+    "downstream_controller/joint1", "position_reference"};
+};
+
+/// Records the switches of the controller manager, and fails them on request
+class SwitchTestHardware : public test_robot_hardware::TestRobotHardware
+{
+public:
+  hardware_interface::return_type prepare_switch(
+    const std::vector<hardware_interface::ControllerInfo> & start_list,
+    const std::vector<hardware_interface::ControllerInfo> & stop_list) override
+  {
+    prepared_start_count = start_list.size();
+    prepared_stop_count = stop_list.size();
+    return prepare_result;
+  }
+
+  hardware_interface::return_type perform_switch(
+    const std::vector<hardware_interface::ControllerInfo> & start_list,
+    const std::vector<hardware_interface::ControllerInfo> &) override
+  {
+    performed_start_names.clear();
+    for (const auto & info : start_list) {
+      performed_start_names.push_back(info.name);
+    }
+    return perform_result;
+  }
+
+  hardware_interface::switch_state get_switch_state() const override
+  {
+    return switch_state;
+  }
+
+  hardware_interface::switch_state get_switch_state(
+    const hardware_interface::ControllerInfo & controller) const override
+  {
+    const auto it = controller_switch_states.find(controller.name);
+    return it == controller_switch_states.end() ? switch_state : it->second;
+  }
+
+  hardware_interface::return_type prepare_result = hardware_interface::return_type::OK;
+  hardware_interface::return_type perform_result = hardware_interface::return_type::OK;
+  size_t prepared_start_count = 0;
+  size_t prepared_stop_count = 0;
+  std::vector<std::string> performed_start_names;
+  hardware_interface::switch_state switch_state = hardware_interface::switch_state::DONE;
+  std::map<std::string, hardware_interface::switch_state> controller_switch_states;
+};
+
+void start_controllers(
+  std::shared_ptr<controller_manager::ControllerManager> cm,
+  const std::vector<std::string> & start_controllers)
+{
+  auto switch_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    start_controllers, std::vector<std::string>{},
+    STRICT, true, rclcpp::Duration(0, 0));
+  ASSERT_EQ(
+    std::future_status::timeout,
+    switch_future.wait_for(std::chrono::milliseconds(100))) <<
+    "switch_controller should be blocking until next update cycle";
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, switch_future.get());
+}
+
+void stop_controllers(
+  std::shared_ptr<controller_manager::ControllerManager> cm,
+  const std::vector<std::string> & stop_controllers)
+{
+  auto switch_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    std::vector<std::string>{}, stop_controllers,
+    STRICT, true, rclcpp::Duration(0, 0));
+  ASSERT_EQ(
+    std::future_status::timeout,
+    switch_future.wait_for(std::chrono::milliseconds(100))) <<
+    "switch_controller should be blocking until next update cycle";
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, switch_future.get());
+}
+
+/// Whether the real-time thread updates the controller, its lifecycle is already active while it
+/// waits to be started
+bool is_updated(
+  std::shared_ptr<controller_manager::ControllerManager> cm, const std::string & name)
+{
+  for (const auto & controller : cm->get_loaded_controllers()) {
+    if (controller.info.name == name) {
+      return controller.running->load();
+    }
+  }
+  ADD_FAILURE() << "controller " << name << " is not loaded";
+  return false;
+}
+}  // namespace
+
 TEST_F(TestControllerManager, controller_lifecycle) {
   auto cm = std::make_shared<controller_manager::ControllerManager>(
     robot_, executor_,
@@ -122,5 +412,987 @@ TEST_F(TestControllerManager, controller_lifecycle) {
   EXPECT_EQ(
     lifecycle_msgs::msg::State::PRIMARY_STATE_UNCONFIGURED,
     test_controller->get_lifecycle_node()->get_current_state().id());
+
+  // The retired controllers list is destroyed in the background
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+  while (test_controller.use_count() > 1 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
   EXPECT_EQ(1, test_controller.use_count());
 }
+
+TEST_F(TestControllerManager, load_unload_while_updating) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+
+  std::atomic<bool> keep_updating{true};
+  std::thread rt_thread(
+    [&cm, &keep_updating]() {
+      while (keep_updating) {
+        cm->update();
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+      }
+    });
+
+  for (size_t i = 0; i < 50u; ++i) {
+    auto test_controller = std::make_shared<test_controller::TestController>();
+    ASSERT_NE(
+      nullptr,
+      cm->add_controller(
+        test_controller, test_controller::TEST_CONTROLLER_NAME,
+        test_controller::TEST_CONTROLLER_TYPE));
+    ASSERT_EQ(
+      controller_interface::return_type::SUCCESS,
+      cm->unload_controller(test_controller::TEST_CONTROLLER_NAME));
+  }
+  EXPECT_TRUE(cm->get_loaded_controllers().empty());
+
+  keep_updating = false;
+  rt_thread.join();
+}
+
+TEST_F(TestControllerManager, queued_switches_applied_in_one_cycle) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+
+  auto test_controller1 = std::make_shared<test_controller::TestController>();
+  auto test_controller2 = std::make_shared<test_controller::TestController>();
+  cm->add_controller(test_controller1, "test_controller1", test_controller::TEST_CONTROLLER_TYPE);
+  cm->add_controller(test_controller2, "test_controller2", test_controller::TEST_CONTROLLER_TYPE);
+
+  auto switch_future1 = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    std::vector<std::string>{"test_controller1"}, std::vector<std::string>{},
+    STRICT, true, rclcpp::Duration(0, 0));
+  auto switch_future2 = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    std::vector<std::string>{"test_controller2"}, std::vector<std::string>{},
+    STRICT, true, rclcpp::Duration(0, 0));
+
+  ASSERT_EQ(
+    std::future_status::timeout,
+    switch_future1.wait_for(std::chrono::milliseconds(100))) <<
+    "switch_controller should be blocking until next update cycle";
+  ASSERT_EQ(
+    std::future_status::timeout,
+    switch_future2.wait_for(std::chrono::milliseconds(100))) <<
+    "switch_controller should be blocking until next update cycle";
+
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, switch_future1.get());
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, switch_future2.get());
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE,
+    test_controller1->get_lifecycle_node()->get_current_state().id());
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE,
+    test_controller2->get_lifecycle_node()->get_current_state().id());
+
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_EQ(1u, test_controller1->internal_counter);
+  EXPECT_EQ(1u, test_controller2->internal_counter);
+}
+
+TEST_F(TestControllerManager, switch_requester_is_woken_by_the_update) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+  auto test_controller = std::make_shared<test_controller::TestController>();
+  cm->add_controller(test_controller, "test_controller", test_controller::TEST_CONTROLLER_TYPE);
+
+  // the requesting thread sleeps until the update applying its switch wakes it, it does not poll
+  std::vector<std::chrono::steady_clock::duration> latencies;
+  for (int i = 0; i < 20; ++i) {
+    const bool start = i % 2 == 0;
+    auto switch_future = std::async(
+      std::launch::async, [&cm, start] {
+        const std::vector<std::string> controllers{"test_controller"};
+        const auto result = cm->switch_controller(
+          start ? controllers : std::vector<std::string>{},
+          start ? std::vector<std::string>{} : controllers, STRICT, true, rclcpp::Duration(0, 0));
+        EXPECT_EQ(controller_interface::return_type::SUCCESS, result);
+        return std::chrono::steady_clock::now();
+      });
+    ASSERT_EQ(
+      std::future_status::timeout,
+      switch_future.wait_for(std::chrono::milliseconds(20)));
+    const auto update_time = std::chrono::steady_clock::now();
+    EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+    latencies.push_back(switch_future.get() - update_time);
+    EXPECT_EQ(start, is_updated(cm, "test_controller"));
+  }
+  std::sort(latencies.begin(), latencies.end());
+  // a wake takes tens of microseconds, polling every millisecond is hundreds in the median
+  EXPECT_LT(
+    std::chrono::duration_cast<std::chrono::microseconds>(latencies[latencies.size() / 2]).count(),
+    200);
+}
+
+TEST_F(TestControllerManager, switch_abandoned_at_shutdown_is_not_destroyed_by_the_update) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+  auto test_controller = std::make_shared<test_controller::TestController>();
+  cm->add_controller(test_controller, "test_controller", test_controller::TEST_CONTROLLER_TYPE);
+
+  auto switch_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    std::vector<std::string>{"test_controller"}, std::vector<std::string>{},
+    STRICT, true, rclcpp::Duration(0, 0));
+  ASSERT_EQ(
+    std::future_status::timeout,
+    switch_future.wait_for(std::chrono::milliseconds(100)));
+  // the requesting thread stops waiting, the request is still queued
+  rclcpp::shutdown();
+  EXPECT_EQ(controller_interface::return_type::ERROR, switch_future.get());
+  rclcpp::init(0, nullptr);
+
+  // applied without releasing the last reference, which the next switch releases
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_TRUE(is_updated(cm, "test_controller"));
+  stop_controllers(cm, {"test_controller"});
+  EXPECT_FALSE(is_updated(cm, "test_controller"));
+}
+
+TEST_F(TestControllerManager, running_state_follows_the_lifecycle_transitions) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+
+  auto test_controller = std::make_shared<test_controller::TestController>();
+  auto failing_controller = std::make_shared<FailingActivationController>();
+  cm->add_controller(test_controller, "test_controller", test_controller::TEST_CONTROLLER_TYPE);
+  cm->add_controller(
+    failing_controller, "failing_controller", test_controller::TEST_CONTROLLER_TYPE);
+  auto is_running = [&cm](const std::string & name) {
+      for (const auto & controller : cm->get_loaded_controllers()) {
+        if (controller.info.name == name) {
+          return controller.running->load();
+        }
+      }
+      ADD_FAILURE() << "controller " << name << " is not loaded";
+      return false;
+    };
+  EXPECT_FALSE(is_running("test_controller"));
+  EXPECT_FALSE(is_running("failing_controller"));
+
+  start_controllers(cm, {"test_controller", "failing_controller"});
+  EXPECT_TRUE(is_running("test_controller"));
+  EXPECT_FALSE(is_running("failing_controller"));
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE,
+    failing_controller->get_lifecycle_node()->get_current_state().id());
+
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_EQ(1u, test_controller->internal_counter);
+  EXPECT_EQ(0u, failing_controller->internal_counter) << "Controller failed to activate";
+
+  auto switch_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    std::vector<std::string>{}, std::vector<std::string>{"test_controller"},
+    STRICT, true, rclcpp::Duration(0, 0));
+  ASSERT_EQ(
+    std::future_status::timeout,
+    switch_future.wait_for(std::chrono::milliseconds(100))) <<
+    "switch_controller should be blocking until next update cycle";
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, switch_future.get());
+  EXPECT_FALSE(is_running("test_controller"));
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_EQ(2u, test_controller->internal_counter);
+}
+
+TEST_F(TestControllerManager, controllers_snapshot_follows_the_changes) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+  auto snapshot = cm->get_controllers_snapshot();
+  ASSERT_NE(nullptr, snapshot);
+  EXPECT_EQ(0u, snapshot->version);
+  EXPECT_TRUE(snapshot->controllers.empty());
+
+  auto test_controller = std::make_shared<test_controller::TestController>();
+  test_controller->claimed_resources = {{"position", {"joint1"}}};
+  cm->add_controller(test_controller, "test_controller", test_controller::TEST_CONTROLLER_TYPE);
+  auto loaded_snapshot = cm->get_controllers_snapshot();
+  EXPECT_EQ(1u, loaded_snapshot->version);
+  ASSERT_EQ(1u, loaded_snapshot->controllers.size());
+  EXPECT_EQ("test_controller", loaded_snapshot->controllers[0].name);
+  EXPECT_EQ(test_controller::TEST_CONTROLLER_TYPE, loaded_snapshot->controllers[0].type);
+  EXPECT_EQ("inactive", loaded_snapshot->controllers[0].state);
+  ASSERT_EQ(1u, loaded_snapshot->controllers[0].claimed_resources.size());
+  EXPECT_EQ("position", loaded_snapshot->controllers[0].claimed_resources[0].hardware_interface);
+  ASSERT_EQ(1u, loaded_snapshot->update_timing.size());
+  // the snapshots taken before are not modified
+  EXPECT_EQ(0u, snapshot->version);
+  EXPECT_TRUE(snapshot->controllers.empty());
+
+  start_controllers(cm, {"test_controller"});
+  snapshot = cm->get_controllers_snapshot();
+  EXPECT_EQ(2u, snapshot->version);
+  ASSERT_EQ(1u, snapshot->controllers.size());
+  EXPECT_EQ("active", snapshot->controllers[0].state);
+  EXPECT_EQ("inactive", loaded_snapshot->controllers[0].state);
+
+  // not rebuilt when nothing changes
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_EQ(snapshot, cm->get_controllers_snapshot());
+
+  stop_controllers(cm, {"test_controller"});
+  // the list used by the real-time thread is only handed over while it is updating
+  auto unload_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::unload_controller, cm, "test_controller");
+  while (unload_future.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready) {
+    EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  }
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, unload_future.get());
+  snapshot = cm->get_controllers_snapshot();
+  EXPECT_EQ(4u, snapshot->version);
+  EXPECT_TRUE(snapshot->controllers.empty());
+}
+
+TEST_F(TestControllerManager, conflicting_claims_are_rejected) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+
+  auto arm_controller = std::make_shared<test_controller::TestController>();
+  arm_controller->claimed_resources = {{"position", {"joint1", "joint2"}}};
+  auto gripper_controller = std::make_shared<test_controller::TestController>();
+  gripper_controller->claimed_resources = {{"position", {"joint2"}}};
+  auto velocity_controller = std::make_shared<test_controller::TestController>();
+  velocity_controller->claimed_resources = {{"velocity", {"joint1", "joint2"}}};
+  auto undeclared_controller = std::make_shared<test_controller::TestController>();
+  cm->add_controller(arm_controller, "arm", test_controller::TEST_CONTROLLER_TYPE);
+  cm->add_controller(gripper_controller, "gripper", test_controller::TEST_CONTROLLER_TYPE);
+  cm->add_controller(velocity_controller, "velocity", test_controller::TEST_CONTROLLER_TYPE);
+  cm->add_controller(undeclared_controller, "undeclared", test_controller::TEST_CONTROLLER_TYPE);
+
+  // rejected before the request reaches the real-time thread, update() is not needed
+  EXPECT_EQ(
+    controller_interface::return_type::ERROR,
+    cm->switch_controller({"arm", "gripper"}, {}, BEST_EFFORT, true, rclcpp::Duration(0, 0)));
+
+  start_controllers(cm, {"arm", "velocity", "undeclared"});
+  EXPECT_EQ(
+    controller_interface::return_type::ERROR,
+    cm->switch_controller({"gripper"}, {}, STRICT, true, rclcpp::Duration(0, 0)));
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE,
+    gripper_controller->get_lifecycle_node()->get_current_state().id());
+
+  // the claims of the stopped controllers are released by the same switch
+  auto switch_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    std::vector<std::string>{"gripper"}, std::vector<std::string>{"arm"},
+    STRICT, true, rclcpp::Duration(0, 0));
+  ASSERT_EQ(
+    std::future_status::timeout,
+    switch_future.wait_for(std::chrono::milliseconds(100))) <<
+    "switch_controller should be blocking until next update cycle";
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, switch_future.get());
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE,
+    gripper_controller->get_lifecycle_node()->get_current_state().id());
+}
+
+TEST_F(TestControllerManager, claimed_joint_values_are_handed_to_the_hardware) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+
+  auto arm_controller = std::make_shared<test_controller::TestController>();
+  arm_controller->claimed_resources = {{"position_command", {"joint1"}}};
+  arm_controller->read_states = {{"position", {"joint1"}}, {"velocity", {"joint1"}}};
+  auto undeclared_controller = std::make_shared<test_controller::TestController>();
+  cm->add_controller(arm_controller, "arm", test_controller::TEST_CONTROLLER_TYPE);
+  cm->add_controller(undeclared_controller, "undeclared", test_controller::TEST_CONTROLLER_TYPE);
+  const auto get_claimed = [this]() {
+      const auto claimed = robot_->get_claimed_joint_values();
+      return std::vector<uint64_t>(claimed.begin(), claimed.end());
+    };
+
+  // all the values are read and written until the first switch
+  std::vector<uint64_t> all;
+  ASSERT_EQ(hardware_interface::return_type::OK, robot_->get_joint_value_mask(false, all));
+  ASSERT_EQ(hardware_interface::return_type::OK, robot_->get_joint_value_mask(true, all));
+  EXPECT_EQ(robot_->get_joint_value_mask_size(), all.size());
+  EXPECT_EQ(all, get_claimed());
+
+  start_controllers(cm, {"arm"});
+  std::vector<uint64_t> arm;
+  ASSERT_EQ(
+    hardware_interface::return_type::OK,
+    robot_->get_joint_value_mask(
+      {{"position", {"joint1"}}, {"velocity", {"joint1"}}, {"position_command", {"joint1"}}},
+      arm));
+  EXPECT_EQ(arm, get_claimed());
+  // the positions of joint1 and joint2, registered first
+  EXPECT_TRUE(robot_->is_joint_value_claimed(robot_->get_joint_values().get_offset(0, 0)));
+  EXPECT_FALSE(robot_->is_joint_value_claimed(robot_->get_joint_values().get_offset(1, 0)));
+
+  // the controllers which did not declare their interfaces may use any of them
+  start_controllers(cm, {"undeclared"});
+  EXPECT_EQ(all, get_claimed());
+
+  stop_controllers(cm, {"arm", "undeclared"});
+  EXPECT_EQ(std::vector<uint64_t>(all.size(), 0u), get_claimed());
+}
+
+TEST_F(TestControllerManager, lifecycle_transitions_are_not_run_in_update) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+  auto controller = std::make_shared<LifecycleRecordingController>();
+  cm->add_controller(controller, "controller", test_controller::TEST_CONTROLLER_TYPE);
+  const auto update_thread = std::this_thread::get_id();
+
+  start_controllers(cm, {"controller"});
+  ASSERT_EQ(1u, controller->activate_threads.size());
+  EXPECT_NE(update_thread, controller->activate_threads[0]);
+  EXPECT_EQ(0u, controller->updates_when_activated[0]) << "activated before its first update";
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_EQ(1u, controller->internal_counter);
+
+  // a restart deactivates and activates the controller, which is not updated meanwhile
+  auto switch_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    std::vector<std::string>{"controller"}, std::vector<std::string>{"controller"},
+    STRICT, true, rclcpp::Duration(0, 0));
+  while (switch_future.wait_for(std::chrono::milliseconds(10)) != std::future_status::ready) {
+    EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  }
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, switch_future.get());
+  ASSERT_EQ(1u, controller->deactivate_threads.size());
+  ASSERT_EQ(2u, controller->activate_threads.size());
+  EXPECT_NE(update_thread, controller->deactivate_threads[0]);
+  EXPECT_NE(update_thread, controller->activate_threads[1]);
+  EXPECT_TRUE(is_updated(cm, "controller"));
+  const auto updates_before_restart = controller->internal_counter;
+  EXPECT_EQ(updates_before_restart, controller->updates_when_deactivated[0]);
+  EXPECT_EQ(updates_before_restart, controller->updates_when_activated[1]);
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_EQ(updates_before_restart + 1, controller->internal_counter);
+
+  stop_controllers(cm, {"controller"});
+  ASSERT_EQ(2u, controller->deactivate_threads.size());
+  EXPECT_NE(update_thread, controller->deactivate_threads[1]);
+  EXPECT_EQ(controller->internal_counter, controller->updates_when_deactivated[1]) <<
+    "deactivated after its last update";
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE,
+    controller->get_lifecycle_node()->get_current_state().id());
+}
+
+TEST_F(TestControllerManager, controller_nodes_on_dedicated_executor) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+  EXPECT_EQ(executor_, cm->get_controller_executor());
+
+  ASSERT_EQ(controller_interface::return_type::SUCCESS, cm->set_controller_executor(2, {0}));
+  const auto controller_executor = cm->get_controller_executor();
+  ASSERT_NE(nullptr, controller_executor);
+  EXPECT_NE(executor_, controller_executor);
+
+  auto controller = std::make_shared<test_controller::TestController>();
+  cm->add_controller(controller, "controller", test_controller::TEST_CONTROLLER_TYPE);
+  // the node of the loaded controller would be left on the previous executor
+  EXPECT_EQ(controller_interface::return_type::ERROR, cm->set_controller_executor(0));
+  EXPECT_EQ(controller_executor, cm->get_controller_executor());
+
+  start_controllers(cm, {"controller"});
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_EQ(1u, controller->internal_counter);
+  stop_controllers(cm, {"controller"});
+
+  auto unload_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::unload_controller, cm, "controller");
+  while (unload_future.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready) {
+    EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  }
+  ASSERT_EQ(controller_interface::return_type::SUCCESS, unload_future.get());
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->set_controller_executor(0));
+  EXPECT_EQ(executor_, cm->get_controller_executor());
+}
+
+TEST_F(TestControllerManager, hardware_switch_hooks) {
+  auto robot = std::make_shared<SwitchTestHardware>();
+  robot->init();
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot, executor_,
+    "test_controller_manager");
+  auto test_controller = std::make_shared<test_controller::TestController>();
+  cm->add_controller(test_controller, "test_controller", test_controller::TEST_CONTROLLER_TYPE);
+
+  robot->prepare_result = hardware_interface::return_type::ERROR;
+  EXPECT_EQ(
+    controller_interface::return_type::ERROR,
+    cm->switch_controller({"test_controller"}, {}, STRICT, true, rclcpp::Duration(0, 0)));
+  EXPECT_EQ(1u, robot->prepared_start_count);
+  EXPECT_EQ(0u, robot->prepared_stop_count);
+
+  robot->prepare_result = hardware_interface::return_type::OK;
+  robot->perform_result = hardware_interface::return_type::ERROR;
+  auto switch_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    std::vector<std::string>{"test_controller"}, std::vector<std::string>{},
+    STRICT, true, rclcpp::Duration(0, 0));
+  ASSERT_EQ(
+    std::future_status::timeout,
+    switch_future.wait_for(std::chrono::milliseconds(100))) <<
+    "switch_controller should be blocking until next update cycle";
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_EQ(controller_interface::return_type::ERROR, switch_future.get());
+  EXPECT_EQ(std::vector<std::string>{"test_controller"}, robot->performed_start_names);
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE,
+    test_controller->get_lifecycle_node()->get_current_state().id());
+
+  robot->perform_result = hardware_interface::return_type::OK;
+  start_controllers(cm, {"test_controller"});
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE,
+    test_controller->get_lifecycle_node()->get_current_state().id());
+}
+
+TEST_F(TestControllerManager, ongoing_hardware_switch_delays_start) {
+  auto robot = std::make_shared<SwitchTestHardware>();
+  robot->init();
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot, executor_,
+    "test_controller_manager");
+  auto test_controller = std::make_shared<test_controller::TestController>();
+  cm->add_controller(test_controller, "test_controller", test_controller::TEST_CONTROLLER_TYPE);
+
+  robot->switch_state = hardware_interface::switch_state::ONGOING;
+  auto switch_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    std::vector<std::string>{"test_controller"}, std::vector<std::string>{},
+    STRICT, false, rclcpp::Duration(0, 0));
+  ASSERT_EQ(
+    std::future_status::timeout,
+    switch_future.wait_for(std::chrono::milliseconds(100))) <<
+    "switch_controller should be blocking until next update cycle";
+  // the update cycles are not blocked while the hardware is switching
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  }
+  EXPECT_EQ(
+    std::future_status::timeout,
+    switch_future.wait_for(std::chrono::milliseconds(10)));
+  EXPECT_FALSE(is_updated(cm, "test_controller"));
+  EXPECT_EQ(0u, test_controller->internal_counter);
+
+  robot->switch_state = hardware_interface::switch_state::DONE;
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, switch_future.get());
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE,
+    test_controller->get_lifecycle_node()->get_current_state().id());
+}
+
+TEST_F(TestControllerManager, hardware_switch_timeout_aborts_start) {
+  auto robot = std::make_shared<SwitchTestHardware>();
+  robot->init();
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot, executor_,
+    "test_controller_manager");
+  auto test_controller = std::make_shared<test_controller::TestController>();
+  cm->add_controller(test_controller, "test_controller", test_controller::TEST_CONTROLLER_TYPE);
+
+  robot->switch_state = hardware_interface::switch_state::ONGOING;
+  auto switch_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    std::vector<std::string>{"test_controller"}, std::vector<std::string>{},
+    STRICT, false, rclcpp::Duration(std::chrono::milliseconds(50)));
+  ASSERT_EQ(
+    std::future_status::timeout,
+    switch_future.wait_for(std::chrono::milliseconds(100))) <<
+    "switch_controller should be blocking until next update cycle";
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_EQ(controller_interface::return_type::ERROR, switch_future.get());
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE,
+    test_controller->get_lifecycle_node()->get_current_state().id());
+
+  // a hardware error aborts the switch as well
+  robot->switch_state = hardware_interface::switch_state::ERROR;
+  switch_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    std::vector<std::string>{"test_controller"}, std::vector<std::string>{},
+    STRICT, false, rclcpp::Duration(0, 0));
+  ASSERT_EQ(
+    std::future_status::timeout,
+    switch_future.wait_for(std::chrono::milliseconds(100))) <<
+    "switch_controller should be blocking until next update cycle";
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_EQ(controller_interface::return_type::ERROR, switch_future.get());
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE,
+    test_controller->get_lifecycle_node()->get_current_state().id());
+}
+
+TEST_F(TestControllerManager, start_asap_starts_switched_controllers_first) {
+  auto robot = std::make_shared<SwitchTestHardware>();
+  robot->init();
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot, executor_,
+    "test_controller_manager");
+  auto fast_controller = std::make_shared<test_controller::TestController>();
+  auto slow_controller = std::make_shared<test_controller::TestController>();
+  cm->add_controller(fast_controller, "fast", test_controller::TEST_CONTROLLER_TYPE);
+  cm->add_controller(slow_controller, "slow", test_controller::TEST_CONTROLLER_TYPE);
+
+  robot->controller_switch_states["slow"] = hardware_interface::switch_state::ONGOING;
+  auto switch_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    std::vector<std::string>{"fast", "slow"}, std::vector<std::string>{},
+    STRICT, true, rclcpp::Duration(0, 0));
+  ASSERT_EQ(
+    std::future_status::timeout,
+    switch_future.wait_for(std::chrono::milliseconds(100))) <<
+    "switch_controller should be blocking until next update cycle";
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE,
+    fast_controller->get_lifecycle_node()->get_current_state().id());
+  EXPECT_TRUE(is_updated(cm, "fast"));
+  EXPECT_FALSE(is_updated(cm, "slow"));
+  EXPECT_EQ(
+    std::future_status::timeout,
+    switch_future.wait_for(std::chrono::milliseconds(10)));
+
+  // the controller started first is updated while the other one waits for the hardware
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_EQ(1u, fast_controller->internal_counter);
+  EXPECT_EQ(0u, slow_controller->internal_counter);
+
+  robot->controller_switch_states["slow"] = hardware_interface::switch_state::DONE;
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, switch_future.get());
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE,
+    slow_controller->get_lifecycle_node()->get_current_state().id());
+}
+
+TEST_F(TestControllerManager, multi_rate_controllers_are_staggered) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+  cm->set_parameter(rclcpp::Parameter("update_rate", 100));
+  cm->set_parameter(rclcpp::Parameter("slow_controller.update_rate", 50));
+  cm->set_parameter(rclcpp::Parameter("slower_controller1.update_rate", 25));
+  cm->set_parameter(rclcpp::Parameter("slower_controller2.update_rate", 25));
+
+  auto fast_controller = std::make_shared<test_controller::TestController>();
+  auto slow_controller = std::make_shared<test_controller::TestController>();
+  auto slower_controller1 = std::make_shared<test_controller::TestController>();
+  auto slower_controller2 = std::make_shared<test_controller::TestController>();
+  cm->add_controller(fast_controller, "fast_controller", test_controller::TEST_CONTROLLER_TYPE);
+  cm->add_controller(slow_controller, "slow_controller", test_controller::TEST_CONTROLLER_TYPE);
+  cm->add_controller(
+    slower_controller1, "slower_controller1", test_controller::TEST_CONTROLLER_TYPE);
+  cm->add_controller(
+    slower_controller2, "slower_controller2", test_controller::TEST_CONTROLLER_TYPE);
+
+  const auto controllers = cm->get_loaded_controllers();
+  ASSERT_EQ(4u, controllers.size());
+  EXPECT_EQ(1u, controllers[0].update_period);
+  EXPECT_EQ(2u, controllers[1].update_period);
+  EXPECT_EQ(4u, controllers[2].update_period);
+  EXPECT_EQ(4u, controllers[3].update_period);
+  EXPECT_NE(controllers[2].update_phase, controllers[3].update_phase) <<
+    "controllers with the same rate should not be updated on the same tick";
+
+  auto switch_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    std::vector<std::string>{
+    "fast_controller", "slow_controller", "slower_controller1", "slower_controller2"},
+    std::vector<std::string>{}, STRICT, true, rclcpp::Duration(0, 0));
+  ASSERT_EQ(
+    std::future_status::timeout,
+    switch_future.wait_for(std::chrono::milliseconds(100))) <<
+    "switch_controller should be blocking until next update cycle";
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, switch_future.get());
+
+  const auto slow_counters = [&]() {
+      return slow_controller->internal_counter + slower_controller1->internal_counter +
+             slower_controller2->internal_counter;
+    };
+  size_t max_slow_updates_per_tick = 0;
+  for (size_t i = 0; i < 8; ++i) {
+    const auto slow_updates_before = slow_counters();
+    EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+    max_slow_updates_per_tick =
+      std::max(max_slow_updates_per_tick, slow_counters() - slow_updates_before);
+  }
+  EXPECT_EQ(8u, fast_controller->internal_counter);
+  EXPECT_EQ(4u, slow_controller->internal_counter);
+  EXPECT_EQ(2u, slower_controller1->internal_counter);
+  EXPECT_EQ(2u, slower_controller2->internal_counter);
+  EXPECT_EQ(1u, max_slow_updates_per_tick);
+}
+
+TEST_F(TestControllerManager, controllers_share_the_time_of_the_cycle) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+  cm->set_parameter(rclcpp::Parameter("update_rate", 100));
+  cm->set_parameter(rclcpp::Parameter("slow_controller.update_rate", 50));
+
+  auto fast_controller = std::make_shared<TimedTestController>();
+  auto slow_controller = std::make_shared<TimedTestController>();
+  // updated through the update() without time, for compatibility
+  auto untimed_controller = std::make_shared<test_controller::TestController>();
+  cm->add_controller(fast_controller, "fast_controller", test_controller::TEST_CONTROLLER_TYPE);
+  cm->add_controller(slow_controller, "slow_controller", test_controller::TEST_CONTROLLER_TYPE);
+  cm->add_controller(
+    untimed_controller, "untimed_controller", test_controller::TEST_CONTROLLER_TYPE);
+  start_controllers(cm, {"fast_controller", "slow_controller", "untimed_controller"});
+
+  const rclcpp::Duration period(std::chrono::milliseconds(10));
+  rclcpp::Time time(1000000000LL);
+  for (size_t i = 0; i < 4; ++i) {
+    time = time + period;
+    EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update(time, period));
+    EXPECT_EQ(time, fast_controller->last_time);
+    EXPECT_EQ(period, fast_controller->last_period);
+  }
+  EXPECT_EQ(4u, untimed_controller->internal_counter);
+  // the slow controller is given the time since its own previous update
+  ASSERT_EQ(2u, slow_controller->internal_counter);
+  EXPECT_EQ(rclcpp::Duration(std::chrono::milliseconds(20)), slow_controller->last_period);
+  const rclcpp::Time previous_time(time.nanoseconds() - period.nanoseconds());
+  EXPECT_TRUE(
+    slow_controller->last_time == time || slow_controller->last_time == previous_time);
+
+  // without time, the period is measured between the updates
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_GE(fast_controller->last_period, rclcpp::Duration(std::chrono::milliseconds(2)));
+}
+
+TEST_F(TestControllerManager, warm_up_runs_dry_updates_before_the_first_update) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+  cm->set_parameter(rclcpp::Parameter("update_rate", 100));
+  cm->set_parameter(rclcpp::Parameter("warm_controller.warm_up_updates", 3));
+  cm->enable_stepping(rclcpp::Time(1, 0));
+  auto warm_controller = std::make_shared<WarmUpTestController>();
+  auto cold_controller = std::make_shared<WarmUpTestController>();
+  cm->add_controller(warm_controller, "warm_controller", test_controller::TEST_CONTROLLER_TYPE);
+  cm->add_controller(cold_controller, "cold_controller", test_controller::TEST_CONTROLLER_TYPE);
+  EXPECT_EQ(0u, warm_controller->warm_up_count);
+
+  // applied right away in stepped mode
+  EXPECT_EQ(
+    controller_interface::return_type::SUCCESS,
+    cm->switch_controller({"warm_controller", "cold_controller"}, {}, STRICT));
+  EXPECT_EQ(3u, warm_controller->warm_up_count);
+  EXPECT_TRUE(warm_controller->warmed_up_active);
+  EXPECT_EQ(0u, warm_controller->updates_when_warmed_up);
+  EXPECT_EQ(rclcpp::Duration(std::chrono::milliseconds(10)), warm_controller->warm_up_period);
+  EXPECT_EQ(rclcpp::Time(1, 30000000).nanoseconds(), warm_controller->warm_up_time.nanoseconds());
+  EXPECT_EQ(0u, cold_controller->warm_up_count);
+
+  const rclcpp::Duration dt(std::chrono::milliseconds(10));
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->step(dt));
+  EXPECT_EQ(1u, warm_controller->internal_counter);
+  EXPECT_EQ(3u, warm_controller->warm_up_count);
+
+  // warmed up again each time it is started
+  EXPECT_EQ(
+    controller_interface::return_type::SUCCESS,
+    cm->switch_controller({}, {"warm_controller"}, STRICT));
+  EXPECT_EQ(
+    controller_interface::return_type::SUCCESS,
+    cm->switch_controller({"warm_controller"}, {}, STRICT));
+  EXPECT_EQ(6u, warm_controller->warm_up_count);
+  EXPECT_EQ(1u, warm_controller->updates_when_warmed_up);
+}
+
+TEST_F(TestControllerManager, independent_controllers_update_in_parallel) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+  cm->set_update_threads(1);
+
+  ConcurrencyTestController::Shared shared;
+  auto left_arm_controller = std::make_shared<ConcurrencyTestController>("left_arm", shared);
+  auto right_arm_controller = std::make_shared<ConcurrencyTestController>("right_arm", shared);
+  left_arm_controller->claimed_resources["position_command"] = {"left_joint1", "left_joint2"};
+  right_arm_controller->claimed_resources["position_command"] = {"right_joint1", "right_joint2"};
+  cm->add_controller(
+    left_arm_controller, "left_arm_controller", test_controller::TEST_CONTROLLER_TYPE);
+  cm->add_controller(
+    right_arm_controller, "right_arm_controller", test_controller::TEST_CONTROLLER_TYPE);
+  start_controllers(cm, {"left_arm_controller", "right_arm_controller"});
+
+  shared.wait_for_count = 2;
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update()) <<
+    "both controllers should be updating at the same time";
+  EXPECT_EQ(2u, shared.max_in_update);
+  EXPECT_EQ(1u, left_arm_controller->internal_counter);
+  EXPECT_EQ(1u, right_arm_controller->internal_counter);
+}
+
+TEST(ControllerWorkerPool, waits_for_workers_of_lower_priority_on_the_same_cpu) {
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(0, &cpu_set);
+  sched_param param;
+  param.sched_priority = 20;
+  if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) != 0 ||
+    pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0)
+  {
+    GTEST_SKIP() << "Cannot run the test thread with a real-time priority";
+  }
+
+  {
+    // the workers inherit the CPU of the test thread, and only run once it sleeps, after it ran
+    // all the tasks of the batch itself
+    controller_manager::ControllerWorkerPool pool(2, 10);
+    for (int i = 0; i < 10; ++i) {
+      std::atomic<int> tasks{0};
+      auto task = [&tasks](size_t) {++tasks;};
+      pool.run(4, task);
+      EXPECT_EQ(4, tasks);
+    }
+  }
+
+  param.sched_priority = 0;
+  pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+  CPU_ZERO(&cpu_set);
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    CPU_SET(cpu, &cpu_set);
+  }
+  pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+}
+
+TEST_F(TestControllerManager, conflicting_controllers_update_in_load_order) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+  cm->set_update_threads(2);
+
+  ConcurrencyTestController::Shared shared;
+  auto trajectory_controller = std::make_shared<ConcurrencyTestController>("trajectory", shared);
+  auto gravity_controller = std::make_shared<ConcurrencyTestController>("gravity", shared);
+  auto legacy_controller = std::make_shared<ConcurrencyTestController>("legacy", shared);
+  // controllers claiming a common interface cannot run together, the ones which did not declare
+  // their claims conflict with all the others
+  trajectory_controller->claimed_resources["effort_command"] = {"joint1"};
+  cm->add_controller(
+    trajectory_controller, "trajectory_controller", test_controller::TEST_CONTROLLER_TYPE);
+  cm->add_controller(
+    gravity_controller, "gravity_controller", test_controller::TEST_CONTROLLER_TYPE);
+  cm->add_controller(
+    legacy_controller, "legacy_controller", test_controller::TEST_CONTROLLER_TYPE);
+  start_controllers(cm, {"legacy_controller", "gravity_controller", "trajectory_controller"});
+
+  shared.update_order.clear();
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  }
+  EXPECT_EQ(1u, shared.max_in_update);
+  EXPECT_EQ(
+    (std::vector<std::string>{
+    "trajectory", "gravity", "legacy",
+    "trajectory", "gravity", "legacy",
+    "trajectory", "gravity", "legacy"}),
+    shared.update_order);
+}
+
+TEST_F(TestControllerManager, chained_controllers_pass_references_in_the_same_cycle) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+  cm->set_update_threads(2);
+
+  // loaded before the controller writing its references, updated after it
+  auto downstream_controller = std::make_shared<ChainedDownstreamController>();
+  auto upstream_controller = std::make_shared<ChainedUpstreamController>();
+  cm->add_controller(
+    downstream_controller, "downstream_controller", test_controller::TEST_CONTROLLER_TYPE);
+  cm->add_controller(
+    upstream_controller, "upstream_controller", test_controller::TEST_CONTROLLER_TYPE);
+  auto loaded_controllers = cm->get_loaded_controllers();
+  ASSERT_EQ(2u, loaded_controllers.size());
+  EXPECT_EQ("upstream_controller", loaded_controllers[0].info.name);
+  EXPECT_EQ("downstream_controller", loaded_controllers[1].info.name);
+  EXPECT_EQ(
+    (std::vector<std::string>{"downstream_controller/joint1"}),
+    loaded_controllers[1].info.references["position_reference"]);
+
+  start_controllers(cm, {"downstream_controller", "upstream_controller"});
+  const auto upstream_count = upstream_controller->internal_counter;
+  downstream_controller->read_references.clear();
+  for (int i = 1; i <= 3; ++i) {
+    EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  }
+  // the value written by the upstream controller in the same cycle
+  EXPECT_EQ(
+    (std::vector<double>{
+    static_cast<double>(upstream_count + 1), static_cast<double>(upstream_count + 2),
+    static_cast<double>(upstream_count + 3)}),
+    downstream_controller->read_references);
+
+  // the upstream controller holds a handle to the references
+  stop_controllers(cm, {"downstream_controller", "upstream_controller"});
+  EXPECT_EQ(
+    controller_interface::return_type::ERROR, cm->unload_controller("downstream_controller"));
+  for (const auto & name : {"upstream_controller", "downstream_controller"}) {
+    auto unload_future = std::async(
+      std::launch::async, &controller_manager::ControllerManager::unload_controller, cm, name);
+    while (unload_future.wait_for(std::chrono::milliseconds(10)) != std::future_status::ready) {
+      cm->update();
+    }
+    EXPECT_EQ(controller_interface::return_type::SUCCESS, unload_future.get());
+  }
+  hardware_interface::JointHandle reference(
+    "downstream_controller/joint1", "position_reference");
+  EXPECT_NE(hardware_interface::return_type::OK, robot_->get_reference_handle(reference));
+}
+
+TEST_F(TestControllerManager, stepped_mode_runs_in_the_calling_thread) {
+  auto robot = std::make_shared<SwitchTestHardware>();
+  robot->init();
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot, executor_,
+    "test_controller_manager");
+  cm->enable_stepping(rclcpp::Time(1, 0));
+  EXPECT_TRUE(cm->is_stepping());
+  auto test_controller = std::make_shared<TimedTestController>();
+  cm->add_controller(test_controller, "test_controller", test_controller::TEST_CONTROLLER_TYPE);
+
+  // applied right away, without waiting for a cycle
+  EXPECT_EQ(
+    controller_interface::return_type::SUCCESS,
+    cm->switch_controller({"test_controller"}, {}, STRICT));
+  EXPECT_TRUE(is_updated(cm, "test_controller"));
+  EXPECT_EQ(0u, test_controller->internal_counter);
+
+  const rclcpp::Duration dt(0, 1000000);
+  for (int i = 1; i <= 100; ++i) {
+    EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->step(dt));
+  }
+  EXPECT_EQ(100u, test_controller->internal_counter);
+  EXPECT_EQ(rclcpp::Time(1, 100000000).nanoseconds(), test_controller->last_time.nanoseconds());
+  EXPECT_EQ(dt.nanoseconds(), test_controller->last_period.nanoseconds());
+  EXPECT_EQ(rclcpp::Time(1, 100000000).nanoseconds(), cm->get_step_time().nanoseconds());
+
+  EXPECT_EQ(
+    controller_interface::return_type::SUCCESS,
+    cm->switch_controller({}, {"test_controller"}, STRICT));
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->step(dt));
+  EXPECT_EQ(100u, test_controller->internal_counter);
+
+  // nothing advances a hardware switch until the next step, so it is aborted
+  robot->switch_state = hardware_interface::switch_state::ONGOING;
+  EXPECT_EQ(
+    controller_interface::return_type::ERROR,
+    cm->switch_controller({"test_controller"}, {}, STRICT));
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE,
+    test_controller->get_lifecycle_node()->get_current_state().id());
+
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->unload_controller("test_controller"));
+  EXPECT_TRUE(cm->get_loaded_controllers().empty());
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->step(dt));
+}
+
+TEST_F(TestControllerManager, control_cycle_is_realtime_clean) {
+  // run with the realtime_violation_detector library preloaded, see the test target
+  if (!hardware_interface::RealtimeSection::is_checked()) {
+    GTEST_SKIP();
+  }
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+  auto test_controller = std::make_shared<TimedTestController>();
+  cm->add_controller(test_controller, "test_controller", test_controller::TEST_CONTROLLER_TYPE);
+  auto other_controller = std::make_shared<TimedTestController>();
+  cm->add_controller(other_controller, "other_controller", test_controller::TEST_CONTROLLER_TYPE);
+
+  // the switches are applied by the real-time thread too
+  std::atomic<bool> running{true};
+  hardware_interface::RealtimeSection::reset_violation_count();
+  std::thread rt_thread([&running, &cm, this] {
+      while (running) {
+        hardware_interface::RealtimeSection realtime_section;
+        robot_->read();
+        cm->update();
+        robot_->write();
+      }
+    });
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(
+      controller_interface::return_type::SUCCESS,
+      cm->switch_controller({"test_controller", "other_controller"}, {}, STRICT));
+    EXPECT_EQ(
+      controller_interface::return_type::SUCCESS,
+      cm->switch_controller({}, {"test_controller", "other_controller"}, STRICT));
+  }
+  running = false;
+  rt_thread.join();
+  EXPECT_EQ(0u, hardware_interface::RealtimeSection::get_violation_count());
+  EXPECT_LT(0u, test_controller->internal_counter);
+
+  // also in the stepped mode
+  cm->enable_stepping(rclcpp::Time(1, 0));
+  ASSERT_EQ(
+    controller_interface::return_type::SUCCESS,
+    cm->switch_controller({"test_controller"}, {}, STRICT));
+  const auto counter = test_controller->internal_counter;
+  hardware_interface::RealtimeSection::reset_violation_count();
+  const rclcpp::Duration dt(0, 1000000);
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(controller_interface::return_type::SUCCESS, cm->step(dt));
+  }
+  EXPECT_EQ(0u, hardware_interface::RealtimeSection::get_violation_count());
+  EXPECT_EQ(counter + 100, test_controller->internal_counter);
+}
+
+TEST_F(TestControllerManager, update_flags_the_stale_hardware) {
+  auto freshness = std::make_shared<hardware_interface::HardwareFreshness>();
+  size_t arm = 0;
+  ASSERT_EQ(
+    hardware_interface::return_type::OK,
+    freshness->add_component("arm", robot_->joint_names, std::chrono::milliseconds(100), arm));
+  robot_->set_hardware_freshness(freshness);
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_, "test_controller_manager");
+  const auto claimed = freshness->get_joint_component_mask({"joint1"});
+  EXPECT_EQ(hardware_interface::HardwareFreshness::get_component_mask(arm), claimed);
+
+  // never read
+  EXPECT_TRUE(freshness->is_fresh());
+  cm->update();
+  EXPECT_FALSE(freshness->is_fresh(claimed));
+
+  freshness->record_read(arm);
+  cm->update();
+  EXPECT_TRUE(freshness->is_fresh(claimed));
+  EXPECT_TRUE(freshness->is_fresh());
+}
@@ -0,0 +1,236 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <future>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "controller_manager/controller_manager.hpp"
+#include "controller_manager_test_common.hpp"
+#include "./test_controller/test_controller.hpp"
+
+namespace
+{
+std::atomic<bool> count_allocations{false};
+std::atomic<size_t> allocations{0};
+/// Only count the allocations of this thread, all the threads if it has no id
+std::atomic<std::thread::id> counted_thread{std::thread::id()};
+
+void * counted_malloc(std::size_t size)
+{
+  if (count_allocations) {
+    const auto thread = counted_thread.load();
+    if (thread == std::thread::id() || thread == std::this_thread::get_id()) {
+      ++allocations;
+    }
+  }
+  void * ptr = std::malloc(size ? size : 1);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+}  // namespace
+
+void * operator new(std::size_t size)
+{
+  return counted_malloc(size);
+}
+
+void * operator new[](std::size_t size)
+{
+  return counted_malloc(size);
+}
+
+void operator delete(void * ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void * ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void * ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void * ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+TEST_F(TestControllerManager, update_does_not_allocate) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+
+  constexpr size_t kNumControllers = 15u;
+  std::vector<std::shared_ptr<test_controller::TestController>> controllers;
+  std::vector<std::string> start_controllers;
+  for (size_t i = 0; i < kNumControllers; ++i) {
+    controllers.push_back(std::make_shared<test_controller::TestController>());
+    start_controllers.push_back("test_controller_" + std::to_string(i));
+    cm->add_controller(
+      controllers.back(), start_controllers.back(), test_controller::TEST_CONTROLLER_TYPE);
+  }
+
+  auto switch_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    start_controllers, std::vector<std::string>(),
+    STRICT, true, rclcpp::Duration(0, 0));
+  while (switch_future.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready) {
+    cm->update();
+  }
+  ASSERT_EQ(controller_interface::return_type::SUCCESS, switch_future.get());
+
+  // first update after the switch rebuilds the active controllers schedule
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+
+  constexpr size_t kNumUpdates = 1000u;
+  allocations = 0;
+  count_allocations = true;
+  for (size_t i = 0; i < kNumUpdates; ++i) {
+    cm->update();
+  }
+  count_allocations = false;
+
+  EXPECT_EQ(0u, allocations.load()) << "update() should not allocate memory";
+  for (const auto & controller : controllers) {
+    EXPECT_EQ(kNumUpdates + 1u, controller->internal_counter);
+  }
+}
+
+TEST_F(TestControllerManager, schedule_rebuild_does_not_allocate) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+
+  auto test_controller = std::make_shared<test_controller::TestController>();
+  cm->add_controller(
+    test_controller, test_controller::TEST_CONTROLLER_NAME,
+    test_controller::TEST_CONTROLLER_TYPE);
+
+  auto switch_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    std::vector<std::string>{test_controller::TEST_CONTROLLER_NAME}, std::vector<std::string>(),
+    STRICT, true, rclcpp::Duration(0, 0));
+  while (switch_future.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready) {
+    cm->update();
+  }
+  ASSERT_EQ(controller_interface::return_type::SUCCESS, switch_future.get());
+
+  // the schedule is rebuilt in this update, within the capacity reserved at load time
+  allocations = 0;
+  count_allocations = true;
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  count_allocations = false;
+
+  EXPECT_EQ(0u, allocations.load()) << "rebuilding the schedule should not allocate memory";
+  EXPECT_EQ(1u, test_controller->internal_counter);
+}
+
+TEST_F(TestControllerManager, parallel_update_does_not_allocate) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+  cm->set_update_threads(2);
+
+  constexpr size_t kNumControllers = 15u;
+  std::vector<std::shared_ptr<test_controller::TestController>> controllers;
+  std::vector<std::string> start_controllers;
+  for (size_t i = 0; i < kNumControllers; ++i) {
+    controllers.push_back(std::make_shared<test_controller::TestController>());
+    controllers.back()->claimed_resources["position_command"] = {"joint" + std::to_string(i)};
+    start_controllers.push_back("test_controller_" + std::to_string(i));
+    cm->add_controller(
+      controllers.back(), start_controllers.back(), test_controller::TEST_CONTROLLER_TYPE);
+  }
+
+  auto switch_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    start_controllers, std::vector<std::string>(),
+    STRICT, true, rclcpp::Duration(0, 0));
+  while (switch_future.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready) {
+    cm->update();
+  }
+  ASSERT_EQ(controller_interface::return_type::SUCCESS, switch_future.get());
+
+  constexpr size_t kNumUpdates = 1000u;
+  allocations = 0;
+  count_allocations = true;
+  for (size_t i = 0; i < kNumUpdates; ++i) {
+    cm->update();
+  }
+  count_allocations = false;
+
+  EXPECT_EQ(0u, allocations.load()) << "update() with worker threads should not allocate memory";
+  for (const auto & controller : controllers) {
+    EXPECT_EQ(kNumUpdates, controller->internal_counter);
+  }
+}
+
+TEST_F(TestControllerManager, switch_cycle_does_not_allocate) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+  auto test_controller = std::make_shared<test_controller::TestController>();
+  cm->add_controller(
+    test_controller, test_controller::TEST_CONTROLLER_NAME,
+    test_controller::TEST_CONTROLLER_TYPE);
+  const std::vector<std::string> controller_names = {test_controller::TEST_CONTROLLER_NAME};
+
+  // only the update applying the switch is counted, not the thread which requested it
+  auto count_switch_cycle = [&cm]() {
+      allocations = 0;
+      counted_thread = std::this_thread::get_id();
+      count_allocations = true;
+      cm->update();
+      count_allocations = false;
+      counted_thread = std::thread::id();
+      return allocations.load();
+    };
+
+  auto switch_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    controller_names, std::vector<std::string>(), STRICT, true, rclcpp::Duration(0, 0));
+  ASSERT_EQ(
+    std::future_status::timeout, switch_future.wait_for(std::chrono::milliseconds(100)));
+  EXPECT_EQ(0u, count_switch_cycle()) << "starting controllers should not allocate memory";
+  ASSERT_EQ(controller_interface::return_type::SUCCESS, switch_future.get());
+  cm->update();
+  EXPECT_EQ(1u, test_controller->internal_counter);
+
+  switch_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    std::vector<std::string>(), controller_names, STRICT, true, rclcpp::Duration(0, 0));
+  ASSERT_EQ(
+    std::future_status::timeout, switch_future.wait_for(std::chrono::milliseconds(100)));
+  EXPECT_EQ(0u, count_switch_cycle()) << "stopping controllers should not allocate memory";
+  ASSERT_EQ(controller_interface::return_type::SUCCESS, switch_future.get());
+}
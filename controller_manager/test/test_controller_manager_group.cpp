@@ -0,0 +1,68 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "controller_manager/controller_manager_group.hpp"
+#include "controller_manager_test_common.hpp"
+#include "test_robot_hardware/test_robot_hardware.hpp"
+#include "./test_controller/test_controller.hpp"
+
+TEST_F(TestControllerManager, group_steps_all_the_controller_managers) {
+  constexpr size_t kRobotCount = 8;
+  controller_manager::ControllerManagerGroup group(2);
+
+  std::vector<std::shared_ptr<test_robot_hardware::TestRobotHardware>> robots;
+  std::vector<std::shared_ptr<test_controller::TestController>> controllers;
+  for (size_t i = 0; i < kRobotCount; ++i) {
+    robots.push_back(std::make_shared<test_robot_hardware::TestRobotHardware>());
+    robots.back()->init();
+    auto cm = std::make_shared<controller_manager::ControllerManager>(
+      robots.back(), executor_, "controller_manager_" + std::to_string(i), group.get_loader());
+    ASSERT_TRUE(group.add(cm, rclcpp::Time(0, 0)));
+    EXPECT_TRUE(cm->is_stepping());
+
+    // created from the loader shared by the group
+    auto controller = cm->load_controller("test_controller", test_controller::TEST_CONTROLLER_TYPE);
+    ASSERT_NE(nullptr, controller);
+    controllers.push_back(std::static_pointer_cast<test_controller::TestController>(controller));
+    ASSERT_EQ(
+      controller_interface::return_type::SUCCESS,
+      cm->switch_controller({"test_controller"}, {}, STRICT));
+  }
+  EXPECT_FALSE(group.add(group.get_controller_managers()[0], rclcpp::Time(0, 0)));
+
+  const rclcpp::Duration dt(0, 1000000);
+  for (int i = 0; i < 50; ++i) {
+    EXPECT_EQ(controller_interface::return_type::SUCCESS, group.step(dt));
+  }
+  for (size_t i = 0; i < kRobotCount; ++i) {
+    EXPECT_EQ(50u, controllers[i]->internal_counter) << "robot " << i;
+    EXPECT_EQ(
+      rclcpp::Time(0, 50000000).nanoseconds(),
+      group.get_controller_managers()[i]->get_step_time().nanoseconds());
+  }
+
+  // no longer stepped once removed
+  auto removed = group.get_controller_managers()[0];
+  EXPECT_TRUE(group.remove(removed));
+  EXPECT_FALSE(group.remove(removed));
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, group.step(dt));
+  EXPECT_EQ(50u, controllers[0]->internal_counter);
+  EXPECT_EQ(51u, controllers[1]->internal_counter);
+}
@@ -133,6 +133,7 @@ TEST_F(TestControllerManagerSrvs, list_controllers_srv) {
   ASSERT_EQ(
     0u,
     result->controller.size());
+  const auto initial_version = result->version;
 
   auto test_controller = std::make_shared<test_controller::TestController>();
   auto abstract_test_controller = cm_->add_controller(
@@ -146,6 +147,7 @@ TEST_F(TestControllerManagerSrvs, list_controllers_srv) {
   ASSERT_EQ(test_controller::TEST_CONTROLLER_NAME, result->controller[0].name);
   ASSERT_EQ(test_controller::TEST_CONTROLLER_TYPE, result->controller[0].type);
   ASSERT_EQ("inactive", result->controller[0].state);
+  EXPECT_EQ(initial_version + 1, result->version);
 
   cm_->switch_controller(
     {test_controller::TEST_CONTROLLER_NAME}, {},
@@ -157,6 +159,12 @@ TEST_F(TestControllerManagerSrvs, list_controllers_srv) {
     1u,
     result->controller.size());
   ASSERT_EQ("active", result->controller[0].state);
+  ASSERT_EQ(test_controller::TEST_CONTROLLER_NAME, result->controller[0].update_timing.name);
+  ASSERT_EQ(4u, result->cycle_timing.size());
+  EXPECT_EQ("read", result->cycle_timing[0].name);
+  EXPECT_EQ("update", result->cycle_timing[1].name);
+  EXPECT_EQ("manage_switch", result->cycle_timing[2].name);
+  EXPECT_EQ("write", result->cycle_timing[3].name);
 
   cm_->switch_controller(
     {}, {test_controller::TEST_CONTROLLER_NAME},
@@ -274,6 +282,39 @@ TEST_F(TestControllerManagerSrvs, load_controller_srv) {
   ASSERT_TRUE(result->ok);
 }
 
+TEST_F(TestControllerManagerSrvs, load_and_start_controllers_srv) {
+  rclcpp::executors::SingleThreadedExecutor srv_executor;
+  rclcpp::Node::SharedPtr srv_node = std::make_shared<rclcpp::Node>("srv_client");
+  srv_executor.add_node(srv_node);
+  rclcpp::Client<controller_manager_msgs::srv::LoadAndStartControllers>::SharedPtr client =
+    srv_node->create_client<controller_manager_msgs::srv::LoadAndStartControllers>(
+    "test_controller_manager/load_and_start_controllers");
+
+  auto request =
+    std::make_shared<controller_manager_msgs::srv::LoadAndStartControllers::Request>();
+  // without any name
+  request->strictness = controller_manager_msgs::srv::SwitchController::Request::STRICT;
+  auto result = call_service_and_wait(*client, request, srv_executor);
+  ASSERT_FALSE(result->ok) << "There's no controller to load";
+  EXPECT_EQ(0u, cm_->get_loaded_controllers().size());
+
+  request->names = {test_controller::TEST_CONTROLLER_NAME};
+  request->start_asap = true;
+  result = call_service_and_wait(*client, request, srv_executor);
+  ASSERT_FALSE(result->ok) << "There's no param specifying the type for " << request->names[0];
+  EXPECT_EQ(0u, cm_->get_loaded_controllers().size());
+
+  rclcpp::Parameter joint_parameters(std::string(test_controller::TEST_CONTROLLER_NAME) + ".type",
+    test_controller::TEST_CONTROLLER_TYPE);
+  cm_->set_parameter(joint_parameters);
+  result = call_service_and_wait(*client, request, srv_executor, true);
+  ASSERT_TRUE(result->ok);
+  ASSERT_EQ(1u, cm_->get_loaded_controllers().size());
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE,
+    cm_->get_loaded_controllers()[0].c->get_lifecycle_node()->get_current_state().id());
+}
+
 TEST_F(TestControllerManagerSrvs, unload_controller_srv) {
   rclcpp::executors::SingleThreadedExecutor srv_executor;
   rclcpp::Node::SharedPtr srv_node = std::make_shared<rclcpp::Node>("srv_client");
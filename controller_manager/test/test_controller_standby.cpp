@@ -0,0 +1,171 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "controller_manager_test_common.hpp"
+#include "hardware_interface/types/hardware_interface_type_values.hpp"
+#include "lifecycle_msgs/msg/state.hpp"
+
+namespace
+{
+/// Writes its command to joint1 when running, and starts from the command it takes over
+class CommandingController : public test_controller::TestController
+{
+public:
+  CommandingController(hardware_interface::JointHandle handle, double command)
+  : handle(handle), command(command)
+  {
+    claimed_resources = {{"position", {"joint1"}}};
+  }
+
+  controller_interface::return_type update() override
+  {
+    handle.set_value(command);
+    return TestController::update();
+  }
+
+  controller_interface::return_type update_standby(
+    const rclcpp::Time &, const rclcpp::Duration &) override
+  {
+    ++standby_updates;
+    return controller_interface::return_type::SUCCESS;
+  }
+
+  void on_takeover() override
+  {
+    taken_over_command = handle.get_value();
+  }
+
+  hardware_interface::JointHandle handle;
+  double command;
+  size_t standby_updates = 0;
+  double taken_over_command = 0.0;
+};
+
+class TestControllerStandby : public TestControllerManager
+{
+public:
+  void SetUp() override
+  {
+    TestControllerManager::SetUp();
+    cm_ = std::make_shared<controller_manager::ControllerManager>(
+      robot_, executor_, "test_controller_manager");
+    hardware_interface::JointHandle handle("joint1", hardware_interface::HW_IF_POSITION_COMMAND);
+    ASSERT_EQ(hardware_interface::return_type::OK, robot_->get_joint_handle(handle));
+    outgoing_ = std::make_shared<CommandingController>(handle, 1.0);
+    incoming_ = std::make_shared<CommandingController>(handle, 2.0);
+    cm_->add_controller(outgoing_, "outgoing", test_controller::TEST_CONTROLLER_TYPE);
+    cm_->add_controller(incoming_, "incoming", test_controller::TEST_CONTROLLER_TYPE);
+  }
+
+  /// Runs future to completion, updating meanwhile as a real-time loop would
+  template<typename FutureT>
+  controller_interface::return_type update_until_ready(FutureT & future)
+  {
+    while (future.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready) {
+      cm_->update();
+    }
+    return future.get();
+  }
+
+  controller_interface::return_type switch_controllers(
+    const std::vector<std::string> & start_controllers,
+    const std::vector<std::string> & stop_controllers)
+  {
+    auto future = std::async(
+      std::launch::async, &controller_manager::ControllerManager::switch_controller, cm_,
+      start_controllers, stop_controllers, STRICT, true, rclcpp::Duration(0, 0));
+    return update_until_ready(future);
+  }
+
+  controller_interface::return_type set_standby(const std::string & name, bool standby)
+  {
+    auto future = std::async(
+      std::launch::async, &controller_manager::ControllerManager::set_controllers_standby, cm_,
+      std::vector<std::string>{name}, standby);
+    return update_until_ready(future);
+  }
+
+  uint8_t get_state(CommandingController & controller)
+  {
+    return controller.get_lifecycle_node()->get_current_state().id();
+  }
+
+  std::shared_ptr<controller_manager::ControllerManager> cm_;
+  std::shared_ptr<CommandingController> outgoing_;
+  std::shared_ptr<CommandingController> incoming_;
+};
+}  // namespace
+
+TEST_F(TestControllerStandby, promotes_the_standby_controller_from_the_last_commands) {
+  ASSERT_EQ(controller_interface::return_type::SUCCESS, switch_controllers({"outgoing"}, {}));
+  ASSERT_EQ(controller_interface::return_type::SUCCESS, set_standby("incoming", true));
+  EXPECT_EQ(lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE, get_state(*incoming_));
+  // a controller in standby claims nothing, the running one is not in conflict with it
+  const auto running_updates = incoming_->internal_counter;
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_EQ(controller_interface::return_type::SUCCESS, cm_->update());
+  }
+  EXPECT_LE(5u, incoming_->standby_updates);
+  EXPECT_EQ(running_updates, incoming_->internal_counter);
+  EXPECT_EQ(1.0, outgoing_->handle.get_value());
+  auto snapshot = cm_->get_controllers_snapshot();
+  EXPECT_TRUE(snapshot->controllers[1].standby);
+
+  ASSERT_EQ(
+    controller_interface::return_type::SUCCESS, switch_controllers({"incoming"}, {"outgoing"}));
+  EXPECT_EQ(1.0, incoming_->taken_over_command);
+  const auto standby_updates = incoming_->standby_updates;
+  const auto outgoing_updates = outgoing_->internal_counter;
+  ASSERT_EQ(controller_interface::return_type::SUCCESS, cm_->update());
+  EXPECT_EQ(standby_updates, incoming_->standby_updates);
+  EXPECT_EQ(outgoing_updates, outgoing_->internal_counter);
+  EXPECT_EQ(2.0, incoming_->handle.get_value());
+  EXPECT_EQ(lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE, get_state(*outgoing_));
+  snapshot = cm_->get_controllers_snapshot();
+  EXPECT_FALSE(snapshot->controllers[1].standby);
+
+  // stopped, not put back in standby
+  ASSERT_EQ(controller_interface::return_type::SUCCESS, switch_controllers({}, {"incoming"}));
+  EXPECT_EQ(lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE, get_state(*incoming_));
+}
+
+TEST_F(TestControllerStandby, leaves_the_standby_deactivated) {
+  ASSERT_EQ(controller_interface::return_type::SUCCESS, set_standby("incoming", true));
+  const auto standby_updates = incoming_->standby_updates;
+  ASSERT_EQ(controller_interface::return_type::SUCCESS, cm_->update());
+  EXPECT_EQ(standby_updates + 1, incoming_->standby_updates);
+  // still active, so it is not unloaded
+  EXPECT_EQ(controller_interface::return_type::ERROR, cm_->unload_controller("incoming"));
+
+  ASSERT_EQ(controller_interface::return_type::SUCCESS, set_standby("incoming", false));
+  EXPECT_EQ(lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE, get_state(*incoming_));
+  const auto last_standby_updates = incoming_->standby_updates;
+  ASSERT_EQ(controller_interface::return_type::SUCCESS, cm_->update());
+  EXPECT_EQ(last_standby_updates, incoming_->standby_updates);
+}
+
+TEST_F(TestControllerStandby, refuses_running_and_unknown_controllers) {
+  ASSERT_EQ(controller_interface::return_type::SUCCESS, switch_controllers({"outgoing"}, {}));
+  EXPECT_EQ(controller_interface::return_type::ERROR, set_standby("outgoing", true));
+  EXPECT_EQ(controller_interface::return_type::ERROR, set_standby("unknown", true));
+  EXPECT_EQ(lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE, get_state(*outgoing_));
+  ASSERT_EQ(controller_interface::return_type::SUCCESS, cm_->update());
+  EXPECT_EQ(0u, outgoing_->standby_updates);
+}
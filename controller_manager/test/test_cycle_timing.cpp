@@ -0,0 +1,99 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "controller_manager/cycle_timing.hpp"
+
+using controller_manager::ScopedTimingProbe;
+using controller_manager::TimingProbe;
+using std::chrono::nanoseconds;
+
+TEST(TestCycleTiming, no_samples) {
+  TimingProbe probe;
+  const auto statistics = probe.get_statistics();
+  EXPECT_EQ(0u, statistics.count);
+  EXPECT_EQ(0u, statistics.window);
+  EXPECT_EQ(nanoseconds(0), statistics.max);
+}
+
+TEST(TestCycleTiming, statistics_of_recorded_samples) {
+  TimingProbe probe(128);
+  // recorded out of order, the p99 does not depend on the order of the samples
+  for (int64_t sample = 100; sample > 0; --sample) {
+    probe.record(nanoseconds(sample));
+  }
+  const auto statistics = probe.get_statistics();
+  EXPECT_EQ(100u, statistics.count);
+  EXPECT_EQ(100u, statistics.window);
+  EXPECT_EQ(nanoseconds(1), statistics.min);
+  EXPECT_EQ(nanoseconds(50), statistics.mean);
+  EXPECT_EQ(nanoseconds(99), statistics.p99);
+  EXPECT_EQ(nanoseconds(100), statistics.max);
+}
+
+TEST(TestCycleTiming, oldest_samples_are_overwritten) {
+  // rounded up to 8 samples
+  TimingProbe probe(5);
+  for (int64_t sample = 1; sample <= 20; ++sample) {
+    probe.record(nanoseconds(sample));
+  }
+  const auto statistics = probe.get_statistics();
+  EXPECT_EQ(20u, statistics.count);
+  EXPECT_GT(statistics.window, 0u);
+  EXPECT_LE(statistics.window, 8u);
+  EXPECT_EQ(nanoseconds(20), statistics.max);
+  EXPECT_EQ(nanoseconds(20 - statistics.window + 1), statistics.min);
+}
+
+TEST(TestCycleTiming, statistics_while_recording) {
+  TimingProbe probe(64);
+  std::atomic<bool> recording{true};
+  std::thread recorder([&probe, &recording]() {
+      while (recording) {
+        for (int64_t sample = 1; sample <= 10; ++sample) {
+          probe.record(nanoseconds(sample));
+        }
+      }
+    });
+  for (int i = 0; i < 1000; ++i) {
+    const auto statistics = probe.get_statistics();
+    if (statistics.window > 0) {
+      // never aggregates a sample which was not recorded
+      EXPECT_GE(statistics.min, nanoseconds(1));
+      EXPECT_LE(statistics.max, nanoseconds(10));
+      EXPECT_LE(statistics.p99, statistics.max);
+    }
+  }
+  recording = false;
+  recorder.join();
+}
+
+TEST(TestCycleTiming, scoped_probe_records_its_lifetime) {
+  TimingProbe probe;
+  {
+    ScopedTimingProbe scoped_probe(&probe);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  {
+    ScopedTimingProbe null_probe(nullptr);
+  }
+  const auto statistics = probe.get_statistics();
+  EXPECT_EQ(1u, statistics.count);
+  EXPECT_GE(statistics.min, std::chrono::milliseconds(2));
+}
@@ -0,0 +1,275 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "controller_manager/dynamic_joint_state_broadcaster.hpp"
+#include "controller_manager_test_common.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+
+using controller_manager::DynamicJointStateBroadcaster;
+using controller_manager::DynamicJointStateBroadcasterOptions;
+using controller_manager_msgs::msg::InterfaceValues;
+using control_msgs::msg::DynamicJointState;
+using hardware_interface::return_type;
+
+namespace
+{
+class TestDynamicJointStateBroadcaster : public TestControllerManager
+{
+public:
+  void SetUp() override
+  {
+    TestControllerManager::SetUp();
+    node_ = std::make_shared<rclcpp::Node>("test_broadcaster");
+    subscribe("/test_broadcaster");
+  }
+
+  /// Subscribes to the layout and the values published by the node
+  void subscribe(const std::string & node_name)
+  {
+    layout_subscription_ = node_->create_subscription<DynamicJointState>(
+      node_name + "/joint_state_layout", rclcpp::QoS(1).transient_local(),
+      [this](const DynamicJointState & layout) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        layouts_.push_back(layout);
+      });
+    values_subscription_ = node_->create_subscription<InterfaceValues>(
+      node_name + "/joint_state_values", rclcpp::QoS(10),
+      [this](const InterfaceValues & values) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        values_.push_back(values);
+      });
+  }
+
+  hardware_interface::return_type configure(DynamicJointStateBroadcaster & broadcaster)
+  {
+    return broadcaster.configure(
+      *robot_,
+      node_->create_publisher<DynamicJointState>(
+        "~/joint_state_layout", rclcpp::QoS(1).transient_local()),
+      node_->create_publisher<InterfaceValues>("~/joint_state_values", rclcpp::QoS(10)));
+  }
+
+  /// Sets the state value of an interface of joint1
+  void set_joint1_state(size_t interface_index, double value)
+  {
+    *robot_->get_joint_values().get_value_ptr(0, interface_index) = value;
+  }
+
+  /// Captures one snapshot
+  void capture(DynamicJointStateBroadcaster & broadcaster, int64_t time_ns)
+  {
+    for (size_t cycle = 0; cycle < broadcaster.get_options().decimation; ++cycle) {
+      broadcaster.capture(time_ns);
+    }
+  }
+
+  bool wait_for(const std::function<bool()> & condition)
+  {
+    for (int i = 0; i < 500 && !condition(); ++i) {
+      rclcpp::spin_some(node_);
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return condition();
+  }
+
+  /// Waits for the broadcaster to have published count messages and for them to be received
+  bool wait_for_values(const DynamicJointStateBroadcaster & broadcaster, uint64_t count)
+  {
+    return wait_for(
+      [this, &broadcaster, count] {
+        std::lock_guard<std::mutex> guard(mutex_);
+        return broadcaster.get_published_count() == count && values_.size() == count;
+      });
+  }
+
+  std::shared_ptr<rclcpp::Node> node_;
+  rclcpp::Subscription<DynamicJointState>::SharedPtr layout_subscription_;
+  rclcpp::Subscription<InterfaceValues>::SharedPtr values_subscription_;
+  std::mutex mutex_;
+  std::vector<DynamicJointState> layouts_;
+  std::vector<InterfaceValues> values_;
+};
+}  // namespace
+
+TEST_F(TestDynamicJointStateBroadcaster, not_configured) {
+  DynamicJointStateBroadcaster broadcaster;
+  EXPECT_FALSE(broadcaster.is_configured());
+  broadcaster.capture(0);
+  EXPECT_EQ(0u, broadcaster.get_snapshot_count());
+
+  // the layout of the hardware is only known once its registration is frozen
+  test_robot_hardware::TestRobotHardware unfrozen_robot;
+  EXPECT_EQ(
+    return_type::ERROR,
+    broadcaster.configure(
+      unfrozen_robot, node_->create_publisher<DynamicJointState>("~/layout", rclcpp::QoS(1)),
+      node_->create_publisher<InterfaceValues>("~/values", rclcpp::QoS(1))));
+  EXPECT_EQ(return_type::ERROR, broadcaster.configure(*robot_, nullptr, nullptr));
+  EXPECT_FALSE(broadcaster.is_configured());
+
+  DynamicJointStateBroadcasterOptions options;
+  options.decimation = 0;
+  DynamicJointStateBroadcaster undecimated_broadcaster(options);
+  EXPECT_EQ(return_type::ERROR, configure(undecimated_broadcaster));
+
+  ASSERT_EQ(return_type::OK, configure(broadcaster));
+  EXPECT_TRUE(broadcaster.is_configured());
+  EXPECT_EQ(return_type::ERROR, configure(broadcaster));
+}
+
+TEST_F(TestDynamicJointStateBroadcaster, publishes_the_layout_once) {
+  DynamicJointStateBroadcaster broadcaster;
+  ASSERT_EQ(return_type::OK, configure(broadcaster));
+  ASSERT_TRUE(
+    wait_for(
+      [this] {
+        std::lock_guard<std::mutex> guard(mutex_);
+        return !layouts_.empty();
+      }));
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  ASSERT_EQ(1u, layouts_.size());
+  const auto & layout = layouts_[0];
+  EXPECT_EQ(robot_->joint_names, layout.joint_names);
+  ASSERT_EQ(3u, layout.interface_values.size());
+  // the state interfaces only
+  const std::vector<std::string> interface_names = {"position", "velocity", "effort"};
+  for (size_t joint = 0; joint < 3; ++joint) {
+    EXPECT_EQ(interface_names, layout.interface_values[joint].interface_names);
+    EXPECT_EQ(
+      std::vector<double>(
+        {robot_->pos_dflt_values[joint], robot_->vel_dflt_values[joint],
+          robot_->eff_dflt_values[joint]}),
+      layout.interface_values[joint].values);
+  }
+  const auto & value_names = broadcaster.get_value_names();
+  ASSERT_EQ(9u, value_names.size());
+  EXPECT_EQ("joint1/position", value_names[0]);
+  EXPECT_EQ("joint3/effort", value_names[8]);
+}
+
+TEST_F(TestDynamicJointStateBroadcaster, streams_all_the_values_at_the_decimated_rate) {
+  DynamicJointStateBroadcasterOptions options;
+  options.decimation = 3;
+  DynamicJointStateBroadcaster broadcaster(options);
+  ASSERT_EQ(return_type::OK, configure(broadcaster));
+
+  broadcaster.capture(1);
+  EXPECT_EQ(1u, broadcaster.get_snapshot_count());
+  broadcaster.capture(2);
+  broadcaster.capture(3);
+  EXPECT_EQ(1u, broadcaster.get_snapshot_count());
+  ASSERT_TRUE(wait_for_values(broadcaster, 1));
+
+  for (uint64_t snapshot = 2; snapshot <= 4; ++snapshot) {
+    set_joint1_state(0, static_cast<double>(snapshot));
+    capture(broadcaster, static_cast<int64_t>(snapshot) * 1000);
+    ASSERT_TRUE(wait_for_values(broadcaster, snapshot));
+  }
+  EXPECT_EQ(4u, broadcaster.get_keyframe_count());
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  EXPECT_EQ(1, values_[0].stamp.nanoseconds());
+  EXPECT_EQ(1u, values_[0].sequence);
+  EXPECT_EQ(robot_->pos_dflt_values[0], values_[0].values.at(0));
+  for (uint64_t snapshot = 2; snapshot <= 4; ++snapshot) {
+    const auto & values = values_[snapshot - 1];
+    EXPECT_EQ(static_cast<int64_t>(snapshot) * 1000, values.stamp.nanoseconds());
+    EXPECT_EQ(snapshot, values.sequence);
+    EXPECT_TRUE(values.indices.empty());
+    ASSERT_EQ(9u, values.values.size());
+    EXPECT_EQ(static_cast<double>(snapshot), values.values[0]);
+    EXPECT_EQ(robot_->vel_dflt_values[0], values.values[1]);
+  }
+}
+
+TEST_F(TestDynamicJointStateBroadcaster, sends_only_the_changed_values_between_keyframes) {
+  DynamicJointStateBroadcasterOptions options;
+  options.decimation = 1;
+  options.change_threshold = 0.5;
+  options.keyframe_interval = 4;
+  DynamicJointStateBroadcaster broadcaster(options);
+  ASSERT_EQ(return_type::OK, configure(broadcaster));
+  const double position = robot_->pos_dflt_values[0];
+  const double velocity = robot_->vel_dflt_values[0];
+
+  // the first snapshot is a keyframe
+  capture(broadcaster, 1);
+  ASSERT_TRUE(wait_for_values(broadcaster, 1));
+  // below the threshold, not sent
+  set_joint1_state(0, position + 0.3);
+  capture(broadcaster, 2);
+  // the changes add up since the value was last sent
+  set_joint1_state(0, position + 0.6);
+  set_joint1_state(1, velocity - 1.0);
+  capture(broadcaster, 3);
+  ASSERT_TRUE(wait_for_values(broadcaster, 2));
+  capture(broadcaster, 4);
+  ASSERT_TRUE(wait_for_values(broadcaster, 3));
+  EXPECT_EQ(4u, broadcaster.get_snapshot_count());
+  EXPECT_EQ(2u, broadcaster.get_keyframe_count());
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  EXPECT_TRUE(values_[0].indices.empty());
+  EXPECT_EQ(9u, values_[0].values.size());
+
+  EXPECT_EQ(3u, values_[1].sequence);
+  EXPECT_EQ(std::vector<uint32_t>({0, 1}), values_[1].indices);
+  EXPECT_EQ(std::vector<double>({position + 0.6, velocity - 1.0}), values_[1].values);
+
+  EXPECT_EQ(4u, values_[2].sequence);
+  EXPECT_TRUE(values_[2].indices.empty());
+  ASSERT_EQ(9u, values_[2].values.size());
+  EXPECT_EQ(position + 0.6, values_[2].values[0]);
+  EXPECT_EQ(robot_->eff_dflt_values[2], values_[2].values[8]);
+}
+
+TEST_F(TestDynamicJointStateBroadcaster, captures_the_cycles_of_the_controller_manager) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_, "test_controller_manager");
+  EXPECT_EQ(nullptr, cm->get_joint_state_broadcaster());
+  subscribe("/test_controller_manager");
+
+  DynamicJointStateBroadcasterOptions options;
+  options.decimation = 5;
+  auto broadcaster = std::make_shared<DynamicJointStateBroadcaster>(options);
+  ASSERT_EQ(
+    controller_interface::return_type::SUCCESS, cm->set_joint_state_broadcaster(broadcaster));
+  EXPECT_TRUE(broadcaster->is_configured());
+  EXPECT_EQ(broadcaster, cm->get_joint_state_broadcaster());
+
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  }
+  EXPECT_EQ(2u, broadcaster->get_snapshot_count());
+  ASSERT_TRUE(
+    wait_for(
+      [this] {
+        std::lock_guard<std::mutex> guard(mutex_);
+        return !layouts_.empty() && !values_.empty();
+      }));
+
+  ASSERT_EQ(controller_interface::return_type::SUCCESS, cm->set_joint_state_broadcaster(nullptr));
+  cm->update();
+  EXPECT_EQ(2u, broadcaster->get_snapshot_count());
+}
@@ -0,0 +1,256 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "controller_manager/flight_recorder.hpp"
+#include "controller_manager_test_common.hpp"
+
+using controller_manager::FlightRecorder;
+using controller_manager::FlightRecorderOptions;
+using hardware_interface::FlightRecordController;
+using hardware_interface::FlightRecordCycle;
+using hardware_interface::FlightRecordDumpReason;
+using hardware_interface::FlightRecordReader;
+using hardware_interface::return_type;
+
+namespace
+{
+class TestFlightRecorder : public TestControllerManager
+{
+public:
+  void SetUp() override
+  {
+    TestControllerManager::SetUp();
+    path_ = ::testing::TempDir() + "test_flight_recorder_" + std::to_string(getpid()) + ".bin";
+  }
+
+  void TearDown() override
+  {
+    std::remove(path_.c_str());
+    for (const auto & path : written_paths_) {
+      std::remove(path.c_str());
+    }
+  }
+
+  /// Records a cycle with the value of the position of joint1 set to time_ns
+  void record_cycle(FlightRecorder & recorder, int64_t time_ns)
+  {
+    *robot_->get_joint_values().get_value_ptr(0, 0) = static_cast<double>(time_ns);
+    auto cycle = recorder.begin_cycle(time_ns, 1000000);
+    ASSERT_NE(nullptr, cycle);
+    recorder.add_controller(cycle, "controller", time_ns, 0);
+    recorder.end_cycle(cycle);
+  }
+
+  /// Waits for the dump thread to have written dump_count files
+  bool wait_for_dumps(const FlightRecorder & recorder, uint64_t dump_count)
+  {
+    for (int i = 0; i < 500 && recorder.get_dump_count() < dump_count; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    written_paths_.push_back(recorder.get_last_dump_path());
+    return recorder.get_dump_count() == dump_count;
+  }
+
+  std::string path_;
+  std::vector<std::string> written_paths_;
+};
+}  // namespace
+
+TEST_F(TestFlightRecorder, not_configured) {
+  FlightRecorder recorder;
+  EXPECT_FALSE(recorder.is_configured());
+  EXPECT_EQ(nullptr, recorder.begin_cycle(0, 0));
+  EXPECT_EQ("", recorder.dump(FlightRecordDumpReason::REQUESTED, path_));
+
+  // the layout of the hardware is only known once its registration is frozen
+  test_robot_hardware::TestRobotHardware unfrozen_robot;
+  EXPECT_EQ(return_type::ERROR, recorder.configure(unfrozen_robot));
+  EXPECT_FALSE(recorder.is_configured());
+
+  FlightRecorderOptions options;
+  options.cycle_capacity = 0;
+  FlightRecorder empty_recorder(options);
+  EXPECT_EQ(return_type::ERROR, empty_recorder.configure(*robot_));
+}
+
+TEST_F(TestFlightRecorder, keeps_the_latest_cycles_oldest_first) {
+  FlightRecorderOptions options;
+  options.cycle_capacity = 4;
+  FlightRecorder recorder(options);
+  ASSERT_EQ(return_type::OK, recorder.configure(*robot_));
+  ASSERT_TRUE(recorder.is_configured());
+  for (int64_t time_ns = 0; time_ns < 10; ++time_ns) {
+    record_cycle(recorder, time_ns);
+  }
+  EXPECT_EQ(10u, recorder.get_recorded_cycle_count());
+
+  ASSERT_EQ(path_, recorder.dump(FlightRecordDumpReason::REQUESTED, path_));
+  EXPECT_EQ(1u, recorder.get_dump_count());
+  EXPECT_EQ(path_, recorder.get_last_dump_path());
+
+  FlightRecordReader reader;
+  ASSERT_EQ(return_type::OK, reader.open(path_));
+  EXPECT_EQ(
+    static_cast<uint32_t>(FlightRecordDumpReason::REQUESTED), reader.get_header().dump_reason);
+  EXPECT_EQ(6u, reader.get_header().first_cycle_index);
+  ASSERT_EQ(4u, reader.get_cycle_count());
+  const auto & arena = robot_->get_joint_values();
+  for (size_t i = 0; i < reader.get_cycle_count(); ++i) {
+    const int64_t time_ns = 6 + static_cast<int64_t>(i);
+    EXPECT_EQ(time_ns, reader.get_cycle(i).time_ns);
+    EXPECT_EQ(1000000, reader.get_cycle(i).period_ns);
+    EXPECT_EQ(0u, reader.get_cycle(i).flags);
+    EXPECT_EQ(static_cast<double>(time_ns), reader.get_joint_values(i)[arena.get_offset(0, 0)]);
+  }
+
+  // fewer cycles than the capacity
+  FlightRecorder other_recorder(options);
+  ASSERT_EQ(return_type::OK, other_recorder.configure(*robot_));
+  record_cycle(other_recorder, 42);
+  ASSERT_EQ(path_, other_recorder.dump(FlightRecordDumpReason::REQUESTED, path_));
+  ASSERT_EQ(return_type::OK, reader.open(path_));
+  EXPECT_EQ(0u, reader.get_header().first_cycle_index);
+  ASSERT_EQ(1u, reader.get_cycle_count());
+  EXPECT_EQ(42, reader.get_cycle(0).time_ns);
+}
+
+TEST_F(TestFlightRecorder, names_the_values_of_the_hardware) {
+  FlightRecorder recorder;
+  ASSERT_EQ(return_type::OK, recorder.configure(*robot_));
+  record_cycle(recorder, 1);
+  ASSERT_EQ(path_, recorder.dump(FlightRecordDumpReason::REQUESTED, path_));
+
+  FlightRecordReader reader;
+  ASSERT_EQ(return_type::OK, reader.open(path_));
+  EXPECT_EQ(robot_->get_actuator_value_names(), reader.get_actuator_value_names());
+  EXPECT_EQ(robot_->get_joint_value_names(), reader.get_joint_value_names());
+  const auto & joint_names = reader.get_joint_value_names();
+  EXPECT_NE(
+    joint_names.end(), std::find(joint_names.begin(), joint_names.end(), "joint1/position"));
+  EXPECT_NE(
+    joint_names.end(), std::find(joint_names.begin(), joint_names.end(), "joint3/effort_command"));
+}
+
+TEST_F(TestFlightRecorder, records_the_controllers_up_to_the_capacity) {
+  FlightRecorderOptions options;
+  options.controller_capacity = 2;
+  FlightRecorder recorder(options);
+  ASSERT_EQ(return_type::OK, recorder.configure(*robot_));
+  auto cycle = recorder.begin_cycle(1, 1);
+  ASSERT_NE(nullptr, cycle);
+  const std::string long_name(40, 'c');
+  recorder.add_controller(cycle, long_name, 10, FlightRecordController::FAILED);
+  recorder.add_controller(cycle, "second", 20, FlightRecordController::SKIPPED);
+  recorder.add_controller(cycle, "third", 30, 0);
+  cycle->flags |= FlightRecordCycle::FAILED;
+  recorder.end_cycle(cycle);
+  ASSERT_EQ(path_, recorder.dump(FlightRecordDumpReason::REQUESTED, path_));
+
+  FlightRecordReader reader;
+  ASSERT_EQ(return_type::OK, reader.open(path_));
+  ASSERT_EQ(1u, reader.get_cycle_count());
+  EXPECT_EQ(FlightRecordCycle::FAILED, reader.get_cycle(0).flags);
+  ASSERT_EQ(2u, reader.get_cycle(0).controller_count);
+  const auto controllers = reader.get_controllers(0);
+  // truncated
+  EXPECT_EQ(long_name.substr(0, FlightRecordController::NAME_SIZE - 1), controllers[0].name);
+  EXPECT_EQ(10, controllers[0].update_duration_ns);
+  EXPECT_EQ(FlightRecordController::FAILED, controllers[0].flags);
+  EXPECT_STREQ("second", controllers[1].name);
+  EXPECT_EQ(20, controllers[1].update_duration_ns);
+  EXPECT_EQ(FlightRecordController::SKIPPED, controllers[1].flags);
+}
+
+TEST_F(TestFlightRecorder, requested_dumps_are_written_by_the_dump_thread) {
+  FlightRecorderOptions options;
+  options.directory = ::testing::TempDir();
+  options.min_automatic_dump_interval = std::chrono::hours(1);
+  options.poll_period = std::chrono::milliseconds(1);
+  FlightRecorder recorder(options);
+  ASSERT_EQ(return_type::OK, recorder.configure(*robot_));
+  record_cycle(recorder, 1);
+
+  recorder.request_dump(FlightRecordDumpReason::FAULT);
+  ASSERT_TRUE(wait_for_dumps(recorder, 1));
+  const auto fault_path = recorder.get_last_dump_path();
+  EXPECT_EQ(0u, fault_path.find(options.directory));
+  EXPECT_NE(std::string::npos, fault_path.find("_fault.bin"));
+  FlightRecordReader reader;
+  ASSERT_EQ(return_type::OK, reader.open(fault_path));
+  EXPECT_EQ(
+    static_cast<uint32_t>(FlightRecordDumpReason::FAULT), reader.get_header().dump_reason);
+  EXPECT_EQ(1u, reader.get_cycle_count());
+  reader.close();
+
+  // the automatic dumps are rate limited, the requested ones are not
+  recorder.request_dump(FlightRecordDumpReason::OVERRUN);
+  recorder.request_dump(FlightRecordDumpReason::FAULT);
+  recorder.request_dump(FlightRecordDumpReason::REQUESTED);
+  ASSERT_TRUE(wait_for_dumps(recorder, 2));
+  EXPECT_NE(std::string::npos, recorder.get_last_dump_path().find("_requested.bin"));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(2u, recorder.get_dump_count());
+
+  // recording goes on after the dumps
+  record_cycle(recorder, 2);
+  EXPECT_EQ(2u, recorder.get_recorded_cycle_count());
+}
+
+TEST_F(TestFlightRecorder, records_the_cycles_of_the_controller_manager) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_, "test_controller_manager");
+  EXPECT_EQ(nullptr, cm->get_flight_recorder());
+  auto recorder = std::make_shared<FlightRecorder>();
+  ASSERT_EQ(controller_interface::return_type::SUCCESS, cm->set_flight_recorder(recorder));
+  EXPECT_TRUE(recorder->is_configured());
+  EXPECT_EQ(recorder, cm->get_flight_recorder());
+
+  auto test_controller = std::make_shared<test_controller::TestController>();
+  cm->add_controller(test_controller, "test_controller", test_controller::TEST_CONTROLLER_TYPE);
+  // the switch is applied by an update
+  std::thread rt_thread([&cm] {
+      for (int i = 0; i < 1000; ++i) {
+        cm->update();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    });
+  ASSERT_EQ(
+    controller_interface::return_type::SUCCESS,
+    cm->switch_controller({"test_controller"}, {}, STRICT));
+  rt_thread.join();
+  EXPECT_LT(0u, test_controller->internal_counter);
+
+  ASSERT_EQ(path_, recorder->dump(FlightRecordDumpReason::REQUESTED, path_));
+  FlightRecordReader reader;
+  ASSERT_EQ(return_type::OK, reader.open(path_));
+  ASSERT_EQ(1000u, reader.get_cycle_count());
+  // the controller is recorded from the cycle which started it on
+  const auto & last_cycle = reader.get_cycle(reader.get_cycle_count() - 1);
+  ASSERT_EQ(1u, last_cycle.controller_count);
+  EXPECT_STREQ("test_controller", reader.get_controllers(reader.get_cycle_count() - 1)[0].name);
+  EXPECT_EQ(0u, reader.get_controllers(reader.get_cycle_count() - 1)[0].flags);
+  EXPECT_LE(
+    reader.get_controllers(reader.get_cycle_count() - 1)[0].update_duration_ns,
+    last_cycle.update_duration_ns);
+}
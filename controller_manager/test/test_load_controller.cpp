@@ -14,6 +14,8 @@
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <chrono>
+#include <future>
 #include <memory>
 #include <string>
 #include <vector>
@@ -22,6 +24,7 @@
 
 #include "controller_interface/controller_interface.hpp"
 
+#include "controller_manager/controller_loader.hpp"
 #include "controller_manager/controller_manager.hpp"
 
 #include "controller_manager_msgs/srv/switch_controller.hpp"
@@ -54,6 +57,19 @@ TEST_F(TestControllerManager, load1_known_controller)
     abstract_test_controller.c->get_lifecycle_node()->get_current_state().id());
 }
 
+TEST_F(TestControllerManager, load_warmed_up_controller)
+{
+  controller_manager::ControllerManager cm(robot_, executor_, "test_controller_manager");
+  cm.set_parameter(rclcpp::Parameter("test_controller_01.warm_up_updates", 2));
+  // the library is bound before the controller is created from it
+  ASSERT_NO_THROW(cm.load_controller("test_controller_01", test_controller::TEST_CONTROLLER_TYPE));
+  ASSERT_EQ(1u, cm.get_loaded_controllers().size());
+  EXPECT_EQ(2u, cm.get_loaded_controllers()[0].warm_up_updates);
+
+  controller_manager::ControllerLoader loader;
+  EXPECT_FALSE(loader.bind_library_now("unknown_controller_type"));
+}
+
 TEST_F(TestControllerManager, load2_known_controller)
 {
   controller_manager::ControllerManager cm(robot_, executor_, "test_controller_manager");
@@ -88,6 +104,95 @@ TEST_F(TestControllerManager, load2_known_controller)
     abstract_test_controller2.c->get_lifecycle_node()->get_current_state().id());
 }
 
+TEST_F(TestControllerManager, load_controllers_in_parallel)
+{
+  controller_manager::ControllerManager cm(robot_, executor_, "test_controller_manager");
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm.preload_controller_libraries());
+  for (const auto & controller_name : {"test_controller1", "test_controller2", "test_controller3"}) {
+    cm.set_parameter(
+      rclcpp::Parameter(
+        std::string(controller_name) + ".type",
+        test_controller::TEST_CONTROLLER_TYPE));
+  }
+  cm.set_parameter(rclcpp::Parameter("unknown_controller.type", "unknown_controller_type"));
+  ASSERT_NO_THROW(cm.load_controller("test_controller3"));
+
+  EXPECT_TRUE(cm.load_controllers({}).empty());
+
+  // unknown types, undefined types and already loaded controllers are skipped
+  const auto controllers = cm.load_controllers(
+    {"test_controller1", "unknown_controller", "untyped_controller", "test_controller2",
+      "test_controller1", "test_controller3"});
+  ASSERT_EQ(6u, controllers.size());
+  EXPECT_NE(nullptr, controllers[0]);
+  EXPECT_EQ(nullptr, controllers[1]);
+  EXPECT_EQ(nullptr, controllers[2]);
+  EXPECT_NE(nullptr, controllers[3]);
+  EXPECT_EQ(nullptr, controllers[4]);
+  EXPECT_EQ(nullptr, controllers[5]);
+
+  // added in the order they were requested, and configured
+  const auto loaded_controllers = cm.get_loaded_controllers();
+  ASSERT_EQ(3u, loaded_controllers.size());
+  EXPECT_EQ("test_controller3", loaded_controllers[0].info.name);
+  EXPECT_EQ("test_controller1", loaded_controllers[1].info.name);
+  EXPECT_EQ("test_controller2", loaded_controllers[2].info.name);
+  EXPECT_EQ(controllers[0], loaded_controllers[1].c);
+  EXPECT_EQ(controllers[3], loaded_controllers[2].c);
+  for (const auto & controller : loaded_controllers) {
+    EXPECT_EQ(
+      lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE,
+      controller.c->get_lifecycle_node()->get_current_state().id());
+  }
+}
+
+TEST_F(TestControllerManager, load_and_start_controllers)
+{
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+  for (const auto & controller_name : {"test_controller1", "test_controller2", "test_controller3"}) {
+    cm->set_parameter(
+      rclcpp::Parameter(
+        std::string(controller_name) + ".type",
+        test_controller::TEST_CONTROLLER_TYPE));
+  }
+
+  // nothing is started if a controller fails to load
+  EXPECT_EQ(
+    controller_interface::return_type::ERROR,
+    cm->load_and_start_controllers(
+      {"test_controller1", "untyped_controller"}, STRICT, true, rclcpp::Duration(0, 0)));
+  ASSERT_EQ(1u, cm->get_loaded_controllers().size());
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE,
+    cm->get_loaded_controllers()[0].c->get_lifecycle_node()->get_current_state().id());
+
+  // the controllers loaded are started in a single update cycle
+  auto load_and_start_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::load_and_start_controllers, cm,
+    std::vector<std::string>{"test_controller2", "untyped_controller", "test_controller3"},
+    BEST_EFFORT, true, rclcpp::Duration(0, 0));
+  while (load_and_start_future.wait_for(std::chrono::milliseconds(10)) !=
+    std::future_status::ready)
+  {
+    EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  }
+  EXPECT_EQ(controller_interface::return_type::ERROR, load_and_start_future.get());
+  const auto loaded_controllers = cm->get_loaded_controllers();
+  ASSERT_EQ(3u, loaded_controllers.size());
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE,
+    loaded_controllers[0].c->get_lifecycle_node()->get_current_state().id());
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE,
+    loaded_controllers[1].c->get_lifecycle_node()->get_current_state().id());
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE,
+    loaded_controllers[2].c->get_lifecycle_node()->get_current_state().id());
+}
+
 TEST_F(TestControllerManager, update)
 {
   controller_manager::ControllerManager cm(robot_, executor_, "test_controller_manager");
@@ -0,0 +1,248 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "controller_manager/controller_manager.hpp"
+#include "controller_manager/realtime_control_loop.hpp"
+#include "controller_manager_test_common.hpp"
+#include "./test_controller/test_controller.hpp"
+#include "hardware_interface/shared_memory_state_exporter.hpp"
+#include "hardware_interface/sync_event_source.hpp"
+
+using controller_manager::RealtimeControlLoop;
+using controller_manager::RealtimeControlLoopOptions;
+
+namespace
+{
+class SlowController : public test_controller::TestController
+{
+public:
+  controller_interface::return_type update() override
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(3));
+    return TestController::update();
+  }
+};
+}  // namespace
+
+TEST_F(TestControllerManager, control_loop_runs_at_period) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+  auto test_controller = std::make_shared<test_controller::TestController>();
+  cm->add_controller(
+    test_controller, test_controller::TEST_CONTROLLER_NAME,
+    test_controller::TEST_CONTROLLER_TYPE);
+
+  RealtimeControlLoopOptions options;
+  options.period = std::chrono::milliseconds(2);
+  options.stack_prefault_size = 64 * 1024;
+  RealtimeControlLoop control_loop(robot_, cm, options);
+  ASSERT_TRUE(control_loop.start());
+  EXPECT_TRUE(control_loop.is_running());
+  EXPECT_FALSE(control_loop.start()) << "the loop is already running";
+
+  // switching is served from this thread, while the loop updates the controller manager
+  EXPECT_EQ(
+    controller_interface::return_type::SUCCESS,
+    cm->switch_controller(
+      {test_controller::TEST_CONTROLLER_NAME}, {}, STRICT, true, rclcpp::Duration(0, 0)));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  control_loop.stop();
+  EXPECT_FALSE(control_loop.is_running());
+
+  const auto statistics = control_loop.get_statistics();
+  EXPECT_EQ(options.period, statistics.period);
+  // loose bounds, the test may not run on a real-time system
+  EXPECT_GT(statistics.cycles, 10u);
+  EXPECT_LE(statistics.cycles, 55u);
+  EXPECT_EQ(0u, statistics.errors);
+  EXPECT_GE(statistics.max_jitter, statistics.last_jitter);
+  EXPECT_GE(statistics.max_cycle_duration, statistics.last_cycle_duration);
+  EXPECT_GT(test_controller->internal_counter, 0u);
+  EXPECT_LT(test_controller->internal_counter, statistics.cycles);
+
+#ifdef CONTROLLER_MANAGER_CYCLE_TIMING
+  auto & cycle_timing = cm->get_cycle_timing();
+  EXPECT_EQ(statistics.cycles, cycle_timing.read.get_statistics().count);
+  EXPECT_EQ(statistics.cycles, cycle_timing.update.get_statistics().count);
+  EXPECT_EQ(statistics.cycles, cycle_timing.write.get_statistics().count);
+  EXPECT_EQ(1u, cycle_timing.manage_switch.get_statistics().count);
+  EXPECT_EQ(statistics.overruns, cycle_timing.overruns.load());
+  const auto controllers = cm->get_loaded_controllers();
+  ASSERT_EQ(1u, controllers.size());
+  const auto update_timing = controllers[0].update_timing->get_statistics();
+  EXPECT_EQ(test_controller->internal_counter, update_timing.count);
+  EXPECT_LE(update_timing.max, cycle_timing.update.get_statistics().max);
+#endif
+}
+
+TEST_F(TestControllerManager, control_loop_skips_overrun_cycles) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+  auto slow_controller = std::make_shared<SlowController>();
+  cm->add_controller(slow_controller, "slow_controller", test_controller::TEST_CONTROLLER_TYPE);
+
+  RealtimeControlLoopOptions options;
+  options.period = std::chrono::milliseconds(1);
+  RealtimeControlLoop control_loop(robot_, cm, options);
+  ASSERT_TRUE(control_loop.start());
+  EXPECT_EQ(
+    controller_interface::return_type::SUCCESS,
+    cm->switch_controller({"slow_controller"}, {}, STRICT, true, rclcpp::Duration(0, 0)));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  control_loop.stop();
+
+  const auto statistics = control_loop.get_statistics();
+  EXPECT_GT(statistics.overruns, 0u);
+  EXPECT_GE(statistics.max_cycle_duration, std::chrono::milliseconds(3));
+  // the missed cycles are skipped, not run back to back to catch up
+  EXPECT_LE(statistics.cycles, 50u / 3u + 2u);
+}
+
+TEST_F(TestControllerManager, control_loop_exports_state) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+
+  RealtimeControlLoopOptions options;
+  options.period = std::chrono::milliseconds(1);
+  options.state_export_segment = "/test_control_loop_state_" + std::to_string(getpid());
+  RealtimeControlLoop control_loop(robot_, cm, options);
+  ASSERT_TRUE(control_loop.start());
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  hardware_interface::SharedMemoryStateReader reader;
+  ASSERT_EQ(hardware_interface::return_type::OK, reader.open(options.state_export_segment));
+  ASSERT_FALSE(reader.get_joint_value_names().empty());
+  EXPECT_EQ("joint1/position", reader.get_joint_value_names().front());
+  std::vector<double> actuator_values;
+  std::vector<double> joint_values;
+  EXPECT_GT(reader.read(actuator_values, joint_values), 0u);
+  control_loop.stop();
+
+  // the segment is removed once the loop stopped
+  hardware_interface::SharedMemoryStateReader late_reader;
+  EXPECT_EQ(
+    hardware_interface::return_type::ERROR, late_reader.open(options.state_export_segment));
+}
+
+TEST_F(TestControllerManager, control_loop_enforces_limits_before_write) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+
+  RealtimeControlLoopOptions options;
+  options.period = std::chrono::milliseconds(1);
+  std::atomic<uint64_t> enforce_count{0};
+  std::atomic<int64_t> max_period_ns{0};
+  options.enforce_limits = [&enforce_count, &max_period_ns](const rclcpp::Duration & period) {
+      ++enforce_count;
+      max_period_ns = std::max(max_period_ns.load(), period.nanoseconds());
+    };
+  RealtimeControlLoop control_loop(robot_, cm, options);
+  ASSERT_TRUE(control_loop.start());
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  control_loop.stop();
+
+  EXPECT_EQ(control_loop.get_statistics().cycles, enforce_count.load());
+  EXPECT_GT(enforce_count.load(), 0u);
+  EXPECT_GE(max_period_ns.load(), options.period.count());
+}
+
+TEST_F(TestControllerManager, control_loop_reports_each_cycle) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+
+  RealtimeControlLoopOptions options;
+  options.period = std::chrono::milliseconds(1);
+  std::atomic<uint64_t> cycle_count{0};
+  std::atomic<int64_t> max_cycle_duration_ns{0};
+  options.on_cycle_end = [&cycle_count, &max_cycle_duration_ns](
+    std::chrono::nanoseconds, std::chrono::nanoseconds cycle_duration) {
+      ++cycle_count;
+      max_cycle_duration_ns = std::max(max_cycle_duration_ns.load(), cycle_duration.count());
+    };
+  RealtimeControlLoop control_loop(robot_, cm, options);
+  ASSERT_TRUE(control_loop.start());
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  control_loop.stop();
+
+  const auto statistics = control_loop.get_statistics();
+  EXPECT_GT(cycle_count.load(), 0u);
+  EXPECT_EQ(statistics.cycles, cycle_count.load());
+  EXPECT_EQ(statistics.max_cycle_duration.count(), max_cycle_duration_ns.load());
+}
+
+TEST_F(TestControllerManager, control_loop_rejects_invalid_period) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+  RealtimeControlLoopOptions options;
+  options.period = std::chrono::nanoseconds(0);
+  RealtimeControlLoop control_loop(robot_, cm, options);
+  EXPECT_FALSE(control_loop.start());
+  EXPECT_FALSE(control_loop.is_running());
+}
+
+TEST_F(TestControllerManager, control_loop_locks_to_the_sync_events) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+  auto sync_event_source = std::make_shared<hardware_interface::SyncEventSource>();
+  robot_->set_sync_event_source(sync_event_source);
+
+  // the bus cycle, on its own clock
+  const auto period = std::chrono::milliseconds(2);
+  std::atomic<bool> running{true};
+  std::thread bus([&running, &sync_event_source, period] {
+      auto event = std::chrono::steady_clock::now();
+      while (running) {
+        event += period;
+        std::this_thread::sleep_until(event);
+        sync_event_source->notify(event.time_since_epoch());
+      }
+    });
+
+  RealtimeControlLoopOptions options;
+  options.period = period;
+  options.sync.offset = std::chrono::microseconds(300);
+  // loose bounds, the test may not run on a real-time system
+  options.sync.lock_window = std::chrono::microseconds(500);
+  RealtimeControlLoop control_loop(robot_, cm, options);
+  ASSERT_TRUE(control_loop.start());
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  control_loop.stop();
+  running = false;
+  bus.join();
+  robot_->set_sync_event_source(nullptr);
+
+  const auto statistics = control_loop.get_statistics();
+  EXPECT_GT(statistics.cycles, 10u);
+  EXPECT_TRUE(statistics.synchronized);
+  EXPECT_LE(std::abs(statistics.sync_phase_error.count()), 500000);
+}
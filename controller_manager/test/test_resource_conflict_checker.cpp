@@ -0,0 +1,90 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "controller_manager/resource_conflict_checker.hpp"
+
+using controller_manager::ResourceConflictChecker;
+
+namespace
+{
+hardware_interface::ControllerInfo make_info(
+  const std::string & name, const std::map<std::string, std::vector<std::string>> & resources)
+{
+  hardware_interface::ControllerInfo info;
+  info.name = name;
+  info.resources = resources;
+  return info;
+}
+}  // namespace
+
+TEST(TestResourceConflictChecker, claims_are_interned_once) {
+  ResourceConflictChecker checker;
+  const auto arm = checker.get_claim_mask(
+    make_info("arm", {{"position", {"joint1", "joint2"}}, {"velocity", {"joint1"}}}));
+  EXPECT_EQ(3u, checker.get_claim_count());
+  const auto gripper = checker.get_claim_mask(make_info("gripper", {{"position", {"joint2"}}}));
+  EXPECT_EQ(3u, checker.get_claim_count());
+  ASSERT_EQ(1u, gripper.size());
+  EXPECT_NE(0u, arm[0] & gripper[0]);
+
+  EXPECT_TRUE(checker.get_claim_mask(make_info("any", {})).empty());
+  EXPECT_EQ("joint2/position", checker.get_claim_name(1));
+}
+
+TEST(TestResourceConflictChecker, conflicting_claims_are_found) {
+  ResourceConflictChecker checker;
+  const auto arm = checker.get_claim_mask(make_info("arm", {{"position", {"joint1", "joint2"}}}));
+  const auto head = checker.get_claim_mask(make_info("head", {{"position", {"joint3"}}}));
+  const auto arm_velocity = checker.get_claim_mask(
+    make_info("arm_velocity", {{"velocity", {"joint1", "joint2"}}}));
+  const auto gripper = checker.get_claim_mask(make_info("gripper", {{"position", {"joint2"}}}));
+
+  size_t first, second, claim;
+  EXPECT_FALSE(ResourceConflictChecker::find_conflict({}, first, second, claim));
+  // different interfaces of the same resources do not conflict
+  EXPECT_FALSE(
+    ResourceConflictChecker::find_conflict({&arm, &head, &arm_velocity}, first, second, claim));
+  ASSERT_TRUE(
+    ResourceConflictChecker::find_conflict(
+      {&arm, &head, &arm_velocity, &gripper}, first, second, claim));
+  EXPECT_EQ(0u, first);
+  EXPECT_EQ(3u, second);
+  EXPECT_EQ("joint2/position", checker.get_claim_name(claim));
+}
+
+TEST(TestResourceConflictChecker, many_claims) {
+  ResourceConflictChecker checker;
+  std::vector<std::string> joints;
+  for (int i = 0; i < 150; ++i) {
+    joints.push_back("joint" + std::to_string(i));
+  }
+  const auto all = checker.get_claim_mask(make_info("all", {{"effort", joints}}));
+  EXPECT_EQ(3u, all.size());
+  const auto last = checker.get_claim_mask(make_info("last", {{"effort", {"joint149"}}}));
+  const auto other = checker.get_claim_mask(make_info("other", {{"position", {"joint149"}}}));
+  EXPECT_EQ(3u, other.size()) << "new claims are interned after the existing ones";
+
+  size_t first, second, claim;
+  EXPECT_FALSE(ResourceConflictChecker::find_conflict({&other, &all}, first, second, claim));
+  ASSERT_TRUE(ResourceConflictChecker::find_conflict({&other, &all, &last}, first, second, claim));
+  EXPECT_EQ(1u, first);
+  EXPECT_EQ(2u, second);
+  EXPECT_EQ(149u, claim);
+}
@@ -0,0 +1,304 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "controller_manager/resource_manager.hpp"
+
+using controller_manager::ResourceManager;
+using hardware_interface::HardwareInfo;
+using hardware_interface::return_type;
+using hardware_interface::status;
+
+namespace
+{
+/// Shared by the fake components of a test, to slow down or block their startup.
+struct Startup
+{
+  std::chrono::milliseconds configure_time{0};
+  return_type configure_result = return_type::OK;
+  std::atomic<size_t> configured{0};
+  std::atomic<size_t> stopped{0};
+
+  /// While blocked, the components wait in configure until they are released.
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool blocked = false;
+
+  return_type configure()
+  {
+    std::this_thread::sleep_for(configure_time);
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this] {return !blocked;});
+    ++configured;
+    return configure_result;
+  }
+
+  void release()
+  {
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+      blocked = false;
+    }
+    cv.notify_all();
+  }
+};
+
+class FakeActuator : public hardware_interface::ActuatorHardwareInterface
+{
+public:
+  explicit FakeActuator(Startup & startup)
+  : startup_(startup) {}
+
+  return_type configure(const HardwareInfo &) override {return startup_.configure();}
+  return_type start() override {return return_type::OK;}
+  return_type stop() override {++startup_.stopped; return return_type::OK;}
+  status get_status() const override {return status::UNKNOWN;}
+  return_type read_joint(std::shared_ptr<hardware_interface::components::Joint>) const override
+  {
+    return return_type::OK;
+  }
+  return_type write_joint(const std::shared_ptr<hardware_interface::components::Joint>) override
+  {
+    return return_type::OK;
+  }
+
+private:
+  Startup & startup_;
+};
+
+class FakeSensor : public hardware_interface::SensorHardwareInterface
+{
+public:
+  explicit FakeSensor(Startup & startup)
+  : startup_(startup) {}
+
+  return_type configure(const HardwareInfo &) override {return startup_.configure();}
+  return_type start() override {return return_type::OK;}
+  return_type stop() override {++startup_.stopped; return return_type::OK;}
+  status get_status() const override {return status::UNKNOWN;}
+  return_type read_sensors(
+    const std::vector<std::shared_ptr<hardware_interface::components::Sensor>> &) const override
+  {
+    return return_type::OK;
+  }
+
+private:
+  Startup & startup_;
+};
+
+HardwareInfo make_info(const std::string & name, const std::string & type)
+{
+  HardwareInfo info;
+  info.name = name;
+  info.type = type;
+  info.hardware_class_type = "fake/" + type;
+  return info;
+}
+}  // namespace
+
+TEST(TestResourceManager, starts_components_in_parallel)
+{
+  Startup startup;
+  startup.configure_time = std::chrono::milliseconds(200);
+  ResourceManager manager;
+  for (const auto & name : {"gripper", "arm", "conveyor"}) {
+    manager.add_actuator(make_info(name, "actuator"), std::make_unique<FakeActuator>(startup));
+  }
+  manager.add_sensor(make_info("camera", "sensor"), std::make_unique<FakeSensor>(startup));
+  ASSERT_EQ(manager.get_hardware_count(), 4u);
+  EXPECT_EQ(manager.get_actuators().size(), 3u);
+  EXPECT_EQ(manager.get_sensors().size(), 1u);
+
+  const auto begin = std::chrono::steady_clock::now();
+  ASSERT_EQ(manager.configure_and_start(std::chrono::seconds(10)), return_type::OK);
+  // the slowest component, not the sum of the four
+  EXPECT_LT(std::chrono::steady_clock::now() - begin, std::chrono::milliseconds(600));
+
+  const auto results = manager.get_startup_results();
+  ASSERT_EQ(results.size(), 4u);
+  EXPECT_EQ(results[0].name, "gripper");
+  EXPECT_EQ(results[3].name, "camera");
+  for (const auto & result : results) {
+    EXPECT_EQ(result.configure_result, return_type::OK);
+    EXPECT_EQ(result.start_result, return_type::OK);
+    EXPECT_FALSE(result.timed_out);
+    EXPECT_GE(result.duration, std::chrono::milliseconds(200));
+  }
+
+  EXPECT_EQ(manager.stop(), return_type::OK);
+  EXPECT_EQ(startup.stopped, 4u);
+}
+
+TEST(TestResourceManager, reports_failed_and_timed_out_components)
+{
+  Startup failing;
+  failing.configure_result = return_type::ERROR;
+  Startup hanging;
+  hanging.blocked = true;
+  Startup working;
+
+  ResourceManager manager;
+  manager.add_actuator(make_info("failing", "actuator"), std::make_unique<FakeActuator>(failing));
+  manager.add_actuator(make_info("hanging", "actuator"), std::make_unique<FakeActuator>(hanging));
+  manager.add_sensor(make_info("working", "sensor"), std::make_unique<FakeSensor>(working));
+
+  EXPECT_EQ(manager.configure_and_start(std::chrono::milliseconds(100)), return_type::ERROR);
+  auto results = manager.get_startup_results();
+  EXPECT_EQ(results[0].configure_result, return_type::ERROR);
+  EXPECT_EQ(results[0].start_result, return_type::ERROR);
+  EXPECT_FALSE(results[0].timed_out);
+  EXPECT_TRUE(results[1].timed_out);
+  EXPECT_EQ(results[1].duration, std::chrono::milliseconds(100));
+  EXPECT_EQ(results[2].start_result, return_type::OK);
+
+  // the hanging component is neither restarted nor stopped until it is done
+  EXPECT_EQ(manager.configure_and_start(std::chrono::milliseconds(100)), return_type::ERROR);
+  EXPECT_EQ(manager.stop(), return_type::ERROR);
+  EXPECT_EQ(working.stopped, 1u);
+  EXPECT_EQ(hanging.stopped, 0u);
+
+  hanging.release();
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (manager.get_startup_results()[1].start_result != return_type::OK &&
+    std::chrono::steady_clock::now() < deadline)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  results = manager.get_startup_results();
+  EXPECT_EQ(results[1].start_result, return_type::OK);
+  EXPECT_TRUE(results[1].timed_out);
+  EXPECT_EQ(manager.stop(), return_type::OK);
+  EXPECT_EQ(hanging.stopped, 1u);
+}
+
+TEST(TestResourceManager, load_hardware_requires_available_classes)
+{
+  ResourceManager manager;
+  std::vector<HardwareInfo> infos;
+  infos.push_back(make_info("gripper", "actuator"));
+  infos.push_back(make_info("conveyor", "belt"));
+  EXPECT_EQ(manager.load_hardware(infos), return_type::ERROR);
+  EXPECT_EQ(manager.get_hardware_count(), 0u);
+  EXPECT_EQ(manager.configure_and_start(std::chrono::milliseconds(10)), return_type::OK);
+}
+
+TEST(TestResourceManager, tracks_the_freshness_of_the_components)
+{
+  Startup startup;
+  ResourceManager manager;
+  auto arm = make_info("arm", "actuator");
+  arm.hardware_parameters["staleness_threshold_ms"] = "20";
+  hardware_interface::components::ComponentInfo joint;
+  joint.name = "joint1";
+  arm.joints.push_back(joint);
+  manager.add_actuator(arm, std::make_unique<FakeActuator>(startup));
+  auto camera = make_info("camera", "sensor");
+  camera.hardware_parameters["staleness_threshold_ms"] = "often";
+  manager.add_sensor(camera, std::make_unique<FakeSensor>(startup));
+
+  const auto & freshness = manager.get_hardware_freshness();
+  ASSERT_NE(freshness, nullptr);
+  ASSERT_EQ(freshness->get_component_count(), 2u);
+  EXPECT_EQ(freshness->get_component_name(0), "arm");
+  EXPECT_EQ(freshness->get_staleness_threshold(0), std::chrono::milliseconds(20));
+  // an invalid threshold is no threshold
+  EXPECT_EQ(freshness->get_staleness_threshold(1), std::chrono::nanoseconds(0));
+  EXPECT_EQ(
+    freshness->get_joint_component_mask({"joint1"}),
+    hardware_interface::HardwareFreshness::get_component_mask(0));
+
+  EXPECT_EQ(freshness->get_last_read_time_ns(0), 0);
+  ASSERT_EQ(manager.get_actuators()[0]->read_joint(nullptr), return_type::OK);
+  EXPECT_NE(freshness->get_last_read_time_ns(0), 0);
+  EXPECT_TRUE(freshness->is_fresh(freshness->update()));
+}
+
+TEST(TestResourceManager, shares_the_clock_domains_of_the_components)
+{
+  Startup startup;
+  ResourceManager manager;
+  hardware_interface::components::ComponentInfo joint;
+  auto arm = make_info("arm", "actuator");
+  arm.hardware_parameters["clock_domain"] = "ethercat_dc";
+  joint.name = "joint1";
+  arm.joints.push_back(joint);
+  manager.add_actuator(arm, std::make_unique<FakeActuator>(startup));
+  auto gripper = make_info("gripper", "actuator");
+  gripper.hardware_parameters["clock_domain"] = "ethercat_dc";
+  joint.name = "finger";
+  gripper.joints.push_back(joint);
+  manager.add_actuator(gripper, std::make_unique<FakeActuator>(startup));
+  manager.add_sensor(make_info("camera", "sensor"), std::make_unique<FakeSensor>(startup));
+
+  const auto & clock_domains = manager.get_clock_domains();
+  ASSERT_NE(clock_domains, nullptr);
+  ASSERT_EQ(clock_domains->get_domain_count(), 1u);
+  EXPECT_EQ(clock_domains->get_domain_name(0), "ethercat_dc");
+  size_t domain = 1;
+  ASSERT_EQ(clock_domains->find_joint_domain("finger", domain), return_type::OK);
+  EXPECT_EQ(domain, 0u);
+  // stamped in steady time
+  EXPECT_EQ(clock_domains->find_joint_domain("camera", domain), return_type::ERROR);
+}
+
+TEST(TestResourceManager, reloads_only_the_changed_components)
+{
+  Startup gripper_startup;
+  Startup arm_startup;
+  Startup camera_startup;
+  ResourceManager manager;
+  std::vector<HardwareInfo> infos = {
+    make_info("gripper", "actuator"), make_info("arm", "actuator"), make_info("camera", "sensor")};
+  manager.add_actuator(infos[0], std::make_unique<FakeActuator>(gripper_startup));
+  manager.add_actuator(infos[1], std::make_unique<FakeActuator>(arm_startup));
+  manager.add_sensor(infos[2], std::make_unique<FakeSensor>(camera_startup));
+  ASSERT_EQ(manager.configure_and_start(std::chrono::seconds(10)), return_type::OK);
+
+  infos[1].hardware_parameters["max_velocity"] = "0.5";
+  ASSERT_EQ(manager.reload_hardware(infos, std::chrono::seconds(10)), return_type::OK);
+  EXPECT_EQ(arm_startup.stopped, 1u);
+  EXPECT_EQ(arm_startup.configured, 2u);
+  EXPECT_EQ(gripper_startup.stopped, 0u);
+  EXPECT_EQ(gripper_startup.configured, 1u);
+  EXPECT_EQ(camera_startup.configured, 1u);
+  EXPECT_EQ(manager.get_startup_results()[1].start_result, return_type::OK);
+
+  // the same description again is a no-op
+  ASSERT_EQ(manager.reload_hardware(infos, std::chrono::seconds(10)), return_type::OK);
+  EXPECT_EQ(arm_startup.configured, 2u);
+
+  // removing a hardware or changing its class needs a restart, nothing is reloaded
+  auto removed = infos;
+  removed.pop_back();
+  removed[0].hardware_parameters["max_effort"] = "10";
+  EXPECT_EQ(manager.reload_hardware(removed, std::chrono::seconds(10)), return_type::ERROR);
+  auto reclassed = infos;
+  reclassed[2].hardware_class_type = "fake/depth_camera";
+  EXPECT_EQ(manager.reload_hardware(reclassed, std::chrono::seconds(10)), return_type::ERROR);
+  EXPECT_EQ(gripper_startup.configured, 1u);
+  EXPECT_EQ(camera_startup.stopped, 0u);
+
+  EXPECT_EQ(manager.stop(), return_type::OK);
+  EXPECT_EQ(arm_startup.stopped, 2u);
+}
@@ -0,0 +1,97 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+
+#include "controller_manager/sync_phase_lock.hpp"
+
+using controller_manager::SyncPhaseLock;
+using controller_manager::SyncPhaseLockOptions;
+using std::chrono::nanoseconds;
+
+namespace
+{
+constexpr int64_t kPeriodNs = 1000000;
+/// The events are 200 ns per period slower than the loop clock
+constexpr int64_t kEventPeriodNs = kPeriodNs + 200;
+constexpr int64_t kFirstEventNs = 1000000000;
+
+/// The latest event at a steady time, as polled by the loop
+nanoseconds latest_event(int64_t now_ns)
+{
+  return nanoseconds(kFirstEventNs + (now_ns - kFirstEventNs) / kEventPeriodNs * kEventPeriodNs);
+}
+}  // namespace
+
+TEST(TestSyncPhaseLock, locks_the_deadlines_to_drifting_events) {
+  SyncPhaseLockOptions options;
+  options.offset = std::chrono::microseconds(-100);
+  SyncPhaseLock phase_lock(nanoseconds(kPeriodNs), options);
+
+  int64_t deadline_ns = kFirstEventNs + 370000;
+  // the phase is aligned in one step on the first event
+  deadline_ns += phase_lock.next_period(nanoseconds(deadline_ns), latest_event(deadline_ns))
+    .count();
+  EXPECT_EQ(kFirstEventNs + kPeriodNs + options.offset.count(), deadline_ns);
+  EXPECT_FALSE(phase_lock.is_locked());
+
+  for (int cycle = 0; cycle < 500; ++cycle) {
+    deadline_ns += phase_lock.next_period(nanoseconds(deadline_ns), latest_event(deadline_ns))
+      .count();
+  }
+  EXPECT_TRUE(phase_lock.is_locked());
+  EXPECT_LE(std::abs(phase_lock.get_phase_error().count()), 10);
+  EXPECT_NEAR(kEventPeriodNs - kPeriodNs, phase_lock.get_period_correction().count(), 10);
+}
+
+TEST(TestSyncPhaseLock, holds_the_rate_over_missing_events) {
+  SyncPhaseLockOptions options;
+  options.holdover_cycles = 3;
+  SyncPhaseLock phase_lock(nanoseconds(kPeriodNs), options);
+  int64_t deadline_ns = kFirstEventNs;
+  nanoseconds last_event(0);
+  for (int cycle = 0; cycle < 500; ++cycle) {
+    last_event = latest_event(deadline_ns);
+    deadline_ns += phase_lock.next_period(nanoseconds(deadline_ns), last_event).count();
+  }
+  ASSERT_TRUE(phase_lock.is_locked());
+  const auto correction = phase_lock.get_period_correction();
+
+  // the events stop
+  for (unsigned int cycle = 0; cycle < options.holdover_cycles; ++cycle) {
+    EXPECT_EQ(
+      nanoseconds(kPeriodNs) + correction, phase_lock.next_period(
+        nanoseconds(deadline_ns), last_event));
+    EXPECT_TRUE(phase_lock.is_locked());
+  }
+  EXPECT_EQ(
+    nanoseconds(kPeriodNs) + correction,
+    phase_lock.next_period(nanoseconds(deadline_ns), last_event));
+  EXPECT_FALSE(phase_lock.is_locked());
+
+  // and come back with another phase, aligned again in one step
+  const nanoseconds event(deadline_ns - 250000);
+  EXPECT_EQ(
+    nanoseconds(kPeriodNs - 250000), phase_lock.next_period(nanoseconds(deadline_ns), event));
+  EXPECT_EQ(nanoseconds(250000), phase_lock.get_phase_error());
+
+  phase_lock.reset();
+  EXPECT_EQ(nanoseconds(0), phase_lock.get_period_correction());
+  EXPECT_EQ(
+    nanoseconds(kPeriodNs), phase_lock.next_period(nanoseconds(deadline_ns), nanoseconds(0)));
+}
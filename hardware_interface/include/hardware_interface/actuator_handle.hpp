@@ -36,6 +36,8 @@ public:
   }
 };
 
+using BoundActuatorHandle = BoundHandle<ActuatorHandle>;
+
 }  // namespace hardware_interface
 
 #endif  // HARDWARE_INTERFACE__ACTUATOR_HANDLE_HPP_
@@ -16,10 +16,15 @@
 #define HARDWARE_INTERFACE__ACTUATOR_HARDWARE_HPP_
 
 #include <memory>
+#include <vector>
 
+#include "hardware_interface/clock_domain_map.hpp"
+#include "hardware_interface/controller_info.hpp"
+#include "hardware_interface/hardware_freshness.hpp"
 #include "hardware_interface/hardware_info.hpp"
 #include "hardware_interface/types/hardware_interface_return_values.hpp"
 #include "hardware_interface/types/hardware_interface_status_values.hpp"
+#include "hardware_interface/types/hardware_interface_switch_state_values.hpp"
 #include "hardware_interface/visibility_control.h"
 
 namespace hardware_interface
@@ -48,12 +53,48 @@ public:
 
   status get_status() const;
 
+  /// Record the successful reads of the component in a freshness tracker.
+  /**
+   * Called before the component is read. Once started, the component is then reported
+   * status::TIMED_OUT while its data is stale.
+   * \param[in] freshness The tracker, null to stop recording.
+   * \param[in] component The index of the component in the tracker.
+   */
+  void set_freshness(std::shared_ptr<HardwareFreshness> freshness, size_t component);
+
+  /// Feed the clock domain of the component with its pairs of device and steady times.
+  /**
+   * Called before the component is read, the pairs are then taken after each successful read.
+   * \param[in] clock_domains The domains, null to stop feeding.
+   * \param[in] domain The index of the domain of the component.
+   */
+  void set_clock_domain(std::shared_ptr<ClockDomainMap> clock_domains, size_t domain);
+
   return_type read_joint(std::shared_ptr<components::Joint> joint);
 
   return_type write_joint(const std::shared_ptr<components::Joint> joint);
 
+  return_type prepare_mode_switch(
+    const std::vector<ControllerInfo> & start_list,
+    const std::vector<ControllerInfo> & stop_list);
+
+  return_type perform_mode_switch(
+    const std::vector<ControllerInfo> & start_list,
+    const std::vector<ControllerInfo> & stop_list);
+
+  switch_state get_mode_switch_state() const;
+
+  switch_state get_mode_switch_state(const ControllerInfo & controller) const;
+
 private:
+  /// Records a successful read in the freshness tracker and the clock domain, returns ret.
+  return_type record_read(return_type ret);
+
   std::unique_ptr<ActuatorHardwareInterface> impl_;
+  std::shared_ptr<HardwareFreshness> freshness_;
+  size_t freshness_component_ = 0;
+  std::shared_ptr<ClockDomainMap> clock_domains_;
+  size_t clock_domain_ = 0;
 };
 
 }  // namespace hardware_interface
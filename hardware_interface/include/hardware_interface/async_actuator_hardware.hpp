@@ -0,0 +1,172 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__ASYNC_ACTUATOR_HARDWARE_HPP_
+#define HARDWARE_INTERFACE__ASYNC_ACTUATOR_HARDWARE_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "hardware_interface/actuator_hardware_interface.hpp"
+#include "hardware_interface/components/joint.hpp"
+#include "hardware_interface/controller_info.hpp"
+#include "hardware_interface/hardware_info.hpp"
+#include "hardware_interface/triple_buffer.hpp"
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+#include "hardware_interface/types/hardware_interface_status_values.hpp"
+#include "hardware_interface/types/hardware_interface_switch_state_values.hpp"
+#include "hardware_interface/visibility_control.h"
+
+namespace hardware_interface
+{
+
+/**
+  * \brief Run the blocking I/O of an actuator driver on its own thread, at its own rate.
+  * The driver's read_joint and write_joint are called by an I/O thread on a private joint, while
+  * read_joint and write_joint of this adapter only exchange the latest state and command with that
+  * thread through wait-free triple buffers, so the real-time loop never waits for the bus.
+  * The state is stale once the driver did not provide a new one for longer than the timeout, e.g.
+  * because its I/O fails or hangs, get_status() then reports status::TIMED_OUT and read_joint
+  * returns return_type::ERROR.
+  * The mode switch functions are forwarded to the driver and run concurrently with its I/O.
+  */
+class AsyncActuatorHardware : public ActuatorHardwareInterface
+{
+public:
+  /**
+   * \param driver the actuator driver doing the blocking I/O.
+   * \param period period of the I/O thread.
+   * \param timeout age after which the state of the driver is stale.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  AsyncActuatorHardware(
+    std::unique_ptr<ActuatorHardwareInterface> driver, std::chrono::nanoseconds period,
+    std::chrono::nanoseconds timeout);
+
+  /// Stops the I/O thread, without stopping the driver.
+  HARDWARE_INTERFACE_PUBLIC
+  ~AsyncActuatorHardware() override;
+
+  AsyncActuatorHardware(const AsyncActuatorHardware &) = delete;
+  AsyncActuatorHardware & operator=(const AsyncActuatorHardware &) = delete;
+
+  /**
+   * \brief Configure the driver and the joint it is read and written through.
+   *
+   * \param actuator_info structure with data from URDF, with exactly one joint.
+   * \return return_type::OK if the driver is configured, return_type::ERROR otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type configure(const HardwareInfo & actuator_info) override;
+
+  /**
+   * \brief Start the driver, then the I/O thread.
+   *
+   * \return return_type::OK if the driver started, return_type::ERROR otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type start() override;
+
+  /**
+   * \brief Stop the I/O thread, then the driver.
+   *
+   * \return the return value of the driver's stop.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type stop() override;
+
+  /**
+   * \brief Get the status of the adapter.
+   *
+   * \return status::TIMED_OUT if started and the state is stale, the status of the adapter
+   * otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  status get_status() const override;
+
+  /**
+   * \brief Set the latest state read by the I/O thread on the joint, without blocking.
+   *
+   * \param joint joint where the state is stored.
+   * \return return_type::ERROR if not configured or the state is stale, the return value of the
+   * joint's set_state otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type read_joint(std::shared_ptr<components::Joint> joint) const override;
+
+  /**
+   * \brief Hand the command of the joint to the I/O thread, without blocking.
+   * The I/O thread writes the driver once a first command was handed over.
+   *
+   * \param joint the joint the command is taken from.
+   * \return return_type::ERROR if not configured, the return value of the joint's get_command
+   * otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type write_joint(const std::shared_ptr<components::Joint> joint) override;
+
+  HARDWARE_INTERFACE_PUBLIC
+  return_type prepare_mode_switch(
+    const std::vector<ControllerInfo> & start_list,
+    const std::vector<ControllerInfo> & stop_list) override;
+
+  HARDWARE_INTERFACE_PUBLIC
+  return_type perform_mode_switch(
+    const std::vector<ControllerInfo> & start_list,
+    const std::vector<ControllerInfo> & stop_list) override;
+
+  HARDWARE_INTERFACE_PUBLIC
+  switch_state get_mode_switch_state() const override;
+
+  HARDWARE_INTERFACE_PUBLIC
+  switch_state get_mode_switch_state(const ControllerInfo & controller) const override;
+
+  /**
+   * \brief Get the number of I/O cycles in which the driver failed to read or write.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  uint64_t get_io_error_count() const;
+
+private:
+  void stop_io_thread();
+  void io_loop();
+  bool is_state_stale() const;
+
+  std::unique_ptr<ActuatorHardwareInterface> driver_;
+  std::chrono::nanoseconds period_;
+  std::chrono::nanoseconds timeout_;
+  /// The joint the driver is read and written through, only used by the I/O thread once started
+  std::shared_ptr<components::Joint> io_joint_;
+  std::unique_ptr<TripleBuffer<std::vector<double>>> state_buffer_;
+  std::unique_ptr<TripleBuffer<std::vector<double>>> command_buffer_;
+
+  std::thread io_thread_;
+  std::mutex io_mutex_;
+  std::condition_variable io_cv_;
+  bool io_running_ = false;
+
+  std::atomic<status> status_{status::UNKNOWN};
+  /// Steady clock time of the latest state, or of the start before the first state
+  std::atomic<int64_t> state_stamp_ns_{0};
+  std::atomic<uint64_t> io_error_count_{0};
+};
+
+}  // namespace hardware_interface
+#endif  // HARDWARE_INTERFACE__ASYNC_ACTUATOR_HARDWARE_HPP_
@@ -0,0 +1,62 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__BOUND_HANDLE_HPP_
+#define HARDWARE_INTERFACE__BOUND_HANDLE_HPP_
+
+namespace hardware_interface
+{
+template<class HandleType>
+class Handle;
+
+/// A handle bound to the storage of its value, for the real-time loop.
+/**
+ * Obtained from Handle::bind(), which checks once that the handle was retrieved from a hardware.
+ * A bound handle is only the pointer to the value, trivially copyable, and its accessors are
+ * inline and unchecked: no names, branch nor exception on the access path. The handle it was bound
+ * from remains for the configuration, e.g. to look the interface up by name.
+ */
+template<class HandleType>
+class BoundHandle
+{
+public:
+  double get_value() const
+  {
+    return *value_ptr_;
+  }
+
+  void set_value(double value) const
+  {
+    *value_ptr_ = value;
+  }
+
+  double * get_value_ptr() const
+  {
+    return value_ptr_;
+  }
+
+private:
+  friend class Handle<HandleType>;
+
+  explicit BoundHandle(double * value_ptr)
+  : value_ptr_(value_ptr)
+  {
+  }
+
+  double * value_ptr_;
+};
+
+}  // namespace hardware_interface
+
+#endif  // HARDWARE_INTERFACE__BOUND_HANDLE_HPP_
@@ -0,0 +1,181 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__CLOCK_DOMAIN_MAP_HPP_
+#define HARDWARE_INTERFACE__CLOCK_DOMAIN_MAP_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+#include "hardware_interface/visibility_control.h"
+
+namespace hardware_interface
+{
+
+/**
+  * \brief Convert the acquisition stamps of the hardware from their device clocks to the steady
+  * clock of the control loop.
+  * The hardware stamps its states in the time base of its device, e.g. an EtherCAT distributed
+  * clock or the PTP clock of a NIC, see components::Joint::get_state_stamp(). Each device clock
+  * is a domain, shared by all the hardware components on that clock. The components feed their
+  * domain with pairs of device and steady times, e.g. the device time of a frame and the steady
+  * time it was received at. The pairs are kept by intervals of the device clock, only the one
+  * received the fastest in each interval, and the domain estimates the mapping between the two
+  * clocks from the last WINDOW_SIZE intervals: the drift is the least-squares slope of those
+  * pairs, the offset is taken from the fastest of them. The jitter of the transport is then
+  * filtered out of the mapping, only its smallest latency remains in the offset.
+  * Estimators then compute the age of a sample as now minus to_steady(stamp), rather than
+  * assuming it was sampled at the start of the cycle.
+  *
+  * The domains are added before the hardware is started. add_sample(), to_steady() and the
+  * getters of the estimate neither block nor allocate, so they are called from the real-time
+  * threads, concurrently: the estimate is published under a sequence lock.
+  */
+class ClockDomainMap
+{
+public:
+  static constexpr size_t MAX_DOMAINS = 16;
+  /// Intervals the mapping is estimated from, per domain
+  static constexpr size_t WINDOW_SIZE = 32;
+
+  /**
+   * \param sample_interval interval of the device clock in which only the fastest pair is kept,
+   * the window then spans WINDOW_SIZE of them.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  explicit ClockDomainMap(
+    std::chrono::nanoseconds sample_interval = std::chrono::milliseconds(10));
+
+  ClockDomainMap(const ClockDomainMap &) = delete;
+  ClockDomainMap & operator=(const ClockDomainMap &) = delete;
+
+  /// Add a domain, or the joints of one more component to an existing domain of that name.
+  /**
+   * \param[in] name The name of the domain, e.g. "ethercat_dc".
+   * \param[in] joint_names The joints and sensors stamped in this domain.
+   * \param[out] domain The index of the domain.
+   * \return The return code, one of `OK` or `ERROR` if MAX_DOMAINS domains were already added.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type add_domain(
+    const std::string & name, const std::vector<std::string> & joint_names, size_t & domain);
+
+  HARDWARE_INTERFACE_PUBLIC
+  size_t get_domain_count() const;
+
+  HARDWARE_INTERFACE_PUBLIC
+  const std::string & get_domain_name(size_t domain) const;
+
+  /// Find the domain a joint or a sensor is stamped in, not real-time safe.
+  /**
+   * \return The return code, one of `OK` or `ERROR` if the joint is in no domain, its stamps
+   * are then steady times.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type find_joint_domain(const std::string & joint_name, size_t & domain) const;
+
+  /// Feed a domain with a pair of device and steady times, real-time safe.
+  /**
+   * \param[in] domain The index of the domain.
+   * \param[in] device_time A time of the device clock.
+   * \param[in] steady_time The steady time at which device_time was observed, e.g. received.
+   * \return true if the pair was taken, false if its device time is not after the one of the
+   * previous pair, or if the domain is being fed concurrently; the pair is then dropped.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  bool add_sample(
+    size_t domain, std::chrono::nanoseconds device_time, std::chrono::nanoseconds steady_time);
+
+  /// Whether the mapping of a domain is estimated, from two pairs at least.
+  HARDWARE_INTERFACE_PUBLIC
+  bool is_synchronized(size_t domain) const;
+
+  /// Convert a time of a device clock to the steady clock, real-time safe.
+  /**
+   * \param[in] domain The index of the domain.
+   * \param[in] device_time A time of the device clock, e.g. an acquisition stamp.
+   * \param[out] steady_time The corresponding steady time.
+   * \return The return code, one of `OK` or `ERROR` if the domain is not synchronized.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type to_steady(
+    size_t domain, std::chrono::nanoseconds device_time,
+    std::chrono::nanoseconds & steady_time) const;
+
+  /// Get the steady minus the device time of the latest pair, without its transport latency.
+  HARDWARE_INTERFACE_PUBLIC
+  std::chrono::nanoseconds get_offset(size_t domain) const;
+
+  /// Get the rate of the steady clock relative to the device clock minus one, 1e-6 for 1 ppm.
+  HARDWARE_INTERFACE_PUBLIC
+  double get_drift(size_t domain) const;
+
+  /// Forget the pairs of a domain, e.g. when its device clock jumped, real-time safe.
+  HARDWARE_INTERFACE_PUBLIC
+  void reset(size_t domain);
+
+private:
+  struct Estimate
+  {
+    int64_t device_ns;
+    int64_t steady_ns;
+    double rate;
+  };
+
+  struct Domain
+  {
+    std::string name;
+    std::vector<std::string> joint_names;
+
+    /// Held by the thread feeding the domain, the others drop their pair
+    std::atomic_flag feeding = ATOMIC_FLAG_INIT;
+    /// The fastest pair of each interval
+    std::array<int64_t, WINDOW_SIZE> device_ns;
+    std::array<int64_t, WINDOW_SIZE> steady_ns;
+    size_t sample_count = 0;
+    /// Index of the interval of the latest pair in the window
+    size_t latest = 0;
+    /// Device time the latest interval started at
+    int64_t interval_start_ns = 0;
+    /// Device time of the latest pair taken, to refuse the pairs going back in time
+    int64_t last_device_ns = 0;
+
+    /// The estimate, published under a sequence lock, odd while being written
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<int64_t> reference_device_ns{0};
+    std::atomic<int64_t> reference_steady_ns{0};
+    std::atomic<double> rate{1.0};
+    std::atomic<bool> synchronized{false};
+  };
+
+  /// Fits the mapping to the pairs of the window
+  void fit(Domain & domain);
+  void publish(Domain & domain, const Estimate & estimate);
+  Estimate load(const Domain & domain) const;
+
+  int64_t sample_interval_ns_;
+  std::array<Domain, MAX_DOMAINS> domains_;
+  std::atomic<size_t> domain_count_{0};
+  std::mutex add_mutex_;
+};
+
+}  // namespace hardware_interface
+#endif  // HARDWARE_INTERFACE__CLOCK_DOMAIN_MAP_HPP_
@@ -21,6 +21,8 @@
 
 #include "hardware_interface/components/component_info.hpp"
 #include "hardware_interface/hardware_info.hpp"
+#include "hardware_interface/typed_parameters.hpp"
+#include "hardware_interface/urdf_document.hpp"
 #include "hardware_interface/visibility_control.h"
 
 namespace hardware_interface
@@ -36,5 +38,42 @@ namespace hardware_interface
 HARDWARE_INTERFACE_PUBLIC
 std::vector<HardwareInfo> parse_control_resources_from_urdf(const std::string & urdf);
 
+/**
+  * \brief Search an already parsed URDF for information about the control resources.
+  *
+  * \param urdf robot's URDF, that may be shared with the other parsers
+  * \return vector filled with information about robot's control resources
+  * \throws std::runtime_error if a robot attribute or tag is not found
+  */
+HARDWARE_INTERFACE_PUBLIC
+std::vector<HardwareInfo> parse_control_resources_from_urdf(const URDFDocument & urdf);
+
+/**
+  * \brief Search an already parsed URDF for the control resources, and convert the parameters of
+  * the hardware classes with a schema to their declared types.
+  *
+  * \param urdf robot's URDF, that may be shared with the other parsers
+  * \param schemas schemas of the parameters by hardware class, the parameters of the other
+  * classes are left as text only
+  * \return vector filled with information about robot's control resources
+  * \throws std::runtime_error if a robot attribute or tag is not found, or if a parameter does
+  * not match the schema of its hardware class
+  */
+HARDWARE_INTERFACE_PUBLIC
+std::vector<HardwareInfo> parse_control_resources_from_urdf(
+  const URDFDocument & urdf,
+  const std::unordered_map<std::string, HardwareParameterSchema> & schemas);
+
+/**
+  * \brief Convert the parameters of a hardware and its joints and sensors to the types declared
+  * by a schema, e.g. after loading the hardware from a HardwareDescriptionCache.
+  *
+  * \param schema schema of the parameters of the hardware class
+  * \param hardware hardware whose typed parameters are filled
+  * \throws std::runtime_error if a required parameter is missing or a value is invalid
+  */
+HARDWARE_INTERFACE_PUBLIC
+void parse_typed_parameters(const HardwareParameterSchema & schema, HardwareInfo & hardware);
+
 }  // namespace hardware_interface
 #endif  // HARDWARE_INTERFACE__COMPONENT_PARSER_HPP_
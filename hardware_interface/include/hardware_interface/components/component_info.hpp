@@ -19,6 +19,8 @@
 #include <unordered_map>
 #include <vector>
 
+#include "hardware_interface/typed_parameters.hpp"
+
 namespace hardware_interface
 {
 namespace components
@@ -56,6 +58,11 @@ struct ComponentInfo
    * \brief (optional) key-value pairs of components parameters.
    */
   std::unordered_map<std::string, std::string> parameters;
+  /**
+   * \brief (optional) values of the parameters declared by the schema of the hardware class,
+   * converted when the description is parsed.
+   */
+  TypedParameters typed_parameters;
 };
 
 }  // namespace components
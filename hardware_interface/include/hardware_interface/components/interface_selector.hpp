@@ -0,0 +1,64 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__COMPONENTS__INTERFACE_SELECTOR_HPP_
+#define HARDWARE_INTERFACE__COMPONENTS__INTERFACE_SELECTOR_HPP_
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace hardware_interface
+{
+namespace components
+{
+
+/**
+ * \brief Interfaces of a component resolved once to the indices of their values, so that values
+ * can be get and set in the hot loop without comparing strings.
+ * A selector is resolved against the command or the state interfaces of one component, and is
+ * only meaningful for that list of interfaces.
+ */
+class InterfaceSelector
+{
+public:
+  InterfaceSelector() = default;
+
+  explicit InterfaceSelector(std::vector<size_t> indices)
+  : indices_(std::move(indices))
+  {
+  }
+
+  const std::vector<size_t> & get_indices() const
+  {
+    return indices_;
+  }
+
+  size_t size() const
+  {
+    return indices_.size();
+  }
+
+  bool empty() const
+  {
+    return indices_.empty();
+  }
+
+private:
+  std::vector<size_t> indices_;
+};
+
+}  // namespace components
+}  // namespace hardware_interface
+#endif  // HARDWARE_INTERFACE__COMPONENTS__INTERFACE_SELECTOR_HPP_
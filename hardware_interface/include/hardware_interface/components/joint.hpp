@@ -15,10 +15,14 @@
 #ifndef HARDWARE_INTERFACE__COMPONENTS__JOINT_HPP_
 #define HARDWARE_INTERFACE__COMPONENTS__JOINT_HPP_
 
+#include <chrono>
 #include <string>
 #include <vector>
 
 #include "hardware_interface/components/component_info.hpp"
+#include "hardware_interface/components/interface_selector.hpp"
+#include "hardware_interface/interface_type_id.hpp"
+#include "hardware_interface/span.hpp"
 #include "hardware_interface/types/hardware_interface_return_values.hpp"
 #include "hardware_interface/visibility_control.h"
 
@@ -71,6 +75,24 @@ public:
   virtual
   std::vector<std::string> get_state_interfaces() const;
 
+  /**
+   * \brief Provide the interned ids of the command interfaces configured for the joint.
+   *
+   * \return id list with command interfaces, in the order of get_command_interfaces().
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  std::vector<InterfaceTypeId> get_command_interface_ids() const;
+
+  /**
+   * \brief Provide the interned ids of the state interfaces configured for the joint.
+   *
+   * \return id list with state interfaces, in the order of get_state_interfaces().
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  std::vector<InterfaceTypeId> get_state_interface_ids() const;
+
   /**
    * \brief Get command list from the joint. This function is used in the write function of the
    * actuator or system hardware. The parameters command and interfaces have the same order,
@@ -195,10 +217,143 @@ public:
   virtual
   return_type set_state(const std::vector<double> & state);
 
+  /**
+   * \brief Resolve command interfaces of the joint once, to get and set commands with the
+   * selector afterwards.
+   *
+   * \param selector resolved command interfaces.
+   * \param interfaces list of command interfaces to resolve.
+   * \return return_type::INTERFACE_NOT_FOUND if one of provided interfaces is not defined for the
+   * joint; return return_type::INTERFACE_NOT_PROVIDED if the list of interfaces is empty;
+   * return_type::OK otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  return_type get_command_interface_selector(
+    InterfaceSelector & selector, const std::vector<std::string> & interfaces) const;
+
+  /**
+   * \brief Resolve state interfaces of the joint once, to get and set states with the selector
+   * afterwards.
+   *
+   * \param selector resolved state interfaces.
+   * \param interfaces list of state interfaces to resolve.
+   * \return return_type::INTERFACE_NOT_FOUND if one of provided interfaces is not defined for the
+   * joint; return return_type::INTERFACE_NOT_PROVIDED if the list of interfaces is empty;
+   * return_type::OK otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  return_type get_state_interface_selector(
+    InterfaceSelector & selector, const std::vector<std::string> & interfaces) const;
+
+  /**
+   * \brief Resolve command interfaces of the joint by interned id, comparing integers only.
+   *
+   * \param selector resolved command interfaces.
+   * \param interfaces list of command interface ids to resolve, e.g. HW_IF_POSITION_ID.
+   * \return return_type::INTERFACE_NOT_FOUND if one of provided interfaces is not defined for the
+   * joint; return return_type::INTERFACE_NOT_PROVIDED if the list of interfaces is empty;
+   * return_type::OK otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  return_type get_command_interface_selector(
+    InterfaceSelector & selector, const std::vector<InterfaceTypeId> & interfaces) const;
+
+  /**
+   * \brief Resolve state interfaces of the joint by interned id, comparing integers only.
+   *
+   * \param selector resolved state interfaces.
+   * \param interfaces list of state interface ids to resolve, e.g. HW_IF_POSITION_ID.
+   * \return return_type::INTERFACE_NOT_FOUND if one of provided interfaces is not defined for the
+   * joint; return return_type::INTERFACE_NOT_PROVIDED if the list of interfaces is empty;
+   * return_type::OK otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  return_type get_state_interface_selector(
+    InterfaceSelector & selector, const std::vector<InterfaceTypeId> & interfaces) const;
+
+  /**
+   * \brief Get commands of the interfaces resolved in the selector, without comparing strings or
+   * allocating.
+   *
+   * \param command output for the commands, same size as the selector.
+   * \param selector command interfaces resolved by get_command_interface_selector().
+   * \return return_type::INTERFACE_VALUE_SIZE_NOT_EQUAL if command and selector do not have the
+   * same length; return_type::INTERFACE_NOT_FOUND if the selector was not resolved for this joint;
+   * return return_type::INTERFACE_NOT_PROVIDED if the selector is empty; return_type::OK otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  return_type get_command(Span<double> command, const InterfaceSelector & selector) const;
+
+  /**
+   * \brief Set commands of the interfaces resolved in the selector, without comparing strings.
+   *
+   * \param command commands to set, same size as the selector.
+   * \param selector command interfaces resolved by get_command_interface_selector().
+   * \return return_type::INTERFACE_VALUE_SIZE_NOT_EQUAL if command and selector do not have the
+   * same length; return_type::INTERFACE_NOT_FOUND if the selector was not resolved for this joint;
+   * return return_type::INTERFACE_NOT_PROVIDED if the selector is empty; return_type::OK otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  return_type set_command(Span<const double> command, const InterfaceSelector & selector);
+
+  /**
+   * \brief Get states of the interfaces resolved in the selector, without comparing strings or
+   * allocating.
+   *
+   * \param state output for the states, same size as the selector.
+   * \param selector state interfaces resolved by get_state_interface_selector().
+   * \return return_type::INTERFACE_VALUE_SIZE_NOT_EQUAL if state and selector do not have the
+   * same length; return_type::INTERFACE_NOT_FOUND if the selector was not resolved for this joint;
+   * return return_type::INTERFACE_NOT_PROVIDED if the selector is empty; return_type::OK otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  return_type get_state(Span<double> state, const InterfaceSelector & selector) const;
+
+  /**
+   * \brief Set states of the interfaces resolved in the selector, without comparing strings.
+   *
+   * \param state states to set, same size as the selector.
+   * \param selector state interfaces resolved by get_state_interface_selector().
+   * \return return_type::INTERFACE_VALUE_SIZE_NOT_EQUAL if state and selector do not have the
+   * same length; return_type::INTERFACE_NOT_FOUND if the selector was not resolved for this joint;
+   * return return_type::INTERFACE_NOT_PROVIDED if the selector is empty; return_type::OK otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  return_type set_state(Span<const double> state, const InterfaceSelector & selector);
+
+  /**
+   * \brief Set the acquisition time of the states, by the hardware reading them. The time is in
+   * the clock of the hardware, converted to the steady clock by the ClockDomainMap of the
+   * hardware if it has one, a steady time otherwise.
+   *
+   * \param stamp acquisition time of the states.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  void set_state_stamp(std::chrono::nanoseconds stamp);
+
+  /**
+   * \brief Acquisition time of the states, zero if the hardware does not stamp them.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  std::chrono::nanoseconds get_state_stamp() const;
+
 protected:
   ComponentInfo info_;
+  /// Interned info_.command_interfaces and info_.state_interfaces, to be kept in sync by derived
+  /// classes changing the interfaces
+  std::vector<InterfaceTypeId> command_interface_ids_;
+  std::vector<InterfaceTypeId> state_interface_ids_;
   std::vector<double> commands_;
   std::vector<double> states_;
+  std::chrono::nanoseconds state_stamp_{0};
 };
 
 }  // namespace components
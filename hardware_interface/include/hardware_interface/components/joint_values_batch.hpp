@@ -0,0 +1,116 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef HARDWARE_INTERFACE__COMPONENTS__JOINT_VALUES_BATCH_HPP_
+#define HARDWARE_INTERFACE__COMPONENTS__JOINT_VALUES_BATCH_HPP_
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "hardware_interface/span.hpp"
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+#include "hardware_interface/visibility_control.h"
+
+namespace hardware_interface
+{
+namespace components
+{
+
+/**
+ * \brief Values of one kind (states or commands) of a group of joints sharing the same interfaces,
+ * stored as a structure of arrays: the values of an interface for all joints are contiguous
+ * (e.g., all positions, then all velocities) and ordered as the joints.
+ * The whole batch is one contiguous block, so a hardware driver can copy or convert a complete
+ * process-data image at once instead of accessing each joint separately.
+ */
+class JointValuesBatch
+{
+public:
+  HARDWARE_INTERFACE_PUBLIC
+  JointValuesBatch() = default;
+
+  /**
+   * \brief Allocate the values for joint_count joints, all initialized to zero.
+   *
+   * \param joint_count number of joints in the batch.
+   * \param interfaces interfaces which are provided by every joint in the batch.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  JointValuesBatch(size_t joint_count, const std::vector<std::string> & interfaces);
+
+  HARDWARE_INTERFACE_PUBLIC
+  const std::vector<std::string> & get_interfaces() const;
+
+  HARDWARE_INTERFACE_PUBLIC
+  size_t get_joint_count() const;
+
+  /**
+   * \brief Resolve the index of an interface, to get its values with get_values() afterwards.
+   *
+   * \param interface interface to resolve.
+   * \param interface_index index of the interface in the batch.
+   * \return return_type::INTERFACE_NOT_FOUND if interface is not in the batch,
+   * return_type::OK otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type get_interface_index(const std::string & interface, size_t & interface_index) const;
+
+  /**
+   * \brief Get the values of an interface for all joints of the batch.
+   *
+   * \param interface_index index of the interface, lower than get_interfaces().size().
+   * \return view of get_joint_count() values, ordered as the joints.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  Span<double> get_values(size_t interface_index);
+
+  HARDWARE_INTERFACE_PUBLIC
+  Span<const double> get_values(size_t interface_index) const;
+
+  /**
+   * \brief Get all values of the batch, interface by interface.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  Span<double> get_all_values();
+
+  HARDWARE_INTERFACE_PUBLIC
+  Span<const double> get_all_values() const;
+
+  /**
+   * \brief Set the acquisition time of the states of the batch, for the whole process image
+   * sampled at once, see components::Joint::set_state_stamp().
+   *
+   * \param stamp acquisition time of the values.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  void set_stamp(std::chrono::nanoseconds stamp);
+
+  /**
+   * \brief Acquisition time of the values, zero if the hardware does not stamp them.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  std::chrono::nanoseconds get_stamp() const;
+
+private:
+  std::vector<std::string> interfaces_;
+  size_t joint_count_ = 0;
+  std::vector<double> values_;
+  std::chrono::nanoseconds stamp_{0};
+};
+
+}  // namespace components
+}  // namespace hardware_interface
+#endif  // HARDWARE_INTERFACE__COMPONENTS__JOINT_VALUES_BATCH_HPP_
@@ -15,10 +15,18 @@
 #ifndef HARDWARE_INTERFACE__COMPONENTS__SENSOR_HPP_
 #define HARDWARE_INTERFACE__COMPONENTS__SENSOR_HPP_
 
+#include <chrono>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "hardware_interface/components/component_info.hpp"
+#include "hardware_interface/components/interface_selector.hpp"
+#include "hardware_interface/components/sensor_filter_chain.hpp"
+#include "hardware_interface/interface_type_id.hpp"
+#include "hardware_interface/sample_queue.hpp"
+#include "hardware_interface/span.hpp"
+#include "hardware_interface/triple_buffer.hpp"
 #include "hardware_interface/types/hardware_interface_return_values.hpp"
 #include "hardware_interface/visibility_control.h"
 
@@ -35,6 +43,9 @@ namespace components
 class Sensor
 {
 public:
+  /// Parameter of the sensor in the URDF enabling its sample queue with the given capacity.
+  static constexpr const char * SAMPLE_QUEUE_CAPACITY_PARAMETER = "sample_queue_capacity";
+
   HARDWARE_INTERFACE_PUBLIC
   Sensor() = default;
 
@@ -44,10 +55,13 @@ public:
 
   /**
    * \brief Configure base sensor class based on the description in the robot's URDF file.
+   * The sample queue is enabled if the SAMPLE_QUEUE_CAPACITY_PARAMETER is set, and the states are
+   * filtered by the filters of the SensorFilterChain::FILTERS_PARAMETER if it is set.
    *
    * \param joint_info structure with data from URDF.
    * \return return_type::OK if required data are provided and is successfully parsed,
-   * return_type::ERROR otherwise.
+   * return_type::ERROR otherwise, e.g. if the sample queue capacity is not a positive integer or
+   * a filter is invalid.
    */
   HARDWARE_INTERFACE_PUBLIC
   virtual
@@ -62,6 +76,15 @@ public:
   virtual
   std::vector<std::string> get_state_interfaces() const;
 
+  /**
+   * \brief Provide the interned ids of the state interfaces configured for the sensor.
+   *
+   * \return id list with state interfaces, in the order of get_state_interfaces().
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  std::vector<InterfaceTypeId> get_state_interface_ids() const;
+
   /**
    * \brief Get state list from the sensor. This function is used by the controller to get the
    * actual state of the hardware. The parameters state, and interfaces have the same order and
@@ -120,11 +143,260 @@ public:
   virtual
   return_type set_state(const std::vector<double> & state);
 
+  /**
+   * \brief Resolve state interfaces of the sensor by interned id once, to get and set states with
+   * the selector afterwards.
+   *
+   * \param selector resolved state interfaces.
+   * \param interfaces list of state interface ids to resolve.
+   * \return return_type::INTERFACE_NOT_FOUND if one of provided interfaces is not defined for the
+   * sensor; return return_type::INTERFACE_NOT_PROVIDED if the list of interfaces is empty;
+   * return_type::OK otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  return_type get_state_interface_selector(
+    InterfaceSelector & selector, const std::vector<InterfaceTypeId> & interfaces) const;
+
+  /**
+   * \brief Get states of the interfaces resolved in the selector, without comparing strings or
+   * allocating.
+   *
+   * \param state output for the states, same size as the selector.
+   * \param selector state interfaces resolved by get_state_interface_selector().
+   * \return return_type::INTERFACE_VALUE_SIZE_NOT_EQUAL if state and selector do not have the
+   * same length; return_type::INTERFACE_NOT_FOUND if the selector was not resolved for this
+   * sensor; return return_type::INTERFACE_NOT_PROVIDED if the selector is empty;
+   * return_type::OK otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  return_type get_state(Span<double> state, const InterfaceSelector & selector) const;
+
+  /**
+   * \brief Set states of the interfaces resolved in the selector, without comparing strings.
+   *
+   * \param state states to set, same size as the selector.
+   * \param selector state interfaces resolved by get_state_interface_selector().
+   * \return return_type::INTERFACE_VALUE_SIZE_NOT_EQUAL if state and selector do not have the
+   * same length; return_type::INTERFACE_NOT_FOUND if the selector was not resolved for this
+   * sensor; return return_type::INTERFACE_NOT_PROVIDED if the selector is empty;
+   * return_type::OK otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  return_type set_state(Span<const double> state, const InterfaceSelector & selector);
+
+  /**
+   * \brief Switch the sensor to buffered states, for sensors sampled in their own driver thread.
+   * The driver thread then publishes whole samples with publish_state(), and the thread reading
+   * the sensor takes the latest one with update_state(). The other state getters and setters
+   * work on the sample taken by the last update_state(), and may then only be called from the
+   * reading thread. Called once after configure(), not real-time safe.
+   *
+   * \return return_type::ERROR if the sensor has no state interfaces, return_type::OK otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  return_type enable_state_buffer();
+
+  HARDWARE_INTERFACE_PUBLIC
+  bool is_state_buffer_enabled() const;
+
+  /**
+   * \brief Publish a whole sample of the sensor, from the driver thread. Wait-free, the sample is
+   * never seen partially written by the reading thread. A sample not taken by update_state()
+   * before the next one is published is dropped.
+   *
+   * \param state values of all the state interfaces, in the order of get_state_interfaces().
+   * \param stamp acquisition time of the sample, in the time base of the driver.
+   * \return return_type::ERROR if the state buffer is not enabled;
+   * return_type::INTERFACE_VALUE_SIZE_NOT_EQUAL if state is not the size of the state interfaces;
+   * return_type::OK otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  return_type publish_state(Span<const double> state, std::chrono::nanoseconds stamp);
+
+  /**
+   * \brief Take the latest sample published by the driver thread, from the reading thread.
+   * Wait-free, does not copy nor allocate. Does nothing if the state buffer is not enabled.
+   *
+   * \return true if a new sample was taken, false if the states are the ones of the last update.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  bool update_state();
+
+  /**
+   * \brief Set the acquisition time of the states, by the hardware setting them without the
+   * state buffer. The time is in the clock of the hardware, see ClockDomainMap.
+   *
+   * \param stamp acquisition time of the states.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  void set_state_stamp(std::chrono::nanoseconds stamp);
+
+  /**
+   * \brief Acquisition time of the states, of the sample taken by the last update_state() or
+   * take_samples() if buffered, zero before the first sample or if the hardware does not stamp
+   * them.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  std::chrono::nanoseconds get_state_stamp() const;
+
+  /**
+   * \brief Enable the queue of the samples of the sensor, for sensors sampled faster than they
+   * are read. The hardware pushes every sample with push_sample(), possibly from a driver thread,
+   * and a single consumer takes all the samples queued since its previous take with
+   * take_samples(). All the storage is allocated here, not real-time safe. Replaces any queue
+   * enabled before, e.g. by configure() for sensors changing their state interfaces afterwards.
+   *
+   * \param capacity maximum number of queued samples.
+   * \return return_type::ERROR if the capacity is zero or the sensor has no state interfaces,
+   * return_type::OK otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  return_type enable_sample_queue(size_t capacity);
+
+  HARDWARE_INTERFACE_PUBLIC
+  bool is_sample_queue_enabled() const;
+
+  /// Capacity of the sample queue, zero if it is not enabled.
+  HARDWARE_INTERFACE_PUBLIC
+  size_t get_sample_queue_capacity() const;
+
+  /**
+   * \brief Queue a whole sample of the sensor. Wait-free, without allocation.
+   *
+   * \param state values of all the state interfaces, in the order of get_state_interfaces().
+   * \param stamp acquisition time of the sample, in the time base of the hardware.
+   * \return return_type::ERROR if the sample queue is not enabled or is full, the sample is then
+   * dropped; return_type::INTERFACE_VALUE_SIZE_NOT_EQUAL if state is not the size of the state
+   * interfaces; return_type::OK otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  return_type push_sample(Span<const double> state, std::chrono::nanoseconds stamp);
+
+  /**
+   * \brief Take all the samples queued since the previous take, by the single consumer. The
+   * states and their stamp are set to the latest taken sample. Wait-free, without allocation.
+   *
+   * \return the taken samples, oldest first, valid until the next take; empty if no sample was
+   * queued or the sample queue is not enabled.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  SampleSpan take_samples();
+
+  /// Samples taken by the last take_samples().
+  HARDWARE_INTERFACE_PUBLIC
+  SampleSpan get_samples() const;
+
+  /// Number of samples dropped because the sample queue was full.
+  HARDWARE_INTERFACE_PUBLIC
+  uint64_t get_dropped_sample_count() const;
+
+  /// Whether the states are filtered, see SensorFilterChain.
+  HARDWARE_INTERFACE_PUBLIC
+  bool has_filter_chain() const;
+
+  /**
+   * \brief Filter the states read in the cycle, once per cycle after the hardware read them,
+   * for all the controllers getting the filtered states. Every sample taken by the last
+   * take_samples() is filtered, in order, if they were not filtered yet, the current states
+   * otherwise. Does nothing without filter chain. Real-time safe.
+   *
+   * \return return_type::INTERFACE_VALUE_SIZE_NOT_EQUAL if the states were resized since the
+   * filter chain was configured, return_type::OK otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  return_type filter_states();
+
+  /**
+   * \brief Get the filtered states, in the order of get_state_interfaces(). They are the raw
+   * states if the sensor has no filter chain.
+   *
+   * \param state list of doubles with the filtered states.
+   * \return return_type::OK always.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  return_type get_filtered_state(std::vector<double> & state) const;
+
+  /**
+   * \brief Get the filtered states of some state interfaces, see get_state().
+   *
+   * \param state list of doubles with the filtered states.
+   * \param interfaces list of the state interfaces of the raw states.
+   * \return the same as get_state().
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  return_type get_filtered_state(
+    std::vector<double> & state, const std::vector<std::string> & interfaces) const;
+
+  /**
+   * \brief Get the filtered states of the interfaces resolved in the selector, without comparing
+   * strings or allocating, see get_state().
+   *
+   * \param state output for the filtered states, same size as the selector.
+   * \param selector state interfaces resolved by get_state_interface_selector().
+   * \return the same as get_state().
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  return_type get_filtered_state(Span<double> state, const InterfaceSelector & selector) const;
+
 protected:
+  /**
+   * \brief Configure the filter chain for the current states, by configure() and by the derived
+   * sensors changing their states afterwards. Not real-time safe.
+   *
+   * \return return_type::ERROR if a filter is invalid, return_type::OK otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type configure_filter_chain();
+
+  /// A sample of all the states, as exchanged between the driver and the reading threads.
+  struct StampedState
+  {
+    std::vector<double> values;
+    std::chrono::nanoseconds stamp{0};
+  };
+
   ComponentInfo info_;
+  /// Interned info_.state_interfaces, to be kept in sync by derived classes changing them
+  std::vector<InterfaceTypeId> state_interface_ids_;
   std::vector<double> states_;
+  std::chrono::nanoseconds state_stamp_{0};
+  /// Samples published by the driver thread, only once enable_state_buffer() was called
+  std::unique_ptr<TripleBuffer<StampedState>> state_buffer_;
+  /// Samples pushed by the hardware, only once the sample queue was enabled
+  std::unique_ptr<SampleQueue> sample_queue_;
+  /// Samples taken by the consumer, contiguous
+  std::vector<double> taken_sample_values_;
+  std::vector<std::chrono::nanoseconds> taken_sample_stamps_;
+  size_t taken_sample_count_ = 0;
+  /// Filters of the states, empty if they are not filtered
+  SensorFilterChain filter_chain_;
+  std::vector<double> filtered_states_;
+  /// Whether the samples taken by the last take_samples() were filtered
+  bool taken_samples_filtered_ = true;
 };
 
+/**
+ * \brief Filter the states of the sensors, see Sensor::filter_states(), called by the hardware
+ * after reading them.
+ *
+ * \return the first error of a sensor, return_type::OK if there is none.
+ */
+HARDWARE_INTERFACE_PUBLIC
+return_type filter_sensor_states(const std::vector<std::shared_ptr<Sensor>> & sensors);
+
 }  // namespace components
 }  // namespace hardware_interface
 #endif  // HARDWARE_INTERFACE__COMPONENTS__SENSOR_HPP_
@@ -0,0 +1,140 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__COMPONENTS__SENSOR_FILTER_CHAIN_HPP_
+#define HARDWARE_INTERFACE__COMPONENTS__SENSOR_FILTER_CHAIN_HPP_
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "hardware_interface/span.hpp"
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+#include "hardware_interface/visibility_control.h"
+
+namespace hardware_interface
+{
+namespace components
+{
+
+/**
+ * \brief Chain of filters applied to all the states of a sensor at once, configured from the
+ * parameters of the sensor in the URDF, e.g.
+ *
+ *   <param name="filters">biquad decimation</param>
+ *   <param name="biquad_cutoff_frequency">50.0</param>
+ *   <param name="biquad_sampling_frequency">1000.0</param>
+ *   <param name="decimation_factor">2</param>
+ *
+ * The filters run in the order of the FILTERS_PARAMETER, each over all the channels of a sample
+ * in one loop, the state of the filters being stored per channel in contiguous arrays so that the
+ * compiler vectorizes the loops. The filters are:
+ * - biquad: IIR filter of the coefficients BIQUAD_COEFFICIENTS_PARAMETER "b0 b1 b2 a1 a2",
+ *   normalized for a0 = 1, or Butterworth low-pass of BIQUAD_CUTOFF_FREQUENCY_PARAMETER at
+ *   BIQUAD_SAMPLING_FREQUENCY_PARAMETER, in Hz.
+ * - moving_average: mean of the last MOVING_AVERAGE_WINDOW_PARAMETER samples.
+ * - median: median of the last MEDIAN_WINDOW_PARAMETER samples, rejecting spikes.
+ * - decimation: keeps one sample every DECIMATION_FACTOR_PARAMETER, the filters after it and the
+ *   output are only updated with the kept samples.
+ *
+ * The filters start from the first sample as if it had always been measured, without transient.
+ * All the storage is allocated by configure(), filter() and reset() are real-time safe.
+ */
+class SensorFilterChain
+{
+public:
+  static constexpr const char * FILTERS_PARAMETER = "filters";
+  static constexpr const char * BIQUAD_COEFFICIENTS_PARAMETER = "biquad_coefficients";
+  static constexpr const char * BIQUAD_CUTOFF_FREQUENCY_PARAMETER = "biquad_cutoff_frequency";
+  static constexpr const char * BIQUAD_SAMPLING_FREQUENCY_PARAMETER = "biquad_sampling_frequency";
+  static constexpr const char * MOVING_AVERAGE_WINDOW_PARAMETER = "moving_average_window";
+  static constexpr const char * MEDIAN_WINDOW_PARAMETER = "median_window";
+  static constexpr const char * DECIMATION_FACTOR_PARAMETER = "decimation_factor";
+
+  /**
+   * \brief Configure the filters from the parameters of a sensor, not real-time safe.
+   *
+   * \param parameters parameters of the sensor, without FILTERS_PARAMETER for no filter.
+   * \param channel_count number of values of a sample, the states of the sensor.
+   * \return return_type::ERROR, and no filter, if a filter is unknown or its parameters are missing
+   * or invalid, return_type::OK otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type configure(
+    const std::unordered_map<std::string, std::string> & parameters, size_t channel_count);
+
+  /// Whether there is no filter.
+  HARDWARE_INTERFACE_PUBLIC
+  bool empty() const;
+
+  HARDWARE_INTERFACE_PUBLIC
+  size_t get_channel_count() const;
+
+  /**
+   * \brief Filter one sample of all the channels.
+   *
+   * \param input values of the channels.
+   * \param output filtered values of the channels, unchanged if the sample is dropped by a
+   * decimation, may not be the input.
+   * \return return_type::INTERFACE_VALUE_SIZE_NOT_EQUAL if input or output is not the size of the
+   * channels, return_type::OK otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type filter(Span<const double> input, Span<double> output);
+
+  /// Forget the filtered samples, the next one starts the filters again.
+  HARDWARE_INTERFACE_PUBLIC
+  void reset();
+
+private:
+  enum class FilterType
+  {
+    BIQUAD,
+    MOVING_AVERAGE,
+    MEDIAN,
+    DECIMATION,
+  };
+
+  struct Filter
+  {
+    FilterType type;
+    /// Biquad coefficients, b0 b1 b2 a1 a2
+    double coefficients[5];
+    /// Window of the moving average and the median, factor of the decimation
+    size_t length;
+    /// Biquad delays, running sums of the moving average, one per channel
+    std::vector<double> state_a;
+    std::vector<double> state_b;
+    /// Last samples of the moving average and the median, length rows of all the channels
+    std::vector<double> window;
+    /// Next row of the window, or samples until the decimation keeps one
+    size_t position;
+  };
+
+  /// Whether the sample goes on through the next filters
+  bool apply(Filter & filter, double * values);
+
+  size_t channel_count_ = 0;
+  std::vector<Filter> filters_;
+  /// Output of the filters, when the sample is not dropped
+  std::vector<double> values_;
+  /// Values of one channel in the window of the median
+  std::vector<double> median_scratch_;
+  bool primed_ = false;
+};
+
+}  // namespace components
+}  // namespace hardware_interface
+#endif  // HARDWARE_INTERFACE__COMPONENTS__SENSOR_FILTER_CHAIN_HPP_
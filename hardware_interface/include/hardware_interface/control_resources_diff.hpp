@@ -0,0 +1,58 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__CONTROL_RESOURCES_DIFF_HPP_
+#define HARDWARE_INTERFACE__CONTROL_RESOURCES_DIFF_HPP_
+
+#include <string>
+#include <vector>
+
+#include "hardware_interface/hardware_info.hpp"
+#include "hardware_interface/visibility_control.h"
+
+namespace hardware_interface
+{
+
+/**
+  * \brief The names of the hardware which differ between two descriptions of the control
+  * resources, in the order of the descriptions.
+  */
+struct ControlResourcesDiff
+{
+  /// In the new description only
+  std::vector<std::string> added;
+  /// In the current description only
+  std::vector<std::string> removed;
+  /// In both, with a different type, class, parameter, joint, sensor or transmission
+  std::vector<std::string> changed;
+  std::vector<std::string> unchanged;
+};
+
+/**
+  * \brief Compare the control resources parsed from a new URDF to the current ones, by hardware
+  * name, to reconfigure only the hardware whose description changed.
+  *
+  * The typed parameters are not compared, they are converted from the text parameters which are.
+  *
+  * \param current control resources of the running hardware
+  * \param updated control resources parsed from the new URDF, e.g. by
+  * parse_control_resources_from_urdf()
+  * \return names of the added, removed, changed and unchanged hardware
+  */
+HARDWARE_INTERFACE_PUBLIC
+ControlResourcesDiff diff_control_resources(
+  const std::vector<HardwareInfo> & current, const std::vector<HardwareInfo> & updated);
+
+}  // namespace hardware_interface
+#endif  // HARDWARE_INTERFACE__CONTROL_RESOURCES_DIFF_HPP_
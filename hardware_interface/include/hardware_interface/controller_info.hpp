@@ -15,10 +15,9 @@
 #ifndef HARDWARE_INTERFACE__CONTROLLER_INFO_HPP_
 #define HARDWARE_INTERFACE__CONTROLLER_INFO_HPP_
 
+#include <map>
 #include <string>
-// TODO(v-lopez)
-// #include <vector>
-// #include <hardware_interface/interface_resources.h>
+#include <vector>
 
 namespace hardware_interface
 {
@@ -36,9 +35,17 @@ struct ControllerInfo
   /** Controller type. */
   std::string type;
 
-  // TODO(v-lopez)
-  /** Claimed resources, grouped by the hardware interface they belong to. */
-//   std::map<std::string, std::vector<std::string>> resources;
+  /** Claimed resources, grouped by the hardware interface they belong to.
+   *  Empty if the controller did not declare them, it may then use any resource. */
+  std::map<std::string, std::vector<std::string>> resources;
+
+  /** State interfaces read by the controller, grouped by interface as the resources.
+   *  Empty if the controller did not declare them, it may then read any state. */
+  std::map<std::string, std::vector<std::string>> read_states;
+
+  /** Reference interfaces exported by the controller, grouped by interface, with their full
+   *  names. Claimed in the resources of the controllers writing them. */
+  std::map<std::string, std::vector<std::string>> references;
 };
 
 }  // namespace hardware_interface
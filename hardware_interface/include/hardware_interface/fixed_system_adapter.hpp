@@ -0,0 +1,177 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__FIXED_SYSTEM_ADAPTER_HPP_
+#define HARDWARE_INTERFACE__FIXED_SYSTEM_ADAPTER_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+#include "hardware_interface/fixed_topology.hpp"
+#include "hardware_interface/joint_handle.hpp"
+#include "hardware_interface/robot_hardware.hpp"
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+
+namespace hardware_interface
+{
+namespace fixed
+{
+
+/// Exchange the values of a FixedSystem with the registry of a RobotHardware.
+/**
+ * The joints of the system are registered like any other joint, so that the controllers claim
+ * and access them through the registry. Once the registration is frozen, bind() resolves the
+ * storage of each value in the arena, and the values are then exchanged with no lookup: the
+ * states of the system are copied into the arena after the hardware is read, and the published
+ * commands copied into the system before the hardware is written. When the joints were registered
+ * together, their values are contiguous in the arena and each copy is a single copy.
+ */
+template<typename SystemT>
+class FixedSystemAdapter
+{
+public:
+  /// Register the joints of a system with their current values, before the freeze.
+  /**
+   * \return The return code, one of `OK` or the error of the first registration which failed.
+   */
+  static return_type register_joints(const SystemT & system, RobotHardware & hardware)
+  {
+    const auto interface_names = SystemT::Joint::get_interface_names();
+    for (size_t joint = 0; joint < SystemT::joint_count; ++joint) {
+      size_t state = 0;
+      size_t command = 0;
+      for (const char * interface_name : interface_names) {
+        const bool is_command = detail::is_command_name(interface_name);
+        const double value = is_command ?
+          system.get_command_values()[joint * SystemT::Joint::command_count + command++] :
+          system.get_state_values()[joint * SystemT::Joint::state_count + state++];
+        const auto result =
+          hardware.register_joint(system.get_joint_names()[joint], interface_name, value);
+        if (result != return_type::OK) {
+          return result;
+        }
+      }
+    }
+    return return_type::OK;
+  }
+
+  /// Resolve the storage of the values of a system in the arena of a frozen registration.
+  /**
+   * \return The return code, one of `OK`, `ERROR` if the registration is not frozen, or the error
+   * of the lookup of an interface which is not registered.
+   */
+  return_type bind(const SystemT & system, RobotHardware & hardware)
+  {
+    if (!hardware.is_registration_frozen()) {
+      return return_type::ERROR;
+    }
+    const auto interface_names = SystemT::Joint::get_interface_names();
+    for (size_t joint = 0; joint < SystemT::joint_count; ++joint) {
+      size_t state = 0;
+      size_t command = 0;
+      for (const char * interface_name : interface_names) {
+        InterfaceId interface_id;
+        auto result = hardware.get_joint_interface_id(
+          system.get_joint_names()[joint], interface_name, interface_id);
+        JointHandle handle(system.get_joint_names()[joint], interface_name);
+        if (result == return_type::OK) {
+          // the hardware reads the commands from their published copy
+          result = detail::is_command_name(interface_name) ?
+            hardware.get_published_joint_handle(interface_id, handle) :
+            hardware.get_joint_handle(interface_id, handle);
+        }
+        if (result != return_type::OK) {
+          return result;
+        }
+        if (detail::is_command_name(interface_name)) {
+          command_ptrs_[joint * SystemT::Joint::command_count + command++] =
+            handle.get_value_ptr();
+        } else {
+          state_ptrs_[joint * SystemT::Joint::state_count + state++] = handle.get_value_ptr();
+        }
+      }
+    }
+    states_contiguous_ = is_contiguous(state_ptrs_);
+    commands_contiguous_ = is_contiguous(command_ptrs_);
+    bound_ = true;
+    return return_type::OK;
+  }
+
+  bool is_bound() const
+  {
+    return bound_;
+  }
+
+  /// Whether the states and the commands are each copied with a single copy.
+  bool is_contiguous() const
+  {
+    return states_contiguous_ && commands_contiguous_;
+  }
+
+  /// Copy the states of a system into the arena, real-time safe, once bound.
+  void export_states(const SystemT & system) const
+  {
+    const auto states = system.get_state_values();
+    if (SystemT::state_count == 0) {
+      return;
+    }
+    if (states_contiguous_) {
+      std::copy_n(states.data(), SystemT::state_count, state_ptrs_[0]);
+    } else {
+      for (size_t i = 0; i < SystemT::state_count; ++i) {
+        *state_ptrs_[i] = states[i];
+      }
+    }
+  }
+
+  /// Copy the published commands of the arena into a system, real-time safe, once bound.
+  void import_commands(SystemT & system) const
+  {
+    auto commands = system.get_command_values();
+    if (SystemT::command_count == 0) {
+      return;
+    }
+    if (commands_contiguous_) {
+      std::copy_n(command_ptrs_[0], SystemT::command_count, commands.data());
+    } else {
+      for (size_t i = 0; i < SystemT::command_count; ++i) {
+        commands[i] = *command_ptrs_[i];
+      }
+    }
+  }
+
+private:
+  template<size_t Size>
+  static bool is_contiguous(const std::array<double *, Size> & ptrs)
+  {
+    for (size_t i = 1; i < Size; ++i) {
+      if (ptrs[i] != ptrs[0] + i) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::array<double *, SystemT::state_count> state_ptrs_{};
+  std::array<double *, SystemT::command_count> command_ptrs_{};
+  bool states_contiguous_ = true;
+  bool commands_contiguous_ = true;
+  bool bound_ = false;
+};
+
+}  // namespace fixed
+}  // namespace hardware_interface
+
+#endif  // HARDWARE_INTERFACE__FIXED_SYSTEM_ADAPTER_HPP_
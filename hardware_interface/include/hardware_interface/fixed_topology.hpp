@@ -0,0 +1,295 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__FIXED_TOPOLOGY_HPP_
+#define HARDWARE_INTERFACE__FIXED_TOPOLOGY_HPP_
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <type_traits>
+
+#include "hardware_interface/span.hpp"
+#include "hardware_interface/types/hardware_interface_type_values.hpp"
+
+namespace hardware_interface
+{
+namespace fixed
+{
+
+/// The standard interfaces of a fixed joint, an interface is a type with a constexpr name().
+struct Position
+{
+  static constexpr const char * name() {return HW_IF_POSITION;}
+};
+
+struct Velocity
+{
+  static constexpr const char * name() {return HW_IF_VELOCITY;}
+};
+
+struct Effort
+{
+  static constexpr const char * name() {return HW_IF_EFFORT;}
+};
+
+struct PositionCommand
+{
+  static constexpr const char * name() {return HW_IF_POSITION_COMMAND;}
+};
+
+struct VelocityCommand
+{
+  static constexpr const char * name() {return HW_IF_VELOCITY_COMMAND;}
+};
+
+struct EffortCommand
+{
+  static constexpr const char * name() {return HW_IF_EFFORT_COMMAND;}
+};
+
+namespace detail
+{
+/// Whether an interface is a command, by the suffix of its name as in InterfaceValueArena
+constexpr bool is_command_name(const char * name)
+{
+  const char suffix[] = "_command";
+  const size_t suffix_size = sizeof(suffix) - 1;
+  size_t size = 0;
+  while (name[size] != '\0') {
+    ++size;
+  }
+  if (size < suffix_size) {
+    return false;
+  }
+  for (size_t i = 0; i < suffix_size; ++i) {
+    if (name[size - suffix_size + i] != suffix[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template<typename ... Interfaces>
+constexpr size_t count_interfaces(bool command)
+{
+  // leading element, for the joints without interfaces
+  const bool is_command[] = {false, is_command_name(Interfaces::name())...};
+  size_t count = 0;
+  for (size_t i = 1; i < sizeof...(Interfaces) + 1; ++i) {
+    count += is_command[i] == command ? 1 : 0;
+  }
+  return count;
+}
+
+template<typename Interface, typename ... Interfaces>
+constexpr bool contains_interface()
+{
+  const bool same[] = {false, std::is_same<Interface, Interfaces>::value...};
+  for (size_t i = 1; i < sizeof...(Interfaces) + 1; ++i) {
+    if (same[i]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/// Offset of an interface among the interfaces of its kind, states or commands
+template<typename Interface, typename ... Interfaces>
+constexpr size_t interface_offset()
+{
+  const bool same[] = {false, std::is_same<Interface, Interfaces>::value...};
+  const bool is_command[] = {false, is_command_name(Interfaces::name())...};
+  size_t offset = 0;
+  for (size_t i = 1; i < sizeof...(Interfaces) + 1; ++i) {
+    if (same[i]) {
+      break;
+    }
+    offset += is_command[i] == is_command_name(Interface::name()) ? 1 : 0;
+  }
+  return offset;
+}
+}  // namespace detail
+
+/// The layout of the interfaces of a joint, fixed at compile time.
+/**
+ * The states and the commands are laid out in two separate regions, each in the order of the
+ * interfaces, as RobotHardware lays out the interfaces of a joint in its arena.
+ * E.g. FixedJoint<Position, Velocity, PositionCommand> has two states and one command.
+ */
+template<typename ... Interfaces>
+struct FixedJoint
+{
+  static constexpr size_t state_count = detail::count_interfaces<Interfaces...>(false);
+  static constexpr size_t command_count = detail::count_interfaces<Interfaces...>(true);
+
+  template<typename Interface>
+  static constexpr bool has_interface()
+  {
+    return detail::contains_interface<Interface, Interfaces...>();
+  }
+
+  template<typename Interface>
+  static constexpr bool is_command()
+  {
+    return detail::is_command_name(Interface::name());
+  }
+
+  /// Offset of an interface in the state or the command region of the joint.
+  template<typename Interface>
+  static constexpr size_t offset()
+  {
+    static_assert(has_interface<Interface>(), "the joint has no such interface");
+    return detail::interface_offset<Interface, Interfaces...>();
+  }
+
+  /// Names of the interfaces, in the order of the template arguments.
+  static std::array<const char *, sizeof...(Interfaces)> get_interface_names()
+  {
+    return {{Interfaces::name()...}};
+  }
+};
+
+template<typename ... Interfaces>
+constexpr size_t FixedJoint<Interfaces...>::state_count;
+template<typename ... Interfaces>
+constexpr size_t FixedJoint<Interfaces...>::command_count;
+
+/// The values of N joints of the same layout, fixed at compile time.
+/**
+ * The offsets of the values are constant expressions, so that get() and set() are plain loads and
+ * stores into the two arrays of the system, with no lookup nor check. The values of the joints
+ * are contiguous, joint by joint, in each region. The joint names are only used to register the
+ * joints in a RobotHardware, see FixedSystemAdapter.
+ */
+template<size_t N, typename JointT>
+class FixedSystem
+{
+public:
+  using Joint = JointT;
+  static constexpr size_t joint_count = N;
+  static constexpr size_t state_count = N * JointT::state_count;
+  static constexpr size_t command_count = N * JointT::command_count;
+
+  explicit FixedSystem(const std::array<std::string, N> & joint_names)
+  : joint_names_(joint_names)
+  {
+  }
+
+  const std::array<std::string, N> & get_joint_names() const
+  {
+    return joint_names_;
+  }
+
+  /// Offset of an interface of a joint in the state or the command region of the system.
+  template<typename Interface>
+  static constexpr size_t offset(size_t joint)
+  {
+    return joint * (JointT::template is_command<Interface>() ?
+           JointT::command_count : JointT::state_count) + JointT::template offset<Interface>();
+  }
+
+  /// Get a value of a joint given at compile time.
+  template<size_t J, typename Interface>
+  double get() const
+  {
+    static_assert(J < N, "joint index out of range");
+    return values<Interface>()[offset<Interface>(J)];
+  }
+
+  template<size_t J, typename Interface>
+  void set(double value)
+  {
+    static_assert(J < N, "joint index out of range");
+    values<Interface>()[offset<Interface>(J)] = value;
+  }
+
+  /// Get a value of a joint, unchecked, e.g. in a loop over the joints.
+  template<typename Interface>
+  double get(size_t joint) const
+  {
+    return values<Interface>()[offset<Interface>(joint)];
+  }
+
+  template<typename Interface>
+  void set(size_t joint, double value)
+  {
+    values<Interface>()[offset<Interface>(joint)] = value;
+  }
+
+  Span<double> get_state_values()
+  {
+    return Span<double>(states_.data(), state_count);
+  }
+
+  Span<const double> get_state_values() const
+  {
+    return Span<const double>(states_.data(), state_count);
+  }
+
+  Span<double> get_command_values()
+  {
+    return Span<double>(commands_.data(), command_count);
+  }
+
+  Span<const double> get_command_values() const
+  {
+    return Span<const double>(commands_.data(), command_count);
+  }
+
+private:
+  template<typename Interface>
+  const std::array<double, state_count> & values(
+    typename std::enable_if<!JointT::template is_command<Interface>()>::type * = nullptr) const
+  {
+    return states_;
+  }
+
+  template<typename Interface>
+  const std::array<double, command_count> & values(
+    typename std::enable_if<JointT::template is_command<Interface>()>::type * = nullptr) const
+  {
+    return commands_;
+  }
+
+  template<typename Interface>
+  std::array<double, state_count> & values(
+    typename std::enable_if<!JointT::template is_command<Interface>()>::type * = nullptr)
+  {
+    return states_;
+  }
+
+  template<typename Interface>
+  std::array<double, command_count> & values(
+    typename std::enable_if<JointT::template is_command<Interface>()>::type * = nullptr)
+  {
+    return commands_;
+  }
+
+  std::array<std::string, N> joint_names_;
+  std::array<double, state_count> states_{};
+  std::array<double, command_count> commands_{};
+};
+
+template<size_t N, typename JointT>
+constexpr size_t FixedSystem<N, JointT>::joint_count;
+template<size_t N, typename JointT>
+constexpr size_t FixedSystem<N, JointT>::state_count;
+template<size_t N, typename JointT>
+constexpr size_t FixedSystem<N, JointT>::command_count;
+
+}  // namespace fixed
+}  // namespace hardware_interface
+
+#endif  // HARDWARE_INTERFACE__FIXED_TOPOLOGY_HPP_
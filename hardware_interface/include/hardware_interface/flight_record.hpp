@@ -0,0 +1,171 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__FLIGHT_RECORD_HPP_
+#define HARDWARE_INTERFACE__FLIGHT_RECORD_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+#include "hardware_interface/visibility_control.h"
+
+namespace hardware_interface
+{
+
+/// Why a flight record was dumped
+enum class FlightRecordDumpReason : uint32_t
+{
+  /// Requested by the dump_flight_record service or by dump()
+  REQUESTED = 0,
+  /// The hardware or a controller failed in a cycle
+  FAULT = 1,
+  /// A cycle ended after the start of the next one
+  OVERRUN = 2,
+};
+
+/// Header at the begin of a flight record file, dumped by the controller manager.
+/**
+ * The file is laid out to be mapped as is: the names follow the header at names_offset, one
+ * null-terminated "handle/interface" name per actuator value and then per joint value, empty for
+ * padding. The cycles follow at cycles_offset, oldest first, each cycle_size bytes long: a
+ * FlightRecordCycle, the actuator values, the joint values, and controller_capacity
+ * FlightRecordController slots, of which the first FlightRecordCycle::controller_count are used.
+ * The values mirror the layout of the InterfaceValueArena of the hardware, state region, padding
+ * and command region included. All the fields are in the byte order of the recording machine.
+ */
+struct FlightRecordHeader
+{
+  static constexpr uint32_t MAGIC = 0x72326672;  // "r2fr"
+  static constexpr uint32_t LAYOUT_VERSION = 1;
+
+  uint32_t magic;
+  uint32_t layout_version;
+  /// A FlightRecordDumpReason
+  uint32_t dump_reason;
+  uint32_t controller_capacity;
+  uint64_t actuator_value_count;
+  uint64_t joint_value_count;
+  uint64_t cycle_size;
+  uint64_t cycle_count;
+  /// Number of cycles recorded before the first one of the file, which were overwritten
+  uint64_t first_cycle_index;
+  uint64_t names_offset;
+  uint64_t names_size;
+  uint64_t cycles_offset;
+};
+
+/// Begin of a recorded cycle
+struct FlightRecordCycle
+{
+  static constexpr uint32_t FAILED = 0x1;
+
+  /// Time of the cycle, as given to the controllers
+  int64_t time_ns;
+  int64_t period_ns;
+  /// Duration of the update of the controller manager, switches included
+  int64_t update_duration_ns;
+  uint32_t controller_count;
+  uint32_t flags;
+};
+
+/// Update of a running controller in a recorded cycle
+struct FlightRecordController
+{
+  static constexpr size_t NAME_SIZE = 32;
+  static constexpr uint32_t FAILED = 0x1;
+  static constexpr uint32_t SKIPPED = 0x2;
+  /// The update was left out as the inputs of the controller did not change
+  static constexpr uint32_t UNCHANGED = 0x4;
+
+  /// Name of the controller, truncated to fit and null-terminated
+  char name[NAME_SIZE];
+  /// Duration of the update, 0 if the controller was not updated in the cycle
+  int64_t update_duration_ns;
+  uint32_t flags;
+  uint32_t reserved;
+};
+
+/// Read a flight record file, mapped read-only.
+class FlightRecordReader
+{
+public:
+  HARDWARE_INTERFACE_PUBLIC
+  FlightRecordReader() = default;
+
+  HARDWARE_INTERFACE_PUBLIC
+  ~FlightRecordReader();
+
+  FlightRecordReader(const FlightRecordReader &) = delete;
+  FlightRecordReader & operator=(const FlightRecordReader &) = delete;
+
+  /// Map a file, only available on Linux.
+  /**
+   * \param[in] path The file.
+   * \return ERROR if the file does not exist or was not written by a compatible recorder.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type open(const std::string & path);
+
+  HARDWARE_INTERFACE_PUBLIC
+  void close();
+
+  HARDWARE_INTERFACE_PUBLIC
+  bool is_open() const;
+
+  HARDWARE_INTERFACE_PUBLIC
+  const FlightRecordHeader & get_header() const;
+
+  /// Names of the actuator values, "actuator/interface", empty for padding
+  HARDWARE_INTERFACE_PUBLIC
+  const std::vector<std::string> & get_actuator_value_names() const;
+
+  /// Names of the joint values, "joint/interface", empty for padding
+  HARDWARE_INTERFACE_PUBLIC
+  const std::vector<std::string> & get_joint_value_names() const;
+
+  HARDWARE_INTERFACE_PUBLIC
+  size_t get_cycle_count() const;
+
+  /// The cycle at index, 0 for the oldest one
+  HARDWARE_INTERFACE_PUBLIC
+  const FlightRecordCycle & get_cycle(size_t index) const;
+
+  /// The header_.actuator_value_count actuator values of the cycle at index
+  HARDWARE_INTERFACE_PUBLIC
+  const double * get_actuator_values(size_t index) const;
+
+  /// The header_.joint_value_count joint values of the cycle at index
+  HARDWARE_INTERFACE_PUBLIC
+  const double * get_joint_values(size_t index) const;
+
+  /// The get_cycle(index).controller_count controllers of the cycle at index
+  HARDWARE_INTERFACE_PUBLIC
+  const FlightRecordController * get_controllers(size_t index) const;
+
+private:
+  const char * get_cycle_data(size_t index) const;
+
+  void * file_ = nullptr;
+  size_t file_size_ = 0;
+  const FlightRecordHeader * header_ = nullptr;
+  std::vector<std::string> actuator_value_names_;
+  std::vector<std::string> joint_value_names_;
+};
+
+}  // namespace hardware_interface
+
+#endif  // HARDWARE_INTERFACE__FLIGHT_RECORD_HPP_
@@ -17,12 +17,17 @@
 
 #include <string>
 
+#include "hardware_interface/bound_handle.hpp"
 #include "hardware_interface/macros.hpp"
 #include "hardware_interface/visibility_control.h"
 
 namespace hardware_interface
 {
-/** A handle used to get and set a value on a given interface. */
+/// A handle used to get and set a value on a given interface.
+/**
+ * Every access checks the value pointer and the handle carries the names of its interface, it is
+ * meant for the configuration, the real-time loop uses the BoundHandle returned by bind().
+ */
 template<class HandleType>
 class Handle
 {
@@ -67,6 +72,24 @@ public:
     *value_ptr_ = value;
   }
 
+  /// Bind the handle to the storage of its value, for unchecked accesses.
+  /**
+   * \throws std::runtime_error if the handle was not retrieved from a hardware.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  BoundHandle<HandleType> bind() const
+  {
+    THROW_ON_NULLPTR(value_ptr_);
+    return BoundHandle<HandleType>(value_ptr_);
+  }
+
+  /// Get the storage of the value, null if the handle was not retrieved from a hardware.
+  HARDWARE_INTERFACE_PUBLIC
+  double * get_value_ptr() const
+  {
+    return value_ptr_;
+  }
+
 protected:
   std::string name_;
   std::string interface_name_;
@@ -0,0 +1,119 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__HARDWARE_DESCRIPTION_CACHE_HPP_
+#define HARDWARE_INTERFACE__HARDWARE_DESCRIPTION_CACHE_HPP_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "hardware_interface/hardware_info.hpp"
+#include "hardware_interface/typed_parameters.hpp"
+#include "hardware_interface/visibility_control.h"
+
+namespace hardware_interface
+{
+
+/// Header at the begin of a hardware description cache file.
+/**
+ * The header is followed by payload_size bytes of serialized HardwareInfo: counts and string
+ * lengths as 32 bit integers, strings without terminator, in the byte order of the machine that
+ * wrote the file.
+ * The typed parameters are not stored, only the text they are converted from.
+ */
+struct HardwareDescriptionCacheHeader
+{
+  static constexpr uint32_t MAGIC = 0x72326864;  // "r2hd"
+  static constexpr uint32_t FORMAT_VERSION = 1;
+
+  uint32_t magic;
+  uint32_t format_version;
+  uint64_t urdf_hash;
+  uint64_t payload_size;
+  uint64_t payload_checksum;
+};
+
+/**
+ * \brief Compute the key of a URDF in the hardware description cache.
+ *
+ * \param urdf string with robot's URDF
+ * \return 64 bit FNV-1a hash of the URDF
+ */
+HARDWARE_INTERFACE_PUBLIC
+uint64_t hash_urdf(const std::string & urdf);
+
+/**
+ * \brief Write the control resources parsed from a URDF to a cache file.
+ *
+ * The file is written next to \p cache_path and then renamed, readers never see a partial file.
+ * \param cache_path path of the cache file
+ * \param urdf_hash hash_urdf() of the URDF the control resources were parsed from
+ * \param hardware_info control resources to store
+ * \return true if the file was written, false otherwise
+ */
+HARDWARE_INTERFACE_PUBLIC
+bool write_hardware_description_cache(
+  const std::string & cache_path, uint64_t urdf_hash,
+  const std::vector<HardwareInfo> & hardware_info);
+
+/**
+ * \brief Read the control resources stored in a cache file.
+ *
+ * The file is memory-mapped, only available on Linux.
+ * \param cache_path path of the cache file
+ * \param urdf_hash hash_urdf() of the URDF the control resources are expected for
+ * \param[out] hardware_info control resources read, left unchanged on failure
+ * \return true if the file exists, was written for \p urdf_hash by this version and is intact,
+ * false otherwise
+ */
+HARDWARE_INTERFACE_PUBLIC
+bool read_hardware_description_cache(
+  const std::string & cache_path, uint64_t urdf_hash, std::vector<HardwareInfo> & hardware_info);
+
+/**
+ * \brief Get the control resources of a URDF from a cache file, parsing the URDF on cache miss.
+ *
+ * On a miss, the URDF is parsed with parse_control_resources_from_urdf() and the cache file is
+ * replaced, failures to write it are ignored.
+ * \param urdf string with robot's URDF
+ * \param cache_path path of the cache file
+ * \return vector filled with information about robot's control resources
+ * \throws std::runtime_error if the URDF has to be parsed and a robot attribute or tag is not found
+ */
+HARDWARE_INTERFACE_PUBLIC
+std::vector<HardwareInfo> load_control_resources_from_urdf(
+  const std::string & urdf, const std::string & cache_path);
+
+/**
+ * \brief Get the control resources of a URDF from a cache file, and convert the parameters of
+ * the hardware classes with a schema to their declared types.
+ *
+ * The typed parameters are converted after the cache is read, as on a miss.
+ * \param urdf string with robot's URDF
+ * \param cache_path path of the cache file
+ * \param schemas schemas of the parameters by hardware class, the parameters of the other
+ * classes are left as text only
+ * \return vector filled with information about robot's control resources
+ * \throws std::runtime_error if the URDF has to be parsed and a robot attribute or tag is not
+ * found, or if a parameter does not match the schema of its hardware class
+ */
+HARDWARE_INTERFACE_PUBLIC
+std::vector<HardwareInfo> load_control_resources_from_urdf(
+  const std::string & urdf, const std::string & cache_path,
+  const std::unordered_map<std::string, HardwareParameterSchema> & schemas);
+
+}  // namespace hardware_interface
+#endif  // HARDWARE_INTERFACE__HARDWARE_DESCRIPTION_CACHE_HPP_
@@ -0,0 +1,180 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef HARDWARE_INTERFACE__HARDWARE_EXECUTOR_HPP_
+#define HARDWARE_INTERFACE__HARDWARE_EXECUTOR_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+#include "hardware_interface/visibility_control.h"
+
+namespace hardware_interface
+{
+/// Timing of the last and slowest read and write of a hardware component.
+struct HardwareTiming
+{
+  std::string name;
+  std::chrono::nanoseconds last_read_duration{0};
+  std::chrono::nanoseconds max_read_duration{0};
+  std::chrono::nanoseconds last_write_duration{0};
+  std::chrono::nanoseconds max_write_duration{0};
+};
+
+/// Runs the read and write of independent hardware components in parallel.
+/**
+ * Each hardware component added to the executor gets its own worker thread once the executor is
+ * started, optionally pinned to a CPU. read() and write() hand the phase to all workers and return
+ * once all of them are done, so that they act as a barrier before and after the update of the
+ * controllers. begin_read() and end_read() split that barrier, to overlap the read of the next
+ * cycle with other work in the control loop.
+ * Until the executor is started, or after it is stopped, the components are read and written one
+ * after the other in the calling thread.
+ */
+class HardwareExecutor
+{
+public:
+  using HardwareCall = std::function<return_type()>;
+
+  HARDWARE_INTERFACE_PUBLIC
+  HardwareExecutor() = default;
+
+  HARDWARE_INTERFACE_PUBLIC
+  ~HardwareExecutor();
+
+  HardwareExecutor(const HardwareExecutor &) = delete;
+  HardwareExecutor & operator=(const HardwareExecutor &) = delete;
+
+  /// Add a hardware component, while the executor is not started.
+  /**
+   * \param[in] name The name of the component, used in the timings.
+   * \param[in] read The call reading the component, e.g. its read_joints and read_sensors.
+   * \param[in] write The call writing the component, e.g. its write_joints.
+   * \param[in] cpu The CPU the worker of the component is pinned to, -1 to not pin it.
+   * \return The return code, one of `OK` or `ERROR` if the executor is started.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type add_hardware(
+    const std::string & name, HardwareCall read, HardwareCall write, int cpu = -1);
+
+  /// Start one worker per hardware component.
+  /**
+   * \return The return code, one of `OK` or `ERROR` if already started.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type start();
+
+  /// Stop and join the workers, waiting for the current phase to finish.
+  HARDWARE_INTERFACE_PUBLIC
+  void stop();
+
+  HARDWARE_INTERFACE_PUBLIC
+  bool is_started() const;
+
+  /// Read all the hardware components and wait until they are done.
+  /**
+   * \return The return code, `OK` if all the components were read, otherwise the first error.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type read();
+
+  /// Write all the hardware components and wait until they are done.
+  /**
+   * \return The return code, `OK` if all the components were written, otherwise the first error.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type write();
+
+  /// Start reading all the hardware components, without waiting for them.
+  /**
+   * \return The return code, one of `OK` or `ERROR` if the previous phase was not ended.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type begin_read();
+
+  /// Wait until the read started by begin_read() is done.
+  /**
+   * \return The return code, `OK` if all the components were read, otherwise the first error.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type end_read();
+
+  /// Start writing all the hardware components, without waiting for them.
+  /**
+   * \return The return code, one of `OK` or `ERROR` if the previous phase was not ended.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type begin_write();
+
+  /// Wait until the write started by begin_write() is done.
+  /**
+   * \return The return code, `OK` if all the components were written, otherwise the first error.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type end_write();
+
+  /// Get the timings of all the hardware components, in the order they were added.
+  /**
+   * Must not be called while a phase is in progress.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  const std::vector<HardwareTiming> & get_timings() const;
+
+private:
+  enum class Phase : std::uint8_t
+  {
+    NONE,
+    READ,
+    WRITE,
+  };
+
+  struct Hardware
+  {
+    HardwareCall read;
+    HardwareCall write;
+    int cpu;
+    std::thread worker;
+  };
+
+  return_type begin_phase(Phase phase);
+  return_type end_phase(Phase phase);
+  void run_phase(size_t index, Phase phase);
+  void worker_loop(size_t index, uint64_t phase_count);
+
+  std::vector<Hardware> hardware_;
+  std::vector<HardwareTiming> timings_;
+  std::vector<return_type> results_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable phase_cv_;
+  std::condition_variable done_cv_;
+  Phase phase_ = Phase::NONE;
+  /// Incremented each time a phase begins, for the workers to know a new phase is begun
+  uint64_t phase_count_ = 0;
+  size_t pending_ = 0;
+  bool started_ = false;
+  bool stopping_ = false;
+};
+
+}  // namespace hardware_interface
+
+#endif  // HARDWARE_INTERFACE__HARDWARE_EXECUTOR_HPP_
@@ -0,0 +1,158 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__HARDWARE_FRESHNESS_HPP_
+#define HARDWARE_INTERFACE__HARDWARE_FRESHNESS_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+#include "hardware_interface/visibility_control.h"
+
+namespace hardware_interface
+{
+
+/**
+  * \brief Track how fresh the data read from the hardware components is.
+  * Each component records the steady clock time of its last successful read, a driver missing
+  * bus frames while still returning OK from its read functions then shows by its read time not
+  * advancing. Once per control cycle, update() compares the read times with the staleness
+  * thresholds of the components and publishes one flag per component in a single word, which the
+  * controller manager checks in bulk and the controllers test against the components of their
+  * joints, with one atomic load and without locking.
+  * The components are added in a non real-time thread, possibly while the others are read and
+  * updated, everything else is real-time safe.
+  */
+class HardwareFreshness
+{
+public:
+  /// Set of components, bit i for the component i.
+  using ComponentMask = uint64_t;
+
+  static constexpr size_t MAX_COMPONENTS = 64;
+
+  HARDWARE_INTERFACE_PUBLIC
+  HardwareFreshness() = default;
+
+  HardwareFreshness(const HardwareFreshness &) = delete;
+  HardwareFreshness & operator=(const HardwareFreshness &) = delete;
+
+  /// Add a component, called in a non real-time thread.
+  /**
+   * \param[in] name The name of the component.
+   * \param[in] joint_names The joints and sensors read through the component.
+   * \param[in] staleness_threshold Age after which the data of the component is stale, zero for a
+   * component which is never stale.
+   * \param[out] component The index of the component.
+   * \return The return code, one of `OK` or `ERROR` if there are already MAX_COMPONENTS
+   * components or one of that name.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type add_component(
+    const std::string & name, const std::vector<std::string> & joint_names,
+    std::chrono::nanoseconds staleness_threshold, size_t & component);
+
+  HARDWARE_INTERFACE_PUBLIC
+  size_t get_component_count() const;
+
+  HARDWARE_INTERFACE_PUBLIC
+  const std::string & get_component_name(size_t component) const;
+
+  HARDWARE_INTERFACE_PUBLIC
+  std::chrono::nanoseconds get_staleness_threshold(size_t component) const;
+
+  /// Record a successful read of a component, now.
+  HARDWARE_INTERFACE_PUBLIC
+  void record_read(size_t component);
+
+  /// Record a successful read of a component at a steady clock time.
+  HARDWARE_INTERFACE_PUBLIC
+  void record_read(size_t component, int64_t time_ns);
+
+  /// Get the steady clock time of the last successful read of a component, zero if never read.
+  HARDWARE_INTERFACE_PUBLIC
+  int64_t get_last_read_time_ns(size_t component) const;
+
+  /// Determine the stale components of the cycle, now.
+  /**
+   * Called once per control cycle, after the components are read.
+   * \return The stale components.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  ComponentMask update();
+
+  /// Determine the stale components of the cycle at a steady clock time.
+  /**
+   * A component with a staleness threshold is stale when it was never read, or last read longer
+   * than its threshold before time_ns.
+   * \return The stale components.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  ComponentMask update(int64_t time_ns);
+
+  /// Get the stale components as of the last update().
+  HARDWARE_INTERFACE_PUBLIC
+  ComponentMask get_stale_components() const;
+
+  /// Whether none of the components was stale as of the last update().
+  HARDWARE_INTERFACE_PUBLIC
+  bool is_fresh() const;
+
+  /// Whether none of a set of components was stale as of the last update().
+  /**
+   * \param[in] components A mask resolved once by get_component_mask() or
+   * get_joint_component_mask().
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  bool is_fresh(ComponentMask components) const;
+
+  /// Get the mask of one component, to test it with is_fresh().
+  HARDWARE_INTERFACE_PUBLIC
+  static ComponentMask get_component_mask(size_t component);
+
+  /// Resolve the components some joints are read through, called in a non real-time thread.
+  /**
+   * \param[in] joint_names The joints, e.g. the ones claimed by a controller; the joints of none
+   * of the components are left out.
+   * \return The components reading at least one of the joints.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  ComponentMask get_joint_component_mask(const std::vector<std::string> & joint_names) const;
+
+private:
+  struct Component
+  {
+    std::string name;
+    std::vector<std::string> joint_names;
+    int64_t staleness_threshold_ns = 0;
+    std::atomic<int64_t> last_read_ns{0};
+  };
+
+  /// Never reallocated, the components are only written before component_count_ is increased
+  std::array<Component, MAX_COMPONENTS> components_;
+  std::atomic<size_t> component_count_{0};
+  /// Serializes add_component()
+  std::mutex add_mutex_;
+  std::atomic<ComponentMask> stale_components_{0};
+};
+
+}  // namespace hardware_interface
+#endif  // HARDWARE_INTERFACE__HARDWARE_FRESHNESS_HPP_
@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "hardware_interface/components/component_info.hpp"
+#include "hardware_interface/typed_parameters.hpp"
 
 namespace hardware_interface
 {
@@ -46,6 +47,11 @@ struct HardwareInfo
    * \brief (optional) key-value pairs for hardware parameters.
    */
   std::unordered_map<std::string, std::string> hardware_parameters;
+  /**
+   * \brief (optional) values of the hardware parameters declared by the schema of the hardware
+   * class, converted when the description is parsed.
+   */
+  TypedParameters typed_hardware_parameters;
   /**
    * \brief map of joints provided by the hardware where the key is the joint name.
    * Required for Actuator and System Hardware.
@@ -0,0 +1,93 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__INTERFACE_LOOKUP_INDEX_HPP_
+#define HARDWARE_INTERFACE__INTERFACE_LOOKUP_INDEX_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "hardware_interface/interface_type_id.hpp"
+#include "hardware_interface/visibility_control.h"
+
+namespace hardware_interface
+{
+/// Identifier of a registered interface, resolved once by name and reused afterwards.
+struct InterfaceId
+{
+  /// Index of the handle, in registration order
+  size_t handle_index = 0;
+  /// Index of the interface in the handle's interfaces, in registration order
+  size_t interface_index = 0;
+};
+
+/// Hashed index of the registered handles and interfaces.
+/**
+ * Handle names are interned to their index and interface names to their InterfaceTypeId when
+ * registered, so that finding an interface by name costs two string hashes and one integer hash,
+ * and a single string hash when the interface type is already interned, independently of the
+ * number of registered handles and interfaces.
+ */
+class InterfaceLookupIndex
+{
+public:
+  /// Add an interface to the index.
+  /**
+   * \param[in] handle_name The name of the handle.
+   * \param[in] interface_name The name of the interface.
+   * \param[in] id The id of the interface, the handle index must be the same for all the
+   * interfaces of a handle.
+   * \return false if the interface was already in the index.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  bool add(const std::string & handle_name, const std::string & interface_name, InterfaceId id);
+
+  /// Add an interface to the index, by interface type.
+  HARDWARE_INTERFACE_PUBLIC
+  bool add(const std::string & handle_name, InterfaceTypeId interface_type, InterfaceId id);
+
+  /// Find the index of a handle by name.
+  HARDWARE_INTERFACE_PUBLIC
+  bool find_handle(const std::string & handle_name, size_t & handle_index) const;
+
+  /// Find the id of an interface by name.
+  HARDWARE_INTERFACE_PUBLIC
+  bool find(
+    const std::string & handle_name, const std::string & interface_name,
+    InterfaceId & id) const;
+
+  /// Find the id of an interface by handle name and interface type.
+  HARDWARE_INTERFACE_PUBLIC
+  bool find(
+    const std::string & handle_name, InterfaceTypeId interface_type,
+    InterfaceId & id) const;
+
+  /// Find the index of an interface in a handle by interface type, without any string lookup.
+  HARDWARE_INTERFACE_PUBLIC
+  bool find_interface(
+    size_t handle_index, InterfaceTypeId interface_type, size_t & interface_index) const;
+
+private:
+  static uint64_t make_key(size_t handle_index, InterfaceTypeId interface_type);
+
+  std::unordered_map<std::string, size_t> handle_indices_;
+  /// Interface index for each (handle index, interface type) key
+  std::unordered_map<uint64_t, size_t> interface_indices_;
+};
+
+}  // namespace hardware_interface
+
+#endif  // HARDWARE_INTERFACE__INTERFACE_LOOKUP_INDEX_HPP_
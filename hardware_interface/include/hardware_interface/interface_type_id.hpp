@@ -0,0 +1,113 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__INTERFACE_TYPE_ID_HPP_
+#define HARDWARE_INTERFACE__INTERFACE_TYPE_ID_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "hardware_interface/visibility_control.h"
+
+namespace hardware_interface
+{
+/// Interned interface type, e.g. "position" or "velocity_command", compared as an integer.
+/**
+ * The standard interface types have constexpr ids, see hardware_interface_type_values.hpp, the
+ * other ones are given the next free id when first interned. Ids are shared by the whole process
+ * and never released, so they can be resolved once at configuration time and then compared,
+ * hashed and stored without any string.
+ * Interning and finding by name take a lock, they are not real-time safe.
+ */
+class InterfaceTypeId
+{
+public:
+  static constexpr uint32_t INVALID_VALUE = UINT32_MAX;
+
+  /// An invalid id, matching no interface type.
+  constexpr InterfaceTypeId()
+  : value_(INVALID_VALUE)
+  {
+  }
+
+  constexpr explicit InterfaceTypeId(uint32_t value)
+  : value_(value)
+  {
+  }
+
+  /// Get the id of an interface type, interning it if it is not yet.
+  /**
+   * \param[in] name The name of the interface type, must not be empty.
+   * \return The id of the interface type, invalid if the name is empty.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  static InterfaceTypeId intern(const std::string & name);
+
+  /// Find the id of an already interned interface type, without interning it.
+  /**
+   * \return false if the interface type was never interned.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  static bool find(const std::string & name, InterfaceTypeId & id);
+
+  /// Get the name the interface type was interned with, empty for an invalid id.
+  HARDWARE_INTERFACE_PUBLIC
+  const std::string & get_name() const;
+
+  constexpr uint32_t get_value() const
+  {
+    return value_;
+  }
+
+  constexpr bool is_valid() const
+  {
+    return value_ != INVALID_VALUE;
+  }
+
+  constexpr bool operator==(const InterfaceTypeId & other) const
+  {
+    return value_ == other.value_;
+  }
+
+  constexpr bool operator!=(const InterfaceTypeId & other) const
+  {
+    return value_ != other.value_;
+  }
+
+  constexpr bool operator<(const InterfaceTypeId & other) const
+  {
+    return value_ < other.value_;
+  }
+
+private:
+  uint32_t value_;
+};
+
+}  // namespace hardware_interface
+
+namespace std
+{
+template<>
+struct hash<hardware_interface::InterfaceTypeId>
+{
+  size_t operator()(const hardware_interface::InterfaceTypeId & id) const
+  {
+    return std::hash<uint32_t>()(id.get_value());
+  }
+};
+}  // namespace std
+
+#endif  // HARDWARE_INTERFACE__INTERFACE_TYPE_ID_HPP_
@@ -0,0 +1,135 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__INTERFACE_VALUE_ARENA_HPP_
+#define HARDWARE_INTERFACE__INTERFACE_VALUE_ARENA_HPP_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "control_msgs/msg/dynamic_joint_state.hpp"
+#include "hardware_interface/realtime_memory_pool.hpp"
+#include "hardware_interface/visibility_control.h"
+
+namespace hardware_interface
+{
+/// Contiguous storage for the values of all the interfaces registered in a RobotHardware.
+/**
+ * The arena is laid out once, when the registration is frozen, and never reallocates afterwards,
+ * so pointers and offsets into it stay valid for the lifetime of the arena.
+ * The state and command interfaces are stored in two separate regions, each starting on its own
+ * cache line. Inside each region, values are ordered as they were registered: handle by handle and
+ * interface by interface.
+ * Interfaces whose name ends with COMMAND_INTERFACE_SUFFIX go to the command region.
+ * The command region is double buffered: the controllers write into the command region while the
+ * hardware reads a published copy of it, on its own cache lines after the command region, which
+ * publish_commands() updates at once between two cycles. The hardware then never sees the
+ * commands of a cycle partially written, even while the next cycle is being computed.
+ */
+class InterfaceValueArena
+{
+public:
+  static constexpr size_t CACHE_LINE_SIZE = 64;
+  static constexpr const char * COMMAND_INTERFACE_SUFFIX = "_command";
+
+  HARDWARE_INTERFACE_PUBLIC
+  InterfaceValueArena() = default;
+
+  InterfaceValueArena(const InterfaceValueArena &) = delete;
+  InterfaceValueArena & operator=(const InterfaceValueArena &) = delete;
+
+  /// Lay out the values of all the registered interfaces, initialized with their current values.
+  /**
+   * \param[in] registered The registered handles and interfaces, with their current values.
+   * \param[in] pool The pool the values are allocated from, which should outlive the arena, null
+   * to allocate them from the heap.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  void freeze(
+    const control_msgs::msg::DynamicJointState & registered,
+    RealtimeMemoryPool * pool = nullptr);
+
+  HARDWARE_INTERFACE_PUBLIC
+  bool is_frozen() const;
+
+  /// Get the storage of an interface value.
+  /**
+   * \param[in] handle_index The index of the handle in the registered handles.
+   * \param[in] interface_index The index of the interface in the handle's interfaces.
+   * \return pointer to the value, valid for the lifetime of the arena.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  double * get_value_ptr(size_t handle_index, size_t interface_index);
+
+  /// Get the offset of an interface value from data().
+  HARDWARE_INTERFACE_PUBLIC
+  size_t get_offset(size_t handle_index, size_t interface_index) const;
+
+  /// Begin of the arena, the state region comes first.
+  HARDWARE_INTERFACE_PUBLIC
+  double * data();
+
+  HARDWARE_INTERFACE_PUBLIC
+  const double * get_state_values() const;
+
+  HARDWARE_INTERFACE_PUBLIC
+  size_t get_state_size() const;
+
+  HARDWARE_INTERFACE_PUBLIC
+  double * get_command_values();
+
+  HARDWARE_INTERFACE_PUBLIC
+  size_t get_command_size() const;
+
+  /// Get the storage of an interface value as read by the hardware.
+  /**
+   * \param[in] handle_index The index of the handle in the registered handles.
+   * \param[in] interface_index The index of the interface in the handle's interfaces.
+   * \return pointer to the published copy of a command value, or to the value itself for a state
+   * value, valid for the lifetime of the arena.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  double * get_published_value_ptr(size_t handle_index, size_t interface_index);
+
+  /// Begin of the published copy of the command region, get_command_size() values.
+  HARDWARE_INTERFACE_PUBLIC
+  const double * get_published_command_values() const;
+
+  /// Copy the command region into its published copy, real-time safe.
+  /**
+   * To be called by the control loop once the commands of a cycle are all written, e.g. at the
+   * end of the update of the controllers, and never while the hardware reads the commands.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  void publish_commands();
+
+  HARDWARE_INTERFACE_PUBLIC
+  static bool is_command_interface(const std::string & interface_name);
+
+private:
+  /// Over-allocated by one cache line to be able to align the begin of the arena.
+  std::vector<double, PoolAllocator<double>> storage_;
+  double * begin_ = nullptr;
+  size_t state_size_ = 0;
+  size_t command_begin_ = 0;
+  size_t command_size_ = 0;
+  size_t published_command_begin_ = 0;
+  /// Offset from begin_ of each interface value, indexed by handle and then by interface.
+  std::vector<std::vector<size_t>> offsets_;
+};
+
+}  // namespace hardware_interface
+
+#endif  // HARDWARE_INTERFACE__INTERFACE_VALUE_ARENA_HPP_
@@ -0,0 +1,117 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__INTERFACE_VALUE_GROUP_HPP_
+#define HARDWARE_INTERFACE__INTERFACE_VALUE_GROUP_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "hardware_interface/span.hpp"
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+
+namespace hardware_interface
+{
+class RobotHardware;
+
+/// The values of one interface of a group of handles, e.g. the positions of the joints of an arm.
+/**
+ * Resolved once from the names of the handles, by RobotHardware::get_joint_value_group(), into the
+ * offsets of the values in the arena. When the values are contiguous in the arena, in the order of
+ * the handles, they are copied at once, otherwise they are gathered and scattered along the
+ * precomputed offsets. Copying does not allocate nor look anything up.
+ */
+class InterfaceValueGroup
+{
+public:
+  InterfaceValueGroup() = default;
+
+  size_t size() const
+  {
+    return offsets_.size();
+  }
+
+  /// Values contiguous in the arena, copied with a single copy.
+  bool is_contiguous() const
+  {
+    return contiguous_;
+  }
+
+  /// Copy the values of the group, in the order of the handles.
+  /**
+   * \param[out] values The values, as many as the group has handles.
+   * \return The return code, one of `OK` or `INTERFACE_VALUE_SIZE_NOT_EQUAL`.
+   */
+  return_type get_values(Span<double> values) const
+  {
+    if (values.size() != offsets_.size()) {
+      return return_type::INTERFACE_VALUE_SIZE_NOT_EQUAL;
+    }
+    if (contiguous_) {
+      std::copy_n(base_ + first_offset(), values.size(), values.data());
+    } else {
+      for (size_t i = 0; i < offsets_.size(); ++i) {
+        values[i] = base_[offsets_[i]];
+      }
+    }
+    return return_type::OK;
+  }
+
+  /// Set the values of the group, in the order of the handles.
+  /**
+   * \param[in] values The values, as many as the group has handles.
+   * \return The return code, one of `OK` or `INTERFACE_VALUE_SIZE_NOT_EQUAL`.
+   */
+  return_type set_values(Span<const double> values) const
+  {
+    if (values.size() != offsets_.size()) {
+      return return_type::INTERFACE_VALUE_SIZE_NOT_EQUAL;
+    }
+    if (contiguous_) {
+      std::copy_n(values.data(), values.size(), base_ + first_offset());
+    } else {
+      for (size_t i = 0; i < offsets_.size(); ++i) {
+        base_[offsets_[i]] = values[i];
+      }
+    }
+    return return_type::OK;
+  }
+
+private:
+  friend class RobotHardware;
+
+  InterfaceValueGroup(double * base, std::vector<size_t> offsets)
+  : base_(base), offsets_(std::move(offsets))
+  {
+    contiguous_ = true;
+    for (size_t i = 1; i < offsets_.size(); ++i) {
+      contiguous_ = contiguous_ && offsets_[i] == offsets_[i - 1] + 1;
+    }
+  }
+
+  size_t first_offset() const
+  {
+    return offsets_.empty() ? 0 : offsets_.front();
+  }
+
+  double * base_ = nullptr;
+  std::vector<size_t> offsets_;
+  bool contiguous_ = true;
+};
+
+}  // namespace hardware_interface
+
+#endif  // HARDWARE_INTERFACE__INTERFACE_VALUE_GROUP_HPP_
@@ -36,6 +36,8 @@ public:
   }
 };
 
+using BoundJointHandle = BoundHandle<JointHandle>;
+
 }  // namespace hardware_interface
 
 #endif  // HARDWARE_INTERFACE__JOINT_HANDLE_HPP_
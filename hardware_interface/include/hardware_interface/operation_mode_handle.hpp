@@ -16,6 +16,7 @@
 #define HARDWARE_INTERFACE__OPERATION_MODE_HANDLE_HPP_
 
 #include <string>
+#include <vector>
 
 #include "hardware_interface/visibility_control.h"
 
@@ -54,6 +55,10 @@ public:
   const std::string &
   get_name() const;
 
+  HARDWARE_INTERFACE_PUBLIC
+  OperationMode
+  get_mode() const;
+
   HARDWARE_INTERFACE_PUBLIC
   void
   set_mode(OperationMode mode);
@@ -66,6 +71,21 @@ private:
   OperationMode * mode_;
 };
 
+/// A change of the operation mode of one handle.
+struct OperationModeChange
+{
+  OperationModeHandle * handle;
+  OperationMode mode;
+};
+
+/// The changes of operation mode of the handles of one hardware component, applied at once.
+struct OperationModeBatch
+{
+  /// The name of the component, empty for the handles which belong to no component
+  std::string component_name;
+  std::vector<OperationModeChange> changes;
+};
+
 }  // namespace hardware_interface
 
 #endif  // HARDWARE_INTERFACE__OPERATION_MODE_HANDLE_HPP_
@@ -0,0 +1,153 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__PACKET_LAYOUT_HPP_
+#define HARDWARE_INTERFACE__PACKET_LAYOUT_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "hardware_interface/components/joint_values_batch.hpp"
+#include "hardware_interface/span.hpp"
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+#include "hardware_interface/visibility_control.h"
+
+namespace hardware_interface
+{
+
+/// How a value is represented in a packet.
+enum class PacketFieldType : std::uint8_t
+{
+  INT8,
+  UINT8,
+  INT16,
+  UINT16,
+  INT32,
+  UINT32,
+  FLOAT32,
+  FLOAT64,
+};
+
+enum class PacketByteOrder : std::uint8_t
+{
+  LITTLE,
+  /// The network byte order
+  BIG,
+};
+
+struct PacketField
+{
+  /// Offset of the first byte of the field in the packet
+  size_t offset = 0;
+  PacketFieldType type = PacketFieldType::FLOAT64;
+  PacketByteOrder byte_order = PacketByteOrder::LITTLE;
+  /// The value is raw * scale + bias, e.g. a scale of 0.001 for a position in milliradians
+  double scale = 1.0;
+  double bias = 0.0;
+};
+
+/**
+  * \brief Map the fields of the packets of a device to the values of a batch of joints.
+  * The fields are registered once with add_field(), resolved against the interfaces of the batch
+  * once with bind(), then decode() and encode() convert between the bytes of a packet and the
+  * values of the batch in place, without any intermediate buffer nor allocation, so they are
+  * called from the real-time thread.
+  * Integer fields are scaled, rounded and saturated when encoded, NaN is encoded as 0.
+  */
+class PacketLayout
+{
+public:
+  /// Register a field of the packet carrying the value of an interface of a joint.
+  /**
+   * \param[in] interface_name The interface, e.g. "position".
+   * \param[in] joint_index The index of the joint in the batch.
+   * \param[in] field Where and how the value is stored in the packet.
+   * \return The return code, one of `OK` or `ERROR` if the scale is zero, if the field overlaps
+   * a field already registered, or if the value is already mapped to a field.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type add_field(
+    const std::string & interface_name, size_t joint_index, const PacketField & field);
+
+  HARDWARE_INTERFACE_PUBLIC
+  size_t get_field_count() const;
+
+  /// Set the size of the packets, beyond the fields, e.g. for a header or a checksum.
+  HARDWARE_INTERFACE_PUBLIC
+  void set_packet_size(size_t packet_size);
+
+  /// Get the size of the packets, large enough for all the fields.
+  HARDWARE_INTERFACE_PUBLIC
+  size_t get_packet_size() const;
+
+  /// Resolve the fields against the interfaces and the joints of a batch.
+  /**
+   * \param[in] batch The batch the values are decoded into or encoded from.
+   * \return The return code, one of `OK`, `INTERFACE_NOT_FOUND` if an interface of a field is
+   * not in the batch, or `ERROR` if the joint of a field is not in the batch. The layout is not
+   * bound on error.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type bind(const components::JointValuesBatch & batch);
+
+  /// Whether bind() succeeded on a batch with the same interfaces and joint count, real-time safe.
+  HARDWARE_INTERFACE_PUBLIC
+  bool is_bound_to(const components::JointValuesBatch & batch) const;
+
+  /// Decode the fields of a packet into the values of the bound batch, real-time safe.
+  /**
+   * The values without a field are left untouched.
+   * \return The return code, one of `OK` or `ERROR` if not bound to the batch or if the packet
+   * is shorter than get_packet_size().
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type decode(Span<const uint8_t> packet, components::JointValuesBatch & values) const;
+
+  /// Encode the values of the bound batch into the fields of a packet, real-time safe.
+  /**
+   * The bytes without a field are left untouched.
+   * \return The return code, one of `OK` or `ERROR` if not bound to the batch or if the packet
+   * is shorter than get_packet_size().
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type encode(const components::JointValuesBatch & values, Span<uint8_t> packet) const;
+
+  /// Get the number of bytes of a field type.
+  HARDWARE_INTERFACE_PUBLIC
+  static size_t get_field_size(PacketFieldType type);
+
+private:
+  struct Mapping
+  {
+    std::string interface_name;
+    size_t joint_index;
+    PacketField field;
+    double inverse_scale;
+    /// Index of the value in the values of the bound batch
+    size_t value_index;
+  };
+
+  std::vector<Mapping> mappings_;
+  size_t fields_size_ = 0;
+  size_t packet_size_ = 0;
+
+  bool bound_ = false;
+  std::vector<std::string> bound_interfaces_;
+  size_t bound_joint_count_ = 0;
+};
+
+}  // namespace hardware_interface
+#endif  // HARDWARE_INTERFACE__PACKET_LAYOUT_HPP_
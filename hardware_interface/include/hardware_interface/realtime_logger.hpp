@@ -0,0 +1,150 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__REALTIME_LOGGER_HPP_
+#define HARDWARE_INTERFACE__REALTIME_LOGGER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "hardware_interface/visibility_control.h"
+
+namespace hardware_interface
+{
+/// Logs from real-time threads without blocking on the output.
+/**
+ * Messages are formatted into preallocated slots of a bounded lock-free queue, and printed by a
+ * background thread. Several threads may log at the same time, e.g. controllers updated in
+ * parallel. Logging never allocates nor blocks: when the queue is full, or more messages than
+ * allowed are logged within a rate limiting period, the message is dropped and counted, and the
+ * background thread reports the number of dropped messages.
+ */
+class RealtimeLogger
+{
+public:
+  enum class Severity
+  {
+    DEBUG,
+    INFO,
+    WARN,
+    ERROR
+  };
+
+  /// Prints a message in the background thread, by default through the rclcpp logging macros.
+  using Sink = std::function<void (Severity severity, const char * logger_name,
+      const char * message)>;
+
+  static constexpr size_t kMaxLoggerNameLength = 63;
+  static constexpr size_t kMaxMessageLength = 255;
+
+  /// Start the background thread.
+  /**
+   * \param[in] capacity The number of messages queued, rounded up to a power of two.
+   * \param[in] max_messages_per_period The number of messages logged per rate limiting period.
+   * \param[in] rate_limit_period The rate limiting period.
+   * \param[in] sink The output of the messages, the rclcpp logging macros if empty.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  explicit RealtimeLogger(
+    size_t capacity = 256, size_t max_messages_per_period = 100,
+    std::chrono::nanoseconds rate_limit_period = std::chrono::seconds(1), Sink sink = Sink());
+
+  /// Print the messages still queued and stop the background thread.
+  HARDWARE_INTERFACE_PUBLIC
+  ~RealtimeLogger();
+
+  RealtimeLogger(const RealtimeLogger &) = delete;
+  RealtimeLogger & operator=(const RealtimeLogger &) = delete;
+
+  /// Queue a printf-style message, longer names and messages are truncated.
+  /**
+   * \return false if the message was dropped.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  bool log(Severity severity, const char * logger_name, const char * format, ...)
+#if defined(__GNUC__)
+  __attribute__((format(printf, 4, 5)))
+#endif
+  ;
+
+  /// Block until all the messages queued before the call are printed.
+  HARDWARE_INTERFACE_PUBLIC
+  void flush();
+
+  /// The number of messages dropped since the logger was started.
+  HARDWARE_INTERFACE_PUBLIC
+  uint64_t get_dropped_count() const;
+
+private:
+  struct Slot
+  {
+    std::atomic<size_t> sequence;
+    Severity severity;
+    char logger_name[kMaxLoggerNameLength + 1];
+    char message[kMaxMessageLength + 1];
+  };
+
+  bool acquire_rate_limit_token();
+  bool print_next();
+  void drain_loop();
+
+  std::unique_ptr<Slot[]> slots_;
+  size_t mask_;
+  std::atomic<size_t> enqueue_position_{0};
+  /// Only used by the background thread, and by flush() to wait for it
+  std::atomic<size_t> dequeue_position_{0};
+
+  const uint64_t max_messages_per_period_;
+  const int64_t rate_limit_period_ns_;
+  std::atomic<int64_t> rate_limit_period_start_ns_{0};
+  std::atomic<uint64_t> messages_in_period_{0};
+
+  std::atomic<uint64_t> dropped_count_{0};
+  uint64_t reported_dropped_count_ = 0;
+
+  Sink sink_;
+  std::mutex mutex_;
+  std::condition_variable stop_cv_;
+  bool stop_ = false;
+  std::thread drain_thread_;
+};
+
+/// The real-time logger of the process, used by the RT log macros.
+/**
+ * Constructed on the first call, which should be done from a non real-time thread, e.g. when
+ * the hardware or the controller manager are set up.
+ */
+HARDWARE_INTERFACE_PUBLIC
+RealtimeLogger & get_realtime_logger();
+
+}  // namespace hardware_interface
+
+#define HARDWARE_INTERFACE_RT_LOG(severity, ...) \
+  ::hardware_interface::get_realtime_logger().log( \
+    ::hardware_interface::RealtimeLogger::Severity::severity, __VA_ARGS__)
+
+/// printf-style real-time safe logging, the first argument is the name of the logger
+#define HARDWARE_INTERFACE_RT_LOG_DEBUG(...) HARDWARE_INTERFACE_RT_LOG(DEBUG, __VA_ARGS__)
+#define HARDWARE_INTERFACE_RT_LOG_INFO(...) HARDWARE_INTERFACE_RT_LOG(INFO, __VA_ARGS__)
+#define HARDWARE_INTERFACE_RT_LOG_WARN(...) HARDWARE_INTERFACE_RT_LOG(WARN, __VA_ARGS__)
+#define HARDWARE_INTERFACE_RT_LOG_ERROR(...) HARDWARE_INTERFACE_RT_LOG(ERROR, __VA_ARGS__)
+
+#endif  // HARDWARE_INTERFACE__REALTIME_LOGGER_HPP_
@@ -0,0 +1,220 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__REALTIME_MEMORY_POOL_HPP_
+#define HARDWARE_INTERFACE__REALTIME_MEMORY_POOL_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "hardware_interface/visibility_control.h"
+
+namespace hardware_interface
+{
+/// Blocks taken from and given back to the pools by the threads charging an account.
+/**
+ * Written by the threads charging the account, with relaxed atomic increments, and read by any
+ * thread, e.g. to list the memory used by the updates of each controller. The bytes are the sizes
+ * of the blocks, rounded up to their size class.
+ */
+struct PoolAllocationAccount
+{
+  std::atomic<uint64_t> allocation_count{0};
+  std::atomic<uint64_t> allocated_bytes{0};
+  std::atomic<uint64_t> deallocation_count{0};
+  std::atomic<uint64_t> deallocated_bytes{0};
+};
+
+/// Charges the blocks allocated and freed by the calling thread, from any pool, to an account.
+/**
+ * Real-time safe, the account of the thread is restored when the scope ends, so that scopes nest.
+ */
+class ScopedPoolAllocationAccount
+{
+public:
+  /**
+   * \param[in] account The account charged until the end of the scope, which should outlive it,
+   * null to charge none.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  explicit ScopedPoolAllocationAccount(PoolAllocationAccount * account);
+
+  HARDWARE_INTERFACE_PUBLIC
+  ~ScopedPoolAllocationAccount();
+
+  ScopedPoolAllocationAccount(const ScopedPoolAllocationAccount &) = delete;
+  ScopedPoolAllocationAccount & operator=(const ScopedPoolAllocationAccount &) = delete;
+
+private:
+  PoolAllocationAccount * previous_;
+};
+
+/// Preallocated memory for the objects used by the control loop, pre-faulted and locked.
+/**
+ * The whole capacity is reserved when constructed, every page is written once so that it is
+ * backed by physical memory, and locked in RAM so that it is never paged out. Blocks are handed
+ * out by power of two size classes, and freed blocks are kept to be reused by the same size class,
+ * so the pool does not fragment when controllers are loaded and unloaded. The memory is only given
+ * back to the system when the pool is destroyed.
+ * Allocating takes a mutex, objects are meant to be allocated when configured, not in the cycle.
+ * The blocks are charged to the PoolAllocationAccount of the calling thread, if any.
+ */
+class RealtimeMemoryPool
+{
+public:
+  static constexpr size_t MIN_BLOCK_SIZE = 16;
+  static constexpr size_t MAX_ALIGNMENT = 64;
+
+  /// Reserve, pre-fault and optionally lock the memory of the pool.
+  /**
+   * \param[in] capacity The number of bytes of the pool, rounded up to whole pages.
+   * \param[in] lock_memory Whether to lock the memory in RAM, see is_locked().
+   * \throw std::bad_alloc if the memory could not be reserved.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  explicit RealtimeMemoryPool(size_t capacity, bool lock_memory = true);
+
+  HARDWARE_INTERFACE_PUBLIC
+  ~RealtimeMemoryPool();
+
+  RealtimeMemoryPool(const RealtimeMemoryPool &) = delete;
+  RealtimeMemoryPool & operator=(const RealtimeMemoryPool &) = delete;
+
+  /// Allocate a block of the size class of bytes.
+  /**
+   * \param[in] bytes The size of the block.
+   * \param[in] alignment The alignment of the block, a power of two up to MAX_ALIGNMENT.
+   * \throw std::bad_alloc if the pool is exhausted or the alignment is not supported.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  void * allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+  /// Give back a block to its size class, with the size it was allocated with.
+  HARDWARE_INTERFACE_PUBLIC
+  void deallocate(void * ptr, size_t bytes);
+
+  /// Whether the block was allocated from this pool.
+  HARDWARE_INTERFACE_PUBLIC
+  bool owns(const void * ptr) const;
+
+  HARDWARE_INTERFACE_PUBLIC
+  size_t get_capacity() const;
+
+  /// The number of bytes handed out at least once, including the ones freed since.
+  HARDWARE_INTERFACE_PUBLIC
+  size_t get_reserved_size() const;
+
+  /// Whether the memory is locked, it may not be if the process lacks the permission to.
+  HARDWARE_INTERFACE_PUBLIC
+  bool is_locked() const;
+
+private:
+  static constexpr size_t kSizeClassCount = 40;
+
+  char * begin_ = nullptr;
+  size_t capacity_ = 0;
+  bool locked_ = false;
+  bool mapped_ = false;
+
+  mutable std::mutex mutex_;
+  size_t next_ = 0;
+  /// Freed blocks of each size class, linked through their first bytes.
+  void * free_lists_[kSizeClassCount] = {};
+};
+
+/// Standard allocator taking the memory from a RealtimeMemoryPool, from the heap without a pool.
+/**
+ * Containers and objects allocated with it, e.g. with allocate_pooled(), should be destroyed
+ * before the pool. The pool propagates along with the container when it is copied, moved or
+ * swapped.
+ */
+template<typename T>
+class PoolAllocator
+{
+public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  PoolAllocator() noexcept = default;
+
+  explicit PoolAllocator(RealtimeMemoryPool * pool) noexcept
+  : pool_(pool)
+  {
+  }
+
+  template<typename U>
+  PoolAllocator(const PoolAllocator<U> & other) noexcept  // NOLINT(runtime/explicit)
+  : pool_(other.get_pool())
+  {
+  }
+
+  T * allocate(size_t n)
+  {
+    if (!pool_) {
+      return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+    return static_cast<T *>(pool_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T * ptr, size_t n) noexcept
+  {
+    if (!pool_) {
+      ::operator delete(ptr);
+      return;
+    }
+    pool_->deallocate(ptr, n * sizeof(T));
+  }
+
+  RealtimeMemoryPool * get_pool() const noexcept
+  {
+    return pool_;
+  }
+
+private:
+  RealtimeMemoryPool * pool_ = nullptr;
+};
+
+template<typename T, typename U>
+bool operator==(const PoolAllocator<T> & a, const PoolAllocator<U> & b) noexcept
+{
+  return a.get_pool() == b.get_pool();
+}
+
+template<typename T, typename U>
+bool operator!=(const PoolAllocator<T> & a, const PoolAllocator<U> & b) noexcept
+{
+  return !(a == b);
+}
+
+/// Create an object in a pool, along with its reference count, e.g. a hardware component.
+/**
+ * \param[in] pool The pool, which should outlive the object, null to create it on the heap.
+ */
+template<typename T, typename ... Args>
+std::shared_ptr<T> allocate_pooled(RealtimeMemoryPool * pool, Args && ... args)
+{
+  return std::allocate_shared<T>(PoolAllocator<T>(pool), std::forward<Args>(args)...);
+}
+
+}  // namespace hardware_interface
+
+#endif  // HARDWARE_INTERFACE__REALTIME_MEMORY_POOL_HPP_
@@ -0,0 +1,65 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__REALTIME_SECTION_HPP_
+#define HARDWARE_INTERFACE__REALTIME_SECTION_HPP_
+
+#include <cstdint>
+
+#include "hardware_interface/visibility_control.h"
+
+namespace hardware_interface
+{
+/// Marks the calling thread as running the real-time part of the control cycle, while in scope.
+/**
+ * Set around the read, update and write of the control cycle. Sections may be nested. Checked by
+ * the realtime_heap_trap library, which aborts on any allocation from the default heap inside a
+ * section when linked into a debug or test executable, and costs nothing otherwise.
+ * Also checked by the realtime_violation_detector library, preloaded into tests, which reports the
+ * allocations, mutex locks, sleeps and blocking system calls made inside a section.
+ */
+class RealtimeSection
+{
+public:
+  HARDWARE_INTERFACE_PUBLIC
+  RealtimeSection();
+
+  HARDWARE_INTERFACE_PUBLIC
+  ~RealtimeSection();
+
+  RealtimeSection(const RealtimeSection &) = delete;
+  RealtimeSection & operator=(const RealtimeSection &) = delete;
+
+  /// Whether the calling thread is inside a section, real-time safe.
+  HARDWARE_INTERFACE_PUBLIC
+  static bool is_active();
+
+  /// Whether the realtime_violation_detector library is preloaded into the process.
+  HARDWARE_INTERFACE_PUBLIC
+  static bool is_checked();
+
+  /**
+   * Number of violations the realtime_violation_detector library reported since the process
+   * started or since the last reset, 0 if it is not preloaded.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  static uint64_t get_violation_count();
+
+  HARDWARE_INTERFACE_PUBLIC
+  static void reset_violation_count();
+};
+
+}  // namespace hardware_interface
+
+#endif  // HARDWARE_INTERFACE__REALTIME_SECTION_HPP_
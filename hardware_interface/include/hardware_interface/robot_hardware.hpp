@@ -15,16 +15,34 @@
 #ifndef HARDWARE_INTERFACE__ROBOT_HARDWARE_HPP_
 #define HARDWARE_INTERFACE__ROBOT_HARDWARE_HPP_
 
+#include <cstdint>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "control_msgs/msg/dynamic_joint_state.hpp"
 #include "hardware_interface/actuator_handle.hpp"
+#include "hardware_interface/clock_domain_map.hpp"
+#include "hardware_interface/controller_info.hpp"
+#include "hardware_interface/hardware_freshness.hpp"
+#include "hardware_interface/interface_lookup_index.hpp"
+#include "hardware_interface/interface_type_id.hpp"
+#include "hardware_interface/interface_value_arena.hpp"
+#include "hardware_interface/interface_value_group.hpp"
 #include "hardware_interface/joint_handle.hpp"
 #include "hardware_interface/operation_mode_handle.hpp"
+#include "hardware_interface/realtime_memory_pool.hpp"
 #include "hardware_interface/robot_hardware_interface.hpp"
+#include "hardware_interface/span.hpp"
+#include "hardware_interface/sync_event_source.hpp"
+#include "hardware_interface/typed_handle.hpp"
+#include "hardware_interface/typed_value_arena.hpp"
 #include "hardware_interface/types/hardware_interface_return_values.hpp"
+#include "hardware_interface/types/hardware_interface_switch_state_values.hpp"
 #include "hardware_interface/visibility_control.h"
 
 namespace hardware_interface
@@ -39,10 +57,25 @@ public:
   virtual
   ~RobotHardware() = default;
 
+  /// Register an operation mode handle which belongs to no hardware component.
   HARDWARE_INTERFACE_PUBLIC
   return_type
   register_operation_mode_handle(OperationModeHandle * operation_mode);
 
+  /// Register the operation mode handle of a joint of a hardware component.
+  /**
+   * The changes of operation mode of the handles of a component are applied together, in one
+   * call of apply_operation_modes(). Called in a non real-time thread, e.g. in init().
+   * \param[in] operation_mode The handle, valid for the lifetime of this object.
+   * \param[in] component_name The name of the hardware component the joint belongs to.
+   * \return The return code, one of `OK` or `ERROR` if the handle is broken or already
+   * registered.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type
+  register_operation_mode_handle(
+    OperationModeHandle * operation_mode, const std::string & component_name);
+
   HARDWARE_INTERFACE_PUBLIC
   return_type
   get_operation_mode_handle(const std::string & name, OperationModeHandle ** operation_mode_handle);
@@ -55,31 +88,175 @@ public:
   std::vector<OperationModeHandle *>
   get_registered_operation_mode_handles();
 
+  /// Request the operation modes of several handles at once, real-time safe.
+  /**
+   * The changes are grouped by hardware component, and apply_operation_modes() is called once
+   * per component with all of its changes, in the order the components were registered.
+   * \param[in] modes The names of the handles with their new modes, a handle given twice takes
+   * the last of its modes.
+   * \return The return code, one of `OK`, or `ERROR` if a handle is not registered, no mode is
+   * then changed, or if a component failed to apply its changes.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type request_operation_modes(
+    const std::vector<std::pair<std::string, OperationMode>> & modes);
+
+  /// Apply the changes of operation mode of the handles of one hardware component.
+  /**
+   * Called in the real-time thread by request_operation_modes() and the default perform_switch(),
+   * so that a driver applies all the changes of a component in a single transaction, e.g. one
+   * bus frame for all the drives of an arm. Should not block nor allocate. Sets the mode of each
+   * handle by default.
+   * \param[in] batch The changes of the component, each handle at most once.
+   * \return The return code, one of `OK` or `ERROR`.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual return_type apply_operation_modes(const OperationModeBatch & batch);
+
   HARDWARE_INTERFACE_PUBLIC
   hardware_interface_ret_t register_actuator(
     const std::string & actuator_name, const std::string & interface_name,
     double default_value = 0.0);
 
+  /// Register an actuator interface by interned type, e.g. HW_IF_POSITION_ID.
+  HARDWARE_INTERFACE_PUBLIC
+  hardware_interface_ret_t register_actuator(
+    const std::string & actuator_name, InterfaceTypeId interface_type,
+    double default_value = 0.0);
+
   HARDWARE_INTERFACE_PUBLIC
   hardware_interface_ret_t register_joint(
     const std::string & joint_name, const std::string & interface_name, double default_value = 0.0);
 
+  /// Register a joint interface by interned type, e.g. HW_IF_POSITION_ID.
+  HARDWARE_INTERFACE_PUBLIC
+  hardware_interface_ret_t register_joint(
+    const std::string & joint_name, InterfaceTypeId interface_type, double default_value = 0.0);
+
+  /// Register a joint interface stored in its own type rather than as a double.
+  /**
+   * E.g. a float for each taxel of a tactile skin, a uint16_t for the status word of a drive or
+   * a bool for a digital input. The value is stored in a TypedValueArena, it is not part of the
+   * registered joints and is only accessed by get_typed_joint_handle().
+   * \param[in] joint_name The name of the joint.
+   * \param[in] interface_name The name of the interface, a command if it ends with "_command".
+   * \param[in] default_value The value until the hardware or a controller writes it.
+   * \return The return code, one of `OK` or `ERROR` if the registration is frozen or the
+   * interface is already registered, as a double or as a typed value.
+   */
+  template<typename T>
+  hardware_interface_ret_t register_typed_joint(
+    const std::string & joint_name, const std::string & interface_name, T default_value = T())
+  {
+    if (!can_register_typed_joint(joint_name, interface_name)) {
+      return return_type::ERROR;
+    }
+    registered_typed_joint_values_.register_value(joint_name, interface_name, default_value);
+    return return_type::OK;
+  }
+
   HARDWARE_INTERFACE_PUBLIC
   hardware_interface_ret_t get_actuator_handle(ActuatorHandle & actuator_handle);
 
   HARDWARE_INTERFACE_PUBLIC
   hardware_interface_ret_t get_joint_handle(JointHandle & joint_handle);
 
+  /// Resolve the id of an actuator interface once, to get its handle by id afterwards.
+  HARDWARE_INTERFACE_PUBLIC
+  hardware_interface_ret_t get_actuator_interface_id(
+    const std::string & actuator_name, const std::string & interface_name,
+    InterfaceId & interface_id) const;
+
+  /// Resolve the id of an actuator interface by interned type, with a single string lookup.
+  HARDWARE_INTERFACE_PUBLIC
+  hardware_interface_ret_t get_actuator_interface_id(
+    const std::string & actuator_name, InterfaceTypeId interface_type,
+    InterfaceId & interface_id) const;
+
+  /// Resolve the id of a joint interface once, to get its handle by id afterwards.
+  HARDWARE_INTERFACE_PUBLIC
+  hardware_interface_ret_t get_joint_interface_id(
+    const std::string & joint_name, const std::string & interface_name,
+    InterfaceId & interface_id) const;
+
+  /// Resolve the id of a joint interface by interned type, with a single string lookup.
+  HARDWARE_INTERFACE_PUBLIC
+  hardware_interface_ret_t get_joint_interface_id(
+    const std::string & joint_name, InterfaceTypeId interface_type,
+    InterfaceId & interface_id) const;
+
+  /// Get an actuator handle by id, without any string lookup.
+  HARDWARE_INTERFACE_PUBLIC
+  hardware_interface_ret_t get_actuator_handle(
+    const InterfaceId & interface_id, ActuatorHandle & actuator_handle);
+
+  /// Get a joint handle by id, without any string lookup.
+  HARDWARE_INTERFACE_PUBLIC
+  hardware_interface_ret_t get_joint_handle(
+    const InterfaceId & interface_id, JointHandle & joint_handle);
+
+  /// Get an actuator handle by id for the hardware, reading the published commands.
+  /**
+   * Command handles point into the copy of the commands updated by publish_commands(), so that
+   * write() only sees complete cycles of commands, state handles are the same as with
+   * get_actuator_handle(). Before the registration is frozen, the same as get_actuator_handle().
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  hardware_interface_ret_t get_published_actuator_handle(
+    const InterfaceId & interface_id, ActuatorHandle & actuator_handle);
+
+  /// Get a joint handle by id for the hardware, reading the published commands.
+  /**
+   * Command handles point into the copy of the commands updated by publish_commands(), so that
+   * write() only sees complete cycles of commands, state handles are the same as with
+   * get_joint_handle(). Before the registration is frozen, the same as get_joint_handle().
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  hardware_interface_ret_t get_published_joint_handle(
+    const InterfaceId & interface_id, JointHandle & joint_handle);
+
+  /// Get the handle of a typed joint interface, once the registration is frozen.
+  /**
+   * \param[in,out] handle The handle, named after the joint and the interface, of the type the
+   * interface was registered with.
+   * \return The return code, one of `OK` or `ERROR` if the registration is not frozen or the
+   * interface is not registered with the type of the handle.
+   */
+  template<typename T>
+  hardware_interface_ret_t get_typed_joint_handle(TypedHandle<T> & handle)
+  {
+    return resolve_typed_joint_handle(handle, false);
+  }
+
+  /// Get the handle of a typed joint interface for the hardware, reading the published commands.
+  template<typename T>
+  hardware_interface_ret_t get_published_typed_joint_handle(TypedHandle<T> & handle)
+  {
+    return resolve_typed_joint_handle(handle, true);
+  }
+
   HARDWARE_INTERFACE_PUBLIC
   hardware_interface_ret_t get_actuator_handles(
     std::vector<ActuatorHandle> & actuator_handles,
     const std::string & interface_name);
 
+  /// Get the handles of all the actuators with an interface type, without comparing strings.
+  HARDWARE_INTERFACE_PUBLIC
+  hardware_interface_ret_t get_actuator_handles(
+    std::vector<ActuatorHandle> & actuator_handles,
+    InterfaceTypeId interface_type);
+
   HARDWARE_INTERFACE_PUBLIC
   hardware_interface_ret_t get_joint_handles(
     std::vector<JointHandle> & joint_handles,
     const std::string & interface_name);
 
+  /// Get the handles of all the joints with an interface type, without comparing strings.
+  HARDWARE_INTERFACE_PUBLIC
+  hardware_interface_ret_t get_joint_handles(
+    std::vector<JointHandle> & joint_handles,
+    InterfaceTypeId interface_type);
+
   HARDWARE_INTERFACE_PUBLIC
   const std::vector<std::string> & get_registered_actuator_names();
 
@@ -100,11 +277,355 @@ public:
   HARDWARE_INTERFACE_PUBLIC
   std::vector<JointHandle> get_registered_joints();
 
+  /// Freeze the registration of actuators and joints.
+  /**
+   * Lays out the values of all the registered interfaces in contiguous arenas, one for the
+   * actuators and one for the joints. Handles retrieved afterwards point into the arenas and
+   * stay valid for the lifetime of this object. No more actuators or joints can be registered.
+   * \return The return code, one of `OK` or `ERROR` if already frozen.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type freeze_registration();
+
+  /// Allocate the arenas from a pre-faulted and locked pool when the registration is frozen.
+  /**
+   * \param[in] pool The pool, kept alive by this object, null to allocate from the heap.
+   * \return The return code, one of `OK` or `ERROR` if the registration is already frozen.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type set_memory_pool(std::shared_ptr<RealtimeMemoryPool> pool);
+
+  HARDWARE_INTERFACE_PUBLIC
+  std::shared_ptr<RealtimeMemoryPool> get_memory_pool() const;
+
+  /// Share the freshness of the data read from the hardware components.
+  /**
+   * Updated by the controller manager at the start of each update, and tested by the controllers
+   * against the components of their joints. Called in a non real-time thread, before the
+   * controllers are configured.
+   * \param[in] freshness The tracker the components record their reads in, null for none.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  void set_hardware_freshness(std::shared_ptr<HardwareFreshness> freshness);
+
+  /// Get the freshness of the data read from the hardware components, null if not tracked.
+  HARDWARE_INTERFACE_PUBLIC
+  const std::shared_ptr<HardwareFreshness> & get_hardware_freshness() const;
+
+  /// Share the clock domains of the hardware components.
+  /**
+   * Used by the controllers to convert the acquisition stamps of the states of their joints to
+   * steady times. Called in a non real-time thread, before the controllers are configured.
+   * \param[in] clock_domains The domains the components feed, null for none.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  void set_clock_domains(std::shared_ptr<ClockDomainMap> clock_domains);
+
+  /// Get the clock domains of the hardware components, null if none.
+  HARDWARE_INTERFACE_PUBLIC
+  const std::shared_ptr<ClockDomainMap> & get_clock_domains() const;
+
+  /// Share the sync events of the hardware bus the control loop is phase-locked to.
+  /**
+   * Called in a non real-time thread, before the control loop is started, e.g. in init() by a
+   * robot hardware driving an EtherCAT master.
+   * \param[in] sync_event_source The source notified by the components, null for none.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  void set_sync_event_source(std::shared_ptr<SyncEventSource> sync_event_source);
+
+  /// Get the sync events of the hardware bus, null if the control loop runs on its own clock.
+  HARDWARE_INTERFACE_PUBLIC
+  const std::shared_ptr<SyncEventSource> & get_sync_event_source() const;
+
+  HARDWARE_INTERFACE_PUBLIC
+  bool is_registration_frozen() const;
+
+  /// Get the values of all the actuator interfaces, only laid out once the registration is frozen.
+  HARDWARE_INTERFACE_PUBLIC
+  InterfaceValueArena & get_actuator_values();
+
+  /// Get the values of all the joint interfaces, only laid out once the registration is frozen.
+  HARDWARE_INTERFACE_PUBLIC
+  InterfaceValueArena & get_joint_values();
+
+  /// Get the values of all the typed joint interfaces, only laid out once the registration is
+  /// frozen.
+  HARDWARE_INTERFACE_PUBLIC
+  TypedValueArena & get_typed_joint_values();
+
+  /// Name the values of the actuator arena, its padding between the state and command regions
+  /// included.
+  /**
+   * \return One "actuator/interface" name per value of the arena, in the order of the values,
+   * empty for padding. Empty before the registration is frozen.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  std::vector<std::string> get_actuator_value_names();
+
+  /// Name the values of the joint arena, see get_actuator_value_names().
+  HARDWARE_INTERFACE_PUBLIC
+  std::vector<std::string> get_joint_value_names();
+
+  /// Publish the commands written by the controllers to the hardware, real-time safe.
+  /**
+   * Copies the command values of all the arenas at once, called by the controller manager at the
+   * end of its update. Does nothing before the registration is frozen.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  void publish_commands();
+
+  /// Resolve the values of one interface of a group of actuators, to copy them at once afterwards.
+  /**
+   * Called in a non real-time thread once the registration is frozen, e.g. when a controller is
+   * configured.
+   * \param[in] actuator_names The actuators of the group, in the order of the values.
+   * \param[in] interface_name The interface of the actuators, e.g. "position".
+   * \param[out] group The resolved group, valid for the lifetime of this object.
+   * \return The return code, one of `OK` or `ERROR` if the registration is not frozen or one of
+   * the actuators does not have the interface.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type get_actuator_value_group(
+    const std::vector<std::string> & actuator_names, const std::string & interface_name,
+    InterfaceValueGroup & group);
+
+  /// Resolve the values of one interface type of a group of actuators, e.g. HW_IF_POSITION_ID.
+  HARDWARE_INTERFACE_PUBLIC
+  return_type get_actuator_value_group(
+    const std::vector<std::string> & actuator_names, InterfaceTypeId interface_type,
+    InterfaceValueGroup & group);
+
+  /// Resolve the values of one interface of a group of joints, to copy them at once afterwards.
+  /**
+   * Called in a non real-time thread once the registration is frozen, e.g. when a controller is
+   * configured.
+   * \param[in] joint_names The joints of the group, in the order of the values.
+   * \param[in] interface_name The interface of the joints, e.g. "position".
+   * \param[out] group The resolved group, valid for the lifetime of this object.
+   * \return The return code, one of `OK` or `ERROR` if the registration is not frozen or one of
+   * the joints does not have the interface.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type get_joint_value_group(
+    const std::vector<std::string> & joint_names, const std::string & interface_name,
+    InterfaceValueGroup & group);
+
+  /// Resolve the values of one interface type of a group of joints, e.g. HW_IF_POSITION_ID.
+  HARDWARE_INTERFACE_PUBLIC
+  return_type get_joint_value_group(
+    const std::vector<std::string> & joint_names, InterfaceTypeId interface_type,
+    InterfaceValueGroup & group);
+
+  /// Copy the values of a group of actuators, real-time safe.
+  /**
+   * \param[in] group A group resolved by get_actuator_value_group().
+   * \param[out] values The values, as many as the group has actuators.
+   * \return The return code, one of `OK` or `INTERFACE_VALUE_SIZE_NOT_EQUAL`.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type get_actuator_values(const InterfaceValueGroup & group, Span<double> values) const;
+
+  /// Set the values of a group of actuators, real-time safe.
+  HARDWARE_INTERFACE_PUBLIC
+  return_type set_actuator_values(const InterfaceValueGroup & group, Span<const double> values);
+
+  /// Copy the values of a group of joints, real-time safe.
+  /**
+   * \param[in] group A group resolved by get_joint_value_group().
+   * \param[out] values The values, as many as the group has joints.
+   * \return The return code, one of `OK` or `INTERFACE_VALUE_SIZE_NOT_EQUAL`.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type get_joint_values(const InterfaceValueGroup & group, Span<double> values) const;
+
+  /// Set the values of a group of joints, real-time safe.
+  HARDWARE_INTERFACE_PUBLIC
+  return_type set_joint_values(const InterfaceValueGroup & group, Span<const double> values);
+
+  /// Register a reference interface, a value written by a controller for another controller.
+  /**
+   * Lets cascaded controllers pass values in memory within the same control cycle, e.g. the
+   * upstream controller writes the position references of the downstream one. The value is owned
+   * by the controller exporting it and is not part of the arenas, so references may be registered
+   * after the registration is frozen. Called in a non real-time thread.
+   * \param[in] reference_name The name of the reference, "<exporting controller>/<joint>".
+   * \param[in] interface_name The name of the interface, e.g. "position".
+   * \param[in] value The storage of the value, valid until the reference is unregistered.
+   * \return The return code, one of `OK` or `ERROR` if the value is null or the reference is
+   * already registered.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  hardware_interface_ret_t register_reference_interface(
+    const std::string & reference_name, const std::string & interface_name, double * value);
+
+  /// Unregister a reference interface, the handles retrieved before must not be used anymore.
+  HARDWARE_INTERFACE_PUBLIC
+  hardware_interface_ret_t unregister_reference_interface(
+    const std::string & reference_name, const std::string & interface_name);
+
+  /// Get the handle of a registered reference interface, called in a non real-time thread.
+  HARDWARE_INTERFACE_PUBLIC
+  hardware_interface_ret_t get_reference_handle(JointHandle & reference_handle);
+
+  /// Check whether the hardware can switch to the interfaces claimed by the controllers.
+  /**
+   * Called in a non real-time thread before a controller switch is requested, the switch is
+   * rejected unless this succeeds. Does nothing by default.
+   * \param[in] start_list The controllers to be started.
+   * \param[in] stop_list The controllers to be stopped.
+   * \return The return code, one of `OK` or `ERROR` if the switch is not feasible.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual return_type prepare_switch(
+    const std::vector<ControllerInfo> & start_list, const std::vector<ControllerInfo> & stop_list);
+
+  /// Switch the hardware to the interfaces claimed by the controllers.
+  /**
+   * Called in the real-time thread, before the controllers are stopped and started, with the
+   * lists a successful prepare_switch() was called with. Should not block nor allocate, a switch
+   * taking several cycles is only started here and then polled with get_switch_state(). By
+   * default, activates the operation modes of the joints claimed by the started controllers and
+   * deactivates those of the joints only claimed by the stopped ones, see
+   * request_operation_modes(), the joints without operation mode handle are left out.
+   * \param[in] start_list The controllers to be started.
+   * \param[in] stop_list The controllers to be stopped.
+   * \return The return code, one of `OK` or `ERROR` to abort the switch.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual return_type perform_switch(
+    const std::vector<ControllerInfo> & start_list, const std::vector<ControllerInfo> & stop_list);
+
+  /// Get the state of the switch started by the last perform_switch().
+  /**
+   * Polled in the real-time thread on every cycle until the switch is done, the controllers are
+   * started once it is `DONE` and aborted if it is `ERROR`. Should not block. `DONE` by default.
+   * \return The state of the switch.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual switch_state get_switch_state() const;
+
+  /// Get the state of the switch of the interfaces claimed by one controller.
+  /**
+   * Polled instead of get_switch_state() for the controllers started as soon as their own
+   * interfaces are switched. The state of the whole switch by default.
+   * \param[in] controller The controller to be started.
+   * \return The state of the switch of its interfaces.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual switch_state get_switch_state(const ControllerInfo & controller) const;
+
+  /// Set the bits of some joint interface values, one bit per value of the joint arena.
+  /**
+   * Bit i of the mask, bit i % 64 of word i / 64, stands for the value at offset i of the joint
+   * arena, see InterfaceValueArena::get_offset(). Called in a non real-time thread, once the
+   * registration is frozen.
+   * \param[in] interfaces The names of the joints grouped by interface, as the resources of
+   * ControllerInfo, the names which are not joint interfaces, e.g. reference interfaces, are left
+   * out.
+   * \param[in,out] mask The bits to set, resized to get_joint_value_mask_size() words.
+   * \return The return code, one of `OK` or `ERROR` if the registration is not frozen.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type get_joint_value_mask(
+    const std::map<std::string, std::vector<std::string>> & interfaces,
+    std::vector<uint64_t> & mask) const;
+
+  /// Set the bits of all the joint state values, or of all the joint command values.
+  HARDWARE_INTERFACE_PUBLIC
+  return_type get_joint_value_mask(bool commands, std::vector<uint64_t> & mask) const;
+
+  /// Number of words of the joint value masks, 0 until the registration is frozen.
+  HARDWARE_INTERFACE_PUBLIC
+  size_t get_joint_value_mask_size() const;
+
+  /// Hand the joint interface values claimed by the active controllers to the hardware.
+  /**
+   * Called by the controller manager in the real-time thread, right after a successful
+   * perform_switch(), with the state values read and the command values written by the
+   * controllers active once the switch is done. The hardware may then skip reading and decoding
+   * the other values, e.g. remap the frames of a bus to transfer only the claimed ones. Copies the
+   * mask without allocating by default, for is_joint_value_claimed(). All the values are claimed
+   * until the first switch.
+   * \param[in] mask The bits of the claimed values, see get_joint_value_mask().
+   * \return The return code, one of `OK` or `ERROR` if the mask is not the size of the masks.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual return_type set_claimed_joint_values(Span<const uint64_t> mask);
+
+  /// Get the bits of the joint interface values claimed by the active controllers.
+  HARDWARE_INTERFACE_PUBLIC
+  Span<const uint64_t> get_claimed_joint_values() const;
+
+  /// Whether the joint value at an offset of the joint arena is claimed, real-time safe.
+  HARDWARE_INTERFACE_PUBLIC
+  bool is_joint_value_claimed(size_t offset) const
+  {
+    return offset / 64 < claimed_joint_values_.size() &&
+           ((claimed_joint_values_[offset / 64] >> (offset % 64)) & 1u);
+  }
+
 private:
+  HARDWARE_INTERFACE_PUBLIC
+  bool can_register_typed_joint(const std::string & joint_name, const std::string & interface_name);
+
+  HARDWARE_INTERFACE_PUBLIC
+  void log_typed_joint_not_found(
+    const std::string & joint_name, const std::string & interface_name) const;
+
+  template<typename T>
+  hardware_interface_ret_t resolve_typed_joint_handle(TypedHandle<T> & handle, bool published)
+  {
+    T * value_ptr = published ?
+      registered_typed_joint_values_.get_published_value_ptr<T>(
+      handle.get_name(), handle.get_interface_name()) :
+      registered_typed_joint_values_.get_value_ptr<T>(
+      handle.get_name(), handle.get_interface_name());
+    if (value_ptr == nullptr) {
+      log_typed_joint_not_found(handle.get_name(), handle.get_interface_name());
+      return return_type::ERROR;
+    }
+    handle = handle.with_value_ptr(value_ptr);
+    return return_type::OK;
+  }
+
+  /// Stage the change of operation mode of a handle in the batch of its component
+  bool stage_operation_mode(const std::string & name, OperationMode mode);
+  return_type apply_staged_operation_modes();
+  void clear_staged_operation_modes();
+
   std::vector<OperationModeHandle *> registered_operation_mode_handles_;
+  /// Index of each operation mode handle by name
+  std::unordered_map<std::string, size_t> operation_mode_index_;
+  /// Index of the batch of the component of each handle
+  std::vector<size_t> operation_mode_components_;
+  /// Index of the staged change of each handle in its batch
+  std::vector<size_t> staged_operation_modes_;
+  /// One batch per component, reserved for all of its handles
+  std::vector<OperationModeBatch> operation_mode_batches_;
 
   control_msgs::msg::DynamicJointState registered_actuators_;
   control_msgs::msg::DynamicJointState registered_joints_;
+
+  /// Destroyed after the arenas allocated from it
+  std::shared_ptr<RealtimeMemoryPool> memory_pool_;
+  InterfaceValueArena registered_actuator_values_;
+  InterfaceValueArena registered_joint_values_;
+  TypedValueArena registered_typed_joint_values_;
+
+  std::shared_ptr<HardwareFreshness> hardware_freshness_;
+  std::shared_ptr<ClockDomainMap> clock_domains_;
+  std::shared_ptr<SyncEventSource> sync_event_source_;
+
+  InterfaceLookupIndex registered_actuator_index_;
+  InterfaceLookupIndex registered_joint_index_;
+  /// Bits of the joint values claimed by the active controllers, sized when frozen
+  std::vector<uint64_t> claimed_joint_values_;
+
+  /// Storage of the reference interfaces by reference and interface name
+  std::map<std::pair<std::string, std::string>, double *> registered_references_;
+  /// Protects the reference interfaces, exported while other controllers are loaded in parallel
+  mutable std::mutex references_mutex_;
 };
 
 using RobotHardwareSharedPtr = std::shared_ptr<RobotHardware>;
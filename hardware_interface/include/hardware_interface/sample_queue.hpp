@@ -0,0 +1,180 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__SAMPLE_QUEUE_HPP_
+#define HARDWARE_INTERFACE__SAMPLE_QUEUE_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "hardware_interface/span.hpp"
+
+namespace hardware_interface
+{
+/// Contiguous view over consecutive samples of the same size, oldest first.
+class SampleSpan
+{
+public:
+  SampleSpan() = default;
+
+  SampleSpan(
+    Span<const double> values, Span<const std::chrono::nanoseconds> stamps, size_t sample_size)
+  : values_(values), stamps_(stamps), sample_size_(sample_size)
+  {
+  }
+
+  /// Number of samples.
+  size_t size() const
+  {
+    return stamps_.size();
+  }
+
+  bool empty() const
+  {
+    return stamps_.empty();
+  }
+
+  /// Number of values per sample.
+  size_t get_sample_size() const
+  {
+    return sample_size_;
+  }
+
+  /// Values of one sample.
+  Span<const double> operator[](size_t index) const
+  {
+    return Span<const double>(values_.data() + index * sample_size_, sample_size_);
+  }
+
+  /// Values of all the samples, one after the other.
+  Span<const double> get_values() const
+  {
+    return values_;
+  }
+
+  /// Acquisition times of the samples.
+  Span<const std::chrono::nanoseconds> get_stamps() const
+  {
+    return stamps_;
+  }
+
+private:
+  Span<const double> values_;
+  Span<const std::chrono::nanoseconds> stamps_;
+  size_t sample_size_ = 0;
+};
+
+/// Bounded wait-free queue of timestamped samples between one producer and one consumer thread.
+/**
+ * All the storage is allocated at construction. A sample pushed while the queue is full is
+ * dropped and counted, the queued samples are never overwritten so that the consumer does not
+ * have to synchronize with the producer while copying them.
+ */
+class SampleQueue
+{
+public:
+  SampleQueue(size_t sample_size, size_t capacity)
+  : sample_size_(sample_size),
+    capacity_(capacity),
+    values_(sample_size * capacity),
+    stamps_(capacity)
+  {
+  }
+
+  SampleQueue(const SampleQueue &) = delete;
+  SampleQueue & operator=(const SampleQueue &) = delete;
+
+  size_t get_sample_size() const
+  {
+    return sample_size_;
+  }
+
+  size_t get_capacity() const
+  {
+    return capacity_;
+  }
+
+  /// Push a sample, from the producer thread.
+  /**
+   * \return false if the sample is not of the sample size or the queue is full, the sample is
+   * then dropped.
+   */
+  bool push(Span<const double> sample, std::chrono::nanoseconds stamp)
+  {
+    const auto tail = tail_.load(std::memory_order_relaxed);
+    if (sample.size() != sample_size_ ||
+      tail - head_.load(std::memory_order_acquire) >= capacity_)
+    {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    const auto slot = static_cast<size_t>(tail % capacity_);
+    std::copy(sample.begin(), sample.end(), values_.begin() + slot * sample_size_);
+    stamps_[slot] = stamp;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Pop the oldest samples, from the consumer thread.
+  /**
+   * \param[out] values The values of the popped samples, one after the other, its size bounds
+   * the number of samples popped.
+   * \param[out] stamps The acquisition times of the popped samples, its size bounds the number of
+   * samples popped.
+   * \return The number of popped samples.
+   */
+  size_t pop(Span<double> values, Span<std::chrono::nanoseconds> stamps)
+  {
+    const auto head = head_.load(std::memory_order_relaxed);
+    const auto available = tail_.load(std::memory_order_acquire) - head;
+    const auto max_count = sample_size_ > 0 ? values.size() / sample_size_ : stamps.size();
+    const auto count = static_cast<size_t>(
+      std::min<uint64_t>(available, std::min(max_count, stamps.size())));
+    for (size_t i = 0; i < count; ++i) {
+      const auto slot = static_cast<size_t>((head + i) % capacity_);
+      std::copy_n(
+        values_.begin() + slot * sample_size_, sample_size_, values.begin() + i * sample_size_);
+      stamps[i] = stamps_[slot];
+    }
+    head_.store(head + count, std::memory_order_release);
+    return count;
+  }
+
+  /// Number of samples dropped because the queue was full, since construction.
+  uint64_t get_dropped_count() const
+  {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+private:
+  static constexpr size_t CACHE_LINE_SIZE = 64;
+
+  const size_t sample_size_;
+  const size_t capacity_;
+  std::vector<double> values_;
+  std::vector<std::chrono::nanoseconds> stamps_;
+  /// Number of samples popped, written by the consumer
+  alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head_{0};
+  /// Number of samples pushed, written by the producer
+  alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> tail_{0};
+  std::atomic<uint64_t> dropped_{0};
+};
+
+}  // namespace hardware_interface
+
+#endif  // HARDWARE_INTERFACE__SAMPLE_QUEUE_HPP_
@@ -20,6 +20,8 @@
 #include <utility>
 #include <vector>
 
+#include "hardware_interface/clock_domain_map.hpp"
+#include "hardware_interface/hardware_freshness.hpp"
 #include "hardware_interface/hardware_info.hpp"
 #include "hardware_interface/types/hardware_interface_return_values.hpp"
 #include "hardware_interface/types/hardware_interface_status_values.hpp"
@@ -55,11 +57,38 @@ public:
   HARDWARE_INTERFACE_PUBLIC
   status get_status() const;
 
+  /// Record the successful reads of the component in a freshness tracker.
+  /**
+   * Called before the component is read. Once started, the component is then reported
+   * status::TIMED_OUT while its data is stale.
+   * \param[in] freshness The tracker, null to stop recording.
+   * \param[in] component The index of the component in the tracker.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  void set_freshness(std::shared_ptr<HardwareFreshness> freshness, size_t component);
+
+  /// Feed the clock domain of the component with its pairs of device and steady times.
+  /**
+   * Called before the component is read, the pairs are then taken after each successful read.
+   * \param[in] clock_domains The domains, null to stop feeding.
+   * \param[in] domain The index of the domain of the component.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  void set_clock_domain(std::shared_ptr<ClockDomainMap> clock_domains, size_t domain);
+
+  /// Read the sensors, then filter their states with their filter chain, once per cycle.
   HARDWARE_INTERFACE_PUBLIC
   return_type read_sensors(const std::vector<std::shared_ptr<components::Sensor>> & sensors);
 
 private:
+  /// Records a successful read in the freshness tracker and the clock domain, returns ret.
+  return_type record_read(return_type ret);
+
   std::unique_ptr<SensorHardwareInterface> impl_;
+  std::shared_ptr<HardwareFreshness> freshness_;
+  size_t freshness_component_ = 0;
+  std::shared_ptr<ClockDomainMap> clock_domains_;
+  size_t clock_domain_ = 0;
 };
 
 }  // namespace hardware_interface
@@ -15,6 +15,7 @@
 #ifndef HARDWARE_INTERFACE__SENSOR_HARDWARE_INTERFACE_HPP_
 #define HARDWARE_INTERFACE__SENSOR_HARDWARE_INTERFACE_HPP_
 
+#include <chrono>
 #include <memory>
 #include <vector>
 
@@ -90,6 +91,26 @@ public:
   virtual
   return_type read_sensors(const std::vector<std::shared_ptr<components::Sensor>> & sensors) const =
   0;
+
+  /**
+   * \brief Get the latest pair of device and steady times of the sensor, for the ClockDomainMap
+   * of its device clock, e.g. the distributed clock time of the last frame and the steady time it
+   * was received at. This function is called in the real-time thread after each successful read
+   * when the hardware is in a clock domain.
+   *
+   * \param device_time time of the device clock.
+   * \param steady_time steady time at which device_time was observed.
+   * \return true if a new pair is provided, false by default.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  bool get_clock_sample(
+    std::chrono::nanoseconds & device_time, std::chrono::nanoseconds & steady_time) const
+  {
+    (void) device_time;
+    (void) steady_time;
+    return false;
+  }
 };
 
 }  // namespace hardware_interface
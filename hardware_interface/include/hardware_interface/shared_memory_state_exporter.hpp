@@ -0,0 +1,174 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__SHARED_MEMORY_STATE_EXPORTER_HPP_
+#define HARDWARE_INTERFACE__SHARED_MEMORY_STATE_EXPORTER_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "hardware_interface/robot_hardware.hpp"
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+#include "hardware_interface/visibility_control.h"
+
+namespace hardware_interface
+{
+/// Header at the begin of a shared memory state segment.
+/**
+ * The header is followed, starting on the next cache line, by the actuator values and then by the
+ * joint values, each mirroring the layout of the corresponding InterfaceValueArena, state region,
+ * padding and command region included. The values are stored as the bits of doubles in lock-free
+ * 64 bit atomics. The names of the values follow at names_offset, one null-terminated
+ * "handle/interface" name per value, empty for padding.
+ * The sequence is odd while the values are being written, readers retry until they copied all the
+ * values between two reads of the same even sequence.
+ */
+struct SharedMemoryStateHeader
+{
+  static constexpr uint32_t MAGIC = 0x72326373;  // "r2cs"
+  static constexpr uint32_t LAYOUT_VERSION = 1;
+
+  uint32_t magic;
+  uint32_t layout_version;
+  std::atomic<uint64_t> sequence;
+  uint64_t actuator_value_count;
+  uint64_t joint_value_count;
+  uint64_t names_offset;
+  uint64_t names_size;
+};
+
+/// Mirror the interface values of a RobotHardware into a POSIX shared memory segment.
+/**
+ * Lets external monitors, in other processes, observe the hardware without going through the
+ * middleware nor slowing down the control loop: exporting is a copy of the arenas into the mapped
+ * segment, without any lock, allocation or system call.
+ * Only available on Linux, open() fails on the other platforms.
+ */
+class SharedMemoryStateExporter
+{
+public:
+  HARDWARE_INTERFACE_PUBLIC
+  SharedMemoryStateExporter() = default;
+
+  /// Unmaps and removes the segment.
+  HARDWARE_INTERFACE_PUBLIC
+  ~SharedMemoryStateExporter();
+
+  SharedMemoryStateExporter(const SharedMemoryStateExporter &) = delete;
+  SharedMemoryStateExporter & operator=(const SharedMemoryStateExporter &) = delete;
+
+  /// Create the segment and lay it out after the arenas of the hardware.
+  /**
+   * Called in a non real-time thread, replaces any existing segment with the same name.
+   * \param[in] segment_name The name of the segment, starting with a slash, e.g. "/robot_state".
+   * \param[in] robot_hardware The hardware to export, its registration must be frozen and it must
+   * outlive this exporter.
+   * \return The return code, one of `OK` or `ERROR` if the registration is not frozen or the
+   * segment could not be created.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type open(const std::string & segment_name, RobotHardware & robot_hardware);
+
+  /// Unmap and remove the segment, the processes that already mapped it keep their mapping.
+  HARDWARE_INTERFACE_PUBLIC
+  void close();
+
+  HARDWARE_INTERFACE_PUBLIC
+  bool is_open() const;
+
+  /// Copy the current values of the hardware into the segment.
+  /**
+   * Real-time safe, to be called by the thread writing the values, e.g. once per control cycle.
+   * Does nothing if the segment is not open.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  void export_values();
+
+private:
+  std::string segment_name_;
+  void * segment_ = nullptr;
+  size_t segment_size_ = 0;
+  SharedMemoryStateHeader * header_ = nullptr;
+  std::atomic<uint64_t> * values_ = nullptr;
+  const double * actuator_values_ = nullptr;
+  size_t actuator_value_count_ = 0;
+  const double * joint_values_ = nullptr;
+  size_t joint_value_count_ = 0;
+};
+
+/// Read the values exported by a SharedMemoryStateExporter, possibly from another process.
+class SharedMemoryStateReader
+{
+public:
+  HARDWARE_INTERFACE_PUBLIC
+  SharedMemoryStateReader() = default;
+
+  HARDWARE_INTERFACE_PUBLIC
+  ~SharedMemoryStateReader();
+
+  SharedMemoryStateReader(const SharedMemoryStateReader &) = delete;
+  SharedMemoryStateReader & operator=(const SharedMemoryStateReader &) = delete;
+
+  /// Map an existing segment read-only.
+  /**
+   * \param[in] segment_name The name the exporter opened the segment with.
+   * \return The return code, one of `OK` or `ERROR` if the segment does not exist or was not
+   * laid out by a compatible exporter.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type open(const std::string & segment_name);
+
+  HARDWARE_INTERFACE_PUBLIC
+  void close();
+
+  HARDWARE_INTERFACE_PUBLIC
+  bool is_open() const;
+
+  /// Names of the actuator values, "actuator/interface", empty for padding.
+  HARDWARE_INTERFACE_PUBLIC
+  const std::vector<std::string> & get_actuator_value_names() const;
+
+  /// Names of the joint values, "joint/interface", empty for padding.
+  HARDWARE_INTERFACE_PUBLIC
+  const std::vector<std::string> & get_joint_value_names() const;
+
+  /// Copy a consistent snapshot of the exported values.
+  /**
+   * Never blocks the exporter, retries instead when the values were written while being copied.
+   * \param[out] actuator_values The actuator values, resized to the number of actuator names.
+   * \param[out] joint_values The joint values, resized to the number of joint names.
+   * \param[in] max_attempts The number of copies to try before giving up.
+   * \return The number of exports done so far, or 0 if nothing was exported yet or no consistent
+   * copy could be made.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  uint64_t read(
+    std::vector<double> & actuator_values, std::vector<double> & joint_values,
+    size_t max_attempts = 100) const;
+
+private:
+  void * segment_ = nullptr;
+  size_t segment_size_ = 0;
+  const SharedMemoryStateHeader * header_ = nullptr;
+  const std::atomic<uint64_t> * values_ = nullptr;
+  std::vector<std::string> actuator_value_names_;
+  std::vector<std::string> joint_value_names_;
+};
+
+}  // namespace hardware_interface
+
+#endif  // HARDWARE_INTERFACE__SHARED_MEMORY_STATE_EXPORTER_HPP_
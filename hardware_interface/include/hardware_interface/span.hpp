@@ -0,0 +1,95 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__SPAN_HPP_
+#define HARDWARE_INTERFACE__SPAN_HPP_
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace hardware_interface
+{
+/// Non-owning view over contiguous values, a minimal stand-in for C++20 std::span.
+template<typename T>
+class Span
+{
+public:
+  using element_type = T;
+  using value_type = typename std::remove_cv<T>::type;
+
+  Span() = default;
+
+  Span(T * data, size_t size)
+  : data_(data), size_(size)
+  {
+  }
+
+  /// Implicit view of a vector, const views can be created from const vectors.
+  template<
+    typename VectorT,
+    typename std::enable_if<std::is_convertible<
+      decltype(std::declval<VectorT &>().data()), T *>::value>::type * = nullptr>
+  Span(VectorT & values)  // NOLINT(runtime/explicit)
+  : data_(values.data()), size_(values.size())
+  {
+  }
+
+  /// Implicit conversion of a mutable view to a const view.
+  template<
+    typename U,
+    typename std::enable_if<std::is_convertible<U *, T *>::value>::type * = nullptr>
+  Span(const Span<U> & other)  // NOLINT(runtime/explicit)
+  : data_(other.data()), size_(other.size())
+  {
+  }
+
+  T * data() const
+  {
+    return data_;
+  }
+
+  size_t size() const
+  {
+    return size_;
+  }
+
+  bool empty() const
+  {
+    return size_ == 0;
+  }
+
+  T & operator[](size_t index) const
+  {
+    return data_[index];
+  }
+
+  T * begin() const
+  {
+    return data_;
+  }
+
+  T * end() const
+  {
+    return data_ + size_;
+  }
+
+private:
+  T * data_ = nullptr;
+  size_t size_ = 0;
+};
+
+}  // namespace hardware_interface
+
+#endif  // HARDWARE_INTERFACE__SPAN_HPP_
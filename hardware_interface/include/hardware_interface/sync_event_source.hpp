@@ -0,0 +1,62 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__SYNC_EVENT_SOURCE_HPP_
+#define HARDWARE_INTERFACE__SYNC_EVENT_SOURCE_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "hardware_interface/visibility_control.h"
+
+namespace hardware_interface
+{
+
+/**
+  * \brief The periodic sync events of a hardware bus, the control loop is phase-locked to.
+  * E.g. the SYNC0 events of an EtherCAT distributed clock: the master component notifies the
+  * source from its sync callback, or from the thread reading the eventfd signaled by its driver.
+  * The events are given in steady time, a component stamping them in device time converts them
+  * with ClockDomainMap::to_steady() first.
+  * notify() and get_latest_event() neither block nor allocate, they are called from any thread.
+  */
+class SyncEventSource
+{
+public:
+  /// Notify a sync event of the bus.
+  /**
+   * \param[in] steady_time The steady time of the event, e.g. converted from the device time.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  void notify(std::chrono::nanoseconds steady_time);
+
+  /// Notify a sync event occurring now, e.g. right after the read of an eventfd.
+  HARDWARE_INTERFACE_PUBLIC
+  void notify();
+
+  /// Get the steady time of the latest event, zero if there was none yet.
+  HARDWARE_INTERFACE_PUBLIC
+  std::chrono::nanoseconds get_latest_event() const;
+
+  HARDWARE_INTERFACE_PUBLIC
+  uint64_t get_event_count() const;
+
+private:
+  std::atomic<int64_t> latest_event_ns_{0};
+  std::atomic<uint64_t> event_count_{0};
+};
+
+}  // namespace hardware_interface
+#endif  // HARDWARE_INTERFACE__SYNC_EVENT_SOURCE_HPP_
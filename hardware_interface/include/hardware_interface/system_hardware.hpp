@@ -20,9 +20,15 @@
 #include <utility>
 #include <vector>
 
+#include "hardware_interface/components/interface_selector.hpp"
+#include "hardware_interface/components/joint_values_batch.hpp"
+#include "hardware_interface/clock_domain_map.hpp"
+#include "hardware_interface/controller_info.hpp"
+#include "hardware_interface/hardware_freshness.hpp"
 #include "hardware_interface/hardware_info.hpp"
 #include "hardware_interface/types/hardware_interface_return_values.hpp"
 #include "hardware_interface/types/hardware_interface_status_values.hpp"
+#include "hardware_interface/types/hardware_interface_switch_state_values.hpp"
 #include "hardware_interface/visibility_control.h"
 
 namespace hardware_interface
@@ -55,6 +61,26 @@ public:
   HARDWARE_INTERFACE_PUBLIC
   status get_status() const;
 
+  /// Record the successful reads of the component in a freshness tracker.
+  /**
+   * Called before the component is read. Once started, the component is then reported
+   * status::TIMED_OUT while its data is stale.
+   * \param[in] freshness The tracker, null to stop recording.
+   * \param[in] component The index of the component in the tracker.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  void set_freshness(std::shared_ptr<HardwareFreshness> freshness, size_t component);
+
+  /// Feed the clock domain of the component with its pairs of device and steady times.
+  /**
+   * Called before the component is read, the pairs are then taken after each successful read.
+   * \param[in] clock_domains The domains, null to stop feeding.
+   * \param[in] domain The index of the domain of the component.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  void set_clock_domain(std::shared_ptr<ClockDomainMap> clock_domains, size_t domain);
+
+  /// Read the sensors, then filter their states with their filter chain, once per cycle.
   HARDWARE_INTERFACE_PUBLIC
   return_type read_sensors(std::vector<std::shared_ptr<components::Sensor>> & sensors);
 
@@ -64,8 +90,55 @@ public:
   HARDWARE_INTERFACE_PUBLIC
   return_type write_joints(const std::vector<std::shared_ptr<components::Joint>> & joints);
 
+  HARDWARE_INTERFACE_PUBLIC
+  bool supports_joint_batches() const;
+
+  HARDWARE_INTERFACE_PUBLIC
+  return_type read_joint_batch(components::JointValuesBatch & states);
+
+  HARDWARE_INTERFACE_PUBLIC
+  return_type write_joint_batch(const components::JointValuesBatch & commands);
+
+  HARDWARE_INTERFACE_PUBLIC
+  return_type prepare_mode_switch(
+    const std::vector<ControllerInfo> & start_list,
+    const std::vector<ControllerInfo> & stop_list);
+
+  HARDWARE_INTERFACE_PUBLIC
+  return_type perform_mode_switch(
+    const std::vector<ControllerInfo> & start_list,
+    const std::vector<ControllerInfo> & stop_list);
+
+  HARDWARE_INTERFACE_PUBLIC
+  switch_state get_mode_switch_state() const;
+
+  HARDWARE_INTERFACE_PUBLIC
+  switch_state get_mode_switch_state(const ControllerInfo & controller) const;
+
 private:
+  /// Whether joints are the ones the batches were prepared for.
+  bool is_bound_to(const std::vector<std::shared_ptr<components::Joint>> & joints) const;
+
+  /// Prepare the batches for joints, joints_batchable_ is false if they have different interfaces.
+  void bind_joint_batches(const std::vector<std::shared_ptr<components::Joint>> & joints);
+
+  /// Records a successful read in the freshness tracker and the clock domain, returns ret.
+  return_type record_read(return_type ret);
+
   std::unique_ptr<SystemHardwareInterface> impl_;
+  std::shared_ptr<HardwareFreshness> freshness_;
+  size_t freshness_component_ = 0;
+  std::shared_ptr<ClockDomainMap> clock_domains_;
+  size_t clock_domain_ = 0;
+
+  std::vector<const components::Joint *> batched_joints_;
+  bool joints_batchable_ = false;
+  components::JointValuesBatch state_batch_;
+  components::JointValuesBatch command_batch_;
+  components::InterfaceSelector state_selector_;
+  components::InterfaceSelector command_selector_;
+  /// Values of one joint, while scattering or gathering the batches
+  std::vector<double> joint_values_;
 };
 
 }  // namespace hardware_interface
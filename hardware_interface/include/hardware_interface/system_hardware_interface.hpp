@@ -15,14 +15,18 @@
 #ifndef HARDWARE_INTERFACE__SYSTEM_HARDWARE_INTERFACE_HPP_
 #define HARDWARE_INTERFACE__SYSTEM_HARDWARE_INTERFACE_HPP_
 
+#include <chrono>
 #include <memory>
 #include <vector>
 
 #include "hardware_interface/components/joint.hpp"
+#include "hardware_interface/components/joint_values_batch.hpp"
 #include "hardware_interface/components/sensor.hpp"
+#include "hardware_interface/controller_info.hpp"
 #include "hardware_interface/hardware_info.hpp"
 #include "hardware_interface/types/hardware_interface_return_values.hpp"
 #include "hardware_interface/types/hardware_interface_status_values.hpp"
+#include "hardware_interface/types/hardware_interface_switch_state_values.hpp"
 #include "hardware_interface/visibility_control.h"
 
 namespace hardware_interface
@@ -115,6 +119,141 @@ public:
   return_type
   virtual
   write_joints(const std::vector<std::shared_ptr<components::Joint>> & joints) = 0;
+
+  /**
+   * \brief Whether the system exchanges joint data in batches, in which case read_joint_batch and
+   * write_joint_batch are used instead of read_joints and write_joints for joints sharing the same
+   * interfaces.
+   *
+   * \return true if read_joint_batch and write_joint_batch are implemented, false otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  bool supports_joint_batches() const
+  {
+    return false;
+  }
+
+  /**
+   * \brief Read data from the hardware into the states of all joints at once.
+   * This function is called by the resource manager instead of read_joints if
+   * supports_joint_batches returns true.
+   *
+   * \param states batch where the joint states from the hardware are stored.
+   * \return return_type:OK if everything worked as expected, return_type::ERROR otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  return_type read_joint_batch(components::JointValuesBatch & states) const
+  {
+    (void) states;
+    return return_type::ERROR;
+  }
+
+  /**
+   * \brief Write the commands of all joints at once to the hardware.
+   * This function is called by the resource manager instead of write_joints if
+   * supports_joint_batches returns true.
+   *
+   * \param commands batch of joint commands which are written to the hardware.
+   * \return return_type:OK if everything worked as expected, return_type::ERROR otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  return_type write_joint_batch(const components::JointValuesBatch & commands)
+  {
+    (void) commands;
+    return return_type::ERROR;
+  }
+
+  /**
+   * \brief Get the latest pair of device and steady times of the system, for the ClockDomainMap
+   * of its device clock, e.g. the distributed clock time of the last frame and the steady time it
+   * was received at. This function is called in the real-time thread after each successful read
+   * when the hardware is in a clock domain.
+   *
+   * \param device_time time of the device clock.
+   * \param steady_time steady time at which device_time was observed.
+   * \return true if a new pair is provided, false by default.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  bool get_clock_sample(
+    std::chrono::nanoseconds & device_time, std::chrono::nanoseconds & steady_time) const
+  {
+    (void) device_time;
+    (void) steady_time;
+    return false;
+  }
+
+  /**
+   * \brief Check whether the system can switch to the interfaces claimed by the controllers.
+   * This function is called in a non real-time thread before the switch is requested.
+   *
+   * \param start_list controllers to be started.
+   * \param stop_list controllers to be stopped.
+   * \return return_type:OK if the switch is feasible, return_type::ERROR otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  return_type prepare_mode_switch(
+    const std::vector<ControllerInfo> & start_list,
+    const std::vector<ControllerInfo> & stop_list)
+  {
+    (void) start_list;
+    (void) stop_list;
+    return return_type::OK;
+  }
+
+  /**
+   * \brief Start switching the system to the interfaces claimed by the controllers.
+   * This function is called in the real-time thread and must not block, a switch taking several
+   * cycles, e.g. a drive changing its mode of operation, is then polled with
+   * get_mode_switch_state.
+   *
+   * \param start_list controllers to be started.
+   * \param stop_list controllers to be stopped.
+   * \return return_type:OK if the switch was started, return_type::ERROR otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  return_type perform_mode_switch(
+    const std::vector<ControllerInfo> & start_list,
+    const std::vector<ControllerInfo> & stop_list)
+  {
+    (void) start_list;
+    (void) stop_list;
+    return return_type::OK;
+  }
+
+  /**
+   * \brief Get the state of the last switch started with perform_mode_switch.
+   * This function is called in the real-time thread on every cycle until the switch is done.
+   *
+   * \return switch_state::DONE once all the interfaces are switched, switch_state::ONGOING while
+   * they are switching, switch_state::ERROR if the switch failed.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  switch_state get_mode_switch_state() const
+  {
+    return switch_state::DONE;
+  }
+
+  /**
+   * \brief Get the state of the switch of the interfaces claimed by one controller, for the
+   * controllers started as soon as their own interfaces are switched.
+   *
+   * \param controller controller to be started.
+   * \return the state of the whole switch by default.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  switch_state get_mode_switch_state(const ControllerInfo & controller) const
+  {
+    (void) controller;
+    return get_mode_switch_state();
+  }
 };
 
 }  // namespace hardware_interface
@@ -0,0 +1,107 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__TRACING_HPP_
+#define HARDWARE_INTERFACE__TRACING_HPP_
+
+#include <atomic>
+#include <cstdint>
+
+#include "hardware_interface/visibility_control.h"
+
+namespace hardware_interface
+{
+/// Receives the begin and end events of the traced phases, e.g. to record them in a test.
+/**
+ * The events are also emitted as the ros2_control:phase_begin and ros2_control:phase_end LTTng
+ * tracepoints when built with HARDWARE_INTERFACE_LTTNG_TRACING, which ros2_tracing records along
+ * with the ROS 2 tracepoints.
+ * The sink is called from the threads running the phases, including the real-time thread, so it
+ * must be thread-safe and real-time safe.
+ */
+class TraceSink
+{
+public:
+  virtual ~TraceSink() = default;
+
+  /**
+   * \param phase Name of the phase, e.g. "update"
+   * \param detail What the phase runs on, e.g. the name of a controller, empty if nothing
+   * \param time_ns Time of the steady clock
+   */
+  virtual void on_begin(const char * phase, const char * detail, int64_t time_ns) = 0;
+
+  virtual void on_end(const char * phase, const char * detail, int64_t time_ns) = 0;
+};
+
+namespace detail
+{
+/// Whether trace_begin() and trace_end() are called, always with LTTng tracepoints
+HARDWARE_INTERFACE_PUBLIC
+extern std::atomic<bool> tracing_enabled;
+
+HARDWARE_INTERFACE_PUBLIC
+void trace_begin(const char * phase, const char * detail);
+
+HARDWARE_INTERFACE_PUBLIC
+void trace_end(const char * phase, const char * detail);
+}  // namespace detail
+
+/**
+ * Sets the sink of the trace events, null to stop tracing into a sink.
+ * \param sink The sink, which must outlive the phases in flight when it is replaced
+ */
+HARDWARE_INTERFACE_PUBLIC
+void set_trace_sink(TraceSink * sink);
+
+/// Traces the phase run while in scope, costs a relaxed atomic load when not tracing.
+class ScopedTrace
+{
+public:
+  /**
+   * \param phase Name of the phase, must outlive the scope
+   * \param detail What the phase runs on, must outlive the scope
+   */
+  explicit ScopedTrace(const char * phase, const char * detail = "")
+  : phase_(phase), detail_(detail),
+    active_(detail::tracing_enabled.load(std::memory_order_relaxed))
+  {
+    if (active_) {
+      detail::trace_begin(phase_, detail_);
+    }
+  }
+
+  ~ScopedTrace()
+  {
+    if (active_) {
+      detail::trace_end(phase_, detail_);
+    }
+  }
+
+  ScopedTrace(const ScopedTrace &) = delete;
+  ScopedTrace & operator=(const ScopedTrace &) = delete;
+
+private:
+  const char * phase_;
+  const char * detail_;
+  bool active_;
+};
+
+}  // namespace hardware_interface
+
+/// Traces the rest of the enclosing scope as a phase, see ScopedTrace
+#define HARDWARE_INTERFACE_TRACE_SCOPE(phase, detail) \
+  ::hardware_interface::ScopedTrace hardware_interface_trace_scope(phase, detail)
+
+#endif  // HARDWARE_INTERFACE__TRACING_HPP_
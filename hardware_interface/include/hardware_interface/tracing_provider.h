@@ -0,0 +1,55 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// LTTng-UST tracepoint provider of the phases traced by hardware_interface/tracing.hpp, only
+// included by src/tracing.cpp when built with HARDWARE_INTERFACE_LTTNG_TRACING
+
+#undef TRACEPOINT_PROVIDER
+#define TRACEPOINT_PROVIDER ros2_control
+
+#undef TRACEPOINT_INCLUDE
+#define TRACEPOINT_INCLUDE "hardware_interface/tracing_provider.h"
+
+#if !defined(HARDWARE_INTERFACE__TRACING_PROVIDER_H_) || defined(TRACEPOINT_HEADER_MULTI_READ)
+#define HARDWARE_INTERFACE__TRACING_PROVIDER_H_
+
+#include <lttng/tracepoint.h>
+
+TRACEPOINT_EVENT(
+  ros2_control,
+  phase_begin,
+  TP_ARGS(
+    const char *, phase_arg,
+    const char *, detail_arg),
+  TP_FIELDS(
+    ctf_string(phase, phase_arg)
+    ctf_string(detail, detail_arg)
+  )
+)
+
+TRACEPOINT_EVENT(
+  ros2_control,
+  phase_end,
+  TP_ARGS(
+    const char *, phase_arg,
+    const char *, detail_arg),
+  TP_FIELDS(
+    ctf_string(phase, phase_arg)
+    ctf_string(detail, detail_arg)
+  )
+)
+
+#endif  // HARDWARE_INTERFACE__TRACING_PROVIDER_H_
+
+#include <lttng/tracepoint-event.h>
@@ -0,0 +1,103 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__TRIPLE_BUFFER_HPP_
+#define HARDWARE_INTERFACE__TRIPLE_BUFFER_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace hardware_interface
+{
+/// Wait-free exchange of the latest value between one writer thread and one reader thread.
+/**
+ * The writer and the reader each own one of three buffers, the third one is shared and holds
+ * the latest published value. Publishing and updating each swap the owned buffer with the shared
+ * one with a single atomic exchange, so neither side ever waits for the other, copies under a
+ * lock or sees a value being written. Values published while the reader did not update are
+ * dropped, the reader always gets the latest one.
+ * The buffers are constructed once, from the initial value, values are written in place so that
+ * types owning memory, e.g. vectors, are only allocated at construction.
+ */
+template<typename T>
+class TripleBuffer
+{
+public:
+  explicit TripleBuffer(const T & initial_value = T())
+  : buffers_{initial_value, initial_value, initial_value}
+  {
+  }
+
+  TripleBuffer(const TripleBuffer &) = delete;
+  TripleBuffer & operator=(const TripleBuffer &) = delete;
+
+  /// Get the buffer owned by the writer, to be filled before publish().
+  T & get_write_buffer()
+  {
+    return buffers_[write_index_];
+  }
+
+  /// Make the write buffer the latest value, the writer gets another buffer to fill.
+  void publish()
+  {
+    write_index_ = shared_.exchange(write_index_ | NEW_VALUE, std::memory_order_acq_rel) & INDEX;
+  }
+
+  /// Take the latest published value, if any was published since the previous update.
+  /**
+   * \return true if the read buffer now holds a newly published value.
+   */
+  bool update()
+  {
+    if ((shared_.load(std::memory_order_relaxed) & NEW_VALUE) == 0) {
+      return false;
+    }
+    read_index_ = shared_.exchange(read_index_, std::memory_order_acq_rel) & INDEX;
+    return true;
+  }
+
+  /// Get the buffer owned by the reader, holding the value taken by the last update().
+  T & get_read_buffer()
+  {
+    return buffers_[read_index_];
+  }
+
+  const T & get_read_buffer() const
+  {
+    return buffers_[read_index_];
+  }
+
+private:
+  static constexpr uint8_t INDEX = 0x3;
+  static constexpr uint8_t NEW_VALUE = 0x4;
+
+  static constexpr size_t CACHE_LINE_SIZE = 64;
+
+  T buffers_[3];
+  /// Index of the shared buffer, with NEW_VALUE set when it was published and not yet read
+  alignas(CACHE_LINE_SIZE) std::atomic<uint8_t> shared_{1};
+  // the indices owned by each thread on their own cache line, not to bounce on every exchange
+  alignas(CACHE_LINE_SIZE) uint8_t write_index_ = 0;
+  alignas(CACHE_LINE_SIZE) uint8_t read_index_ = 2;
+};
+
+template<typename T>
+constexpr uint8_t TripleBuffer<T>::INDEX;
+template<typename T>
+constexpr uint8_t TripleBuffer<T>::NEW_VALUE;
+
+}  // namespace hardware_interface
+
+#endif  // HARDWARE_INTERFACE__TRIPLE_BUFFER_HPP_
@@ -0,0 +1,113 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__TYPED_HANDLE_HPP_
+#define HARDWARE_INTERFACE__TYPED_HANDLE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include "hardware_interface/macros.hpp"
+#include "hardware_interface/typed_value_arena.hpp"
+#include "hardware_interface/visibility_control.h"
+
+namespace hardware_interface
+{
+/// A handle used to get and set an interface value stored in its own type, see TypedValueArena.
+template<typename T>
+class TypedHandle
+{
+public:
+  using value_type = T;
+
+  HARDWARE_INTERFACE_PUBLIC
+  TypedHandle(
+    const std::string & name, const std::string & interface_name,
+    T * value_ptr = nullptr)
+  : name_(name), interface_name_(interface_name), value_ptr_(value_ptr)
+  {
+  }
+
+  HARDWARE_INTERFACE_PUBLIC
+  TypedHandle with_value_ptr(T * value_ptr) const
+  {
+    return TypedHandle(name_, interface_name_, value_ptr);
+  }
+
+  HARDWARE_INTERFACE_PUBLIC
+  const std::string & get_name() const
+  {
+    return name_;
+  }
+
+  HARDWARE_INTERFACE_PUBLIC
+  const std::string & get_interface_name() const
+  {
+    return interface_name_;
+  }
+
+  HARDWARE_INTERFACE_PUBLIC
+  T get_value() const
+  {
+    THROW_ON_NULLPTR(value_ptr_);
+    return *value_ptr_;
+  }
+
+  HARDWARE_INTERFACE_PUBLIC
+  void set_value(T value)
+  {
+    THROW_ON_NULLPTR(value_ptr_);
+    *value_ptr_ = value;
+  }
+
+  /// Test one bit of a bitfield, e.g. the fault bit of a status word.
+  HARDWARE_INTERFACE_PUBLIC
+  bool test_bit(size_t bit) const
+  {
+    static_assert(std::is_same<T, uint16_t>::value, "only bitfields have bits");
+    return (get_value() >> bit) & 1u;
+  }
+
+  /// Set or clear one bit of a bitfield, leaving the others as they are.
+  HARDWARE_INTERFACE_PUBLIC
+  void set_bit(size_t bit, bool value)
+  {
+    static_assert(std::is_same<T, uint16_t>::value, "only bitfields have bits");
+    const auto mask = static_cast<uint16_t>(1u << bit);
+    set_value(static_cast<uint16_t>(value ? get_value() | mask : get_value() & ~mask));
+  }
+
+  /// Get the storage of the value, null if the handle was not retrieved from a hardware.
+  HARDWARE_INTERFACE_PUBLIC
+  T * get_value_ptr() const
+  {
+    return value_ptr_;
+  }
+
+private:
+  std::string name_;
+  std::string interface_name_;
+  T * value_ptr_;
+};
+
+using Float32Handle = TypedHandle<float>;
+using Int32Handle = TypedHandle<int32_t>;
+using BitfieldHandle = TypedHandle<uint16_t>;
+using BoolHandle = TypedHandle<bool>;
+
+}  // namespace hardware_interface
+
+#endif  // HARDWARE_INTERFACE__TYPED_HANDLE_HPP_
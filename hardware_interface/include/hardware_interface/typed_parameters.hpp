@@ -0,0 +1,254 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__TYPED_PARAMETERS_HPP_
+#define HARDWARE_INTERFACE__TYPED_PARAMETERS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "hardware_interface/visibility_control.h"
+
+namespace hardware_interface
+{
+
+enum class ParameterType : uint8_t
+{
+  DOUBLE,
+  INTEGER,
+  BOOL,
+  STRING,
+  DOUBLE_ARRAY,
+  INTEGER_ARRAY,
+};
+
+template<typename T>
+struct ParameterTraits;
+
+template<>
+struct ParameterTraits<double>
+{
+  static constexpr ParameterType type = ParameterType::DOUBLE;
+};
+
+template<>
+struct ParameterTraits<int64_t>
+{
+  static constexpr ParameterType type = ParameterType::INTEGER;
+};
+
+template<>
+struct ParameterTraits<bool>
+{
+  static constexpr ParameterType type = ParameterType::BOOL;
+};
+
+template<>
+struct ParameterTraits<std::string>
+{
+  static constexpr ParameterType type = ParameterType::STRING;
+};
+
+template<>
+struct ParameterTraits<std::vector<double>>
+{
+  static constexpr ParameterType type = ParameterType::DOUBLE_ARRAY;
+};
+
+template<>
+struct ParameterTraits<std::vector<int64_t>>
+{
+  static constexpr ParameterType type = ParameterType::INTEGER_ARRAY;
+};
+
+/// Precomputed key of a parameter of type T, given by ParameterSchema::declare().
+template<typename T>
+struct ParameterKey
+{
+  /// Index of the parameter among the parameters of type T of its schema
+  size_t index;
+};
+
+/**
+  * \brief The values of the parameters of a hardware or a component, converted from their text
+  * once, when the description is parsed.
+  * The values are stored by type and looked up by the precomputed keys of their schema, with no
+  * hashing nor conversion, so the drivers read them anywhere, including in the real-time loop.
+  */
+class TypedParameters
+{
+public:
+  /// Whether the parameter has a value, always true for the required and the defaulted ones.
+  template<typename T>
+  bool has(ParameterKey<T> key) const
+  {
+    const auto & slots = get_slots<T>();
+    return key.index < slots.size() && slots[key.index].present;
+  }
+
+  /// Get the value of a parameter, which has to have one, see has().
+  template<typename T>
+  const T & get(ParameterKey<T> key) const
+  {
+    return get_slots<T>()[key.index].value;
+  }
+
+  template<typename T>
+  void set(ParameterKey<T> key, const T & value)
+  {
+    auto & slots = get_slots<T>();
+    if (key.index >= slots.size()) {
+      slots.resize(key.index + 1);
+    }
+    slots[key.index] = {value, true};
+  }
+
+  /// Whether no parameter has a value, e.g. if the hardware class declared no schema.
+  bool empty() const
+  {
+    return get_slots<double>().empty() && get_slots<int64_t>().empty() &&
+           get_slots<bool>().empty() && get_slots<std::string>().empty() &&
+           get_slots<std::vector<double>>().empty() && get_slots<std::vector<int64_t>>().empty();
+  }
+
+private:
+  template<typename T>
+  struct Slot
+  {
+    T value;
+    bool present;
+  };
+
+  template<typename T>
+  using Slots = std::vector<Slot<T>>;
+
+  template<typename T>
+  const Slots<T> & get_slots() const
+  {
+    return std::get<Slots<T>>(slots_);
+  }
+
+  template<typename T>
+  Slots<T> & get_slots()
+  {
+    return std::get<Slots<T>>(slots_);
+  }
+
+  std::tuple<
+    Slots<double>, Slots<int64_t>, Slots<bool>, Slots<std::string>, Slots<std::vector<double>>,
+    Slots<std::vector<int64_t>>> slots_;
+};
+
+struct ParameterDescriptor
+{
+  std::string name;
+  ParameterType type;
+  /// Index of the parameter among the parameters of its type
+  size_t index;
+  /// Whether the description has to give the parameter, which has no default then
+  bool required;
+};
+
+/**
+  * \brief The parameters a hardware class or its components accept, declared by the driver.
+  * Each declaration gives the key the driver looks the value up with, e.g. in a static member
+  * initialized along with the schema.
+  */
+class ParameterSchema
+{
+public:
+  /// Declare a parameter the description has to give.
+  /**
+   * \throws std::invalid_argument if a parameter of that name was already declared
+   */
+  template<typename T>
+  ParameterKey<T> declare(const std::string & name)
+  {
+    return add<T>(name, true);
+  }
+
+  /// Declare a parameter taking a default value when the description does not give it.
+  template<typename T>
+  ParameterKey<T> declare(const std::string & name, const T & default_value)
+  {
+    const auto key = add<T>(name, false);
+    defaults_.set(key, default_value);
+    return key;
+  }
+
+  /// Declare a parameter which has no value when the description does not give it.
+  template<typename T>
+  ParameterKey<T> declare_optional(const std::string & name)
+  {
+    return add<T>(name, false);
+  }
+
+  const std::vector<ParameterDescriptor> & get_descriptors() const
+  {
+    return descriptors_;
+  }
+
+  /// The default values, the typed parameters of a description are initialized to.
+  const TypedParameters & get_defaults() const
+  {
+    return defaults_;
+  }
+
+  /// Convert the parameters of a description to their declared types.
+  /**
+   * The parameters undeclared by the schema are left as text only.
+   * \param[in] parameters The text of the parameters, by name.
+   * \param[in] owner_name The name of the hardware or component, for the errors.
+   * \return the typed values of the parameters
+   * \throws std::runtime_error if a required parameter is missing or a value is invalid
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  TypedParameters parse(
+    const std::unordered_map<std::string, std::string> & parameters,
+    const std::string & owner_name) const;
+
+private:
+  template<typename T>
+  ParameterKey<T> add(const std::string & name, bool required)
+  {
+    size_t count = 0;
+    for (const auto & descriptor : descriptors_) {
+      if (descriptor.name == name) {
+        throw std::invalid_argument("parameter " + name + " declared twice");
+      }
+      count += descriptor.type == ParameterTraits<T>::type ? 1 : 0;
+    }
+    descriptors_.push_back({name, ParameterTraits<T>::type, count, required});
+    return ParameterKey<T>{count};
+  }
+
+  std::vector<ParameterDescriptor> descriptors_;
+  TypedParameters defaults_;
+};
+
+/// The schemas of the parameters of a hardware class, of its hardware tag and its components.
+struct HardwareParameterSchema
+{
+  ParameterSchema hardware_parameters;
+  ParameterSchema joint_parameters;
+  ParameterSchema sensor_parameters;
+};
+
+}  // namespace hardware_interface
+#endif  // HARDWARE_INTERFACE__TYPED_PARAMETERS_HPP_
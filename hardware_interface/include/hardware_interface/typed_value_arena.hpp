@@ -0,0 +1,236 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__TYPED_VALUE_ARENA_HPP_
+#define HARDWARE_INTERFACE__TYPED_VALUE_ARENA_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "hardware_interface/realtime_memory_pool.hpp"
+#include "hardware_interface/span.hpp"
+#include "hardware_interface/visibility_control.h"
+
+namespace hardware_interface
+{
+
+/// The types of the interface values stored in their own type rather than as a double.
+enum class InterfaceValueType : uint8_t
+{
+  FLOAT32,
+  INT32,
+  /// A bitfield, e.g. the status word of a drive or a bank of digital inputs
+  UINT16,
+  BOOL,
+};
+
+constexpr size_t INTERFACE_VALUE_TYPE_COUNT = 4;
+
+template<typename T>
+struct InterfaceValueTraits;
+
+template<>
+struct InterfaceValueTraits<float>
+{
+  static constexpr InterfaceValueType type = InterfaceValueType::FLOAT32;
+};
+
+template<>
+struct InterfaceValueTraits<int32_t>
+{
+  static constexpr InterfaceValueType type = InterfaceValueType::INT32;
+};
+
+template<>
+struct InterfaceValueTraits<uint16_t>
+{
+  static constexpr InterfaceValueType type = InterfaceValueType::UINT16;
+};
+
+template<>
+struct InterfaceValueTraits<bool>
+{
+  static constexpr InterfaceValueType type = InterfaceValueType::BOOL;
+};
+
+/// Contiguous storage for the interface values which are not doubles.
+/**
+ * The counterpart of InterfaceValueArena for the values stored in their own type, e.g. the digital
+ * inputs as bools, the status words of the drives as 16 bits bitfields or the taxels of a tactile
+ * skin as floats, half the size of doubles. The values are registered by handle and interface
+ * name, then laid out once, when the arena is frozen, and never reallocated afterwards.
+ * As in InterfaceValueArena, the interfaces whose name ends with "_command" go to the command
+ * region, which has a published copy for the hardware updated by publish_commands(). In each
+ * region, the values are grouped by type, each type starting on its own cache line, in the order
+ * they were registered: the values of one type registered together, e.g. all the taxels of a
+ * skin, are contiguous and read at once, see get_state_values().
+ */
+class TypedValueArena
+{
+public:
+  HARDWARE_INTERFACE_PUBLIC
+  TypedValueArena() = default;
+
+  TypedValueArena(const TypedValueArena &) = delete;
+  TypedValueArena & operator=(const TypedValueArena &) = delete;
+
+  /// Register an interface value, before the arena is frozen.
+  /**
+   * \return false if the arena is frozen or the interface is already registered.
+   */
+  template<typename T>
+  bool register_value(
+    const std::string & handle_name, const std::string & interface_name, T default_value)
+  {
+    uint32_t bits = 0;
+    std::memcpy(&bits, &default_value, sizeof(T));
+    return add(handle_name, interface_name, InterfaceValueTraits<T>::type, bits);
+  }
+
+  /// Get the type of a registered interface value.
+  /**
+   * \return false if the interface is not registered.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  bool get_value_type(
+    const std::string & handle_name, const std::string & interface_name,
+    InterfaceValueType & type) const;
+
+  HARDWARE_INTERFACE_PUBLIC
+  size_t get_value_count() const;
+
+  /// Lay out the registered values, initialized with their default values.
+  /**
+   * \param[in] pool The pool the values are allocated from, which should outlive the arena, null
+   * to allocate them from the heap.
+   * \throws std::runtime_error if the arena is already frozen.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  void freeze(RealtimeMemoryPool * pool = nullptr);
+
+  HARDWARE_INTERFACE_PUBLIC
+  bool is_frozen() const;
+
+  /// Get the storage of an interface value, once frozen.
+  /**
+   * \return pointer to the value, valid for the lifetime of the arena, null if the arena is not
+   * frozen or the interface is not registered with type T.
+   */
+  template<typename T>
+  T * get_value_ptr(const std::string & handle_name, const std::string & interface_name)
+  {
+    return static_cast<T *>(
+      find_value(handle_name, interface_name, InterfaceValueTraits<T>::type, false));
+  }
+
+  /// Get the storage of an interface value as read by the hardware, see get_value_ptr().
+  /**
+   * \return pointer to the published copy of a command value, or to the value itself for a state
+   * value.
+   */
+  template<typename T>
+  T * get_published_value_ptr(const std::string & handle_name, const std::string & interface_name)
+  {
+    return static_cast<T *>(
+      find_value(handle_name, interface_name, InterfaceValueTraits<T>::type, true));
+  }
+
+  /// Get the state values of type T, in the order they were registered.
+  template<typename T>
+  Span<T> get_state_values()
+  {
+    return get_values<T>(state_blocks_, 0);
+  }
+
+  /// Get the command values of type T, as written by the controllers.
+  template<typename T>
+  Span<T> get_command_values()
+  {
+    return get_values<T>(command_blocks_, command_begin_);
+  }
+
+  /// Get the published command values of type T, as read by the hardware.
+  template<typename T>
+  Span<const T> get_published_command_values()
+  {
+    return get_values<T>(command_blocks_, published_command_begin_);
+  }
+
+  /// Copy the command region into its published copy, real-time safe.
+  HARDWARE_INTERFACE_PUBLIC
+  void publish_commands();
+
+private:
+  struct Value
+  {
+    InterfaceValueType type;
+    bool command;
+    uint32_t default_bits;
+    /// Offset in bytes from begin_, once frozen
+    size_t offset;
+  };
+
+  /// The values of one type in a region
+  struct Block
+  {
+    /// Offset in bytes from the begin of the region
+    size_t begin = 0;
+    size_t count = 0;
+  };
+
+  using Blocks = std::array<Block, INTERFACE_VALUE_TYPE_COUNT>;
+
+  HARDWARE_INTERFACE_PUBLIC
+  bool add(
+    const std::string & handle_name, const std::string & interface_name, InterfaceValueType type,
+    uint32_t default_bits);
+
+  HARDWARE_INTERFACE_PUBLIC
+  void * find_value(
+    const std::string & handle_name, const std::string & interface_name, InterfaceValueType type,
+    bool published);
+
+  template<typename T>
+  Span<T> get_values(const Blocks & blocks, size_t region_begin)
+  {
+    if (begin_ == nullptr) {
+      return Span<T>();
+    }
+    const auto & block = blocks[static_cast<size_t>(InterfaceValueTraits<T>::type)];
+    return Span<T>(reinterpret_cast<T *>(begin_ + region_begin + block.begin), block.count);
+  }
+
+  std::vector<Value> values_;
+  /// Index of each value in values_, by handle and interface name
+  std::map<std::pair<std::string, std::string>, size_t> index_;
+
+  /// Over-allocated by one cache line to be able to align the begin of the arena.
+  std::vector<uint8_t, PoolAllocator<uint8_t>> storage_;
+  uint8_t * begin_ = nullptr;
+  Blocks state_blocks_;
+  Blocks command_blocks_;
+  size_t command_begin_ = 0;
+  size_t command_size_ = 0;
+  size_t published_command_begin_ = 0;
+};
+
+}  // namespace hardware_interface
+
+#endif  // HARDWARE_INTERFACE__TYPED_VALUE_ARENA_HPP_
@@ -25,6 +25,7 @@ enum class status : std::uint8_t
   CONFIGURED = 1,
   STARTED = 3,
   STOPPED = 4,
+  TIMED_OUT = 5,
 };
 
 }  // namespace hardware_interface
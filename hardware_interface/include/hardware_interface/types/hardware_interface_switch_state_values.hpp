@@ -0,0 +1,32 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__TYPES__HARDWARE_INTERFACE_SWITCH_STATE_VALUES_HPP_
+#define HARDWARE_INTERFACE__TYPES__HARDWARE_INTERFACE_SWITCH_STATE_VALUES_HPP_
+
+#include <cstdint>
+
+namespace hardware_interface
+{
+/// State of a switch of the hardware to the interfaces claimed by the controllers.
+enum class switch_state : std::uint8_t
+{
+  DONE = 0,
+  ONGOING = 1,
+  ERROR = 2,
+};
+
+}  // namespace hardware_interface
+
+#endif  // HARDWARE_INTERFACE__TYPES__HARDWARE_INTERFACE_SWITCH_STATE_VALUES_HPP_
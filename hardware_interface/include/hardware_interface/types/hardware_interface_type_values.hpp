@@ -15,11 +15,24 @@
 #ifndef HARDWARE_INTERFACE__TYPES__HARDWARE_INTERFACE_TYPE_VALUES_HPP_
 #define HARDWARE_INTERFACE__TYPES__HARDWARE_INTERFACE_TYPE_VALUES_HPP_
 
+#include "hardware_interface/interface_type_id.hpp"
+
 namespace hardware_interface
 {
 constexpr const auto HW_IF_POSITION = "position";
 constexpr const auto HW_IF_VELOCITY = "velocity";
 constexpr const auto HW_IF_EFFORT = "effort";
+constexpr const auto HW_IF_POSITION_COMMAND = "position_command";
+constexpr const auto HW_IF_VELOCITY_COMMAND = "velocity_command";
+constexpr const auto HW_IF_EFFORT_COMMAND = "effort_command";
+
+/// Interned ids of the standard interface types, in the order they are pre-interned.
+constexpr InterfaceTypeId HW_IF_POSITION_ID{0};
+constexpr InterfaceTypeId HW_IF_VELOCITY_ID{1};
+constexpr InterfaceTypeId HW_IF_EFFORT_ID{2};
+constexpr InterfaceTypeId HW_IF_POSITION_COMMAND_ID{3};
+constexpr InterfaceTypeId HW_IF_VELOCITY_COMMAND_ID{4};
+constexpr InterfaceTypeId HW_IF_EFFORT_COMMAND_ID{5};
 }  // namespace hardware_interface
 
 #endif  // HARDWARE_INTERFACE__TYPES__HARDWARE_INTERFACE_TYPE_VALUES_HPP_
@@ -0,0 +1,223 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__UDP_SYSTEM_HARDWARE_HPP_
+#define HARDWARE_INTERFACE__UDP_SYSTEM_HARDWARE_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "hardware_interface/batched_frame_io.hpp"
+#include "hardware_interface/components/joint.hpp"
+#include "hardware_interface/components/joint_values_batch.hpp"
+#include "hardware_interface/components/sensor.hpp"
+#include "hardware_interface/hardware_info.hpp"
+#include "hardware_interface/packet_layout.hpp"
+#include "hardware_interface/span.hpp"
+#include "hardware_interface/system_hardware_interface.hpp"
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+#include "hardware_interface/types/hardware_interface_status_values.hpp"
+#include "hardware_interface/visibility_control.h"
+
+namespace hardware_interface
+{
+
+/**
+  * \brief Base class of the systems exchanging one state packet and one command packet per cycle
+  * over UDP, e.g. Ethernet drives and robot controllers with a UDP real-time interface.
+  * A driver only registers where the values of its joints are in the packets, the joint batches
+  * are then decoded straight from the receive buffers and encoded straight into the send buffers
+  * of a BatchedFrameIo, without any intermediate copy nor allocation in the real-time thread.
+  * The joint indices of the layouts are the indices of the joints in the HardwareInfo, all the
+  * joints must share the same interfaces to be exchanged in batches.
+  *
+  * The socket is configured with the hardware parameters:
+  * - "remote_address" and "remote_port": the IPv4 address and the port of the device, required.
+  * - "local_address" and "local_port": where the state packets are received, any by default.
+  * - "receive_timeout_ms": age after which the state is stale, 100 by default.
+  * - "use_io_uring": "false" for the batched system calls, "true" by default.
+  */
+class UdpSystemHardware : public SystemHardwareInterface
+{
+public:
+  HARDWARE_INTERFACE_PUBLIC
+  UdpSystemHardware();
+
+  /// Closes the socket.
+  HARDWARE_INTERFACE_PUBLIC
+  ~UdpSystemHardware() override;
+
+  UdpSystemHardware(const UdpSystemHardware &) = delete;
+  UdpSystemHardware & operator=(const UdpSystemHardware &) = delete;
+
+  /**
+   * \brief Parse the socket parameters and register the packet layouts with configure_layouts.
+   *
+   * \param system_info structure with data from URDF.
+   * \return return_type::OK if the parameters are valid and the layouts are registered,
+   * return_type::ERROR otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type configure(const HardwareInfo & system_info) override;
+
+  /**
+   * \brief Open and connect the socket, then start its I/O.
+   *
+   * \return return_type::OK if the socket is open, return_type::ERROR otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type start() override;
+
+  /**
+   * \brief Stop the I/O, then close the socket.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type stop() override;
+
+  /**
+   * \brief Get the status of the system.
+   *
+   * \return status::TIMED_OUT if started and no state packet was accepted for longer than the
+   * receive timeout, the status of the system otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  status get_status() const override;
+
+  /// The packets only carry joints, the sensors are left untouched.
+  HARDWARE_INTERFACE_PUBLIC
+  return_type read_sensors(
+    std::vector<std::shared_ptr<components::Sensor>> & sensors) const override;
+
+  /// The joints are only exchanged in batches.
+  /**
+   * \return return_type::ERROR
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type read_joints(std::vector<std::shared_ptr<components::Joint>> & joints) const override;
+
+  /// The joints are only exchanged in batches.
+  /**
+   * \return return_type::ERROR
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type write_joints(const std::vector<std::shared_ptr<components::Joint>> & joints) override;
+
+  HARDWARE_INTERFACE_PUBLIC
+  bool supports_joint_batches() const override;
+
+  /**
+   * \brief Decode the latest state packet received since the previous read, without blocking.
+   * The states are left untouched when no packet was received.
+   *
+   * \param states batch where the joint states are decoded into.
+   * \return return_type::ERROR if not started, if the states do not match the state layout or if
+   * the state is stale, return_type::OK otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type read_joint_batch(components::JointValuesBatch & states) const override;
+
+  /**
+   * \brief Encode the commands into a command packet and send it, without blocking.
+   *
+   * \param commands batch of joint commands which are encoded.
+   * \return return_type::ERROR if not started, if the commands do not match the command layout or
+   * if the packet could not be sent, return_type::OK otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type write_joint_batch(const components::JointValuesBatch & commands) override;
+
+  /// Get the port the socket is bound to once started, e.g. when any local port was requested.
+  HARDWARE_INTERFACE_PUBLIC
+  uint16_t get_local_port() const;
+
+  /// Get the frame I/O of the socket, e.g. for the counts of sent and dropped packets.
+  HARDWARE_INTERFACE_PUBLIC
+  const BatchedFrameIo & get_frame_io() const;
+
+  /// Get the number of state packets rejected for their size or by accept_state_packet.
+  HARDWARE_INTERFACE_PUBLIC
+  uint64_t get_rejected_packet_count() const;
+
+protected:
+  /**
+   * \brief Register the fields of the state and command packets, called by configure.
+   *
+   * \param system_info structure with data from URDF.
+   * \param state_layout layout the state packets are decoded with.
+   * \param command_layout layout the command packets are encoded with.
+   * \return return_type::OK if the layouts are registered, return_type::ERROR otherwise.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  return_type configure_layouts(
+    const HardwareInfo & system_info, PacketLayout & state_layout,
+    PacketLayout & command_layout) = 0;
+
+  /**
+   * \brief Check a received state packet before it is decoded, e.g. its header or checksum,
+   * called in the real-time thread.
+   *
+   * \param packet the state packet, of the size of the state layout at least.
+   * \return true if the packet is decoded, true by default.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  bool accept_state_packet(Span<const uint8_t> packet) const
+  {
+    (void) packet;
+    return true;
+  }
+
+  /**
+   * \brief Complete a command packet once its fields are encoded, e.g. with a sequence number or
+   * a checksum, called in the real-time thread.
+   *
+   * \param packet the command packet, of the size of the command layout.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  void finish_command_packet(Span<uint8_t> packet)
+  {
+    (void) packet;
+  }
+
+private:
+  void close_socket();
+  bool is_state_stale() const;
+
+  std::string remote_address_;
+  uint16_t remote_port_ = 0;
+  std::string local_address_;
+  uint16_t local_port_ = 0;
+  std::chrono::nanoseconds receive_timeout_;
+  bool use_io_uring_ = true;
+
+  /// Bound to the batches by the first read and write, hence mutable for the read
+  mutable PacketLayout state_layout_;
+  PacketLayout command_layout_;
+
+  int socket_ = -1;
+  std::unique_ptr<BatchedFrameIo> frame_io_;
+  status status_ = status::UNKNOWN;
+  /// Steady clock time of the latest accepted state packet, or of the start before the first one
+  mutable std::atomic<int64_t> state_stamp_ns_{0};
+  mutable std::atomic<uint64_t> rejected_packet_count_{0};
+};
+
+}  // namespace hardware_interface
+#endif  // HARDWARE_INTERFACE__UDP_SYSTEM_HARDWARE_HPP_
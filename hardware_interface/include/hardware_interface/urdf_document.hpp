@@ -0,0 +1,122 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__URDF_DOCUMENT_HPP_
+#define HARDWARE_INTERFACE__URDF_DOCUMENT_HPP_
+
+#include <istream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "hardware_interface/visibility_control.h"
+
+namespace tinyxml2
+{
+class XMLDocument;
+class XMLElement;
+}  // namespace tinyxml2
+
+namespace hardware_interface
+{
+
+/// A robot description parsed once and shared by the parsers reading it.
+/**
+ * Building the XML document dominates the cost of parsing large descriptions, this document lets
+ * parse_control_resources_from_urdf(), transmission_interface::parse_transmissions_from_urdf() and
+ * joint_limits_interface::getJointLimits() read the same parsed description.
+ * The ros2_control, transmission and joint elements under the root are indexed when parsing.
+ *
+ * With ScanMode::RELEVANT_ELEMENTS, the description is scanned as a stream instead and only the
+ * root element and its ros2_control, transmission and joint children are built as a document.
+ * The other subtrees, e.g. links with their meshes, inline geometry and materials, are skipped
+ * without being stored, so that the memory used is proportional to the elements read by the
+ * parsers rather than to the whole description. The root element then has no other children.
+ */
+class URDFDocument
+{
+public:
+  enum class ScanMode
+  {
+    /// Build the whole description as a document
+    FULL_DOCUMENT,
+    /// Build only the elements read by the parsers, skipping the other subtrees
+    RELEVANT_ELEMENTS,
+  };
+
+  /// Parse a robot description.
+  /**
+   * \param urdf string with robot's URDF
+   * \param mode whether the whole description or only the elements read by the parsers are built
+   * \throws std::runtime_error if the URDF is empty or not valid XML
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  explicit URDFDocument(const std::string & urdf, ScanMode mode = ScanMode::FULL_DOCUMENT);
+
+  /// Scan a robot description from a stream, e.g. a file, building only the relevant elements.
+  /**
+   * The description is read once, without being stored, see ScanMode::RELEVANT_ELEMENTS.
+   * \param urdf stream with robot's URDF
+   * \throws std::runtime_error if the URDF is empty or not valid XML
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  explicit URDFDocument(std::istream & urdf);
+
+  HARDWARE_INTERFACE_PUBLIC
+  ~URDFDocument();
+
+  URDFDocument(const URDFDocument &) = delete;
+  URDFDocument & operator=(const URDFDocument &) = delete;
+
+  /// The root element of the description, normally the robot tag.
+  HARDWARE_INTERFACE_PUBLIC
+  const tinyxml2::XMLElement * get_root_element() const;
+
+  /// The ros2_control elements under the root, in document order.
+  HARDWARE_INTERFACE_PUBLIC
+  const std::vector<const tinyxml2::XMLElement *> & get_ros2_control_elements() const;
+
+  /// The transmission elements under the root, in document order.
+  HARDWARE_INTERFACE_PUBLIC
+  const std::vector<const tinyxml2::XMLElement *> & get_transmission_elements() const;
+
+  /// The joint elements under the root, in document order.
+  HARDWARE_INTERFACE_PUBLIC
+  const std::vector<const tinyxml2::XMLElement *> & get_joint_elements() const;
+
+  /// Find a joint element under the root by its name.
+  /**
+   * \param name name attribute of the joint
+   * \return the first joint element with this name, nullptr if there is none
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  const tinyxml2::XMLElement * find_joint_element(const std::string & name) const;
+
+private:
+  /// Parses the XML and indexes the children of the root
+  void parse(const std::string & xml);
+  /// Scans the relevant elements of a description, then parses them
+  void scan(std::streambuf & urdf);
+
+  std::unique_ptr<tinyxml2::XMLDocument> document_;
+  std::vector<const tinyxml2::XMLElement *> ros2_control_elements_;
+  std::vector<const tinyxml2::XMLElement *> transmission_elements_;
+  std::vector<const tinyxml2::XMLElement *> joint_elements_;
+  std::unordered_map<std::string, const tinyxml2::XMLElement *> joint_elements_by_name_;
+};
+
+}  // namespace hardware_interface
+#endif  // HARDWARE_INTERFACE__URDF_DOCUMENT_HPP_
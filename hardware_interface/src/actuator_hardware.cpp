@@ -13,18 +13,23 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <chrono>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "hardware_interface/actuator_hardware.hpp"
 
 #include "hardware_interface/actuator_hardware_interface.hpp"
+#include "hardware_interface/clock_domain_map.hpp"
 #include "hardware_interface/components/component_info.hpp"
 #include "hardware_interface/components/joint.hpp"
+#include "hardware_interface/hardware_freshness.hpp"
 #include "hardware_interface/hardware_info.hpp"
 #include "hardware_interface/types/hardware_interface_return_values.hpp"
 #include "hardware_interface/types/hardware_interface_status_values.hpp"
+#include "hardware_interface/types/hardware_interface_switch_state_values.hpp"
 #include "hardware_interface/visibility_control.h"
 
 namespace hardware_interface
@@ -51,12 +56,32 @@ return_type ActuatorHardware::stop()
 
 status ActuatorHardware::get_status() const
 {
-  return impl_->get_status();
+  const status current = impl_->get_status();
+  if (current == status::STARTED && freshness_ &&
+    !freshness_->is_fresh(HardwareFreshness::get_component_mask(freshness_component_)))
+  {
+    return status::TIMED_OUT;
+  }
+  return current;
+}
+
+void ActuatorHardware::set_freshness(
+  std::shared_ptr<HardwareFreshness> freshness, size_t component)
+{
+  freshness_ = std::move(freshness);
+  freshness_component_ = component;
+}
+
+void ActuatorHardware::set_clock_domain(
+  std::shared_ptr<ClockDomainMap> clock_domains, size_t domain)
+{
+  clock_domains_ = std::move(clock_domains);
+  clock_domain_ = domain;
 }
 
 return_type ActuatorHardware::read_joint(std::shared_ptr<components::Joint> joint)
 {
-  return impl_->read_joint(joint);
+  return record_read(impl_->read_joint(joint));
 }
 
 return_type ActuatorHardware::write_joint(const std::shared_ptr<components::Joint> joint)
@@ -64,4 +89,43 @@ return_type ActuatorHardware::write_joint(const std::shared_ptr<components::Join
   return impl_->write_joint(joint);
 }
 
+return_type ActuatorHardware::prepare_mode_switch(
+  const std::vector<ControllerInfo> & start_list,
+  const std::vector<ControllerInfo> & stop_list)
+{
+  return impl_->prepare_mode_switch(start_list, stop_list);
+}
+
+return_type ActuatorHardware::perform_mode_switch(
+  const std::vector<ControllerInfo> & start_list,
+  const std::vector<ControllerInfo> & stop_list)
+{
+  return impl_->perform_mode_switch(start_list, stop_list);
+}
+
+switch_state ActuatorHardware::get_mode_switch_state() const
+{
+  return impl_->get_mode_switch_state();
+}
+
+switch_state ActuatorHardware::get_mode_switch_state(const ControllerInfo & controller) const
+{
+  return impl_->get_mode_switch_state(controller);
+}
+
+return_type ActuatorHardware::record_read(return_type ret)
+{
+  if (ret != return_type::OK) {
+    return ret;
+  }
+  if (freshness_) {
+    freshness_->record_read(freshness_component_);
+  }
+  std::chrono::nanoseconds device_time, steady_time;
+  if (clock_domains_ && impl_->get_clock_sample(device_time, steady_time)) {
+    clock_domains_->add_sample(clock_domain_, device_time, steady_time);
+  }
+  return ret;
+}
+
 }  // namespace hardware_interface
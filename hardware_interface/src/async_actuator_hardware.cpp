@@ -0,0 +1,214 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hardware_interface/async_actuator_hardware.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace
+{
+constexpr auto kLoggerName = "async actuator hardware";
+
+int64_t now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}  // namespace
+
+namespace hardware_interface
+{
+
+AsyncActuatorHardware::AsyncActuatorHardware(
+  std::unique_ptr<ActuatorHardwareInterface> driver, std::chrono::nanoseconds period,
+  std::chrono::nanoseconds timeout)
+: driver_(std::move(driver)), period_(period), timeout_(timeout)
+{}
+
+AsyncActuatorHardware::~AsyncActuatorHardware()
+{
+  stop_io_thread();
+}
+
+return_type AsyncActuatorHardware::configure(const HardwareInfo & actuator_info)
+{
+  if (io_thread_.joinable()) {
+    RCLCPP_ERROR(rclcpp::get_logger(kLoggerName), "cannot configure while started");
+    return return_type::ERROR;
+  }
+  if (actuator_info.joints.size() != 1) {
+    RCLCPP_ERROR_STREAM(
+      rclcpp::get_logger(kLoggerName),
+      "actuator '" << actuator_info.name << "' must have exactly one joint");
+    return return_type::ERROR;
+  }
+  if (driver_->configure(actuator_info) != return_type::OK) {
+    return return_type::ERROR;
+  }
+  io_joint_ = std::make_shared<components::Joint>();
+  if (io_joint_->configure(actuator_info.joints[0]) != return_type::OK) {
+    return return_type::ERROR;
+  }
+  state_buffer_ = std::make_unique<TripleBuffer<std::vector<double>>>(
+    std::vector<double>(actuator_info.joints[0].state_interfaces.size(), 0.0));
+  command_buffer_ = std::make_unique<TripleBuffer<std::vector<double>>>(
+    std::vector<double>(actuator_info.joints[0].command_interfaces.size(), 0.0));
+  status_ = status::CONFIGURED;
+  return return_type::OK;
+}
+
+return_type AsyncActuatorHardware::start()
+{
+  if (!io_joint_ || io_thread_.joinable()) {
+    return return_type::ERROR;
+  }
+  if (driver_->start() != return_type::OK) {
+    return return_type::ERROR;
+  }
+  // the driver gets one timeout to provide its first state
+  state_stamp_ns_ = now_ns();
+  io_running_ = true;
+  io_thread_ = std::thread(&AsyncActuatorHardware::io_loop, this);
+  status_ = status::STARTED;
+  return return_type::OK;
+}
+
+return_type AsyncActuatorHardware::stop()
+{
+  stop_io_thread();
+  const auto ret = driver_->stop();
+  status_ = status::STOPPED;
+  return ret;
+}
+
+status AsyncActuatorHardware::get_status() const
+{
+  const status current = status_;
+  if (current == status::STARTED && is_state_stale()) {
+    return status::TIMED_OUT;
+  }
+  return current;
+}
+
+return_type AsyncActuatorHardware::read_joint(std::shared_ptr<components::Joint> joint) const
+{
+  if (!state_buffer_) {
+    return return_type::ERROR;
+  }
+  if (state_buffer_->update()) {
+    const auto ret = joint->set_state(state_buffer_->get_read_buffer());
+    if (ret != return_type::OK) {
+      return ret;
+    }
+  }
+  return is_state_stale() ? return_type::ERROR : return_type::OK;
+}
+
+return_type AsyncActuatorHardware::write_joint(const std::shared_ptr<components::Joint> joint)
+{
+  if (!command_buffer_) {
+    return return_type::ERROR;
+  }
+  const auto ret = joint->get_command(command_buffer_->get_write_buffer());
+  if (ret == return_type::OK) {
+    command_buffer_->publish();
+  }
+  return ret;
+}
+
+return_type AsyncActuatorHardware::prepare_mode_switch(
+  const std::vector<ControllerInfo> & start_list,
+  const std::vector<ControllerInfo> & stop_list)
+{
+  return driver_->prepare_mode_switch(start_list, stop_list);
+}
+
+return_type AsyncActuatorHardware::perform_mode_switch(
+  const std::vector<ControllerInfo> & start_list,
+  const std::vector<ControllerInfo> & stop_list)
+{
+  return driver_->perform_mode_switch(start_list, stop_list);
+}
+
+switch_state AsyncActuatorHardware::get_mode_switch_state() const
+{
+  return driver_->get_mode_switch_state();
+}
+
+switch_state AsyncActuatorHardware::get_mode_switch_state(const ControllerInfo & controller) const
+{
+  return driver_->get_mode_switch_state(controller);
+}
+
+uint64_t AsyncActuatorHardware::get_io_error_count() const
+{
+  return io_error_count_;
+}
+
+void AsyncActuatorHardware::stop_io_thread()
+{
+  {
+    std::lock_guard<std::mutex> guard(io_mutex_);
+    io_running_ = false;
+  }
+  io_cv_.notify_all();
+  if (io_thread_.joinable()) {
+    io_thread_.join();
+  }
+}
+
+void AsyncActuatorHardware::io_loop()
+{
+  bool commanded = false;
+  auto next_cycle = std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> lock(io_mutex_);
+  while (io_running_) {
+    lock.unlock();
+
+    if (command_buffer_->update()) {
+      commanded = io_joint_->set_command(command_buffer_->get_read_buffer()) == return_type::OK;
+    }
+    bool io_ok = !commanded || driver_->write_joint(io_joint_) == return_type::OK;
+    if (driver_->read_joint(io_joint_) == return_type::OK &&
+      io_joint_->get_state(state_buffer_->get_write_buffer()) == return_type::OK)
+    {
+      state_buffer_->publish();
+      state_stamp_ns_ = now_ns();
+    } else {
+      io_ok = false;
+    }
+    if (!io_ok) {
+      ++io_error_count_;
+    }
+
+    lock.lock();
+    // a cycle overrunning its period starts the next one right away, without catching up
+    next_cycle = std::max(next_cycle + period_, std::chrono::steady_clock::now());
+    io_cv_.wait_until(lock, next_cycle, [this] {return !io_running_;});
+  }
+}
+
+bool AsyncActuatorHardware::is_state_stale() const
+{
+  return now_ns() - state_stamp_ns_ > timeout_.count();
+}
+
+}  // namespace hardware_interface
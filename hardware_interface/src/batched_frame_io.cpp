@@ -0,0 +1,767 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hardware_interface/batched_frame_io.hpp"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace
+{
+constexpr auto kLoggerName = "batched frame io";
+
+#ifdef __linux__
+/// Kinds of the requests, in the upper half of the user data of the io_uring entries, the tx
+/// banks by their index
+constexpr uint64_t kTxBank0Request = 0;
+constexpr uint64_t kRxRequest = 2;
+constexpr uint64_t kCancelRequest = 3;
+/// Time given to the operations in flight to be cancelled by close()
+constexpr auto kCancelTimeout = std::chrono::seconds(1);
+
+uint64_t make_user_data(uint64_t kind, size_t index)
+{
+  return kind << 32 | static_cast<uint64_t>(index);
+}
+
+bool would_block(int error)
+{
+  return error == EAGAIN || error == EWOULDBLOCK || error == EINTR;
+}
+
+/// Minimal io_uring, set up with the raw system calls rather than through liburing.
+class IoUring
+{
+public:
+  IoUring() = default;
+
+  ~IoUring()
+  {
+    release();
+  }
+
+  IoUring(const IoUring &) = delete;
+  IoUring & operator=(const IoUring &) = delete;
+
+  /// Whether the kernel has io_uring and supports the operations used, the ring is set up if so
+  bool setup(unsigned int entries)
+  {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    const long fd = syscall(__NR_io_uring_setup, entries, &params);  // NOLINT(runtime/int)
+    if (fd < 0) {
+      return false;
+    }
+    fd_ = static_cast<int>(fd);
+    if (!map(params) || !probe()) {
+      release();
+      return false;
+    }
+    return true;
+  }
+
+  /// The next submission entry, cleared, or null if the submission ring is full
+  io_uring_sqe * get_sqe()
+  {
+    const unsigned int head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    if (sq_local_tail_ - head >= sq_entries_) {
+      return nullptr;
+    }
+    const unsigned int index = sq_local_tail_ & sq_mask_;
+    sq_array_[index] = index;
+    io_uring_sqe * sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    ++sq_local_tail_;
+    return sqe;
+  }
+
+  /// Whether submission entries are queued, also the ones a failed enter() left
+  bool has_pending() const
+  {
+    return sq_local_tail_ != __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+  }
+
+  /// Submit the queued entries with one system call, -1 with errno set if it failed
+  int enter()
+  {
+    __atomic_store_n(sq_tail_, sq_local_tail_, __ATOMIC_RELEASE);
+    const unsigned int to_submit = sq_local_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    return static_cast<int>(
+      syscall(__NR_io_uring_enter, fd_, to_submit, 0, 0, nullptr, 0));
+  }
+
+  /// Call on_cqe on each completion, without any system call
+  template<typename CallbackT>
+  void reap(CallbackT && on_cqe)
+  {
+    unsigned int head = *cq_head_;
+    const unsigned int tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+      on_cqe(cqes_[head & cq_mask_]);
+      ++head;
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+  }
+
+  void release()
+  {
+    if (sqes_) {
+      munmap(sqes_, sqes_size_);
+      sqes_ = nullptr;
+    }
+    if (cq_ring_ && cq_ring_ != sq_ring_) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    cq_ring_ = nullptr;
+    if (sq_ring_) {
+      munmap(sq_ring_, sq_ring_size_);
+      sq_ring_ = nullptr;
+    }
+    if (fd_ >= 0) {
+      ::close(fd_);
+      fd_ = -1;
+    }
+  }
+
+private:
+  bool map(const io_uring_params & params)
+  {
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+      sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+    sq_ring_ = map_region(sq_ring_size_, IORING_OFF_SQ_RING);
+    if (!sq_ring_) {
+      return false;
+    }
+    cq_ring_ = single_mmap ? sq_ring_ : map_region(cq_ring_size_, IORING_OFF_CQ_RING);
+    if (!cq_ring_) {
+      return false;
+    }
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe *>(map_region(sqes_size_, IORING_OFF_SQES));
+    if (!sqes_) {
+      return false;
+    }
+
+    auto * sq = static_cast<uint8_t *>(sq_ring_);
+    sq_head_ = reinterpret_cast<unsigned int *>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned int *>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned int *>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned int *>(sq + params.sq_off.array);
+    sq_entries_ = params.sq_entries;
+    sq_local_tail_ = *sq_tail_;
+
+    auto * cq = static_cast<uint8_t *>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned int *>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned int *>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned int *>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    return true;
+  }
+
+  void * map_region(size_t size, uint64_t offset)
+  {
+    void * region = mmap(
+      nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+      static_cast<off_t>(offset));
+    return region == MAP_FAILED ? nullptr : region;
+  }
+
+  /// Whether the read, write and cancel operations are supported, from Linux 5.6
+  bool probe()
+  {
+    constexpr unsigned int kOpCount = 256;
+    std::vector<uint8_t> buffer(sizeof(io_uring_probe) + kOpCount * sizeof(io_uring_probe_op));
+    auto * probe = reinterpret_cast<io_uring_probe *>(buffer.data());
+    if (syscall(__NR_io_uring_register, fd_, IORING_REGISTER_PROBE, probe, kOpCount) < 0) {
+      return false;
+    }
+    for (const auto op : {IORING_OP_READ, IORING_OP_WRITE, IORING_OP_ASYNC_CANCEL}) {
+      if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  int fd_ = -1;
+  void * sq_ring_ = nullptr;
+  void * cq_ring_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  size_t cq_ring_size_ = 0;
+  io_uring_sqe * sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+
+  unsigned int * sq_head_ = nullptr;
+  unsigned int * sq_tail_ = nullptr;
+  unsigned int * sq_array_ = nullptr;
+  unsigned int sq_mask_ = 0;
+  unsigned int sq_entries_ = 0;
+  /// Tail of the entries queued, published to the kernel by enter()
+  unsigned int sq_local_tail_ = 0;
+
+  unsigned int * cq_head_ = nullptr;
+  unsigned int * cq_tail_ = nullptr;
+  unsigned int cq_mask_ = 0;
+  io_uring_cqe * cqes_ = nullptr;
+};
+#endif
+}  // namespace
+
+namespace hardware_interface
+{
+
+struct BatchedFrameIo::Impl
+{
+#ifdef __linux__
+  IoUring ring;
+  /// The receive buffers a read is queued or in flight on, with io_uring
+  std::vector<uint8_t> rx_in_flight;
+  size_t rx_reads_in_flight = 0;
+
+  /// Headers of the batched system calls, pointing into the buffers
+  std::vector<iovec> tx_iovecs;
+  std::vector<mmsghdr> tx_messages;
+  std::vector<iovec> rx_iovecs;
+  std::vector<mmsghdr> rx_messages;
+#endif
+};
+
+BatchedFrameIo::BatchedFrameIo(const BatchedFrameIoOptions & options)
+: options_(options)
+{
+}
+
+BatchedFrameIo::~BatchedFrameIo()
+{
+  close();
+}
+
+return_type BatchedFrameIo::open(int fd, FrameIoMode mode)
+{
+  if (is_open()) {
+    RCLCPP_ERROR(rclcpp::get_logger(kLoggerName), "already open");
+    return return_type::ERROR;
+  }
+  if (fd < 0 || options_.max_frames == 0 || options_.max_frame_size == 0) {
+    RCLCPP_ERROR(rclcpp::get_logger(kLoggerName), "invalid file descriptor or options");
+    return return_type::ERROR;
+  }
+#ifdef __linux__
+  fd_ = fd;
+  mode_ = mode;
+  const size_t buffer_size = options_.max_frames * options_.max_frame_size;
+  for (auto & bank : tx_banks_) {
+    bank.data.assign(buffer_size, 0);
+    bank.frame_sizes.assign(options_.max_frames, 0);
+    reset_bank(bank);
+    bank.writes_in_flight = 0;
+  }
+  tx_bank_ = 0;
+  rx_data_.assign(buffer_size, 0);
+  rx_sizes_.assign(get_rx_slot_count(), 0);
+  received_slots_.assign(get_rx_slot_count(), 0);
+  received_count_ = 0;
+  impl_ = std::make_unique<Impl>();
+
+  // two banks of writes, the reads and their cancellation
+  const auto ring_entries = static_cast<unsigned int>(4 * options_.max_frames);
+  if (options_.use_io_uring && impl_->ring.setup(ring_entries)) {
+    backend_ = FrameIoBackend::IO_URING;
+    impl_->rx_in_flight.assign(get_rx_slot_count(), 0);
+    impl_->rx_reads_in_flight = 0;
+    for (size_t slot = 0; slot < get_rx_slot_count(); ++slot) {
+      arm_read(slot);
+    }
+    if (impl_->ring.enter() < 0) {
+      RCLCPP_ERROR(
+        rclcpp::get_logger(kLoggerName), "could not submit the reads: %s", std::strerror(errno));
+      close();
+      return return_type::ERROR;
+    }
+    return return_type::OK;
+  }
+
+  if (mode_ == FrameIoMode::STREAM) {
+    // the syscalls of a datagram socket are made non-blocking by their flags, not a stream's
+    fd_flags_ = fcntl(fd_, F_GETFL);
+    if (fd_flags_ < 0 || fcntl(fd_, F_SETFL, fd_flags_ | O_NONBLOCK) < 0) {
+      RCLCPP_ERROR(
+        rclcpp::get_logger(kLoggerName), "could not make the stream non-blocking: %s",
+        std::strerror(errno));
+      fd_flags_ = -1;
+      close();
+      return return_type::ERROR;
+    }
+  } else {
+    auto prepare = [](
+      std::vector<uint8_t> & data, size_t frame_size, size_t frame_count,
+      std::vector<iovec> & iovecs, std::vector<mmsghdr> & messages) {
+        iovecs.resize(frame_count);
+        messages.resize(frame_count);
+        for (size_t i = 0; i < frame_count; ++i) {
+          iovecs[i].iov_base = data.data() + i * frame_size;
+          iovecs[i].iov_len = frame_size;
+          std::memset(&messages[i], 0, sizeof(messages[i]));
+          messages[i].msg_hdr.msg_iov = &iovecs[i];
+          messages[i].msg_hdr.msg_iovlen = 1;
+        }
+      };
+    // the syscalls write synchronously, the first bank is enough
+    prepare(
+      tx_banks_[0].data, options_.max_frame_size, options_.max_frames, impl_->tx_iovecs,
+      impl_->tx_messages);
+    prepare(
+      rx_data_, options_.max_frame_size, options_.max_frames, impl_->rx_iovecs,
+      impl_->rx_messages);
+  }
+  backend_ = FrameIoBackend::BATCHED_SYSCALLS;
+  return return_type::OK;
+#else
+  (void) fd;
+  (void) mode;
+  RCLCPP_ERROR(rclcpp::get_logger(kLoggerName), "only supported on Linux");
+  return return_type::ERROR;
+#endif
+}
+
+void BatchedFrameIo::close()
+{
+  if (!impl_) {
+    return;
+  }
+#ifdef __linux__
+  if (backend_ == FrameIoBackend::IO_URING) {
+    auto & ring = impl_->ring;
+    auto cancel = [&ring](uint64_t user_data) {
+        io_uring_sqe * sqe = ring.get_sqe();
+        if (sqe) {
+          sqe->opcode = IORING_OP_ASYNC_CANCEL;
+          sqe->fd = -1;
+          sqe->addr = user_data;
+          sqe->user_data = make_user_data(kCancelRequest, 0);
+        }
+      };
+    for (size_t slot = 0; slot < impl_->rx_in_flight.size(); ++slot) {
+      if (impl_->rx_in_flight[slot]) {
+        cancel(make_user_data(kRxRequest, slot));
+      }
+    }
+    for (size_t bank = 0; bank < tx_banks_.size(); ++bank) {
+      const size_t writes = mode_ == FrameIoMode::STREAM ? 1 : tx_banks_[bank].frame_count;
+      for (size_t i = 0; tx_banks_[bank].writes_in_flight > 0 && i < writes; ++i) {
+        cancel(make_user_data(kTxBank0Request + bank, i));
+      }
+    }
+    // the kernel must be done with the buffers before they are freed
+    const auto deadline = std::chrono::steady_clock::now() + kCancelTimeout;
+    while (impl_->rx_reads_in_flight > 0 || tx_banks_[0].writes_in_flight > 0 ||
+      tx_banks_[1].writes_in_flight > 0)
+    {
+      if (ring.has_pending()) {
+        ring.enter();
+      }
+      ring.reap(
+        [this](const io_uring_cqe & cqe) {
+          const uint64_t kind = cqe.user_data >> 32;
+          const size_t index = static_cast<size_t>(cqe.user_data & 0xffffffff);
+          if (kind == kRxRequest && impl_->rx_in_flight[index]) {
+            impl_->rx_in_flight[index] = 0;
+            --impl_->rx_reads_in_flight;
+          } else if (kind < kRxRequest && tx_banks_[kind].writes_in_flight > 0) {
+            --tx_banks_[kind].writes_in_flight;
+          }
+        });
+      if (std::chrono::steady_clock::now() > deadline) {
+        RCLCPP_ERROR(
+          rclcpp::get_logger(kLoggerName), "operations are still in flight, closing anyway");
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  if (fd_flags_ >= 0) {
+    fcntl(fd_, F_SETFL, fd_flags_);
+    fd_flags_ = -1;
+  }
+#endif
+  impl_.reset();
+  fd_ = -1;
+  backend_ = FrameIoBackend::NONE;
+  received_count_ = 0;
+  for (auto & bank : tx_banks_) {
+    reset_bank(bank);
+    bank.writes_in_flight = 0;
+  }
+}
+
+bool BatchedFrameIo::is_open() const
+{
+  return backend_ != FrameIoBackend::NONE;
+}
+
+FrameIoBackend BatchedFrameIo::get_backend() const
+{
+  return backend_;
+}
+
+const BatchedFrameIoOptions & BatchedFrameIo::get_options() const
+{
+  return options_;
+}
+
+return_type BatchedFrameIo::queue_frame(Span<const uint8_t> frame)
+{
+  const auto destination = reserve_frame(frame.size());
+  if (destination.data() == nullptr) {
+    return return_type::ERROR;
+  }
+  if (!frame.empty()) {
+    std::memcpy(destination.data(), frame.data(), frame.size());
+  }
+  return return_type::OK;
+}
+
+Span<uint8_t> BatchedFrameIo::reserve_frame(size_t size)
+{
+  if (!is_open() || size > options_.max_frame_size) {
+    ++dropped_frame_count_;
+    return Span<uint8_t>();
+  }
+  auto & bank = tx_banks_[tx_bank_];
+  if (bank.writes_in_flight > 0 || bank.frame_count == options_.max_frames) {
+    ++dropped_frame_count_;
+    return Span<uint8_t>();
+  }
+  uint8_t * destination = mode_ == FrameIoMode::STREAM ?
+    bank.data.data() + bank.byte_count :
+    bank.data.data() + bank.frame_count * options_.max_frame_size;
+  bank.frame_sizes[bank.frame_count++] = size;
+  bank.byte_count += size;
+  return Span<uint8_t>(destination, size);
+}
+
+size_t BatchedFrameIo::get_queued_frame_count() const
+{
+  return tx_banks_[tx_bank_].frame_count;
+}
+
+return_type BatchedFrameIo::submit()
+{
+  if (!is_open()) {
+    return return_type::ERROR;
+  }
+  auto & bank = tx_banks_[tx_bank_];
+  return backend_ == FrameIoBackend::IO_URING ? submit_io_uring(bank) : submit_syscalls(bank);
+}
+
+return_type BatchedFrameIo::reap()
+{
+  if (!is_open()) {
+    return return_type::ERROR;
+  }
+  return backend_ == FrameIoBackend::IO_URING ? reap_io_uring() : reap_syscalls();
+}
+
+size_t BatchedFrameIo::get_received_count() const
+{
+  return received_count_;
+}
+
+Span<const uint8_t> BatchedFrameIo::get_received_frame(size_t index) const
+{
+  const size_t slot = received_slots_[index];
+  return Span<const uint8_t>(rx_data_.data() + slot * options_.max_frame_size, rx_sizes_[slot]);
+}
+
+uint64_t BatchedFrameIo::get_sent_frame_count() const
+{
+  return sent_frame_count_;
+}
+
+uint64_t BatchedFrameIo::get_dropped_frame_count() const
+{
+  return dropped_frame_count_;
+}
+
+uint64_t BatchedFrameIo::get_received_frame_count() const
+{
+  return received_frame_count_;
+}
+
+uint64_t BatchedFrameIo::get_error_count() const
+{
+  return error_count_;
+}
+
+uint64_t BatchedFrameIo::get_syscall_count() const
+{
+  return syscall_count_;
+}
+
+size_t BatchedFrameIo::get_rx_slot_count() const
+{
+  return mode_ == FrameIoMode::STREAM ? 1 : options_.max_frames;
+}
+
+uint8_t * BatchedFrameIo::get_rx_slot(size_t slot)
+{
+  return rx_data_.data() + slot * options_.max_frame_size;
+}
+
+size_t BatchedFrameIo::get_rx_slot_size() const
+{
+  return mode_ == FrameIoMode::STREAM ? rx_data_.size() : options_.max_frame_size;
+}
+
+void BatchedFrameIo::reset_bank(TxBank & bank)
+{
+  bank.frame_count = 0;
+  bank.byte_count = 0;
+}
+
+void BatchedFrameIo::count_written(TxBank & bank, size_t written)
+{
+  size_t end = 0;
+  size_t sent = 0;
+  for (size_t i = 0; i < bank.frame_count; ++i) {
+    end += bank.frame_sizes[i];
+    if (end > written) {
+      break;
+    }
+    ++sent;
+  }
+  sent_frame_count_ += sent;
+  dropped_frame_count_ += bank.frame_count - sent;
+}
+
+void BatchedFrameIo::arm_read(size_t slot)
+{
+#ifdef __linux__
+  io_uring_sqe * sqe = impl_->ring.get_sqe();
+  if (!sqe) {
+    // sized not to happen, the slot is armed again with the next reaped ones
+    ++error_count_;
+    return;
+  }
+  sqe->opcode = IORING_OP_READ;
+  sqe->fd = fd_;
+  sqe->addr = reinterpret_cast<uint64_t>(get_rx_slot(slot));
+  sqe->len = static_cast<uint32_t>(get_rx_slot_size());
+  sqe->user_data = make_user_data(kRxRequest, slot);
+  impl_->rx_in_flight[slot] = 1;
+  ++impl_->rx_reads_in_flight;
+#else
+  (void) slot;
+#endif
+}
+
+return_type BatchedFrameIo::submit_io_uring(TxBank & bank)
+{
+#ifdef __linux__
+  auto & ring = impl_->ring;
+  if (bank.frame_count > 0) {
+    // the stream is written at once, the datagrams by writes linked to be sent in order
+    const size_t writes = mode_ == FrameIoMode::STREAM ? 1 : bank.frame_count;
+    for (size_t i = 0; i < writes; ++i) {
+      io_uring_sqe * sqe = ring.get_sqe();
+      if (!sqe) {
+        dropped_frame_count_ += writes - i;
+        break;
+      }
+      sqe->opcode = IORING_OP_WRITE;
+      sqe->fd = fd_;
+      if (mode_ == FrameIoMode::STREAM) {
+        sqe->addr = reinterpret_cast<uint64_t>(bank.data.data());
+        sqe->len = static_cast<uint32_t>(bank.byte_count);
+      } else {
+        sqe->addr = reinterpret_cast<uint64_t>(bank.data.data() + i * options_.max_frame_size);
+        sqe->len = static_cast<uint32_t>(bank.frame_sizes[i]);
+        if (i + 1 < writes) {
+          sqe->flags |= IOSQE_IO_LINK;
+        }
+      }
+      sqe->user_data = make_user_data(kTxBank0Request + tx_bank_, i);
+      ++bank.writes_in_flight;
+    }
+    if (bank.writes_in_flight == 0) {
+      reset_bank(bank);
+    } else {
+      // the next frames are queued while these are written
+      tx_bank_ = 1 - tx_bank_;
+    }
+  }
+  if (!ring.has_pending()) {
+    return return_type::OK;
+  }
+  ++syscall_count_;
+  if (ring.enter() < 0 && !would_block(errno) && errno != EBUSY) {
+    // the entries stay queued for the next submit()
+    ++error_count_;
+    return return_type::ERROR;
+  }
+  return return_type::OK;
+#else
+  (void) bank;
+  return return_type::ERROR;
+#endif
+}
+
+return_type BatchedFrameIo::reap_io_uring()
+{
+#ifdef __linux__
+  // the buffers of the previous frames are free, read again by the next submit()
+  for (size_t i = 0; i < received_count_; ++i) {
+    arm_read(received_slots_[i]);
+  }
+  received_count_ = 0;
+  impl_->ring.reap(
+    [this](const io_uring_cqe & cqe) {
+      const uint64_t kind = cqe.user_data >> 32;
+      const size_t index = static_cast<size_t>(cqe.user_data & 0xffffffff);
+      if (kind == kRxRequest) {
+        impl_->rx_in_flight[index] = 0;
+        --impl_->rx_reads_in_flight;
+        if (cqe.res > 0) {
+          rx_sizes_[index] = static_cast<size_t>(cqe.res);
+          received_slots_[received_count_++] = index;
+          ++received_frame_count_;
+        } else {
+          // also the end of a stream, read again rather than polled
+          if (cqe.res != 0 && cqe.res != -EAGAIN && cqe.res != -EINTR) {
+            ++error_count_;
+          }
+          arm_read(index);
+        }
+      } else if (kind < kRxRequest) {
+        auto & bank = tx_banks_[kind];
+        if (mode_ == FrameIoMode::STREAM) {
+          count_written(bank, cqe.res > 0 ? static_cast<size_t>(cqe.res) : 0);
+        } else if (cqe.res >= 0) {
+          ++sent_frame_count_;
+        } else {
+          ++dropped_frame_count_;
+        }
+        if (--bank.writes_in_flight == 0) {
+          reset_bank(bank);
+        }
+      }
+    });
+  return return_type::OK;
+#else
+  return return_type::ERROR;
+#endif
+}
+
+return_type BatchedFrameIo::submit_syscalls(TxBank & bank)
+{
+#ifdef __linux__
+  if (bank.frame_count == 0) {
+    return return_type::OK;
+  }
+  ++syscall_count_;
+  auto ret = return_type::OK;
+  if (mode_ == FrameIoMode::STREAM) {
+    const ssize_t written = ::write(fd_, bank.data.data(), bank.byte_count);
+    if (written < 0 && !would_block(errno)) {
+      ++error_count_;
+      ret = return_type::ERROR;
+    }
+    count_written(bank, written > 0 ? static_cast<size_t>(written) : 0);
+  } else {
+    for (size_t i = 0; i < bank.frame_count; ++i) {
+      impl_->tx_iovecs[i].iov_len = bank.frame_sizes[i];
+    }
+    const int sent = sendmmsg(
+      fd_, impl_->tx_messages.data(), static_cast<unsigned int>(bank.frame_count), MSG_DONTWAIT);
+    if (sent < 0 && !would_block(errno) && errno != ENOBUFS) {
+      ++error_count_;
+      ret = return_type::ERROR;
+    }
+    const size_t sent_count = sent > 0 ? static_cast<size_t>(sent) : 0;
+    sent_frame_count_ += sent_count;
+    dropped_frame_count_ += bank.frame_count - sent_count;
+  }
+  reset_bank(bank);
+  return ret;
+#else
+  (void) bank;
+  return return_type::ERROR;
+#endif
+}
+
+return_type BatchedFrameIo::reap_syscalls()
+{
+#ifdef __linux__
+  received_count_ = 0;
+  ++syscall_count_;
+  if (mode_ == FrameIoMode::STREAM) {
+    const ssize_t read = ::read(fd_, rx_data_.data(), rx_data_.size());
+    if (read < 0) {
+      if (would_block(errno)) {
+        return return_type::OK;
+      }
+      ++error_count_;
+      return return_type::ERROR;
+    }
+    if (read > 0) {
+      rx_sizes_[0] = static_cast<size_t>(read);
+      received_slots_[received_count_++] = 0;
+      ++received_frame_count_;
+    }
+    return return_type::OK;
+  }
+
+  const int received = recvmmsg(
+    fd_, impl_->rx_messages.data(), static_cast<unsigned int>(get_rx_slot_count()),
+    MSG_DONTWAIT, nullptr);
+  if (received < 0) {
+    if (would_block(errno)) {
+      return return_type::OK;
+    }
+    ++error_count_;
+    return return_type::ERROR;
+  }
+  for (size_t i = 0; i < static_cast<size_t>(received); ++i) {
+    rx_sizes_[i] = impl_->rx_messages[i].msg_len;
+    received_slots_[received_count_++] = i;
+  }
+  received_frame_count_ += static_cast<uint64_t>(received);
+  return return_type::OK;
+#else
+  return return_type::ERROR;
+#endif
+}
+
+}  // namespace hardware_interface
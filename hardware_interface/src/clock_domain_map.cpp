@@ -0,0 +1,226 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hardware_interface/clock_domain_map.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace hardware_interface
+{
+
+constexpr size_t ClockDomainMap::MAX_DOMAINS;
+constexpr size_t ClockDomainMap::WINDOW_SIZE;
+
+ClockDomainMap::ClockDomainMap(std::chrono::nanoseconds sample_interval)
+: sample_interval_ns_(sample_interval.count())
+{
+}
+
+return_type ClockDomainMap::add_domain(
+  const std::string & name, const std::vector<std::string> & joint_names, size_t & domain)
+{
+  std::lock_guard<std::mutex> guard(add_mutex_);
+  const size_t count = domain_count_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < count; ++i) {
+    if (domains_[i].name == name) {
+      auto & existing = domains_[i].joint_names;
+      existing.insert(existing.end(), joint_names.begin(), joint_names.end());
+      domain = i;
+      return return_type::OK;
+    }
+  }
+  if (count == MAX_DOMAINS) {
+    return return_type::ERROR;
+  }
+  domains_[count].name = name;
+  domains_[count].joint_names = joint_names;
+  // publishes the domain to the real-time threads
+  domain_count_.store(count + 1, std::memory_order_release);
+  domain = count;
+  return return_type::OK;
+}
+
+size_t ClockDomainMap::get_domain_count() const
+{
+  return domain_count_.load(std::memory_order_acquire);
+}
+
+const std::string & ClockDomainMap::get_domain_name(size_t domain) const
+{
+  return domains_[domain].name;
+}
+
+return_type ClockDomainMap::find_joint_domain(
+  const std::string & joint_name, size_t & domain) const
+{
+  const size_t count = get_domain_count();
+  for (size_t i = 0; i < count; ++i) {
+    const auto & joint_names = domains_[i].joint_names;
+    if (std::find(joint_names.begin(), joint_names.end(), joint_name) != joint_names.end()) {
+      domain = i;
+      return return_type::OK;
+    }
+  }
+  return return_type::ERROR;
+}
+
+bool ClockDomainMap::add_sample(
+  size_t domain, std::chrono::nanoseconds device_time, std::chrono::nanoseconds steady_time)
+{
+  auto & fed = domains_[domain];
+  if (fed.feeding.test_and_set(std::memory_order_acquire)) {
+    return false;
+  }
+  const int64_t device_ns = device_time.count();
+  const int64_t steady_ns = steady_time.count();
+  if (fed.sample_count > 0 && device_ns <= fed.last_device_ns) {
+    fed.feeding.clear(std::memory_order_release);
+    return false;
+  }
+  fed.last_device_ns = device_ns;
+
+  if (fed.sample_count == 0 || device_ns - fed.interval_start_ns >= sample_interval_ns_) {
+    fed.latest = fed.sample_count == 0 ? 0 : (fed.latest + 1) % WINDOW_SIZE;
+    fed.device_ns[fed.latest] = device_ns;
+    fed.steady_ns[fed.latest] = steady_ns;
+    fed.sample_count = std::min(fed.sample_count + 1, WINDOW_SIZE);
+    fed.interval_start_ns = device_ns;
+    fit(fed);
+  } else if (steady_ns - device_ns < fed.steady_ns[fed.latest] - fed.device_ns[fed.latest]) {
+    // received faster than the pair kept for the interval, the drift within one interval is
+    // negligible
+    fed.device_ns[fed.latest] = device_ns;
+    fed.steady_ns[fed.latest] = steady_ns;
+    fit(fed);
+  }
+  fed.feeding.clear(std::memory_order_release);
+  return true;
+}
+
+bool ClockDomainMap::is_synchronized(size_t domain) const
+{
+  return domains_[domain].synchronized.load(std::memory_order_acquire);
+}
+
+return_type ClockDomainMap::to_steady(
+  size_t domain, std::chrono::nanoseconds device_time,
+  std::chrono::nanoseconds & steady_time) const
+{
+  if (!is_synchronized(domain)) {
+    return return_type::ERROR;
+  }
+  const Estimate estimate = load(domains_[domain]);
+  const double elapsed = static_cast<double>(device_time.count() - estimate.device_ns);
+  steady_time = std::chrono::nanoseconds(
+    estimate.steady_ns + static_cast<int64_t>(std::llround(elapsed * estimate.rate)));
+  return return_type::OK;
+}
+
+std::chrono::nanoseconds ClockDomainMap::get_offset(size_t domain) const
+{
+  const Estimate estimate = load(domains_[domain]);
+  return std::chrono::nanoseconds(estimate.steady_ns - estimate.device_ns);
+}
+
+double ClockDomainMap::get_drift(size_t domain) const
+{
+  return load(domains_[domain]).rate - 1.0;
+}
+
+void ClockDomainMap::reset(size_t domain)
+{
+  auto & fed = domains_[domain];
+  // spins only while a pair is being added
+  while (fed.feeding.test_and_set(std::memory_order_acquire)) {}
+  fed.sample_count = 0;
+  fed.latest = 0;
+  fed.interval_start_ns = 0;
+  fed.last_device_ns = 0;
+  fed.synchronized.store(false, std::memory_order_release);
+  publish(fed, {0, 0, 1.0});
+  fed.feeding.clear(std::memory_order_release);
+}
+
+void ClockDomainMap::fit(Domain & domain)
+{
+  if (domain.sample_count < 2) {
+    return;
+  }
+  // relative to the latest pair, for the differences to be exact in double precision
+  const int64_t device_ref = domain.device_ns[domain.latest];
+  const int64_t steady_ref = domain.steady_ns[domain.latest];
+  double mean_x = 0.0, mean_y = 0.0;
+  for (size_t i = 0; i < domain.sample_count; ++i) {
+    mean_x += static_cast<double>(domain.device_ns[i] - device_ref);
+    mean_y += static_cast<double>(domain.steady_ns[i] - steady_ref);
+  }
+  mean_x /= static_cast<double>(domain.sample_count);
+  mean_y /= static_cast<double>(domain.sample_count);
+  double covariance = 0.0, variance = 0.0;
+  for (size_t i = 0; i < domain.sample_count; ++i) {
+    const double dx = static_cast<double>(domain.device_ns[i] - device_ref) - mean_x;
+    const double dy = static_cast<double>(domain.steady_ns[i] - steady_ref) - mean_y;
+    covariance += dx * dy;
+    variance += dx * dx;
+  }
+  // the device times of the window are distinct, the variance is not zero
+  const double rate = covariance / variance;
+  // the fastest pair lies the lowest under the fitted slope
+  double min_residual = 0.0;
+  for (size_t i = 0; i < domain.sample_count; ++i) {
+    const double x = static_cast<double>(domain.device_ns[i] - device_ref);
+    const double y = static_cast<double>(domain.steady_ns[i] - steady_ref);
+    min_residual = std::min(min_residual, y - rate * x);
+  }
+  publish(
+    domain, {device_ref, steady_ref + static_cast<int64_t>(std::llround(min_residual)), rate});
+}
+
+void ClockDomainMap::publish(Domain & domain, const Estimate & estimate)
+{
+  const uint64_t sequence = domain.sequence.load(std::memory_order_relaxed);
+  domain.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  domain.reference_device_ns.store(estimate.device_ns, std::memory_order_relaxed);
+  domain.reference_steady_ns.store(estimate.steady_ns, std::memory_order_relaxed);
+  domain.rate.store(estimate.rate, std::memory_order_relaxed);
+  domain.sequence.store(sequence + 2, std::memory_order_release);
+  if (domain.sample_count >= 2) {
+    domain.synchronized.store(true, std::memory_order_release);
+  }
+}
+
+ClockDomainMap::Estimate ClockDomainMap::load(const Domain & domain) const
+{
+  Estimate estimate;
+  uint64_t before = 0;
+  uint64_t after = 0;
+  do {
+    before = domain.sequence.load(std::memory_order_acquire);
+    estimate.device_ns = domain.reference_device_ns.load(std::memory_order_relaxed);
+    estimate.steady_ns = domain.reference_steady_ns.load(std::memory_order_relaxed);
+    estimate.rate = domain.rate.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    after = domain.sequence.load(std::memory_order_relaxed);
+  } while ((before & 1) != 0 || before != after);
+  return estimate;
+}
+
+}  // namespace hardware_interface
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <tinyxml2.h>
+#include <cstring>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
@@ -21,6 +22,9 @@
 #include "hardware_interface/components/component_info.hpp"
 #include "hardware_interface/hardware_info.hpp"
 #include "hardware_interface/component_parser.hpp"
+#include "hardware_interface/tracing.hpp"
+#include "hardware_interface/typed_parameters.hpp"
+#include "hardware_interface/urdf_document.hpp"
 
 namespace
 {
@@ -46,15 +50,20 @@ namespace detail
  *
  * \param element_it XMLElement iterator to search for the text.
  * \param tag_name parent tag name where text is searched for (used for error output)
+ * \param owner_name name of the element owning the tag, if any (used for error output)
  * \return text of for the tag
  * \throws std::runtime_error if text is not found
  */
 std::string get_text_for_element(
-  const tinyxml2::XMLElement * element_it, const std::string & tag_name)
+  const tinyxml2::XMLElement * element_it, const char * tag_name,
+  const char * owner_name = nullptr)
 {
   const auto get_text_output = element_it->GetText();
   if (!get_text_output) {
-    throw std::runtime_error("text not specified in the " + tag_name + " tag");
+    // the message is only built on failure, parsing valid descriptions copies no tag names
+    throw std::runtime_error(
+            "text not specified in the " +
+            (owner_name ? std::string(owner_name) + " " : std::string()) + tag_name + " tag");
   }
   return get_text_output;
 }
@@ -72,33 +81,14 @@ std::string get_text_for_element(
 std::string get_attribute_value(
   const tinyxml2::XMLElement * element_it,
   const char * attribute_name,
-  std::string tag_name)
+  const char * tag_name)
 {
-  const tinyxml2::XMLAttribute * attr;
-  attr = element_it->FindAttribute(attribute_name);
+  const tinyxml2::XMLAttribute * attr = element_it->FindAttribute(attribute_name);
   if (!attr) {
     throw std::runtime_error(
             "no attribute " + std::string(attribute_name) + " in " + tag_name + " tag");
   }
-  return element_it->Attribute(attribute_name);
-}
-
-/**
- * \brief Gets value of the attribute on an XMLelement.
- * If attribute is not found throws an error.
- *
- * \param element_it XMLElement iterator to search for the attribute
- * \param attribute_name atribute name to serach for and return value
- * \param tag_name parent tag name where attribute is searched for (used for error output)
- * \return attribute value
- * \throws std::runtime_error if attribute is not found
- */
-std::string get_attribute_value(
-  const tinyxml2::XMLElement * element_it,
-  const char * attribute_name,
-  const char * tag_name)
-{
-  return get_attribute_value(element_it, attribute_name, std::string(tag_name));
+  return attr->Value();
 }
 
 /**
@@ -120,9 +110,7 @@ std::unordered_map<std::string, std::string> parse_parameters_from_xml(
     if (!attr) {
       throw std::runtime_error("no parameter name attribute set in param tag");
     }
-    const std::string parameter_name = params_it->Attribute("name");
-    const std::string parameter_value = get_text_for_element(params_it, parameter_name);
-    parameters[parameter_name] = parameter_value;
+    parameters[attr->Value()] = get_text_for_element(params_it, attr->Value());
 
     params_it = params_it->NextSiblingElement(kParamTag);
   }
@@ -143,9 +131,7 @@ std::vector<std::string> parse_interfaces_from_xml(
   std::vector<std::string> interfaces;
 
   while (interfaces_it) {
-    const std::string interface_type = get_text_for_element(
-      interfaces_it, std::string(interfaceTag) + " type ");
-    interfaces.push_back(interface_type);
+    interfaces.push_back(get_text_for_element(interfaces_it, interfaceTag));
     interfaces_it = interfaces_it->NextSiblingElement(interfaceTag);
   }
   return interfaces;
@@ -164,13 +150,14 @@ components::ComponentInfo parse_component_from_xml(const tinyxml2::XMLElement *
 
   // Find name, type and class of a component
   component.type = component_it->Name();
-  component.name = get_attribute_value(component_it, "name", component.type);
+  component.name = get_attribute_value(component_it, "name", component_it->Name());
 
   const auto * classType_it = component_it->FirstChildElement(kClassTypeTag);
   if (!classType_it) {
     throw std::runtime_error("no class type tag found in " + component.name);
   }
-  component.class_type = get_text_for_element(classType_it, component.name + " " + kClassTypeTag);
+  component.class_type = get_text_for_element(
+    classType_it, kClassTypeTag, component.name.c_str());
 
   // Parse commandInterfaceType tags
   const auto * command_interfaces_it = component_it->FirstChildElement(kCommandInterfaceTypeTag);
@@ -212,22 +199,25 @@ HardwareInfo parse_resource_from_xml(const tinyxml2::XMLElement * ros2_control_i
   hardware.hardware_class_type = "";
   const auto * ros2_control_child_it = ros2_control_it->FirstChildElement();
   while (ros2_control_child_it) {
-    if (!std::string(kHardwareTag).compare(ros2_control_child_it->Name())) {
+    const char * child_name = ros2_control_child_it->Name();
+    if (!std::strcmp(kHardwareTag, child_name)) {
       const auto * type_it = ros2_control_child_it->FirstChildElement(kClassTypeTag);
-      hardware.hardware_class_type = get_text_for_element(
-        type_it, std::string("hardware ") + kClassTypeTag);
+      if (!type_it) {
+        throw std::runtime_error("no class type tag found in hardware");
+      }
+      hardware.hardware_class_type = get_text_for_element(type_it, kClassTypeTag, kHardwareTag);
       const auto * params_it = ros2_control_child_it->FirstChildElement(kParamTag);
       if (params_it) {
         hardware.hardware_parameters = parse_parameters_from_xml(params_it);
       }
-    } else if (!std::string(kJointTag).compare(ros2_control_child_it->Name())) {
+    } else if (!std::strcmp(kJointTag, child_name)) {
       hardware.joints.push_back(parse_component_from_xml(ros2_control_child_it) );
-    } else if (!std::string(kSensorTag).compare(ros2_control_child_it->Name())) {
+    } else if (!std::strcmp(kSensorTag, child_name)) {
       hardware.sensors.push_back(parse_component_from_xml(ros2_control_child_it) );
-    } else if (!std::string(kTransmissionTag).compare(ros2_control_child_it->Name())) {
+    } else if (!std::strcmp(kTransmissionTag, child_name)) {
       hardware.transmissions.push_back(parse_component_from_xml(ros2_control_child_it) );
     } else {
-      throw std::runtime_error("invalid tag name " + std::string(ros2_control_child_it->Name()));
+      throw std::runtime_error("invalid tag name " + std::string(child_name));
     }
     ros2_control_child_it = ros2_control_child_it->NextSiblingElement();
   }
@@ -243,33 +233,58 @@ std::vector<HardwareInfo> parse_control_resources_from_urdf(const std::string &
   if (urdf.empty()) {
     throw std::runtime_error("empty URDF passed to robot");
   }
-  tinyxml2::XMLDocument doc;
-  if (!doc.Parse(urdf.c_str()) && doc.Error()) {
-    throw std::runtime_error("invalid URDF passed in to robot parser");
-  }
-  if (doc.Error()) {
-    throw std::runtime_error("invalid URDF passed in to robot parser");
-  }
+  return parse_control_resources_from_urdf(URDFDocument(urdf));
+}
 
+std::vector<HardwareInfo> parse_control_resources_from_urdf(const URDFDocument & urdf)
+{
+  HARDWARE_INTERFACE_TRACE_SCOPE("parse_control_resources", "");
   // Find robot tag
-  const tinyxml2::XMLElement * robot_it = doc.RootElement();
+  const tinyxml2::XMLElement * robot_it = urdf.get_root_element();
 
-  if (std::string(kRobotTag).compare(robot_it->Name())) {
+  if (std::strcmp(kRobotTag, robot_it->Name())) {
     throw std::runtime_error("the robot tag is not root element in URDF");
   }
 
-  const tinyxml2::XMLElement * ros2_control_it = robot_it->FirstChildElement(kROS2ControlTag);
-  if (!ros2_control_it) {
+  const auto & ros2_control_elements = urdf.get_ros2_control_elements();
+  if (ros2_control_elements.empty()) {
     throw std::runtime_error("no " + std::string(kROS2ControlTag) + " tag");
   }
 
   std::vector<HardwareInfo> hardware_info;
-  while (ros2_control_it) {
+  hardware_info.reserve(ros2_control_elements.size());
+  for (const auto * ros2_control_it : ros2_control_elements) {
     hardware_info.push_back(detail::parse_resource_from_xml(ros2_control_it));
-    ros2_control_it = ros2_control_it->NextSiblingElement(kROS2ControlTag);
   }
 
   return hardware_info;
 }
 
+std::vector<HardwareInfo> parse_control_resources_from_urdf(
+  const URDFDocument & urdf,
+  const std::unordered_map<std::string, HardwareParameterSchema> & schemas)
+{
+  auto hardware_info = parse_control_resources_from_urdf(urdf);
+  for (auto & hardware : hardware_info) {
+    const auto schema = schemas.find(hardware.hardware_class_type);
+    if (schema != schemas.end()) {
+      parse_typed_parameters(schema->second, hardware);
+    }
+  }
+  return hardware_info;
+}
+
+void parse_typed_parameters(const HardwareParameterSchema & schema, HardwareInfo & hardware)
+{
+  hardware.typed_hardware_parameters =
+    schema.hardware_parameters.parse(hardware.hardware_parameters, "hardware " + hardware.name);
+  for (auto & joint : hardware.joints) {
+    joint.typed_parameters = schema.joint_parameters.parse(joint.parameters, "joint " + joint.name);
+  }
+  for (auto & sensor : hardware.sensors) {
+    sensor.typed_parameters =
+      schema.sensor_parameters.parse(sensor.parameters, "sensor " + sensor.name);
+  }
+}
+
 }  // namespace hardware_interface
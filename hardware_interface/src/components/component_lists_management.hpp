@@ -19,6 +19,9 @@
 #include <string>
 #include <vector>
 
+#include "hardware_interface/components/interface_selector.hpp"
+#include "hardware_interface/interface_type_id.hpp"
+#include "hardware_interface/span.hpp"
 #include "hardware_interface/types/hardware_interface_return_values.hpp"
 #include "hardware_interface/visibility_control.h"
 
@@ -137,6 +140,119 @@ inline return_type set_internal_values(
   return return_type::OK;
 }
 
+/**
+ * \brief Resolve queried_interfaces to the indices of their values in int_interfaces, either by
+ * name or by interned InterfaceTypeId.
+ *
+ * \param selector resolved interfaces.
+ * \param queried_interfaces interfaces to resolve.
+ * \param int_interfaces full list of interfaces of a component.
+ * \return return_type::INTERFACE_NOT_FOUND if one of queried_interfaces is not defined in
+ * int_interfaces; return return_type::INTERFACE_NOT_PROVIDED if queried_interfaces list is empty;
+ * return_type::OK otherwise.
+ */
+template<typename InterfaceT>
+inline return_type resolve_interfaces(
+  InterfaceSelector & selector, const std::vector<InterfaceT> & queried_interfaces,
+  const std::vector<InterfaceT> & int_interfaces)
+{
+  if (queried_interfaces.size() == 0) {
+    return return_type::INTERFACE_NOT_PROVIDED;
+  }
+
+  std::vector<size_t> indices;
+  indices.reserve(queried_interfaces.size());
+  for (const auto & interface : queried_interfaces) {
+    auto it = std::find(int_interfaces.begin(), int_interfaces.end(), interface);
+    if (it == int_interfaces.end()) {
+      return return_type::INTERFACE_NOT_FOUND;
+    }
+    indices.push_back(static_cast<size_t>(std::distance(int_interfaces.begin(), it)));
+  }
+  selector = InterfaceSelector(std::move(indices));
+  return return_type::OK;
+}
+
+/**
+ * \brief Intern the interfaces of a component, once when it is configured.
+ *
+ * \param interfaces names of the interfaces.
+ * \return the interned ids of the interfaces, in the same order.
+ */
+inline std::vector<InterfaceTypeId> intern_interfaces(const std::vector<std::string> & interfaces)
+{
+  std::vector<InterfaceTypeId> ids;
+  ids.reserve(interfaces.size());
+  for (const auto & interface : interfaces) {
+    ids.push_back(InterfaceTypeId::intern(interface));
+  }
+  return ids;
+}
+
+/**
+ * \brief Get values for the interfaces of the selector from the int_values, without allocating.
+ *
+ * \param values values to return, same size as the selector.
+ * \param selector interfaces resolved by resolve_interfaces().
+ * \param int_values internal values of a component.
+ * \return return_type::INTERFACE_NOT_PROVIDED if the selector is empty;
+ * return_type::INTERFACE_VALUE_SIZE_NOT_EQUAL if values and selector do not have the same length;
+ * return_type::INTERFACE_NOT_FOUND if the selector was not resolved for this component;
+ * return_type::OK otherwise.
+ */
+inline return_type get_internal_values(
+  Span<double> values, const InterfaceSelector & selector, const std::vector<double> & int_values)
+{
+  if (selector.empty()) {
+    return return_type::INTERFACE_NOT_PROVIDED;
+  }
+  if (values.size() != selector.size()) {
+    return return_type::INTERFACE_VALUE_SIZE_NOT_EQUAL;
+  }
+
+  const auto & indices = selector.get_indices();
+  for (size_t i = 0; i < indices.size(); ++i) {
+    if (indices[i] >= int_values.size()) {
+      return return_type::INTERFACE_NOT_FOUND;
+    }
+    values[i] = int_values[indices[i]];
+  }
+  return return_type::OK;
+}
+
+/**
+ * \brief Set values for the interfaces of the selector to the int_values.
+ *
+ * \param values values to set, same size as the selector.
+ * \param selector interfaces resolved by resolve_interfaces().
+ * \param int_values internal values of a component.
+ * \return return_type::INTERFACE_NOT_PROVIDED if the selector is empty;
+ * return_type::INTERFACE_VALUE_SIZE_NOT_EQUAL if values and selector do not have the same length;
+ * return_type::INTERFACE_NOT_FOUND if the selector was not resolved for this component;
+ * return_type::OK otherwise.
+ */
+inline return_type set_internal_values(
+  Span<const double> values, const InterfaceSelector & selector, std::vector<double> & int_values)
+{
+  if (selector.empty()) {
+    return return_type::INTERFACE_NOT_PROVIDED;
+  }
+  if (values.size() != selector.size()) {
+    return return_type::INTERFACE_VALUE_SIZE_NOT_EQUAL;
+  }
+
+  const auto & indices = selector.get_indices();
+  for (const auto index : indices) {
+    if (index >= int_values.size()) {
+      return return_type::INTERFACE_NOT_FOUND;
+    }
+  }
+  for (size_t i = 0; i < indices.size(); ++i) {
+    int_values[indices[i]] = values[i];
+  }
+  return return_type::OK;
+}
+
 }  // namespace components
 }  // namespace hardware_interface
 #endif  // COMPONENTS__COMPONENT_LISTS_MANAGEMENT_HPP_
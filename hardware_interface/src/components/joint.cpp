@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <chrono>
 #include <string>
 #include <vector>
 
@@ -29,6 +30,8 @@ namespace components
 return_type Joint::configure(const ComponentInfo & joint_info)
 {
   info_ = joint_info;
+  command_interface_ids_ = intern_interfaces(info_.command_interfaces);
+  state_interface_ids_ = intern_interfaces(info_.state_interfaces);
   if (info_.command_interfaces.size() > 0) {
     commands_.resize(info_.command_interfaces.size());
   }
@@ -48,6 +51,16 @@ std::vector<std::string> Joint::get_state_interfaces() const
   return info_.state_interfaces;
 }
 
+std::vector<InterfaceTypeId> Joint::get_command_interface_ids() const
+{
+  return command_interface_ids_;
+}
+
+std::vector<InterfaceTypeId> Joint::get_state_interface_ids() const
+{
+  return state_interface_ids_;
+}
+
 return_type Joint::get_command(
   std::vector<double> & command, const std::vector<std::string> & interfaces) const
 {
@@ -92,5 +105,59 @@ return_type Joint::set_state(const std::vector<double> & state)
   return set_internal_values(state, states_);
 }
 
+return_type Joint::get_command_interface_selector(
+  InterfaceSelector & selector, const std::vector<std::string> & interfaces) const
+{
+  return resolve_interfaces(selector, interfaces, info_.command_interfaces);
+}
+
+return_type Joint::get_state_interface_selector(
+  InterfaceSelector & selector, const std::vector<std::string> & interfaces) const
+{
+  return resolve_interfaces(selector, interfaces, info_.state_interfaces);
+}
+
+return_type Joint::get_command_interface_selector(
+  InterfaceSelector & selector, const std::vector<InterfaceTypeId> & interfaces) const
+{
+  return resolve_interfaces(selector, interfaces, command_interface_ids_);
+}
+
+return_type Joint::get_state_interface_selector(
+  InterfaceSelector & selector, const std::vector<InterfaceTypeId> & interfaces) const
+{
+  return resolve_interfaces(selector, interfaces, state_interface_ids_);
+}
+
+return_type Joint::get_command(Span<double> command, const InterfaceSelector & selector) const
+{
+  return get_internal_values(command, selector, commands_);
+}
+
+return_type Joint::set_command(Span<const double> command, const InterfaceSelector & selector)
+{
+  return set_internal_values(command, selector, commands_);
+}
+
+return_type Joint::get_state(Span<double> state, const InterfaceSelector & selector) const
+{
+  return get_internal_values(state, selector, states_);
+}
+
+return_type Joint::set_state(Span<const double> state, const InterfaceSelector & selector)
+{
+  return set_internal_values(state, selector, states_);
+}
+
+void Joint::set_state_stamp(std::chrono::nanoseconds stamp)
+{
+  state_stamp_ = stamp;
+}
+
+std::chrono::nanoseconds Joint::get_state_stamp() const
+{
+  return state_stamp_;
+}
+
 }  // namespace components
 }  // namespace hardware_interface
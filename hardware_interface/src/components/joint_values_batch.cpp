@@ -0,0 +1,89 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "hardware_interface/components/joint_values_batch.hpp"
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+
+namespace hardware_interface
+{
+namespace components
+{
+
+JointValuesBatch::JointValuesBatch(
+  size_t joint_count, const std::vector<std::string> & interfaces)
+: interfaces_(interfaces),
+  joint_count_(joint_count),
+  values_(joint_count * interfaces.size(), 0.0)
+{
+}
+
+const std::vector<std::string> & JointValuesBatch::get_interfaces() const
+{
+  return interfaces_;
+}
+
+size_t JointValuesBatch::get_joint_count() const
+{
+  return joint_count_;
+}
+
+return_type JointValuesBatch::get_interface_index(
+  const std::string & interface, size_t & interface_index) const
+{
+  auto it = std::find(interfaces_.begin(), interfaces_.end(), interface);
+  if (it == interfaces_.end()) {
+    return return_type::INTERFACE_NOT_FOUND;
+  }
+  interface_index = static_cast<size_t>(std::distance(interfaces_.begin(), it));
+  return return_type::OK;
+}
+
+Span<double> JointValuesBatch::get_values(size_t interface_index)
+{
+  return Span<double>(values_.data() + interface_index * joint_count_, joint_count_);
+}
+
+Span<const double> JointValuesBatch::get_values(size_t interface_index) const
+{
+  return Span<const double>(values_.data() + interface_index * joint_count_, joint_count_);
+}
+
+Span<double> JointValuesBatch::get_all_values()
+{
+  return values_;
+}
+
+Span<const double> JointValuesBatch::get_all_values() const
+{
+  return values_;
+}
+
+void JointValuesBatch::set_stamp(std::chrono::nanoseconds stamp)
+{
+  stamp_ = stamp;
+}
+
+std::chrono::nanoseconds JointValuesBatch::get_stamp() const
+{
+  return stamp_;
+}
+
+}  // namespace components
+}  // namespace hardware_interface
@@ -12,6 +12,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -25,13 +30,44 @@ namespace hardware_interface
 {
 namespace components
 {
+namespace
+{
+/// Parse a strictly positive integer.
+bool parse_capacity(const std::string & text, size_t & capacity)
+{
+  if (text.empty() || !std::all_of(text.begin(), text.end(), ::isdigit)) {
+    return false;
+  }
+  try {
+    capacity = static_cast<size_t>(std::stoull(text));
+  } catch (const std::out_of_range &) {
+    return false;
+  }
+  return capacity > 0;
+}
+}  // namespace
+
+constexpr const char * Sensor::SAMPLE_QUEUE_CAPACITY_PARAMETER;
 
 return_type Sensor::configure(const ComponentInfo & joint_info)
 {
   info_ = joint_info;
+  state_interface_ids_ = intern_interfaces(info_.state_interfaces);
   if (info_.state_interfaces.size() > 0) {
     states_.resize(info_.state_interfaces.size());
   }
+  sample_queue_.reset();
+  if (configure_filter_chain() != return_type::OK) {
+    return return_type::ERROR;
+  }
+  const auto capacity_it = info_.parameters.find(SAMPLE_QUEUE_CAPACITY_PARAMETER);
+  if (capacity_it != info_.parameters.end()) {
+    size_t capacity = 0;
+    if (!parse_capacity(capacity_it->second, capacity)) {
+      return return_type::ERROR;
+    }
+    return enable_sample_queue(capacity);
+  }
   return return_type::OK;
 }
 
@@ -40,6 +76,11 @@ std::vector<std::string> Sensor::get_state_interfaces() const
   return info_.state_interfaces;
 }
 
+std::vector<InterfaceTypeId> Sensor::get_state_interface_ids() const
+{
+  return state_interface_ids_;
+}
+
 return_type Sensor::get_state(
   std::vector<double> & state, const std::vector<std::string> & interfaces) const
 {
@@ -62,5 +103,205 @@ return_type Sensor::set_state(const std::vector<double> & state)
   return set_internal_values(state, states_);
 }
 
+return_type Sensor::get_state_interface_selector(
+  InterfaceSelector & selector, const std::vector<InterfaceTypeId> & interfaces) const
+{
+  return resolve_interfaces(selector, interfaces, state_interface_ids_);
+}
+
+return_type Sensor::get_state(Span<double> state, const InterfaceSelector & selector) const
+{
+  return get_internal_values(state, selector, states_);
+}
+
+return_type Sensor::set_state(Span<const double> state, const InterfaceSelector & selector)
+{
+  return set_internal_values(state, selector, states_);
+}
+
+return_type Sensor::enable_state_buffer()
+{
+  if (states_.empty()) {
+    return return_type::ERROR;
+  }
+  StampedState initial_state;
+  initial_state.values = states_;
+  state_buffer_ = std::make_unique<TripleBuffer<StampedState>>(initial_state);
+  state_stamp_ = std::chrono::nanoseconds(0);
+  return return_type::OK;
+}
+
+bool Sensor::is_state_buffer_enabled() const
+{
+  return state_buffer_ != nullptr;
+}
+
+return_type Sensor::publish_state(Span<const double> state, std::chrono::nanoseconds stamp)
+{
+  if (!state_buffer_) {
+    return return_type::ERROR;
+  }
+  auto & sample = state_buffer_->get_write_buffer();
+  if (state.size() != sample.values.size()) {
+    return return_type::INTERFACE_VALUE_SIZE_NOT_EQUAL;
+  }
+  std::copy(state.begin(), state.end(), sample.values.begin());
+  sample.stamp = stamp;
+  state_buffer_->publish();
+  return return_type::OK;
+}
+
+bool Sensor::update_state()
+{
+  if (!state_buffer_ || !state_buffer_->update()) {
+    return false;
+  }
+  // the read buffer is owned by this thread until the next update, trade it for the states
+  auto & sample = state_buffer_->get_read_buffer();
+  states_.swap(sample.values);
+  state_stamp_ = sample.stamp;
+  return true;
+}
+
+void Sensor::set_state_stamp(std::chrono::nanoseconds stamp)
+{
+  state_stamp_ = stamp;
+}
+
+std::chrono::nanoseconds Sensor::get_state_stamp() const
+{
+  return state_stamp_;
+}
+
+return_type Sensor::enable_sample_queue(size_t capacity)
+{
+  if (capacity == 0 || states_.empty()) {
+    return return_type::ERROR;
+  }
+  sample_queue_ = std::make_unique<SampleQueue>(states_.size(), capacity);
+  taken_sample_values_.assign(states_.size() * capacity, 0.0);
+  taken_sample_stamps_.assign(capacity, std::chrono::nanoseconds(0));
+  taken_sample_count_ = 0;
+  return return_type::OK;
+}
+
+bool Sensor::is_sample_queue_enabled() const
+{
+  return sample_queue_ != nullptr;
+}
+
+size_t Sensor::get_sample_queue_capacity() const
+{
+  return sample_queue_ ? sample_queue_->get_capacity() : 0;
+}
+
+return_type Sensor::push_sample(Span<const double> state, std::chrono::nanoseconds stamp)
+{
+  if (!sample_queue_) {
+    return return_type::ERROR;
+  }
+  if (state.size() != sample_queue_->get_sample_size()) {
+    return return_type::INTERFACE_VALUE_SIZE_NOT_EQUAL;
+  }
+  return sample_queue_->push(state, stamp) ? return_type::OK : return_type::ERROR;
+}
+
+SampleSpan Sensor::take_samples()
+{
+  if (!sample_queue_) {
+    return SampleSpan();
+  }
+  taken_sample_count_ = sample_queue_->pop(taken_sample_values_, taken_sample_stamps_);
+  const auto sample_size = sample_queue_->get_sample_size();
+  if (taken_sample_count_ > 0) {
+    // derived sensors may have resized the states since the queue was enabled
+    states_.resize(sample_size);
+    const auto latest = taken_sample_values_.begin() + (taken_sample_count_ - 1) * sample_size;
+    std::copy_n(latest, sample_size, states_.begin());
+    state_stamp_ = taken_sample_stamps_[taken_sample_count_ - 1];
+    taken_samples_filtered_ = false;
+  }
+  return get_samples();
+}
+
+SampleSpan Sensor::get_samples() const
+{
+  if (!sample_queue_) {
+    return SampleSpan();
+  }
+  const auto sample_size = sample_queue_->get_sample_size();
+  return SampleSpan(
+    Span<const double>(taken_sample_values_.data(), taken_sample_count_ * sample_size),
+    Span<const std::chrono::nanoseconds>(taken_sample_stamps_.data(), taken_sample_count_),
+    sample_size);
+}
+
+uint64_t Sensor::get_dropped_sample_count() const
+{
+  return sample_queue_ ? sample_queue_->get_dropped_count() : 0;
+}
+
+return_type Sensor::configure_filter_chain()
+{
+  filtered_states_ = states_;
+  taken_samples_filtered_ = true;
+  return filter_chain_.configure(info_.parameters, states_.size());
+}
+
+bool Sensor::has_filter_chain() const
+{
+  return !filter_chain_.empty();
+}
+
+return_type Sensor::filter_states()
+{
+  if (filter_chain_.empty()) {
+    return return_type::OK;
+  }
+  if (states_.size() != filter_chain_.get_channel_count()) {
+    return return_type::INTERFACE_VALUE_SIZE_NOT_EQUAL;
+  }
+  if (taken_samples_filtered_) {
+    return filter_chain_.filter(states_, filtered_states_);
+  }
+  taken_samples_filtered_ = true;
+  const auto samples = get_samples();
+  for (size_t s = 0; s < samples.size(); ++s) {
+    filter_chain_.filter(samples[s], filtered_states_);
+  }
+  return return_type::OK;
+}
+
+return_type Sensor::get_filtered_state(std::vector<double> & state) const
+{
+  return get_internal_values(state, filter_chain_.empty() ? states_ : filtered_states_);
+}
+
+return_type Sensor::get_filtered_state(
+  std::vector<double> & state, const std::vector<std::string> & interfaces) const
+{
+  return get_internal_values(
+    state, interfaces, info_.state_interfaces,
+    filter_chain_.empty() ? states_ : filtered_states_);
+}
+
+return_type Sensor::get_filtered_state(
+  Span<double> state, const InterfaceSelector & selector) const
+{
+  return get_internal_values(state, selector, filter_chain_.empty() ? states_ : filtered_states_);
+}
+
+return_type filter_sensor_states(const std::vector<std::shared_ptr<Sensor>> & sensors)
+{
+  return_type result = return_type::OK;
+  for (const auto & sensor : sensors) {
+    const auto sensor_result = sensor->filter_states();
+    if (result == return_type::OK) {
+      result = sensor_result;
+    }
+  }
+  return result;
+}
+
 }  // namespace components
 }  // namespace hardware_interface
@@ -0,0 +1,314 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hardware_interface/components/sensor_filter_chain.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace hardware_interface
+{
+namespace components
+{
+namespace
+{
+using Parameters = std::unordered_map<std::string, std::string>;
+
+/// Split a list separated by commas or spaces.
+std::vector<std::string> split(const std::string & text)
+{
+  std::vector<std::string> items;
+  size_t position = 0;
+  while ((position = text.find_first_not_of(" ,\t\n", position)) != std::string::npos) {
+    const size_t next = text.find_first_of(" ,\t\n", position);
+    items.push_back(text.substr(position, next - position));
+    position = next;
+  }
+  return items;
+}
+
+bool parse_double(const std::string & text, double & value)
+{
+  if (text.empty()) {
+    return false;
+  }
+  char * end = nullptr;
+  errno = 0;
+  value = std::strtod(text.c_str(), &end);
+  return errno == 0 && end == text.c_str() + text.size() && std::isfinite(value);
+}
+
+bool get_double(const Parameters & parameters, const char * name, double & value)
+{
+  const auto it = parameters.find(name);
+  return it != parameters.end() && parse_double(it->second, value);
+}
+
+/// Get a strictly positive integer.
+bool get_length(const Parameters & parameters, const char * name, size_t & length)
+{
+  double value = 0.0;
+  if (!get_double(parameters, name, value) || !(value >= 1.0) || value != std::floor(value)) {
+    return false;
+  }
+  length = static_cast<size_t>(value);
+  return true;
+}
+
+/// Butterworth low-pass, from the audio EQ cookbook of R. Bristow-Johnson
+bool design_low_pass(double cutoff, double sampling, double * coefficients)
+{
+  if (!(cutoff > 0.0) || !(sampling > 2.0 * cutoff)) {
+    return false;
+  }
+  const double w0 = 2.0 * M_PI * cutoff / sampling;
+  const double alpha = std::sin(w0) / (2.0 * M_SQRT1_2);
+  const double a0 = 1.0 + alpha;
+  const double cos_w0 = std::cos(w0);
+  coefficients[0] = (1.0 - cos_w0) / 2.0 / a0;
+  coefficients[1] = (1.0 - cos_w0) / a0;
+  coefficients[2] = coefficients[0];
+  coefficients[3] = -2.0 * cos_w0 / a0;
+  coefficients[4] = (1.0 - alpha) / a0;
+  return true;
+}
+
+/// Transposed direct form II, the delays of each channel in z1 and z2
+void apply_biquad(
+  size_t n, const double * coefficients, double * __restrict values, double * __restrict z1,
+  double * __restrict z2)
+{
+  const double b0 = coefficients[0];
+  const double b1 = coefficients[1];
+  const double b2 = coefficients[2];
+  const double a1 = coefficients[3];
+  const double a2 = coefficients[4];
+  for (size_t c = 0; c < n; ++c) {
+    const double x = values[c];
+    const double y = b0 * x + z1[c];
+    z1[c] = b1 * x - a1 * y + z2[c];
+    z2[c] = b2 * x - a2 * y;
+    values[c] = y;
+  }
+}
+
+void apply_moving_average(
+  size_t n, double inverse_length, double * __restrict values, double * __restrict sums,
+  double * __restrict oldest)
+{
+  for (size_t c = 0; c < n; ++c) {
+    const double x = values[c];
+    sums[c] += x - oldest[c];
+    oldest[c] = x;
+    values[c] = sums[c] * inverse_length;
+  }
+}
+}  // namespace
+
+constexpr const char * SensorFilterChain::FILTERS_PARAMETER;
+constexpr const char * SensorFilterChain::BIQUAD_COEFFICIENTS_PARAMETER;
+constexpr const char * SensorFilterChain::BIQUAD_CUTOFF_FREQUENCY_PARAMETER;
+constexpr const char * SensorFilterChain::BIQUAD_SAMPLING_FREQUENCY_PARAMETER;
+constexpr const char * SensorFilterChain::MOVING_AVERAGE_WINDOW_PARAMETER;
+constexpr const char * SensorFilterChain::MEDIAN_WINDOW_PARAMETER;
+constexpr const char * SensorFilterChain::DECIMATION_FACTOR_PARAMETER;
+
+return_type SensorFilterChain::configure(const Parameters & parameters, size_t channel_count)
+{
+  filters_.clear();
+  channel_count_ = channel_count;
+  values_.assign(channel_count, 0.0);
+  median_scratch_.clear();
+  primed_ = false;
+  const auto filters_it = parameters.find(FILTERS_PARAMETER);
+  if (filters_it == parameters.end()) {
+    return return_type::OK;
+  }
+
+  std::vector<Filter> filters;
+  for (const auto & name : split(filters_it->second)) {
+    Filter filter{};
+    if (name == "biquad") {
+      filter.type = FilterType::BIQUAD;
+      const auto coefficients_it = parameters.find(BIQUAD_COEFFICIENTS_PARAMETER);
+      if (coefficients_it != parameters.end()) {
+        const auto coefficients = split(coefficients_it->second);
+        if (coefficients.size() != 5) {
+          return return_type::ERROR;
+        }
+        for (size_t k = 0; k < 5; ++k) {
+          if (!parse_double(coefficients[k], filter.coefficients[k])) {
+            return return_type::ERROR;
+          }
+        }
+        // the filter has to have a gain to be started from a sample
+        if (1.0 + filter.coefficients[3] + filter.coefficients[4] == 0.0) {
+          return return_type::ERROR;
+        }
+      } else {
+        double cutoff = 0.0;
+        double sampling = 0.0;
+        if (!get_double(parameters, BIQUAD_CUTOFF_FREQUENCY_PARAMETER, cutoff) ||
+          !get_double(parameters, BIQUAD_SAMPLING_FREQUENCY_PARAMETER, sampling) ||
+          !design_low_pass(cutoff, sampling, filter.coefficients))
+        {
+          return return_type::ERROR;
+        }
+      }
+      filter.state_a.assign(channel_count, 0.0);
+      filter.state_b.assign(channel_count, 0.0);
+    } else if (name == "moving_average") {
+      filter.type = FilterType::MOVING_AVERAGE;
+      if (!get_length(parameters, MOVING_AVERAGE_WINDOW_PARAMETER, filter.length)) {
+        return return_type::ERROR;
+      }
+      filter.state_a.assign(channel_count, 0.0);
+      filter.window.assign(filter.length * channel_count, 0.0);
+    } else if (name == "median") {
+      filter.type = FilterType::MEDIAN;
+      if (!get_length(parameters, MEDIAN_WINDOW_PARAMETER, filter.length)) {
+        return return_type::ERROR;
+      }
+      filter.window.assign(filter.length * channel_count, 0.0);
+      median_scratch_.resize(std::max(median_scratch_.size(), filter.length));
+    } else if (name == "decimation") {
+      filter.type = FilterType::DECIMATION;
+      if (!get_length(parameters, DECIMATION_FACTOR_PARAMETER, filter.length)) {
+        return return_type::ERROR;
+      }
+    } else {
+      return return_type::ERROR;
+    }
+    filters.push_back(std::move(filter));
+  }
+  filters_ = std::move(filters);
+  return return_type::OK;
+}
+
+bool SensorFilterChain::empty() const
+{
+  return filters_.empty();
+}
+
+size_t SensorFilterChain::get_channel_count() const
+{
+  return channel_count_;
+}
+
+return_type SensorFilterChain::filter(Span<const double> input, Span<double> output)
+{
+  if (input.size() != channel_count_ || output.size() != channel_count_) {
+    return return_type::INTERFACE_VALUE_SIZE_NOT_EQUAL;
+  }
+  std::copy(input.begin(), input.end(), values_.begin());
+  bool kept = true;
+  for (auto & filter : filters_) {
+    if (!apply(filter, values_.data())) {
+      kept = false;
+      break;
+    }
+  }
+  primed_ = true;
+  if (kept) {
+    std::copy(values_.begin(), values_.end(), output.begin());
+  }
+  return return_type::OK;
+}
+
+void SensorFilterChain::reset()
+{
+  primed_ = false;
+}
+
+bool SensorFilterChain::apply(Filter & filter, double * values)
+{
+  const size_t n = channel_count_;
+  switch (filter.type) {
+    case FilterType::BIQUAD:
+      if (!primed_) {
+        // the delays of the steady state of the sample
+        const double * k = filter.coefficients;
+        const double gain = (k[0] + k[1] + k[2]) / (1.0 + k[3] + k[4]);
+        for (size_t c = 0; c < n; ++c) {
+          const double y = gain * values[c];
+          filter.state_b[c] = k[2] * values[c] - k[4] * y;
+          filter.state_a[c] = y - k[0] * values[c];
+        }
+      }
+      apply_biquad(n, filter.coefficients, values, filter.state_a.data(), filter.state_b.data());
+      return true;
+    case FilterType::MOVING_AVERAGE:
+      if (!primed_) {
+        for (size_t row = 0; row < filter.length; ++row) {
+          std::copy_n(values, n, filter.window.begin() + row * n);
+        }
+        for (size_t c = 0; c < n; ++c) {
+          filter.state_a[c] = values[c] * static_cast<double>(filter.length);
+        }
+        filter.position = 0;
+      } else if (filter.position == 0) {
+        // sum the window again once per turn, the running sums would drift otherwise
+        std::fill(filter.state_a.begin(), filter.state_a.end(), 0.0);
+        for (size_t row = 0; row < filter.length; ++row) {
+          const double * window_row = filter.window.data() + row * n;
+          for (size_t c = 0; c < n; ++c) {
+            filter.state_a[c] += window_row[c];
+          }
+        }
+      }
+      apply_moving_average(
+        n, 1.0 / static_cast<double>(filter.length), values, filter.state_a.data(),
+        filter.window.data() + filter.position * n);
+      filter.position = (filter.position + 1) % filter.length;
+      return true;
+    case FilterType::MEDIAN:
+      if (!primed_) {
+        for (size_t row = 0; row < filter.length; ++row) {
+          std::copy_n(values, n, filter.window.begin() + row * n);
+        }
+        filter.position = 0;
+      }
+      std::copy_n(values, n, filter.window.begin() + filter.position * n);
+      filter.position = (filter.position + 1) % filter.length;
+      for (size_t c = 0; c < n; ++c) {
+        for (size_t row = 0; row < filter.length; ++row) {
+          median_scratch_[row] = filter.window[row * n + c];
+        }
+        const auto begin = median_scratch_.begin();
+        const auto middle = begin + filter.length / 2;
+        std::nth_element(begin, middle, begin + filter.length);
+        double median = *middle;
+        if (filter.length % 2 == 0) {
+          median = 0.5 * (median + *std::max_element(begin, middle));
+        }
+        values[c] = median;
+      }
+      return true;
+    case FilterType::DECIMATION:
+      if (!primed_) {
+        filter.position = 0;
+      }
+      filter.position = (filter.position + 1) % filter.length;
+      return filter.position == 1 % filter.length;
+  }
+  return true;
+}
+
+}  // namespace components
+}  // namespace hardware_interface
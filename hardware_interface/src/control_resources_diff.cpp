@@ -0,0 +1,85 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hardware_interface/control_resources_diff.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "hardware_interface/components/component_info.hpp"
+
+namespace
+{
+bool is_same_component(
+  const hardware_interface::components::ComponentInfo & a,
+  const hardware_interface::components::ComponentInfo & b)
+{
+  return a.name == b.name && a.type == b.type && a.class_type == b.class_type &&
+         a.command_interfaces == b.command_interfaces &&
+         a.state_interfaces == b.state_interfaces && a.parameters == b.parameters;
+}
+
+bool is_same_components(
+  const std::vector<hardware_interface::components::ComponentInfo> & a,
+  const std::vector<hardware_interface::components::ComponentInfo> & b)
+{
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(), is_same_component);
+}
+
+bool is_same_hardware(
+  const hardware_interface::HardwareInfo & a, const hardware_interface::HardwareInfo & b)
+{
+  return a.type == b.type && a.hardware_class_type == b.hardware_class_type &&
+         a.hardware_parameters == b.hardware_parameters &&
+         is_same_components(a.joints, b.joints) && is_same_components(a.sensors, b.sensors) &&
+         is_same_components(a.transmissions, b.transmissions);
+}
+
+std::vector<hardware_interface::HardwareInfo>::const_iterator find_hardware(
+  const std::vector<hardware_interface::HardwareInfo> & hardware, const std::string & name)
+{
+  return std::find_if(
+    hardware.begin(), hardware.end(), [&name](const hardware_interface::HardwareInfo & info) {
+      return info.name == name;
+    });
+}
+}  // namespace
+
+namespace hardware_interface
+{
+
+ControlResourcesDiff diff_control_resources(
+  const std::vector<HardwareInfo> & current, const std::vector<HardwareInfo> & updated)
+{
+  ControlResourcesDiff diff;
+  for (const auto & info : current) {
+    if (find_hardware(updated, info.name) == updated.end()) {
+      diff.removed.push_back(info.name);
+    }
+  }
+  for (const auto & info : updated) {
+    const auto current_info = find_hardware(current, info.name);
+    if (current_info == current.end()) {
+      diff.added.push_back(info.name);
+    } else if (is_same_hardware(*current_info, info)) {
+      diff.unchanged.push_back(info.name);
+    } else {
+      diff.changed.push_back(info.name);
+    }
+  }
+  return diff;
+}
+
+}  // namespace hardware_interface
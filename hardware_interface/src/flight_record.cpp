@@ -0,0 +1,192 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hardware_interface/flight_record.hpp"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace
+{
+constexpr auto kLoggerName = "flight_record";
+}  // namespace
+
+namespace hardware_interface
+{
+
+constexpr uint32_t FlightRecordHeader::MAGIC;
+constexpr uint32_t FlightRecordHeader::LAYOUT_VERSION;
+constexpr uint32_t FlightRecordCycle::FAILED;
+constexpr size_t FlightRecordController::NAME_SIZE;
+constexpr uint32_t FlightRecordController::FAILED;
+constexpr uint32_t FlightRecordController::SKIPPED;
+constexpr uint32_t FlightRecordController::UNCHANGED;
+
+FlightRecordReader::~FlightRecordReader()
+{
+  close();
+}
+
+return_type FlightRecordReader::open(const std::string & path)
+{
+  close();
+#ifdef __linux__
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger(kLoggerName), "could not open flight record '%s': %s", path.c_str(),
+      std::strerror(errno));
+    return return_type::ERROR;
+  }
+  struct stat file_stat;
+  void * file = MAP_FAILED;
+  size_t file_size = 0;
+  if (fstat(fd, &file_stat) == 0 &&
+    static_cast<size_t>(file_stat.st_size) >= sizeof(FlightRecordHeader))
+  {
+    file_size = static_cast<size_t>(file_stat.st_size);
+    file = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  ::close(fd);
+  if (file == MAP_FAILED) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger(kLoggerName), "could not map flight record '%s'", path.c_str());
+    return return_type::ERROR;
+  }
+
+  const auto header = static_cast<const FlightRecordHeader *>(file);
+  const bool compatible = header->magic == FlightRecordHeader::MAGIC &&
+    header->layout_version == FlightRecordHeader::LAYOUT_VERSION;
+  const size_t value_count = compatible ?
+    header->actuator_value_count + header->joint_value_count : 0;
+  if (!compatible ||
+    header->cycle_size != sizeof(FlightRecordCycle) + value_count * sizeof(double) +
+    header->controller_capacity * sizeof(FlightRecordController) ||
+    header->names_offset + header->names_size > header->cycles_offset ||
+    header->cycles_offset + header->cycle_count * header->cycle_size > file_size)
+  {
+    RCLCPP_ERROR(
+      rclcpp::get_logger(kLoggerName), "flight record '%s' has an unknown layout", path.c_str());
+    munmap(file, file_size);
+    return return_type::ERROR;
+  }
+
+  std::vector<std::string> names;
+  const char * name = static_cast<const char *>(file) + header->names_offset;
+  const char * names_end = name + header->names_size;
+  while (name < names_end && names.size() < value_count) {
+    const auto length = strnlen(name, static_cast<size_t>(names_end - name));
+    names.emplace_back(name, length);
+    name += length + 1;
+  }
+  if (names.size() != value_count) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger(kLoggerName), "flight record '%s' misses value names", path.c_str());
+    munmap(file, file_size);
+    return return_type::ERROR;
+  }
+
+  file_ = file;
+  file_size_ = file_size;
+  header_ = header;
+  const auto joint_names_begin = names.begin() + header->actuator_value_count;
+  actuator_value_names_.assign(names.begin(), joint_names_begin);
+  joint_value_names_.assign(joint_names_begin, names.end());
+  return return_type::OK;
+#else
+  RCLCPP_ERROR(
+    rclcpp::get_logger(kLoggerName),
+    "reading flight records is not supported on this platform, cannot open '%s'", path.c_str());
+  return return_type::ERROR;
+#endif
+}
+
+void FlightRecordReader::close()
+{
+  if (file_ == nullptr) {
+    return;
+  }
+#ifdef __linux__
+  munmap(file_, file_size_);
+#endif
+  file_ = nullptr;
+  file_size_ = 0;
+  header_ = nullptr;
+  actuator_value_names_.clear();
+  joint_value_names_.clear();
+}
+
+bool FlightRecordReader::is_open() const
+{
+  return header_ != nullptr;
+}
+
+const FlightRecordHeader & FlightRecordReader::get_header() const
+{
+  return *header_;
+}
+
+const std::vector<std::string> & FlightRecordReader::get_actuator_value_names() const
+{
+  return actuator_value_names_;
+}
+
+const std::vector<std::string> & FlightRecordReader::get_joint_value_names() const
+{
+  return joint_value_names_;
+}
+
+size_t FlightRecordReader::get_cycle_count() const
+{
+  return header_ ? static_cast<size_t>(header_->cycle_count) : 0;
+}
+
+const FlightRecordCycle & FlightRecordReader::get_cycle(size_t index) const
+{
+  return *reinterpret_cast<const FlightRecordCycle *>(get_cycle_data(index));
+}
+
+const double * FlightRecordReader::get_actuator_values(size_t index) const
+{
+  return reinterpret_cast<const double *>(get_cycle_data(index) + sizeof(FlightRecordCycle));
+}
+
+const double * FlightRecordReader::get_joint_values(size_t index) const
+{
+  return get_actuator_values(index) + header_->actuator_value_count;
+}
+
+const FlightRecordController * FlightRecordReader::get_controllers(size_t index) const
+{
+  return reinterpret_cast<const FlightRecordController *>(
+    get_joint_values(index) + header_->joint_value_count);
+}
+
+const char * FlightRecordReader::get_cycle_data(size_t index) const
+{
+  return static_cast<const char *>(file_) + header_->cycles_offset + index * header_->cycle_size;
+}
+
+}  // namespace hardware_interface
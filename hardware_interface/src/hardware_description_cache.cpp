@@ -0,0 +1,356 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hardware_interface/hardware_description_cache.hpp"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "hardware_interface/component_parser.hpp"
+
+namespace
+{
+constexpr uint64_t kFNVOffsetBasis = 14695981039346656037ULL;
+constexpr uint64_t kFNVPrime = 1099511628211ULL;
+
+uint64_t fnv1a(const char * data, size_t size)
+{
+  uint64_t hash = kFNVOffsetBasis;
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= kFNVPrime;
+  }
+  return hash;
+}
+
+/// Append the serialized control resources to a payload.
+class PayloadWriter
+{
+public:
+  explicit PayloadWriter(std::string & payload)
+  : payload_(payload) {}
+
+  void write_size(size_t size)
+  {
+    const auto value = static_cast<uint32_t>(size);
+    payload_.append(reinterpret_cast<const char *>(&value), sizeof(value));
+  }
+
+  void write_string(const std::string & value)
+  {
+    write_size(value.size());
+    payload_.append(value);
+  }
+
+  void write_strings(const std::vector<std::string> & values)
+  {
+    write_size(values.size());
+    for (const auto & value : values) {
+      write_string(value);
+    }
+  }
+
+  void write_parameters(const std::unordered_map<std::string, std::string> & parameters)
+  {
+    write_size(parameters.size());
+    for (const auto & parameter : parameters) {
+      write_string(parameter.first);
+      write_string(parameter.second);
+    }
+  }
+
+  void write_components(const std::vector<hardware_interface::components::ComponentInfo> & values)
+  {
+    write_size(values.size());
+    for (const auto & component : values) {
+      write_string(component.name);
+      write_string(component.type);
+      write_string(component.class_type);
+      write_strings(component.command_interfaces);
+      write_strings(component.state_interfaces);
+      write_parameters(component.parameters);
+    }
+  }
+
+  void write_hardware(const std::vector<hardware_interface::HardwareInfo> & values)
+  {
+    write_size(values.size());
+    for (const auto & hardware : values) {
+      write_string(hardware.name);
+      write_string(hardware.type);
+      write_string(hardware.hardware_class_type);
+      write_parameters(hardware.hardware_parameters);
+      write_components(hardware.joints);
+      write_components(hardware.sensors);
+      write_components(hardware.transmissions);
+    }
+  }
+
+private:
+  std::string & payload_;
+};
+
+/// Read the serialized control resources from a payload, checking every size against its end.
+class PayloadReader
+{
+public:
+  PayloadReader(const char * data, size_t size)
+  : data_(data), size_(size) {}
+
+  bool at_end() const {return position_ == size_;}
+
+  /// Read a count of elements, each of them taking at least min_element_size bytes.
+  bool read_size(uint32_t & size, size_t min_element_size = 1)
+  {
+    if (size_ - position_ < sizeof(size)) {
+      return false;
+    }
+    std::memcpy(&size, data_ + position_, sizeof(size));
+    position_ += sizeof(size);
+    return size <= (size_ - position_) / min_element_size;
+  }
+
+  bool read_string(std::string & value)
+  {
+    uint32_t size;
+    if (!read_size(size)) {
+      return false;
+    }
+    value.assign(data_ + position_, size);
+    position_ += size;
+    return true;
+  }
+
+  bool read_strings(std::vector<std::string> & values)
+  {
+    uint32_t size;
+    if (!read_size(size, sizeof(uint32_t))) {
+      return false;
+    }
+    values.resize(size);
+    for (auto & value : values) {
+      if (!read_string(value)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool read_parameters(std::unordered_map<std::string, std::string> & parameters)
+  {
+    uint32_t size;
+    if (!read_size(size, 2 * sizeof(uint32_t))) {
+      return false;
+    }
+    parameters.reserve(size);
+    std::string name;
+    std::string value;
+    for (uint32_t i = 0; i < size; ++i) {
+      if (!read_string(name) || !read_string(value)) {
+        return false;
+      }
+      parameters[name] = value;
+    }
+    return true;
+  }
+
+  bool read_components(std::vector<hardware_interface::components::ComponentInfo> & values)
+  {
+    uint32_t size;
+    if (!read_size(size, 6 * sizeof(uint32_t))) {
+      return false;
+    }
+    values.resize(size);
+    for (auto & component : values) {
+      if (!read_string(component.name) || !read_string(component.type) ||
+        !read_string(component.class_type) || !read_strings(component.command_interfaces) ||
+        !read_strings(component.state_interfaces) || !read_parameters(component.parameters))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool read_hardware(std::vector<hardware_interface::HardwareInfo> & values)
+  {
+    uint32_t size;
+    if (!read_size(size, 7 * sizeof(uint32_t))) {
+      return false;
+    }
+    values.resize(size);
+    for (auto & hardware : values) {
+      if (!read_string(hardware.name) || !read_string(hardware.type) ||
+        !read_string(hardware.hardware_class_type) ||
+        !read_parameters(hardware.hardware_parameters) || !read_components(hardware.joints) ||
+        !read_components(hardware.sensors) || !read_components(hardware.transmissions))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+private:
+  const char * data_;
+  size_t size_;
+  size_t position_ = 0;
+};
+
+#ifdef __linux__
+/// Check the header of a mapped cache file and deserialize its payload.
+bool read_cache(
+  const char * data, size_t size, uint64_t urdf_hash,
+  std::vector<hardware_interface::HardwareInfo> & hardware_info)
+{
+  hardware_interface::HardwareDescriptionCacheHeader header;
+  if (size < sizeof(header)) {
+    return false;
+  }
+  std::memcpy(&header, data, sizeof(header));
+  if (header.magic != hardware_interface::HardwareDescriptionCacheHeader::MAGIC ||
+    header.format_version != hardware_interface::HardwareDescriptionCacheHeader::FORMAT_VERSION ||
+    header.urdf_hash != urdf_hash || header.payload_size != size - sizeof(header))
+  {
+    return false;
+  }
+  const char * payload = data + sizeof(header);
+  if (fnv1a(payload, header.payload_size) != header.payload_checksum) {
+    return false;
+  }
+  PayloadReader reader(payload, header.payload_size);
+  return reader.read_hardware(hardware_info) && reader.at_end();
+}
+#endif
+}  // namespace
+
+namespace hardware_interface
+{
+
+constexpr uint32_t HardwareDescriptionCacheHeader::MAGIC;
+constexpr uint32_t HardwareDescriptionCacheHeader::FORMAT_VERSION;
+
+uint64_t hash_urdf(const std::string & urdf)
+{
+  return fnv1a(urdf.data(), urdf.size());
+}
+
+bool write_hardware_description_cache(
+  const std::string & cache_path, uint64_t urdf_hash,
+  const std::vector<HardwareInfo> & hardware_info)
+{
+  std::string payload;
+  PayloadWriter(payload).write_hardware(hardware_info);
+
+  HardwareDescriptionCacheHeader header;
+  header.magic = HardwareDescriptionCacheHeader::MAGIC;
+  header.format_version = HardwareDescriptionCacheHeader::FORMAT_VERSION;
+  header.urdf_hash = urdf_hash;
+  header.payload_size = payload.size();
+  header.payload_checksum = fnv1a(payload.data(), payload.size());
+
+  const std::string temporary_path = cache_path + ".tmp";
+  {
+    std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(payload.data(), payload.size());
+    if (!file.good()) {
+      file.close();
+      std::remove(temporary_path.c_str());
+      return false;
+    }
+  }
+  if (std::rename(temporary_path.c_str(), cache_path.c_str()) != 0) {
+    std::remove(temporary_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool read_hardware_description_cache(
+  const std::string & cache_path, uint64_t urdf_hash, std::vector<HardwareInfo> & hardware_info)
+{
+#ifdef __linux__
+  const int fd = ::open(cache_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat file_status;
+  if (fstat(fd, &file_status) != 0 || file_status.st_size <= 0) {
+    ::close(fd);
+    return false;
+  }
+  const auto size = static_cast<size_t>(file_status.st_size);
+  void * data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    return false;
+  }
+
+  std::vector<HardwareInfo> cached_hardware_info;
+  const bool valid = read_cache(
+    static_cast<const char *>(data), size, urdf_hash, cached_hardware_info);
+  munmap(data, size);
+  if (valid) {
+    hardware_info.swap(cached_hardware_info);
+  }
+  return valid;
+#else
+  (void) cache_path;
+  (void) urdf_hash;
+  (void) hardware_info;
+  return false;
+#endif
+}
+
+std::vector<HardwareInfo> load_control_resources_from_urdf(
+  const std::string & urdf, const std::string & cache_path)
+{
+  const auto urdf_hash = hash_urdf(urdf);
+  std::vector<HardwareInfo> hardware_info;
+  if (read_hardware_description_cache(cache_path, urdf_hash, hardware_info)) {
+    return hardware_info;
+  }
+  hardware_info = parse_control_resources_from_urdf(urdf);
+  write_hardware_description_cache(cache_path, urdf_hash, hardware_info);
+  return hardware_info;
+}
+
+std::vector<HardwareInfo> load_control_resources_from_urdf(
+  const std::string & urdf, const std::string & cache_path,
+  const std::unordered_map<std::string, HardwareParameterSchema> & schemas)
+{
+  // the typed parameters are not cached, they are converted again from their text
+  auto hardware_info = load_control_resources_from_urdf(urdf, cache_path);
+  for (auto & hardware : hardware_info) {
+    const auto schema = schemas.find(hardware.hardware_class_type);
+    if (schema != schemas.end()) {
+      parse_typed_parameters(schema->second, hardware);
+    }
+  }
+  return hardware_info;
+}
+
+}  // namespace hardware_interface
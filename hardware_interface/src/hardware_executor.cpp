@@ -0,0 +1,253 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "hardware_interface/hardware_executor.hpp"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "hardware_interface/realtime_logger.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+namespace
+{
+constexpr auto kLoggerName = "hardware executor";
+
+void pin_current_thread(int cpu)
+{
+  if (cpu < 0) {
+    return;
+  }
+#ifdef __linux__
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(cpu, &cpu_set);
+  if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) != 0) {
+    RCLCPP_WARN_STREAM(
+      rclcpp::get_logger(kLoggerName), "could not pin hardware worker to CPU " << cpu);
+  }
+#else
+  RCLCPP_WARN_STREAM(
+    rclcpp::get_logger(kLoggerName),
+    "pinning hardware workers is not supported on this platform, ignoring CPU " << cpu);
+#endif
+}
+}  // namespace
+
+namespace hardware_interface
+{
+
+HardwareExecutor::~HardwareExecutor()
+{
+  stop();
+}
+
+return_type HardwareExecutor::add_hardware(
+  const std::string & name, HardwareCall read, HardwareCall write, int cpu)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (started_ || phase_ != Phase::NONE) {
+    RCLCPP_ERROR_STREAM(
+      rclcpp::get_logger(kLoggerName),
+      "cannot add hardware '" << name << "' while the executor is running");
+    return return_type::ERROR;
+  }
+  hardware_.push_back(Hardware{std::move(read), std::move(write), cpu, std::thread()});
+  HardwareTiming timing;
+  timing.name = name;
+  timings_.push_back(timing);
+  results_.push_back(return_type::OK);
+  return return_type::OK;
+}
+
+return_type HardwareExecutor::start()
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (started_ || phase_ != Phase::NONE) {
+    RCLCPP_ERROR_STREAM(rclcpp::get_logger(kLoggerName), "executor is already running");
+    return return_type::ERROR;
+  }
+  started_ = true;
+  for (size_t i = 0; i < hardware_.size(); ++i) {
+    hardware_[i].worker = std::thread(&HardwareExecutor::worker_loop, this, i, phase_count_);
+  }
+  return return_type::OK;
+}
+
+void HardwareExecutor::stop()
+{
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (!started_) {
+      return;
+    }
+    stopping_ = true;
+  }
+  phase_cv_.notify_all();
+  for (auto & hardware : hardware_) {
+    hardware.worker.join();
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  started_ = false;
+  stopping_ = false;
+}
+
+bool HardwareExecutor::is_started() const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  return started_;
+}
+
+return_type HardwareExecutor::read()
+{
+  const auto ret = begin_read();
+  if (ret != return_type::OK) {
+    return ret;
+  }
+  return end_read();
+}
+
+return_type HardwareExecutor::write()
+{
+  const auto ret = begin_write();
+  if (ret != return_type::OK) {
+    return ret;
+  }
+  return end_write();
+}
+
+return_type HardwareExecutor::begin_read()
+{
+  return begin_phase(Phase::READ);
+}
+
+return_type HardwareExecutor::end_read()
+{
+  return end_phase(Phase::READ);
+}
+
+return_type HardwareExecutor::begin_write()
+{
+  return begin_phase(Phase::WRITE);
+}
+
+return_type HardwareExecutor::end_write()
+{
+  return end_phase(Phase::WRITE);
+}
+
+const std::vector<HardwareTiming> & HardwareExecutor::get_timings() const
+{
+  return timings_;
+}
+
+return_type HardwareExecutor::begin_phase(Phase phase)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (phase_ != Phase::NONE) {
+    HARDWARE_INTERFACE_RT_LOG_ERROR(
+      kLoggerName, "cannot begin a phase before the previous one is ended");
+    return return_type::ERROR;
+  }
+  phase_ = phase;
+
+  if (!started_) {
+    // serially in the calling thread, the phase cannot be observed by any worker
+    lock.unlock();
+    for (size_t i = 0; i < hardware_.size(); ++i) {
+      run_phase(i, phase);
+    }
+    return return_type::OK;
+  }
+
+  pending_ = hardware_.size();
+  ++phase_count_;
+  lock.unlock();
+  phase_cv_.notify_all();
+  return return_type::OK;
+}
+
+return_type HardwareExecutor::end_phase(Phase phase)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (phase_ != phase) {
+    HARDWARE_INTERFACE_RT_LOG_ERROR(kLoggerName, "cannot end a phase which was not begun");
+    return return_type::ERROR;
+  }
+  done_cv_.wait(lock, [this] {return pending_ == 0;});
+  phase_ = Phase::NONE;
+
+  for (const auto result : results_) {
+    if (result != return_type::OK) {
+      return result;
+    }
+  }
+  return return_type::OK;
+}
+
+void HardwareExecutor::run_phase(size_t index, Phase phase)
+{
+  auto & hardware = hardware_[index];
+  auto & timing = timings_[index];
+  const auto & call = phase == Phase::READ ? hardware.read : hardware.write;
+
+  const auto begin = std::chrono::steady_clock::now();
+  results_[index] = call ? call() : return_type::OK;
+  const auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now() - begin);
+
+  if (phase == Phase::READ) {
+    timing.last_read_duration = duration;
+    timing.max_read_duration = std::max(timing.max_read_duration, duration);
+  } else {
+    timing.last_write_duration = duration;
+    timing.max_write_duration = std::max(timing.max_write_duration, duration);
+  }
+}
+
+void HardwareExecutor::worker_loop(size_t index, uint64_t phase_count)
+{
+  pin_current_thread(hardware_[index].cpu);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    phase_cv_.wait(lock, [this, phase_count] {return stopping_ || phase_count_ != phase_count;});
+    if (phase_count_ == phase_count) {
+      // stopping, and no phase left to run
+      return;
+    }
+    phase_count = phase_count_;
+    const auto phase = phase_;
+    lock.unlock();
+
+    run_phase(index, phase);
+
+    lock.lock();
+    if (--pending_ == 0) {
+      done_cv_.notify_all();
+    }
+  }
+}
+
+}  // namespace hardware_interface
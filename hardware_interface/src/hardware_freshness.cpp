@@ -0,0 +1,154 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hardware_interface/hardware_freshness.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace
+{
+int64_t now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}  // namespace
+
+namespace hardware_interface
+{
+
+constexpr size_t HardwareFreshness::MAX_COMPONENTS;
+
+return_type HardwareFreshness::add_component(
+  const std::string & name, const std::vector<std::string> & joint_names,
+  std::chrono::nanoseconds staleness_threshold, size_t & component)
+{
+  std::lock_guard<std::mutex> guard(add_mutex_);
+  const size_t count = component_count_.load(std::memory_order_relaxed);
+  if (count == MAX_COMPONENTS) {
+    return return_type::ERROR;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    if (components_[i].name == name) {
+      return return_type::ERROR;
+    }
+  }
+  auto & added = components_[count];
+  added.name = name;
+  added.joint_names = joint_names;
+  added.staleness_threshold_ns = std::max<int64_t>(staleness_threshold.count(), 0);
+  added.last_read_ns.store(0, std::memory_order_relaxed);
+  // publishes the component to update() and the readers
+  component_count_.store(count + 1, std::memory_order_release);
+  component = count;
+  return return_type::OK;
+}
+
+size_t HardwareFreshness::get_component_count() const
+{
+  return component_count_.load(std::memory_order_acquire);
+}
+
+const std::string & HardwareFreshness::get_component_name(size_t component) const
+{
+  return components_[component].name;
+}
+
+std::chrono::nanoseconds HardwareFreshness::get_staleness_threshold(size_t component) const
+{
+  return std::chrono::nanoseconds(components_[component].staleness_threshold_ns);
+}
+
+void HardwareFreshness::record_read(size_t component)
+{
+  record_read(component, now_ns());
+}
+
+void HardwareFreshness::record_read(size_t component, int64_t time_ns)
+{
+  components_[component].last_read_ns.store(time_ns, std::memory_order_relaxed);
+}
+
+int64_t HardwareFreshness::get_last_read_time_ns(size_t component) const
+{
+  return components_[component].last_read_ns.load(std::memory_order_relaxed);
+}
+
+HardwareFreshness::ComponentMask HardwareFreshness::update()
+{
+  return update(now_ns());
+}
+
+HardwareFreshness::ComponentMask HardwareFreshness::update(int64_t time_ns)
+{
+  const size_t count = component_count_.load(std::memory_order_acquire);
+  ComponentMask stale = 0;
+  for (size_t i = 0; i < count; ++i) {
+    const auto & component = components_[i];
+    if (component.staleness_threshold_ns == 0) {
+      continue;
+    }
+    const int64_t last_read_ns = component.last_read_ns.load(std::memory_order_relaxed);
+    if (last_read_ns == 0 || time_ns - last_read_ns > component.staleness_threshold_ns) {
+      stale |= get_component_mask(i);
+    }
+  }
+  stale_components_.store(stale, std::memory_order_relaxed);
+  return stale;
+}
+
+HardwareFreshness::ComponentMask HardwareFreshness::get_stale_components() const
+{
+  return stale_components_.load(std::memory_order_relaxed);
+}
+
+bool HardwareFreshness::is_fresh() const
+{
+  return get_stale_components() == 0;
+}
+
+bool HardwareFreshness::is_fresh(ComponentMask components) const
+{
+  return (get_stale_components() & components) == 0;
+}
+
+HardwareFreshness::ComponentMask HardwareFreshness::get_component_mask(size_t component)
+{
+  return ComponentMask(1) << component;
+}
+
+HardwareFreshness::ComponentMask HardwareFreshness::get_joint_component_mask(
+  const std::vector<std::string> & joint_names) const
+{
+  const size_t count = get_component_count();
+  ComponentMask components = 0;
+  for (size_t i = 0; i < count; ++i) {
+    const auto & component_joints = components_[i].joint_names;
+    for (const auto & joint_name : joint_names) {
+      if (std::find(component_joints.begin(), component_joints.end(), joint_name) !=
+        component_joints.end())
+      {
+        components |= get_component_mask(i);
+        break;
+      }
+    }
+  }
+  return components;
+}
+
+}  // namespace hardware_interface
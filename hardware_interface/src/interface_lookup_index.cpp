@@ -0,0 +1,92 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hardware_interface/interface_lookup_index.hpp"
+
+#include <string>
+
+namespace hardware_interface
+{
+
+bool InterfaceLookupIndex::add(
+  const std::string & handle_name, const std::string & interface_name, InterfaceId id)
+{
+  return add(handle_name, InterfaceTypeId::intern(interface_name), id);
+}
+
+bool InterfaceLookupIndex::add(
+  const std::string & handle_name, InterfaceTypeId interface_type, InterfaceId id)
+{
+  if (!interface_type.is_valid()) {
+    return false;
+  }
+  handle_indices_.emplace(handle_name, id.handle_index);
+  return interface_indices_.emplace(
+    make_key(id.handle_index, interface_type), id.interface_index).second;
+}
+
+bool InterfaceLookupIndex::find_handle(const std::string & handle_name, size_t & handle_index) const
+{
+  const auto it = handle_indices_.find(handle_name);
+  if (it == handle_indices_.end()) {
+    return false;
+  }
+  handle_index = it->second;
+  return true;
+}
+
+bool InterfaceLookupIndex::find(
+  const std::string & handle_name, const std::string & interface_name,
+  InterfaceId & id) const
+{
+  InterfaceTypeId interface_type;
+  if (!InterfaceTypeId::find(interface_name, interface_type)) {
+    return false;
+  }
+  return find(handle_name, interface_type, id);
+}
+
+bool InterfaceLookupIndex::find(
+  const std::string & handle_name, InterfaceTypeId interface_type,
+  InterfaceId & id) const
+{
+  size_t handle_index;
+  size_t interface_index;
+  if (!find_handle(handle_name, handle_index) ||
+    !find_interface(handle_index, interface_type, interface_index))
+  {
+    return false;
+  }
+  id.handle_index = handle_index;
+  id.interface_index = interface_index;
+  return true;
+}
+
+bool InterfaceLookupIndex::find_interface(
+  size_t handle_index, InterfaceTypeId interface_type, size_t & interface_index) const
+{
+  const auto it = interface_indices_.find(make_key(handle_index, interface_type));
+  if (it == interface_indices_.end()) {
+    return false;
+  }
+  interface_index = it->second;
+  return true;
+}
+
+uint64_t InterfaceLookupIndex::make_key(size_t handle_index, InterfaceTypeId interface_type)
+{
+  return (static_cast<uint64_t>(handle_index) << 32) | interface_type.get_value();
+}
+
+}  // namespace hardware_interface
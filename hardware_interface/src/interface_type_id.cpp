@@ -0,0 +1,108 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hardware_interface/interface_type_id.hpp"
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "hardware_interface/types/hardware_interface_type_values.hpp"
+
+namespace hardware_interface
+{
+namespace
+{
+/// Names of the interned interface types, indexed by id and never moved.
+class InterfaceTypeRegistry
+{
+public:
+  InterfaceTypeRegistry()
+  {
+    // pre-interned so the ids match the constexpr standard ids
+    for (const auto name : {HW_IF_POSITION, HW_IF_VELOCITY, HW_IF_EFFORT,
+        HW_IF_POSITION_COMMAND, HW_IF_VELOCITY_COMMAND, HW_IF_EFFORT_COMMAND})
+    {
+      intern(name);
+    }
+  }
+
+  uint32_t intern(const std::string & name)
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    const auto it = ids_.emplace(name, static_cast<uint32_t>(names_.size()));
+    if (it.second) {
+      names_.push_back(name);
+    }
+    return it.first->second;
+  }
+
+  bool find(const std::string & name, uint32_t & id) const
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    const auto it = ids_.find(name);
+    if (it == ids_.end()) {
+      return false;
+    }
+    id = it->second;
+    return true;
+  }
+
+  const std::string & get_name(uint32_t id) const
+  {
+    static const std::string empty;
+    std::lock_guard<std::mutex> guard(mutex_);
+    return id < names_.size() ? names_[id] : empty;
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, uint32_t> ids_;
+  std::deque<std::string> names_;
+};
+
+InterfaceTypeRegistry & get_registry()
+{
+  static InterfaceTypeRegistry registry;
+  return registry;
+}
+}  // namespace
+
+constexpr uint32_t InterfaceTypeId::INVALID_VALUE;
+
+InterfaceTypeId InterfaceTypeId::intern(const std::string & name)
+{
+  if (name.empty()) {
+    return InterfaceTypeId();
+  }
+  return InterfaceTypeId(get_registry().intern(name));
+}
+
+bool InterfaceTypeId::find(const std::string & name, InterfaceTypeId & id)
+{
+  uint32_t value;
+  if (!get_registry().find(name, value)) {
+    return false;
+  }
+  id = InterfaceTypeId(value);
+  return true;
+}
+
+const std::string & InterfaceTypeId::get_name() const
+{
+  return get_registry().get_name(value_);
+}
+
+}  // namespace hardware_interface
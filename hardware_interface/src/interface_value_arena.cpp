@@ -0,0 +1,156 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hardware_interface/interface_value_arena.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+constexpr size_t kValuesPerCacheLine =
+  hardware_interface::InterfaceValueArena::CACHE_LINE_SIZE / sizeof(double);
+
+size_t round_up_to_cache_line(size_t size)
+{
+  return (size + kValuesPerCacheLine - 1) / kValuesPerCacheLine * kValuesPerCacheLine;
+}
+}  // namespace
+
+namespace hardware_interface
+{
+
+constexpr size_t InterfaceValueArena::CACHE_LINE_SIZE;
+constexpr const char * InterfaceValueArena::COMMAND_INTERFACE_SUFFIX;
+
+void InterfaceValueArena::freeze(
+  const control_msgs::msg::DynamicJointState & registered, RealtimeMemoryPool * pool)
+{
+  if (is_frozen()) {
+    throw std::runtime_error("interface value arena is already frozen");
+  }
+
+  // count the values of each region to know where the command region starts
+  state_size_ = 0;
+  command_size_ = 0;
+  for (const auto & interface_values : registered.interface_values) {
+    for (const auto & interface_name : interface_values.interface_names) {
+      if (is_command_interface(interface_name)) {
+        ++command_size_;
+      } else {
+        ++state_size_;
+      }
+    }
+  }
+  command_begin_ = round_up_to_cache_line(state_size_);
+  published_command_begin_ = command_begin_ + round_up_to_cache_line(command_size_);
+
+  storage_ = std::vector<double, PoolAllocator<double>>(
+    published_command_begin_ + round_up_to_cache_line(command_size_) + kValuesPerCacheLine, 0.0,
+    PoolAllocator<double>(pool));
+  const auto address = reinterpret_cast<std::uintptr_t>(storage_.data());
+  const auto misalignment = address % CACHE_LINE_SIZE;
+  begin_ = storage_.data() +
+    (misalignment ? (CACHE_LINE_SIZE - misalignment) / sizeof(double) : 0u);
+
+  size_t next_state = 0;
+  size_t next_command = command_begin_;
+  offsets_.resize(registered.interface_values.size());
+  for (size_t i = 0; i < registered.interface_values.size(); ++i) {
+    const auto & interface_values = registered.interface_values[i];
+    offsets_[i].resize(interface_values.interface_names.size());
+    for (size_t j = 0; j < interface_values.interface_names.size(); ++j) {
+      const auto offset = is_command_interface(interface_values.interface_names[j]) ?
+        next_command++ : next_state++;
+      offsets_[i][j] = offset;
+      begin_[offset] = interface_values.values[j];
+    }
+  }
+  publish_commands();
+}
+
+bool InterfaceValueArena::is_frozen() const
+{
+  return begin_ != nullptr;
+}
+
+double * InterfaceValueArena::get_value_ptr(size_t handle_index, size_t interface_index)
+{
+  return begin_ + get_offset(handle_index, interface_index);
+}
+
+size_t InterfaceValueArena::get_offset(size_t handle_index, size_t interface_index) const
+{
+  return offsets_.at(handle_index).at(interface_index);
+}
+
+double * InterfaceValueArena::data()
+{
+  return begin_;
+}
+
+const double * InterfaceValueArena::get_state_values() const
+{
+  return begin_;
+}
+
+size_t InterfaceValueArena::get_state_size() const
+{
+  return state_size_;
+}
+
+double * InterfaceValueArena::get_command_values()
+{
+  return begin_ ? begin_ + command_begin_ : nullptr;
+}
+
+size_t InterfaceValueArena::get_command_size() const
+{
+  return command_size_;
+}
+
+double * InterfaceValueArena::get_published_value_ptr(size_t handle_index, size_t interface_index)
+{
+  const auto offset = get_offset(handle_index, interface_index);
+  if (offset < command_begin_) {
+    return begin_ + offset;
+  }
+  return begin_ + published_command_begin_ + (offset - command_begin_);
+}
+
+const double * InterfaceValueArena::get_published_command_values() const
+{
+  return begin_ ? begin_ + published_command_begin_ : nullptr;
+}
+
+void InterfaceValueArena::publish_commands()
+{
+  if (begin_) {
+    std::memcpy(
+      begin_ + published_command_begin_, begin_ + command_begin_, command_size_ * sizeof(double));
+  }
+}
+
+bool InterfaceValueArena::is_command_interface(const std::string & interface_name)
+{
+  const auto suffix_length = std::strlen(COMMAND_INTERFACE_SUFFIX);
+  return interface_name.size() > suffix_length &&
+         interface_name.compare(
+    interface_name.size() - suffix_length, suffix_length, COMMAND_INTERFACE_SUFFIX) == 0;
+}
+
+}  // namespace hardware_interface
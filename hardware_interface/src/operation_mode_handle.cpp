@@ -42,6 +42,14 @@ OperationModeHandle::get_name() const
   return name_;
 }
 
+OperationMode
+OperationModeHandle::get_mode() const
+{
+  THROW_ON_NULLPTR(mode_)
+
+  return *mode_;
+}
+
 void
 OperationModeHandle::set_mode(OperationMode mode)
 {
@@ -0,0 +1,257 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hardware_interface/packet_layout.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace
+{
+uint64_t load_bytes(const uint8_t * bytes, size_t size, hardware_interface::PacketByteOrder order)
+{
+  uint64_t raw = 0;
+  for (size_t i = 0; i < size; ++i) {
+    const size_t shift = order == hardware_interface::PacketByteOrder::LITTLE ?
+      8 * i : 8 * (size - 1 - i);
+    raw |= static_cast<uint64_t>(bytes[i]) << shift;
+  }
+  return raw;
+}
+
+void store_bytes(
+  uint64_t raw, uint8_t * bytes, size_t size, hardware_interface::PacketByteOrder order)
+{
+  for (size_t i = 0; i < size; ++i) {
+    const size_t shift = order == hardware_interface::PacketByteOrder::LITTLE ?
+      8 * i : 8 * (size - 1 - i);
+    bytes[i] = static_cast<uint8_t>(raw >> shift);
+  }
+}
+
+/// Rounds and saturates a value to an integer type, NaN becomes 0.
+template<typename IntT>
+uint64_t to_integer(double value)
+{
+  if (std::isnan(value)) {
+    return 0;
+  }
+  const double rounded = std::round(value);
+  IntT integer;
+  if (rounded <= static_cast<double>(std::numeric_limits<IntT>::min())) {
+    integer = std::numeric_limits<IntT>::min();
+  } else if (rounded >= static_cast<double>(std::numeric_limits<IntT>::max())) {
+    integer = std::numeric_limits<IntT>::max();
+  } else {
+    integer = static_cast<IntT>(rounded);
+  }
+  // two's complement bits, truncated to the size of the field by store_bytes
+  return static_cast<uint64_t>(static_cast<int64_t>(integer));
+}
+
+double from_raw(uint64_t raw, hardware_interface::PacketFieldType type)
+{
+  using hardware_interface::PacketFieldType;
+  switch (type) {
+    case PacketFieldType::INT8:
+      return static_cast<int8_t>(static_cast<uint8_t>(raw));
+    case PacketFieldType::UINT8:
+      return static_cast<uint8_t>(raw);
+    case PacketFieldType::INT16:
+      return static_cast<int16_t>(static_cast<uint16_t>(raw));
+    case PacketFieldType::UINT16:
+      return static_cast<uint16_t>(raw);
+    case PacketFieldType::INT32:
+      return static_cast<int32_t>(static_cast<uint32_t>(raw));
+    case PacketFieldType::UINT32:
+      return static_cast<uint32_t>(raw);
+    case PacketFieldType::FLOAT32:
+      {
+        const auto bits = static_cast<uint32_t>(raw);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+      }
+    case PacketFieldType::FLOAT64:
+      {
+        double value;
+        std::memcpy(&value, &raw, sizeof(value));
+        return value;
+      }
+  }
+  return 0.0;
+}
+
+uint64_t to_raw(double value, hardware_interface::PacketFieldType type)
+{
+  using hardware_interface::PacketFieldType;
+  switch (type) {
+    case PacketFieldType::INT8:
+      return to_integer<int8_t>(value);
+    case PacketFieldType::UINT8:
+      return to_integer<uint8_t>(value);
+    case PacketFieldType::INT16:
+      return to_integer<int16_t>(value);
+    case PacketFieldType::UINT16:
+      return to_integer<uint16_t>(value);
+    case PacketFieldType::INT32:
+      return to_integer<int32_t>(value);
+    case PacketFieldType::UINT32:
+      return to_integer<uint32_t>(value);
+    case PacketFieldType::FLOAT32:
+      {
+        const auto single = static_cast<float>(value);
+        uint32_t bits;
+        std::memcpy(&bits, &single, sizeof(bits));
+        return bits;
+      }
+    case PacketFieldType::FLOAT64:
+      {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+      }
+  }
+  return 0;
+}
+}  // namespace
+
+namespace hardware_interface
+{
+
+return_type PacketLayout::add_field(
+  const std::string & interface_name, size_t joint_index, const PacketField & field)
+{
+  if (field.scale == 0.0 || !std::isfinite(field.scale)) {
+    return return_type::ERROR;
+  }
+  const size_t end = field.offset + get_field_size(field.type);
+  for (const auto & mapping : mappings_) {
+    const size_t mapping_end = mapping.field.offset + get_field_size(mapping.field.type);
+    if (field.offset < mapping_end && mapping.field.offset < end) {
+      return return_type::ERROR;
+    }
+    if (mapping.interface_name == interface_name && mapping.joint_index == joint_index) {
+      return return_type::ERROR;
+    }
+  }
+  mappings_.push_back({interface_name, joint_index, field, 1.0 / field.scale, 0});
+  fields_size_ = std::max(fields_size_, end);
+  bound_ = false;
+  return return_type::OK;
+}
+
+size_t PacketLayout::get_field_count() const
+{
+  return mappings_.size();
+}
+
+void PacketLayout::set_packet_size(size_t packet_size)
+{
+  packet_size_ = packet_size;
+}
+
+size_t PacketLayout::get_packet_size() const
+{
+  return std::max(fields_size_, packet_size_);
+}
+
+return_type PacketLayout::bind(const components::JointValuesBatch & batch)
+{
+  bound_ = false;
+  for (auto & mapping : mappings_) {
+    size_t interface_index = 0;
+    if (batch.get_interface_index(mapping.interface_name, interface_index) != return_type::OK) {
+      return return_type::INTERFACE_NOT_FOUND;
+    }
+    if (mapping.joint_index >= batch.get_joint_count()) {
+      return return_type::ERROR;
+    }
+    mapping.value_index = interface_index * batch.get_joint_count() + mapping.joint_index;
+  }
+  bound_interfaces_ = batch.get_interfaces();
+  bound_joint_count_ = batch.get_joint_count();
+  bound_ = true;
+  return return_type::OK;
+}
+
+bool PacketLayout::is_bound_to(const components::JointValuesBatch & batch) const
+{
+  return bound_ && batch.get_joint_count() == bound_joint_count_ &&
+         batch.get_interfaces() == bound_interfaces_;
+}
+
+return_type PacketLayout::decode(
+  Span<const uint8_t> packet, components::JointValuesBatch & values) const
+{
+  if (!bound_ || packet.size() < get_packet_size() ||
+    values.get_joint_count() != bound_joint_count_ ||
+    values.get_interfaces().size() != bound_interfaces_.size())
+  {
+    return return_type::ERROR;
+  }
+  auto all_values = values.get_all_values();
+  for (const auto & mapping : mappings_) {
+    const auto & field = mapping.field;
+    const uint64_t raw =
+      load_bytes(packet.data() + field.offset, get_field_size(field.type), field.byte_order);
+    all_values[mapping.value_index] = from_raw(raw, field.type) * field.scale + field.bias;
+  }
+  return return_type::OK;
+}
+
+return_type PacketLayout::encode(
+  const components::JointValuesBatch & values, Span<uint8_t> packet) const
+{
+  if (!bound_ || packet.size() < get_packet_size() ||
+    values.get_joint_count() != bound_joint_count_ ||
+    values.get_interfaces().size() != bound_interfaces_.size())
+  {
+    return return_type::ERROR;
+  }
+  const auto all_values = values.get_all_values();
+  for (const auto & mapping : mappings_) {
+    const auto & field = mapping.field;
+    const double raw_value = (all_values[mapping.value_index] - field.bias) * mapping.inverse_scale;
+    store_bytes(
+      to_raw(raw_value, field.type), packet.data() + field.offset, get_field_size(field.type),
+      field.byte_order);
+  }
+  return return_type::OK;
+}
+
+size_t PacketLayout::get_field_size(PacketFieldType type)
+{
+  switch (type) {
+    case PacketFieldType::INT8:
+    case PacketFieldType::UINT8:
+      return 1;
+    case PacketFieldType::INT16:
+    case PacketFieldType::UINT16:
+      return 2;
+    case PacketFieldType::INT32:
+    case PacketFieldType::UINT32:
+    case PacketFieldType::FLOAT32:
+      return 4;
+    case PacketFieldType::FLOAT64:
+      return 8;
+  }
+  return 0;
+}
+
+}  // namespace hardware_interface
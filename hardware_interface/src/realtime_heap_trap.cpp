@@ -0,0 +1,87 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Replaces the global allocation functions of the executable it is linked into, to abort on any
+// allocation from the default heap in a real-time section. Only meant for debug and test builds.
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "hardware_interface/realtime_section.hpp"
+
+namespace
+{
+void * checked_malloc(std::size_t size)
+{
+  if (hardware_interface::RealtimeSection::is_active()) {
+    // neither allocates nor locks, unlike the logging
+    static const char kMessage[] = "realtime_heap_trap: heap allocation in a real-time section\n";
+#ifdef __linux__
+    const auto written = write(STDERR_FILENO, kMessage, sizeof(kMessage) - 1);
+    (void) written;
+#endif
+    std::abort();
+  }
+  return std::malloc(size ? size : 1);
+}
+}  // namespace
+
+void * operator new(std::size_t size)
+{
+  void * ptr = checked_malloc(size);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void * operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+void * operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+  return checked_malloc(size);
+}
+
+void * operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+  return checked_malloc(size);
+}
+
+void operator delete(void * ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void * ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void * ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void * ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
@@ -0,0 +1,206 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hardware_interface/realtime_logger.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace
+{
+constexpr auto kLoggerName = "realtime logger";
+/// Period the background thread polls the queue with, the producers never notify it
+constexpr auto kDrainPeriod = std::chrono::milliseconds(10);
+
+int64_t now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void print_with_rclcpp(
+  hardware_interface::RealtimeLogger::Severity severity, const char * logger_name,
+  const char * message)
+{
+  using Severity = hardware_interface::RealtimeLogger::Severity;
+  switch (severity) {
+    case Severity::DEBUG:
+      RCLCPP_DEBUG(rclcpp::get_logger(logger_name), "%s", message);
+      break;
+    case Severity::INFO:
+      RCLCPP_INFO(rclcpp::get_logger(logger_name), "%s", message);
+      break;
+    case Severity::WARN:
+      RCLCPP_WARN(rclcpp::get_logger(logger_name), "%s", message);
+      break;
+    case Severity::ERROR:
+      RCLCPP_ERROR(rclcpp::get_logger(logger_name), "%s", message);
+      break;
+  }
+}
+}  // namespace
+
+namespace hardware_interface
+{
+
+RealtimeLogger::RealtimeLogger(
+  size_t capacity, size_t max_messages_per_period, std::chrono::nanoseconds rate_limit_period,
+  Sink sink)
+: max_messages_per_period_(max_messages_per_period),
+  rate_limit_period_ns_(rate_limit_period.count()),
+  rate_limit_period_start_ns_(now_ns()),
+  sink_(sink ? std::move(sink) : Sink(print_with_rclcpp))
+{
+  size_t size = 1;
+  while (size < capacity) {
+    size <<= 1;
+  }
+  slots_.reset(new Slot[size]);
+  mask_ = size - 1;
+  for (size_t i = 0; i < size; ++i) {
+    slots_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  drain_thread_ = std::thread(&RealtimeLogger::drain_loop, this);
+}
+
+RealtimeLogger::~RealtimeLogger()
+{
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stop_ = true;
+  }
+  stop_cv_.notify_all();
+  drain_thread_.join();
+}
+
+bool RealtimeLogger::log(Severity severity, const char * logger_name, const char * format, ...)
+{
+  if (!acquire_rate_limit_token()) {
+    dropped_count_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  // bounded multi-producer queue, each slot's sequence tells whether it may be written or read
+  Slot * slot;
+  size_t position = enqueue_position_.load(std::memory_order_relaxed);
+  for (;;) {
+    slot = &slots_[position & mask_];
+    const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+    const auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+    if (difference == 0) {
+      if (enqueue_position_.compare_exchange_weak(
+          position, position + 1, std::memory_order_relaxed))
+      {
+        break;
+      }
+    } else if (difference < 0) {
+      // full
+      dropped_count_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    } else {
+      position = enqueue_position_.load(std::memory_order_relaxed);
+    }
+  }
+
+  slot->severity = severity;
+  std::strncpy(slot->logger_name, logger_name, kMaxLoggerNameLength);
+  slot->logger_name[kMaxLoggerNameLength] = '\0';
+  va_list arguments;
+  va_start(arguments, format);
+  std::vsnprintf(slot->message, sizeof(slot->message), format, arguments);
+  va_end(arguments);
+  slot->sequence.store(position + 1, std::memory_order_release);
+  return true;
+}
+
+void RealtimeLogger::flush()
+{
+  const size_t end = enqueue_position_.load(std::memory_order_acquire);
+  while (static_cast<std::ptrdiff_t>(dequeue_position_.load(std::memory_order_acquire) - end) < 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+uint64_t RealtimeLogger::get_dropped_count() const
+{
+  return dropped_count_.load(std::memory_order_relaxed);
+}
+
+bool RealtimeLogger::acquire_rate_limit_token()
+{
+  const int64_t now = now_ns();
+  int64_t period_start = rate_limit_period_start_ns_.load(std::memory_order_relaxed);
+  if (now - period_start >= rate_limit_period_ns_ &&
+    rate_limit_period_start_ns_.compare_exchange_strong(
+      period_start, now, std::memory_order_relaxed))
+  {
+    // a concurrent message may still be counted in the previous period, which is harmless
+    messages_in_period_.store(0, std::memory_order_relaxed);
+  }
+  return messages_in_period_.fetch_add(1, std::memory_order_relaxed) < max_messages_per_period_;
+}
+
+bool RealtimeLogger::print_next()
+{
+  const size_t position = dequeue_position_.load(std::memory_order_relaxed);
+  Slot & slot = slots_[position & mask_];
+  if (slot.sequence.load(std::memory_order_acquire) != position + 1) {
+    return false;
+  }
+  sink_(slot.severity, slot.logger_name, slot.message);
+  slot.sequence.store(position + mask_ + 1, std::memory_order_release);
+  dequeue_position_.store(position + 1, std::memory_order_release);
+  return true;
+}
+
+void RealtimeLogger::drain_loop()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    const bool stop = stop_;
+    lock.unlock();
+    while (print_next()) {
+    }
+    const uint64_t dropped_count = dropped_count_.load(std::memory_order_relaxed);
+    if (dropped_count != reported_dropped_count_) {
+      char message[kMaxMessageLength + 1];
+      std::snprintf(
+        message, sizeof(message), "dropped %llu real-time log messages",
+        static_cast<unsigned long long>(dropped_count - reported_dropped_count_));  // NOLINT
+      sink_(Severity::WARN, kLoggerName, message);
+      reported_dropped_count_ = dropped_count;
+    }
+    lock.lock();
+    if (stop) {
+      return;
+    }
+    stop_cv_.wait_for(lock, kDrainPeriod, [this] {return stop_;});
+  }
+}
+
+RealtimeLogger & get_realtime_logger()
+{
+  static RealtimeLogger logger;
+  return logger;
+}
+
+}  // namespace hardware_interface
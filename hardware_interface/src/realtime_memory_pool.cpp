@@ -0,0 +1,200 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hardware_interface/realtime_memory_pool.hpp"
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+namespace
+{
+/// The account charged by the calling thread, see ScopedPoolAllocationAccount
+thread_local hardware_interface::PoolAllocationAccount * current_account = nullptr;
+
+void charge(std::atomic<uint64_t> & count, std::atomic<uint64_t> & bytes, size_t block_size)
+{
+  count.fetch_add(1, std::memory_order_relaxed);
+  bytes.fetch_add(block_size, std::memory_order_relaxed);
+}
+
+size_t get_page_size()
+{
+#ifdef __linux__
+  return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else
+  return 4096;
+#endif
+}
+
+/// Index of the smallest power of two block, from MIN_BLOCK_SIZE, holding bytes.
+size_t get_size_class(size_t bytes)
+{
+  size_t size_class = 0;
+  for (size_t block_size = hardware_interface::RealtimeMemoryPool::MIN_BLOCK_SIZE;
+    block_size < bytes; block_size <<= 1)
+  {
+    ++size_class;
+  }
+  return size_class;
+}
+}  // namespace
+
+namespace hardware_interface
+{
+
+constexpr size_t RealtimeMemoryPool::MIN_BLOCK_SIZE;
+constexpr size_t RealtimeMemoryPool::MAX_ALIGNMENT;
+
+RealtimeMemoryPool::RealtimeMemoryPool(size_t capacity, bool lock_memory)
+{
+  const size_t page_size = get_page_size();
+  capacity_ = (std::max<size_t>(capacity, 1) + page_size - 1) / page_size * page_size;
+#ifdef __linux__
+  void * memory = mmap(
+    nullptr, capacity_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED) {
+    throw std::bad_alloc();
+  }
+  begin_ = static_cast<char *>(memory);
+  mapped_ = true;
+#else
+  begin_ = static_cast<char *>(::operator new(capacity_));
+#endif
+  // pre-fault every page, so that no allocation from the pool page-faults later on
+  for (size_t offset = 0; offset < capacity_; offset += page_size) {
+    begin_[offset] = 0;
+  }
+#ifdef __linux__
+  locked_ = lock_memory && mlock(begin_, capacity_) == 0;
+#else
+  (void) lock_memory;
+#endif
+}
+
+RealtimeMemoryPool::~RealtimeMemoryPool()
+{
+#ifdef __linux__
+  if (locked_) {
+    munlock(begin_, capacity_);
+  }
+  if (mapped_) {
+    munmap(begin_, capacity_);
+    return;
+  }
+#endif
+  ::operator delete(begin_);
+}
+
+ScopedPoolAllocationAccount::ScopedPoolAllocationAccount(PoolAllocationAccount * account)
+: previous_(current_account)
+{
+  current_account = account;
+}
+
+ScopedPoolAllocationAccount::~ScopedPoolAllocationAccount()
+{
+  current_account = previous_;
+}
+
+void * RealtimeMemoryPool::allocate(size_t bytes, size_t alignment)
+{
+  if (alignment > MAX_ALIGNMENT || (alignment & (alignment - 1)) != 0) {
+    throw std::bad_alloc();
+  }
+  const size_t size_class = get_size_class(bytes);
+  if (size_class >= kSizeClassCount) {
+    throw std::bad_alloc();
+  }
+  const size_t block_size = MIN_BLOCK_SIZE << size_class;
+  // blocks are aligned on their size, up to MAX_ALIGNMENT, so any freed block can be reused
+  const size_t block_alignment = std::min(block_size, MAX_ALIGNMENT);
+  if (alignment > block_alignment) {
+    throw std::bad_alloc();
+  }
+
+  void * block = nullptr;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    void *& free_list = free_lists_[size_class];
+    if (free_list) {
+      block = free_list;
+      std::memcpy(&free_list, block, sizeof(void *));
+    } else {
+      const auto address = reinterpret_cast<std::uintptr_t>(begin_) + next_;
+      const size_t padding = (block_alignment - address % block_alignment) % block_alignment;
+      if (padding + block_size > capacity_ - next_) {
+        throw std::bad_alloc();
+      }
+      block = begin_ + next_ + padding;
+      next_ += padding + block_size;
+    }
+  }
+  if (current_account) {
+    charge(current_account->allocation_count, current_account->allocated_bytes, block_size);
+  }
+  return block;
+}
+
+void RealtimeMemoryPool::deallocate(void * ptr, size_t bytes)
+{
+  if (!ptr) {
+    return;
+  }
+  const size_t size_class = get_size_class(bytes);
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    void *& free_list = free_lists_[size_class];
+    std::memcpy(ptr, &free_list, sizeof(void *));
+    free_list = ptr;
+  }
+  if (current_account) {
+    charge(
+      current_account->deallocation_count, current_account->deallocated_bytes,
+      MIN_BLOCK_SIZE << size_class);
+  }
+}
+
+bool RealtimeMemoryPool::owns(const void * ptr) const
+{
+  const auto address = reinterpret_cast<std::uintptr_t>(ptr);
+  const auto begin = reinterpret_cast<std::uintptr_t>(begin_);
+  return address >= begin && address < begin + capacity_;
+}
+
+size_t RealtimeMemoryPool::get_capacity() const
+{
+  return capacity_;
+}
+
+size_t RealtimeMemoryPool::get_reserved_size() const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  return next_;
+}
+
+bool RealtimeMemoryPool::is_locked() const
+{
+  return locked_;
+}
+
+}  // namespace hardware_interface
@@ -0,0 +1,77 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hardware_interface/realtime_section.hpp"
+
+#ifdef __linux__
+#include <dlfcn.h>
+#endif
+
+namespace
+{
+thread_local unsigned int realtime_section_depth = 0;
+
+/// Looks up a function of the realtime_violation_detector library, null if it is not preloaded
+template<typename FunctionT>
+FunctionT find_detector_function(const char * name)
+{
+#ifdef __linux__
+  return reinterpret_cast<FunctionT>(dlsym(RTLD_DEFAULT, name));
+#else
+  (void) name;
+  return nullptr;
+#endif
+}
+}  // namespace
+
+namespace hardware_interface
+{
+
+RealtimeSection::RealtimeSection()
+{
+  ++realtime_section_depth;
+}
+
+RealtimeSection::~RealtimeSection()
+{
+  --realtime_section_depth;
+}
+
+bool RealtimeSection::is_active()
+{
+  return realtime_section_depth > 0;
+}
+
+bool RealtimeSection::is_checked()
+{
+  return
+    find_detector_function<uint64_t (*)()>("realtime_violation_detector_get_count") != nullptr;
+}
+
+uint64_t RealtimeSection::get_violation_count()
+{
+  const auto get_count =
+    find_detector_function<uint64_t (*)()>("realtime_violation_detector_get_count");
+  return get_count ? get_count() : 0;
+}
+
+void RealtimeSection::reset_violation_count()
+{
+  const auto reset = find_detector_function<void (*)()>("realtime_violation_detector_reset");
+  if (reset) {
+    reset();
+  }
+}
+
+}  // namespace hardware_interface
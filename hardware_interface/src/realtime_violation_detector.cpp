@@ -0,0 +1,296 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Preloaded into tests with LD_PRELOAD, interposes the allocation functions, the mutex locks, the
+// sleeps and the blocking system calls, to report each call made in a real-time section with the
+// stack of the caller. Reports are written to stderr, and counted for the tests to assert that
+// their control loop is real-time clean, see RealtimeSection::get_violation_count().
+//
+// Environment variables:
+// REALTIME_VIOLATION_DETECTOR_MAX_REPORTS Number of violations reported with their stack, the
+//   following ones are only counted, 16 by default
+// REALTIME_VIOLATION_DETECTOR_ABORT Aborts after the first report when set to 1
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <linux/futex.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/select.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "hardware_interface/realtime_section.hpp"
+
+// the allocation functions of glibc, which do not need to be looked up while allocating
+extern "C" {
+void * __libc_malloc(size_t size);
+void * __libc_calloc(size_t count, size_t size);
+void * __libc_realloc(void * ptr, size_t size);
+void * __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void * ptr);
+}
+
+namespace
+{
+constexpr int kMaxFrames = 32;
+
+/// Set while checking or reporting, so that the calls made by the detector itself are let through
+__attribute__((tls_model("initial-exec"))) thread_local bool in_detector = false;
+
+std::atomic<uint64_t> violation_count{0};
+std::atomic<uint64_t> report_count{0};
+std::atomic<uint64_t> max_reports{16};
+std::atomic<bool> abort_on_violation{false};
+
+void write_to_stderr(const char * text)
+{
+  const auto written = ::write(STDERR_FILENO, text, std::strlen(text));
+  (void) written;
+}
+
+void report(const char * call)
+{
+  violation_count.fetch_add(1, std::memory_order_relaxed);
+  if (report_count.fetch_add(1, std::memory_order_relaxed) >=
+    max_reports.load(std::memory_order_relaxed))
+  {
+    return;
+  }
+  write_to_stderr("realtime_violation_detector: ");
+  write_to_stderr(call);
+  write_to_stderr(" in a real-time section, called from:\n");
+  void * frames[kMaxFrames];
+  const int frame_count = backtrace(frames, kMaxFrames);
+  // skips the frames of the detector
+  if (frame_count > 2) {
+    backtrace_symbols_fd(frames + 2, frame_count - 2, STDERR_FILENO);
+  }
+  if (abort_on_violation.load(std::memory_order_relaxed)) {
+    std::abort();
+  }
+}
+
+/// Reports the call when made in a real-time section, to be called first by each interposer
+void check(const char * call)
+{
+  if (in_detector) {
+    return;
+  }
+  in_detector = true;
+  if (hardware_interface::RealtimeSection::is_active()) {
+    report(call);
+  }
+  in_detector = false;
+}
+
+/// The function interposed, looked up once
+void * next_function(std::atomic<void *> & function, const char * name)
+{
+  auto next = function.load(std::memory_order_acquire);
+  if (!next) {
+    next = dlsym(RTLD_NEXT, name);
+    function.store(next, std::memory_order_release);
+  }
+  return next;
+}
+
+#define REALTIME_VIOLATION_DETECTOR_NEXT(name) \
+  reinterpret_cast<decltype(&::name)>( \
+    [] { \
+      static std::atomic<void *> function{nullptr}; \
+      return next_function(function, #name); \
+    } ())
+
+struct Options
+{
+  Options()
+  {
+    const char * max_reports_env = std::getenv("REALTIME_VIOLATION_DETECTOR_MAX_REPORTS");
+    if (max_reports_env) {
+      max_reports = std::strtoull(max_reports_env, nullptr, 10);
+    }
+    const char * abort_env = std::getenv("REALTIME_VIOLATION_DETECTOR_ABORT");
+    abort_on_violation = abort_env && std::strcmp(abort_env, "1") == 0;
+    // loads what backtrace() needs now rather than in the first report
+    void * frame;
+    backtrace(&frame, 1);
+  }
+} options;
+}  // namespace
+
+extern "C" {
+
+HARDWARE_INTERFACE_PUBLIC
+uint64_t realtime_violation_detector_get_count()
+{
+  return violation_count.load(std::memory_order_relaxed);
+}
+
+HARDWARE_INTERFACE_PUBLIC
+void realtime_violation_detector_reset()
+{
+  violation_count = 0;
+  report_count = 0;
+}
+
+void * malloc(size_t size) __THROW
+{
+  check("malloc");
+  return __libc_malloc(size);
+}
+
+void * calloc(size_t count, size_t size) __THROW
+{
+  check("calloc");
+  return __libc_calloc(count, size);
+}
+
+void * realloc(void * ptr, size_t size) __THROW
+{
+  check("realloc");
+  return __libc_realloc(ptr, size);
+}
+
+void * memalign(size_t alignment, size_t size) __THROW
+{
+  check("memalign");
+  return __libc_memalign(alignment, size);
+}
+
+void * aligned_alloc(size_t alignment, size_t size) __THROW
+{
+  check("aligned_alloc");
+  return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void ** ptr, size_t alignment, size_t size) __THROW
+{
+  check("posix_memalign");
+  void * allocated = __libc_memalign(alignment, size);
+  if (!allocated) {
+    return ENOMEM;
+  }
+  *ptr = allocated;
+  return 0;
+}
+
+void free(void * ptr) __THROW
+{
+  if (ptr) {
+    check("free");
+  }
+  __libc_free(ptr);
+}
+
+int pthread_mutex_lock(pthread_mutex_t * mutex) __THROWNL
+{
+  check("pthread_mutex_lock");
+  return REALTIME_VIOLATION_DETECTOR_NEXT(pthread_mutex_lock)(mutex);
+}
+
+int pthread_cond_wait(pthread_cond_t * cond, pthread_mutex_t * mutex)
+{
+  check("pthread_cond_wait");
+  return REALTIME_VIOLATION_DETECTOR_NEXT(pthread_cond_wait)(cond, mutex);
+}
+
+int pthread_cond_timedwait(
+  pthread_cond_t * cond, pthread_mutex_t * mutex, const struct timespec * abstime)
+{
+  check("pthread_cond_timedwait");
+  return REALTIME_VIOLATION_DETECTOR_NEXT(pthread_cond_timedwait)(cond, mutex, abstime);
+}
+
+unsigned int sleep(unsigned int seconds)
+{
+  check("sleep");
+  return REALTIME_VIOLATION_DETECTOR_NEXT(sleep)(seconds);
+}
+
+int usleep(useconds_t microseconds)
+{
+  check("usleep");
+  return REALTIME_VIOLATION_DETECTOR_NEXT(usleep)(microseconds);
+}
+
+int nanosleep(const struct timespec * duration, struct timespec * remaining)
+{
+  check("nanosleep");
+  return REALTIME_VIOLATION_DETECTOR_NEXT(nanosleep)(duration, remaining);
+}
+
+int clock_nanosleep(
+  clockid_t clock, int flags, const struct timespec * time, struct timespec * remaining)
+{
+  check("clock_nanosleep");
+  return REALTIME_VIOLATION_DETECTOR_NEXT(clock_nanosleep)(clock, flags, time, remaining);
+}
+
+ssize_t read(int fd, void * buffer, size_t count)
+{
+  check("read");
+  return REALTIME_VIOLATION_DETECTOR_NEXT(read)(fd, buffer, count);
+}
+
+ssize_t write(int fd, const void * buffer, size_t count)
+{
+  check("write");
+  return REALTIME_VIOLATION_DETECTOR_NEXT(write)(fd, buffer, count);
+}
+
+int poll(struct pollfd * fds, nfds_t count, int timeout)
+{
+  check("poll");
+  return REALTIME_VIOLATION_DETECTOR_NEXT(poll)(fds, count, timeout);
+}
+
+int select(
+  int count, fd_set * read_fds, fd_set * write_fds, fd_set * except_fds, struct timeval * timeout)
+{
+  check("select");
+  return REALTIME_VIOLATION_DETECTOR_NEXT(select)(count, read_fds, write_fds, except_fds, timeout);
+}
+
+long syscall(long number, ...) __THROW  // NOLINT(runtime/int)
+{
+  // the system calls take at most six arguments, passed in registers whatever their type
+  va_list arguments;
+  va_start(arguments, number);
+  long values[6];  // NOLINT(runtime/int)
+  for (auto & value : values) {
+    value = va_arg(arguments, long);  // NOLINT(runtime/int)
+  }
+  va_end(arguments);
+  // waking the threads sleeping on a futex neither blocks nor takes a lock
+  if (number != SYS_futex || (values[1] & FUTEX_CMD_MASK) != FUTEX_WAKE) {
+    check("syscall");
+  }
+  return REALTIME_VIOLATION_DETECTOR_NEXT(syscall)(
+    number, values[0], values[1], values[2], values[3], values[4], values[5]);
+}
+
+}  // extern "C"
@@ -15,110 +15,99 @@
 #include "hardware_interface/robot_hardware.hpp"
 
 #include <algorithm>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "hardware_interface/macros.hpp"
 #include "hardware_interface/operation_mode_handle.hpp"
+#include "hardware_interface/realtime_logger.hpp"
 #include "rclcpp/rclcpp.hpp"
 
 namespace
 {
+constexpr size_t kNotStaged = static_cast<size_t>(-1);
 constexpr auto kOperationModeLoggerName = "joint operation mode handle";
 constexpr auto kActuatorLoggerName = "actuator handle";
 constexpr auto kJointLoggerName = "joint handle";
-}
+constexpr auto kReferenceLoggerName = "reference handle";
 
-namespace hardware_interface
-{
-/// Register the handle to the handle list if the handle's name is not found.
-/**
- * \param[in] registered_handles The handle list.
- * \param[in] handle The handle to be registered.
- * \param[in] logger_name The name of the logger.
- * \return The return code, one of `OK` or `ERROR`.
- */
-template<typename T>
-return_type
-register_handle(std::vector<T *> & registered_handles, T * handle, const std::string & logger_name)
+/// Number of values of the arena, padding between the state and command regions included.
+size_t get_extent(hardware_interface::InterfaceValueArena & arena)
 {
-  if (handle->get_name().empty()) {
-    RCLCPP_ERROR_STREAM(
-      rclcpp::get_logger(
-        logger_name), "cannot register handle! No name is specified");
-    return return_type::ERROR;
+  if (arena.data() == nullptr) {
+    return 0;
   }
-
-  if (!handle->valid_pointers()) {
-    RCLCPP_ERROR_STREAM(
-      rclcpp::get_logger(
-        logger_name), "cannot register handle! Points to nullptr!");
-    return return_type::ERROR;
+  if (arena.get_command_size() == 0) {
+    return arena.get_state_size();
   }
+  return static_cast<size_t>(arena.get_command_values() - arena.data()) +
+         arena.get_command_size();
+}
 
-  auto handle_pos = std::find_if(
-    registered_handles.begin(), registered_handles.end(),
-    [&](auto handle_ptr) -> bool {
-      return handle_ptr->get_name() == handle->get_name();
-    });
-
-  // handle exists already
-  if (handle_pos != registered_handles.end()) {
-    RCLCPP_ERROR_STREAM(
-      rclcpp::get_logger(logger_name),
-      "cannot register handle! Handle exists already");
-    return return_type::ERROR;
+/// Name each value of the arena after its handle and interface, padding stays unnamed.
+template<typename GetInterfaceNames>
+std::vector<std::string> get_value_names(
+  hardware_interface::InterfaceValueArena & arena, const std::vector<std::string> & handle_names,
+  GetInterfaceNames get_interface_names)
+{
+  std::vector<std::string> names(get_extent(arena));
+  for (size_t handle = 0; handle < handle_names.size(); ++handle) {
+    const auto & interface_names = get_interface_names(handle_names[handle]);
+    for (size_t interface = 0; interface < interface_names.size(); ++interface) {
+      names[arena.get_offset(handle, interface)] =
+        handle_names[handle] + "/" + interface_names[interface];
+    }
   }
-  registered_handles.push_back(handle);
-  return return_type::OK;
+  return names;
+}
 }
 
+namespace hardware_interface
+{
 return_type
 RobotHardware::register_operation_mode_handle(OperationModeHandle * operation_mode_handle)
 {
-  return register_handle<OperationModeHandle>(
-    registered_operation_mode_handles_,
-    operation_mode_handle,
-    kOperationModeLoggerName);
+  return register_operation_mode_handle(operation_mode_handle, "");
 }
 
-/// Find the handle by name from the registered handle list.
-/**
- * \param[in] registered_handles The registered handle list.
- * \param[in] name The handle's name.
- * \param[in] logger_name The name of the logger.
- * \param[out] handle the handle if found.
- * \return The return code, one of `OK` or `ERROR`.
- */
-template<typename T>
 return_type
-get_handle(
-  std::vector<T *> & registered_handles,
-  const std::string & name,
-  const std::string & logger_name,
-  T ** handle)
+RobotHardware::register_operation_mode_handle(
+  OperationModeHandle * operation_mode_handle, const std::string & component_name)
 {
-  if (name.empty()) {
-    RCLCPP_ERROR_STREAM(
-      rclcpp::get_logger(logger_name),
-      "cannot get handle! No name given");
+  if (operation_mode_handle->get_name().empty()) {
+    HARDWARE_INTERFACE_RT_LOG_ERROR(
+      kOperationModeLoggerName, "cannot register handle! No name is specified");
     return return_type::ERROR;
   }
 
-  auto handle_pos = std::find_if(
-    registered_handles.begin(), registered_handles.end(),
-    [&](auto handle_ptr) -> bool {
-      return handle_ptr->get_name() == name;
-    });
+  if (!operation_mode_handle->valid_pointers()) {
+    HARDWARE_INTERFACE_RT_LOG_ERROR(
+      kOperationModeLoggerName, "cannot register handle! Points to nullptr!");
+    return return_type::ERROR;
+  }
 
-  if (handle_pos == registered_handles.end()) {
-    RCLCPP_ERROR_STREAM(
-      rclcpp::get_logger(
-        logger_name), "cannot get handle. No joint " << name << " found.");
+  const auto handle_index = registered_operation_mode_handles_.size();
+  if (!operation_mode_index_.emplace(operation_mode_handle->get_name(), handle_index).second) {
+    HARDWARE_INTERFACE_RT_LOG_ERROR(
+      kOperationModeLoggerName, "cannot register handle! Handle exists already");
     return return_type::ERROR;
   }
 
-  *handle = *handle_pos;
+  auto batch = std::find_if(
+    operation_mode_batches_.begin(), operation_mode_batches_.end(),
+    [&](const OperationModeBatch & batch) {return batch.component_name == component_name;});
+  if (batch == operation_mode_batches_.end()) {
+    operation_mode_batches_.push_back({component_name, {}});
+    batch = operation_mode_batches_.end() - 1;
+  }
+  // the batches are filled in the real-time thread and must not allocate
+  batch->changes.reserve(batch->changes.size() + 1);
+  operation_mode_components_.push_back(
+    static_cast<size_t>(batch - operation_mode_batches_.begin()));
+  staged_operation_modes_.push_back(kNotStaged);
+  registered_operation_mode_handles_.push_back(operation_mode_handle);
   return return_type::OK;
 }
 
@@ -127,11 +116,87 @@ RobotHardware::get_operation_mode_handle(
   const std::string & name, OperationModeHandle ** operation_mode_handle)
 {
   THROW_ON_NOT_NULLPTR(*operation_mode_handle)
-  return get_handle<OperationModeHandle>(
-    registered_operation_mode_handles_,
-    name,
-    kOperationModeLoggerName,
-    operation_mode_handle);
+  if (name.empty()) {
+    HARDWARE_INTERFACE_RT_LOG_ERROR(kOperationModeLoggerName, "cannot get handle! No name given");
+    return return_type::ERROR;
+  }
+
+  const auto found = operation_mode_index_.find(name);
+  if (found == operation_mode_index_.end()) {
+    HARDWARE_INTERFACE_RT_LOG_ERROR(
+      kOperationModeLoggerName, "cannot get handle. No joint %s found.", name.c_str());
+    return return_type::ERROR;
+  }
+
+  *operation_mode_handle = registered_operation_mode_handles_[found->second];
+  return return_type::OK;
+}
+
+bool RobotHardware::stage_operation_mode(const std::string & name, OperationMode mode)
+{
+  const auto found = operation_mode_index_.find(name);
+  if (found == operation_mode_index_.end()) {
+    return false;
+  }
+  const auto handle_index = found->second;
+  auto & changes = operation_mode_batches_[operation_mode_components_[handle_index]].changes;
+  auto & staged = staged_operation_modes_[handle_index];
+  if (staged == kNotStaged) {
+    staged = changes.size();
+    changes.push_back({registered_operation_mode_handles_[handle_index], mode});
+  } else {
+    changes[staged].mode = mode;
+  }
+  return true;
+}
+
+return_type RobotHardware::apply_staged_operation_modes()
+{
+  auto result = return_type::OK;
+  for (auto & batch : operation_mode_batches_) {
+    if (batch.changes.empty()) {
+      continue;
+    }
+    if (apply_operation_modes(batch) != return_type::OK && result == return_type::OK) {
+      HARDWARE_INTERFACE_RT_LOG_ERROR(
+        kOperationModeLoggerName, "component '%s' failed to apply its operation modes",
+        batch.component_name.c_str());
+      result = return_type::ERROR;
+    }
+  }
+  clear_staged_operation_modes();
+  return result;
+}
+
+void RobotHardware::clear_staged_operation_modes()
+{
+  for (auto & batch : operation_mode_batches_) {
+    batch.changes.clear();
+  }
+  std::fill(staged_operation_modes_.begin(), staged_operation_modes_.end(), kNotStaged);
+}
+
+return_type RobotHardware::request_operation_modes(
+  const std::vector<std::pair<std::string, OperationMode>> & modes)
+{
+  for (const auto & mode : modes) {
+    if (!stage_operation_mode(mode.first, mode.second)) {
+      HARDWARE_INTERFACE_RT_LOG_ERROR(
+        kOperationModeLoggerName, "cannot request operation mode. No joint %s found.",
+        mode.first.c_str());
+      clear_staged_operation_modes();
+      return return_type::ERROR;
+    }
+  }
+  return apply_staged_operation_modes();
+}
+
+return_type RobotHardware::apply_operation_modes(const OperationModeBatch & batch)
+{
+  for (const auto & change : batch.changes) {
+    change.handle->set_mode(change.mode);
+  }
+  return return_type::OK;
 }
 
 template<typename T>
@@ -160,52 +225,61 @@ RobotHardware::get_registered_operation_mode_handles()
 
 hardware_interface_ret_t register_handle(
   const std::string & handle_name,
-  const std::string & interface_name,
+  const InterfaceTypeId interface_type,
   const double default_value,
   control_msgs::msg::DynamicJointState & registered,
-  const std::string & logger_name)
+  const InterfaceValueArena & registered_values,
+  InterfaceLookupIndex & registered_index,
+  const char * logger_name)
 {
-  if (handle_name.empty() || interface_name.empty()) {
-    RCLCPP_ERROR_STREAM(rclcpp::get_logger(logger_name), "handle name or interface is empty!");
+  if (handle_name.empty() || !interface_type.is_valid()) {
+    HARDWARE_INTERFACE_RT_LOG_ERROR(logger_name, "handle name or interface is empty!");
     return return_type::ERROR;
   }
 
-  const auto & names_list = registered.joint_names;
-  const auto it = std::find(names_list.cbegin(), names_list.cend(), handle_name);
-  if (it == names_list.cend()) {
+  const auto & interface_name = interface_type.get_name();
+  if (registered_values.is_frozen()) {
+    HARDWARE_INTERFACE_RT_LOG_ERROR(
+      logger_name, "cannot register handle (%s:%s), the registration is frozen!",
+      handle_name.c_str(), interface_name.c_str());
+    return return_type::ERROR;
+  }
+
+  InterfaceId id;
+  if (!registered_index.find_handle(handle_name, id.handle_index)) {
+    id.handle_index = registered.joint_names.size();
     registered.joint_names.push_back(handle_name);
-    control_msgs::msg::InterfaceValue iv;
-    iv.interface_names = {interface_name};
-    iv.values = {default_value};
-    registered.interface_values.push_back(iv);
-    return return_type::OK;
-  } else {
-    const auto index = std::distance(names_list.cbegin(), it);
-    auto & ivs = registered.interface_values[static_cast<size_t>(index)];
-    const auto interface_names = ivs.interface_names;
-    const auto it = std::find(interface_names.cbegin(), interface_names.cend(), interface_name);
-    if (it == interface_names.cend()) {
-      ivs.interface_names.push_back(interface_name);
-      ivs.values.push_back(default_value);
-      return return_type::OK;
-    } else {
-      RCLCPP_ERROR_STREAM(
-        rclcpp::get_logger(logger_name), "handle with interface (" <<
-          handle_name << ":" << interface_name <<
-          ") is already registered!");
-      return return_type::ERROR;
-    }
+    registered.interface_values.emplace_back();
   }
+  auto & ivs = registered.interface_values[id.handle_index];
+  id.interface_index = ivs.interface_names.size();
+  if (!registered_index.add(handle_name, interface_type, id)) {
+    HARDWARE_INTERFACE_RT_LOG_ERROR(
+      logger_name, "handle with interface (%s:%s) is already registered!",
+      handle_name.c_str(), interface_name.c_str());
+    return return_type::ERROR;
+  }
+  ivs.interface_names.push_back(interface_name);
+  ivs.values.push_back(default_value);
+  return return_type::OK;
 }
 
 hardware_interface_ret_t RobotHardware::register_actuator(
   const std::string & actuator_name,
   const std::string & interface_name,
   const double default_value)
+{
+  return register_actuator(actuator_name, InterfaceTypeId::intern(interface_name), default_value);
+}
+
+hardware_interface_ret_t RobotHardware::register_actuator(
+  const std::string & actuator_name,
+  const InterfaceTypeId interface_type,
+  const double default_value)
 {
   return register_handle(
-    actuator_name, interface_name, default_value, registered_actuators_,
-    kActuatorLoggerName);
+    actuator_name, interface_type, default_value, registered_actuators_,
+    registered_actuator_values_, registered_actuator_index_, kActuatorLoggerName);
 }
 
 hardware_interface_ret_t RobotHardware::register_joint(
@@ -213,62 +287,251 @@ hardware_interface_ret_t RobotHardware::register_joint(
   const std::string & interface_name,
   double default_value)
 {
+  return register_joint(joint_name, InterfaceTypeId::intern(interface_name), default_value);
+}
+
+hardware_interface_ret_t RobotHardware::register_joint(
+  const std::string & joint_name,
+  const InterfaceTypeId interface_type,
+  double default_value)
+{
+  InterfaceValueType type;
+  if (interface_type.is_valid() &&
+    registered_typed_joint_values_.get_value_type(joint_name, interface_type.get_name(), type))
+  {
+    HARDWARE_INTERFACE_RT_LOG_ERROR(
+      kJointLoggerName, "handle with interface (%s:%s) is already registered as a typed value!",
+      joint_name.c_str(), interface_type.get_name().c_str());
+    return return_type::ERROR;
+  }
   return register_handle(
-    joint_name, interface_name, default_value, registered_joints_,
-    kJointLoggerName);
+    joint_name, interface_type, default_value, registered_joints_,
+    registered_joint_values_, registered_joint_index_, kJointLoggerName);
+}
+
+bool RobotHardware::can_register_typed_joint(
+  const std::string & joint_name, const std::string & interface_name)
+{
+  if (joint_name.empty() || interface_name.empty()) {
+    HARDWARE_INTERFACE_RT_LOG_ERROR(kJointLoggerName, "handle name or interface is empty!");
+    return false;
+  }
+  if (is_registration_frozen()) {
+    HARDWARE_INTERFACE_RT_LOG_ERROR(
+      kJointLoggerName, "cannot register handle (%s:%s), the registration is frozen!",
+      joint_name.c_str(), interface_name.c_str());
+    return false;
+  }
+  InterfaceId id;
+  InterfaceValueType type;
+  if (registered_joint_index_.find(joint_name, interface_name, id) ||
+    registered_typed_joint_values_.get_value_type(joint_name, interface_name, type))
+  {
+    HARDWARE_INTERFACE_RT_LOG_ERROR(
+      kJointLoggerName, "handle with interface (%s:%s) is already registered!",
+      joint_name.c_str(), interface_name.c_str());
+    return false;
+  }
+  return true;
+}
+
+void RobotHardware::log_typed_joint_not_found(
+  const std::string & joint_name, const std::string & interface_name) const
+{
+  if (!is_registration_frozen()) {
+    HARDWARE_INTERFACE_RT_LOG_ERROR(
+      kJointLoggerName, "registration must be frozen to get typed handle (%s:%s)!",
+      joint_name.c_str(), interface_name.c_str());
+    return;
+  }
+  HARDWARE_INTERFACE_RT_LOG_ERROR(
+    kJointLoggerName, "typed handle with interface (%s:%s) of that type wasn't found!",
+    joint_name.c_str(), interface_name.c_str());
+}
+
+/// Get the storage of an interface value, in the arena once the registration is frozen.
+double * get_value_ptr(
+  control_msgs::msg::DynamicJointState & registered,
+  InterfaceValueArena & registered_values,
+  size_t handle_index,
+  size_t interface_index)
+{
+  if (registered_values.is_frozen()) {
+    return registered_values.get_value_ptr(handle_index, interface_index);
+  }
+  return &registered.interface_values[handle_index].values[interface_index];
 }
 
 template<class HandleType>
 hardware_interface_ret_t get_handle(
   HandleType & handle,
   control_msgs::msg::DynamicJointState & registered,
-  const std::string & logger_name)
+  InterfaceValueArena & registered_values,
+  const InterfaceLookupIndex & registered_index,
+  const char * logger_name)
 {
   const auto & handle_name = handle.get_name();
   const auto & interface_name = handle.get_interface_name();
 
   if (handle_name.empty() || interface_name.empty()) {
-    RCLCPP_ERROR_STREAM(
-      rclcpp::get_logger(logger_name), "name or interface is ill-defined!");
+    HARDWARE_INTERFACE_RT_LOG_ERROR(logger_name, "name or interface is ill-defined!");
     return return_type::ERROR;
   }
 
-  const auto & names_list = registered.joint_names;
-  const auto it = std::find(names_list.cbegin(), names_list.cend(), handle_name);
-  if (it == names_list.cend()) {
-    RCLCPP_ERROR_STREAM(
-      rclcpp::get_logger(
-        logger_name), "handle with name " << handle_name << " not found!");
+  InterfaceId id;
+  if (!registered_index.find_handle(handle_name, id.handle_index)) {
+    HARDWARE_INTERFACE_RT_LOG_ERROR(
+      logger_name, "handle with name %s not found!", handle_name.c_str());
     return return_type::ERROR;
   }
 
-  const auto index = std::distance(names_list.cbegin(), it);
-  auto & ivs = registered.interface_values[static_cast<size_t>(index)];
-  const auto interface_names = ivs.interface_names;
-  const auto if_it = std::find(interface_names.cbegin(), interface_names.cend(), interface_name);
-  if (if_it != interface_names.cend()) {
-    const auto value_index = std::distance(interface_names.cbegin(), if_it);
-    handle = handle.with_value_ptr(&(ivs.values[static_cast<size_t>(value_index)]));
-    return return_type::OK;
-  } else {
-    RCLCPP_ERROR_STREAM(
-      rclcpp::get_logger(
-        logger_name),
-      "handle with interface (" << handle_name << ":" << interface_name << ") wasn't found!");
+  if (!registered_index.find(handle_name, interface_name, id)) {
+    HARDWARE_INTERFACE_RT_LOG_ERROR(
+      logger_name, "handle with interface (%s:%s) wasn't found!",
+      handle_name.c_str(), interface_name.c_str());
     return return_type::ERROR;
   }
 
-  return return_type::ERROR;
+  handle = handle.with_value_ptr(
+    get_value_ptr(registered, registered_values, id.handle_index, id.interface_index));
+  return return_type::OK;
 }
 
 hardware_interface_ret_t RobotHardware::get_actuator_handle(ActuatorHandle & actuator_handle)
 {
-  return get_handle<ActuatorHandle>(actuator_handle, registered_actuators_, kActuatorLoggerName);
+  return get_handle<ActuatorHandle>(
+    actuator_handle, registered_actuators_, registered_actuator_values_,
+    registered_actuator_index_, kActuatorLoggerName);
 }
 
 hardware_interface_ret_t RobotHardware::get_joint_handle(JointHandle & joint_handle)
 {
-  return get_handle<JointHandle>(joint_handle, registered_joints_, kJointLoggerName);
+  return get_handle<JointHandle>(
+    joint_handle, registered_joints_, registered_joint_values_, registered_joint_index_,
+    kJointLoggerName);
+}
+
+const std::string & get_interface_name(const std::string & interface_name)
+{
+  return interface_name;
+}
+
+const std::string & get_interface_name(const InterfaceTypeId interface_type)
+{
+  return interface_type.get_name();
+}
+
+template<typename InterfaceT>
+hardware_interface_ret_t get_interface_id(
+  const std::string & handle_name,
+  const InterfaceT & interface,
+  const InterfaceLookupIndex & registered_index,
+  InterfaceId & interface_id,
+  const char * logger_name)
+{
+  if (!registered_index.find(handle_name, interface, interface_id)) {
+    HARDWARE_INTERFACE_RT_LOG_ERROR(
+      logger_name, "handle with interface (%s:%s) wasn't found!",
+      handle_name.c_str(), get_interface_name(interface).c_str());
+    return return_type::ERROR;
+  }
+  return return_type::OK;
+}
+
+hardware_interface_ret_t RobotHardware::get_actuator_interface_id(
+  const std::string & actuator_name, const std::string & interface_name,
+  InterfaceId & interface_id) const
+{
+  return get_interface_id(
+    actuator_name, interface_name, registered_actuator_index_, interface_id,
+    kActuatorLoggerName);
+}
+
+hardware_interface_ret_t RobotHardware::get_actuator_interface_id(
+  const std::string & actuator_name, InterfaceTypeId interface_type,
+  InterfaceId & interface_id) const
+{
+  return get_interface_id(
+    actuator_name, interface_type, registered_actuator_index_, interface_id,
+    kActuatorLoggerName);
+}
+
+hardware_interface_ret_t RobotHardware::get_joint_interface_id(
+  const std::string & joint_name, const std::string & interface_name,
+  InterfaceId & interface_id) const
+{
+  return get_interface_id(
+    joint_name, interface_name, registered_joint_index_, interface_id, kJointLoggerName);
+}
+
+hardware_interface_ret_t RobotHardware::get_joint_interface_id(
+  const std::string & joint_name, InterfaceTypeId interface_type,
+  InterfaceId & interface_id) const
+{
+  return get_interface_id(
+    joint_name, interface_type, registered_joint_index_, interface_id, kJointLoggerName);
+}
+
+template<class HandleType>
+hardware_interface_ret_t get_handle(
+  const InterfaceId & interface_id,
+  HandleType & handle,
+  control_msgs::msg::DynamicJointState & registered,
+  InterfaceValueArena & registered_values,
+  const char * logger_name,
+  bool published = false)
+{
+  if (interface_id.handle_index >= registered.joint_names.size() ||
+    interface_id.interface_index >=
+    registered.interface_values[interface_id.handle_index].interface_names.size())
+  {
+    HARDWARE_INTERFACE_RT_LOG_ERROR(
+      logger_name, "handle with id (%zu:%zu) wasn't found!",
+      interface_id.handle_index, interface_id.interface_index);
+    return return_type::ERROR;
+  }
+
+  handle = HandleType(
+    registered.joint_names[interface_id.handle_index],
+    registered.interface_values[interface_id.handle_index].interface_names[
+      interface_id.interface_index],
+    published && registered_values.is_frozen() ?
+    registered_values.get_published_value_ptr(
+      interface_id.handle_index, interface_id.interface_index) :
+    get_value_ptr(
+      registered, registered_values, interface_id.handle_index, interface_id.interface_index));
+  return return_type::OK;
+}
+
+hardware_interface_ret_t RobotHardware::get_actuator_handle(
+  const InterfaceId & interface_id, ActuatorHandle & actuator_handle)
+{
+  return get_handle<ActuatorHandle>(
+    interface_id, actuator_handle, registered_actuators_, registered_actuator_values_,
+    kActuatorLoggerName);
+}
+
+hardware_interface_ret_t RobotHardware::get_joint_handle(
+  const InterfaceId & interface_id, JointHandle & joint_handle)
+{
+  return get_handle<JointHandle>(
+    interface_id, joint_handle, registered_joints_, registered_joint_values_, kJointLoggerName);
+}
+
+hardware_interface_ret_t RobotHardware::get_published_actuator_handle(
+  const InterfaceId & interface_id, ActuatorHandle & actuator_handle)
+{
+  return get_handle<ActuatorHandle>(
+    interface_id, actuator_handle, registered_actuators_, registered_actuator_values_,
+    kActuatorLoggerName, true);
+}
+
+hardware_interface_ret_t RobotHardware::get_published_joint_handle(
+  const InterfaceId & interface_id, JointHandle & joint_handle)
+{
+  return get_handle<JointHandle>(
+    interface_id, joint_handle, registered_joints_, registered_joint_values_, kJointLoggerName,
+    true);
 }
 
 template<class HandleType>
@@ -284,12 +547,40 @@ hardware_interface_ret_t get_handles(
   return return_type::OK;
 }
 
+template<class HandleType>
+hardware_interface_ret_t get_handles(
+  std::vector<HandleType> & handles,
+  const InterfaceTypeId interface_type,
+  control_msgs::msg::DynamicJointState & registered,
+  InterfaceValueArena & registered_values,
+  const InterfaceLookupIndex & registered_index)
+{
+  const auto & interface_name = interface_type.get_name();
+  for (size_t handle_index = 0; handle_index < registered.joint_names.size(); ++handle_index) {
+    size_t interface_index;
+    if (registered_index.find_interface(handle_index, interface_type, interface_index)) {
+      handles.emplace_back(
+        registered.joint_names[handle_index], interface_name,
+        get_value_ptr(registered, registered_values, handle_index, interface_index));
+    }
+  }
+  return return_type::OK;
+}
+
 hardware_interface_ret_t RobotHardware::get_actuator_handles(
   std::vector<ActuatorHandle> & actuator_handles, const std::string & interface_name)
 {
   return get_handles<ActuatorHandle>(actuator_handles, get_registered_actuators(), interface_name);
 }
 
+hardware_interface_ret_t RobotHardware::get_actuator_handles(
+  std::vector<ActuatorHandle> & actuator_handles, InterfaceTypeId interface_type)
+{
+  return get_handles<ActuatorHandle>(
+    actuator_handles, interface_type, registered_actuators_, registered_actuator_values_,
+    registered_actuator_index_);
+}
+
 hardware_interface_ret_t RobotHardware::get_joint_handles(
   std::vector<JointHandle> & joint_handles,
   const std::string & interface_name)
@@ -297,6 +588,14 @@ hardware_interface_ret_t RobotHardware::get_joint_handles(
   return get_handles<JointHandle>(joint_handles, get_registered_joints(), interface_name);
 }
 
+hardware_interface_ret_t RobotHardware::get_joint_handles(
+  std::vector<JointHandle> & joint_handles, InterfaceTypeId interface_type)
+{
+  return get_handles<JointHandle>(
+    joint_handles, interface_type, registered_joints_, registered_joint_values_,
+    registered_joint_index_);
+}
+
 const std::vector<std::string> & RobotHardware::get_registered_actuator_names()
 {
   return registered_actuators_.joint_names;
@@ -310,36 +609,35 @@ const std::vector<std::string> & RobotHardware::get_registered_joint_names()
 template<class HandleType>
 const std::vector<std::string> & get_registered_interface_names(
   const std::string & name,
-  control_msgs::msg::DynamicJointState & registered)
+  control_msgs::msg::DynamicJointState & registered,
+  const InterfaceLookupIndex & registered_index)
 {
-  const auto & it = std::find(
-    registered.joint_names.begin(), registered.joint_names.end(), name);
-
-  if (it == registered.joint_names.end()) {
+  size_t joint_index;
+  if (!registered_index.find_handle(name, joint_index)) {
     throw std::runtime_error(name + " not found");
   }
 
-  // joint found, can safely cast here
-  const auto joint_index =
-    static_cast<uint64_t>(std::distance(registered.joint_names.begin(), it));
-
   return registered.interface_values[joint_index].interface_names;
 }
 
 const std::vector<std::string> & RobotHardware::get_registered_actuator_interface_names(
   const std::string & actuator_name)
 {
-  return get_registered_interface_names<ActuatorHandle>(actuator_name, registered_actuators_);
+  return get_registered_interface_names<ActuatorHandle>(
+    actuator_name, registered_actuators_, registered_actuator_index_);
 }
 
 const std::vector<std::string> & RobotHardware::get_registered_joint_interface_names(
   const std::string & joint_name)
 {
-  return get_registered_interface_names<JointHandle>(joint_name, registered_joints_);
+  return get_registered_interface_names<JointHandle>(
+    joint_name, registered_joints_, registered_joint_index_);
 }
 
 template<class HandleType>
-std::vector<HandleType> get_registered_handles(control_msgs::msg::DynamicJointState & registered)
+std::vector<HandleType> get_registered_handles(
+  control_msgs::msg::DynamicJointState & registered,
+  InterfaceValueArena & registered_values)
 {
   std::vector<HandleType> result;
   result.reserve(registered.joint_names.size());    // rough estimate
@@ -355,7 +653,7 @@ std::vector<HandleType> get_registered_handles(control_msgs::msg::DynamicJointSt
     for (auto j = 0u; j < joint_interfaces.interface_names.size(); ++j) {
       result.emplace_back(
         handle_names[i], joint_interfaces.interface_names[j],
-        &joint_interfaces.values[j]);
+        get_value_ptr(registered, registered_values, i, j));
     }
   }
 
@@ -364,12 +662,378 @@ std::vector<HandleType> get_registered_handles(control_msgs::msg::DynamicJointSt
 
 std::vector<ActuatorHandle> RobotHardware::get_registered_actuators()
 {
-  return get_registered_handles<ActuatorHandle>(registered_actuators_);
+  return get_registered_handles<ActuatorHandle>(
+    registered_actuators_, registered_actuator_values_);
 }
 
 std::vector<JointHandle> RobotHardware::get_registered_joints()
 {
-  return get_registered_handles<JointHandle>(registered_joints_);
+  return get_registered_handles<JointHandle>(registered_joints_, registered_joint_values_);
+}
+
+return_type RobotHardware::freeze_registration()
+{
+  if (is_registration_frozen()) {
+    RCLCPP_ERROR(rclcpp::get_logger(kJointLoggerName), "registration is already frozen!");
+    return return_type::ERROR;
+  }
+  registered_actuator_values_.freeze(registered_actuators_, memory_pool_.get());
+  registered_joint_values_.freeze(registered_joints_, memory_pool_.get());
+  registered_typed_joint_values_.freeze(memory_pool_.get());
+  // all the values are claimed until the controller manager switches controllers
+  claimed_joint_values_.assign((get_extent(registered_joint_values_) + 63) / 64, 0u);
+  std::vector<uint64_t> all_values;
+  get_joint_value_mask(false, all_values);
+  get_joint_value_mask(true, all_values);
+  claimed_joint_values_ = std::move(all_values);
+  return return_type::OK;
+}
+
+return_type RobotHardware::set_memory_pool(std::shared_ptr<RealtimeMemoryPool> pool)
+{
+  if (is_registration_frozen()) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger(kJointLoggerName),
+      "registration is already frozen, the arenas are already allocated!");
+    return return_type::ERROR;
+  }
+  memory_pool_ = std::move(pool);
+  return return_type::OK;
+}
+
+std::shared_ptr<RealtimeMemoryPool> RobotHardware::get_memory_pool() const
+{
+  return memory_pool_;
+}
+
+void RobotHardware::set_hardware_freshness(std::shared_ptr<HardwareFreshness> freshness)
+{
+  hardware_freshness_ = std::move(freshness);
+}
+
+const std::shared_ptr<HardwareFreshness> & RobotHardware::get_hardware_freshness() const
+{
+  return hardware_freshness_;
+}
+
+void RobotHardware::set_clock_domains(std::shared_ptr<ClockDomainMap> clock_domains)
+{
+  clock_domains_ = std::move(clock_domains);
+}
+
+const std::shared_ptr<ClockDomainMap> & RobotHardware::get_clock_domains() const
+{
+  return clock_domains_;
+}
+
+void RobotHardware::set_sync_event_source(std::shared_ptr<SyncEventSource> sync_event_source)
+{
+  sync_event_source_ = std::move(sync_event_source);
+}
+
+const std::shared_ptr<SyncEventSource> & RobotHardware::get_sync_event_source() const
+{
+  return sync_event_source_;
+}
+
+bool RobotHardware::is_registration_frozen() const
+{
+  return registered_joint_values_.is_frozen();
+}
+
+InterfaceValueArena & RobotHardware::get_actuator_values()
+{
+  return registered_actuator_values_;
+}
+
+InterfaceValueArena & RobotHardware::get_joint_values()
+{
+  return registered_joint_values_;
+}
+
+TypedValueArena & RobotHardware::get_typed_joint_values()
+{
+  return registered_typed_joint_values_;
+}
+
+std::vector<std::string> RobotHardware::get_actuator_value_names()
+{
+  return get_value_names(
+    registered_actuator_values_, get_registered_actuator_names(),
+    [this](const std::string & name) -> const std::vector<std::string> & {
+      return get_registered_actuator_interface_names(name);
+    });
+}
+
+std::vector<std::string> RobotHardware::get_joint_value_names()
+{
+  return get_value_names(
+    registered_joint_values_, get_registered_joint_names(),
+    [this](const std::string & name) -> const std::vector<std::string> & {
+      return get_registered_joint_interface_names(name);
+    });
+}
+
+void RobotHardware::publish_commands()
+{
+  registered_actuator_values_.publish_commands();
+  registered_joint_values_.publish_commands();
+  registered_typed_joint_values_.publish_commands();
+}
+
+return_type RobotHardware::get_joint_value_mask(
+  const std::map<std::string, std::vector<std::string>> & interfaces,
+  std::vector<uint64_t> & mask) const
+{
+  if (!is_registration_frozen()) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger(kJointLoggerName), "registration must be frozen to resolve value masks!");
+    return return_type::ERROR;
+  }
+  mask.resize(get_joint_value_mask_size());
+  for (const auto & interface : interfaces) {
+    for (const auto & joint_name : interface.second) {
+      InterfaceId id;
+      if (registered_joint_index_.find(joint_name, interface.first, id)) {
+        const auto offset =
+          registered_joint_values_.get_offset(id.handle_index, id.interface_index);
+        mask[offset / 64] |= uint64_t(1) << (offset % 64);
+      }
+    }
+  }
+  return return_type::OK;
+}
+
+return_type RobotHardware::get_joint_value_mask(bool commands, std::vector<uint64_t> & mask) const
+{
+  if (!is_registration_frozen()) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger(kJointLoggerName), "registration must be frozen to resolve value masks!");
+    return return_type::ERROR;
+  }
+  mask.resize(get_joint_value_mask_size());
+  for (size_t j = 0; j < registered_joints_.joint_names.size(); ++j) {
+    const auto & interface_names = registered_joints_.interface_values[j].interface_names;
+    for (size_t i = 0; i < interface_names.size(); ++i) {
+      if (InterfaceValueArena::is_command_interface(interface_names[i]) == commands) {
+        const auto offset = registered_joint_values_.get_offset(j, i);
+        mask[offset / 64] |= uint64_t(1) << (offset % 64);
+      }
+    }
+  }
+  return return_type::OK;
+}
+
+size_t RobotHardware::get_joint_value_mask_size() const
+{
+  return claimed_joint_values_.size();
+}
+
+return_type RobotHardware::set_claimed_joint_values(Span<const uint64_t> mask)
+{
+  if (mask.size() != claimed_joint_values_.size()) {
+    return return_type::ERROR;
+  }
+  std::copy(mask.begin(), mask.end(), claimed_joint_values_.begin());
+  return return_type::OK;
+}
+
+Span<const uint64_t> RobotHardware::get_claimed_joint_values() const
+{
+  return Span<const uint64_t>(claimed_joint_values_.data(), claimed_joint_values_.size());
+}
+
+/// Resolve the offsets in the arena of one interface of a group of handles.
+template<typename InterfaceT>
+return_type get_value_group(
+  const std::vector<std::string> & handle_names,
+  const InterfaceT & interface,
+  const InterfaceLookupIndex & registered_index,
+  InterfaceValueArena & registered_values,
+  std::vector<size_t> & offsets,
+  const char * logger_name)
+{
+  if (!registered_values.is_frozen()) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger(logger_name), "registration must be frozen to resolve value groups!");
+    return return_type::ERROR;
+  }
+  offsets.clear();
+  offsets.reserve(handle_names.size());
+  for (const auto & handle_name : handle_names) {
+    InterfaceId interface_id;
+    if (get_interface_id(
+        handle_name, interface, registered_index, interface_id, logger_name) != return_type::OK)
+    {
+      return return_type::ERROR;
+    }
+    offsets.push_back(
+      registered_values.get_offset(interface_id.handle_index, interface_id.interface_index));
+  }
+  return return_type::OK;
+}
+
+return_type RobotHardware::get_actuator_value_group(
+  const std::vector<std::string> & actuator_names, const std::string & interface_name,
+  InterfaceValueGroup & group)
+{
+  std::vector<size_t> offsets;
+  const auto ret = get_value_group(
+    actuator_names, interface_name, registered_actuator_index_, registered_actuator_values_,
+    offsets, kActuatorLoggerName);
+  if (ret == return_type::OK) {
+    group = InterfaceValueGroup(registered_actuator_values_.data(), std::move(offsets));
+  }
+  return ret;
+}
+
+return_type RobotHardware::get_actuator_value_group(
+  const std::vector<std::string> & actuator_names, InterfaceTypeId interface_type,
+  InterfaceValueGroup & group)
+{
+  std::vector<size_t> offsets;
+  const auto ret = get_value_group(
+    actuator_names, interface_type, registered_actuator_index_, registered_actuator_values_,
+    offsets, kActuatorLoggerName);
+  if (ret == return_type::OK) {
+    group = InterfaceValueGroup(registered_actuator_values_.data(), std::move(offsets));
+  }
+  return ret;
+}
+
+return_type RobotHardware::get_joint_value_group(
+  const std::vector<std::string> & joint_names, const std::string & interface_name,
+  InterfaceValueGroup & group)
+{
+  std::vector<size_t> offsets;
+  const auto ret = get_value_group(
+    joint_names, interface_name, registered_joint_index_, registered_joint_values_, offsets,
+    kJointLoggerName);
+  if (ret == return_type::OK) {
+    group = InterfaceValueGroup(registered_joint_values_.data(), std::move(offsets));
+  }
+  return ret;
+}
+
+return_type RobotHardware::get_joint_value_group(
+  const std::vector<std::string> & joint_names, InterfaceTypeId interface_type,
+  InterfaceValueGroup & group)
+{
+  std::vector<size_t> offsets;
+  const auto ret = get_value_group(
+    joint_names, interface_type, registered_joint_index_, registered_joint_values_, offsets,
+    kJointLoggerName);
+  if (ret == return_type::OK) {
+    group = InterfaceValueGroup(registered_joint_values_.data(), std::move(offsets));
+  }
+  return ret;
+}
+
+return_type RobotHardware::get_actuator_values(
+  const InterfaceValueGroup & group, Span<double> values) const
+{
+  return group.get_values(values);
+}
+
+return_type RobotHardware::set_actuator_values(
+  const InterfaceValueGroup & group, Span<const double> values)
+{
+  return group.set_values(values);
+}
+
+return_type RobotHardware::get_joint_values(
+  const InterfaceValueGroup & group, Span<double> values) const
+{
+  return group.get_values(values);
+}
+
+return_type RobotHardware::set_joint_values(
+  const InterfaceValueGroup & group, Span<const double> values)
+{
+  return group.set_values(values);
+}
+
+hardware_interface_ret_t RobotHardware::register_reference_interface(
+  const std::string & reference_name, const std::string & interface_name, double * value)
+{
+  if (!value) {
+    HARDWARE_INTERFACE_RT_LOG_ERROR(
+      kReferenceLoggerName, "cannot register reference (%s:%s)! Points to nullptr!",
+      reference_name.c_str(), interface_name.c_str());
+    return return_type::ERROR;
+  }
+  std::lock_guard<std::mutex> guard(references_mutex_);
+  const auto key = std::make_pair(reference_name, interface_name);
+  if (!registered_references_.emplace(key, value).second) {
+    HARDWARE_INTERFACE_RT_LOG_ERROR(
+      kReferenceLoggerName, "cannot register reference (%s:%s)! Reference exists already",
+      reference_name.c_str(), interface_name.c_str());
+    return return_type::ERROR;
+  }
+  return return_type::OK;
+}
+
+hardware_interface_ret_t RobotHardware::unregister_reference_interface(
+  const std::string & reference_name, const std::string & interface_name)
+{
+  std::lock_guard<std::mutex> guard(references_mutex_);
+  if (registered_references_.erase(std::make_pair(reference_name, interface_name)) == 0) {
+    HARDWARE_INTERFACE_RT_LOG_ERROR(
+      kReferenceLoggerName, "reference (%s:%s) wasn't registered!",
+      reference_name.c_str(), interface_name.c_str());
+    return return_type::ERROR;
+  }
+  return return_type::OK;
+}
+
+hardware_interface_ret_t RobotHardware::get_reference_handle(JointHandle & reference_handle)
+{
+  std::lock_guard<std::mutex> guard(references_mutex_);
+  const auto found = registered_references_.find(
+    std::make_pair(reference_handle.get_name(), reference_handle.get_interface_name()));
+  if (found == registered_references_.end()) {
+    HARDWARE_INTERFACE_RT_LOG_ERROR(
+      kReferenceLoggerName, "reference with interface (%s:%s) wasn't found!",
+      reference_handle.get_name().c_str(), reference_handle.get_interface_name().c_str());
+    return return_type::ERROR;
+  }
+  reference_handle = reference_handle.with_value_ptr(found->second);
+  return return_type::OK;
+}
+
+return_type RobotHardware::prepare_switch(
+  const std::vector<ControllerInfo> &,
+  const std::vector<ControllerInfo> &)
+{
+  return return_type::OK;
+}
+
+return_type RobotHardware::perform_switch(
+  const std::vector<ControllerInfo> & start_list,
+  const std::vector<ControllerInfo> & stop_list)
+{
+  // joints claimed by both a stopped and a started controller stay active
+  for (const auto & controllers : {&stop_list, &start_list}) {
+    const auto mode = controllers == &start_list ? OperationMode::ACTIVE : OperationMode::INACTIVE;
+    for (const auto & controller : *controllers) {
+      for (const auto & claimed : controller.resources) {
+        for (const auto & joint_name : claimed.second) {
+          stage_operation_mode(joint_name, mode);
+        }
+      }
+    }
+  }
+  return apply_staged_operation_modes();
+}
+
+switch_state RobotHardware::get_switch_state() const
+{
+  return switch_state::DONE;
+}
+
+switch_state RobotHardware::get_switch_state(const ControllerInfo &) const
+{
+  return get_switch_state();
 }
 
 }  // namespace hardware_interface
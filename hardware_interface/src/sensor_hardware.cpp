@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <utility>
@@ -19,8 +20,10 @@
 
 #include "hardware_interface/sensor_hardware.hpp"
 
+#include "hardware_interface/clock_domain_map.hpp"
 #include "hardware_interface/components/component_info.hpp"
 #include "hardware_interface/components/sensor.hpp"
+#include "hardware_interface/hardware_freshness.hpp"
 #include "hardware_interface/hardware_info.hpp"
 #include "hardware_interface/sensor_hardware_interface.hpp"
 #include "hardware_interface/types/hardware_interface_return_values.hpp"
@@ -51,13 +54,52 @@ return_type SensorHardware::stop()
 
 status SensorHardware::get_status() const
 {
-  return impl_->get_status();
+  const status current = impl_->get_status();
+  if (current == status::STARTED && freshness_ &&
+    !freshness_->is_fresh(HardwareFreshness::get_component_mask(freshness_component_)))
+  {
+    return status::TIMED_OUT;
+  }
+  return current;
+}
+
+void SensorHardware::set_freshness(
+  std::shared_ptr<HardwareFreshness> freshness, size_t component)
+{
+  freshness_ = std::move(freshness);
+  freshness_component_ = component;
+}
+
+void SensorHardware::set_clock_domain(
+  std::shared_ptr<ClockDomainMap> clock_domains, size_t domain)
+{
+  clock_domains_ = std::move(clock_domains);
+  clock_domain_ = domain;
 }
 
 return_type SensorHardware::read_sensors(
   const std::vector<std::shared_ptr<components::Sensor>> & sensors)
 {
-  return impl_->read_sensors(sensors);
+  return_type ret = impl_->read_sensors(sensors);
+  if (ret == return_type::OK) {
+    ret = components::filter_sensor_states(sensors);
+  }
+  return record_read(ret);
+}
+
+return_type SensorHardware::record_read(return_type ret)
+{
+  if (ret != return_type::OK) {
+    return ret;
+  }
+  if (freshness_) {
+    freshness_->record_read(freshness_component_);
+  }
+  std::chrono::nanoseconds device_time, steady_time;
+  if (clock_domains_ && impl_->get_clock_sample(device_time, steady_time)) {
+    clock_domains_->add_sample(clock_domain_, device_time, steady_time);
+  }
+  return ret;
 }
 
 }  // namespace hardware_interface
@@ -0,0 +1,347 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hardware_interface/shared_memory_state_exporter.hpp"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace
+{
+constexpr auto kLoggerName = "shared memory state";
+/// The values start on the cache line following the header
+constexpr size_t kValuesOffset = hardware_interface::InterfaceValueArena::CACHE_LINE_SIZE;
+
+static_assert(
+  sizeof(hardware_interface::SharedMemoryStateHeader) <= kValuesOffset,
+  "the header has to fit in the first cache line of the segment");
+// Only lock-free atomics are address-free, and can thus be shared between processes
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "64 bit atomics have to be lock-free");
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(double), "values have to be 64 bit");
+
+uint64_t to_bits(double value)
+{
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+double from_bits(uint64_t bits)
+{
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+}  // namespace
+
+namespace hardware_interface
+{
+
+constexpr uint32_t SharedMemoryStateHeader::MAGIC;
+constexpr uint32_t SharedMemoryStateHeader::LAYOUT_VERSION;
+
+SharedMemoryStateExporter::~SharedMemoryStateExporter()
+{
+  close();
+}
+
+return_type SharedMemoryStateExporter::open(
+  const std::string & segment_name, RobotHardware & robot_hardware)
+{
+  close();
+  if (!robot_hardware.is_registration_frozen()) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger(kLoggerName),
+      "cannot export the state of '%s' before the registration is frozen", segment_name.c_str());
+    return return_type::ERROR;
+  }
+#ifdef __linux__
+  auto & actuator_arena = robot_hardware.get_actuator_values();
+  auto & joint_arena = robot_hardware.get_joint_values();
+  const auto actuator_names = robot_hardware.get_actuator_value_names();
+  const auto joint_names = robot_hardware.get_joint_value_names();
+  std::string names;
+  for (const auto & name : actuator_names) {
+    names.append(name).push_back('\0');
+  }
+  for (const auto & name : joint_names) {
+    names.append(name).push_back('\0');
+  }
+
+  const size_t value_count = actuator_names.size() + joint_names.size();
+  const size_t names_offset = kValuesOffset + value_count * sizeof(std::atomic<uint64_t>);
+  const size_t segment_size = names_offset + names.size();
+
+  // a segment left behind by a previous run would have a stale layout
+  shm_unlink(segment_name.c_str());
+  const int fd = shm_open(segment_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger(kLoggerName), "could not create shared memory segment '%s': %s",
+      segment_name.c_str(), std::strerror(errno));
+    return return_type::ERROR;
+  }
+  void * segment = MAP_FAILED;
+  if (ftruncate(fd, static_cast<off_t>(segment_size)) == 0) {
+    segment = mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  const int error = errno;
+  ::close(fd);
+  if (segment == MAP_FAILED) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger(kLoggerName), "could not map shared memory segment '%s': %s",
+      segment_name.c_str(), std::strerror(error));
+    shm_unlink(segment_name.c_str());
+    return return_type::ERROR;
+  }
+
+  segment_name_ = segment_name;
+  segment_ = segment;
+  segment_size_ = segment_size;
+  actuator_values_ = actuator_arena.data();
+  actuator_value_count_ = actuator_names.size();
+  joint_values_ = joint_arena.data();
+  joint_value_count_ = joint_names.size();
+
+  header_ = new (segment_) SharedMemoryStateHeader();
+  header_->layout_version = SharedMemoryStateHeader::LAYOUT_VERSION;
+  header_->sequence.store(0);
+  header_->actuator_value_count = actuator_value_count_;
+  header_->joint_value_count = joint_value_count_;
+  header_->names_offset = names_offset;
+  header_->names_size = names.size();
+  // touching every value now also avoids page faults in the first exports
+  values_ = reinterpret_cast<std::atomic<uint64_t> *>(
+    static_cast<char *>(segment_) + kValuesOffset);
+  for (size_t i = 0; i < value_count; ++i) {
+    new (&values_[i]) std::atomic<uint64_t>(to_bits(0.0));
+  }
+  std::memcpy(static_cast<char *>(segment_) + names_offset, names.data(), names.size());
+  // readers ignore the segment until the magic is set
+  std::atomic_thread_fence(std::memory_order_release);
+  header_->magic = SharedMemoryStateHeader::MAGIC;
+  return return_type::OK;
+#else
+  RCLCPP_ERROR(
+    rclcpp::get_logger(kLoggerName),
+    "exporting the state to shared memory is not supported on this platform");
+  return return_type::ERROR;
+#endif
+}
+
+void SharedMemoryStateExporter::close()
+{
+  if (segment_ == nullptr) {
+    return;
+  }
+#ifdef __linux__
+  munmap(segment_, segment_size_);
+  shm_unlink(segment_name_.c_str());
+#endif
+  segment_name_.clear();
+  segment_ = nullptr;
+  segment_size_ = 0;
+  header_ = nullptr;
+  values_ = nullptr;
+  actuator_values_ = nullptr;
+  actuator_value_count_ = 0;
+  joint_values_ = nullptr;
+  joint_value_count_ = 0;
+}
+
+bool SharedMemoryStateExporter::is_open() const
+{
+  return header_ != nullptr;
+}
+
+void SharedMemoryStateExporter::export_values()
+{
+  if (header_ == nullptr) {
+    return;
+  }
+  const auto sequence = header_->sequence.load(std::memory_order_relaxed);
+  header_->sequence.store(sequence + 1, std::memory_order_relaxed);
+  // the odd sequence has to be visible before any of the values
+  std::atomic_thread_fence(std::memory_order_release);
+  for (size_t i = 0; i < actuator_value_count_; ++i) {
+    values_[i].store(to_bits(actuator_values_[i]), std::memory_order_relaxed);
+  }
+  auto joint_values = values_ + actuator_value_count_;
+  for (size_t i = 0; i < joint_value_count_; ++i) {
+    joint_values[i].store(to_bits(joint_values_[i]), std::memory_order_relaxed);
+  }
+  header_->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+SharedMemoryStateReader::~SharedMemoryStateReader()
+{
+  close();
+}
+
+return_type SharedMemoryStateReader::open(const std::string & segment_name)
+{
+  close();
+#ifdef __linux__
+  const int fd = shm_open(segment_name.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger(kLoggerName), "could not open shared memory segment '%s': %s",
+      segment_name.c_str(), std::strerror(errno));
+    return return_type::ERROR;
+  }
+  struct stat segment_stat;
+  void * segment = MAP_FAILED;
+  size_t segment_size = 0;
+  if (fstat(fd, &segment_stat) == 0 &&
+    static_cast<size_t>(segment_stat.st_size) >= kValuesOffset)
+  {
+    segment_size = static_cast<size_t>(segment_stat.st_size);
+    segment = mmap(nullptr, segment_size, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  ::close(fd);
+  if (segment == MAP_FAILED) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger(kLoggerName), "could not map shared memory segment '%s'",
+      segment_name.c_str());
+    return return_type::ERROR;
+  }
+
+  const auto header = static_cast<const SharedMemoryStateHeader *>(segment);
+  const bool compatible = header->magic == SharedMemoryStateHeader::MAGIC &&
+    header->layout_version == SharedMemoryStateHeader::LAYOUT_VERSION;
+  std::atomic_thread_fence(std::memory_order_acquire);
+  const size_t value_count = compatible ?
+    header->actuator_value_count + header->joint_value_count : 0;
+  if (!compatible ||
+    header->names_offset != kValuesOffset + value_count * sizeof(std::atomic<uint64_t>) ||
+    header->names_offset + header->names_size > segment_size)
+  {
+    RCLCPP_ERROR(
+      rclcpp::get_logger(kLoggerName), "shared memory segment '%s' has an unknown layout",
+      segment_name.c_str());
+    munmap(segment, segment_size);
+    return return_type::ERROR;
+  }
+
+  std::vector<std::string> names;
+  const char * name = static_cast<const char *>(segment) + header->names_offset;
+  const char * names_end = name + header->names_size;
+  while (name < names_end && names.size() < value_count) {
+    const auto length = strnlen(name, static_cast<size_t>(names_end - name));
+    names.emplace_back(name, length);
+    name += length + 1;
+  }
+  if (names.size() != value_count) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger(kLoggerName), "shared memory segment '%s' misses value names",
+      segment_name.c_str());
+    munmap(segment, segment_size);
+    return return_type::ERROR;
+  }
+
+  segment_ = segment;
+  segment_size_ = segment_size;
+  header_ = header;
+  values_ = reinterpret_cast<const std::atomic<uint64_t> *>(
+    static_cast<const char *>(segment) + kValuesOffset);
+  const auto joint_names_begin = names.begin() + header->actuator_value_count;
+  actuator_value_names_.assign(names.begin(), joint_names_begin);
+  joint_value_names_.assign(joint_names_begin, names.end());
+  return return_type::OK;
+#else
+  RCLCPP_ERROR(
+    rclcpp::get_logger(kLoggerName),
+    "reading the state from shared memory is not supported on this platform, cannot open '%s'",
+    segment_name.c_str());
+  return return_type::ERROR;
+#endif
+}
+
+void SharedMemoryStateReader::close()
+{
+  if (segment_ == nullptr) {
+    return;
+  }
+#ifdef __linux__
+  munmap(segment_, segment_size_);
+#endif
+  segment_ = nullptr;
+  segment_size_ = 0;
+  header_ = nullptr;
+  values_ = nullptr;
+  actuator_value_names_.clear();
+  joint_value_names_.clear();
+}
+
+bool SharedMemoryStateReader::is_open() const
+{
+  return header_ != nullptr;
+}
+
+const std::vector<std::string> & SharedMemoryStateReader::get_actuator_value_names() const
+{
+  return actuator_value_names_;
+}
+
+const std::vector<std::string> & SharedMemoryStateReader::get_joint_value_names() const
+{
+  return joint_value_names_;
+}
+
+uint64_t SharedMemoryStateReader::read(
+  std::vector<double> & actuator_values, std::vector<double> & joint_values,
+  size_t max_attempts) const
+{
+  if (header_ == nullptr) {
+    return 0;
+  }
+  actuator_values.resize(actuator_value_names_.size());
+  joint_values.resize(joint_value_names_.size());
+  const auto joint_bits = values_ + actuator_values.size();
+  for (size_t attempt = 0; attempt < max_attempts; ++attempt) {
+    const auto sequence = header_->sequence.load(std::memory_order_acquire);
+    if (sequence % 2 != 0) {
+      std::this_thread::yield();
+      continue;
+    }
+    for (size_t i = 0; i < actuator_values.size(); ++i) {
+      actuator_values[i] = from_bits(values_[i].load(std::memory_order_relaxed));
+    }
+    for (size_t i = 0; i < joint_values.size(); ++i) {
+      joint_values[i] = from_bits(joint_bits[i].load(std::memory_order_relaxed));
+    }
+    // the copies have to complete before the sequence is checked again
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header_->sequence.load(std::memory_order_relaxed) == sequence) {
+      return sequence / 2;
+    }
+  }
+  return 0;
+}
+
+}  // namespace hardware_interface
@@ -0,0 +1,45 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hardware_interface/sync_event_source.hpp"
+
+#include <chrono>
+
+namespace hardware_interface
+{
+
+void SyncEventSource::notify(std::chrono::nanoseconds steady_time)
+{
+  latest_event_ns_.store(steady_time.count(), std::memory_order_release);
+  event_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SyncEventSource::notify()
+{
+  notify(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()));
+}
+
+std::chrono::nanoseconds SyncEventSource::get_latest_event() const
+{
+  return std::chrono::nanoseconds(latest_event_ns_.load(std::memory_order_acquire));
+}
+
+uint64_t SyncEventSource::get_event_count() const
+{
+  return event_count_.load(std::memory_order_relaxed);
+}
+
+}  // namespace hardware_interface
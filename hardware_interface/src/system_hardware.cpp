@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
 #include <string>
 #include <utility>
@@ -19,13 +21,16 @@
 
 #include "hardware_interface/system_hardware.hpp"
 
+#include "hardware_interface/clock_domain_map.hpp"
 #include "hardware_interface/components/component_info.hpp"
 #include "hardware_interface/components/joint.hpp"
 #include "hardware_interface/components/sensor.hpp"
+#include "hardware_interface/hardware_freshness.hpp"
 #include "hardware_interface/hardware_info.hpp"
 #include "hardware_interface/system_hardware_interface.hpp"
 #include "hardware_interface/types/hardware_interface_return_values.hpp"
 #include "hardware_interface/types/hardware_interface_status_values.hpp"
+#include "hardware_interface/types/hardware_interface_switch_state_values.hpp"
 #include "hardware_interface/visibility_control.h"
 
 namespace hardware_interface
@@ -52,23 +57,197 @@ return_type SystemHardware::stop()
 
 status SystemHardware::get_status() const
 {
-  return impl_->get_status();
+  const status current = impl_->get_status();
+  if (current == status::STARTED && freshness_ &&
+    !freshness_->is_fresh(HardwareFreshness::get_component_mask(freshness_component_)))
+  {
+    return status::TIMED_OUT;
+  }
+  return current;
+}
+
+void SystemHardware::set_freshness(
+  std::shared_ptr<HardwareFreshness> freshness, size_t component)
+{
+  freshness_ = std::move(freshness);
+  freshness_component_ = component;
+}
+
+void SystemHardware::set_clock_domain(
+  std::shared_ptr<ClockDomainMap> clock_domains, size_t domain)
+{
+  clock_domains_ = std::move(clock_domains);
+  clock_domain_ = domain;
 }
 
 return_type SystemHardware::read_sensors(std::vector<std::shared_ptr<components::Sensor>> & sensors)
 {
-  return impl_->read_sensors(sensors);
+  return_type ret = impl_->read_sensors(sensors);
+  if (ret == return_type::OK) {
+    ret = components::filter_sensor_states(sensors);
+  }
+  return record_read(ret);
 }
 
 return_type SystemHardware::read_joints(std::vector<std::shared_ptr<components::Joint>> & joints)
 {
-  return impl_->read_joints(joints);
+  if (!impl_->supports_joint_batches()) {
+    return record_read(impl_->read_joints(joints));
+  }
+  if (!is_bound_to(joints)) {
+    bind_joint_batches(joints);
+  }
+  if (!joints_batchable_) {
+    return record_read(impl_->read_joints(joints));
+  }
+
+  return_type ret = impl_->read_joint_batch(state_batch_);
+  if (ret != return_type::OK) {
+    return ret;
+  }
+  const size_t interface_count = state_batch_.get_interfaces().size();
+  for (size_t j = 0; j < joints.size(); ++j) {
+    for (size_t i = 0; i < interface_count; ++i) {
+      joint_values_[i] = state_batch_.get_values(i)[j];
+    }
+    ret = joints[j]->set_state(
+      Span<const double>(joint_values_.data(), interface_count), state_selector_);
+    if (ret != return_type::OK) {
+      break;
+    }
+    joints[j]->set_state_stamp(state_batch_.get_stamp());
+  }
+  return record_read(ret);
 }
 
 return_type SystemHardware::write_joints(
   const std::vector<std::shared_ptr<components::Joint>> & joints)
 {
-  return impl_->write_joints(joints);
+  if (!impl_->supports_joint_batches()) {
+    return impl_->write_joints(joints);
+  }
+  if (!is_bound_to(joints)) {
+    bind_joint_batches(joints);
+  }
+  if (!joints_batchable_) {
+    return impl_->write_joints(joints);
+  }
+
+  const size_t interface_count = command_batch_.get_interfaces().size();
+  for (size_t j = 0; j < joints.size(); ++j) {
+    const return_type ret = joints[j]->get_command(
+      Span<double>(joint_values_.data(), interface_count), command_selector_);
+    if (ret != return_type::OK) {
+      return ret;
+    }
+    for (size_t i = 0; i < interface_count; ++i) {
+      command_batch_.get_values(i)[j] = joint_values_[i];
+    }
+  }
+  return impl_->write_joint_batch(command_batch_);
+}
+
+bool SystemHardware::supports_joint_batches() const
+{
+  return impl_->supports_joint_batches();
+}
+
+return_type SystemHardware::read_joint_batch(components::JointValuesBatch & states)
+{
+  return record_read(impl_->read_joint_batch(states));
+}
+
+return_type SystemHardware::write_joint_batch(const components::JointValuesBatch & commands)
+{
+  return impl_->write_joint_batch(commands);
+}
+
+bool SystemHardware::is_bound_to(
+  const std::vector<std::shared_ptr<components::Joint>> & joints) const
+{
+  if (joints.size() != batched_joints_.size()) {
+    return false;
+  }
+  for (size_t j = 0; j < joints.size(); ++j) {
+    if (joints[j].get() != batched_joints_[j]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void SystemHardware::bind_joint_batches(
+  const std::vector<std::shared_ptr<components::Joint>> & joints)
+{
+  batched_joints_.clear();
+  for (const auto & joint : joints) {
+    batched_joints_.push_back(joint.get());
+  }
+
+  joints_batchable_ = false;
+  if (joints.empty()) {
+    return;
+  }
+  const auto state_interfaces = joints.front()->get_state_interfaces();
+  const auto command_interfaces = joints.front()->get_command_interfaces();
+  for (const auto & joint : joints) {
+    if (joint->get_state_interfaces() != state_interfaces ||
+      joint->get_command_interfaces() != command_interfaces)
+    {
+      return;
+    }
+  }
+  if (joints.front()->get_state_interface_selector(state_selector_, state_interfaces) !=
+    return_type::OK ||
+    joints.front()->get_command_interface_selector(command_selector_, command_interfaces) !=
+    return_type::OK)
+  {
+    return;
+  }
+
+  state_batch_ = components::JointValuesBatch(joints.size(), state_interfaces);
+  command_batch_ = components::JointValuesBatch(joints.size(), command_interfaces);
+  joint_values_.resize(std::max(state_interfaces.size(), command_interfaces.size()));
+  joints_batchable_ = true;
+}
+
+return_type SystemHardware::prepare_mode_switch(
+  const std::vector<ControllerInfo> & start_list,
+  const std::vector<ControllerInfo> & stop_list)
+{
+  return impl_->prepare_mode_switch(start_list, stop_list);
+}
+
+return_type SystemHardware::perform_mode_switch(
+  const std::vector<ControllerInfo> & start_list,
+  const std::vector<ControllerInfo> & stop_list)
+{
+  return impl_->perform_mode_switch(start_list, stop_list);
+}
+
+switch_state SystemHardware::get_mode_switch_state() const
+{
+  return impl_->get_mode_switch_state();
+}
+
+switch_state SystemHardware::get_mode_switch_state(const ControllerInfo & controller) const
+{
+  return impl_->get_mode_switch_state(controller);
+}
+
+return_type SystemHardware::record_read(return_type ret)
+{
+  if (ret != return_type::OK) {
+    return ret;
+  }
+  if (freshness_) {
+    freshness_->record_read(freshness_component_);
+  }
+  std::chrono::nanoseconds device_time, steady_time;
+  if (clock_domains_ && impl_->get_clock_sample(device_time, steady_time)) {
+    clock_domains_->add_sample(clock_domain_, device_time, steady_time);
+  }
+  return ret;
 }
 
 }  // namespace hardware_interface
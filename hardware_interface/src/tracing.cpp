@@ -0,0 +1,79 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hardware_interface/tracing.hpp"
+
+#include <atomic>
+#include <chrono>
+
+#ifdef HARDWARE_INTERFACE_LTTNG_TRACING
+#define TRACEPOINT_CREATE_PROBES
+#define TRACEPOINT_DEFINE
+#include "hardware_interface/tracing_provider.h"
+#endif
+
+namespace
+{
+std::atomic<hardware_interface::TraceSink *> trace_sink{nullptr};
+
+int64_t now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}  // namespace
+
+namespace hardware_interface
+{
+namespace detail
+{
+#ifdef HARDWARE_INTERFACE_LTTNG_TRACING
+// the tracepoints check themselves whether they are enabled in a tracing session
+std::atomic<bool> tracing_enabled{true};
+#else
+std::atomic<bool> tracing_enabled{false};
+#endif
+
+void trace_begin(const char * phase, const char * detail)
+{
+#ifdef HARDWARE_INTERFACE_LTTNG_TRACING
+  tracepoint(ros2_control, phase_begin, phase, detail);
+#endif
+  auto sink = trace_sink.load(std::memory_order_acquire);
+  if (sink) {
+    sink->on_begin(phase, detail, now_ns());
+  }
+}
+
+void trace_end(const char * phase, const char * detail)
+{
+#ifdef HARDWARE_INTERFACE_LTTNG_TRACING
+  tracepoint(ros2_control, phase_end, phase, detail);
+#endif
+  auto sink = trace_sink.load(std::memory_order_acquire);
+  if (sink) {
+    sink->on_end(phase, detail, now_ns());
+  }
+}
+}  // namespace detail
+
+void set_trace_sink(TraceSink * sink)
+{
+  trace_sink.store(sink, std::memory_order_release);
+#ifndef HARDWARE_INTERFACE_LTTNG_TRACING
+  detail::tracing_enabled.store(sink != nullptr, std::memory_order_relaxed);
+#endif
+}
+
+}  // namespace hardware_interface
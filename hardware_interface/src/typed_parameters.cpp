@@ -0,0 +1,159 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hardware_interface/typed_parameters.hpp"
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+bool parse_value(const std::string & text, double & value)
+{
+  if (text.empty() || std::isspace(static_cast<unsigned char>(text.front()))) {
+    return false;
+  }
+  char * end = nullptr;
+  errno = 0;
+  value = std::strtod(text.c_str(), &end);
+  return errno == 0 && end == text.c_str() + text.size();
+}
+
+bool parse_value(const std::string & text, int64_t & value)
+{
+  if (text.empty() || std::isspace(static_cast<unsigned char>(text.front()))) {
+    return false;
+  }
+  char * end = nullptr;
+  errno = 0;
+  value = std::strtoll(text.c_str(), &end, 0);
+  return errno == 0 && end == text.c_str() + text.size();
+}
+
+bool parse_value(const std::string & text, bool & value)
+{
+  if (text == "true" || text == "True" || text == "1") {
+    value = true;
+    return true;
+  }
+  if (text == "false" || text == "False" || text == "0") {
+    value = false;
+    return true;
+  }
+  return false;
+}
+
+bool parse_value(const std::string & text, std::string & value)
+{
+  value = text;
+  return true;
+}
+
+/// Arrays are separated by commas or spaces, optionally in brackets, e.g. "[0.1, 0.2]"
+template<typename T>
+bool parse_value(const std::string & text, std::vector<T> & values)
+{
+  size_t begin = text.find_first_not_of(" \t\n");
+  size_t end = text.find_last_not_of(" \t\n");
+  values.clear();
+  if (begin == std::string::npos) {
+    return true;
+  }
+  if (text[begin] == '[') {
+    if (text[end] != ']') {
+      return false;
+    }
+    ++begin;
+  } else {
+    ++end;
+  }
+  const std::string elements = text.substr(begin, end - begin);
+  size_t position = 0;
+  while ((position = elements.find_first_not_of(" ,\t\n", position)) != std::string::npos) {
+    const size_t next = elements.find_first_of(" ,\t\n", position);
+    T value;
+    if (!parse_value(elements.substr(position, next - position), value)) {
+      return false;
+    }
+    values.push_back(value);
+    position = next;
+  }
+  return true;
+}
+
+template<typename T>
+void parse_parameter(
+  const hardware_interface::ParameterDescriptor & descriptor, const std::string & text,
+  const std::string & kind, const std::string & owner_name,
+  hardware_interface::TypedParameters & typed)
+{
+  T value;
+  if (!parse_value(text, value)) {
+    throw std::runtime_error(
+            "invalid " + kind + " '" + text + "' of parameter " + descriptor.name + " in " +
+            owner_name);
+  }
+  typed.set(hardware_interface::ParameterKey<T>{descriptor.index}, value);
+}
+}  // namespace
+
+namespace hardware_interface
+{
+
+TypedParameters ParameterSchema::parse(
+  const std::unordered_map<std::string, std::string> & parameters,
+  const std::string & owner_name) const
+{
+  TypedParameters typed = defaults_;
+  for (const auto & descriptor : descriptors_) {
+    const auto parameter = parameters.find(descriptor.name);
+    if (parameter == parameters.end()) {
+      if (descriptor.required) {
+        throw std::runtime_error(
+                "required parameter " + descriptor.name + " not set in " + owner_name);
+      }
+      continue;
+    }
+    const auto & text = parameter->second;
+    switch (descriptor.type) {
+      case ParameterType::DOUBLE:
+        parse_parameter<double>(descriptor, text, "double", owner_name, typed);
+        break;
+      case ParameterType::INTEGER:
+        parse_parameter<int64_t>(descriptor, text, "integer", owner_name, typed);
+        break;
+      case ParameterType::BOOL:
+        parse_parameter<bool>(descriptor, text, "bool", owner_name, typed);
+        break;
+      case ParameterType::STRING:
+        parse_parameter<std::string>(descriptor, text, "string", owner_name, typed);
+        break;
+      case ParameterType::DOUBLE_ARRAY:
+        parse_parameter<std::vector<double>>(descriptor, text, "double array", owner_name, typed);
+        break;
+      case ParameterType::INTEGER_ARRAY:
+        parse_parameter<std::vector<int64_t>>(
+          descriptor, text, "integer array", owner_name, typed);
+        break;
+    }
+  }
+  return typed;
+}
+
+}  // namespace hardware_interface
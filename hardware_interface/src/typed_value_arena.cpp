@@ -0,0 +1,161 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hardware_interface/typed_value_arena.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "hardware_interface/interface_value_arena.hpp"
+
+namespace
+{
+constexpr size_t kCacheLineSize = hardware_interface::InterfaceValueArena::CACHE_LINE_SIZE;
+
+size_t round_up_to_cache_line(size_t size)
+{
+  return (size + kCacheLineSize - 1) / kCacheLineSize * kCacheLineSize;
+}
+
+size_t get_value_size(hardware_interface::InterfaceValueType type)
+{
+  switch (type) {
+    case hardware_interface::InterfaceValueType::FLOAT32:
+      return sizeof(float);
+    case hardware_interface::InterfaceValueType::INT32:
+      return sizeof(int32_t);
+    case hardware_interface::InterfaceValueType::UINT16:
+      return sizeof(uint16_t);
+    case hardware_interface::InterfaceValueType::BOOL:
+      return sizeof(bool);
+  }
+  return 0;
+}
+}  // namespace
+
+namespace hardware_interface
+{
+
+bool TypedValueArena::add(
+  const std::string & handle_name, const std::string & interface_name, InterfaceValueType type,
+  uint32_t default_bits)
+{
+  if (is_frozen()) {
+    return false;
+  }
+  if (!index_.emplace(std::make_pair(handle_name, interface_name), values_.size()).second) {
+    return false;
+  }
+  values_.push_back(
+    {type, InterfaceValueArena::is_command_interface(interface_name), default_bits, 0});
+  return true;
+}
+
+bool TypedValueArena::get_value_type(
+  const std::string & handle_name, const std::string & interface_name,
+  InterfaceValueType & type) const
+{
+  const auto it = index_.find(std::make_pair(handle_name, interface_name));
+  if (it == index_.end()) {
+    return false;
+  }
+  type = values_[it->second].type;
+  return true;
+}
+
+size_t TypedValueArena::get_value_count() const
+{
+  return values_.size();
+}
+
+void TypedValueArena::freeze(RealtimeMemoryPool * pool)
+{
+  if (is_frozen()) {
+    throw std::runtime_error("typed value arena is already frozen");
+  }
+
+  // count the values of each type in each region to lay out the blocks
+  state_blocks_ = Blocks();
+  command_blocks_ = Blocks();
+  for (const auto & value : values_) {
+    auto & blocks = value.command ? command_blocks_ : state_blocks_;
+    ++blocks[static_cast<size_t>(value.type)].count;
+  }
+  const auto lay_out = [](Blocks & blocks) {
+      size_t size = 0;
+      for (size_t type = 0; type < INTERFACE_VALUE_TYPE_COUNT; ++type) {
+        blocks[type].begin = size;
+        size += round_up_to_cache_line(
+          blocks[type].count * get_value_size(static_cast<InterfaceValueType>(type)));
+      }
+      return size;
+    };
+  command_begin_ = lay_out(state_blocks_);
+  command_size_ = lay_out(command_blocks_);
+  published_command_begin_ = command_begin_ + command_size_;
+
+  storage_ = std::vector<uint8_t, PoolAllocator<uint8_t>>(
+    published_command_begin_ + command_size_ + kCacheLineSize, 0u, PoolAllocator<uint8_t>(pool));
+  const auto address = reinterpret_cast<std::uintptr_t>(storage_.data());
+  const auto misalignment = address % kCacheLineSize;
+  begin_ = storage_.data() + (misalignment ? kCacheLineSize - misalignment : 0u);
+
+  std::array<size_t, INTERFACE_VALUE_TYPE_COUNT> next_state{};
+  std::array<size_t, INTERFACE_VALUE_TYPE_COUNT> next_command{};
+  for (auto & value : values_) {
+    const auto type = static_cast<size_t>(value.type);
+    const auto size = get_value_size(value.type);
+    value.offset = value.command ?
+      command_begin_ + command_blocks_[type].begin + next_command[type]++ * size :
+      state_blocks_[type].begin + next_state[type]++ * size;
+    std::memcpy(begin_ + value.offset, &value.default_bits, size);
+  }
+  publish_commands();
+}
+
+bool TypedValueArena::is_frozen() const
+{
+  return begin_ != nullptr;
+}
+
+void * TypedValueArena::find_value(
+  const std::string & handle_name, const std::string & interface_name, InterfaceValueType type,
+  bool published)
+{
+  if (!is_frozen()) {
+    return nullptr;
+  }
+  const auto it = index_.find(std::make_pair(handle_name, interface_name));
+  if (it == index_.end() || values_[it->second].type != type) {
+    return nullptr;
+  }
+  const auto & value = values_[it->second];
+  if (published && value.command) {
+    return begin_ + published_command_begin_ + (value.offset - command_begin_);
+  }
+  return begin_ + value.offset;
+}
+
+void TypedValueArena::publish_commands()
+{
+  if (begin_) {
+    std::memcpy(begin_ + published_command_begin_, begin_ + command_begin_, command_size_);
+  }
+}
+
+}  // namespace hardware_interface
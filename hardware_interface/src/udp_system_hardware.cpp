@@ -0,0 +1,311 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hardware_interface/udp_system_hardware.hpp"
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace
+{
+constexpr auto kLoggerName = "udp system hardware";
+constexpr auto kDefaultReceiveTimeout = std::chrono::milliseconds(100);
+/// State packets received per cycle at most, the older ones are superseded by the latest
+constexpr size_t kMaxPacketsPerCycle = 8;
+
+int64_t now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::string get_parameter(
+  const hardware_interface::HardwareInfo & info, const std::string & name,
+  const std::string & default_value)
+{
+  const auto param = info.hardware_parameters.find(name);
+  return param == info.hardware_parameters.end() ? default_value : param->second;
+}
+
+bool parse_port(const std::string & value, uint16_t & port)
+{
+  try {
+    size_t end = 0;
+    const int parsed = std::stoi(value, &end);
+    if (end != value.size() || parsed < 0 || parsed > 65535) {
+      return false;
+    }
+    port = static_cast<uint16_t>(parsed);
+    return true;
+  } catch (const std::exception &) {
+    return false;
+  }
+}
+
+#ifdef __linux__
+bool make_address(const std::string & address, uint16_t port, sockaddr_in & socket_address)
+{
+  std::memset(&socket_address, 0, sizeof(socket_address));
+  socket_address.sin_family = AF_INET;
+  socket_address.sin_port = htons(port);
+  return inet_pton(AF_INET, address.c_str(), &socket_address.sin_addr) == 1;
+}
+#endif
+}  // namespace
+
+namespace hardware_interface
+{
+
+UdpSystemHardware::UdpSystemHardware()
+: receive_timeout_(kDefaultReceiveTimeout), frame_io_(std::make_unique<BatchedFrameIo>())
+{}
+
+UdpSystemHardware::~UdpSystemHardware()
+{
+  close_socket();
+}
+
+return_type UdpSystemHardware::configure(const HardwareInfo & system_info)
+{
+  if (status_ == status::STARTED) {
+    RCLCPP_ERROR(rclcpp::get_logger(kLoggerName), "cannot configure while started");
+    return return_type::ERROR;
+  }
+
+  remote_address_ = get_parameter(system_info, "remote_address", "");
+  local_address_ = get_parameter(system_info, "local_address", "0.0.0.0");
+  if (remote_address_.empty() ||
+    !parse_port(get_parameter(system_info, "remote_port", ""), remote_port_) ||
+    !parse_port(get_parameter(system_info, "local_port", "0"), local_port_))
+  {
+    RCLCPP_ERROR(
+      rclcpp::get_logger(kLoggerName), "'%s' has no valid remote address and ports",
+      system_info.name.c_str());
+    return return_type::ERROR;
+  }
+  try {
+    const double timeout_ms = std::stod(
+      get_parameter(
+        system_info, "receive_timeout_ms", std::to_string(kDefaultReceiveTimeout.count())));
+    if (!(timeout_ms > 0.0)) {
+      throw std::invalid_argument("not positive");
+    }
+    receive_timeout_ = std::chrono::nanoseconds(static_cast<int64_t>(timeout_ms * 1e6));
+  } catch (const std::exception &) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger(kLoggerName), "'%s' has an invalid receive_timeout_ms",
+      system_info.name.c_str());
+    return return_type::ERROR;
+  }
+  use_io_uring_ = get_parameter(system_info, "use_io_uring", "true") != "false";
+
+  state_layout_ = PacketLayout();
+  command_layout_ = PacketLayout();
+  if (configure_layouts(system_info, state_layout_, command_layout_) != return_type::OK) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger(kLoggerName), "could not register the packet layouts of '%s'",
+      system_info.name.c_str());
+    return return_type::ERROR;
+  }
+  status_ = status::CONFIGURED;
+  return return_type::OK;
+}
+
+return_type UdpSystemHardware::start()
+{
+  if (status_ != status::CONFIGURED && status_ != status::STOPPED) {
+    return return_type::ERROR;
+  }
+#ifdef __linux__
+  sockaddr_in local, remote;
+  if (!make_address(local_address_, local_port_, local) ||
+    !make_address(remote_address_, remote_port_, remote))
+  {
+    RCLCPP_ERROR(rclcpp::get_logger(kLoggerName), "invalid IPv4 address");
+    return return_type::ERROR;
+  }
+  socket_ = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  // connected, for the packets to be sent and received without any address
+  if (socket_ < 0 ||
+    bind(socket_, reinterpret_cast<const sockaddr *>(&local), sizeof(local)) != 0 ||
+    connect(socket_, reinterpret_cast<const sockaddr *>(&remote), sizeof(remote)) != 0)
+  {
+    RCLCPP_ERROR(
+      rclcpp::get_logger(kLoggerName), "could not open the socket: %s", std::strerror(errno));
+    close_socket();
+    return return_type::ERROR;
+  }
+
+  BatchedFrameIoOptions options;
+  options.max_frames = kMaxPacketsPerCycle;
+  options.max_frame_size =
+    std::max<size_t>(
+    std::max(state_layout_.get_packet_size(), command_layout_.get_packet_size()), 1);
+  options.use_io_uring = use_io_uring_;
+  frame_io_ = std::make_unique<BatchedFrameIo>(options);
+  if (frame_io_->open(socket_, FrameIoMode::DATAGRAM) != return_type::OK) {
+    close_socket();
+    return return_type::ERROR;
+  }
+  state_stamp_ns_ = now_ns();
+  status_ = status::STARTED;
+  return return_type::OK;
+#else
+  RCLCPP_ERROR(rclcpp::get_logger(kLoggerName), "only supported on Linux");
+  return return_type::ERROR;
+#endif
+}
+
+return_type UdpSystemHardware::stop()
+{
+  close_socket();
+  status_ = status::STOPPED;
+  return return_type::OK;
+}
+
+status UdpSystemHardware::get_status() const
+{
+  if (status_ == status::STARTED && is_state_stale()) {
+    return status::TIMED_OUT;
+  }
+  return status_;
+}
+
+return_type UdpSystemHardware::read_sensors(
+  std::vector<std::shared_ptr<components::Sensor>> & sensors) const
+{
+  (void) sensors;
+  return return_type::OK;
+}
+
+return_type UdpSystemHardware::read_joints(
+  std::vector<std::shared_ptr<components::Joint>> & joints) const
+{
+  (void) joints;
+  return return_type::ERROR;
+}
+
+return_type UdpSystemHardware::write_joints(
+  const std::vector<std::shared_ptr<components::Joint>> & joints)
+{
+  (void) joints;
+  return return_type::ERROR;
+}
+
+bool UdpSystemHardware::supports_joint_batches() const
+{
+  return true;
+}
+
+return_type UdpSystemHardware::read_joint_batch(components::JointValuesBatch & states) const
+{
+  if (status_ != status::STARTED) {
+    return return_type::ERROR;
+  }
+  if (!state_layout_.is_bound_to(states) && state_layout_.bind(states) != return_type::OK) {
+    return return_type::ERROR;
+  }
+  if (frame_io_->reap() != return_type::OK) {
+    return return_type::ERROR;
+  }
+  // the latest accepted packet supersedes the ones received before it
+  const size_t packet_size = state_layout_.get_packet_size();
+  for (size_t i = frame_io_->get_received_count(); i-- > 0; ) {
+    const auto packet = frame_io_->get_received_frame(i);
+    if (packet.size() < packet_size || !accept_state_packet(packet)) {
+      ++rejected_packet_count_;
+      continue;
+    }
+    state_layout_.decode(packet, states);
+    state_stamp_ns_ = now_ns();
+    break;
+  }
+  return is_state_stale() ? return_type::ERROR : return_type::OK;
+}
+
+return_type UdpSystemHardware::write_joint_batch(const components::JointValuesBatch & commands)
+{
+  if (status_ != status::STARTED) {
+    return return_type::ERROR;
+  }
+  if (!command_layout_.is_bound_to(commands) && command_layout_.bind(commands) != return_type::OK) {
+    return return_type::ERROR;
+  }
+  // encoded in place, in the send buffer
+  const auto packet = frame_io_->reserve_frame(command_layout_.get_packet_size());
+  if (packet.data() == nullptr) {
+    return return_type::ERROR;
+  }
+  command_layout_.encode(commands, packet);
+  finish_command_packet(packet);
+  // also puts the reads of the reaped state packets back in flight
+  return frame_io_->submit();
+}
+
+uint16_t UdpSystemHardware::get_local_port() const
+{
+#ifdef __linux__
+  sockaddr_in local;
+  socklen_t size = sizeof(local);
+  if (socket_ >= 0 &&
+    getsockname(socket_, reinterpret_cast<sockaddr *>(&local), &size) == 0)
+  {
+    return ntohs(local.sin_port);
+  }
+#endif
+  return 0;
+}
+
+const BatchedFrameIo & UdpSystemHardware::get_frame_io() const
+{
+  return *frame_io_;
+}
+
+uint64_t UdpSystemHardware::get_rejected_packet_count() const
+{
+  return rejected_packet_count_;
+}
+
+void UdpSystemHardware::close_socket()
+{
+  frame_io_->close();
+#ifdef __linux__
+  if (socket_ >= 0) {
+    ::close(socket_);
+  }
+#endif
+  socket_ = -1;
+}
+
+bool UdpSystemHardware::is_state_stale() const
+{
+  return now_ns() - state_stamp_ns_ > receive_timeout_.count();
+}
+
+}  // namespace hardware_interface
@@ -0,0 +1,307 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <tinyxml2.h>
+#include <cctype>
+#include <cstring>
+#include <istream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "hardware_interface/urdf_document.hpp"
+
+namespace
+{
+constexpr const auto kROS2ControlTag = "ros2_control";
+constexpr const auto kTransmissionTag = "transmission";
+constexpr const auto kJointTag = "joint";
+constexpr const auto kInvalidURDF = "invalid URDF passed to parser";
+
+/// A read-only stream buffer over a string, to scan the string without copying it
+class StringStreamBuffer : public std::streambuf
+{
+public:
+  explicit StringStreamBuffer(const std::string & string)
+  {
+    auto * begin = const_cast<char *>(string.data());
+    setg(begin, begin, begin + string.size());
+  }
+};
+
+/// Reads a description one character at a time, and appends them to a capture if any
+class Reader
+{
+public:
+  explicit Reader(std::streambuf & buffer)
+  : buffer_(buffer)
+  {
+  }
+
+  bool at_end()
+  {
+    return buffer_.sgetc() == std::char_traits<char>::eof();
+  }
+
+  char peek()
+  {
+    const auto c = buffer_.sgetc();
+    if (c == std::char_traits<char>::eof()) {
+      throw std::runtime_error(kInvalidURDF);
+    }
+    return std::char_traits<char>::to_char_type(c);
+  }
+
+  char next()
+  {
+    const char c = peek();
+    buffer_.sbumpc();
+    if (capture_) {
+      capture_->push_back(c);
+    }
+    return c;
+  }
+
+  void set_capture(std::string * capture)
+  {
+    capture_ = capture;
+  }
+
+  /// Skip up to and including a terminator, e.g. the "-->" of a comment
+  void skip_past(const char * terminator)
+  {
+    const size_t length = std::strlen(terminator);
+    std::string window;
+    while (window.size() < length || window.compare(0, length, terminator)) {
+      window.push_back(next());
+      if (window.size() > length) {
+        window.erase(0, 1);
+      }
+    }
+  }
+
+  /// Skip the rest of a tag up to its '>', not the ones in its quoted attribute values
+  /**
+   * \param tag the skipped characters are appended to it if not null
+   * \return whether the tag closes its element, as in <joint/>
+   */
+  bool skip_tag(std::string * tag)
+  {
+    char quote = 0;
+    char previous = 0;
+    while (true) {
+      const char c = next();
+      if (tag) {
+        tag->push_back(c);
+      }
+      if (quote) {
+        quote = c == quote ? 0 : quote;
+      } else if (c == '"' || c == '\'') {
+        quote = c;
+      } else if (c == '>') {
+        return previous == '/';
+      }
+      previous = c;
+    }
+  }
+
+private:
+  std::streambuf & buffer_;
+  std::string * capture_ = nullptr;
+};
+
+bool is_relevant_element(const std::string & name)
+{
+  return name == kROS2ControlTag || name == kTransmissionTag || name == kJointTag;
+}
+
+bool is_name_end(char c)
+{
+  return c == '>' || c == '/' || std::isspace(static_cast<unsigned char>(c));
+}
+
+/// Scan a description down to its root element and the relevant children of the root
+/**
+ * Only the tags of the root and of its children are held while scanning, the deeper subtrees
+ * which are not relevant are skipped without being stored.
+ * \return the XML of the root element with its relevant children only
+ */
+std::string scan_relevant_elements(std::streambuf & buffer)
+{
+  Reader reader(buffer);
+  if (reader.at_end()) {
+    throw std::runtime_error("empty URDF passed to parser");
+  }
+
+  std::string xml;
+  std::string root_name;
+  size_t depth = 0;
+  bool capturing = false;
+  while (true) {
+    if (reader.at_end()) {
+      throw std::runtime_error(root_name.empty() ? "no root element in URDF" : kInvalidURDF);
+    }
+    if (reader.next() != '<') {
+      continue;
+    }
+
+    const char c = reader.next();
+    if (c == '!') {
+      const char kind = reader.next();
+      if (kind == '-') {
+        reader.skip_past("-->");
+      } else if (kind == '[') {
+        reader.skip_past("]]>");
+      } else {
+        reader.skip_tag(nullptr);
+      }
+      continue;
+    }
+    if (c == '?') {
+      reader.skip_past("?>");
+      continue;
+    }
+    if (c == '/') {
+      reader.skip_tag(nullptr);
+      if (depth == 0) {
+        throw std::runtime_error(kInvalidURDF);
+      }
+      --depth;
+      if (depth == 1 && capturing) {
+        reader.set_capture(nullptr);
+        capturing = false;
+      } else if (depth == 0) {
+        return xml + "</" + root_name + ">";
+      }
+      continue;
+    }
+
+    std::string name(1, c);
+    while (!is_name_end(reader.peek())) {
+      name.push_back(reader.next());
+    }
+    if (capturing || depth > 1) {
+      depth += reader.skip_tag(nullptr) ? 0 : 1;
+      continue;
+    }
+    std::string tag = "<" + name;
+    const bool closed = reader.skip_tag(&tag);
+    if (depth == 0) {
+      root_name = name;
+      xml = tag;
+      if (closed) {
+        return xml;
+      }
+    } else if (is_relevant_element(name)) {
+      xml += tag;
+      if (!closed) {
+        reader.set_capture(&xml);
+        capturing = true;
+      }
+    }
+    depth += closed ? 0 : 1;
+  }
+}
+}  // namespace
+
+namespace hardware_interface
+{
+
+URDFDocument::URDFDocument(const std::string & urdf, ScanMode mode)
+: document_(new tinyxml2::XMLDocument())
+{
+  if (urdf.empty()) {
+    throw std::runtime_error("empty URDF passed to parser");
+  }
+  if (mode == ScanMode::RELEVANT_ELEMENTS) {
+    StringStreamBuffer buffer(urdf);
+    scan(buffer);
+  } else {
+    parse(urdf);
+  }
+}
+
+URDFDocument::URDFDocument(std::istream & urdf)
+: document_(new tinyxml2::XMLDocument())
+{
+  if (!urdf.rdbuf()) {
+    throw std::runtime_error("empty URDF passed to parser");
+  }
+  scan(*urdf.rdbuf());
+}
+
+void URDFDocument::scan(std::streambuf & urdf)
+{
+  parse(scan_relevant_elements(urdf));
+}
+
+void URDFDocument::parse(const std::string & xml)
+{
+  if (document_->Parse(xml.c_str(), xml.size()) != tinyxml2::XML_SUCCESS) {
+    throw std::runtime_error(kInvalidURDF);
+  }
+  const auto * root_it = document_->RootElement();
+  if (!root_it) {
+    throw std::runtime_error("no root element in URDF");
+  }
+
+  // Index the elements read by the parsers in a single pass over the children of the root
+  for (const auto * child_it = root_it->FirstChildElement(); child_it;
+    child_it = child_it->NextSiblingElement())
+  {
+    const char * name = child_it->Name();
+    if (!std::strcmp(name, kROS2ControlTag)) {
+      ros2_control_elements_.push_back(child_it);
+    } else if (!std::strcmp(name, kTransmissionTag)) {
+      transmission_elements_.push_back(child_it);
+    } else if (!std::strcmp(name, kJointTag)) {
+      joint_elements_.push_back(child_it);
+      const char * joint_name = child_it->Attribute("name");
+      if (joint_name) {
+        joint_elements_by_name_.emplace(joint_name, child_it);
+      }
+    }
+  }
+}
+
+URDFDocument::~URDFDocument() = default;
+
+const tinyxml2::XMLElement * URDFDocument::get_root_element() const
+{
+  return document_->RootElement();
+}
+
+const std::vector<const tinyxml2::XMLElement *> & URDFDocument::get_ros2_control_elements() const
+{
+  return ros2_control_elements_;
+}
+
+const std::vector<const tinyxml2::XMLElement *> & URDFDocument::get_transmission_elements() const
+{
+  return transmission_elements_;
+}
+
+const std::vector<const tinyxml2::XMLElement *> & URDFDocument::get_joint_elements() const
+{
+  return joint_elements_;
+}
+
+const tinyxml2::XMLElement * URDFDocument::find_joint_element(const std::string & name) const
+{
+  const auto it = joint_elements_by_name_.find(name);
+  return it == joint_elements_by_name_.end() ? nullptr : it->second;
+}
+
+}  // namespace hardware_interface
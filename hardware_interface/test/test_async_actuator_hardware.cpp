@@ -0,0 +1,202 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "hardware_interface/async_actuator_hardware.hpp"
+#include "hardware_interface/components/joint.hpp"
+
+using hardware_interface::ActuatorHardwareInterface;
+using hardware_interface::AsyncActuatorHardware;
+using hardware_interface::HardwareInfo;
+using hardware_interface::return_type;
+using hardware_interface::status;
+using hardware_interface::components::Joint;
+
+namespace
+{
+/// Echoes the position command into the position state, the way a slow serial bus would.
+class SlowDriver : public ActuatorHardwareInterface
+{
+public:
+  SlowDriver(std::chrono::milliseconds transaction_time, std::atomic<bool> & failing)
+  : transaction_time_(transaction_time), failing_(failing)
+  {
+  }
+
+  return_type configure(const HardwareInfo & actuator_info) override
+  {
+    (void) actuator_info;
+    return return_type::OK;
+  }
+
+  return_type start() override
+  {
+    return return_type::OK;
+  }
+
+  return_type stop() override
+  {
+    return return_type::OK;
+  }
+
+  status get_status() const override
+  {
+    return status::UNKNOWN;
+  }
+
+  return_type read_joint(std::shared_ptr<Joint> joint) const override
+  {
+    std::this_thread::sleep_for(transaction_time_);
+    if (failing_) {
+      return return_type::ERROR;
+    }
+    return joint->set_state({position_, position_ * 2.0});
+  }
+
+  return_type write_joint(const std::shared_ptr<Joint> joint) override
+  {
+    std::this_thread::sleep_for(transaction_time_);
+    std::vector<double> command;
+    joint->get_command(command);
+    position_ = command[0];
+    return failing_ ? return_type::ERROR : return_type::OK;
+  }
+
+private:
+  std::chrono::milliseconds transaction_time_;
+  std::atomic<bool> & failing_;
+  std::atomic<double> position_{0.0};
+};
+}  // namespace
+
+class TestAsyncActuatorHardware : public testing::Test
+{
+public:
+  TestAsyncActuatorHardware()
+  {
+    actuator_info.name = "gripper";
+    hardware_interface::components::ComponentInfo joint_info;
+    joint_info.name = "finger";
+    joint_info.command_interfaces = {"position"};
+    joint_info.state_interfaces = {"position", "velocity"};
+    actuator_info.joints.push_back(joint_info);
+    joint->configure(joint_info);
+  }
+
+protected:
+  /// Read the joint every millisecond, as the control loop would, until its position is reached.
+  bool wait_for_position(AsyncActuatorHardware & actuator, double position)
+  {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    std::vector<double> state;
+    while (std::chrono::steady_clock::now() < deadline) {
+      actuator.read_joint(joint);
+      joint->get_state(state);
+      if (state[0] == position) {
+        return true;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+  }
+
+  HardwareInfo actuator_info;
+  std::shared_ptr<Joint> joint = std::make_shared<Joint>();
+  std::atomic<bool> failing{false};
+};
+
+TEST_F(TestAsyncActuatorHardware, exchanges_commands_and_states_without_blocking)
+{
+  AsyncActuatorHardware actuator(
+    std::make_unique<SlowDriver>(std::chrono::milliseconds(3), failing),
+    std::chrono::milliseconds(1), std::chrono::seconds(1));
+  EXPECT_EQ(actuator.get_status(), status::UNKNOWN);
+  EXPECT_EQ(actuator.read_joint(joint), return_type::ERROR);
+  ASSERT_EQ(actuator.configure(actuator_info), return_type::OK);
+  EXPECT_EQ(actuator.get_status(), status::CONFIGURED);
+  ASSERT_EQ(actuator.start(), return_type::OK);
+  EXPECT_EQ(actuator.start(), return_type::ERROR);
+  EXPECT_EQ(actuator.get_status(), status::STARTED);
+
+  ASSERT_EQ(joint->set_command({0.5}), return_type::OK);
+  // the real-time side only swaps buffers, far below the driver's 3 ms transactions
+  const auto begin = std::chrono::steady_clock::now();
+  EXPECT_EQ(actuator.write_joint(joint), return_type::OK);
+  actuator.read_joint(joint);
+  EXPECT_LT(std::chrono::steady_clock::now() - begin, std::chrono::milliseconds(3));
+
+  ASSERT_TRUE(wait_for_position(actuator, 0.5));
+  std::vector<double> state;
+  joint->get_state(state);
+  EXPECT_THAT(state, testing::ElementsAre(0.5, 1.0));
+  EXPECT_EQ(actuator.read_joint(joint), return_type::OK);
+
+  ASSERT_EQ(joint->set_command({-0.25}), return_type::OK);
+  EXPECT_EQ(actuator.write_joint(joint), return_type::OK);
+  ASSERT_TRUE(wait_for_position(actuator, -0.25));
+  EXPECT_EQ(actuator.get_io_error_count(), 0u);
+
+  EXPECT_EQ(actuator.stop(), return_type::OK);
+  EXPECT_EQ(actuator.get_status(), status::STOPPED);
+}
+
+TEST_F(TestAsyncActuatorHardware, reports_stale_states)
+{
+  AsyncActuatorHardware actuator(
+    std::make_unique<SlowDriver>(std::chrono::milliseconds(1), failing),
+    std::chrono::milliseconds(1), std::chrono::milliseconds(50));
+  ASSERT_EQ(actuator.configure(actuator_info), return_type::OK);
+  ASSERT_EQ(actuator.start(), return_type::OK);
+  ASSERT_EQ(joint->set_command({1.5}), return_type::OK);
+  ASSERT_EQ(actuator.write_joint(joint), return_type::OK);
+  ASSERT_TRUE(wait_for_position(actuator, 1.5));
+
+  failing = true;
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (actuator.get_status() != status::TIMED_OUT &&
+    std::chrono::steady_clock::now() < deadline)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(actuator.get_status(), status::TIMED_OUT);
+  EXPECT_EQ(actuator.read_joint(joint), return_type::ERROR);
+  EXPECT_GT(actuator.get_io_error_count(), 0u);
+
+  // the status recovers with the next state
+  failing = false;
+  ASSERT_EQ(joint->set_command({2.5}), return_type::OK);
+  ASSERT_EQ(actuator.write_joint(joint), return_type::OK);
+  ASSERT_TRUE(wait_for_position(actuator, 2.5));
+  EXPECT_EQ(actuator.get_status(), status::STARTED);
+  EXPECT_EQ(actuator.read_joint(joint), return_type::OK);
+}
+
+TEST_F(TestAsyncActuatorHardware, requires_a_single_joint)
+{
+  AsyncActuatorHardware actuator(
+    std::make_unique<SlowDriver>(std::chrono::milliseconds(1), failing),
+    std::chrono::milliseconds(1), std::chrono::milliseconds(50));
+  actuator_info.joints.push_back(actuator_info.joints[0]);
+  EXPECT_EQ(actuator.configure(actuator_info), return_type::ERROR);
+  EXPECT_EQ(actuator.start(), return_type::ERROR);
+  EXPECT_EQ(actuator.write_joint(joint), return_type::ERROR);
+}
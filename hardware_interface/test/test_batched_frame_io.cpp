@@ -0,0 +1,195 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hardware_interface/batched_frame_io.hpp"
+
+using hardware_interface::BatchedFrameIo;
+using hardware_interface::BatchedFrameIoOptions;
+using hardware_interface::FrameIoBackend;
+using hardware_interface::FrameIoMode;
+using hardware_interface::Span;
+using hardware_interface::return_type;
+
+namespace
+{
+class TestBatchedFrameIo : public ::testing::Test
+{
+public:
+  void TearDown() override
+  {
+    for (const int fd : fds_) {
+      close(fd);
+    }
+  }
+
+  /// A pair of connected sockets, the first one for the frame I/O, the second one for the peer
+  void make_socket_pair(int type)
+  {
+    ASSERT_EQ(0, socketpair(AF_UNIX, type, 0, fds_));
+  }
+
+  BatchedFrameIoOptions make_options(bool use_io_uring) const
+  {
+    BatchedFrameIoOptions options;
+    options.max_frames = 4;
+    options.max_frame_size = 8;
+    options.use_io_uring = use_io_uring;
+    return options;
+  }
+
+  /// Reaps until count frames are received in total, submitting for the reads to be rearmed
+  std::vector<std::string> reap_frames(BatchedFrameIo & io, size_t count)
+  {
+    std::vector<std::string> frames;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (frames.size() < count && std::chrono::steady_clock::now() < deadline) {
+      EXPECT_EQ(return_type::OK, io.reap());
+      for (size_t i = 0; i < io.get_received_count(); ++i) {
+        const auto frame = io.get_received_frame(i);
+        frames.emplace_back(frame.begin(), frame.end());
+      }
+      EXPECT_EQ(return_type::OK, io.submit());
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return frames;
+  }
+
+  static Span<const uint8_t> as_frame(const std::string & frame)
+  {
+    return Span<const uint8_t>(reinterpret_cast<const uint8_t *>(frame.data()), frame.size());
+  }
+
+  int fds_[2] = {-1, -1};
+};
+}  // namespace
+
+TEST_F(TestBatchedFrameIo, sends_and_receives_datagrams_in_batches)
+{
+  make_socket_pair(SOCK_DGRAM);
+  for (const bool use_io_uring : {true, false}) {
+    SCOPED_TRACE(use_io_uring ? "io_uring" : "batched syscalls");
+    BatchedFrameIo io(make_options(use_io_uring));
+    ASSERT_EQ(return_type::OK, io.open(fds_[0], FrameIoMode::DATAGRAM));
+    EXPECT_TRUE(io.is_open());
+    if (!use_io_uring) {
+      EXPECT_EQ(FrameIoBackend::BATCHED_SYSCALLS, io.get_backend());
+    } else if (io.get_backend() != FrameIoBackend::IO_URING) {
+      // the fallback is then checked twice, reported in the results rather than on the console
+      RecordProperty("io_uring", "unavailable, fell back to the batched syscalls");
+    }
+
+    // one system call for the three frames
+    for (const std::string frame : {"joint1", "joint2", "j3"}) {
+      ASSERT_EQ(return_type::OK, io.queue_frame(as_frame(frame)));
+    }
+    EXPECT_EQ(3u, io.get_queued_frame_count());
+    const auto syscalls = io.get_syscall_count();
+    ASSERT_EQ(return_type::OK, io.submit());
+    EXPECT_EQ(syscalls + 1, io.get_syscall_count());
+    EXPECT_EQ(0u, io.get_queued_frame_count());
+    for (const std::string expected : {"joint1", "joint2", "j3"}) {
+      char buffer[16];
+      const ssize_t size = recv(fds_[1], buffer, sizeof(buffer), 0);
+      ASSERT_EQ(static_cast<ssize_t>(expected.size()), size);
+      EXPECT_EQ(expected, std::string(buffer, static_cast<size_t>(size)));
+    }
+
+    for (const std::string frame : {"state1", "state2"}) {
+      ASSERT_EQ(static_cast<ssize_t>(frame.size()), send(fds_[1], frame.data(), frame.size(), 0));
+    }
+    const auto frames = reap_frames(io, 2);
+    EXPECT_THAT(frames, ::testing::UnorderedElementsAre("state1", "state2"));
+    EXPECT_EQ(3u, io.get_sent_frame_count());
+    EXPECT_EQ(2u, io.get_received_frame_count());
+    EXPECT_EQ(0u, io.get_dropped_frame_count());
+    EXPECT_EQ(0u, io.get_error_count());
+
+    io.close();
+    EXPECT_FALSE(io.is_open());
+    EXPECT_EQ(FrameIoBackend::NONE, io.get_backend());
+  }
+}
+
+TEST_F(TestBatchedFrameIo, writes_a_stream_back_to_back)
+{
+  make_socket_pair(SOCK_STREAM);
+  for (const bool use_io_uring : {true, false}) {
+    SCOPED_TRACE(use_io_uring ? "io_uring" : "batched syscalls");
+    BatchedFrameIo io(make_options(use_io_uring));
+    ASSERT_EQ(return_type::OK, io.open(fds_[0], FrameIoMode::STREAM));
+    ASSERT_EQ(return_type::OK, io.queue_frame(as_frame("ab")));
+    ASSERT_EQ(return_type::OK, io.queue_frame(as_frame("cde")));
+    ASSERT_EQ(return_type::OK, io.submit());
+    char buffer[16];
+    size_t size = 0;
+    while (size < 5) {
+      const ssize_t read = recv(fds_[1], buffer + size, sizeof(buffer) - size, 0);
+      ASSERT_GT(read, 0);
+      size += static_cast<size_t>(read);
+    }
+    EXPECT_EQ("abcde", std::string(buffer, size));
+
+    ASSERT_EQ(3, send(fds_[1], "xyz", 3, 0));
+    std::string received;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (received.size() < 3 && std::chrono::steady_clock::now() < deadline) {
+      for (const auto & chunk : reap_frames(io, 1)) {
+        received += chunk;
+      }
+    }
+    EXPECT_EQ("xyz", received);
+    // the write completions are collected by the reaps
+    EXPECT_EQ(2u, io.get_sent_frame_count());
+    io.close();
+  }
+}
+
+TEST_F(TestBatchedFrameIo, drops_the_frames_which_do_not_fit)
+{
+  make_socket_pair(SOCK_DGRAM);
+  BatchedFrameIo io(make_options(false));
+  EXPECT_EQ(return_type::ERROR, io.queue_frame(as_frame("closed")));
+  EXPECT_EQ(return_type::ERROR, io.submit());
+  EXPECT_EQ(return_type::ERROR, io.reap());
+  EXPECT_EQ(return_type::ERROR, io.open(-1, FrameIoMode::DATAGRAM));
+
+  ASSERT_EQ(return_type::OK, io.open(fds_[0], FrameIoMode::DATAGRAM));
+  EXPECT_EQ(return_type::ERROR, io.open(fds_[0], FrameIoMode::DATAGRAM));
+  EXPECT_EQ(return_type::ERROR, io.queue_frame(as_frame("too large")));
+  for (size_t i = 0; i < io.get_options().max_frames; ++i) {
+    EXPECT_EQ(return_type::OK, io.queue_frame(as_frame("frame")));
+  }
+  EXPECT_EQ(return_type::ERROR, io.queue_frame(as_frame("full")));
+  EXPECT_EQ(3u, io.get_dropped_frame_count());
+
+  // nothing received, without blocking
+  ASSERT_EQ(return_type::OK, io.reap());
+  EXPECT_EQ(0u, io.get_received_count());
+  ASSERT_EQ(return_type::OK, io.submit());
+  EXPECT_EQ(4u, io.get_sent_frame_count());
+  // nothing to send, without any system call
+  const auto syscalls = io.get_syscall_count();
+  ASSERT_EQ(return_type::OK, io.submit());
+  EXPECT_EQ(syscalls, io.get_syscall_count());
+}
@@ -0,0 +1,164 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "hardware_interface/actuator_hardware.hpp"
+#include "hardware_interface/actuator_hardware_interface.hpp"
+#include "hardware_interface/clock_domain_map.hpp"
+#include "hardware_interface/components/joint.hpp"
+
+using hardware_interface::ActuatorHardware;
+using hardware_interface::ActuatorHardwareInterface;
+using hardware_interface::ClockDomainMap;
+using hardware_interface::HardwareInfo;
+using hardware_interface::return_type;
+using hardware_interface::status;
+using hardware_interface::components::Joint;
+using std::chrono::nanoseconds;
+
+namespace
+{
+/// Stamps its joint in device time, and provides a pair of device and steady times per read.
+class StampingActuator : public ActuatorHardwareInterface
+{
+public:
+  return_type configure(const HardwareInfo &) override {return return_type::OK;}
+  return_type start() override {return return_type::OK;}
+  return_type stop() override {return return_type::OK;}
+  status get_status() const override {return status::STARTED;}
+  return_type read_joint(std::shared_ptr<Joint> joint) const override
+  {
+    joint->set_state_stamp(device_time_);
+    return return_type::OK;
+  }
+  return_type write_joint(const std::shared_ptr<Joint>) override {return return_type::OK;}
+  bool get_clock_sample(nanoseconds & device_time, nanoseconds & steady_time) const override
+  {
+    device_time = device_time_;
+    steady_time = steady_time_;
+    return true;
+  }
+
+  nanoseconds device_time_{0};
+  nanoseconds steady_time_{0};
+};
+
+constexpr int64_t kUs = 1000;
+constexpr int64_t kMs = 1000 * kUs;
+constexpr double kDrift = 20e-6;
+constexpr int64_t kDeviceOrigin = 1000 * kMs;
+constexpr int64_t kSteadyOrigin = 5000 * kMs;
+
+/// The steady time at which a device time elapses, for a steady clock faster by kDrift
+int64_t true_steady_ns(int64_t device_ns)
+{
+  return kSteadyOrigin +
+         static_cast<int64_t>(static_cast<double>(device_ns - kDeviceOrigin) * (1.0 + kDrift));
+}
+}  // namespace
+
+TEST(TestClockDomainMap, filters_the_transport_jitter_out_of_the_mapping)
+{
+  ClockDomainMap map;
+  size_t domain = 0;
+  ASSERT_EQ(return_type::OK, map.add_domain("ethercat_dc", {"joint1"}, domain));
+  EXPECT_FALSE(map.is_synchronized(domain));
+  nanoseconds steady;
+  EXPECT_EQ(return_type::ERROR, map.to_steady(domain, nanoseconds(kDeviceOrigin), steady));
+
+  // one frame per millisecond, received 50 us to 550 us after it was sampled
+  uint32_t jitter = 12345;
+  for (int64_t i = 0; i < 1000; ++i) {
+    const int64_t device_ns = kDeviceOrigin + i * kMs;
+    jitter = jitter * 1103515245u + 12345u;
+    const int64_t latency_ns = i % 7 == 0 ? 50 * kUs : 50 * kUs + (jitter >> 16) % (500 * kUs);
+    EXPECT_TRUE(
+      map.add_sample(domain, nanoseconds(device_ns), nanoseconds(true_steady_ns(device_ns) +
+      latency_ns)));
+  }
+  ASSERT_TRUE(map.is_synchronized(domain));
+  EXPECT_NEAR(kDrift, map.get_drift(domain), 1e-6);
+  // only the smallest latency remains
+  for (const int64_t device_ns : {kDeviceOrigin + 990 * kMs, kDeviceOrigin + 1005 * kMs}) {
+    ASSERT_EQ(return_type::OK, map.to_steady(domain, nanoseconds(device_ns), steady));
+    EXPECT_NEAR(
+      static_cast<double>(true_steady_ns(device_ns) + 50 * kUs),
+      static_cast<double>(steady.count()), 1.0 * kUs);
+  }
+  EXPECT_NEAR(
+    static_cast<double>(true_steady_ns(kDeviceOrigin + 999 * kMs) + 50 * kUs -
+    (kDeviceOrigin + 999 * kMs)), static_cast<double>(map.get_offset(domain).count()), 1.0 * kUs);
+
+  // the device clock going back in time is refused until the domain is reset
+  EXPECT_FALSE(map.add_sample(domain, nanoseconds(kDeviceOrigin), nanoseconds(kSteadyOrigin)));
+  map.reset(domain);
+  EXPECT_FALSE(map.is_synchronized(domain));
+  EXPECT_TRUE(map.add_sample(domain, nanoseconds(kDeviceOrigin), nanoseconds(kSteadyOrigin)));
+}
+
+TEST(TestClockDomainMap, shares_the_domains_between_components)
+{
+  ClockDomainMap map;
+  size_t arm = 0, gripper = 0, camera = 0;
+  ASSERT_EQ(return_type::OK, map.add_domain("ethercat_dc", {"joint1", "joint2"}, arm));
+  ASSERT_EQ(return_type::OK, map.add_domain("ptp", {"camera"}, camera));
+  ASSERT_EQ(return_type::OK, map.add_domain("ethercat_dc", {"finger"}, gripper));
+  EXPECT_EQ(arm, gripper);
+  EXPECT_NE(arm, camera);
+  EXPECT_EQ(2u, map.get_domain_count());
+  EXPECT_EQ("ptp", map.get_domain_name(camera));
+
+  size_t domain = 0;
+  ASSERT_EQ(return_type::OK, map.find_joint_domain("finger", domain));
+  EXPECT_EQ(arm, domain);
+  ASSERT_EQ(return_type::OK, map.find_joint_domain("camera", domain));
+  EXPECT_EQ(camera, domain);
+  EXPECT_EQ(return_type::ERROR, map.find_joint_domain("unknown", domain));
+
+  for (size_t i = map.get_domain_count(); i < ClockDomainMap::MAX_DOMAINS; ++i) {
+    ASSERT_EQ(return_type::OK, map.add_domain("domain" + std::to_string(i), {}, domain));
+  }
+  EXPECT_EQ(return_type::ERROR, map.add_domain("one too many", {}, domain));
+}
+
+TEST(TestClockDomainMap, components_feed_their_domain_on_successful_reads)
+{
+  auto map = std::make_shared<ClockDomainMap>(nanoseconds(0));
+  size_t domain = 0;
+  ASSERT_EQ(return_type::OK, map->add_domain("ethercat_dc", {"joint1"}, domain));
+  auto impl = std::make_unique<StampingActuator>();
+  auto & driver = *impl;
+  ActuatorHardware actuator(std::move(impl));
+  actuator.set_clock_domain(map, domain);
+  auto joint = std::make_shared<Joint>();
+
+  for (int64_t i = 0; i < 2; ++i) {
+    driver.device_time_ = nanoseconds(kDeviceOrigin + i * kMs);
+    driver.steady_time_ = nanoseconds(kSteadyOrigin + i * kMs);
+    ASSERT_EQ(return_type::OK, actuator.read_joint(joint));
+  }
+  EXPECT_EQ(nanoseconds(kDeviceOrigin + kMs), joint->get_state_stamp());
+  ASSERT_TRUE(map->is_synchronized(domain));
+  nanoseconds steady;
+  ASSERT_EQ(return_type::OK, map->to_steady(domain, joint->get_state_stamp(), steady));
+  EXPECT_EQ(nanoseconds(kSteadyOrigin + kMs), steady);
+}
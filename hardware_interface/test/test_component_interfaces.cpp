@@ -13,8 +13,12 @@
 // limitations under the License.
 
 #include <gmock/gmock.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -22,6 +26,7 @@
 #include "hardware_interface/actuator_hardware_interface.hpp"
 #include "hardware_interface/components/component_info.hpp"
 #include "hardware_interface/components/joint.hpp"
+#include "hardware_interface/components/joint_values_batch.hpp"
 #include "hardware_interface/components/sensor.hpp"
 #include "hardware_interface/hardware_info.hpp"
 #include "hardware_interface/sensor_hardware_interface.hpp"
@@ -30,6 +35,7 @@
 #include "hardware_interface/system_hardware.hpp"
 #include "hardware_interface/types/hardware_interface_return_values.hpp"
 #include "hardware_interface/types/hardware_interface_status_values.hpp"
+#include "hardware_interface/types/hardware_interface_switch_state_values.hpp"
 #include "hardware_interface/types/hardware_interface_type_values.hpp"
 
 using namespace ::testing;  // NOLINT
@@ -54,10 +60,12 @@ public:
     }
     if (info_.command_interfaces.size() == 0) {
       info_.command_interfaces.push_back(HW_IF_POSITION);
+      command_interface_ids_.push_back(HW_IF_POSITION_ID);
       commands_.resize(1);
     }
     if (info_.state_interfaces.size() == 0) {
       info_.state_interfaces.push_back(HW_IF_POSITION);
+      state_interface_ids_.push_back(HW_IF_POSITION_ID);
       states_.resize(1);
     }
 
@@ -114,6 +122,9 @@ public:
       info_.state_interfaces.push_back("torque_x");
       info_.state_interfaces.push_back("torque_y");
       info_.state_interfaces.push_back("torque_z");
+      for (const auto & interface : info_.state_interfaces) {
+        state_interface_ids_.push_back(InterfaceTypeId::intern(interface));
+      }
     }
     states_ = {1.34, 5.67, 8.21, 5.63, 5.99, 4.32};
     return return_type::OK;
@@ -325,6 +336,83 @@ private:
   std::vector<double> joints_hw_values_ = {-1.575, -0.7543};
 };
 
+class DummyBatchedSystemHardware : public DummySystemHardware
+{
+public:
+  std::vector<double> written_positions_;
+
+private:
+  bool supports_joint_batches() const override
+  {
+    return true;
+  }
+
+  return_type read_joint_batch(components::JointValuesBatch & states) const override
+  {
+    size_t position_index;
+    if (states.get_interface_index(HW_IF_POSITION, position_index) != return_type::OK ||
+      states.get_joint_count() > joints_hw_values_.size())
+    {
+      return return_type::ERROR;
+    }
+    auto positions = states.get_values(position_index);
+    std::copy(joints_hw_values_.begin(), joints_hw_values_.begin() + positions.size(),
+      positions.begin());
+    return return_type::OK;
+  }
+
+  return_type write_joint_batch(const components::JointValuesBatch & commands) override
+  {
+    size_t position_index;
+    if (commands.get_interface_index(HW_IF_POSITION, position_index) != return_type::OK) {
+      return return_type::ERROR;
+    }
+    auto positions = commands.get_values(position_index);
+    written_positions_.assign(positions.begin(), positions.end());
+    return return_type::OK;
+  }
+
+  std::vector<double> joints_hw_values_ = {0.25, -0.5};
+};
+
+/// Switches the mode of its drives in the background, the gripper drive switching first
+class DummyModeSwitchingSystemHardware : public DummySystemHardware
+{
+public:
+  switch_state drives_state_ = switch_state::DONE;
+  switch_state gripper_state_ = switch_state::DONE;
+  std::vector<std::string> switching_controllers_;
+
+private:
+  return_type prepare_mode_switch(
+    const std::vector<ControllerInfo> & start_list, const std::vector<ControllerInfo> &) override
+  {
+    return start_list.size() > 2 ? return_type::ERROR : return_type::OK;
+  }
+
+  return_type perform_mode_switch(
+    const std::vector<ControllerInfo> & start_list, const std::vector<ControllerInfo> &) override
+  {
+    switching_controllers_.clear();
+    for (const auto & controller : start_list) {
+      switching_controllers_.push_back(controller.name);
+    }
+    drives_state_ = switch_state::ONGOING;
+    gripper_state_ = switch_state::ONGOING;
+    return return_type::OK;
+  }
+
+  switch_state get_mode_switch_state() const override
+  {
+    return drives_state_;
+  }
+
+  switch_state get_mode_switch_state(const ControllerInfo & controller) const override
+  {
+    return controller.name == "gripper" ? gripper_state_ : drives_state_;
+  }
+};
+
 }  // namespace hardware_interfaces_components_test
 }  // namespace hardware_interface
 
@@ -333,9 +421,17 @@ using hardware_interface::components::Joint;
 using hardware_interface::components::Sensor;
 using hardware_interface::ActuatorHardware;
 using hardware_interface::ActuatorHardwareInterface;
+using hardware_interface::ControllerInfo;
 using hardware_interface::HardwareInfo;
+using hardware_interface::HW_IF_EFFORT_ID;
+using hardware_interface::HW_IF_POSITION_ID;
+using hardware_interface::HW_IF_VELOCITY_ID;
+using hardware_interface::InterfaceTypeId;
+using hardware_interface::Span;
+using hardware_interface::components::InterfaceSelector;
 using hardware_interface::status;
 using hardware_interface::return_type;
+using hardware_interface::switch_state;
 using hardware_interface::SensorHardware;
 using hardware_interface::SensorHardwareInterface;
 using hardware_interface::SystemHardware;
@@ -346,6 +442,8 @@ using hardware_interface::hardware_interfaces_components_test::DummyPositionJoin
 
 using hardware_interface::hardware_interfaces_components_test::DummyActuatorHardware;
 using hardware_interface::hardware_interfaces_components_test::DummySensorHardware;
+using hardware_interface::hardware_interfaces_components_test::DummyBatchedSystemHardware;
+using hardware_interface::hardware_interfaces_components_test::DummyModeSwitchingSystemHardware;
 using hardware_interface::hardware_interfaces_components_test::DummySystemHardware;
 
 class TestComponentInterfaces : public Test
@@ -451,6 +549,61 @@ TEST_F(TestComponentInterfaces, joint_example_component_works)
   EXPECT_EQ(joint.configure(joint_info), return_type::ERROR);
 }
 
+TEST_F(TestComponentInterfaces, joint_selector_getters_and_setters_work)
+{
+  DummyPositionJoint joint;
+  EXPECT_EQ(joint.configure(joint_info), return_type::OK);
+
+  hardware_interface::components::InterfaceSelector selector;
+  std::vector<std::string> interfaces;
+  EXPECT_EQ(
+    joint.get_command_interface_selector(selector, interfaces),
+    return_type::INTERFACE_NOT_PROVIDED);
+  interfaces.push_back(hardware_interface::HW_IF_VELOCITY);
+  EXPECT_EQ(
+    joint.get_command_interface_selector(selector, interfaces), return_type::INTERFACE_NOT_FOUND);
+
+  double value = 1.2;
+  EXPECT_EQ(
+    joint.set_command(hardware_interface::Span<const double>(&value, 1), selector),
+    return_type::INTERFACE_NOT_PROVIDED);
+
+  interfaces.clear();
+  interfaces.push_back(hardware_interface::HW_IF_POSITION);
+  ASSERT_EQ(joint.get_command_interface_selector(selector, interfaces), return_type::OK);
+  ASSERT_EQ(selector.size(), 1u);
+
+  std::vector<double> input;
+  EXPECT_EQ(joint.set_command(input, selector), return_type::INTERFACE_VALUE_SIZE_NOT_EQUAL);
+  input.push_back(1.2);
+  EXPECT_EQ(joint.set_command(input, selector), return_type::OK);
+
+  std::vector<double> output(1);
+  EXPECT_EQ(joint.get_command(output, selector), return_type::OK);
+  EXPECT_EQ(output[0], 1.2);
+  output.clear();
+  EXPECT_EQ(joint.get_command(output, interfaces), return_type::OK);
+  ASSERT_THAT(output, SizeIs(1));
+  EXPECT_EQ(output[0], 1.2);
+  std::vector<double> wrong_size_output(2);
+  EXPECT_EQ(
+    joint.get_command(wrong_size_output, selector), return_type::INTERFACE_VALUE_SIZE_NOT_EQUAL);
+
+  // State getters and setters
+  ASSERT_EQ(joint.get_state_interface_selector(selector, interfaces), return_type::OK);
+  input[0] = 2.1;
+  EXPECT_EQ(joint.set_state(input, selector), return_type::OK);
+  EXPECT_EQ(joint.get_state(output, selector), return_type::OK);
+  EXPECT_EQ(output[0], 2.1);
+
+  // A selector resolved for another component's interfaces is rejected
+  hardware_interface::components::InterfaceSelector foreign_selector({3});
+  EXPECT_EQ(joint.get_state(output, foreign_selector), return_type::INTERFACE_NOT_FOUND);
+  EXPECT_EQ(joint.set_state(input, foreign_selector), return_type::INTERFACE_NOT_FOUND);
+  EXPECT_EQ(joint.get_state(output, selector), return_type::OK);
+  EXPECT_EQ(output[0], 2.1);
+}
+
 TEST_F(TestComponentInterfaces, multi_joint_example_component_works)
 {
   DummyMultiJoint joint;
@@ -601,6 +754,259 @@ TEST_F(TestComponentInterfaces, sensor_example_component_works)
   EXPECT_EQ(sensor.configure(sensor_info), return_type::ERROR);
 }
 
+TEST_F(TestComponentInterfaces, components_resolve_interface_ids)
+{
+  DummyMultiJoint joint;
+  joint_info.name = "DummyMultiJoint";
+  joint_info.parameters["max_position"] = "3.14";
+  joint_info.parameters["min_position"] = "-3.14";
+  joint_info.parameters["max_velocity"] = "1.14";
+  joint_info.parameters["min_velocity"] = "-1.14";
+  joint_info.command_interfaces = {
+    hardware_interface::HW_IF_POSITION, hardware_interface::HW_IF_VELOCITY};
+  joint_info.state_interfaces = {hardware_interface::HW_IF_VELOCITY, "custom"};
+  ASSERT_EQ(joint.configure(joint_info), return_type::OK);
+
+  const auto custom_id = InterfaceTypeId::intern("custom");
+  EXPECT_THAT(joint.get_command_interface_ids(), ElementsAre(HW_IF_POSITION_ID, HW_IF_VELOCITY_ID));
+  EXPECT_THAT(joint.get_state_interface_ids(), ElementsAre(HW_IF_VELOCITY_ID, custom_id));
+
+  // ids resolve to the same indices as names
+  InterfaceSelector by_id;
+  InterfaceSelector by_name;
+  ASSERT_EQ(
+    joint.get_state_interface_selector(by_id, {custom_id, HW_IF_VELOCITY_ID}), return_type::OK);
+  const std::vector<std::string> names = {"custom", hardware_interface::HW_IF_VELOCITY};
+  ASSERT_EQ(joint.get_state_interface_selector(by_name, names), return_type::OK);
+  EXPECT_EQ(by_id.get_indices(), by_name.get_indices());
+  EXPECT_EQ(
+    joint.get_command_interface_selector(by_id, std::vector<InterfaceTypeId>{HW_IF_EFFORT_ID}),
+    return_type::INTERFACE_NOT_FOUND);
+  EXPECT_EQ(
+    joint.get_command_interface_selector(by_id, std::vector<InterfaceTypeId>{}),
+    return_type::INTERFACE_NOT_PROVIDED);
+  ASSERT_EQ(
+    joint.get_command_interface_selector(by_id, {HW_IF_VELOCITY_ID}), return_type::OK);
+  const double command = 0.5;
+  EXPECT_EQ(joint.set_command(Span<const double>(&command, 1), by_id), return_type::OK);
+  std::vector<double> commands;
+  EXPECT_EQ(joint.get_command(commands), return_type::OK);
+  EXPECT_THAT(commands, ElementsAre(0.0, 0.5));
+
+  DummyForceTorqueSensor sensor;
+  ASSERT_EQ(sensor.configure(sensor_info), return_type::OK);
+  ASSERT_THAT(sensor.get_state_interface_ids(), SizeIs(6));
+  EXPECT_EQ(sensor.get_state_interface_ids()[2], InterfaceTypeId::intern("force_z"));
+  InterfaceSelector torques;
+  ASSERT_EQ(
+    sensor.get_state_interface_selector(
+      torques, {InterfaceTypeId::intern("torque_x"), InterfaceTypeId::intern("torque_z")}),
+    return_type::OK);
+  std::vector<double> values(2);
+  EXPECT_EQ(sensor.get_state(values, torques), return_type::OK);
+  EXPECT_THAT(values, ElementsAre(5.63, 4.32));
+  EXPECT_EQ(
+    sensor.get_state_interface_selector(torques, {HW_IF_POSITION_ID}),
+    return_type::INTERFACE_NOT_FOUND);
+}
+
+TEST_F(TestComponentInterfaces, sensor_state_buffer_works)
+{
+  DummyForceTorqueSensor sensor;
+  ASSERT_EQ(sensor.configure(sensor_info), return_type::OK);
+  EXPECT_FALSE(sensor.is_state_buffer_enabled());
+  const std::vector<double> sample = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0};
+  EXPECT_EQ(sensor.publish_state(sample, std::chrono::nanoseconds(1)), return_type::ERROR);
+  EXPECT_FALSE(sensor.update_state());
+
+  ASSERT_EQ(sensor.enable_state_buffer(), return_type::OK);
+  ASSERT_TRUE(sensor.is_state_buffer_enabled());
+  EXPECT_FALSE(sensor.update_state());
+  EXPECT_EQ(sensor.get_state_stamp(), std::chrono::nanoseconds(0));
+
+  // nothing changes until the reader takes the sample
+  ASSERT_EQ(sensor.publish_state(sample, std::chrono::nanoseconds(10)), return_type::OK);
+  std::vector<double> output;
+  EXPECT_EQ(sensor.get_state(output), return_type::OK);
+  EXPECT_THAT(output, ElementsAre(1.34, 5.67, 8.21, 5.63, 5.99, 4.32));
+  ASSERT_TRUE(sensor.update_state());
+  EXPECT_EQ(sensor.get_state_stamp(), std::chrono::nanoseconds(10));
+  EXPECT_EQ(sensor.get_state(output), return_type::OK);
+  EXPECT_EQ(output, sample);
+  EXPECT_FALSE(sensor.update_state());
+  EXPECT_EQ(sensor.get_state_stamp(), std::chrono::nanoseconds(10));
+
+  // only the latest of several samples is taken
+  const std::vector<double> older(6, 7.0);
+  const std::vector<double> latest(6, 8.0);
+  ASSERT_EQ(sensor.publish_state(older, std::chrono::nanoseconds(20)), return_type::OK);
+  ASSERT_EQ(sensor.publish_state(latest, std::chrono::nanoseconds(30)), return_type::OK);
+  ASSERT_TRUE(sensor.update_state());
+  EXPECT_EQ(sensor.get_state_stamp(), std::chrono::nanoseconds(30));
+  EXPECT_EQ(sensor.get_state(output), return_type::OK);
+  EXPECT_EQ(output, latest);
+
+  const std::vector<double> too_short(3, 0.0);
+  EXPECT_EQ(
+    sensor.publish_state(too_short, std::chrono::nanoseconds(40)),
+    return_type::INTERFACE_VALUE_SIZE_NOT_EQUAL);
+  EXPECT_FALSE(sensor.update_state());
+}
+
+TEST_F(TestComponentInterfaces, sensor_state_buffer_is_consistent_across_threads)
+{
+  DummyForceTorqueSensor sensor;
+  ASSERT_EQ(sensor.configure(sensor_info), return_type::OK);
+  ASSERT_EQ(sensor.enable_state_buffer(), return_type::OK);
+
+  constexpr int64_t kSamples = 20000;
+  std::atomic<bool> done{false};
+  std::thread driver([&sensor, &done]() {
+      std::vector<double> sample(6);
+      for (int64_t i = 1; i <= kSamples; ++i) {
+        std::fill(sample.begin(), sample.end(), static_cast<double>(i));
+        sensor.publish_state(sample, std::chrono::nanoseconds(i));
+      }
+      done = true;
+    });
+
+  std::vector<double> output(6);
+  InterfaceSelector selector;
+  ASSERT_EQ(
+    sensor.get_state_interface_selector(selector, sensor.get_state_interface_ids()),
+    return_type::OK);
+  int64_t last_stamp = 0;
+  while (true) {
+    const bool finished = done;
+    if (!sensor.update_state()) {
+      if (finished) {
+        break;
+      }
+      continue;
+    }
+    const auto stamp = sensor.get_state_stamp().count();
+    ASSERT_EQ(sensor.get_state(output, selector), return_type::OK);
+    // a torn sample would mix values of different samples or of another stamp
+    EXPECT_THAT(output, Each(static_cast<double>(stamp)));
+    EXPECT_GT(stamp, last_stamp);
+    last_stamp = stamp;
+  }
+  driver.join();
+  EXPECT_EQ(last_stamp, kSamples);
+}
+
+TEST_F(TestComponentInterfaces, sensor_sample_queue_works)
+{
+  Sensor sensor;
+  sensor_info.state_interfaces = {"force_x", "force_y", "force_z"};
+  sensor_info.parameters[Sensor::SAMPLE_QUEUE_CAPACITY_PARAMETER] = "0";
+  EXPECT_EQ(sensor.configure(sensor_info), return_type::ERROR);
+  sensor_info.parameters[Sensor::SAMPLE_QUEUE_CAPACITY_PARAMETER] = "-4";
+  EXPECT_EQ(sensor.configure(sensor_info), return_type::ERROR);
+  sensor_info.parameters[Sensor::SAMPLE_QUEUE_CAPACITY_PARAMETER] = "8";
+  ASSERT_EQ(sensor.configure(sensor_info), return_type::OK);
+  ASSERT_TRUE(sensor.is_sample_queue_enabled());
+  EXPECT_EQ(sensor.get_sample_queue_capacity(), 8u);
+  EXPECT_TRUE(sensor.take_samples().empty());
+
+  // 7 samples per cycle, as pushed by read_sensors()
+  std::vector<double> sample(3);
+  for (int64_t cycle = 0; cycle < 3; ++cycle) {
+    for (int64_t i = 0; i < 7; ++i) {
+      const auto index = cycle * 7 + i;
+      sample = {1.0 * index, 2.0 * index, 3.0 * index};
+      ASSERT_EQ(sensor.push_sample(sample, std::chrono::nanoseconds(index)), return_type::OK);
+    }
+    const auto samples = sensor.take_samples();
+    ASSERT_EQ(samples.size(), 7u);
+    EXPECT_EQ(samples.get_sample_size(), 3u);
+    EXPECT_EQ(samples.get_values().size(), 21u);
+    for (size_t i = 0; i < samples.size(); ++i) {
+      const auto index = static_cast<double>(cycle * 7 + static_cast<int64_t>(i));
+      EXPECT_EQ(samples.get_stamps()[i].count(), cycle * 7 + static_cast<int64_t>(i));
+      EXPECT_THAT(
+        std::vector<double>(samples[i].begin(), samples[i].end()),
+        ElementsAre(index, 2.0 * index, 3.0 * index));
+    }
+    EXPECT_EQ(sensor.get_samples().size(), 7u);
+    // the states hold the latest sample
+    std::vector<double> states;
+    EXPECT_EQ(sensor.get_state(states), return_type::OK);
+    EXPECT_EQ(states, sample);
+    EXPECT_EQ(sensor.get_state_stamp().count(), cycle * 7 + 6);
+  }
+  EXPECT_TRUE(sensor.take_samples().empty());
+
+  // samples pushed to a full queue are dropped, the queued ones are kept
+  for (int64_t i = 0; i < 10; ++i) {
+    sample.assign(3, static_cast<double>(i));
+    const auto ret = sensor.push_sample(sample, std::chrono::nanoseconds(i));
+    EXPECT_EQ(ret, i < 8 ? return_type::OK : return_type::ERROR);
+  }
+  EXPECT_EQ(sensor.get_dropped_sample_count(), 2u);
+  const auto samples = sensor.take_samples();
+  ASSERT_EQ(samples.size(), 8u);
+  EXPECT_EQ(samples.get_stamps()[0].count(), 0);
+  EXPECT_EQ(samples.get_stamps()[7].count(), 7);
+
+  const std::vector<double> too_long(4, 0.0);
+  EXPECT_EQ(
+    sensor.push_sample(too_long, std::chrono::nanoseconds(0)),
+    return_type::INTERFACE_VALUE_SIZE_NOT_EQUAL);
+
+  Sensor unqueued;
+  sensor_info.parameters.erase(Sensor::SAMPLE_QUEUE_CAPACITY_PARAMETER);
+  ASSERT_EQ(unqueued.configure(sensor_info), return_type::OK);
+  EXPECT_FALSE(unqueued.is_sample_queue_enabled());
+  EXPECT_EQ(unqueued.push_sample(sample, std::chrono::nanoseconds(0)), return_type::ERROR);
+  EXPECT_TRUE(unqueued.take_samples().empty());
+  EXPECT_EQ(unqueued.enable_sample_queue(0), return_type::ERROR);
+  EXPECT_EQ(unqueued.enable_sample_queue(2), return_type::OK);
+  EXPECT_EQ(unqueued.get_sample_queue_capacity(), 2u);
+}
+
+TEST_F(TestComponentInterfaces, sensor_sample_queue_is_consistent_across_threads)
+{
+  Sensor sensor;
+  sensor_info.state_interfaces = {"force_x", "force_y", "force_z"};
+  sensor_info.parameters[Sensor::SAMPLE_QUEUE_CAPACITY_PARAMETER] = "16";
+  ASSERT_EQ(sensor.configure(sensor_info), return_type::OK);
+
+  constexpr int64_t kSamples = 20000;
+  std::atomic<bool> done{false};
+  std::thread driver([&sensor, &done]() {
+      std::vector<double> sample(3);
+      for (int64_t i = 1; i <= kSamples; ) {
+        std::fill(sample.begin(), sample.end(), static_cast<double>(i));
+        if (sensor.push_sample(sample, std::chrono::nanoseconds(i)) == return_type::OK) {
+          ++i;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+      done = true;
+    });
+
+  // every sample is taken once, in order
+  int64_t expected = 1;
+  while (true) {
+    const bool finished = done;
+    const auto samples = sensor.take_samples();
+    for (size_t i = 0; i < samples.size(); ++i) {
+      ASSERT_EQ(samples.get_stamps()[i].count(), expected);
+      EXPECT_THAT(
+        std::vector<double>(samples[i].begin(), samples[i].end()),
+        Each(static_cast<double>(expected)));
+      ++expected;
+    }
+    if (finished && samples.empty()) {
+      break;
+    }
+  }
+  driver.join();
+  EXPECT_EQ(expected, kSamples + 1);
+}
+
 TEST_F(TestComponentInterfaces, actuator_hardware_interface_works)
 {
   ActuatorHardware actuator_hw(std::make_unique<DummyActuatorHardware>());
@@ -625,6 +1031,15 @@ TEST_F(TestComponentInterfaces, actuator_hardware_interface_works)
   EXPECT_EQ(output[0], 1.2);
   EXPECT_EQ(interfaces[0], hardware_interface::HW_IF_POSITION);
   EXPECT_EQ(actuator_hw.write_joint(joint), return_type::OK);
+
+  // switching modes completes immediately by default
+  std::vector<ControllerInfo> controllers(1);
+  controllers[0].name = "arm";
+  EXPECT_EQ(actuator_hw.prepare_mode_switch(controllers, {}), return_type::OK);
+  EXPECT_EQ(actuator_hw.perform_mode_switch(controllers, {}), return_type::OK);
+  EXPECT_EQ(actuator_hw.get_mode_switch_state(), switch_state::DONE);
+  EXPECT_EQ(actuator_hw.get_mode_switch_state(controllers[0]), switch_state::DONE);
+
   EXPECT_EQ(actuator_hw.stop(), return_type::OK);
   EXPECT_EQ(actuator_hw.get_status(), status::STOPPED);
 }
@@ -718,3 +1133,94 @@ TEST_F(TestComponentInterfaces, system_interface_with_hardware_works)
   EXPECT_EQ(system.stop(), return_type::OK);
   EXPECT_EQ(system.get_status(), status::STOPPED);
 }
+
+TEST_F(TestComponentInterfaces, system_interface_with_joint_batches_works)
+{
+  auto batched_hw = std::make_unique<DummyBatchedSystemHardware>();
+  auto batched_hw_ptr = batched_hw.get();
+  SystemHardware system(std::move(batched_hw));
+  EXPECT_TRUE(system.supports_joint_batches());
+
+  auto joint1 = std::make_shared<DummyPositionJoint>();
+  auto joint2 = std::make_shared<DummyPositionJoint>();
+  EXPECT_EQ(joint1->configure(joint_info), return_type::OK);
+  EXPECT_EQ(joint2->configure(joint_info), return_type::OK);
+  std::vector<std::shared_ptr<Joint>> joints;
+  joints.push_back(joint1);
+  joints.push_back(joint2);
+
+  HardwareInfo system_hw_info;
+  system_hw_info.name = "DummyBatchedSystemHardware";
+  system_hw_info.hardware_parameters["example_api_version"] = "1.1";
+  system_hw_info.hardware_parameters["example_param_write_for_sec"] = "2";
+  system_hw_info.hardware_parameters["example_param_read_for_sec"] = "3";
+  EXPECT_EQ(system.configure(system_hw_info), return_type::OK);
+  EXPECT_EQ(system.start(), return_type::OK);
+
+  // states are read in one batch and scattered to the joints
+  EXPECT_EQ(system.read_joints(joints), return_type::OK);
+  std::vector<double> output;
+  EXPECT_EQ(joint1->get_state(output), return_type::OK);
+  ASSERT_THAT(output, SizeIs(1));
+  EXPECT_EQ(output[0], 0.25);
+  output.clear();
+  EXPECT_EQ(joint2->get_state(output), return_type::OK);
+  ASSERT_THAT(output, SizeIs(1));
+  EXPECT_EQ(output[0], -0.5);
+
+  // commands are gathered from the joints and written in one batch
+  EXPECT_EQ(joint1->set_command(std::vector<double>{1.1}), return_type::OK);
+  EXPECT_EQ(joint2->set_command(std::vector<double>{2.2}), return_type::OK);
+  EXPECT_EQ(system.write_joints(joints), return_type::OK);
+  EXPECT_THAT(batched_hw_ptr->written_positions_, ElementsAre(1.1, 2.2));
+
+  // batches can be exchanged directly
+  hardware_interface::components::JointValuesBatch states(
+    2, {hardware_interface::HW_IF_POSITION});
+  EXPECT_EQ(system.read_joint_batch(states), return_type::OK);
+  EXPECT_THAT(states.get_all_values(), ElementsAre(0.25, -0.5));
+
+  // joints with different interfaces are read one by one
+  auto velocity_joint = std::make_shared<Joint>();
+  ComponentInfo velocity_joint_info;
+  velocity_joint_info.name = "VelocityJoint";
+  velocity_joint_info.command_interfaces.push_back(hardware_interface::HW_IF_VELOCITY);
+  velocity_joint_info.state_interfaces.push_back(hardware_interface::HW_IF_VELOCITY);
+  EXPECT_EQ(velocity_joint->configure(velocity_joint_info), return_type::OK);
+  joints[1] = velocity_joint;
+  EXPECT_EQ(system.read_joints(joints), return_type::OK);
+  output.clear();
+  EXPECT_EQ(velocity_joint->get_state(output), return_type::OK);
+  ASSERT_THAT(output, SizeIs(1));
+  EXPECT_EQ(output[0], -0.7543);
+}
+
+TEST_F(TestComponentInterfaces, system_interface_mode_switch_works)
+{
+  auto switching_hw = std::make_unique<DummyModeSwitchingSystemHardware>();
+  auto switching_hw_ptr = switching_hw.get();
+  SystemHardware system(std::move(switching_hw));
+
+  std::vector<ControllerInfo> controllers(3);
+  controllers[0].name = "arm";
+  controllers[1].name = "gripper";
+  controllers[2].name = "head";
+  EXPECT_EQ(system.prepare_mode_switch(controllers, {}), return_type::ERROR);
+  controllers.pop_back();
+  EXPECT_EQ(system.prepare_mode_switch(controllers, {}), return_type::OK);
+
+  // the switch is started, then polled until done
+  EXPECT_EQ(system.perform_mode_switch(controllers, {}), return_type::OK);
+  EXPECT_THAT(switching_hw_ptr->switching_controllers_, ElementsAre("arm", "gripper"));
+  EXPECT_EQ(system.get_mode_switch_state(), switch_state::ONGOING);
+  EXPECT_EQ(system.get_mode_switch_state(controllers[1]), switch_state::ONGOING);
+
+  switching_hw_ptr->gripper_state_ = switch_state::DONE;
+  EXPECT_EQ(system.get_mode_switch_state(), switch_state::ONGOING);
+  EXPECT_EQ(system.get_mode_switch_state(controllers[0]), switch_state::ONGOING);
+  EXPECT_EQ(system.get_mode_switch_state(controllers[1]), switch_state::DONE);
+
+  switching_hw_ptr->drives_state_ = switch_state::ERROR;
+  EXPECT_EQ(system.get_mode_switch_state(), switch_state::ERROR);
+  EXPECT_EQ(system.get_mode_switch_state(controllers[0]), switch_state::ERROR);
+}
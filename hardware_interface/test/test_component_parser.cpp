@@ -13,9 +13,13 @@
 // limitations under the License.
 
 #include <gmock/gmock.h>
+#include <tinyxml2.h>
+#include <sstream>
 #include <string>
+#include <unordered_map>
 
 #include "hardware_interface/component_parser.hpp"
+#include "hardware_interface/urdf_document.hpp"
 
 using namespace ::testing;  // NOLINT
 
@@ -1046,3 +1050,141 @@ TEST_F(TestComponentParser, successfully_parse_valid_urdf_actuator_only)
   ASSERT_THAT(hardware_info.transmissions[0].parameters, SizeIs(1));
   EXPECT_EQ(hardware_info.transmissions[0].parameters.at("joint_to_actuator"), "${1024/PI}");
 }
+
+TEST_F(TestComponentParser, successfully_parse_shared_urdf_document)
+{
+  const std::string urdf_to_test = urdf_xml_head_ +
+    valid_urdf_ros2_control_actuator_modular_robot_sensors_ + urdf_xml_tail_;
+  const hardware_interface::URDFDocument urdf(urdf_to_test);
+
+  // only the top-level elements are indexed, not the ones under ros2_control
+  EXPECT_THAT(urdf.get_ros2_control_elements(), SizeIs(4));
+  EXPECT_THAT(urdf.get_transmission_elements(), IsEmpty());
+  EXPECT_THAT(urdf.get_joint_elements(), SizeIs(4));
+  ASSERT_NE(nullptr, urdf.find_joint_element("joint1"));
+  EXPECT_STREQ("revolute", urdf.find_joint_element("joint1")->Attribute("type"));
+  EXPECT_EQ(nullptr, urdf.find_joint_element("unknown_joint"));
+
+  // the document can be parsed by several parsers with the same result as the string
+  const auto control_hardware = parse_control_resources_from_urdf(urdf);
+  const auto control_hardware_from_string = parse_control_resources_from_urdf(urdf_to_test);
+  ASSERT_THAT(control_hardware, SizeIs(control_hardware_from_string.size()));
+  for (size_t i = 0; i < control_hardware.size(); ++i) {
+    EXPECT_EQ(control_hardware_from_string[i].name, control_hardware[i].name);
+    EXPECT_EQ(control_hardware_from_string[i].type, control_hardware[i].type);
+    EXPECT_EQ(
+      control_hardware_from_string[i].hardware_parameters,
+      control_hardware[i].hardware_parameters);
+    ASSERT_THAT(control_hardware[i].joints, SizeIs(control_hardware_from_string[i].joints.size()));
+    for (size_t j = 0; j < control_hardware[i].joints.size(); ++j) {
+      EXPECT_EQ(control_hardware_from_string[i].joints[j].name, control_hardware[i].joints[j].name);
+      EXPECT_EQ(
+        control_hardware_from_string[i].joints[j].parameters,
+        control_hardware[i].joints[j].parameters);
+    }
+  }
+  EXPECT_THAT(parse_control_resources_from_urdf(urdf), SizeIs(4));
+}
+
+TEST_F(TestComponentParser, invalid_urdf_document_throws_error)
+{
+  EXPECT_THROW(hardware_interface::URDFDocument(""), std::runtime_error);
+  EXPECT_THROW(hardware_interface::URDFDocument("<robot><joint></robot>"), std::runtime_error);
+}
+
+TEST_F(TestComponentParser, scanned_urdf_document_has_only_the_relevant_elements)
+{
+  const std::string urdf_to_test = urdf_xml_head_ +
+    valid_urdf_ros2_control_actuator_modular_robot_sensors_ + urdf_xml_tail_;
+  const hardware_interface::URDFDocument urdf(
+    urdf_to_test, hardware_interface::URDFDocument::ScanMode::RELEVANT_ELEMENTS);
+  std::istringstream stream(urdf_to_test);
+  const hardware_interface::URDFDocument streamed_urdf(stream);
+
+  for (const auto * document : {&urdf, &streamed_urdf}) {
+    ASSERT_NE(nullptr, document->get_root_element());
+    EXPECT_STREQ("robot", document->get_root_element()->Name());
+    EXPECT_STREQ("MinimalRobot", document->get_root_element()->Attribute("name"));
+    EXPECT_EQ(nullptr, document->get_root_element()->FirstChildElement("link"));
+    EXPECT_THAT(document->get_ros2_control_elements(), SizeIs(4));
+    EXPECT_THAT(document->get_joint_elements(), SizeIs(4));
+    ASSERT_NE(nullptr, document->find_joint_element("joint1"));
+    EXPECT_STREQ("revolute", document->find_joint_element("joint1")->Attribute("type"));
+
+    const auto control_hardware = parse_control_resources_from_urdf(*document);
+    const auto control_hardware_from_string = parse_control_resources_from_urdf(urdf_to_test);
+    ASSERT_THAT(control_hardware, SizeIs(control_hardware_from_string.size()));
+    for (size_t i = 0; i < control_hardware.size(); ++i) {
+      EXPECT_EQ(control_hardware_from_string[i].name, control_hardware[i].name);
+      EXPECT_EQ(
+        control_hardware_from_string[i].hardware_parameters,
+        control_hardware[i].hardware_parameters);
+      EXPECT_THAT(
+        control_hardware[i].sensors, SizeIs(control_hardware_from_string[i].sensors.size()));
+    }
+  }
+}
+
+TEST_F(TestComponentParser, scanner_skips_comments_data_and_quoted_brackets)
+{
+  const std::string urdf_to_test =
+    R"(<?xml version="1.0"?>
+<!-- <ros2_control name="commented_out"> -->
+<robot name="ScannedRobot">
+  <link name="base_link">
+    <visual><geometry><mesh filename="meshes/base>link.stl" scale='1 1 1'/></geometry></visual>
+  </link>
+  <gazebo><![CDATA[ <joint name="in_data"/> ]]></gazebo>
+  <joint name="joint1" type="revolute">
+    <!-- </joint> -->
+    <limit lower="-1" upper="1.5" effort="3" velocity="0.2"/>
+  </joint>
+  <joint name="joint2" type="fixed"/>
+</robot>
+)";
+  const hardware_interface::URDFDocument urdf(
+    urdf_to_test, hardware_interface::URDFDocument::ScanMode::RELEVANT_ELEMENTS);
+  EXPECT_THAT(urdf.get_ros2_control_elements(), IsEmpty());
+  ASSERT_THAT(urdf.get_joint_elements(), SizeIs(2));
+  ASSERT_NE(nullptr, urdf.find_joint_element("joint1"));
+  ASSERT_NE(nullptr, urdf.find_joint_element("joint1")->FirstChildElement("limit"));
+  EXPECT_STREQ("1.5", urdf.find_joint_element("joint1")->FirstChildElement("limit")->Attribute(
+      "upper"));
+  EXPECT_NE(nullptr, urdf.find_joint_element("joint2"));
+  EXPECT_EQ(nullptr, urdf.find_joint_element("in_data"));
+
+  const auto scan = hardware_interface::URDFDocument::ScanMode::RELEVANT_ELEMENTS;
+  EXPECT_THROW(hardware_interface::URDFDocument("", scan), std::runtime_error);
+  EXPECT_THROW(hardware_interface::URDFDocument("<!-- -->", scan), std::runtime_error);
+  EXPECT_THROW(hardware_interface::URDFDocument("<robot><link>", scan), std::runtime_error);
+  EXPECT_THROW(
+    hardware_interface::URDFDocument("<robot><joint></robot>", scan), std::runtime_error);
+}
+
+TEST_F(TestComponentParser, parses_the_parameters_declared_by_the_hardware_schemas)
+{
+  const std::string urdf_to_test = urdf_xml_head_ +
+    valid_urdf_ros2_control_system_one_interface_ + urdf_xml_tail_;
+  const hardware_interface::URDFDocument urdf(urdf_to_test);
+
+  std::unordered_map<std::string, hardware_interface::HardwareParameterSchema> schemas;
+  auto & schema = schemas["ros2_control_demo_hardware/2DOF_System_Hardware_Position_Only"];
+  const auto write_for_sec =
+    schema.hardware_parameters.declare<double>("example_param_write_for_sec");
+  const auto read_for_sec =
+    schema.hardware_parameters.declare<int64_t>("example_param_read_for_sec");
+  const auto max_position = schema.joint_parameters.declare<double>("max_position_value");
+  const auto control_hardware = parse_control_resources_from_urdf(urdf, schemas);
+  ASSERT_THAT(control_hardware, SizeIs(1));
+  const auto & hardware_info = control_hardware.front();
+  EXPECT_EQ(hardware_info.typed_hardware_parameters.get(write_for_sec), 2.0);
+  EXPECT_EQ(hardware_info.typed_hardware_parameters.get(read_for_sec), 2);
+  ASSERT_THAT(hardware_info.joints, SizeIs(2));
+  EXPECT_EQ(hardware_info.joints[1].typed_parameters.get(max_position), 1.0);
+  // the text is kept along with the values
+  EXPECT_EQ(hardware_info.hardware_parameters.at("example_param_write_for_sec"), "2");
+
+  // the errors are reported when the description is parsed, not when the hardware reads them
+  schema.joint_parameters.declare<bool>("min_position_value");
+  EXPECT_THROW(parse_control_resources_from_urdf(urdf, schemas), std::runtime_error);
+}
@@ -0,0 +1,98 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <string>
+#include <vector>
+
+#include "hardware_interface/control_resources_diff.hpp"
+
+using namespace ::testing;  // NOLINT
+using hardware_interface::HardwareInfo;
+using hardware_interface::diff_control_resources;
+
+namespace
+{
+HardwareInfo make_actuator(const std::string & name, const std::string & joint_name)
+{
+  HardwareInfo info;
+  info.name = name;
+  info.type = "actuator";
+  info.hardware_class_type = "ros2_control_demo_hardware/Position_Actuator_Hadware";
+  info.hardware_parameters["example_param_write_for_sec"] = "1.23";
+  hardware_interface::components::ComponentInfo joint;
+  joint.name = joint_name;
+  joint.type = "joint";
+  joint.class_type = "ros2_control_components/PositionJoint";
+  joint.command_interfaces = {"position"};
+  info.joints.push_back(joint);
+  return info;
+}
+
+std::vector<HardwareInfo> make_robot()
+{
+  HardwareInfo sensor;
+  sensor.name = "2DOF_System_Robot_Sensor";
+  sensor.type = "sensor";
+  sensor.hardware_class_type = "ros2_control_demo_hardware/2D_Sensor_Force_Torque";
+  hardware_interface::components::ComponentInfo tcp_sensor;
+  tcp_sensor.name = "tcp_fts_sensor";
+  tcp_sensor.type = "sensor";
+  tcp_sensor.class_type = "ros2_control_components/ForceTorqueSensor";
+  tcp_sensor.state_interfaces = {"fx", "tz"};
+  sensor.sensors.push_back(tcp_sensor);
+  return {make_actuator("joint1_actuator", "joint1"), make_actuator("joint2_actuator", "joint2"),
+    sensor};
+}
+}  // namespace
+
+TEST(TestControlResourcesDiff, same_resources_are_unchanged)
+{
+  const auto current = make_robot();
+  const auto diff = diff_control_resources(current, current);
+  EXPECT_THAT(
+    diff.unchanged,
+    ElementsAre("joint1_actuator", "joint2_actuator", "2DOF_System_Robot_Sensor"));
+  EXPECT_THAT(diff.changed, IsEmpty());
+  EXPECT_THAT(diff.added, IsEmpty());
+  EXPECT_THAT(diff.removed, IsEmpty());
+
+  // the typed parameters follow the text ones
+  auto updated = current;
+  updated[0].typed_hardware_parameters = hardware_interface::TypedParameters();
+  EXPECT_THAT(diff_control_resources(current, updated).unchanged, SizeIs(3));
+}
+
+TEST(TestControlResourcesDiff, finds_the_changed_added_and_removed_hardware)
+{
+  const auto current = make_robot();
+  auto updated = current;
+  // one parameter of the first actuator, a sensor for the second one, no more sensor hardware
+  updated[0].hardware_parameters["example_param_write_for_sec"] = "2";
+  updated[1].sensors.push_back(updated[2].sensors.front());
+  updated.pop_back();
+  updated.push_back(make_actuator("joint3_actuator", "joint3"));
+
+  const auto diff = diff_control_resources(current, updated);
+  EXPECT_THAT(diff.changed, ElementsAre("joint1_actuator", "joint2_actuator"));
+  EXPECT_THAT(diff.unchanged, IsEmpty());
+  EXPECT_THAT(diff.added, ElementsAre("joint3_actuator"));
+  EXPECT_THAT(diff.removed, ElementsAre("2DOF_System_Robot_Sensor"));
+
+  // an interface of a joint
+  updated = current;
+  updated[1].joints[0].state_interfaces.push_back("position");
+  EXPECT_THAT(diff_control_resources(current, updated).changed, ElementsAre("joint2_actuator"));
+}
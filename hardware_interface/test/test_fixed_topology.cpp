@@ -0,0 +1,122 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "hardware_interface/fixed_system_adapter.hpp"
+#include "hardware_interface/fixed_topology.hpp"
+#include "hardware_interface/robot_hardware.hpp"
+#include "hardware_interface/types/hardware_interface_type_values.hpp"
+
+namespace hw = hardware_interface;
+namespace fixed = hardware_interface::fixed;
+
+namespace
+{
+class DummyRobotHardware : public hw::RobotHardware
+{
+  hw::return_type init() override {return hw::return_type::OK;}
+  hw::return_type read() override {return hw::return_type::OK;}
+  hw::return_type write() override {return hw::return_type::OK;}
+};
+
+using ArmJoint = fixed::FixedJoint<
+  fixed::Position, fixed::Velocity, fixed::PositionCommand, fixed::Effort>;
+using Arm = fixed::FixedSystem<2, ArmJoint>;
+
+// the layout is resolved at compile time
+static_assert(ArmJoint::state_count == 3, "three states");
+static_assert(ArmJoint::command_count == 1, "one command");
+static_assert(ArmJoint::offset<fixed::Effort>() == 2, "effort is the third state");
+static_assert(ArmJoint::offset<fixed::PositionCommand>() == 0, "the first command");
+static_assert(Arm::offset<fixed::Velocity>(1) == 4, "velocity of the second joint");
+static_assert(Arm::offset<fixed::PositionCommand>(1) == 1, "command of the second joint");
+static_assert(!ArmJoint::has_interface<fixed::EffortCommand>(), "no effort command");
+}  // namespace
+
+TEST(TestFixedTopology, stores_the_values_at_their_constant_offsets)
+{
+  Arm arm({"joint1", "joint2"});
+  arm.set<1, fixed::Velocity>(0.5);
+  arm.set<fixed::Effort>(0, 2.0);
+  arm.set<0, fixed::PositionCommand>(-1.0);
+  EXPECT_EQ(0.5, arm.get<fixed::Velocity>(1));
+  EXPECT_EQ(2.0, (arm.get<0, fixed::Effort>()));
+  EXPECT_THAT(arm.get_state_values(), testing::ElementsAre(0.0, 0.0, 2.0, 0.0, 0.5, 0.0));
+  EXPECT_THAT(arm.get_command_values(), testing::ElementsAre(-1.0, 0.0));
+}
+
+TEST(TestFixedTopology, exchanges_the_values_with_the_registry)
+{
+  DummyRobotHardware hardware;
+  Arm arm({"joint1", "joint2"});
+  arm.set<1, fixed::Position>(0.25);
+  fixed::FixedSystemAdapter<Arm> adapter;
+  ASSERT_EQ(hw::return_type::ERROR, adapter.bind(arm, hardware));
+  ASSERT_EQ(hw::return_type::OK, fixed::FixedSystemAdapter<Arm>::register_joints(arm, hardware));
+  ASSERT_EQ(hw::return_type::OK, hardware.freeze_registration());
+  ASSERT_EQ(hw::return_type::OK, adapter.bind(arm, hardware));
+  EXPECT_TRUE(adapter.is_bound());
+  // registered together, copied at once
+  EXPECT_TRUE(adapter.is_contiguous());
+
+  // the registered joints start from the values of the system
+  hw::JointHandle position("joint2", hw::HW_IF_POSITION);
+  ASSERT_EQ(hw::return_type::OK, hardware.get_joint_handle(position));
+  EXPECT_EQ(0.25, position.get_value());
+
+  // the hardware read
+  arm.set<0, fixed::Effort>(3.0);
+  adapter.export_states(arm);
+  hw::JointHandle effort("joint1", hw::HW_IF_EFFORT);
+  ASSERT_EQ(hw::return_type::OK, hardware.get_joint_handle(effort));
+  EXPECT_EQ(3.0, effort.get_value());
+
+  // a controller commands, the commands are published at the end of the update
+  hw::JointHandle command("joint2", hw::HW_IF_POSITION_COMMAND);
+  ASSERT_EQ(hw::return_type::OK, hardware.get_joint_handle(command));
+  command.set_value(1.5);
+  adapter.import_commands(arm);
+  EXPECT_EQ(0.0, arm.get<fixed::PositionCommand>(1));
+  hardware.publish_commands();
+  adapter.import_commands(arm);
+  EXPECT_EQ(1.5, arm.get<fixed::PositionCommand>(1));
+}
+
+TEST(TestFixedTopology, gathers_the_values_registered_apart)
+{
+  DummyRobotHardware hardware;
+  Arm arm({"joint1", "joint2"});
+  ASSERT_EQ(hw::return_type::OK, hardware.register_joint("gripper", hw::HW_IF_POSITION));
+  ASSERT_EQ(hw::return_type::OK, fixed::FixedSystemAdapter<Arm>::register_joints(arm, hardware));
+  // laid out in between the states of the two joints of the system
+  ASSERT_EQ(hw::return_type::OK, hardware.register_joint("joint1", "temperature"));
+  ASSERT_EQ(hw::return_type::OK, hardware.freeze_registration());
+  fixed::FixedSystemAdapter<Arm> adapter;
+  ASSERT_EQ(hw::return_type::OK, adapter.bind(arm, hardware));
+  EXPECT_FALSE(adapter.is_contiguous());
+
+  arm.set<1, fixed::Velocity>(-0.5);
+  adapter.export_states(arm);
+  hw::JointHandle velocity("joint2", hw::HW_IF_VELOCITY);
+  ASSERT_EQ(hw::return_type::OK, hardware.get_joint_handle(velocity));
+  EXPECT_EQ(-0.5, velocity.get_value());
+  hw::JointHandle temperature("joint1", "temperature");
+  ASSERT_EQ(hw::return_type::OK, hardware.get_joint_handle(temperature));
+  EXPECT_EQ(0.0, temperature.get_value());
+}
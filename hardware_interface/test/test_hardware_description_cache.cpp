@@ -0,0 +1,255 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "hardware_interface/component_parser.hpp"
+#include "hardware_interface/hardware_description_cache.hpp"
+
+using namespace ::testing;  // NOLINT
+using hardware_interface::HardwareInfo;
+using hardware_interface::components::ComponentInfo;
+
+namespace
+{
+void expect_same_components(
+  const std::vector<ComponentInfo> & expected, const std::vector<ComponentInfo> & actual)
+{
+  ASSERT_THAT(actual, SizeIs(expected.size()));
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(expected[i].name, actual[i].name);
+    EXPECT_EQ(expected[i].type, actual[i].type);
+    EXPECT_EQ(expected[i].class_type, actual[i].class_type);
+    EXPECT_EQ(expected[i].command_interfaces, actual[i].command_interfaces);
+    EXPECT_EQ(expected[i].state_interfaces, actual[i].state_interfaces);
+    EXPECT_EQ(expected[i].parameters, actual[i].parameters);
+  }
+}
+
+void expect_same_hardware(
+  const std::vector<HardwareInfo> & expected, const std::vector<HardwareInfo> & actual)
+{
+  ASSERT_THAT(actual, SizeIs(expected.size()));
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(expected[i].name, actual[i].name);
+    EXPECT_EQ(expected[i].type, actual[i].type);
+    EXPECT_EQ(expected[i].hardware_class_type, actual[i].hardware_class_type);
+    EXPECT_EQ(expected[i].hardware_parameters, actual[i].hardware_parameters);
+    expect_same_components(expected[i].joints, actual[i].joints);
+    expect_same_components(expected[i].sensors, actual[i].sensors);
+    expect_same_components(expected[i].transmissions, actual[i].transmissions);
+  }
+}
+}  // namespace
+
+class TestHardwareDescriptionCache : public Test
+{
+protected:
+  void SetUp() override
+  {
+    urdf_ =
+      R"(
+<?xml version="1.0" encoding="utf-8"?>
+<robot name="MinimalRobot">
+  <link name="base_link"/>
+  <ros2_control name="2DOF_System_Robot" type="system">
+    <hardware>
+      <classType>ros2_control_demo_hardware/2DOF_System_Hardware</classType>
+      <param name="example_param_write_for_sec">2</param>
+      <param name="example_param_read_for_sec">2</param>
+    </hardware>
+    <joint name="joint1">
+      <classType>ros2_control_components/PositionJoint</classType>
+      <commandInterfaceType>position</commandInterfaceType>
+      <commandInterfaceType>velocity</commandInterfaceType>
+      <stateInterfaceType>position</stateInterfaceType>
+      <param name="min_position_value">-1</param>
+      <param name="max_position_value">1</param>
+    </joint>
+    <sensor name="sensor1">
+      <classType>ros2_control_components/ForceTorqueSensor</classType>
+      <stateInterfaceType>force</stateInterfaceType>
+    </sensor>
+    <transmission name="transmission1">
+      <classType>transmission_interface/SimpleTansmission</classType>
+      <param name="joint_to_actuator">${1024/PI}</param>
+    </transmission>
+  </ros2_control>
+  <ros2_control name="Empty_Sensor" type="sensor">
+    <hardware>
+      <classType>ros2_control_demo_hardware/Empty_Sensor</classType>
+    </hardware>
+  </ros2_control>
+</robot>
+)";
+    cache_path_ = TempDir() + "test_hardware_description_cache_" + std::to_string(getpid());
+    std::remove(cache_path_.c_str());
+  }
+
+  void TearDown() override
+  {
+    std::remove(cache_path_.c_str());
+  }
+
+  std::string read_file()
+  {
+    std::ifstream file(cache_path_, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+
+  void write_file(const std::string & content)
+  {
+    std::ofstream file(cache_path_, std::ios::binary | std::ios::trunc);
+    file << content;
+  }
+
+  std::string urdf_;
+  std::string cache_path_;
+};
+
+TEST_F(TestHardwareDescriptionCache, hash_depends_on_the_whole_urdf)
+{
+  EXPECT_EQ(hardware_interface::hash_urdf(urdf_), hardware_interface::hash_urdf(urdf_));
+  EXPECT_NE(hardware_interface::hash_urdf(urdf_), hardware_interface::hash_urdf(urdf_ + " "));
+}
+
+TEST_F(TestHardwareDescriptionCache, round_trip)
+{
+  const auto hardware_info = hardware_interface::parse_control_resources_from_urdf(urdf_);
+  const auto urdf_hash = hardware_interface::hash_urdf(urdf_);
+  ASSERT_TRUE(
+    hardware_interface::write_hardware_description_cache(cache_path_, urdf_hash, hardware_info));
+
+  std::vector<HardwareInfo> cached_hardware_info;
+  ASSERT_TRUE(
+    hardware_interface::read_hardware_description_cache(
+      cache_path_, urdf_hash, cached_hardware_info));
+  expect_same_hardware(hardware_info, cached_hardware_info);
+}
+
+TEST_F(TestHardwareDescriptionCache, rejects_stale_and_corrupt_files)
+{
+  const auto hardware_info = hardware_interface::parse_control_resources_from_urdf(urdf_);
+  const auto urdf_hash = hardware_interface::hash_urdf(urdf_);
+  std::vector<HardwareInfo> cached_hardware_info(1);
+  cached_hardware_info[0].name = "untouched";
+
+  // missing file
+  EXPECT_FALSE(
+    hardware_interface::read_hardware_description_cache(
+      cache_path_, urdf_hash, cached_hardware_info));
+
+  // written for another URDF
+  ASSERT_TRUE(
+    hardware_interface::write_hardware_description_cache(cache_path_, urdf_hash, hardware_info));
+  EXPECT_FALSE(
+    hardware_interface::read_hardware_description_cache(
+      cache_path_, urdf_hash + 1, cached_hardware_info));
+
+  // truncated
+  const auto content = read_file();
+  write_file(content.substr(0, content.size() - 1));
+  EXPECT_FALSE(
+    hardware_interface::read_hardware_description_cache(
+      cache_path_, urdf_hash, cached_hardware_info));
+
+  // corrupted payload
+  auto corrupted_content = content;
+  corrupted_content[sizeof(hardware_interface::HardwareDescriptionCacheHeader) + 4] ^= 1;
+  write_file(corrupted_content);
+  EXPECT_FALSE(
+    hardware_interface::read_hardware_description_cache(
+      cache_path_, urdf_hash, cached_hardware_info));
+
+  // not a cache file
+  write_file(urdf_);
+  EXPECT_FALSE(
+    hardware_interface::read_hardware_description_cache(
+      cache_path_, urdf_hash, cached_hardware_info));
+
+  ASSERT_THAT(cached_hardware_info, SizeIs(1));
+  EXPECT_EQ("untouched", cached_hardware_info[0].name);
+
+  // the intact file is still accepted
+  write_file(content);
+  EXPECT_TRUE(
+    hardware_interface::read_hardware_description_cache(
+      cache_path_, urdf_hash, cached_hardware_info));
+}
+
+TEST_F(TestHardwareDescriptionCache, load_parses_only_on_cache_miss)
+{
+  // the first load parses the URDF and fills the cache
+  const auto hardware_info = hardware_interface::load_control_resources_from_urdf(
+    urdf_, cache_path_);
+  expect_same_hardware(
+    hardware_interface::parse_control_resources_from_urdf(urdf_), hardware_info);
+  std::vector<HardwareInfo> cached_hardware_info;
+  ASSERT_TRUE(
+    hardware_interface::read_hardware_description_cache(
+      cache_path_, hardware_interface::hash_urdf(urdf_), cached_hardware_info));
+  expect_same_hardware(hardware_info, cached_hardware_info);
+
+  // later loads use the cache instead of the URDF
+  cached_hardware_info[0].name = "from_cache";
+  ASSERT_TRUE(
+    hardware_interface::write_hardware_description_cache(
+      cache_path_, hardware_interface::hash_urdf(urdf_), cached_hardware_info));
+  EXPECT_EQ(
+    "from_cache",
+    hardware_interface::load_control_resources_from_urdf(urdf_, cache_path_)[0].name);
+
+  // a changed URDF is parsed again and replaces the cache
+  const std::string changed_urdf = urdf_ + "\n";
+  EXPECT_EQ(
+    "2DOF_System_Robot",
+    hardware_interface::load_control_resources_from_urdf(changed_urdf, cache_path_)[0].name);
+  EXPECT_FALSE(
+    hardware_interface::read_hardware_description_cache(
+      cache_path_, hardware_interface::hash_urdf(urdf_), cached_hardware_info));
+  EXPECT_THROW(
+    hardware_interface::load_control_resources_from_urdf("<robot/>", cache_path_),
+    std::runtime_error);
+}
+
+TEST_F(TestHardwareDescriptionCache, load_converts_the_typed_parameters_of_the_cached_hardware)
+{
+  std::unordered_map<std::string, hardware_interface::HardwareParameterSchema> schemas;
+  auto & schema = schemas["ros2_control_demo_hardware/2DOF_System_Hardware"];
+  const auto write_for_sec =
+    schema.hardware_parameters.declare<double>("example_param_write_for_sec");
+  const auto max_position = schema.joint_parameters.declare<double>("max_position_value");
+
+  // on a miss, then on a hit
+  for (int i = 0; i < 2; ++i) {
+    const auto hardware_info =
+      hardware_interface::load_control_resources_from_urdf(urdf_, cache_path_, schemas);
+    ASSERT_THAT(hardware_info, SizeIs(2));
+    EXPECT_EQ(2.0, hardware_info[0].typed_hardware_parameters.get(write_for_sec));
+    EXPECT_EQ(1.0, hardware_info[0].joints[0].typed_parameters.get(max_position));
+    EXPECT_TRUE(hardware_info[1].typed_hardware_parameters.empty());
+  }
+  std::vector<HardwareInfo> cached_hardware_info;
+  EXPECT_TRUE(
+    hardware_interface::read_hardware_description_cache(
+      cache_path_, hardware_interface::hash_urdf(urdf_), cached_hardware_info));
+}
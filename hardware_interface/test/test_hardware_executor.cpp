@@ -0,0 +1,165 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hardware_interface/hardware_executor.hpp"
+
+using hardware_interface::HardwareExecutor;
+using hardware_interface::return_type;
+
+namespace
+{
+/// Lets calls through only once count calls are waiting, i.e. if they run concurrently.
+class Rendezvous
+{
+public:
+  explicit Rendezvous(size_t count)
+  : count_(count)
+  {
+  }
+
+  return_type arrive()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++arrived_;
+    cv_.notify_all();
+    const bool all_arrived = cv_.wait_for(
+      lock, std::chrono::seconds(5), [this] {return arrived_ % count_ == 0;});
+    return all_arrived ? return_type::OK : return_type::ERROR;
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  size_t count_;
+  size_t arrived_ = 0;
+};
+}  // namespace
+
+TEST(TestHardwareExecutor, runs_serially_until_started)
+{
+  HardwareExecutor executor;
+  std::vector<std::string> calls;
+  for (const auto & name : {"arm", "gripper"}) {
+    const std::string hardware(name);
+    EXPECT_EQ(
+      executor.add_hardware(
+        hardware,
+        [&calls, hardware] {calls.push_back(hardware + "_read"); return return_type::OK;},
+        [&calls, hardware] {calls.push_back(hardware + "_write"); return return_type::OK;}),
+      return_type::OK);
+  }
+
+  EXPECT_FALSE(executor.is_started());
+  EXPECT_EQ(executor.read(), return_type::OK);
+  EXPECT_EQ(executor.write(), return_type::OK);
+  EXPECT_THAT(
+    calls, testing::ElementsAre("arm_read", "gripper_read", "arm_write", "gripper_write"));
+}
+
+TEST(TestHardwareExecutor, reads_and_writes_in_parallel)
+{
+  constexpr size_t kHardwareCount = 3;
+  HardwareExecutor executor;
+  Rendezvous read_rendezvous(kHardwareCount);
+  Rendezvous write_rendezvous(kHardwareCount);
+  for (size_t i = 0; i < kHardwareCount; ++i) {
+    EXPECT_EQ(
+      executor.add_hardware(
+        "hardware" + std::to_string(i),
+        [&read_rendezvous] {return read_rendezvous.arrive();},
+        [&write_rendezvous] {return write_rendezvous.arrive();}),
+      return_type::OK);
+  }
+
+  ASSERT_EQ(executor.start(), return_type::OK);
+  EXPECT_TRUE(executor.is_started());
+  EXPECT_EQ(executor.start(), return_type::ERROR);
+  EXPECT_EQ(executor.add_hardware("late", nullptr, nullptr), return_type::ERROR);
+  for (int cycle = 0; cycle < 10; ++cycle) {
+    EXPECT_EQ(executor.read(), return_type::OK);
+    EXPECT_EQ(executor.write(), return_type::OK);
+  }
+  executor.stop();
+  EXPECT_FALSE(executor.is_started());
+}
+
+TEST(TestHardwareExecutor, overlaps_read_with_other_work)
+{
+  HardwareExecutor executor;
+  std::atomic<bool> compute_done(false);
+  std::atomic<bool> read_saw_compute(false);
+  EXPECT_EQ(
+    executor.add_hardware(
+      "sensor",
+      [&] {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!compute_done && std::chrono::steady_clock::now() < deadline) {
+          std::this_thread::yield();
+        }
+        read_saw_compute = compute_done.load();
+        return return_type::OK;
+      },
+      nullptr),
+    return_type::OK);
+  ASSERT_EQ(executor.start(), return_type::OK);
+
+  EXPECT_EQ(executor.begin_read(), return_type::OK);
+  EXPECT_EQ(executor.begin_write(), return_type::ERROR);
+  EXPECT_EQ(executor.end_write(), return_type::ERROR);
+  // the read is still running while the calling thread computes
+  compute_done = true;
+  EXPECT_EQ(executor.end_read(), return_type::OK);
+  EXPECT_TRUE(read_saw_compute);
+}
+
+TEST(TestHardwareExecutor, reports_errors_and_timings)
+{
+  HardwareExecutor executor;
+  EXPECT_EQ(
+    executor.add_hardware(
+      "slow",
+      [] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        return return_type::OK;
+      },
+      [] {return return_type::OK;}),
+    return_type::OK);
+  EXPECT_EQ(
+    executor.add_hardware(
+      "broken", [] {return return_type::CAN_NOT_READ;}, [] {return return_type::OK;}, 0),
+    return_type::OK);
+  ASSERT_EQ(executor.start(), return_type::OK);
+
+  EXPECT_EQ(executor.read(), return_type::CAN_NOT_READ);
+  EXPECT_EQ(executor.write(), return_type::OK);
+
+  const auto & timings = executor.get_timings();
+  ASSERT_EQ(timings.size(), 2u);
+  EXPECT_EQ(timings[0].name, "slow");
+  EXPECT_GE(timings[0].last_read_duration, std::chrono::milliseconds(2));
+  EXPECT_GE(timings[0].max_read_duration, timings[0].last_read_duration);
+  EXPECT_EQ(timings[1].name, "broken");
+  EXPECT_LT(timings[1].last_read_duration, timings[0].last_read_duration);
+}
@@ -0,0 +1,155 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "hardware_interface/actuator_hardware.hpp"
+#include "hardware_interface/actuator_hardware_interface.hpp"
+#include "hardware_interface/hardware_freshness.hpp"
+
+using hardware_interface::ActuatorHardware;
+using hardware_interface::ActuatorHardwareInterface;
+using hardware_interface::HardwareFreshness;
+using hardware_interface::HardwareInfo;
+using hardware_interface::return_type;
+using hardware_interface::status;
+using hardware_interface::components::Joint;
+using std::chrono::milliseconds;
+
+namespace
+{
+/// Reports OK from read_joint while read_result says so, as a driver missing frames would not.
+class FlakyActuator : public ActuatorHardwareInterface
+{
+public:
+  explicit FlakyActuator(return_type & read_result)
+  : read_result_(read_result) {}
+
+  return_type configure(const HardwareInfo &) override {return return_type::OK;}
+  return_type start() override {status_ = status::STARTED; return return_type::OK;}
+  return_type stop() override {status_ = status::STOPPED; return return_type::OK;}
+  status get_status() const override {return status_;}
+  return_type read_joint(std::shared_ptr<Joint>) const override {return read_result_;}
+  return_type write_joint(const std::shared_ptr<Joint>) override {return return_type::OK;}
+
+private:
+  return_type & read_result_;
+  status status_ = status::CONFIGURED;
+};
+
+constexpr int64_t kMs = 1000000;
+}  // namespace
+
+TEST(TestHardwareFreshness, flags_the_components_read_too_long_ago)
+{
+  HardwareFreshness freshness;
+  size_t arm = 0, gripper = 0, camera = 0;
+  ASSERT_EQ(return_type::OK, freshness.add_component("arm", {"joint1"}, milliseconds(10), arm));
+  ASSERT_EQ(
+    return_type::OK, freshness.add_component("gripper", {"joint2"}, milliseconds(5), gripper));
+  // never stale, without a threshold
+  ASSERT_EQ(
+    return_type::OK,
+    freshness.add_component("camera", {"camera"}, std::chrono::nanoseconds(0), camera));
+  EXPECT_EQ(3u, freshness.get_component_count());
+  EXPECT_EQ("gripper", freshness.get_component_name(gripper));
+  EXPECT_EQ(milliseconds(5), freshness.get_staleness_threshold(gripper));
+
+  // fresh until the first update, stale until the first read
+  EXPECT_TRUE(freshness.is_fresh());
+  EXPECT_EQ(
+    HardwareFreshness::get_component_mask(arm) | HardwareFreshness::get_component_mask(gripper),
+    freshness.update(100 * kMs));
+  EXPECT_FALSE(freshness.is_fresh());
+  EXPECT_TRUE(freshness.is_fresh(HardwareFreshness::get_component_mask(camera)));
+
+  freshness.record_read(arm, 100 * kMs);
+  freshness.record_read(gripper, 100 * kMs);
+  EXPECT_EQ(100 * kMs, freshness.get_last_read_time_ns(arm));
+  EXPECT_EQ(0u, freshness.update(105 * kMs));
+  EXPECT_TRUE(freshness.is_fresh());
+
+  // the flags only change on update
+  EXPECT_EQ(HardwareFreshness::get_component_mask(gripper), freshness.update(106 * kMs));
+  EXPECT_TRUE(freshness.is_fresh(HardwareFreshness::get_component_mask(arm)));
+  EXPECT_FALSE(freshness.is_fresh(HardwareFreshness::get_component_mask(gripper)));
+  freshness.record_read(gripper, 106 * kMs);
+  EXPECT_FALSE(freshness.is_fresh(HardwareFreshness::get_component_mask(gripper)));
+  EXPECT_EQ(0u, freshness.update(107 * kMs));
+  EXPECT_EQ(HardwareFreshness::get_component_mask(arm), freshness.update(111 * kMs));
+  EXPECT_EQ(HardwareFreshness::get_component_mask(arm), freshness.get_stale_components());
+}
+
+TEST(TestHardwareFreshness, resolves_the_components_of_joints)
+{
+  HardwareFreshness freshness;
+  size_t arm = 0, base = 0;
+  ASSERT_EQ(
+    return_type::OK, freshness.add_component("arm", {"joint1", "joint2"}, milliseconds(1), arm));
+  ASSERT_EQ(
+    return_type::OK, freshness.add_component("base", {"wheel1", "wheel2"}, milliseconds(1), base));
+  EXPECT_EQ(
+    HardwareFreshness::get_component_mask(arm),
+    freshness.get_joint_component_mask({"joint2", "unknown"}));
+  EXPECT_EQ(
+    HardwareFreshness::get_component_mask(arm) | HardwareFreshness::get_component_mask(base),
+    freshness.get_joint_component_mask({"wheel1", "joint1"}));
+  EXPECT_EQ(0u, freshness.get_joint_component_mask({"unknown"}));
+
+  size_t component = 0;
+  EXPECT_EQ(return_type::ERROR, freshness.add_component("arm", {}, milliseconds(1), component));
+  for (size_t i = freshness.get_component_count(); i < HardwareFreshness::MAX_COMPONENTS; ++i) {
+    ASSERT_EQ(
+      return_type::OK,
+      freshness.add_component("hardware" + std::to_string(i), {}, milliseconds(1), component));
+    EXPECT_EQ(i, component);
+  }
+  EXPECT_EQ(
+    return_type::ERROR, freshness.add_component("one too many", {}, milliseconds(1), component));
+}
+
+TEST(TestHardwareFreshness, components_record_their_successful_reads)
+{
+  auto freshness = std::make_shared<HardwareFreshness>();
+  size_t component = 0;
+  ASSERT_EQ(
+    return_type::OK, freshness->add_component("actuator", {"joint1"}, milliseconds(50), component));
+  return_type read_result = return_type::OK;
+  ActuatorHardware actuator(std::make_unique<FlakyActuator>(read_result));
+  actuator.set_freshness(freshness, component);
+  ASSERT_EQ(return_type::OK, actuator.start());
+
+  ASSERT_EQ(return_type::OK, actuator.read_joint(nullptr));
+  const auto last_read_ns = freshness->get_last_read_time_ns(component);
+  EXPECT_NE(0, last_read_ns);
+  EXPECT_EQ(0u, freshness->update());
+  EXPECT_EQ(status::STARTED, actuator.get_status());
+
+  // the failed reads are not recorded
+  read_result = return_type::ERROR;
+  EXPECT_EQ(return_type::ERROR, actuator.read_joint(nullptr));
+  EXPECT_EQ(last_read_ns, freshness->get_last_read_time_ns(component));
+  EXPECT_NE(0u, freshness->update(last_read_ns + 51 * kMs));
+  EXPECT_EQ(status::TIMED_OUT, actuator.get_status());
+
+  // only a started component times out
+  ASSERT_EQ(return_type::OK, actuator.stop());
+  EXPECT_EQ(status::STOPPED, actuator.get_status());
+}
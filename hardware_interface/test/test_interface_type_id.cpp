@@ -0,0 +1,83 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hardware_interface/interface_type_id.hpp"
+#include "hardware_interface/types/hardware_interface_type_values.hpp"
+
+namespace hw = hardware_interface;
+
+TEST(TestInterfaceTypeId, standard_types_are_pre_interned)
+{
+  EXPECT_EQ(hw::HW_IF_POSITION_ID, hw::InterfaceTypeId::intern(hw::HW_IF_POSITION));
+  EXPECT_EQ(hw::HW_IF_VELOCITY_ID, hw::InterfaceTypeId::intern(hw::HW_IF_VELOCITY));
+  EXPECT_EQ(hw::HW_IF_EFFORT_ID, hw::InterfaceTypeId::intern(hw::HW_IF_EFFORT));
+  EXPECT_EQ(
+    hw::HW_IF_POSITION_COMMAND_ID, hw::InterfaceTypeId::intern(hw::HW_IF_POSITION_COMMAND));
+  EXPECT_EQ(
+    hw::HW_IF_VELOCITY_COMMAND_ID, hw::InterfaceTypeId::intern(hw::HW_IF_VELOCITY_COMMAND));
+  EXPECT_EQ(hw::HW_IF_EFFORT_COMMAND_ID, hw::InterfaceTypeId::intern(hw::HW_IF_EFFORT_COMMAND));
+  EXPECT_EQ(hw::HW_IF_VELOCITY, hw::HW_IF_VELOCITY_ID.get_name());
+  EXPECT_EQ(hw::HW_IF_EFFORT_COMMAND, hw::HW_IF_EFFORT_COMMAND_ID.get_name());
+
+  static_assert(hw::HW_IF_POSITION_ID != hw::HW_IF_VELOCITY_ID, "ids are compile-time values");
+}
+
+TEST(TestInterfaceTypeId, custom_types_are_interned_once)
+{
+  hw::InterfaceTypeId id;
+  EXPECT_FALSE(id.is_valid());
+  EXPECT_EQ("", id.get_name());
+  EXPECT_FALSE(hw::InterfaceTypeId::find("test_interface_type_id_custom", id));
+
+  const auto custom = hw::InterfaceTypeId::intern("test_interface_type_id_custom");
+  ASSERT_TRUE(custom.is_valid());
+  EXPECT_NE(hw::HW_IF_POSITION_ID, custom);
+  EXPECT_EQ(custom, hw::InterfaceTypeId::intern("test_interface_type_id_custom"));
+  ASSERT_TRUE(hw::InterfaceTypeId::find("test_interface_type_id_custom", id));
+  EXPECT_EQ(custom, id);
+  EXPECT_EQ("test_interface_type_id_custom", custom.get_name());
+
+  EXPECT_FALSE(hw::InterfaceTypeId::intern("").is_valid());
+}
+
+TEST(TestInterfaceTypeId, concurrent_interning_is_consistent)
+{
+  constexpr size_t kThreads = 4;
+  constexpr size_t kNames = 200;
+  std::vector<std::vector<hw::InterfaceTypeId>> ids(kThreads);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < kThreads; ++t) {
+    threads.emplace_back(
+      [&ids, t]() {
+        for (size_t i = 0; i < kNames; ++i) {
+          ids[t].push_back(hw::InterfaceTypeId::intern("concurrent_" + std::to_string(i)));
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  for (size_t t = 1; t < kThreads; ++t) {
+    EXPECT_EQ(ids[0], ids[t]);
+  }
+  for (size_t i = 0; i < kNames; ++i) {
+    EXPECT_EQ("concurrent_" + std::to_string(i), ids[0][i].get_name());
+  }
+}
@@ -0,0 +1,126 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "hardware_interface/interface_value_arena.hpp"
+
+using hardware_interface::InterfaceValueArena;
+
+namespace
+{
+control_msgs::msg::DynamicJointState make_registered()
+{
+  control_msgs::msg::DynamicJointState registered;
+  registered.joint_names = {"joint1", "joint2"};
+  registered.interface_values.resize(2);
+  registered.interface_values[0].interface_names = {"position", "position_command", "velocity"};
+  registered.interface_values[0].values = {1.0, 2.0, 3.0};
+  registered.interface_values[1].interface_names = {"position", "position_command"};
+  registered.interface_values[1].values = {4.0, 5.0};
+  return registered;
+}
+}  // namespace
+
+TEST(TestInterfaceValueArena, not_frozen_by_default)
+{
+  InterfaceValueArena arena;
+  EXPECT_FALSE(arena.is_frozen());
+  EXPECT_EQ(nullptr, arena.data());
+  EXPECT_EQ(nullptr, arena.get_command_values());
+}
+
+TEST(TestInterfaceValueArena, classifies_command_interfaces)
+{
+  EXPECT_TRUE(InterfaceValueArena::is_command_interface("position_command"));
+  EXPECT_FALSE(InterfaceValueArena::is_command_interface("position"));
+  EXPECT_FALSE(InterfaceValueArena::is_command_interface("_command"));
+  EXPECT_FALSE(InterfaceValueArena::is_command_interface("command_position"));
+}
+
+TEST(TestInterfaceValueArena, lays_out_separate_contiguous_regions)
+{
+  InterfaceValueArena arena;
+  arena.freeze(make_registered());
+  ASSERT_TRUE(arena.is_frozen());
+
+  ASSERT_EQ(3u, arena.get_state_size());
+  ASSERT_EQ(2u, arena.get_command_size());
+  EXPECT_EQ(
+    0u,
+    reinterpret_cast<std::uintptr_t>(arena.data()) % InterfaceValueArena::CACHE_LINE_SIZE);
+  EXPECT_EQ(
+    0u,
+    reinterpret_cast<std::uintptr_t>(arena.get_command_values()) %
+    InterfaceValueArena::CACHE_LINE_SIZE);
+
+  const double * states = arena.get_state_values();
+  EXPECT_THAT(std::vector<double>(states, states + 3), testing::ElementsAre(1.0, 3.0, 4.0));
+  const double * commands = arena.get_command_values();
+  EXPECT_THAT(std::vector<double>(commands, commands + 2), testing::ElementsAre(2.0, 5.0));
+}
+
+TEST(TestInterfaceValueArena, value_ptrs_match_offsets)
+{
+  InterfaceValueArena arena;
+  const auto registered = make_registered();
+  arena.freeze(registered);
+
+  for (size_t i = 0; i < registered.interface_values.size(); ++i) {
+    const auto & values = registered.interface_values[i].values;
+    for (size_t j = 0; j < values.size(); ++j) {
+      EXPECT_EQ(arena.data() + arena.get_offset(i, j), arena.get_value_ptr(i, j));
+      EXPECT_DOUBLE_EQ(values[j], *arena.get_value_ptr(i, j));
+    }
+  }
+  EXPECT_ANY_THROW(arena.get_value_ptr(2, 0));
+  EXPECT_ANY_THROW(arena.get_value_ptr(1, 2));
+}
+
+TEST(TestInterfaceValueArena, can_not_freeze_twice)
+{
+  InterfaceValueArena arena;
+  arena.freeze(make_registered());
+  EXPECT_ANY_THROW(arena.freeze(make_registered()));
+}
+
+TEST(TestInterfaceValueArena, publishes_commands_at_once)
+{
+  InterfaceValueArena arena;
+  arena.freeze(make_registered());
+  const double * published = arena.get_published_command_values();
+  ASSERT_NE(nullptr, published);
+  // the published copy starts on its own cache line, initialized with the registered values
+  EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(published) % InterfaceValueArena::CACHE_LINE_SIZE);
+  EXPECT_GE(published, arena.get_command_values() + arena.get_command_size());
+  EXPECT_EQ(2.0, published[0]);
+  EXPECT_EQ(5.0, published[1]);
+
+  // state values are shared, command values are read from the published copy
+  EXPECT_EQ(arena.get_value_ptr(0, 0), arena.get_published_value_ptr(0, 0));
+  EXPECT_EQ(published, arena.get_published_value_ptr(0, 1));
+  EXPECT_EQ(published + 1, arena.get_published_value_ptr(1, 1));
+
+  *arena.get_value_ptr(0, 1) = 6.0;
+  *arena.get_value_ptr(1, 1) = 7.0;
+  EXPECT_EQ(2.0, *arena.get_published_value_ptr(0, 1));
+  EXPECT_EQ(5.0, *arena.get_published_value_ptr(1, 1));
+  arena.publish_commands();
+  EXPECT_EQ(6.0, *arena.get_published_value_ptr(0, 1));
+  EXPECT_EQ(7.0, *arena.get_published_value_ptr(1, 1));
+}
@@ -13,8 +13,12 @@
 // limitations under the License.
 
 #include <gmock/gmock.h>
+
+#include <type_traits>
+
 #include "hardware_interface/joint_handle.hpp"
 
+using hardware_interface::BoundJointHandle;
 using hardware_interface::JointHandle;
 
 namespace
@@ -54,3 +58,29 @@ TEST(TestJointHandle, with_value_ptr_initializes_new_handle_correctly)
   EXPECT_ANY_THROW(handle.get_value());
   EXPECT_DOUBLE_EQ(new_handle.get_value(), value);
 }
+
+TEST(TestJointHandle, bind_throws_for_nullptr)
+{
+  JointHandle handle{JOINT_NAME, FOO_INTERFACE};
+  EXPECT_ANY_THROW(handle.bind());
+}
+
+TEST(TestJointHandle, bound_handle_accesses_the_value)
+{
+  static_assert(
+    std::is_trivially_copyable<BoundJointHandle>::value, "bound handles must be trivially copyable");
+  static_assert(sizeof(BoundJointHandle) == sizeof(double *), "bound handles must be a pointer");
+
+  double value = 1.337;
+  JointHandle handle{JOINT_NAME, FOO_INTERFACE, &value};
+  const BoundJointHandle bound = handle.bind();
+  EXPECT_EQ(bound.get_value_ptr(), &value);
+  EXPECT_DOUBLE_EQ(bound.get_value(), value);
+  bound.set_value(0.5);
+  EXPECT_DOUBLE_EQ(value, 0.5);
+  EXPECT_DOUBLE_EQ(handle.get_value(), 0.5);
+
+  const BoundJointHandle copy = bound;
+  copy.set_value(-2.0);
+  EXPECT_DOUBLE_EQ(bound.get_value(), -2.0);
+}
@@ -0,0 +1,159 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gmock/gmock.h>
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hardware_interface/realtime_logger.hpp"
+
+using hardware_interface::RealtimeLogger;
+using testing::ElementsAre;
+using testing::HasSubstr;
+
+namespace
+{
+/// Collects the messages printed by the background thread of a logger.
+class RecordingSink
+{
+public:
+  RealtimeLogger::Sink sink()
+  {
+    return [this](RealtimeLogger::Severity severity, const char * logger_name,
+             const char * message) {
+             std::lock_guard<std::mutex> guard(mutex_);
+             severities_.push_back(severity);
+             messages_.push_back(std::string(logger_name) + ": " + message);
+           };
+  }
+
+  std::vector<std::string> messages()
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return messages_;
+  }
+
+  std::vector<RealtimeLogger::Severity> severities()
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return severities_;
+  }
+
+private:
+  std::mutex mutex_;
+  std::vector<std::string> messages_;
+  std::vector<RealtimeLogger::Severity> severities_;
+};
+}  // namespace
+
+TEST(TestRealtimeLogger, messages_are_printed_in_order)
+{
+  RecordingSink recording;
+  RealtimeLogger logger(8, 100, std::chrono::seconds(1), recording.sink());
+  EXPECT_TRUE(logger.log(RealtimeLogger::Severity::ERROR, "joint handle", "no joint %s", "j1"));
+  EXPECT_TRUE(logger.log(RealtimeLogger::Severity::INFO, "joint handle", "%d joints", 2));
+  logger.flush();
+  EXPECT_THAT(
+    recording.messages(), ElementsAre("joint handle: no joint j1", "joint handle: 2 joints"));
+  EXPECT_THAT(
+    recording.severities(),
+    ElementsAre(RealtimeLogger::Severity::ERROR, RealtimeLogger::Severity::INFO));
+  EXPECT_EQ(0u, logger.get_dropped_count());
+}
+
+TEST(TestRealtimeLogger, long_messages_are_truncated)
+{
+  RecordingSink recording;
+  RealtimeLogger logger(8, 100, std::chrono::seconds(1), recording.sink());
+  const std::string long_name(RealtimeLogger::kMaxLoggerNameLength + 10, 'n');
+  const std::string long_message(RealtimeLogger::kMaxMessageLength + 10, 'm');
+  logger.log(RealtimeLogger::Severity::WARN, long_name.c_str(), "%s", long_message.c_str());
+  logger.flush();
+  ASSERT_EQ(1u, recording.messages().size());
+  EXPECT_EQ(
+    long_name.substr(0, RealtimeLogger::kMaxLoggerNameLength) + ": " +
+    long_message.substr(0, RealtimeLogger::kMaxMessageLength),
+    recording.messages()[0]);
+}
+
+TEST(TestRealtimeLogger, excess_messages_are_rate_limited)
+{
+  RecordingSink recording;
+  RealtimeLogger logger(64, 3, std::chrono::hours(1), recording.sink());
+  for (int i = 0; i < 10; ++i) {
+    logger.log(RealtimeLogger::Severity::ERROR, "test", "message %d", i);
+  }
+  EXPECT_EQ(7u, logger.get_dropped_count());
+  logger.flush();
+  // the dropped messages are reported once the queued ones are printed
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  const auto messages = recording.messages();
+  ASSERT_EQ(4u, messages.size());
+  EXPECT_EQ("test: message 2", messages[2]);
+  EXPECT_THAT(messages[3], HasSubstr("dropped 7 real-time log messages"));
+}
+
+TEST(TestRealtimeLogger, messages_are_dropped_when_the_queue_is_full)
+{
+  std::mutex blocked;
+  blocked.lock();
+  RealtimeLogger logger(
+    4, 100, std::chrono::seconds(1),
+    [&blocked](RealtimeLogger::Severity, const char *, const char *) {
+      // block the background thread on the first message
+      std::lock_guard<std::mutex> guard(blocked);
+    });
+  size_t logged = 0;
+  for (int i = 0; i < 10; ++i) {
+    logged += logger.log(RealtimeLogger::Severity::ERROR, "test", "message %d", i) ? 1 : 0;
+  }
+  // the queue holds 4 messages, one more if the background thread took the first one already
+  EXPECT_GE(logged, 4u);
+  EXPECT_LE(logged, 5u);
+  EXPECT_EQ(10u - logged, logger.get_dropped_count());
+  blocked.unlock();
+  logger.flush();
+}
+
+TEST(TestRealtimeLogger, concurrent_producers)
+{
+  RecordingSink recording;
+  RealtimeLogger logger(1024, 1000, std::chrono::hours(1), recording.sink());
+  std::vector<std::thread> producers;
+  for (int producer = 0; producer < 4; ++producer) {
+    producers.emplace_back(
+      [&logger, producer]() {
+        for (int i = 0; i < 100; ++i) {
+          logger.log(RealtimeLogger::Severity::DEBUG, "test", "%d:%d", producer, i);
+        }
+      });
+  }
+  for (auto & producer : producers) {
+    producer.join();
+  }
+  logger.flush();
+  EXPECT_EQ(400u, recording.messages().size() + logger.get_dropped_count());
+}
+
+TEST(TestRealtimeLogger, global_logger)
+{
+  EXPECT_TRUE(HARDWARE_INTERFACE_RT_LOG_INFO("test", "logged with the %s", "global logger"));
+  EXPECT_EQ(&hardware_interface::get_realtime_logger(), &hardware_interface::get_realtime_logger());
+  hardware_interface::get_realtime_logger().flush();
+}
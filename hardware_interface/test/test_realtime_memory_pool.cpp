@@ -0,0 +1,176 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "hardware_interface/realtime_memory_pool.hpp"
+#include "hardware_interface/realtime_section.hpp"
+#include "hardware_interface/robot_hardware.hpp"
+
+using hardware_interface::PoolAllocator;
+using hardware_interface::RealtimeMemoryPool;
+using hardware_interface::RealtimeSection;
+
+namespace
+{
+/// Keeps the allocations of the tests from being optimized away
+std::unique_ptr<int> allocation_sink;
+
+class TestHardware : public hardware_interface::RobotHardware
+{
+public:
+  hardware_interface::return_type init() override
+  {
+    return hardware_interface::return_type::OK;
+  }
+
+  hardware_interface::return_type read() override
+  {
+    return hardware_interface::return_type::OK;
+  }
+
+  hardware_interface::return_type write() override
+  {
+    return hardware_interface::return_type::OK;
+  }
+};
+}  // namespace
+
+TEST(TestRealtimeMemoryPool, reuses_freed_blocks_of_the_same_size_class)
+{
+  RealtimeMemoryPool pool(1 << 16, false);
+  EXPECT_GE(pool.get_capacity(), 1u << 16);
+  EXPECT_EQ(0u, pool.get_reserved_size());
+
+  void * first = pool.allocate(24);
+  EXPECT_TRUE(pool.owns(first));
+  EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(first) % alignof(std::max_align_t));
+  const auto reserved = pool.get_reserved_size();
+  pool.deallocate(first, 24);
+  // same size class of 32 bytes, nothing more reserved
+  void * second = pool.allocate(30);
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(reserved, pool.get_reserved_size());
+
+  void * aligned = pool.allocate(256, 64);
+  EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(aligned) % 64);
+  int local = 0;
+  EXPECT_FALSE(pool.owns(&local));
+}
+
+TEST(TestRealtimeMemoryPool, throws_once_exhausted)
+{
+  RealtimeMemoryPool pool(4096, false);
+  EXPECT_THROW(pool.allocate(2 * pool.get_capacity()), std::bad_alloc);
+  EXPECT_THROW(pool.allocate(16, 128), std::bad_alloc);
+  std::vector<void *> blocks;
+  EXPECT_THROW(
+    while (true) {
+    blocks.push_back(pool.allocate(64));
+  }, std::bad_alloc);
+  EXPECT_EQ(pool.get_capacity() / 64, blocks.size());
+}
+
+TEST(TestRealtimeMemoryPool, containers_and_objects_allocate_from_the_pool)
+{
+  RealtimeMemoryPool pool(1 << 16, false);
+  std::vector<double, PoolAllocator<double>> values(100, 1.0, PoolAllocator<double>(&pool));
+  EXPECT_TRUE(pool.owns(values.data()));
+
+  auto moved = std::move(values);
+  EXPECT_TRUE(pool.owns(moved.data()));
+  EXPECT_EQ(&pool, moved.get_allocator().get_pool());
+
+  auto object = hardware_interface::allocate_pooled<std::vector<int>>(&pool, 10u, 3);
+  EXPECT_TRUE(pool.owns(object.get()));
+  EXPECT_EQ(10u, object->size());
+
+  // allocated from the heap without a pool
+  std::vector<double, PoolAllocator<double>> heap_values(100, 1.0);
+  EXPECT_FALSE(pool.owns(heap_values.data()));
+}
+
+TEST(TestRealtimeMemoryPool, charges_the_blocks_to_the_account_of_the_thread)
+{
+  RealtimeMemoryPool pool(1 << 16, false);
+  hardware_interface::PoolAllocationAccount outer;
+  hardware_interface::PoolAllocationAccount inner;
+  void * uncharged = pool.allocate(24);
+  {
+    hardware_interface::ScopedPoolAllocationAccount outer_scope(&outer);
+    void * block = pool.allocate(24);
+    {
+      hardware_interface::ScopedPoolAllocationAccount inner_scope(&inner);
+      pool.deallocate(pool.allocate(100), 100);
+    }
+    pool.deallocate(block, 24);
+    // the scope is per thread
+    std::thread([&pool]() {pool.deallocate(pool.allocate(16), 16);}).join();
+  }
+  pool.deallocate(uncharged, 24);
+
+  // rounded up to the size classes of 32 and 128 bytes
+  EXPECT_EQ(1u, outer.allocation_count.load());
+  EXPECT_EQ(32u, outer.allocated_bytes.load());
+  EXPECT_EQ(1u, outer.deallocation_count.load());
+  EXPECT_EQ(32u, outer.deallocated_bytes.load());
+  EXPECT_EQ(1u, inner.allocation_count.load());
+  EXPECT_EQ(128u, inner.allocated_bytes.load());
+  EXPECT_EQ(128u, inner.deallocated_bytes.load());
+}
+
+TEST(TestRealtimeMemoryPool, arenas_allocate_from_the_pool_of_the_hardware)
+{
+  auto pool = std::make_shared<RealtimeMemoryPool>(1 << 16, false);
+  TestHardware hardware;
+  hardware.register_joint("joint1", "position");
+  hardware.register_joint("joint1", "position_command");
+  EXPECT_EQ(hardware_interface::return_type::OK, hardware.set_memory_pool(pool));
+  EXPECT_EQ(hardware_interface::return_type::OK, hardware.freeze_registration());
+  EXPECT_TRUE(pool->owns(hardware.get_joint_values().data()));
+  EXPECT_EQ(hardware_interface::return_type::ERROR, hardware.set_memory_pool(nullptr));
+  EXPECT_EQ(pool, hardware.get_memory_pool());
+}
+
+TEST(TestRealtimeHeapTrap, allows_allocations_outside_of_real_time_sections)
+{
+  EXPECT_FALSE(RealtimeSection::is_active());
+  {
+    RealtimeSection section;
+    EXPECT_TRUE(RealtimeSection::is_active());
+    {
+      RealtimeSection nested;
+      EXPECT_TRUE(RealtimeSection::is_active());
+    }
+    EXPECT_TRUE(RealtimeSection::is_active());
+  }
+  EXPECT_FALSE(RealtimeSection::is_active());
+  allocation_sink = std::make_unique<int>(42);
+  EXPECT_EQ(42, *allocation_sink);
+}
+
+TEST(TestRealtimeHeapTrap, aborts_on_allocations_in_real_time_sections)
+{
+  EXPECT_DEATH(
+  {
+    RealtimeSection section;
+    allocation_sink = std::make_unique<int>(42);
+  }, "heap allocation in a real-time section");
+}
@@ -0,0 +1,121 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "hardware_interface/realtime_section.hpp"
+
+using hardware_interface::RealtimeSection;
+
+namespace
+{
+/// Keeps the allocations of the tests from being optimized away
+std::unique_ptr<int> allocation_sink;
+
+class TestRealtimeViolationDetector : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    // run with LD_PRELOAD by the test target
+    if (!RealtimeSection::is_checked()) {
+      GTEST_SKIP();
+    }
+    RealtimeSection::reset_violation_count();
+  }
+};
+}  // namespace
+
+TEST_F(TestRealtimeViolationDetector, ignores_calls_outside_of_real_time_sections)
+{
+  std::mutex mutex;
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+    allocation_sink = std::make_unique<int>(42);
+  }
+  allocation_sink.reset();
+  std::this_thread::sleep_for(std::chrono::microseconds(1));
+  EXPECT_EQ(0u, RealtimeSection::get_violation_count());
+}
+
+TEST_F(TestRealtimeViolationDetector, counts_allocations_in_real_time_sections)
+{
+  {
+    RealtimeSection section;
+    allocation_sink = std::make_unique<int>(42);
+  }
+  EXPECT_EQ(1u, RealtimeSection::get_violation_count());
+  {
+    RealtimeSection section;
+    allocation_sink.reset();
+  }
+  EXPECT_EQ(2u, RealtimeSection::get_violation_count());
+
+  RealtimeSection::reset_violation_count();
+  EXPECT_EQ(0u, RealtimeSection::get_violation_count());
+}
+
+TEST_F(TestRealtimeViolationDetector, counts_blocking_calls_in_real_time_sections)
+{
+  std::mutex mutex;
+  {
+    RealtimeSection section;
+    mutex.lock();
+  }
+  mutex.unlock();
+  EXPECT_EQ(1u, RealtimeSection::get_violation_count());
+
+  // a failed try_lock() does not block
+  {
+    RealtimeSection section;
+    if (mutex.try_lock()) {
+      mutex.unlock();
+    }
+  }
+  EXPECT_EQ(1u, RealtimeSection::get_violation_count());
+
+  {
+    RealtimeSection section;
+    std::this_thread::sleep_for(std::chrono::microseconds(1));
+  }
+  EXPECT_EQ(2u, RealtimeSection::get_violation_count());
+}
+
+TEST_F(TestRealtimeViolationDetector, only_counts_the_calls_of_the_thread_in_the_section)
+{
+  std::atomic<bool> in_section{false};
+  std::atomic<bool> allocated{false};
+  std::thread other([&in_section, &allocated] {
+      while (!in_section) {
+        std::this_thread::yield();
+      }
+      allocation_sink = std::make_unique<int>(42);
+      allocated = true;
+    });
+  {
+    RealtimeSection section;
+    in_section = true;
+    while (!allocated) {
+      std::this_thread::yield();
+    }
+  }
+  other.join();
+  EXPECT_EQ(0u, RealtimeSection::get_violation_count());
+}
@@ -16,6 +16,7 @@
 #include <string>
 #include <vector>
 #include "hardware_interface/robot_hardware.hpp"
+#include "hardware_interface/types/hardware_interface_type_values.hpp"
 
 namespace hw = hardware_interface;
 using testing::SizeIs;
@@ -189,3 +190,242 @@ TEST_F(TestJoints, can_get_registered_joints_of_interface)
   ASSERT_EQ(hw::return_type::OK, robot_hw_.get_joint_handles(handles3, "NoInterface"));
   ASSERT_TRUE(handles3.empty());
 }
+
+TEST_F(TestJoints, handles_use_the_arena_once_frozen)
+{
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.register_joint(JOINT_NAME, FOO_INTERFACE, 1.0));
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.register_joint(JOINT_NAME, BAR_INTERFACE, 2.0));
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.register_joint(JOINT2_NAME, FOO_INTERFACE, 3.0));
+
+  EXPECT_FALSE(robot_hw_.is_registration_frozen());
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.freeze_registration());
+  EXPECT_TRUE(robot_hw_.is_registration_frozen());
+  EXPECT_EQ(hw::return_type::ERROR, robot_hw_.freeze_registration());
+  EXPECT_EQ(hw::return_type::ERROR, robot_hw_.register_joint(JOINT2_NAME, BAR_INTERFACE));
+
+  auto & arena = robot_hw_.get_joint_values();
+  ASSERT_EQ(3u, arena.get_state_size());
+  const double * begin = arena.get_state_values();
+
+  hw::JointHandle handle{JOINT2_NAME, FOO_INTERFACE};
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.get_joint_handle(handle));
+  EXPECT_DOUBLE_EQ(3.0, handle.get_value());
+  handle.set_value(4.2);
+  EXPECT_DOUBLE_EQ(4.2, begin[2]);
+
+  for (const auto & registered_handle : robot_hw_.get_registered_joints()) {
+    hw::JointHandle found{registered_handle.get_name(), registered_handle.get_interface_name()};
+    ASSERT_EQ(hw::return_type::OK, robot_hw_.get_joint_handle(found));
+    EXPECT_DOUBLE_EQ(registered_handle.get_value(), found.get_value());
+  }
+}
+
+TEST_F(TestJoints, can_get_handles_by_resolved_id)
+{
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.register_joint(JOINT_NAME, FOO_INTERFACE, 1.0));
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.register_joint(JOINT2_NAME, FOO_INTERFACE, 2.0));
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.register_joint(JOINT2_NAME, BAR_INTERFACE, 3.0));
+
+  hw::InterfaceId id;
+  EXPECT_EQ(
+    hw::return_type::ERROR,
+    robot_hw_.get_joint_interface_id(JOINT_NAME, BAR_INTERFACE, id));
+  EXPECT_EQ(
+    hw::return_type::ERROR,
+    robot_hw_.get_joint_interface_id("no_joint", FOO_INTERFACE, id));
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.get_joint_interface_id(JOINT2_NAME, BAR_INTERFACE, id));
+  EXPECT_EQ(1u, id.handle_index);
+  EXPECT_EQ(1u, id.interface_index);
+
+  hw::JointHandle handle{"", ""};
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.get_joint_handle(id, handle));
+  EXPECT_EQ(JOINT2_NAME, handle.get_name());
+  EXPECT_EQ(BAR_INTERFACE, handle.get_interface_name());
+  EXPECT_DOUBLE_EQ(3.0, handle.get_value());
+
+  hw::JointHandle by_name{JOINT2_NAME, BAR_INTERFACE};
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.get_joint_handle(by_name));
+  by_name.set_value(4.0);
+  EXPECT_DOUBLE_EQ(4.0, handle.get_value());
+
+  id.interface_index = 2u;
+  EXPECT_EQ(hw::return_type::ERROR, robot_hw_.get_joint_handle(id, handle));
+  id.handle_index = 2u;
+  id.interface_index = 0u;
+  EXPECT_EQ(hw::return_type::ERROR, robot_hw_.get_joint_handle(id, handle));
+}
+
+TEST_F(TestJoints, can_register_and_resolve_by_interface_type)
+{
+  const auto foo_type = hw::InterfaceTypeId::intern(FOO_INTERFACE);
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.register_joint(JOINT_NAME, hw::HW_IF_POSITION_ID, 1.0));
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.register_joint(JOINT_NAME, foo_type, 2.0));
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.register_joint(JOINT2_NAME, hw::HW_IF_POSITION, 3.0));
+  EXPECT_EQ(hw::return_type::ERROR, robot_hw_.register_joint(JOINT_NAME, FOO_INTERFACE));
+  EXPECT_EQ(hw::return_type::ERROR, robot_hw_.register_joint(JOINT_NAME, hw::InterfaceTypeId()));
+  EXPECT_THAT(
+    robot_hw_.get_registered_joint_interface_names(JOINT_NAME),
+    ElementsAre(hw::HW_IF_POSITION, FOO_INTERFACE));
+
+  // names and types resolve to the same ids
+  hw::InterfaceId by_type;
+  hw::InterfaceId by_name;
+  ASSERT_EQ(
+    hw::return_type::OK, robot_hw_.get_joint_interface_id(JOINT_NAME, foo_type, by_type));
+  ASSERT_EQ(
+    hw::return_type::OK, robot_hw_.get_joint_interface_id(JOINT_NAME, FOO_INTERFACE, by_name));
+  EXPECT_EQ(by_name.handle_index, by_type.handle_index);
+  EXPECT_EQ(by_name.interface_index, by_type.interface_index);
+  EXPECT_EQ(
+    hw::return_type::ERROR,
+    robot_hw_.get_joint_interface_id(JOINT2_NAME, hw::HW_IF_VELOCITY_ID, by_type));
+
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.freeze_registration());
+  std::vector<hw::JointHandle> handles;
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.get_joint_handles(handles, hw::HW_IF_POSITION_ID));
+  ASSERT_THAT(handles, SizeIs(2));
+  EXPECT_EQ(JOINT_NAME, handles[0].get_name());
+  EXPECT_EQ(hw::HW_IF_POSITION, handles[0].get_interface_name());
+  EXPECT_DOUBLE_EQ(1.0, handles[0].get_value());
+  EXPECT_EQ(JOINT2_NAME, handles[1].get_name());
+  EXPECT_DOUBLE_EQ(3.0, handles[1].get_value());
+
+  hw::JointHandle by_id{"", ""};
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.get_joint_handle(by_type, by_id));
+  by_id.set_value(5.0);
+  handles.clear();
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.get_joint_handles(handles, foo_type));
+  ASSERT_THAT(handles, SizeIs(1));
+  EXPECT_DOUBLE_EQ(5.0, handles[0].get_value());
+}
+
+TEST_F(TestJoints, can_copy_value_groups_at_once)
+{
+  const std::vector<std::string> joint_names = {"joint_a", "joint_b", "joint_c"};
+  for (size_t i = 0; i < joint_names.size(); ++i) {
+    // one state and one command per joint, each contiguous in its own region of the arena
+    EXPECT_EQ(hw::return_type::OK, robot_hw_.register_joint(joint_names[i], FOO_INTERFACE, i));
+    EXPECT_EQ(
+      hw::return_type::OK,
+      robot_hw_.register_joint(joint_names[i], hw::HW_IF_VELOCITY_COMMAND_ID));
+  }
+
+  hw::InterfaceValueGroup positions;
+  EXPECT_EQ(
+    hw::return_type::ERROR, robot_hw_.get_joint_value_group(joint_names, FOO_INTERFACE, positions));
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.freeze_registration());
+  ASSERT_EQ(
+    hw::return_type::OK, robot_hw_.get_joint_value_group(joint_names, FOO_INTERFACE, positions));
+  EXPECT_EQ(3u, positions.size());
+  EXPECT_TRUE(positions.is_contiguous());
+
+  // the joints are in the order of the group, not of the registration
+  hw::InterfaceValueGroup velocities;
+  ASSERT_EQ(
+    hw::return_type::OK,
+    robot_hw_.get_joint_value_group(
+      {"joint_c", "joint_a", "joint_b"}, hw::HW_IF_VELOCITY_COMMAND_ID, velocities));
+  EXPECT_FALSE(velocities.is_contiguous());
+
+  std::vector<double> values(3);
+  EXPECT_EQ(hw::return_type::OK, robot_hw_.get_joint_values(positions, values));
+  EXPECT_THAT(values, ElementsAre(0.0, 1.0, 2.0));
+
+  const std::vector<double> new_values = {4.0, 5.0, 6.0};
+  EXPECT_EQ(hw::return_type::OK, robot_hw_.set_joint_values(velocities, new_values));
+  EXPECT_EQ(hw::return_type::OK, robot_hw_.get_joint_values(velocities, values));
+  EXPECT_THAT(values, ElementsAre(4.0, 5.0, 6.0));
+  hw::JointHandle handle{"joint_a", hw::HW_IF_VELOCITY_COMMAND};
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.get_joint_handle(handle));
+  EXPECT_EQ(5.0, handle.get_value());
+
+  std::vector<double> too_short(2);
+  EXPECT_EQ(
+    hw::return_type::INTERFACE_VALUE_SIZE_NOT_EQUAL,
+    robot_hw_.get_joint_values(positions, too_short));
+  EXPECT_EQ(
+    hw::return_type::INTERFACE_VALUE_SIZE_NOT_EQUAL,
+    robot_hw_.set_joint_values(positions, too_short));
+
+  hw::InterfaceValueGroup missing;
+  EXPECT_EQ(
+    hw::return_type::ERROR, robot_hw_.get_joint_value_group(joint_names, BAR_INTERFACE, missing));
+}
+
+TEST_F(TestJoints, hardware_reads_published_commands)
+{
+  EXPECT_EQ(hw::return_type::OK, robot_hw_.register_joint(JOINT_NAME, hw::HW_IF_POSITION_ID, 1.0));
+  EXPECT_EQ(
+    hw::return_type::OK, robot_hw_.register_joint(JOINT_NAME, hw::HW_IF_POSITION_COMMAND_ID, 2.0));
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.freeze_registration());
+
+  hw::InterfaceId state_id;
+  hw::InterfaceId command_id;
+  ASSERT_EQ(
+    hw::return_type::OK,
+    robot_hw_.get_joint_interface_id(JOINT_NAME, hw::HW_IF_POSITION_ID, state_id));
+  ASSERT_EQ(
+    hw::return_type::OK,
+    robot_hw_.get_joint_interface_id(JOINT_NAME, hw::HW_IF_POSITION_COMMAND_ID, command_id));
+  hw::JointHandle controller_state{"", ""};
+  hw::JointHandle controller_command{"", ""};
+  hw::JointHandle hardware_state{"", ""};
+  hw::JointHandle hardware_command{"", ""};
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.get_joint_handle(state_id, controller_state));
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.get_joint_handle(command_id, controller_command));
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.get_published_joint_handle(state_id, hardware_state));
+  ASSERT_EQ(
+    hw::return_type::OK, robot_hw_.get_published_joint_handle(command_id, hardware_command));
+  EXPECT_EQ(controller_state.get_value_ptr(), hardware_state.get_value_ptr());
+  EXPECT_NE(controller_command.get_value_ptr(), hardware_command.get_value_ptr());
+  EXPECT_EQ(hw::HW_IF_POSITION_COMMAND, hardware_command.get_interface_name());
+
+  // the hardware only sees the commands once published
+  EXPECT_EQ(2.0, hardware_command.get_value());
+  controller_command.set_value(3.0);
+  EXPECT_EQ(2.0, hardware_command.get_value());
+  robot_hw_.publish_commands();
+  EXPECT_EQ(3.0, hardware_command.get_value());
+}
+
+TEST_F(TestJoints, can_register_typed_joint_interfaces)
+{
+  EXPECT_EQ(hw::return_type::OK, robot_hw_.register_joint(JOINT_NAME, FOO_INTERFACE, 1.0));
+  EXPECT_EQ(
+    hw::return_type::OK, robot_hw_.register_typed_joint(JOINT_NAME, BAR_INTERFACE, 2.5f));
+  EXPECT_EQ(
+    hw::return_type::OK,
+    robot_hw_.register_typed_joint(JOINT2_NAME, "status_word", uint16_t{0x0040}));
+  EXPECT_EQ(
+    hw::return_type::OK, robot_hw_.register_typed_joint(JOINT2_NAME, "enable_command", false));
+  // an interface is either a double or a typed value
+  EXPECT_EQ(hw::return_type::ERROR, robot_hw_.register_typed_joint(JOINT_NAME, FOO_INTERFACE, 0));
+  EXPECT_EQ(hw::return_type::ERROR, robot_hw_.register_joint(JOINT_NAME, BAR_INTERFACE, 0.0));
+  EXPECT_EQ(hw::return_type::ERROR, robot_hw_.register_typed_joint(JOINT_NAME, BAR_INTERFACE, 0));
+  EXPECT_EQ(hw::return_type::ERROR, robot_hw_.register_typed_joint(JOINT_NAME, "", true));
+  // typed values are not part of the registered joints
+  EXPECT_THAT(robot_hw_.get_registered_joint_names(), ElementsAre(JOINT_NAME));
+
+  hw::Float32Handle bar(JOINT_NAME, BAR_INTERFACE);
+  EXPECT_EQ(hw::return_type::ERROR, robot_hw_.get_typed_joint_handle(bar));
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.freeze_registration());
+  EXPECT_EQ(
+    hw::return_type::ERROR, robot_hw_.register_typed_joint(JOINT2_NAME, "fault", false));
+
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.get_typed_joint_handle(bar));
+  EXPECT_EQ(2.5f, bar.get_value());
+  hw::Int32Handle wrong_type(JOINT_NAME, BAR_INTERFACE);
+  EXPECT_EQ(hw::return_type::ERROR, robot_hw_.get_typed_joint_handle(wrong_type));
+  hw::BitfieldHandle status_word(JOINT2_NAME, "status_word");
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.get_typed_joint_handle(status_word));
+  EXPECT_TRUE(status_word.test_bit(6));
+
+  hw::BoolHandle controller_enable(JOINT2_NAME, "enable_command");
+  hw::BoolHandle hardware_enable(JOINT2_NAME, "enable_command");
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.get_typed_joint_handle(controller_enable));
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.get_published_typed_joint_handle(hardware_enable));
+  controller_enable.set_value(true);
+  EXPECT_FALSE(hardware_enable.get_value());
+  robot_hw_.publish_commands();
+  EXPECT_TRUE(hardware_enable.get_value());
+}
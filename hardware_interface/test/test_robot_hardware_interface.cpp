@@ -12,7 +12,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
+#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -48,6 +51,23 @@ public:
   }
 };
 
+/// Records the batches of operation modes, as a driver sending one bus frame per component
+class BatchingRobotHardware : public MyTestRobotHardware
+{
+public:
+  hw::return_type apply_operation_modes(const hw::OperationModeBatch & batch) override
+  {
+    std::vector<std::string> names;
+    for (const auto & change : batch.changes) {
+      names.push_back(change.handle->get_name());
+    }
+    batches.emplace_back(batch.component_name, names);
+    return hw::RobotHardware::apply_operation_modes(batch);
+  }
+
+  std::vector<std::pair<std::string, std::vector<std::string>>> batches;
+};
+
 constexpr auto JOINT_NAME = "joint_1";
 constexpr auto NEW_JOINT_NAME = "joint_2";
 }  // namespace
@@ -141,3 +161,132 @@ TEST_F(TestRobotHardwareInterface, can_get_handles_by_name)
   op_mode_handle = nullptr;
   EXPECT_EQ(hw::return_type::OK, robot_.get_operation_mode_handle(NEW_JOINT_NAME, &op_mode_handle));
 }
+
+TEST_F(TestRobotHardwareInterface, can_register_references_once_frozen)
+{
+  robot_.register_joint(JOINT_NAME, "position");
+  ASSERT_EQ(hw::return_type::OK, robot_.freeze_registration());
+
+  double reference = 1.0;
+  EXPECT_EQ(
+    hw::return_type::ERROR,
+    robot_.register_reference_interface("controller/joint_1", "position", nullptr));
+  EXPECT_EQ(
+    hw::return_type::OK,
+    robot_.register_reference_interface("controller/joint_1", "position", &reference));
+  EXPECT_EQ(
+    hw::return_type::ERROR,
+    robot_.register_reference_interface("controller/joint_1", "position", &reference));
+
+  hw::JointHandle reference_handle("controller/joint_1", "position");
+  ASSERT_EQ(hw::return_type::OK, robot_.get_reference_handle(reference_handle));
+  reference_handle.set_value(2.0);
+  EXPECT_EQ(2.0, reference);
+  // references are not joints
+  hw::JointHandle joint_handle("controller/joint_1", "position");
+  EXPECT_EQ(hw::return_type::ERROR, robot_.get_joint_handle(joint_handle));
+
+  EXPECT_EQ(
+    hw::return_type::OK, robot_.unregister_reference_interface("controller/joint_1", "position"));
+  EXPECT_EQ(
+    hw::return_type::ERROR,
+    robot_.unregister_reference_interface("controller/joint_1", "position"));
+  hw::JointHandle unregistered_handle("controller/joint_1", "position");
+  EXPECT_EQ(hw::return_type::ERROR, robot_.get_reference_handle(unregistered_handle));
+}
+
+TEST_F(TestRobotHardwareInterface, masks_the_claimed_joint_values)
+{
+  robot_.register_joint(JOINT_NAME, "position");
+  robot_.register_joint(JOINT_NAME, "position_command");
+  robot_.register_joint(NEW_JOINT_NAME, "position");
+  std::vector<uint64_t> mask;
+  EXPECT_EQ(hw::return_type::ERROR, robot_.get_joint_value_mask(false, mask));
+  ASSERT_EQ(hw::return_type::OK, robot_.freeze_registration());
+  ASSERT_EQ(1u, robot_.get_joint_value_mask_size());
+
+  auto & values = robot_.get_joint_values();
+  const auto position = values.get_offset(0, 0);
+  const auto command = values.get_offset(0, 1);
+  const auto new_position = values.get_offset(1, 0);
+  // all claimed until the first switch
+  EXPECT_TRUE(robot_.is_joint_value_claimed(position));
+  EXPECT_TRUE(robot_.is_joint_value_claimed(command));
+  EXPECT_TRUE(robot_.is_joint_value_claimed(new_position));
+
+  // the interfaces which are not joint interfaces are left out
+  ASSERT_EQ(
+    hw::return_type::OK,
+    robot_.get_joint_value_mask(
+      {{"position_command", {JOINT_NAME, "controller/joint_1"}}, {"velocity", {JOINT_NAME}}},
+      mask));
+  EXPECT_EQ(std::vector<uint64_t>{uint64_t(1) << command}, mask);
+  ASSERT_EQ(hw::return_type::OK, robot_.get_joint_value_mask(false, mask));
+  EXPECT_EQ(
+    std::vector<uint64_t>{
+      (uint64_t(1) << command) | (uint64_t(1) << position) | (uint64_t(1) << new_position)},
+    mask);
+
+  const std::vector<uint64_t> claimed = {uint64_t(1) << new_position};
+  ASSERT_EQ(hw::return_type::OK, robot_.set_claimed_joint_values(claimed));
+  EXPECT_FALSE(robot_.is_joint_value_claimed(position));
+  EXPECT_FALSE(robot_.is_joint_value_claimed(command));
+  EXPECT_TRUE(robot_.is_joint_value_claimed(new_position));
+  EXPECT_FALSE(robot_.is_joint_value_claimed(1000));
+  const std::vector<uint64_t> too_long(2, 0u);
+  EXPECT_EQ(hw::return_type::ERROR, robot_.set_claimed_joint_values(too_long));
+}
+
+TEST_F(TestRobotHardwareInterface, applies_operation_modes_in_one_batch_per_component)
+{
+  BatchingRobotHardware robot;
+  std::map<std::string, hw::OperationMode> modes;
+  std::vector<hw::OperationModeHandle> handles;
+  handles.reserve(4);
+  for (const auto & joint_name : {"arm_joint1", "arm_joint2", "gripper_joint", "arm_joint3"}) {
+    handles.emplace_back(joint_name, &(modes[joint_name] = hw::OperationMode::INACTIVE));
+  }
+  ASSERT_EQ(hw::return_type::OK, robot.register_operation_mode_handle(&handles[0], "arm"));
+  ASSERT_EQ(hw::return_type::OK, robot.register_operation_mode_handle(&handles[1], "arm"));
+  ASSERT_EQ(hw::return_type::OK, robot.register_operation_mode_handle(&handles[2], "gripper"));
+  ASSERT_EQ(hw::return_type::OK, robot.register_operation_mode_handle(&handles[3], "arm"));
+  EXPECT_EQ(hw::return_type::ERROR, robot.register_operation_mode_handle(&handles[3], "arm"));
+
+  EXPECT_EQ(
+    hw::return_type::OK, robot.request_operation_modes(
+      {{"arm_joint3", hw::OperationMode::ACTIVE},
+        {"gripper_joint", hw::OperationMode::ACTIVE},
+        {"arm_joint1", hw::OperationMode::INACTIVE},
+        {"arm_joint3", hw::OperationMode::INACTIVE}}));
+  using Batch = std::pair<std::string, std::vector<std::string>>;
+  EXPECT_THAT(
+    robot.batches, ElementsAre(
+      Batch{"arm", {"arm_joint3", "arm_joint1"}}, Batch{"gripper", {"gripper_joint"}}));
+  EXPECT_EQ(hw::OperationMode::INACTIVE, modes["arm_joint3"]);
+  EXPECT_EQ(hw::OperationMode::ACTIVE, modes["gripper_joint"]);
+
+  // no mode changes if one of the handles is unknown
+  robot.batches.clear();
+  EXPECT_EQ(
+    hw::return_type::ERROR, robot.request_operation_modes(
+      {{"arm_joint1", hw::OperationMode::ACTIVE}, {"unknown", hw::OperationMode::ACTIVE}}));
+  EXPECT_THAT(robot.batches, SizeIs(0));
+  EXPECT_EQ(hw::OperationMode::INACTIVE, modes["arm_joint1"]);
+
+  // a switch activates the joints of the started controllers, one batch per component
+  hw::ControllerInfo position_controller;
+  position_controller.name = "position_controller";
+  position_controller.resources = {{"position", {"arm_joint1", "arm_joint2", "arm_joint3"}}};
+  hw::ControllerInfo effort_controller;
+  effort_controller.name = "effort_controller";
+  effort_controller.resources = {{"effort", {"arm_joint1", "arm_joint2", "base_joint"}}};
+  ASSERT_EQ(hw::return_type::OK, robot.perform_switch({position_controller}, {}));
+  EXPECT_THAT(robot.batches, ElementsAre(Batch{"arm", {"arm_joint1", "arm_joint2", "arm_joint3"}}));
+
+  robot.batches.clear();
+  ASSERT_EQ(hw::return_type::OK, robot.perform_switch({effort_controller}, {position_controller}));
+  EXPECT_THAT(robot.batches, ElementsAre(Batch{"arm", {"arm_joint1", "arm_joint2", "arm_joint3"}}));
+  EXPECT_EQ(hw::OperationMode::ACTIVE, modes["arm_joint1"]);
+  EXPECT_EQ(hw::OperationMode::ACTIVE, modes["arm_joint2"]);
+  EXPECT_EQ(hw::OperationMode::INACTIVE, modes["arm_joint3"]);
+}
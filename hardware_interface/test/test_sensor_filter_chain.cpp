@@ -0,0 +1,239 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "hardware_interface/components/component_info.hpp"
+#include "hardware_interface/components/sensor.hpp"
+#include "hardware_interface/components/sensor_filter_chain.hpp"
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+
+using hardware_interface::return_type;
+using hardware_interface::components::ComponentInfo;
+using hardware_interface::components::Sensor;
+using hardware_interface::components::SensorFilterChain;
+using testing::DoubleNear;
+using testing::ElementsAre;
+
+namespace
+{
+using Parameters = std::unordered_map<std::string, std::string>;
+
+std::vector<double> filter(SensorFilterChain & chain, const std::vector<double> & input)
+{
+  std::vector<double> output(chain.get_channel_count(), -1.0);
+  EXPECT_EQ(chain.filter(input, output), return_type::OK);
+  return output;
+}
+}  // namespace
+
+TEST(TestSensorFilterChain, invalid_filters_are_rejected)
+{
+  SensorFilterChain chain;
+  EXPECT_EQ(chain.configure({}, 3), return_type::OK);
+  EXPECT_TRUE(chain.empty());
+
+  const std::vector<Parameters> invalid = {
+    {{"filters", "kalman"}},
+    {{"filters", "moving_average"}},
+    {{"filters", "moving_average"}, {"moving_average_window", "0"}},
+    {{"filters", "median"}, {"median_window", "2.5"}},
+    {{"filters", "decimation"}, {"decimation_factor", "-2"}},
+    {{"filters", "biquad"}},
+    {{"filters", "biquad"}, {"biquad_coefficients", "1 0 0"}},
+    {{"filters", "biquad"}, {"biquad_coefficients", "1 0 0 0 -1"}},
+    {{"filters", "biquad"}, {"biquad_cutoff_frequency", "600"},
+      {"biquad_sampling_frequency", "1000"}},
+  };
+  for (const auto & parameters : invalid) {
+    EXPECT_EQ(chain.configure(parameters, 3), return_type::ERROR);
+    EXPECT_TRUE(chain.empty());
+  }
+
+  ASSERT_EQ(chain.configure({{"filters", "decimation"}, {"decimation_factor", "2"}}, 3),
+    return_type::OK);
+  std::vector<double> input(3);
+  std::vector<double> output(3);
+  std::vector<double> short_values(2);
+  EXPECT_EQ(chain.filter(short_values, output), return_type::INTERFACE_VALUE_SIZE_NOT_EQUAL);
+  EXPECT_EQ(chain.filter(input, short_values), return_type::INTERFACE_VALUE_SIZE_NOT_EQUAL);
+}
+
+TEST(TestSensorFilterChain, moving_average_averages_each_channel)
+{
+  SensorFilterChain chain;
+  ASSERT_EQ(
+    chain.configure({{"filters", "moving_average"}, {"moving_average_window", "4"}}, 2),
+    return_type::OK);
+  // started from the first sample
+  EXPECT_THAT(filter(chain, {4.0, -8.0}), ElementsAre(4.0, -8.0));
+  EXPECT_THAT(filter(chain, {8.0, 0.0}), ElementsAre(5.0, -6.0));
+  EXPECT_THAT(filter(chain, {8.0, 0.0}), ElementsAre(6.0, -4.0));
+  EXPECT_THAT(filter(chain, {8.0, 0.0}), ElementsAre(7.0, -2.0));
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_THAT(filter(chain, {8.0, 0.0}), ElementsAre(8.0, 0.0));
+  }
+
+  chain.reset();
+  EXPECT_THAT(filter(chain, {1.0, 2.0}), ElementsAre(1.0, 2.0));
+}
+
+TEST(TestSensorFilterChain, median_rejects_spikes)
+{
+  SensorFilterChain chain;
+  ASSERT_EQ(
+    chain.configure({{"filters", "median"}, {"median_window", "3"}}, 2), return_type::OK);
+  EXPECT_THAT(filter(chain, {1.0, 10.0}), ElementsAre(1.0, 10.0));
+  EXPECT_THAT(filter(chain, {100.0, 11.0}), ElementsAre(1.0, 10.0));
+  EXPECT_THAT(filter(chain, {2.0, 12.0}), ElementsAre(2.0, 11.0));
+  EXPECT_THAT(filter(chain, {3.0, -50.0}), ElementsAre(3.0, 11.0));
+
+  ASSERT_EQ(
+    chain.configure({{"filters", "median"}, {"median_window", "2"}}, 1), return_type::OK);
+  EXPECT_THAT(filter(chain, {1.0}), ElementsAre(1.0));
+  EXPECT_THAT(filter(chain, {3.0}), ElementsAre(2.0));
+}
+
+TEST(TestSensorFilterChain, decimation_holds_the_output)
+{
+  SensorFilterChain chain;
+  ASSERT_EQ(
+    chain.configure(
+      {{"filters", "decimation, moving_average"}, {"decimation_factor", "3"},
+        {"moving_average_window", "2"}}, 1),
+    return_type::OK);
+  EXPECT_THAT(filter(chain, {0.0}), ElementsAre(0.0));
+  // the dropped samples leave the output as it was
+  std::vector<double> input = {1.0};
+  std::vector<double> output = {7.0};
+  EXPECT_EQ(chain.filter(input, output), return_type::OK);
+  EXPECT_THAT(output, ElementsAre(7.0));
+  input = {2.0};
+  EXPECT_EQ(chain.filter(input, output), return_type::OK);
+  EXPECT_THAT(output, ElementsAre(7.0));
+  // the filters after the decimation only see the kept samples
+  EXPECT_THAT(filter(chain, {3.0}), ElementsAre(1.5));
+  EXPECT_THAT(filter(chain, {4.0}), ElementsAre(-1.0));
+  EXPECT_THAT(filter(chain, {5.0}), ElementsAre(-1.0));
+  EXPECT_THAT(filter(chain, {6.0}), ElementsAre(4.5));
+}
+
+TEST(TestSensorFilterChain, biquad_low_pass_attenuates_the_high_frequencies)
+{
+  SensorFilterChain chain;
+  ASSERT_EQ(
+    chain.configure(
+      {{"filters", "biquad"}, {"biquad_cutoff_frequency", "20"},
+        {"biquad_sampling_frequency", "1000"}}, 2),
+    return_type::OK);
+  // no transient from the first sample
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_THAT(
+      filter(chain, {5.0, -1.0}), ElementsAre(DoubleNear(5.0, 1e-9), DoubleNear(-1.0, 1e-9)));
+  }
+
+  // a constant on the first channel, a 250 Hz oscillation on the second
+  double peak = 0.0;
+  std::vector<double> output;
+  for (int i = 0; i < 1000; ++i) {
+    output = filter(chain, {5.0, -1.0 + std::sin(M_PI / 2.0 * i)});
+    if (i > 500) {
+      peak = std::max(peak, std::abs(output[1] + 1.0));
+    }
+  }
+  EXPECT_NEAR(output[0], 5.0, 1e-9);
+  EXPECT_LT(peak, 0.01);
+
+  // the explicit coefficients of a pass-through, delayed by one sample
+  ASSERT_EQ(
+    chain.configure({{"filters", "biquad"}, {"biquad_coefficients", "0 1 0 0 0"}}, 1),
+    return_type::OK);
+  EXPECT_THAT(filter(chain, {1.0}), ElementsAre(1.0));
+  EXPECT_THAT(filter(chain, {2.0}), ElementsAre(1.0));
+  EXPECT_THAT(filter(chain, {3.0}), ElementsAre(2.0));
+}
+
+TEST(TestSensorFilterChain, sensor_exposes_the_raw_and_the_filtered_states)
+{
+  ComponentInfo info;
+  info.name = "ft_sensor";
+  info.state_interfaces = {"force_x", "force_y"};
+  info.parameters = {{"filters", "moving_average"}, {"moving_average_window", "2"}};
+  Sensor sensor;
+  ASSERT_EQ(sensor.configure(info), return_type::OK);
+  EXPECT_TRUE(sensor.has_filter_chain());
+
+  ASSERT_EQ(sensor.set_state({2.0, 4.0}), return_type::OK);
+  ASSERT_EQ(sensor.filter_states(), return_type::OK);
+  ASSERT_EQ(sensor.set_state({4.0, 8.0}), return_type::OK);
+  ASSERT_EQ(sensor.filter_states(), return_type::OK);
+
+  std::vector<double> state;
+  EXPECT_EQ(sensor.get_state(state), return_type::OK);
+  EXPECT_THAT(state, ElementsAre(4.0, 8.0));
+  EXPECT_EQ(sensor.get_filtered_state(state), return_type::OK);
+  EXPECT_THAT(state, ElementsAre(3.0, 6.0));
+  state.clear();
+  EXPECT_EQ(sensor.get_filtered_state(state, {"force_y"}), return_type::OK);
+  EXPECT_THAT(state, ElementsAre(6.0));
+  EXPECT_EQ(sensor.get_filtered_state(state, {"torque_x"}), return_type::INTERFACE_NOT_FOUND);
+
+  // without filters the filtered states are the raw ones
+  Sensor unfiltered;
+  info.parameters.clear();
+  ASSERT_EQ(unfiltered.configure(info), return_type::OK);
+  EXPECT_FALSE(unfiltered.has_filter_chain());
+  ASSERT_EQ(unfiltered.set_state({1.0, 2.0}), return_type::OK);
+  EXPECT_EQ(unfiltered.filter_states(), return_type::OK);
+  EXPECT_EQ(unfiltered.get_filtered_state(state), return_type::OK);
+  EXPECT_THAT(state, ElementsAre(1.0, 2.0));
+}
+
+TEST(TestSensorFilterChain, sensor_filters_every_queued_sample)
+{
+  ComponentInfo info;
+  info.name = "imu";
+  info.state_interfaces = {"acceleration_x"};
+  info.parameters = {
+    {Sensor::SAMPLE_QUEUE_CAPACITY_PARAMETER, "8"}, {"filters", "decimation"},
+    {"decimation_factor", "4"}};
+  Sensor sensor;
+  ASSERT_EQ(sensor.configure(info), return_type::OK);
+
+  std::vector<double> state;
+  for (int cycle = 0; cycle < 2; ++cycle) {
+    for (int i = 0; i < 6; ++i) {
+      const std::vector<double> sample = {static_cast<double>(cycle * 6 + i)};
+      ASSERT_EQ(sensor.push_sample(sample, std::chrono::nanoseconds(cycle * 6 + i)),
+        return_type::OK);
+    }
+    EXPECT_EQ(sensor.take_samples().size(), 6u);
+    ASSERT_EQ(sensor.filter_states(), return_type::OK);
+    EXPECT_EQ(sensor.get_filtered_state(state), return_type::OK);
+    // samples 0, 4, 8 are kept
+    EXPECT_THAT(state, ElementsAre(cycle == 0 ? 4.0 : 8.0));
+  }
+  // the queued samples are filtered once, the states again in the following cycles
+  ASSERT_EQ(sensor.filter_states(), return_type::OK);
+  ASSERT_EQ(sensor.filter_states(), return_type::OK);
+  EXPECT_EQ(sensor.get_filtered_state(state), return_type::OK);
+  EXPECT_THAT(state, ElementsAre(11.0));
+}
@@ -0,0 +1,169 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hardware_interface/robot_hardware.hpp"
+#include "hardware_interface/shared_memory_state_exporter.hpp"
+
+namespace hw = hardware_interface;
+using testing::Each;
+using testing::ElementsAre;
+
+namespace
+{
+class DummyRobotHardware : public hw::RobotHardware
+{
+  hw::return_type init() override
+  {
+    return hw::return_type::OK;
+  }
+
+  hw::return_type read() override
+  {
+    return hw::return_type::OK;
+  }
+
+  hw::return_type write() override
+  {
+    return hw::return_type::OK;
+  }
+};
+}  // namespace
+
+class TestSharedMemoryStateExporter : public testing::Test
+{
+public:
+  TestSharedMemoryStateExporter()
+  : segment_name_("/test_shared_memory_state_" + std::to_string(getpid()))
+  {
+    robot_.register_actuator("motor", "position", 1.0);
+    robot_.register_joint("joint1", "position", 2.0);
+    robot_.register_joint("joint1", "position_command", 3.0);
+    robot_.register_joint("joint2", "position", 4.0);
+  }
+
+protected:
+  /// Set all the joint values, padding included.
+  void set_joint_values(double value)
+  {
+    auto & arena = robot_.get_joint_values();
+    std::fill(arena.data(), arena.get_command_values() + arena.get_command_size(), value);
+  }
+
+  DummyRobotHardware robot_;
+  std::string segment_name_;
+};
+
+TEST_F(TestSharedMemoryStateExporter, requires_frozen_registration)
+{
+  hw::SharedMemoryStateExporter exporter;
+  EXPECT_EQ(hw::return_type::ERROR, exporter.open(segment_name_, robot_));
+  EXPECT_FALSE(exporter.is_open());
+  // exporting without a segment is a no-op
+  exporter.export_values();
+
+  hw::SharedMemoryStateReader reader;
+  EXPECT_EQ(hw::return_type::ERROR, reader.open(segment_name_));
+  EXPECT_FALSE(reader.is_open());
+}
+
+TEST_F(TestSharedMemoryStateExporter, exports_named_values)
+{
+  ASSERT_EQ(hw::return_type::OK, robot_.freeze_registration());
+  hw::SharedMemoryStateExporter exporter;
+  ASSERT_EQ(hw::return_type::OK, exporter.open(segment_name_, robot_));
+  ASSERT_TRUE(exporter.is_open());
+
+  hw::SharedMemoryStateReader reader;
+  ASSERT_EQ(hw::return_type::OK, reader.open(segment_name_));
+  EXPECT_THAT(reader.get_actuator_value_names(), ElementsAre("motor/position"));
+  // the command region starts on its own cache line, the padding stays unnamed
+  const auto & joint_names = reader.get_joint_value_names();
+  ASSERT_EQ(
+    hw::InterfaceValueArena::CACHE_LINE_SIZE / sizeof(double) + 1, joint_names.size());
+  EXPECT_EQ("joint1/position", joint_names[0]);
+  EXPECT_EQ("joint2/position", joint_names[1]);
+  EXPECT_EQ("", joint_names[2]);
+  EXPECT_EQ("joint1/position_command", joint_names.back());
+
+  std::vector<double> actuator_values;
+  std::vector<double> joint_values;
+  EXPECT_EQ(0u, reader.read(actuator_values, joint_values));
+
+  exporter.export_values();
+  ASSERT_EQ(1u, reader.read(actuator_values, joint_values));
+  EXPECT_THAT(actuator_values, ElementsAre(1.0));
+  EXPECT_EQ(2.0, joint_values[0]);
+  EXPECT_EQ(4.0, joint_values[1]);
+  EXPECT_EQ(3.0, joint_values.back());
+
+  *robot_.get_joint_values().get_command_values() = 5.0;
+  exporter.export_values();
+  ASSERT_EQ(2u, reader.read(actuator_values, joint_values));
+  EXPECT_EQ(5.0, joint_values.back());
+
+  // the reader keeps its mapping once the exporter removed the segment
+  exporter.close();
+  EXPECT_EQ(2u, reader.read(actuator_values, joint_values));
+  hw::SharedMemoryStateReader late_reader;
+  EXPECT_EQ(hw::return_type::ERROR, late_reader.open(segment_name_));
+}
+
+TEST_F(TestSharedMemoryStateExporter, reads_consistent_snapshots)
+{
+  ASSERT_EQ(hw::return_type::OK, robot_.freeze_registration());
+  hw::SharedMemoryStateExporter exporter;
+  ASSERT_EQ(hw::return_type::OK, exporter.open(segment_name_, robot_));
+  hw::SharedMemoryStateReader reader;
+  ASSERT_EQ(hw::return_type::OK, reader.open(segment_name_));
+
+  constexpr uint64_t kExports = 20000;
+  std::atomic<bool> done{false};
+  std::thread writer([this, &exporter, &done]() {
+      for (uint64_t cycle = 1; cycle <= kExports; ++cycle) {
+        set_joint_values(static_cast<double>(cycle));
+        exporter.export_values();
+      }
+      done = true;
+    });
+
+  std::vector<double> actuator_values;
+  std::vector<double> joint_values;
+  uint64_t last_export = 0;
+  size_t snapshots = 0;
+  while (!done) {
+    const auto exported = reader.read(actuator_values, joint_values);
+    if (exported == 0) {
+      continue;
+    }
+    // a torn copy would mix values of different cycles
+    EXPECT_THAT(joint_values, Each(static_cast<double>(exported)));
+    EXPECT_GE(exported, last_export);
+    last_export = exported;
+    ++snapshots;
+  }
+  writer.join();
+
+  EXPECT_GT(snapshots, 0u);
+  EXPECT_EQ(kExports, reader.read(actuator_values, joint_values));
+  EXPECT_THAT(joint_values, Each(static_cast<double>(kExports)));
+}
@@ -0,0 +1,85 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "hardware_interface/tracing.hpp"
+
+namespace hw = hardware_interface;
+
+namespace
+{
+class RecordingSink : public hw::TraceSink
+{
+public:
+  void on_begin(const char * phase, const char * detail, int64_t time_ns) override
+  {
+    events.push_back(std::string("begin ") + phase + " " + detail);
+    times.push_back(time_ns);
+  }
+
+  void on_end(const char * phase, const char * detail, int64_t time_ns) override
+  {
+    events.push_back(std::string("end ") + phase + " " + detail);
+    times.push_back(time_ns);
+  }
+
+  std::vector<std::string> events;
+  std::vector<int64_t> times;
+};
+}  // namespace
+
+TEST(TestTracing, scopes_are_traced_into_the_sink)
+{
+  RecordingSink sink;
+  hw::set_trace_sink(&sink);
+  {
+    HARDWARE_INTERFACE_TRACE_SCOPE("update", "");
+    hw::ScopedTrace nested("update_controller", "pid");
+  }
+  hw::set_trace_sink(nullptr);
+
+  EXPECT_THAT(
+    sink.events, testing::ElementsAre(
+      "begin update ", "begin update_controller pid", "end update_controller pid",
+      "end update "));
+  EXPECT_TRUE(std::is_sorted(sink.times.begin(), sink.times.end()));
+}
+
+TEST(TestTracing, scopes_are_not_traced_without_sink)
+{
+  RecordingSink sink;
+  hw::set_trace_sink(&sink);
+  hw::set_trace_sink(nullptr);
+  {
+    HARDWARE_INTERFACE_TRACE_SCOPE("read", "");
+  }
+  EXPECT_TRUE(sink.events.empty());
+}
+
+TEST(TestTracing, a_scope_begun_before_the_sink_is_set_is_not_ended_into_it)
+{
+  RecordingSink sink;
+  {
+    hw::ScopedTrace trace("write");
+    hw::set_trace_sink(&sink);
+  }
+  hw::set_trace_sink(nullptr);
+  EXPECT_TRUE(sink.events.empty());
+}
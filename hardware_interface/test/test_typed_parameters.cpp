@@ -0,0 +1,84 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "hardware_interface/typed_parameters.hpp"
+
+using hardware_interface::ParameterSchema;
+using hardware_interface::TypedParameters;
+using ::testing::ElementsAre;
+
+TEST(TestTypedParameters, converts_the_declared_parameters_once)
+{
+  ParameterSchema schema;
+  const auto port = schema.declare<int64_t>("port");
+  const auto gain = schema.declare<double>("gain", 0.5);
+  const auto retries = schema.declare<int64_t>("retries", 3);
+  const auto use_crc = schema.declare<bool>("use_crc");
+  const auto device = schema.declare<std::string>("device");
+  const auto offsets = schema.declare<std::vector<double>>("offsets");
+  const auto ids = schema.declare<std::vector<int64_t>>("ids");
+  const auto timeout = schema.declare_optional<double>("timeout");
+
+  const TypedParameters parameters = schema.parse(
+    {{"port", "0x1f90"}, {"gain", "1e-3"}, {"use_crc", "true"}, {"device", "/dev/ttyUSB0"},
+      {"offsets", "[0.1, -0.2,0.3]"}, {"ids", "1 2  3"}, {"undeclared", "kept as text"}},
+    "hardware arm");
+  EXPECT_EQ(8080, parameters.get(port));
+  EXPECT_DOUBLE_EQ(1e-3, parameters.get(gain));
+  EXPECT_EQ(3, parameters.get(retries));
+  EXPECT_TRUE(parameters.get(use_crc));
+  EXPECT_EQ("/dev/ttyUSB0", parameters.get(device));
+  EXPECT_THAT(parameters.get(offsets), ElementsAre(0.1, -0.2, 0.3));
+  EXPECT_THAT(parameters.get(ids), ElementsAre(1, 2, 3));
+  EXPECT_TRUE(parameters.has(retries));
+  EXPECT_FALSE(parameters.has(timeout));
+  EXPECT_FALSE(parameters.empty());
+  EXPECT_TRUE(TypedParameters().empty());
+}
+
+TEST(TestTypedParameters, reports_the_invalid_parameters)
+{
+  ParameterSchema schema;
+  schema.declare<double>("gain");
+  schema.declare<int64_t>("port", 80);
+  schema.declare<bool>("use_crc", false);
+  schema.declare<std::vector<double>>("offsets", {});
+  EXPECT_THROW(schema.declare<int64_t>("gain"), std::invalid_argument);
+
+  const std::unordered_map<std::string, std::string> valid = {{"gain", "2"}};
+  EXPECT_NO_THROW(schema.parse(valid, "hardware arm"));
+  EXPECT_THROW(schema.parse({}, "hardware arm"), std::runtime_error);
+  for (const auto & invalid : std::vector<std::unordered_map<std::string, std::string>>{
+      {{"gain", "fast"}}, {{"gain", "1.5 "}}, {{"gain", ""}},
+      {{"gain", "1"}, {"port", "80.5"}}, {{"gain", "1"}, {"port", "99999999999999999999"}},
+      {{"gain", "1"}, {"use_crc", "yes"}}, {{"gain", "1"}, {"offsets", "[1, 2"}},
+      {{"gain", "1"}, {"offsets", "1, two"}}})
+  {
+    EXPECT_THROW(schema.parse(invalid, "hardware arm"), std::runtime_error);
+  }
+  try {
+    schema.parse({{"gain", "fast"}}, "hardware arm");
+  } catch (const std::runtime_error & error) {
+    EXPECT_EQ(
+      std::string("invalid double 'fast' of parameter gain in hardware arm"), error.what());
+  }
+}
@@ -0,0 +1,115 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "hardware_interface/typed_handle.hpp"
+#include "hardware_interface/typed_value_arena.hpp"
+
+using hardware_interface::BitfieldHandle;
+using hardware_interface::InterfaceValueType;
+using hardware_interface::TypedValueArena;
+
+namespace
+{
+constexpr size_t kCacheLineSize = 64;
+
+bool is_cache_aligned(const void * ptr)
+{
+  return reinterpret_cast<std::uintptr_t>(ptr) % kCacheLineSize == 0;
+}
+}  // namespace
+
+TEST(TestTypedValueArena, lays_out_the_values_by_region_and_type)
+{
+  TypedValueArena arena;
+  for (size_t taxel = 0; taxel < 1000; ++taxel) {
+    ASSERT_TRUE(
+      arena.register_value("skin", "taxel" + std::to_string(taxel), static_cast<float>(taxel)));
+  }
+  ASSERT_TRUE(arena.register_value("drive1", "status_word", uint16_t{0x0237}));
+  ASSERT_TRUE(arena.register_value("drive1", "control_word_command", uint16_t{0x000f}));
+  ASSERT_TRUE(arena.register_value("gripper", "closed", true));
+  ASSERT_TRUE(arena.register_value("gripper", "mode_command", int32_t{-3}));
+  EXPECT_FALSE(arena.register_value("gripper", "closed", false));
+  EXPECT_EQ(1004u, arena.get_value_count());
+
+  InterfaceValueType type;
+  ASSERT_TRUE(arena.get_value_type("drive1", "status_word", type));
+  EXPECT_EQ(InterfaceValueType::UINT16, type);
+  EXPECT_FALSE(arena.get_value_type("drive1", "position", type));
+  EXPECT_EQ(nullptr, arena.get_value_ptr<bool>("gripper", "closed"));
+  EXPECT_TRUE(arena.get_state_values<float>().empty());
+
+  arena.freeze();
+  EXPECT_TRUE(arena.is_frozen());
+  EXPECT_THROW(arena.freeze(), std::runtime_error);
+  EXPECT_FALSE(arena.register_value("gripper", "open", false));
+
+  // the taxels are contiguous floats, read at once
+  const auto taxels = arena.get_state_values<float>();
+  ASSERT_EQ(1000u, taxels.size());
+  EXPECT_TRUE(is_cache_aligned(taxels.data()));
+  EXPECT_EQ(taxels.data(), arena.get_value_ptr<float>("skin", "taxel0"));
+  EXPECT_EQ(taxels.data() + 999, arena.get_value_ptr<float>("skin", "taxel999"));
+  EXPECT_EQ(999.0f, taxels[999]);
+
+  // each type starts on its own cache line, with its default values
+  const auto status_words = arena.get_state_values<uint16_t>();
+  ASSERT_EQ(1u, status_words.size());
+  EXPECT_TRUE(is_cache_aligned(status_words.data()));
+  EXPECT_EQ(0x0237, status_words[0]);
+  ASSERT_EQ(1u, arena.get_state_values<bool>().size());
+  EXPECT_TRUE(*arena.get_value_ptr<bool>("gripper", "closed"));
+  EXPECT_TRUE(arena.get_state_values<int32_t>().empty());
+  ASSERT_EQ(1u, arena.get_command_values<int32_t>().size());
+  EXPECT_EQ(-3, arena.get_command_values<int32_t>()[0]);
+
+  // the values are only found with their own type
+  EXPECT_EQ(nullptr, arena.get_value_ptr<int32_t>("drive1", "status_word"));
+  EXPECT_EQ(nullptr, arena.get_value_ptr<float>("skin", "taxel1000"));
+}
+
+TEST(TestTypedValueArena, hardware_reads_the_published_commands)
+{
+  TypedValueArena arena;
+  ASSERT_TRUE(arena.register_value("drive1", "status_word", uint16_t{0}));
+  ASSERT_TRUE(arena.register_value("drive1", "control_word_command", uint16_t{0x0006}));
+  arena.freeze();
+
+  EXPECT_EQ(
+    arena.get_value_ptr<uint16_t>("drive1", "status_word"),
+    arena.get_published_value_ptr<uint16_t>("drive1", "status_word"));
+  BitfieldHandle controller("drive1", "control_word_command",
+    arena.get_value_ptr<uint16_t>("drive1", "control_word_command"));
+  BitfieldHandle hardware("drive1", "control_word_command",
+    arena.get_published_value_ptr<uint16_t>("drive1", "control_word_command"));
+  ASSERT_NE(controller.get_value_ptr(), hardware.get_value_ptr());
+  EXPECT_TRUE(is_cache_aligned(arena.get_published_command_values<uint16_t>().data()));
+
+  // switch on and enable the operation, bits 0 and 3
+  controller.set_bit(0, true);
+  controller.set_bit(3, true);
+  controller.set_bit(1, false);
+  EXPECT_EQ(0x000d, controller.get_value());
+  EXPECT_EQ(0x0006, hardware.get_value());
+  arena.publish_commands();
+  EXPECT_EQ(0x000d, hardware.get_value());
+  EXPECT_TRUE(hardware.test_bit(3));
+  EXPECT_FALSE(hardware.test_bit(1));
+}
@@ -0,0 +1,330 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hardware_interface/packet_layout.hpp"
+#include "hardware_interface/udp_system_hardware.hpp"
+
+using hardware_interface::HardwareInfo;
+using hardware_interface::PacketByteOrder;
+using hardware_interface::PacketField;
+using hardware_interface::PacketFieldType;
+using hardware_interface::PacketLayout;
+using hardware_interface::Span;
+using hardware_interface::UdpSystemHardware;
+using hardware_interface::return_type;
+using hardware_interface::status;
+using hardware_interface::components::JointValuesBatch;
+
+namespace
+{
+PacketField make_field(
+  size_t offset, PacketFieldType type, PacketByteOrder byte_order, double scale = 1.0,
+  double bias = 0.0)
+{
+  PacketField field;
+  field.offset = offset;
+  field.type = type;
+  field.byte_order = byte_order;
+  field.scale = scale;
+  field.bias = bias;
+  return field;
+}
+
+constexpr uint8_t kStateHeader = 0xA5;
+
+/// A device sending its positions in big endian milliradians after a header byte, and its
+/// velocities as little endian floats, commanded with little endian doubles and a sequence number.
+class TestDevice : public UdpSystemHardware
+{
+public:
+  uint8_t sequence_ = 0;
+
+protected:
+  return_type configure_layouts(
+    const HardwareInfo & system_info, PacketLayout & state_layout,
+    PacketLayout & command_layout) override
+  {
+    for (size_t j = 0; j < system_info.joints.size(); ++j) {
+      if (state_layout.add_field(
+          "position", j,
+          make_field(1 + 4 * j, PacketFieldType::INT32, PacketByteOrder::BIG, 0.001)) !=
+        return_type::OK ||
+        state_layout.add_field(
+          "velocity", j,
+          make_field(9 + 4 * j, PacketFieldType::FLOAT32, PacketByteOrder::LITTLE)) !=
+        return_type::OK ||
+        command_layout.add_field(
+          "position", j,
+          make_field(8 * j, PacketFieldType::FLOAT64, PacketByteOrder::LITTLE)) != return_type::OK)
+      {
+        return return_type::ERROR;
+      }
+    }
+    command_layout.set_packet_size(command_layout.get_packet_size() + 1);
+    return return_type::OK;
+  }
+
+  bool accept_state_packet(Span<const uint8_t> packet) const override
+  {
+    return packet[0] == kStateHeader;
+  }
+
+  void finish_command_packet(Span<uint8_t> packet) override
+  {
+    packet[packet.size() - 1] = ++sequence_;
+  }
+};
+
+class TestUdpSystemHardware : public ::testing::Test
+{
+public:
+  void SetUp() override
+  {
+    peer_ = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(peer_, 0);
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(0, bind(peer_, reinterpret_cast<sockaddr *>(&address), sizeof(address)));
+    socklen_t size = sizeof(address);
+    ASSERT_EQ(0, getsockname(peer_, reinterpret_cast<sockaddr *>(&address), &size));
+    peer_port_ = ntohs(address.sin_port);
+
+    info_.name = "device";
+    info_.joints.resize(2);
+    info_.hardware_parameters["remote_address"] = "127.0.0.1";
+    info_.hardware_parameters["remote_port"] = std::to_string(peer_port_);
+    info_.hardware_parameters["local_address"] = "127.0.0.1";
+    info_.hardware_parameters["receive_timeout_ms"] = "50";
+  }
+
+  void TearDown() override
+  {
+    close(peer_);
+  }
+
+  void connect_peer(uint16_t device_port)
+  {
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(device_port);
+    ASSERT_EQ(0, connect(peer_, reinterpret_cast<sockaddr *>(&address), sizeof(address)));
+  }
+
+  void send_state(uint8_t header, int32_t position1_mrad, float velocity2)
+  {
+    std::vector<uint8_t> packet(17, 0);
+    packet[0] = header;
+    const auto position = static_cast<uint32_t>(position1_mrad);
+    for (size_t i = 0; i < 4; ++i) {
+      packet[1 + i] = static_cast<uint8_t>(position >> (8 * (3 - i)));
+    }
+    // a little endian host is assumed for the float
+    std::memcpy(&packet[13], &velocity2, sizeof(velocity2));
+    ASSERT_EQ(
+      static_cast<ssize_t>(packet.size()), send(peer_, packet.data(), packet.size(), 0));
+  }
+
+  /// Reads and writes cycles until a state is decoded, for the reads of io_uring to be rearmed
+  bool cycle_until(
+    TestDevice & device, JointValuesBatch & states, const JointValuesBatch & commands,
+    double position1)
+  {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (std::chrono::steady_clock::now() < deadline) {
+      device.read_joint_batch(states);
+      device.write_joint_batch(commands);
+      if (states.get_values(0)[0] == position1) {
+        return true;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+  }
+
+  int peer_ = -1;
+  uint16_t peer_port_ = 0;
+  HardwareInfo info_;
+};
+}  // namespace
+
+TEST(TestPacketLayout, decodes_and_encodes_scaled_fields_in_place)
+{
+  PacketLayout layout;
+  ASSERT_EQ(
+    return_type::OK,
+    layout.add_field(
+      "position", 0, make_field(0, PacketFieldType::INT16, PacketByteOrder::BIG, 0.01, 1.0)));
+  ASSERT_EQ(
+    return_type::OK,
+    layout.add_field(
+      "position", 1, make_field(2, PacketFieldType::UINT8, PacketByteOrder::LITTLE)));
+  ASSERT_EQ(
+    return_type::OK,
+    layout.add_field(
+      "effort", 0, make_field(3, PacketFieldType::FLOAT64, PacketByteOrder::BIG)));
+  EXPECT_EQ(3u, layout.get_field_count());
+  EXPECT_EQ(11u, layout.get_packet_size());
+
+  // overlapping fields, values mapped twice and null scales are refused
+  EXPECT_EQ(
+    return_type::ERROR,
+    layout.add_field("effort", 1, make_field(10, PacketFieldType::INT16, PacketByteOrder::BIG)));
+  EXPECT_EQ(
+    return_type::ERROR,
+    layout.add_field("position", 1, make_field(20, PacketFieldType::INT8, PacketByteOrder::BIG)));
+  EXPECT_EQ(
+    return_type::ERROR,
+    layout.add_field(
+      "effort", 1, make_field(20, PacketFieldType::INT8, PacketByteOrder::BIG, 0.0)));
+
+  JointValuesBatch missing_interface(2, {"position"});
+  EXPECT_EQ(return_type::INTERFACE_NOT_FOUND, layout.bind(missing_interface));
+  JointValuesBatch missing_joint(1, {"position", "effort"});
+  EXPECT_EQ(return_type::ERROR, layout.bind(missing_joint));
+  JointValuesBatch values(2, {"effort", "position"});
+  std::vector<uint8_t> packet(11, 0);
+  EXPECT_EQ(return_type::ERROR, layout.decode(packet, values));
+  ASSERT_EQ(return_type::OK, layout.bind(values));
+  EXPECT_TRUE(layout.is_bound_to(values));
+  EXPECT_FALSE(layout.is_bound_to(missing_joint));
+
+  // -150 * 0.01 + 1.0
+  const std::vector<uint8_t> state = {0xFF, 0x6A, 200, 0x40, 0x09, 0x21, 0xFB, 0x54, 0x44, 0x2D,
+    0x18};
+  ASSERT_EQ(return_type::OK, layout.decode(state, values));
+  EXPECT_DOUBLE_EQ(-0.5, values.get_values(1)[0]);
+  EXPECT_DOUBLE_EQ(200.0, values.get_values(1)[1]);
+  EXPECT_DOUBLE_EQ(M_PI, values.get_values(0)[0]);
+  // left untouched without a field
+  EXPECT_DOUBLE_EQ(0.0, values.get_values(0)[1]);
+  EXPECT_EQ(return_type::ERROR, layout.decode(Span<const uint8_t>(state.data(), 10), values));
+
+  ASSERT_EQ(return_type::OK, layout.encode(values, packet));
+  EXPECT_EQ(state, packet);
+
+  // rounded, saturated, and NaN encoded as 0
+  values.get_values(1)[0] = 1.0 + 0.0149;
+  values.get_values(1)[1] = 300.0;
+  ASSERT_EQ(return_type::OK, layout.encode(values, packet));
+  EXPECT_EQ(0x00, packet[0]);
+  EXPECT_EQ(0x01, packet[1]);
+  EXPECT_EQ(255, packet[2]);
+  values.get_values(1)[0] = -1e9;
+  values.get_values(1)[1] = std::numeric_limits<double>::quiet_NaN();
+  ASSERT_EQ(return_type::OK, layout.encode(values, packet));
+  EXPECT_EQ(0x80, packet[0]);
+  EXPECT_EQ(0x00, packet[1]);
+  EXPECT_EQ(0, packet[2]);
+}
+
+TEST_F(TestUdpSystemHardware, exchanges_the_joint_batches_in_packets)
+{
+  for (const bool use_io_uring : {true, false}) {
+    SCOPED_TRACE(use_io_uring ? "io_uring" : "batched syscalls");
+    info_.hardware_parameters["use_io_uring"] = use_io_uring ? "true" : "false";
+    TestDevice device;
+    EXPECT_TRUE(device.supports_joint_batches());
+    ASSERT_EQ(return_type::OK, device.configure(info_));
+    ASSERT_EQ(return_type::OK, device.start());
+    EXPECT_EQ(status::STARTED, device.get_status());
+    connect_peer(device.get_local_port());
+
+    JointValuesBatch states(2, {"position", "velocity"});
+    JointValuesBatch commands(2, {"position"});
+    commands.get_values(0)[0] = 0.25;
+    commands.get_values(0)[1] = -1.5;
+
+    // a rejected state is not decoded
+    send_state(0x00, 999, 9.0f);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (device.get_rejected_packet_count() == 0 &&
+      std::chrono::steady_clock::now() < deadline)
+    {
+      device.read_joint_batch(states);
+      device.write_joint_batch(commands);
+    }
+    EXPECT_EQ(1u, device.get_rejected_packet_count());
+    EXPECT_DOUBLE_EQ(0.0, states.get_values(0)[0]);
+
+    send_state(kStateHeader, 1234, -2.5f);
+    ASSERT_TRUE(cycle_until(device, states, commands, 1.234));
+    EXPECT_DOUBLE_EQ(-2.5, states.get_values(1)[1]);
+
+    uint8_t packet[64];
+    const ssize_t size = recv(peer_, packet, sizeof(packet), 0);
+    ASSERT_EQ(17, size);
+    double position;
+    std::memcpy(&position, packet + 8, sizeof(position));
+    EXPECT_DOUBLE_EQ(-1.5, position);
+    EXPECT_EQ(1, packet[16]);
+    EXPECT_EQ(0u, device.get_frame_io().get_dropped_frame_count());
+
+    ASSERT_EQ(return_type::OK, device.stop());
+    EXPECT_EQ(return_type::ERROR, device.read_joint_batch(states));
+    EXPECT_EQ(return_type::ERROR, device.write_joint_batch(commands));
+    // drains the commands of the other cycles
+    while (recv(peer_, packet, sizeof(packet), MSG_DONTWAIT) > 0) {}
+  }
+}
+
+TEST_F(TestUdpSystemHardware, times_out_without_state_packets)
+{
+  TestDevice device;
+  info_.hardware_parameters.erase("remote_address");
+  EXPECT_EQ(return_type::ERROR, device.configure(info_));
+  info_.hardware_parameters["remote_address"] = "127.0.0.1";
+  info_.hardware_parameters["receive_timeout_ms"] = "-1";
+  EXPECT_EQ(return_type::ERROR, device.configure(info_));
+  info_.hardware_parameters["receive_timeout_ms"] = "20";
+  ASSERT_EQ(return_type::OK, device.configure(info_));
+  ASSERT_EQ(return_type::OK, device.start());
+  EXPECT_EQ(return_type::ERROR, device.start());
+  connect_peer(device.get_local_port());
+
+  JointValuesBatch states(2, {"position", "velocity"});
+  JointValuesBatch commands(2, {"position"});
+  EXPECT_EQ(return_type::OK, device.read_joint_batch(states));
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  EXPECT_EQ(return_type::ERROR, device.read_joint_batch(states));
+  EXPECT_EQ(status::TIMED_OUT, device.get_status());
+
+  send_state(kStateHeader, -500, 0.0f);
+  ASSERT_TRUE(cycle_until(device, states, commands, -0.5));
+  EXPECT_EQ(status::STARTED, device.get_status());
+
+  // the batches which do not match the layouts are refused
+  JointValuesBatch other_states(1, {"position", "velocity"});
+  EXPECT_EQ(return_type::ERROR, device.read_joint_batch(other_states));
+  JointValuesBatch other_commands(2, {"velocity"});
+  EXPECT_EQ(return_type::ERROR, device.write_joint_batch(other_commands));
+}
@@ -0,0 +1,392 @@
+// Copyright 2020, ros2_control Development Team
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the copyright holders nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef JOINT_LIMITS_INTERFACE__JOINT_LIMITS_ENFORCER_HPP_
+#define JOINT_LIMITS_INTERFACE__JOINT_LIMITS_ENFORCER_HPP_
+
+#include <hardware_interface/joint_handle.hpp>
+
+#include <rclcpp/duration.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "joint_limits_interface/joint_limits.hpp"
+#include "joint_limits_interface/joint_limits_interface_exception.hpp"
+
+namespace joint_limits_interface
+{
+
+/** \brief Enforce the limits of many joints in a single pass.
+ *
+ * Applies the same policies as PositionJointSaturationHandle, VelocityJointSoftLimitsHandle and
+ * EffortJointSoftLimitsHandle, with bit-identical results, to all the joints added to it. The
+ * limits and the state of the joints are stored as structure of arrays. Each call to
+ * enforceLimits() gathers the values of the joints, computes all the commands in plain loops over
+ * these arrays, and scatters them back. The loops have selects instead of branches, so that the
+ * compiler can vectorize them. The results stay bit-identical as long as the compiler does not
+ * fuse multiply-adds differently in the handles and in the enforcer, e.g. with -ffp-contract=off
+ * or on targets without FMA instructions.
+ *
+ * The joints are added in a non real-time context. enforceLimits() and reset() are real-time safe.
+ * The values of the joints are accessed through the pointers of their handles, the values have to
+ * outlive the enforcer.
+ */
+class JointLimitsEnforcer
+{
+public:
+  /** \brief Add a position-controlled joint, limited as by PositionJointSaturationHandle. */
+  void add_position_saturation(
+    const hardware_interface::JointHandle & position,
+    const hardware_interface::JointHandle & command,
+    const JointLimits & limits)
+  {
+    const auto position_ptr = get_value_ptr(position);
+    const auto command_ptr = get_value_ptr(command);
+    auto & joints = position_saturation_;
+    joints.positions.push_back(position_ptr);
+    joints.commands.push_back(command_ptr);
+    joints.min_positions.push_back(
+      limits.has_position_limits ? limits.min_position : -std::numeric_limits<double>::max());
+    joints.max_positions.push_back(
+      limits.has_position_limits ? limits.max_position : std::numeric_limits<double>::max());
+    joints.max_velocities.push_back(limits.max_velocity);
+    joints.has_velocity_limits.push_back(limits.has_velocity_limits);
+    joints.previous_positions.push_back(std::numeric_limits<double>::quiet_NaN());
+    joints.position_values.push_back(0.0);
+    joints.command_values.push_back(0.0);
+  }
+
+  /** \brief Add a velocity-controlled joint, limited as by VelocityJointSoftLimitsHandle.
+   *
+   * The velocity state is required, VelocityJointSoftLimitsHandle can only estimate the velocity
+   * from a position history it never updates.
+   */
+  void add_velocity_soft_limits(
+    const hardware_interface::JointHandle & position,
+    const hardware_interface::JointHandle & velocity,
+    const hardware_interface::JointHandle & command,
+    const JointLimits & limits,
+    const SoftJointLimits & soft_limits)
+  {
+    auto & joints = velocity_soft_limits_;
+    add_soft_limits(joints, position, velocity, command, limits, soft_limits);
+    joints.max_velocities.back() =
+      limits.has_velocity_limits ? limits.max_velocity : std::numeric_limits<double>::max();
+  }
+
+  /** \brief Add an effort-controlled joint, limited as by EffortJointSoftLimitsHandle.
+   *
+   * The velocity state is required, EffortJointSoftLimitsHandle can only estimate the velocity
+   * from a position history it never updates.
+   * \throws JointLimitsInterfaceException if the joint has no velocity or effort limits.
+   */
+  void add_effort_soft_limits(
+    const hardware_interface::JointHandle & position,
+    const hardware_interface::JointHandle & velocity,
+    const hardware_interface::JointHandle & command,
+    const JointLimits & limits,
+    const SoftJointLimits & soft_limits)
+  {
+    if (!limits.has_velocity_limits) {
+      throw JointLimitsInterfaceException(
+              "Cannot enforce limits for joint '" + command.get_name() +
+              "'. It has no velocity limits specification.");
+    }
+    if (!limits.has_effort_limits) {
+      throw JointLimitsInterfaceException(
+              "Cannot enforce limits for joint '" + command.get_name() +
+              "'. It has no effort limits specification.");
+    }
+    add_soft_limits(effort_soft_limits_, position, velocity, command, limits, soft_limits);
+  }
+
+  /** \return The number of joints whose limits are enforced. */
+  size_t size() const
+  {
+    return position_saturation_.commands.size() + velocity_soft_limits_.commands.size() +
+           effort_soft_limits_.commands.size();
+  }
+
+  /** \name Real-Time Safe Functions
+   *\{*/
+  /** \brief Enforce the limits of all the joints.
+   * \param period Control period.
+   */
+  void enforceLimits(const rclcpp::Duration & period)
+  {
+    const double dt = period.seconds();
+    enforce_position_saturation(dt);
+    enforce_velocity_soft_limits(dt);
+    enforce_effort_soft_limits();
+  }
+
+  /** \brief Clear the stored positions, as reset() of the handles. */
+  void reset()
+  {
+    std::fill(
+      position_saturation_.previous_positions.begin(),
+      position_saturation_.previous_positions.end(),
+      std::numeric_limits<double>::quiet_NaN());
+  }
+  /*\}*/
+
+private:
+  // The flags are as wide as the values, so that the loops use the same vector lanes for both.
+  struct PositionSaturationJoints
+  {
+    std::vector<const double *> positions;
+    std::vector<double *> commands;
+    std::vector<double> min_positions;
+    std::vector<double> max_positions;
+    std::vector<double> max_velocities;
+    std::vector<int64_t> has_velocity_limits;
+    std::vector<double> previous_positions;
+    // values gathered each cycle
+    std::vector<double> position_values;
+    std::vector<double> command_values;
+  };
+
+  struct SoftLimitsJoints
+  {
+    std::vector<const double *> positions;
+    std::vector<const double *> velocities;
+    std::vector<double *> commands;
+    std::vector<double> soft_min_positions;
+    std::vector<double> soft_max_positions;
+    std::vector<double> k_positions;
+    std::vector<double> k_velocities;
+    std::vector<double> max_velocities;
+    std::vector<double> max_accelerations;
+    std::vector<double> max_efforts;
+    std::vector<int64_t> has_position_limits;
+    std::vector<int64_t> has_acceleration_limits;
+    // values gathered each cycle
+    std::vector<double> position_values;
+    std::vector<double> velocity_values;
+    std::vector<double> command_values;
+  };
+
+  static double * get_value_ptr(const hardware_interface::JointHandle & handle)
+  {
+    if (handle.get_value_ptr() == nullptr) {
+      throw JointLimitsInterfaceException(
+              "Cannot enforce limits for joint '" + handle.get_name() + "'. Its '" +
+              handle.get_interface_name() + "' handle has no value.");
+    }
+    return handle.get_value_ptr();
+  }
+
+  static void add_soft_limits(
+    SoftLimitsJoints & joints,
+    const hardware_interface::JointHandle & position,
+    const hardware_interface::JointHandle & velocity,
+    const hardware_interface::JointHandle & command,
+    const JointLimits & limits,
+    const SoftJointLimits & soft_limits)
+  {
+    const auto position_ptr = get_value_ptr(position);
+    const auto velocity_ptr = get_value_ptr(velocity);
+    const auto command_ptr = get_value_ptr(command);
+    joints.positions.push_back(position_ptr);
+    joints.velocities.push_back(velocity_ptr);
+    joints.commands.push_back(command_ptr);
+    joints.soft_min_positions.push_back(soft_limits.min_position);
+    joints.soft_max_positions.push_back(soft_limits.max_position);
+    joints.k_positions.push_back(soft_limits.k_position);
+    joints.k_velocities.push_back(soft_limits.k_velocity);
+    joints.max_velocities.push_back(limits.max_velocity);
+    joints.max_accelerations.push_back(limits.max_acceleration);
+    joints.max_efforts.push_back(limits.max_effort);
+    joints.has_position_limits.push_back(limits.has_position_limits);
+    joints.has_acceleration_limits.push_back(limits.has_acceleration_limits);
+    joints.position_values.push_back(0.0);
+    joints.velocity_values.push_back(0.0);
+    joints.command_values.push_back(0.0);
+  }
+
+  // Same comparisons as std::min, std::max and rcppmath::clamp, but on values rather than
+  // references, so that the compiler can turn them into vector min, max and blend instructions.
+  static double min_of(double a, double b)
+  {
+    return b < a ? b : a;
+  }
+
+  static double max_of(double a, double b)
+  {
+    return a < b ? b : a;
+  }
+
+  static double clamp(double value, double low, double high)
+  {
+    return value < low ? low : (high < value ? high : value);
+  }
+
+  static void gather(const std::vector<const double *> & sources, std::vector<double> & values)
+  {
+    for (size_t i = 0; i < sources.size(); ++i) {
+      values[i] = *sources[i];
+    }
+  }
+
+  static void gather(const std::vector<double *> & sources, std::vector<double> & values)
+  {
+    for (size_t i = 0; i < sources.size(); ++i) {
+      values[i] = *sources[i];
+    }
+  }
+
+  static void scatter(const std::vector<double> & values, const std::vector<double *> & targets)
+  {
+    for (size_t i = 0; i < targets.size(); ++i) {
+      *targets[i] = values[i];
+    }
+  }
+
+  void enforce_position_saturation(double dt)
+  {
+    auto & joints = position_saturation_;
+    const size_t count = joints.commands.size();
+    gather(joints.positions, joints.position_values);
+    gather(joints.commands, joints.command_values);
+
+    const double * position = joints.position_values.data();
+    const double * min_position = joints.min_positions.data();
+    const double * max_position = joints.max_positions.data();
+    const double * max_velocity = joints.max_velocities.data();
+    const int64_t * has_velocity_limits = joints.has_velocity_limits.data();
+    double * previous_position = joints.previous_positions.data();
+    double * command = joints.command_values.data();
+    for (size_t i = 0; i < count; ++i) {
+      const double previous = std::isnan(previous_position[i]) ? position[i] : previous_position[i];
+      const double delta_pos = max_velocity[i] * dt;
+      const double min_pos = has_velocity_limits[i] ?
+        max_of(previous - delta_pos, min_position[i]) : min_position[i];
+      const double max_pos = has_velocity_limits[i] ?
+        min_of(previous + delta_pos, max_position[i]) : max_position[i];
+      command[i] = clamp(command[i], min_pos, max_pos);
+      previous_position[i] = command[i];
+    }
+
+    scatter(joints.command_values, joints.commands);
+  }
+
+  void enforce_velocity_soft_limits(double dt)
+  {
+    auto & joints = velocity_soft_limits_;
+    const size_t count = joints.commands.size();
+    gather(joints.positions, joints.position_values);
+    gather(joints.velocities, joints.velocity_values);
+    gather(joints.commands, joints.command_values);
+
+    const double * position = joints.position_values.data();
+    const double * velocity = joints.velocity_values.data();
+    const double * soft_min_position = joints.soft_min_positions.data();
+    const double * soft_max_position = joints.soft_max_positions.data();
+    const double * k_position = joints.k_positions.data();
+    const double * max_velocity = joints.max_velocities.data();
+    const double * max_acceleration = joints.max_accelerations.data();
+    const int64_t * has_position_limits = joints.has_position_limits.data();
+    const int64_t * has_acceleration_limits = joints.has_acceleration_limits.data();
+    double * command = joints.command_values.data();
+    for (size_t i = 0; i < count; ++i) {
+      double min_vel = has_position_limits[i] ?
+        clamp(
+        -k_position[i] * (position[i] - soft_min_position[i]), -max_velocity[i],
+        max_velocity[i]) :
+        -max_velocity[i];
+      double max_vel = has_position_limits[i] ?
+        clamp(
+        -k_position[i] * (position[i] - soft_max_position[i]), -max_velocity[i],
+        max_velocity[i]) :
+        max_velocity[i];
+      const double delta_vel = max_acceleration[i] * dt;
+      min_vel = has_acceleration_limits[i] ? max_of(velocity[i] - delta_vel, min_vel) : min_vel;
+      max_vel = has_acceleration_limits[i] ? min_of(velocity[i] + delta_vel, max_vel) : max_vel;
+      command[i] = clamp(command[i], min_vel, max_vel);
+    }
+
+    scatter(joints.command_values, joints.commands);
+  }
+
+  void enforce_effort_soft_limits()
+  {
+    auto & joints = effort_soft_limits_;
+    const size_t count = joints.commands.size();
+    gather(joints.positions, joints.position_values);
+    gather(joints.velocities, joints.velocity_values);
+    gather(joints.commands, joints.command_values);
+
+    const double * position = joints.position_values.data();
+    const double * velocity = joints.velocity_values.data();
+    const double * soft_min_position = joints.soft_min_positions.data();
+    const double * soft_max_position = joints.soft_max_positions.data();
+    const double * k_position = joints.k_positions.data();
+    const double * k_velocity = joints.k_velocities.data();
+    const double * max_velocity = joints.max_velocities.data();
+    const double * max_effort = joints.max_efforts.data();
+    const int64_t * has_position_limits = joints.has_position_limits.data();
+    double * command = joints.command_values.data();
+    for (size_t i = 0; i < count; ++i) {
+      const double soft_min_vel = has_position_limits[i] ?
+        clamp(
+        -k_position[i] * (position[i] - soft_min_position[i]), -max_velocity[i],
+        max_velocity[i]) :
+        -max_velocity[i];
+      const double soft_max_vel = has_position_limits[i] ?
+        clamp(
+        -k_position[i] * (position[i] - soft_max_position[i]), -max_velocity[i],
+        max_velocity[i]) :
+        max_velocity[i];
+      const double soft_min_eff = clamp(
+        -k_velocity[i] * (velocity[i] - soft_min_vel), -max_effort[i], max_effort[i]);
+      const double soft_max_eff = clamp(
+        -k_velocity[i] * (velocity[i] - soft_max_vel), -max_effort[i], max_effort[i]);
+      command[i] = clamp(command[i], soft_min_eff, soft_max_eff);
+    }
+
+    scatter(joints.command_values, joints.commands);
+  }
+
+  PositionSaturationJoints position_saturation_;
+  SoftLimitsJoints velocity_soft_limits_;
+  SoftLimitsJoints effort_soft_limits_;
+};
+
+}  // namespace joint_limits_interface
+
+#endif  // JOINT_LIMITS_INTERFACE__JOINT_LIMITS_ENFORCER_HPP_
@@ -49,6 +49,7 @@
 #include <limits>
 #include <string>
 #include <memory>
+#include <vector>
 
 #include "joint_limits_interface/joint_limits.hpp"
 #include "joint_limits_interface/joint_limits_interface_exception.hpp"
@@ -628,100 +629,138 @@ private:
   double max_vel_limit_;
 };
 
-// TODO(anyone): Port this to ROS 2
-// //**
-//  * \brief Interface for enforcing joint limits.
-//  *
-//  * \tparam HandleType %Handle type. Must implement the following methods:
-//  *  \code
-//  *   void enforceLimits();
-//  *   std::string get_name() const;
-//  *  \endcode
-//  */
-// template<class HandleType>
-// class joint_limits_interface::JointLimitsInterface
-//   : public hardware_interface::ResourceManager<HandleType>
-// {
-// public:
-//   HandleType getHandle(const std::string & name)
-//   {
-//     // Rethrow exception with a meaningful type
-//     try {
-//       return this->hardware_interface::ResourceManager<HandleType>::getHandle(name);
-//     } catch (const std::logic_error & e) {
-//       throw joint_limits_interface::JointLimitsInterfaceException(e.what());
-//     }
-//   }
-//
-//   /** \name Real-Time Safe Functions
-//    *\{*/
-//   /** \brief Enforce limits for all managed handles. */
-//   void enforceLimits(const rclcpp::Duration & period)
-//   {
-//     for (auto && resource_name_and_handle : this->resource_map_) {
-//       resource_name_and_handle.second.enforceLimits(period);
-//     }
-//   }
-//   /*\}*/
-// };
-//
-// /** Interface for enforcing limits on a position-controlled joint through saturation. */
-// class PositionJointSaturationInterface
-//   : public joint_limits_interface::JointLimitsInterface<PositionJointSaturationHandle>
-// {
-// public:
-//   /** \name Real-Time Safe Functions
-//    *\{*/
-//   /** \brief Reset all managed handles. */
-//   void reset()
-//   {
-//     for (auto && resource_name_and_handle : this->resource_map_) {
-//       resource_name_and_handle.second.reset();
-//     }
-//   }
-//   /*\}*/
-// };
-//
-// /** Interface for enforcing limits on a position-controlled joint with soft position limits. */
-// class PositionJointSoftLimitsInterface
-//   : public joint_limits_interface::JointLimitsInterface<PositionJointSoftLimitsHandle>
-// {
-// public:
-//   /** \name Real-Time Safe Functions
-//    *\{*/
-//   /** \brief Reset all managed handles. */
-//   void reset()
-//   {
-//     for (auto && resource_name_and_handle : this->resource_map_) {
-//       resource_name_and_handle.second.reset();
-//     }
-//   }
-//   /*\}*/
-// };
-//
-// /** Interface for enforcing limits on an effort-controlled joint through saturation. */
-// class EffortJointSaturationInterface
-//   : public joint_limits_interface::JointLimitsInterface<EffortJointSaturationHandle>
-// {
-// };
-//
-// /** Interface for enforcing limits on an effort-controlled joint with soft position limits. */
-// class EffortJointSoftLimitsInterface
-//   : public joint_limits_interface::JointLimitsInterface<EffortJointSoftLimitsHandle>
-// {
-// };
-//
-// /** Interface for enforcing limits on a velocity-controlled joint through saturation. */
-// class VelocityJointSaturationInterface
-//   : public joint_limits_interface::JointLimitsInterface<VelocityJointSaturationHandle>
-// {
-// };
-//
-// /** Interface for enforcing limits on a velocity-controlled joint with soft position limits. */
-// class VelocityJointSoftLimitsInterface
-//   : public joint_limits_interface::JointLimitsInterface<VelocityJointSoftLimitsHandle>
-// {
-// };
+/**
+ * \brief Interface for enforcing joint limits.
+ *
+ * The handles are stored by value, in registration order, and are all of the same concrete type
+ * so that enforcing the limits of all the joints does not go through virtual dispatch.
+ *
+ * \tparam HandleType %Handle type. Must implement the following methods:
+ *  \code
+ *   void enforceLimits(const rclcpp::Duration & period);
+ *   std::string get_name() const;
+ *  \endcode
+ */
+template<class HandleType>
+class JointLimitsInterface
+{
+public:
+  /**
+   * \brief Register a handle, replacing the one of the same joint if any.
+   * References to the registered handles are invalidated.
+   */
+  void registerHandle(const HandleType & handle)
+  {
+    const auto name = handle.get_name();
+    for (auto & registered : handles_) {
+      if (registered.get_name() == name) {
+        registered = handle;
+        return;
+      }
+    }
+    handles_.push_back(handle);
+  }
+
+  /**
+   * \return The handle of a joint.
+   * \throws JointLimitsInterfaceException if no handle was registered for the joint.
+   */
+  HandleType & getHandle(const std::string & name)
+  {
+    for (auto & handle : handles_) {
+      if (handle.get_name() == name) {
+        return handle;
+      }
+    }
+    throw joint_limits_interface::JointLimitsInterfaceException(
+            "Could not find joint '" + name + "' in the joint limits interface.");
+  }
+
+  /** \return The names of the joints of the registered handles. */
+  std::vector<std::string> getNames() const
+  {
+    std::vector<std::string> names;
+    names.reserve(handles_.size());
+    for (const auto & handle : handles_) {
+      names.push_back(handle.get_name());
+    }
+    return names;
+  }
+
+  /** \name Real-Time Safe Functions
+   *\{*/
+  /** \brief Enforce limits for all managed handles. */
+  void enforceLimits(const rclcpp::Duration & period)
+  {
+    for (auto & handle : handles_) {
+      // qualified to bind the call statically
+      handle.HandleType::enforceLimits(period);
+    }
+  }
+  /*\}*/
+
+protected:
+  std::vector<HandleType> handles_;
+};
+
+/** Interface for enforcing limits on a position-controlled joint through saturation. */
+class PositionJointSaturationInterface
+  : public joint_limits_interface::JointLimitsInterface<PositionJointSaturationHandle>
+{
+public:
+  /** \name Real-Time Safe Functions
+   *\{*/
+  /** \brief Reset all managed handles. */
+  void reset()
+  {
+    for (auto & handle : handles_) {
+      handle.PositionJointSaturationHandle::reset();
+    }
+  }
+  /*\}*/
+};
+
+/** Interface for enforcing limits on a position-controlled joint with soft position limits. */
+class PositionJointSoftLimitsInterface
+  : public joint_limits_interface::JointLimitsInterface<PositionJointSoftLimitsHandle>
+{
+public:
+  /** \name Real-Time Safe Functions
+   *\{*/
+  /** \brief Reset all managed handles. */
+  void reset()
+  {
+    for (auto & handle : handles_) {
+      handle.PositionJointSoftLimitsHandle::reset();
+    }
+  }
+  /*\}*/
+};
+
+/** Interface for enforcing limits on an effort-controlled joint through saturation. */
+class EffortJointSaturationInterface
+  : public joint_limits_interface::JointLimitsInterface<EffortJointSaturationHandle>
+{
+};
+
+/** Interface for enforcing limits on an effort-controlled joint with soft position limits. */
+class EffortJointSoftLimitsInterface
+  : public joint_limits_interface::JointLimitsInterface<EffortJointSoftLimitsHandle>
+{
+};
+
+/** Interface for enforcing limits on a velocity-controlled joint through saturation. */
+class VelocityJointSaturationInterface
+  : public joint_limits_interface::JointLimitsInterface<VelocityJointSaturationHandle>
+{
+};
+
+/** Interface for enforcing limits on a velocity-controlled joint with soft position limits. */
+class VelocityJointSoftLimitsInterface
+  : public joint_limits_interface::JointLimitsInterface<VelocityJointSoftLimitsHandle>
+{
+};
+
 }  // namespace joint_limits_interface
 
 #endif  // JOINT_LIMITS_INTERFACE__JOINT_LIMITS_INTERFACE_HPP_
@@ -39,89 +39,179 @@
 
 #include <rclcpp/rclcpp.hpp>
 
+#include <array>
+#include <cstdint>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace joint_limits_interface
 {
 
-/**
- * \brief Populate a JointLimits instance from the ROS parameter server.
- *
- * It is assumed that the following parameter structure is followed on the provided NodeHandle. Unspecified parameters
- * are simply not added to the joint limits specification.
- * \code
- * joint_limits:
- *   foo_joint:
- *     has_position_limits: true
- *     min_position: 0.0
- *     max_position: 1.0
- *     has_velocity_limits: true
- *     max_velocity: 2.0
- *     has_acceleration_limits: true
- *     max_acceleration: 5.0
- *     has_jerk_limits: true
- *     max_jerk: 100.0
- *     has_effort_limits: true
- *     max_effort: 20.0
- *   bar_joint:
- *     has_position_limits: false # Continuous joint
- *     has_velocity_limits: true
- *     max_velocity: 4.0
- * \endcode
- *
- * This specification is similar to the one used by <a href="http://moveit.ros.org/wiki/MoveIt!">MoveIt!</a>,
- * but additionally supports jerk and effort limits.
- *
- * \param[in] joint_name Name of joint whose limits are to be fetched.
- * \param[in] node NodeHandle where the joint limits are specified.
- * \param[out] limits Where joint limit data gets written into. Limits specified in the parameter server will overwrite
- * existing values. Values in \p limits not specified in the parameter server remain unchanged.
- * \return True if a limits specification is found (ie. the \p joint_limits/joint_name parameter exists in \p node), false otherwise.
- */
-inline bool getJointLimits(
-  const std::string & joint_name, const rclcpp::Node::SharedPtr & node,
-  JointLimits & limits)
+namespace internal
 {
-  const std::string param_base_name = "joint_limits." + joint_name;
-  try {
-    if (!node->has_parameter(param_base_name + ".has_position_limits") &&
-      !node->has_parameter(param_base_name + ".min_position") &&
-      !node->has_parameter(param_base_name + ".max_position") &&
-      !node->has_parameter(param_base_name + ".has_velocity_limits") &&
-      !node->has_parameter(param_base_name + ".min_velocity") &&
-      !node->has_parameter(param_base_name + ".max_velocity") &&
-      !node->has_parameter(param_base_name + ".has_acceleration_limits") &&
-      !node->has_parameter(param_base_name + ".max_acceleration") &&
-      !node->has_parameter(param_base_name + ".has_jerk_limits") &&
-      !node->has_parameter(param_base_name + ".max_jerk") &&
-      !node->has_parameter(param_base_name + ".has_effort_limits") &&
-      !node->has_parameter(param_base_name + ".max_effort") &&
-      !node->has_parameter(param_base_name + ".angle_wraparound") &&
-      !node->has_parameter(param_base_name + ".has_soft_limits") &&
-      !node->has_parameter(param_base_name + ".k_position") &&
-      !node->has_parameter(param_base_name + ".k_velocity") &&
-      !node->has_parameter(param_base_name + ".soft_lower_limit") &&
-      !node->has_parameter(param_base_name + ".soft_upper_limit"))
-    {
+
+/// The parameters of a joint limits specification, in the joint_limits.<joint_name> namespace.
+enum JointLimitsParameter : size_t
+{
+  HAS_POSITION_LIMITS,
+  MIN_POSITION,
+  MAX_POSITION,
+  HAS_VELOCITY_LIMITS,
+  MIN_VELOCITY,
+  MAX_VELOCITY,
+  HAS_ACCELERATION_LIMITS,
+  MAX_ACCELERATION,
+  HAS_JERK_LIMITS,
+  MAX_JERK,
+  HAS_EFFORT_LIMITS,
+  MAX_EFFORT,
+  ANGLE_WRAPAROUND,
+  HAS_SOFT_LIMITS,
+  K_POSITION,
+  K_VELOCITY,
+  SOFT_LOWER_LIMIT,
+  SOFT_UPPER_LIMIT,
+  JOINT_LIMITS_PARAMETER_COUNT
+};
+
+inline const char * getJointLimitsParameterName(size_t parameter)
+{
+  static const char * const names[JOINT_LIMITS_PARAMETER_COUNT] = {
+    "has_position_limits", "min_position", "max_position",
+    "has_velocity_limits", "min_velocity", "max_velocity",
+    "has_acceleration_limits", "max_acceleration",
+    "has_jerk_limits", "max_jerk",
+    "has_effort_limits", "max_effort",
+    "angle_wraparound",
+    "has_soft_limits", "k_position", "k_velocity", "soft_lower_limit", "soft_upper_limit"
+  };
+  return names[parameter];
+}
+
+inline bool isJointLimitsFlag(size_t parameter)
+{
+  return parameter == HAS_POSITION_LIMITS || parameter == HAS_VELOCITY_LIMITS ||
+         parameter == HAS_ACCELERATION_LIMITS || parameter == HAS_JERK_LIMITS ||
+         parameter == HAS_EFFORT_LIMITS || parameter == ANGLE_WRAPAROUND ||
+         parameter == HAS_SOFT_LIMITS;
+}
+
+/// The joint limits parameters of one joint, as found on a node.
+struct JointLimitsSpecification
+{
+  /// Bit i is set if the parameter i exists.
+  uint32_t declared = 0;
+  /// Bit i is set if the parameter i has a value of the expected type, stored in values[i].
+  uint32_t valid = 0;
+  /// The values of the parameters, flags are stored as 0.0 or 1.0.
+  std::array<double, JOINT_LIMITS_PARAMETER_COUNT> values{};
+
+  bool isDeclared(size_t parameter) const {return (declared & (1u << parameter)) != 0;}
+
+  bool get(size_t parameter, double & value) const
+  {
+    if ((valid & (1u << parameter)) == 0) {return false;}
+    value = values[parameter];
+    return true;
+  }
+
+  bool get(size_t parameter, bool & value) const
+  {
+    double flag;
+    if (!get(parameter, flag)) {return false;}
+    value = flag != 0.0;
+    return true;
+  }
+
+  /// Store a parameter, values of an unexpected type only count as declared.
+  void set(size_t parameter, const rclcpp::Parameter & value, const rclcpp::Logger & logger)
+  {
+    declared |= 1u << parameter;
+    const auto type = value.get_type();
+    const bool is_flag = isJointLimitsFlag(parameter);
+    if (type == rclcpp::ParameterType::PARAMETER_NOT_SET) {
+      return;
+    } else if (is_flag && type == rclcpp::ParameterType::PARAMETER_BOOL) {
+      values[parameter] = value.as_bool() ? 1.0 : 0.0;
+    } else if (!is_flag && type == rclcpp::ParameterType::PARAMETER_DOUBLE) {
+      values[parameter] = value.as_double();
+    } else if (!is_flag && type == rclcpp::ParameterType::PARAMETER_INTEGER) {
+      values[parameter] = static_cast<double>(value.as_int());
+    } else {
       RCLCPP_ERROR_STREAM(
-        node->get_logger(), "No joint limits specification found for joint '" << joint_name <<
-          "' in the parameter server (node: " << std::string(
-          node->get_name()) + " param name: " + param_base_name << ").");
-      return false;
+        logger, "Ignoring joint limits parameter '" << value.get_name() <<
+          "' of unexpected type '" << value.get_type_name() << "'.");
+      return;
     }
-  } catch (const std::exception & ex) {
-    RCLCPP_ERROR_STREAM(node->get_logger(), ex.what());
+    valid |= 1u << parameter;
+  }
+};
+
+/// Parse "joint_limits.<joint_name>.<parameter>" into its joint name and parameter index.
+inline bool parseJointLimitsParameterName(
+  const std::string & name, std::string & joint_name, size_t & parameter)
+{
+  static const std::string prefix = "joint_limits.";
+  const auto separator = name.rfind('.');
+  if (separator == std::string::npos || separator <= prefix.size() ||
+    name.compare(0, prefix.size(), prefix) != 0)
+  {
+    return false;
+  }
+  const auto parameter_name = name.substr(separator + 1);
+  for (size_t i = 0; i < JOINT_LIMITS_PARAMETER_COUNT; ++i) {
+    if (parameter_name == getJointLimitsParameterName(i)) {
+      joint_name = name.substr(prefix.size(), separator - prefix.size());
+      parameter = i;
+      return true;
+    }
+  }
+  return false;
+}
+
+/// Fetch all the parameters under a prefix, with one listing and one fetch.
+inline std::vector<rclcpp::Parameter> getParametersWithPrefix(
+  const rclcpp::Node::SharedPtr & node, const std::string & prefix)
+{
+  const auto names = node->list_parameters(
+    {prefix}, rcl_interfaces::srv::ListParameters::Request::DEPTH_RECURSIVE).names;
+  return node->get_parameters(names);
+}
+
+/// Fetch the specification of a single joint.
+inline JointLimitsSpecification getJointLimitsSpecification(
+  const std::string & joint_name, const rclcpp::Node::SharedPtr & node)
+{
+  JointLimitsSpecification specification;
+  std::string parameter_joint_name;
+  size_t parameter;
+  for (const auto & value : getParametersWithPrefix(node, "joint_limits." + joint_name)) {
+    // the prefix also matches the parameters of the joints named joint_name.<something>
+    if (parseJointLimitsParameterName(value.get_name(), parameter_joint_name, parameter) &&
+      parameter_joint_name == joint_name)
+    {
+      specification.set(parameter, value, node->get_logger());
+    }
+  }
+  return specification;
+}
+
+/// Overwrite the limits specified, see getJointLimits().
+inline bool applyJointLimits(const JointLimitsSpecification & specification, JointLimits & limits)
+{
+  if (specification.declared == 0) {
     return false;
   }
 
   // Position limits
   bool has_position_limits = false;
-  if (node->get_parameter(param_base_name + ".has_position_limits", has_position_limits)) {
+  if (specification.get(HAS_POSITION_LIMITS, has_position_limits)) {
     if (!has_position_limits) {limits.has_position_limits = false;}
     double min_pos, max_pos;
     if (has_position_limits &&
-      node->get_parameter(param_base_name + ".min_position", min_pos) &&
-      node->get_parameter(param_base_name + ".max_position", max_pos))
+      specification.get(MIN_POSITION, min_pos) &&
+      specification.get(MAX_POSITION, max_pos))
     {
       limits.has_position_limits = true;
       limits.min_position = min_pos;
@@ -129,19 +219,17 @@ inline bool getJointLimits(
     }
 
     bool angle_wraparound;
-    if (!has_position_limits &&
-      node->get_parameter(param_base_name + ".angle_wraparound", angle_wraparound))
-    {
+    if (!has_position_limits && specification.get(ANGLE_WRAPAROUND, angle_wraparound)) {
       limits.angle_wraparound = angle_wraparound;
     }
   }
 
   // Velocity limits
   bool has_velocity_limits = false;
-  if (node->get_parameter(param_base_name + ".has_velocity_limits", has_velocity_limits)) {
+  if (specification.get(HAS_VELOCITY_LIMITS, has_velocity_limits)) {
     if (!has_velocity_limits) {limits.has_velocity_limits = false;}
     double max_vel;
-    if (has_velocity_limits && node->get_parameter(param_base_name + ".max_velocity", max_vel)) {
+    if (has_velocity_limits && specification.get(MAX_VELOCITY, max_vel)) {
       limits.has_velocity_limits = true;
       limits.max_velocity = max_vel;
     }
@@ -149,12 +237,10 @@ inline bool getJointLimits(
 
   // Acceleration limits
   bool has_acceleration_limits = false;
-  if (node->get_parameter(param_base_name + ".has_acceleration_limits", has_acceleration_limits)) {
+  if (specification.get(HAS_ACCELERATION_LIMITS, has_acceleration_limits)) {
     if (!has_acceleration_limits) {limits.has_acceleration_limits = false;}
     double max_acc;
-    if (has_acceleration_limits &&
-      node->get_parameter(param_base_name + ".max_acceleration", max_acc))
-    {
+    if (has_acceleration_limits && specification.get(MAX_ACCELERATION, max_acc)) {
       limits.has_acceleration_limits = true;
       limits.max_acceleration = max_acc;
     }
@@ -162,10 +248,10 @@ inline bool getJointLimits(
 
   // Jerk limits
   bool has_jerk_limits = false;
-  if (node->get_parameter(param_base_name + ".has_jerk_limits", has_jerk_limits)) {
+  if (specification.get(HAS_JERK_LIMITS, has_jerk_limits)) {
     if (!has_jerk_limits) {limits.has_jerk_limits = false;}
     double max_jerk;
-    if (has_jerk_limits && node->get_parameter(param_base_name + ".max_jerk", max_jerk)) {
+    if (has_jerk_limits && specification.get(MAX_JERK, max_jerk)) {
       limits.has_jerk_limits = true;
       limits.max_jerk = max_jerk;
     }
@@ -173,10 +259,10 @@ inline bool getJointLimits(
 
   // Effort limits
   bool has_effort_limits = false;
-  if (node->get_parameter(param_base_name + ".has_effort_limits", has_effort_limits)) {
+  if (specification.get(HAS_EFFORT_LIMITS, has_effort_limits)) {
     if (!has_effort_limits) {limits.has_effort_limits = false;}
     double max_effort;
-    if (has_effort_limits && node->get_parameter(param_base_name + ".max_effort", max_effort)) {
+    if (has_effort_limits && specification.get(MAX_EFFORT, max_effort)) {
       limits.has_effort_limits = true;
       limits.max_effort = max_effort;
     }
@@ -185,6 +271,87 @@ inline bool getJointLimits(
   return true;
 }
 
+/// Overwrite the soft limits if completely specified, see getSoftJointLimits().
+inline bool applySoftJointLimits(
+  const JointLimitsSpecification & specification, SoftJointLimits & soft_limits)
+{
+  bool has_soft_limits = false;
+  double k_position, k_velocity, min_position, max_position;
+  if (specification.get(HAS_SOFT_LIMITS, has_soft_limits) && has_soft_limits &&
+    specification.get(K_POSITION, k_position) &&
+    specification.get(K_VELOCITY, k_velocity) &&
+    specification.get(SOFT_LOWER_LIMIT, min_position) &&
+    specification.get(SOFT_UPPER_LIMIT, max_position))
+  {
+    soft_limits.k_position = k_position;
+    soft_limits.k_velocity = k_velocity;
+    soft_limits.min_position = min_position;
+    soft_limits.max_position = max_position;
+    return true;
+  }
+  return false;
+}
+
+}  // namespace internal
+
+/**
+ * \brief Populate a JointLimits instance from the ROS parameter server.
+ *
+ * It is assumed that the following parameter structure is followed on the provided NodeHandle. Unspecified parameters
+ * are simply not added to the joint limits specification.
+ * \code
+ * joint_limits:
+ *   foo_joint:
+ *     has_position_limits: true
+ *     min_position: 0.0
+ *     max_position: 1.0
+ *     has_velocity_limits: true
+ *     max_velocity: 2.0
+ *     has_acceleration_limits: true
+ *     max_acceleration: 5.0
+ *     has_jerk_limits: true
+ *     max_jerk: 100.0
+ *     has_effort_limits: true
+ *     max_effort: 20.0
+ *   bar_joint:
+ *     has_position_limits: false # Continuous joint
+ *     has_velocity_limits: true
+ *     max_velocity: 4.0
+ * \endcode
+ *
+ * This specification is similar to the one used by <a href="http://moveit.ros.org/wiki/MoveIt!">MoveIt!</a>,
+ * but additionally supports jerk and effort limits.
+ *
+ * \param[in] joint_name Name of joint whose limits are to be fetched.
+ * \param[in] node NodeHandle where the joint limits are specified.
+ * \param[out] limits Where joint limit data gets written into. Limits specified in the parameter server will overwrite
+ * existing values. Values in \p limits not specified in the parameter server remain unchanged.
+ * \return True if a limits specification is found (ie. the \p joint_limits/joint_name parameter exists in \p node), false otherwise.
+ */
+inline bool getJointLimits(
+  const std::string & joint_name, const rclcpp::Node::SharedPtr & node,
+  JointLimits & limits)
+{
+  const std::string param_base_name = "joint_limits." + joint_name;
+  internal::JointLimitsSpecification specification;
+  try {
+    specification = internal::getJointLimitsSpecification(joint_name, node);
+  } catch (const std::exception & ex) {
+    RCLCPP_ERROR_STREAM(node->get_logger(), ex.what());
+    return false;
+  }
+
+  if (specification.declared == 0) {
+    RCLCPP_ERROR_STREAM(
+      node->get_logger(), "No joint limits specification found for joint '" << joint_name <<
+        "' in the parameter server (node: " << std::string(
+        node->get_name()) + " param name: " + param_base_name << ").");
+    return false;
+  }
+
+  return internal::applyJointLimits(specification, limits);
+}
+
 /**
  * \brief Populate a SoftJointLimits instance from the ROS parameter server.
  *
@@ -213,44 +380,121 @@ inline bool getSoftJointLimits(
   SoftJointLimits & soft_limits)
 {
   const std::string param_base_name = "joint_limits." + joint_name;
+  internal::JointLimitsSpecification specification;
   try {
-    if (!node->has_parameter(param_base_name + ".has_soft_limits") &&
-      !node->has_parameter(param_base_name + ".k_velocity") &&
-      !node->has_parameter(param_base_name + ".k_position") &&
-      !node->has_parameter(param_base_name + ".soft_lower_limit") &&
-      !node->has_parameter(param_base_name + ".soft_upper_limit"))
-    {
-      RCLCPP_DEBUG_STREAM(
-        node->get_logger(), "No soft joint limits specification found for joint '" << joint_name <<
-          "' in the parameter server (node: " << std::string(
-          node->get_name()) + " param name: " + param_base_name << ").");
-      return false;
-    }
+    specification = internal::getJointLimitsSpecification(joint_name, node);
   } catch (const std::exception & ex) {
     RCLCPP_ERROR_STREAM(node->get_logger(), ex.what());
     return false;
   }
 
-  // Override soft limits if complete specification is found
-  bool has_soft_limits;
-  if (node->get_parameter(param_base_name + ".has_soft_limits", has_soft_limits)) {
-    if (has_soft_limits &&
-      node->has_parameter(param_base_name + ".k_position") &&
-      node->has_parameter(param_base_name + ".k_velocity") &&
-      node->has_parameter(param_base_name + ".soft_lower_limit") &&
-      node->has_parameter(param_base_name + ".soft_upper_limit"))
-    {
-      node->get_parameter(param_base_name + ".k_position", soft_limits.k_position);
-      node->get_parameter(param_base_name + ".k_velocity", soft_limits.k_velocity);
-      node->get_parameter(param_base_name + ".soft_lower_limit", soft_limits.min_position);
-      node->get_parameter(param_base_name + ".soft_upper_limit", soft_limits.max_position);
-      return true;
-    }
+  if (!specification.isDeclared(internal::HAS_SOFT_LIMITS) &&
+    !specification.isDeclared(internal::K_VELOCITY) &&
+    !specification.isDeclared(internal::K_POSITION) &&
+    !specification.isDeclared(internal::SOFT_LOWER_LIMIT) &&
+    !specification.isDeclared(internal::SOFT_UPPER_LIMIT))
+  {
+    RCLCPP_DEBUG_STREAM(
+      node->get_logger(), "No soft joint limits specification found for joint '" << joint_name <<
+        "' in the parameter server (node: " << std::string(
+        node->get_name()) + " param name: " + param_base_name << ").");
+    return false;
   }
 
-  return false;
+  return internal::applySoftJointLimits(specification, soft_limits);
 }
 
+/// The joint limits of all the joints specified on a node, loaded at once.
+/**
+ * Accepts the same parameter structure as getJointLimits() and getSoftJointLimits(), but fetches
+ * the parameters of all the joints with a single listing and a single fetch, instead of a few
+ * calls per joint.
+ * The specifications are kept contiguously, one per joint. A table is a plain value: it can be
+ * loaded once, e.g. by the robot or the controller manager, and shared by several controllers,
+ * e.g. through a `std::shared_ptr<const JointLimitsTable>`, instead of re-reading the
+ * parameters for each of them.
+ */
+class JointLimitsTable
+{
+public:
+  /// Replace the content of the table by the joint limits specified on \p node.
+  /**
+   * \param[in] node Node where the joint limits are specified.
+   * \return True if the parameters could be fetched, false otherwise, leaving the table empty.
+   */
+  bool load(const rclcpp::Node::SharedPtr & node)
+  {
+    joint_names_.clear();
+    specifications_.clear();
+    indices_.clear();
+
+    std::vector<rclcpp::Parameter> parameters;
+    try {
+      parameters = internal::getParametersWithPrefix(node, "joint_limits");
+    } catch (const std::exception & ex) {
+      RCLCPP_ERROR_STREAM(node->get_logger(), ex.what());
+      return false;
+    }
+
+    std::string joint_name;
+    size_t parameter;
+    for (const auto & value : parameters) {
+      if (!internal::parseJointLimitsParameterName(value.get_name(), joint_name, parameter)) {
+        continue;
+      }
+      auto index = indices_.find(joint_name);
+      if (index == indices_.end()) {
+        index = indices_.emplace(joint_name, joint_names_.size()).first;
+        joint_names_.push_back(joint_name);
+        specifications_.emplace_back();
+      }
+      specifications_[index->second].set(parameter, value, node->get_logger());
+    }
+    return true;
+  }
+
+  /// Number of joints with a joint limits specification.
+  size_t size() const {return joint_names_.size();}
+
+  /// Names of the joints with a joint limits specification, in the order of the table.
+  const std::vector<std::string> & getJointNames() const {return joint_names_;}
+
+  bool hasJoint(const std::string & joint_name) const {return indices_.count(joint_name) > 0;}
+
+  /// Populate a JointLimits instance from the table, like getJointLimits() does from a node.
+  /**
+   * \param[in] joint_name Name of joint whose limits are to be fetched.
+   * \param[out] limits Where joint limit data gets written into, values not specified in the
+   * table remain unchanged.
+   * \return True if a limits specification is found for \p joint_name, false otherwise.
+   */
+  bool getJointLimits(const std::string & joint_name, JointLimits & limits) const
+  {
+    const auto index = indices_.find(joint_name);
+    return index != indices_.end() &&
+           internal::applyJointLimits(specifications_[index->second], limits);
+  }
+
+  /// Populate a SoftJointLimits instance from the table, like getSoftJointLimits() does.
+  /**
+   * \param[in] joint_name Name of joint whose soft limits are to be fetched.
+   * \param[out] soft_limits Where soft joint limit data gets written into.
+   * \return True if a complete soft limits specification is found for \p joint_name, false
+   * otherwise.
+   */
+  bool getSoftJointLimits(const std::string & joint_name, SoftJointLimits & soft_limits) const
+  {
+    const auto index = indices_.find(joint_name);
+    return index != indices_.end() &&
+           internal::applySoftJointLimits(specifications_[index->second], soft_limits);
+  }
+
+private:
+  std::vector<std::string> joint_names_;
+  std::vector<internal::JointLimitsSpecification> specifications_;
+  std::unordered_map<std::string, size_t> indices_;
+};
+
 }  // namespace joint_limits_interface
 
 #endif  // JOINT_LIMITS_INTERFACE__JOINT_LIMITS_ROSPARAM_HPP_
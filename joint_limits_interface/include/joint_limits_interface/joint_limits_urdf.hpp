@@ -36,10 +36,13 @@
 #define JOINT_LIMITS_INTERFACE__JOINT_LIMITS_URDF_HPP_
 
 #include <rclcpp/rclcpp.hpp>
+#include <tinyxml2.h>
 #include <urdf_model/joint.h>
 #include <urdf/urdfdom_compatibility.h>
 #include <joint_limits_interface/joint_limits.hpp>
 
+#include <cstring>
+
 namespace joint_limits_interface
 {
 
@@ -98,6 +101,92 @@ inline bool getSoftJointLimits(urdf::JointConstSharedPtr urdf_joint, SoftJointLi
   return true;
 }
 
+/**
+ * \brief Populate a JointLimits instance from a URDF joint element.
+ *
+ * Reads the joint element of an already parsed robot description, e.g. one found by
+ * hardware_interface::URDFDocument::find_joint_element(), instead of building a urdf::Model.
+ * The limits are populated as from the equivalent urdf::Joint.
+ * \param[in] urdf_joint URDF joint element.
+ * \param[out] limits Where URDF joint limit data gets written into. Limits in \e urdf_joint will
+ * overwrite existing values. Values in \e limits not present in \e urdf_joint remain unchanged.
+ * \return True if \e urdf_joint has a valid limits specification, false otherwise.
+ */
+inline bool getJointLimits(const tinyxml2::XMLElement * urdf_joint, JointLimits & limits)
+{
+  if (!urdf_joint) {
+    return false;
+  }
+  // effort and velocity are required, the bounds default to 0 as in urdfdom
+  const auto * urdf_limits = urdf_joint->FirstChildElement("limit");
+  double effort, velocity;
+  if (!urdf_limits ||
+    urdf_limits->QueryDoubleAttribute("effort", &effort) != tinyxml2::XML_SUCCESS ||
+    urdf_limits->QueryDoubleAttribute("velocity", &velocity) != tinyxml2::XML_SUCCESS)
+  {
+    return false;
+  }
+
+  const char * type = urdf_joint->Attribute("type");
+  const auto is_type = [type](const char * name) {return type && !std::strcmp(type, name);};
+  limits.has_position_limits = is_type("revolute") || is_type("prismatic");
+  if (limits.has_position_limits) {
+    double lower = 0.0, upper = 0.0;
+    urdf_limits->QueryDoubleAttribute("lower", &lower);
+    urdf_limits->QueryDoubleAttribute("upper", &upper);
+    limits.min_position = lower;
+    limits.max_position = upper;
+  }
+
+  if (!limits.has_position_limits && is_type("continuous")) {
+    limits.angle_wraparound = true;
+  }
+
+  limits.has_velocity_limits = true;
+  limits.max_velocity = velocity;
+
+  limits.has_acceleration_limits = false;
+
+  limits.has_effort_limits = true;
+  limits.max_effort = effort;
+
+  return true;
+}
+
+/**
+ * \brief Populate a SoftJointLimits instance from a URDF joint element.
+ * \param[in] urdf_joint URDF joint element, see getJointLimits().
+ * \param[out] soft_limits Where URDF soft joint limit data gets written into.
+ * \return True if \e urdf_joint has a valid soft limits specification, false otherwise.
+ */
+inline bool getSoftJointLimits(
+  const tinyxml2::XMLElement * urdf_joint, SoftJointLimits & soft_limits)
+{
+  if (!urdf_joint) {
+    return false;
+  }
+  // k_velocity is required, the other values default to 0 as in urdfdom
+  const auto * urdf_safety = urdf_joint->FirstChildElement("safety_controller");
+  double k_velocity;
+  if (!urdf_safety ||
+    urdf_safety->QueryDoubleAttribute("k_velocity", &k_velocity) != tinyxml2::XML_SUCCESS)
+  {
+    return false;
+  }
+
+  double soft_lower_limit = 0.0, soft_upper_limit = 0.0, k_position = 0.0;
+  urdf_safety->QueryDoubleAttribute("soft_lower_limit", &soft_lower_limit);
+  urdf_safety->QueryDoubleAttribute("soft_upper_limit", &soft_upper_limit);
+  urdf_safety->QueryDoubleAttribute("k_position", &k_position);
+
+  soft_limits.min_position = soft_lower_limit;
+  soft_limits.max_position = soft_upper_limit;
+  soft_limits.k_position = k_position;
+  soft_limits.k_velocity = k_velocity;
+
+  return true;
+}
+
 }  // namespace joint_limits_interface
 
 #endif  // JOINT_LIMITS_INTERFACE__JOINT_LIMITS_URDF_HPP_
@@ -0,0 +1,241 @@
+// Copyright 2020, ros2_control Development Team
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the copyright holders nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <gtest/gtest.h>
+
+#include <joint_limits_interface/joint_limits_enforcer.hpp>
+#include <joint_limits_interface/joint_limits_interface.hpp>
+
+#include <rclcpp/rclcpp.hpp>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using hardware_interface::JointHandle;
+using joint_limits_interface::JointLimits;
+using joint_limits_interface::JointLimitsEnforcer;
+using joint_limits_interface::SoftJointLimits;
+
+namespace
+{
+constexpr size_t kJointCount = 40;
+constexpr size_t kCycleCount = 50;
+
+/// The values of a joint, stored once for the handles and once for the enforcer
+struct JointValues
+{
+  double position = 0.0;
+  double velocity = 0.0;
+  double command = 0.0;
+};
+}  // namespace
+
+class JointLimitsEnforcerTest : public ::testing::Test
+{
+public:
+  JointLimitsEnforcerTest()
+  : period(0, 10000000),
+    handle_values(kJointCount),
+    enforcer_values(kJointCount),
+    random(42)
+  {
+    for (size_t i = 0; i < kJointCount; ++i) {
+      // mix the optional limits over the joints
+      limits[i].has_position_limits = i % 3 != 0;
+      limits[i].min_position = -1.0 - 0.01 * i;
+      limits[i].max_position = 1.0 + 0.01 * i;
+      limits[i].has_velocity_limits = i % 4 != 1;
+      limits[i].max_velocity = 2.0 + 0.1 * i;
+      limits[i].has_acceleration_limits = i % 2 == 0;
+      limits[i].max_acceleration = 10.0 + i;
+      limits[i].has_effort_limits = true;
+      limits[i].max_effort = 8.0 + 0.2 * i;
+      soft_limits[i].min_position = limits[i].min_position + 0.2;
+      soft_limits[i].max_position = limits[i].max_position - 0.2;
+      soft_limits[i].k_position = 20.0 - 0.1 * i;
+      soft_limits[i].k_velocity = 40.0 + 0.3 * i;
+    }
+  }
+
+protected:
+  JointHandle make_handle(size_t index, const std::string & interface_name, double * value)
+  {
+    return JointHandle("joint" + std::to_string(index), interface_name, value);
+  }
+
+  std::shared_ptr<JointHandle> make_shared_handle(
+    size_t index, const std::string & interface_name, double * value)
+  {
+    return std::make_shared<JointHandle>(make_handle(index, interface_name, value));
+  }
+
+  /// Set the same random state and command to both copies of the values.
+  void randomize(double command_range)
+  {
+    std::uniform_real_distribution<double> position(-1.5, 1.5);
+    std::uniform_real_distribution<double> velocity(-3.0, 3.0);
+    std::uniform_real_distribution<double> command(-command_range, command_range);
+    for (size_t i = 0; i < kJointCount; ++i) {
+      handle_values[i].position = position(random);
+      handle_values[i].velocity = velocity(random);
+      handle_values[i].command = command(random);
+      enforcer_values[i] = handle_values[i];
+    }
+  }
+
+  void expect_same_commands(size_t cycle)
+  {
+    for (size_t i = 0; i < kJointCount; ++i) {
+      // bit-identical, not only close
+      EXPECT_EQ(handle_values[i].command, enforcer_values[i].command) <<
+        "joint " << i << " in cycle " << cycle;
+    }
+  }
+
+  rclcpp::Duration period;
+  JointLimits limits[kJointCount];
+  SoftJointLimits soft_limits[kJointCount];
+  std::vector<JointValues> handle_values;
+  std::vector<JointValues> enforcer_values;
+  std::mt19937 random;
+};
+
+TEST_F(JointLimitsEnforcerTest, position_saturation_matches_handles)
+{
+  std::vector<joint_limits_interface::PositionJointSaturationHandle> handles;
+  JointLimitsEnforcer enforcer;
+  for (size_t i = 0; i < kJointCount; ++i) {
+    handles.emplace_back(
+      make_shared_handle(i, "position", &handle_values[i].position),
+      make_shared_handle(i, "position_command", &handle_values[i].command),
+      limits[i]);
+    enforcer.add_position_saturation(
+      make_handle(i, "position", &enforcer_values[i].position),
+      make_handle(i, "position_command", &enforcer_values[i].command),
+      limits[i]);
+  }
+  ASSERT_EQ(kJointCount, enforcer.size());
+
+  for (size_t cycle = 0; cycle < kCycleCount; ++cycle) {
+    if (cycle == kCycleCount / 2) {
+      for (auto & handle : handles) {
+        handle.reset();
+      }
+      enforcer.reset();
+    }
+    randomize(2.0);
+    for (auto & handle : handles) {
+      handle.enforceLimits(period);
+    }
+    enforcer.enforceLimits(period);
+    expect_same_commands(cycle);
+  }
+}
+
+TEST_F(JointLimitsEnforcerTest, velocity_soft_limits_match_handles)
+{
+  std::vector<joint_limits_interface::VelocityJointSoftLimitsHandle> handles;
+  JointLimitsEnforcer enforcer;
+  for (size_t i = 0; i < kJointCount; ++i) {
+    handles.emplace_back(
+      make_shared_handle(i, "position", &handle_values[i].position),
+      make_shared_handle(i, "velocity", &handle_values[i].velocity),
+      make_shared_handle(i, "velocity_command", &handle_values[i].command),
+      limits[i], soft_limits[i]);
+    enforcer.add_velocity_soft_limits(
+      make_handle(i, "position", &enforcer_values[i].position),
+      make_handle(i, "velocity", &enforcer_values[i].velocity),
+      make_handle(i, "velocity_command", &enforcer_values[i].command),
+      limits[i], soft_limits[i]);
+  }
+
+  for (size_t cycle = 0; cycle < kCycleCount; ++cycle) {
+    randomize(6.0);
+    for (auto & handle : handles) {
+      handle.enforceLimits(period);
+    }
+    enforcer.enforceLimits(period);
+    expect_same_commands(cycle);
+  }
+}
+
+TEST_F(JointLimitsEnforcerTest, effort_soft_limits_match_handles)
+{
+  std::vector<joint_limits_interface::EffortJointSoftLimitsHandle> handles;
+  JointLimitsEnforcer enforcer;
+  for (size_t i = 0; i < kJointCount; ++i) {
+    limits[i].has_velocity_limits = true;
+    handles.emplace_back(
+      make_shared_handle(i, "position", &handle_values[i].position),
+      make_shared_handle(i, "velocity", &handle_values[i].velocity),
+      make_shared_handle(i, "effort_command", &handle_values[i].command),
+      limits[i], soft_limits[i]);
+    enforcer.add_effort_soft_limits(
+      make_handle(i, "position", &enforcer_values[i].position),
+      make_handle(i, "velocity", &enforcer_values[i].velocity),
+      make_handle(i, "effort_command", &enforcer_values[i].command),
+      limits[i], soft_limits[i]);
+  }
+
+  for (size_t cycle = 0; cycle < kCycleCount; ++cycle) {
+    randomize(20.0);
+    for (auto & handle : handles) {
+      handle.enforceLimits(period);
+    }
+    enforcer.enforceLimits(period);
+    expect_same_commands(cycle);
+  }
+}
+
+TEST_F(JointLimitsEnforcerTest, rejects_invalid_joints)
+{
+  JointLimitsEnforcer enforcer;
+  double value = 0.0;
+  EXPECT_THROW(
+    enforcer.add_position_saturation(
+      make_handle(0, "position", nullptr), make_handle(0, "position_command", &value), limits[0]),
+    joint_limits_interface::JointLimitsInterfaceException);
+
+  JointLimits no_effort_limits = limits[0];
+  no_effort_limits.has_effort_limits = false;
+  EXPECT_THROW(
+    enforcer.add_effort_soft_limits(
+      make_handle(0, "position", &value), make_handle(0, "velocity", &value),
+      make_handle(0, "effort_command", &value), no_effort_limits, soft_limits[0]),
+    joint_limits_interface::JointLimitsInterfaceException);
+  EXPECT_EQ(0u, enforcer.size());
+
+  // nothing to enforce
+  enforcer.enforceLimits(period);
+}
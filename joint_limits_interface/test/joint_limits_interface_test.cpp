@@ -521,56 +521,50 @@ protected:
   std::shared_ptr<hardware_interface::JointHandle> pos2_handle, vel2_handle, eff2_handle;
 };
 
-// TEST_F(JointLimitsInterfaceTest, InterfaceRegistration)
-// {
-//   // Populate interface
-//   joint_limits_interface::PositionJointSoftLimitsHandle limits_handle1(
-//     pos_handle, cmd_handle, limits, soft_limits);
-//   joint_limits_interface::PositionJointSoftLimitsHandle limits_handle2(
-//     pos_handle2, cmd_handle2, limits, soft_limits);
-//
-//   joint_limits_interface::PositionJointSoftLimitsInterface iface;
-//   iface.registerHandle(limits_handle1);
-//   iface.registerHandle(limits_handle2);
-//
-//   // Get handles
-//   EXPECT_NO_THROW(iface.getHandle(name));
-//   EXPECT_NO_THROW(iface.getHandle(name2));
-//
-//   PositionJointSoftLimitsHandle h1_tmp = iface.getHandle(name);
-//   EXPECT_EQ(name, h1_tmp.getName());
-//
-//   PositionJointSoftLimitsHandle h2_tmp = iface.getHandle(name2);
-//   EXPECT_EQ(name2, h2_tmp.getName());
-//
-//   // Print error message
-//   // Requires manual output inspection, but exception message should contain the interface name
-//   // (not its base class)
-//   try {
-//     iface.getHandle("unknown_name");
-//   } catch (const JointLimitsInterfaceException & e) {
-//     ROS_ERROR_STREAM(e.what());
-//   }
-//
-//   // Enforce limits of all managed joints
-//   // Halfway between soft and hard limit
-//   pos = pos2 = (soft_limits.max_position + limits.max_position) / 2.0;
-//   // Try to get closer to the hard limit
-//   cmd_handle->set_value(limits.max_position);
-//   cmd_handle2.set_cmd(limits.max_position);
-//   iface.enforceLimits(period);
-//   EXPECT_GT(pos_handle->get_value(), cmd_handle->get_value());
-//   EXPECT_GT(cmd_handle2.getPosition(), cmd_handle2.get_cmd());
-// }
-//
-#if 0  // todo: implement the interfaces
+TEST_F(JointLimitsInterfaceTest, InterfaceRegistration)
+{
+  // Populate interface
+  joint_limits_interface::PositionJointSoftLimitsHandle limits_handle1(
+    pos_handle, cmd_handle, limits, soft_limits);
+  joint_limits_interface::PositionJointSoftLimitsHandle limits_handle2(
+    pos2_handle, cmd2_handle, limits, soft_limits);
+
+  joint_limits_interface::PositionJointSoftLimitsInterface iface;
+  iface.registerHandle(limits_handle1);
+  iface.registerHandle(limits_handle2);
+
+  // Get handles
+  EXPECT_NO_THROW(iface.getHandle(name));
+  EXPECT_NO_THROW(iface.getHandle(name2));
+  EXPECT_EQ(name, iface.getHandle(name).get_name());
+  EXPECT_EQ(name2, iface.getHandle(name2).get_name());
+  EXPECT_THROW(
+    iface.getHandle("unknown_name"), joint_limits_interface::JointLimitsInterfaceException);
+
+  // Registering the same joint again replaces its handle
+  iface.registerHandle(limits_handle1);
+  ASSERT_EQ(2u, iface.getNames().size());
+  EXPECT_EQ(name, iface.getNames()[0]);
+  EXPECT_EQ(name2, iface.getNames()[1]);
+
+  // Enforce limits of all managed joints
+  // Halfway between soft and hard limit
+  pos = pos2 = (soft_limits.max_position + limits.max_position) / 2.0;
+  // Try to get closer to the hard limit
+  cmd_handle->set_value(limits.max_position);
+  cmd2_handle->set_value(limits.max_position);
+  iface.enforceLimits(period);
+  EXPECT_GT(pos_handle->get_value(), cmd_handle->get_value());
+  EXPECT_GT(pos2_handle->get_value(), cmd2_handle->get_value());
+}
+
 TEST_F(JointLimitsHandleTest, ResetSaturationInterface)
 {
   // Populate interface
-  joint_limits_interface::PositionJointSaturationHandle limits_handle1
-    (pos_handle, cmd_handle, limits);
+  joint_limits_interface::PositionJointSaturationHandle limits_handle1(
+    pos_handle, cmd_handle, limits);
 
-  PositionJointSaturationInterface iface;
+  joint_limits_interface::PositionJointSaturationInterface iface;
   iface.registerHandle(limits_handle1);
 
   iface.enforceLimits(period);  // initialize limit handles
@@ -589,33 +583,32 @@ TEST_F(JointLimitsHandleTest, ResetSaturationInterface)
 
   EXPECT_NEAR(cmd_handle->get_value(), limits.max_position, EPS);
 }
-#endif
 
-// TEST_F(JointLimitsHandleTest, ResetSoftLimitsInterface)
-// {
-//   // Populate interface
-//   PositionJointSoftLimitsHandle limits_handle1(cmd_handle, limits, soft_limits);
-//
-//   PositionJointSoftLimitsInterface iface;
-//   iface.registerHandle(limits_handle1);
-//
-//   iface.enforceLimits(period); // initialize limit handles
-//
-//   const double max_increment = period.seconds() * limits.max_velocity;
-//
-//   cmd_handle->set_value(limits.max_position);
-//   iface.enforceLimits(period);
-//
-//   EXPECT_NEAR(cmd_handle->get_value(), max_increment, EPS);
-//
-//   iface.reset();
-//   pos = limits.max_position;
-//   cmd_handle->set_value(soft_limits.max_position);
-//   iface.enforceLimits(period);
-//
-//   EXPECT_NEAR(cmd_handle->get_value(), soft_limits.max_position, EPS);
-//
-// }
+TEST_F(JointLimitsHandleTest, ResetSoftLimitsInterface)
+{
+  // Populate interface
+  joint_limits_interface::PositionJointSoftLimitsHandle limits_handle1(
+    pos_handle, cmd_handle, limits, soft_limits);
+
+  joint_limits_interface::PositionJointSoftLimitsInterface iface;
+  iface.registerHandle(limits_handle1);
+
+  iface.enforceLimits(period);  // initialize limit handles
+
+  const double max_increment = period.seconds() * limits.max_velocity;
+
+  cmd_handle->set_value(limits.max_position);
+  iface.enforceLimits(period);
+
+  EXPECT_NEAR(cmd_handle->get_value(), max_increment, EPS);
+
+  iface.reset();
+  pos = limits.max_position;
+  cmd_handle->set_value(soft_limits.max_position);
+  iface.enforceLimits(period);
+
+  EXPECT_NEAR(cmd_handle->get_value(), soft_limits.max_position, EPS);
+}
 
 int main(int argc, char ** argv)
 {
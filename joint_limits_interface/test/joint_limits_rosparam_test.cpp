@@ -208,6 +208,57 @@ TEST_F(JointLimitsRosParamTest, GetSoftJointLimits)
   }
 }
 
+TEST_F(JointLimitsRosParamTest, JointLimitsTable)
+{
+  joint_limits_interface::JointLimitsTable table;
+  ASSERT_TRUE(table.load(node_));
+  EXPECT_TRUE(table.hasJoint("foo_joint"));
+  EXPECT_FALSE(table.hasJoint("unknown_joint"));
+  ASSERT_EQ(table.getJointNames().size(), table.size());
+
+  // Every joint of the table is loaded as by the per-joint functions
+  for (const auto & joint_name : table.getJointNames()) {
+    for (bool initial_limits : {false, true}) {
+      joint_limits_interface::JointLimits limits, limits_ref;
+      limits.has_velocity_limits = limits_ref.has_velocity_limits = initial_limits;
+      limits.max_velocity = limits_ref.max_velocity = 3.0;
+      EXPECT_EQ(
+        getJointLimits(joint_name, node_, limits_ref),
+        table.getJointLimits(joint_name, limits)) << joint_name;
+
+      EXPECT_EQ(limits_ref.has_position_limits, limits.has_position_limits) << joint_name;
+      EXPECT_EQ(limits_ref.min_position, limits.min_position) << joint_name;
+      EXPECT_EQ(limits_ref.max_position, limits.max_position) << joint_name;
+      EXPECT_EQ(limits_ref.has_velocity_limits, limits.has_velocity_limits) << joint_name;
+      EXPECT_EQ(limits_ref.max_velocity, limits.max_velocity) << joint_name;
+      EXPECT_EQ(limits_ref.has_acceleration_limits, limits.has_acceleration_limits) << joint_name;
+      EXPECT_EQ(limits_ref.max_acceleration, limits.max_acceleration) << joint_name;
+      EXPECT_EQ(limits_ref.has_jerk_limits, limits.has_jerk_limits) << joint_name;
+      EXPECT_EQ(limits_ref.max_jerk, limits.max_jerk) << joint_name;
+      EXPECT_EQ(limits_ref.has_effort_limits, limits.has_effort_limits) << joint_name;
+      EXPECT_EQ(limits_ref.max_effort, limits.max_effort) << joint_name;
+      EXPECT_EQ(limits_ref.angle_wraparound, limits.angle_wraparound) << joint_name;
+    }
+
+    joint_limits_interface::SoftJointLimits soft_limits, soft_limits_ref;
+    EXPECT_EQ(
+      getSoftJointLimits(joint_name, node_, soft_limits_ref),
+      table.getSoftJointLimits(joint_name, soft_limits)) << joint_name;
+    EXPECT_EQ(soft_limits_ref.k_position, soft_limits.k_position) << joint_name;
+    EXPECT_EQ(soft_limits_ref.k_velocity, soft_limits.k_velocity) << joint_name;
+    EXPECT_EQ(soft_limits_ref.min_position, soft_limits.min_position) << joint_name;
+    EXPECT_EQ(soft_limits_ref.max_position, soft_limits.max_position) << joint_name;
+  }
+
+  // Unknown joints are left untouched
+  joint_limits_interface::JointLimits limits;
+  joint_limits_interface::SoftJointLimits soft_limits;
+  EXPECT_FALSE(table.getJointLimits("unknown_joint", limits));
+  EXPECT_FALSE(table.getSoftJointLimits("unknown_joint", soft_limits));
+  EXPECT_FALSE(limits.has_position_limits);
+  EXPECT_EQ(0.0, soft_limits.k_position);
+}
+
 int main(int argc, char ** argv)
 {
   rclcpp::init(argc, argv);
@@ -34,6 +34,7 @@
 
 #include <gtest/gtest.h>
 
+#include <hardware_interface/urdf_document.hpp>
 #include <joint_limits_interface/joint_limits_urdf.hpp>
 
 #include <string>
@@ -187,6 +188,78 @@ TEST_F(JointLimitsUrdfTest, GetSoftJointLimits)
   }
 }
 
+TEST_F(JointLimitsUrdfTest, GetJointLimitsFromURDFDocument)
+{
+  const hardware_interface::URDFDocument urdf(
+    R"(
+<robot name="robot">
+  <joint name="revolute_joint" type="revolute">
+    <limit effort="8.0" velocity="2.0" lower="-1.0" upper="1.0"/>
+    <safety_controller k_position="20.0" k_velocity="40.0" soft_lower_limit="-0.8"
+      soft_upper_limit="0.8"/>
+  </joint>
+  <joint name="continuous_joint" type="continuous">
+    <limit effort="8.0" velocity="2.0"/>
+  </joint>
+  <joint name="fixed_joint" type="fixed"/>
+  <joint name="incomplete_joint" type="prismatic">
+    <limit velocity="2.0" lower="-1.0" upper="1.0"/>
+    <safety_controller k_position="20.0"/>
+  </joint>
+</robot>
+)");
+
+  // Same limits as from the equivalent urdf::Joint
+  {
+    urdf_joint->type = urdf::Joint::REVOLUTE;
+    joint_limits_interface::JointLimits limits, limits_ref;
+    EXPECT_TRUE(getJointLimits(urdf.find_joint_element("revolute_joint"), limits));
+    EXPECT_TRUE(getJointLimits(urdf_joint, limits_ref));
+
+    EXPECT_EQ(limits_ref.has_position_limits, limits.has_position_limits);
+    EXPECT_DOUBLE_EQ(limits_ref.min_position, limits.min_position);
+    EXPECT_DOUBLE_EQ(limits_ref.max_position, limits.max_position);
+    EXPECT_EQ(limits_ref.angle_wraparound, limits.angle_wraparound);
+    EXPECT_EQ(limits_ref.has_velocity_limits, limits.has_velocity_limits);
+    EXPECT_DOUBLE_EQ(limits_ref.max_velocity, limits.max_velocity);
+    EXPECT_EQ(limits_ref.has_acceleration_limits, limits.has_acceleration_limits);
+    EXPECT_EQ(limits_ref.has_effort_limits, limits.has_effort_limits);
+    EXPECT_DOUBLE_EQ(limits_ref.max_effort, limits.max_effort);
+
+    joint_limits_interface::SoftJointLimits soft_limits;
+    EXPECT_TRUE(getSoftJointLimits(urdf.find_joint_element("revolute_joint"), soft_limits));
+    EXPECT_DOUBLE_EQ(urdf_joint->safety->soft_lower_limit, soft_limits.min_position);
+    EXPECT_DOUBLE_EQ(urdf_joint->safety->soft_upper_limit, soft_limits.max_position);
+    EXPECT_DOUBLE_EQ(urdf_joint->safety->k_position, soft_limits.k_position);
+    EXPECT_DOUBLE_EQ(urdf_joint->safety->k_velocity, soft_limits.k_velocity);
+  }
+
+  // CONTINUOUS type
+  {
+    joint_limits_interface::JointLimits limits;
+    EXPECT_TRUE(getJointLimits(urdf.find_joint_element("continuous_joint"), limits));
+    EXPECT_FALSE(limits.has_position_limits);
+    EXPECT_TRUE(limits.angle_wraparound);
+    EXPECT_TRUE(limits.has_velocity_limits);
+    EXPECT_DOUBLE_EQ(2.0, limits.max_velocity);
+
+    joint_limits_interface::SoftJointLimits soft_limits;
+    EXPECT_FALSE(getSoftJointLimits(urdf.find_joint_element("continuous_joint"), soft_limits));
+  }
+
+  // Missing or incomplete specifications
+  {
+    joint_limits_interface::JointLimits limits;
+    joint_limits_interface::SoftJointLimits soft_limits;
+    EXPECT_FALSE(getJointLimits(urdf.find_joint_element("unknown_joint"), limits));
+    EXPECT_FALSE(getJointLimits(urdf.find_joint_element("fixed_joint"), limits));
+    EXPECT_FALSE(getJointLimits(urdf.find_joint_element("incomplete_joint"), limits));
+    EXPECT_FALSE(getSoftJointLimits(urdf.find_joint_element("incomplete_joint"), soft_limits));
+    EXPECT_FALSE(limits.has_position_limits);
+    EXPECT_FALSE(limits.has_velocity_limits);
+  }
+}
+
 int main(int argc, char ** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,164 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "controller_interface/batch_pid.hpp"
+#include "hardware_interface/interface_value_group.hpp"
+#include "hardware_interface/joint_handle.hpp"
+#include "hardware_interface/robot_hardware.hpp"
+#include "hardware_interface/types/hardware_interface_type_values.hpp"
+
+namespace hw = hardware_interface;
+
+namespace
+{
+constexpr double kPeriod = 0.001;
+
+class BenchmarkRobotHardware : public hw::RobotHardware
+{
+  hw::return_type init() override
+  {
+    return hw::return_type::OK;
+  }
+
+  hw::return_type read() override
+  {
+    return hw::return_type::OK;
+  }
+
+  hw::return_type write() override
+  {
+    return hw::return_type::OK;
+  }
+};
+
+controller_interface::PidGains make_gains()
+{
+  controller_interface::PidGains gains;
+  gains.p = 100.0;
+  gains.i = 10.0;
+  gains.d = 1.0;
+  gains.i_min = -5.0;
+  gains.i_max = 5.0;
+  gains.derivative_time_constant = 0.005;
+  gains.output_min = -50.0;
+  gains.output_max = 50.0;
+  return gains;
+}
+
+/// The PID loop of one joint, as a controller running one loop per joint handle would have it.
+struct ScalarPid
+{
+  controller_interface::PidGains gains;
+  double integral = 0.0;
+  double previous_error = 0.0;
+  double derivative = 0.0;
+  bool has_previous_error = false;
+
+  double update(double error, double dt)
+  {
+    if (has_previous_error) {
+      const double alpha = dt / (gains.derivative_time_constant + dt);
+      derivative += alpha * ((error - previous_error) / dt - derivative);
+    }
+    const double next_integral =
+      std::min(std::max(integral + gains.i * error * dt, gains.i_min), gains.i_max);
+    const double output = gains.p * error + next_integral + gains.d * derivative;
+    if (!((output > gains.output_max && gains.i * error > 0.0) ||
+      (output < gains.output_min && gains.i * error < 0.0)))
+    {
+      integral = next_integral;
+    }
+    previous_error = error;
+    has_previous_error = true;
+    return std::min(std::max(output, gains.output_min), gains.output_max);
+  }
+};
+
+std::vector<std::string> make_joint_names(const benchmark::State & state)
+{
+  std::vector<std::string> joint_names;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    joint_names.push_back("joint" + std::to_string(i));
+  }
+  return joint_names;
+}
+
+/// A position state and an effort command interface per joint, the positions spread around 0.
+void set_up_robot(hw::RobotHardware & robot, const std::vector<std::string> & joint_names)
+{
+  for (size_t i = 0; i < joint_names.size(); ++i) {
+    robot.register_joint(joint_names[i], hw::HW_IF_POSITION, 0.01 * static_cast<double>(i));
+    robot.register_joint(joint_names[i], hw::HW_IF_EFFORT_COMMAND);
+  }
+  robot.freeze_registration();
+}
+}  // namespace
+
+static void BM_PidPerJointHandle(benchmark::State & state)
+{
+  const auto joint_names = make_joint_names(state);
+  BenchmarkRobotHardware robot;
+  set_up_robot(robot, joint_names);
+  std::vector<hw::JointHandle> positions;
+  std::vector<hw::JointHandle> efforts;
+  std::vector<ScalarPid> pids(joint_names.size());
+  for (size_t i = 0; i < joint_names.size(); ++i) {
+    positions.emplace_back(joint_names[i], hw::HW_IF_POSITION);
+    efforts.emplace_back(joint_names[i], hw::HW_IF_EFFORT_COMMAND);
+    robot.get_joint_handle(positions.back());
+    robot.get_joint_handle(efforts.back());
+    pids[i].gains = make_gains();
+  }
+  const std::vector<double> setpoints(joint_names.size(), 0.1);
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < pids.size(); ++i) {
+      efforts[i].set_value(pids[i].update(setpoints[i] - positions[i].get_value(), kPeriod));
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PidPerJointHandle)->Arg(6)->Arg(7)->Arg(16)->Arg(32)->Arg(64);
+
+static void BM_BatchPidOverValueGroups(benchmark::State & state)
+{
+  const auto joint_names = make_joint_names(state);
+  BenchmarkRobotHardware robot;
+  set_up_robot(robot, joint_names);
+  hw::InterfaceValueGroup position_group;
+  hw::InterfaceValueGroup effort_group;
+  robot.get_joint_value_group(joint_names, hw::HW_IF_POSITION_ID, position_group);
+  robot.get_joint_value_group(joint_names, hw::HW_IF_EFFORT_COMMAND_ID, effort_group);
+  controller_interface::BatchPid pid(joint_names.size(), make_gains());
+  const std::vector<double> setpoints(joint_names.size(), 0.1);
+  std::vector<double> positions(joint_names.size());
+  std::vector<double> efforts(joint_names.size());
+  const std::vector<double> no_feed_forwards;
+
+  for (auto _ : state) {
+    robot.get_joint_values(position_group, positions);
+    pid.update(setpoints, positions, no_feed_forwards, kPeriod, efforts);
+    robot.set_joint_values(effort_group, efforts);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BatchPidOverValueGroups)->Arg(6)->Arg(7)->Arg(16)->Arg(32)->Arg(64);
@@ -0,0 +1,87 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <sstream>
+#include <string>
+
+#include "hardware_interface/component_parser.hpp"
+#include "hardware_interface/urdf_document.hpp"
+
+namespace
+{
+/// A robot with range(0) joints, each with a link and a multi-interface ros2_control joint,
+/// split over systems of 10 joints.
+std::string make_urdf(const benchmark::State & state)
+{
+  constexpr int64_t kJointsPerSystem = 10;
+  const auto joint_count = state.range(0);
+
+  std::ostringstream urdf;
+  urdf << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<robot name=\"GeneratedRobot\">\n";
+  urdf << "  <link name=\"link0\"/>\n";
+  for (int64_t i = 0; i < joint_count; ++i) {
+    urdf << "  <link name=\"link" << i + 1 << "\"/>\n";
+    urdf << "  <joint name=\"joint" << i << "\" type=\"revolute\">\n";
+    urdf << "    <parent link=\"link" << i << "\"/>\n";
+    urdf << "    <child link=\"link" << i + 1 << "\"/>\n";
+    urdf << "    <limit lower=\"-1\" upper=\"1\" effort=\"10\" velocity=\"2\"/>\n";
+    urdf << "  </joint>\n";
+  }
+  for (int64_t i = 0; i < joint_count; ++i) {
+    if (i % kJointsPerSystem == 0) {
+      urdf << "  <ros2_control name=\"System" << i / kJointsPerSystem << "\" type=\"system\">\n";
+      urdf << "    <hardware>\n";
+      urdf << "      <classType>ros2_control_demo_hardware/GeneratedSystem</classType>\n";
+      urdf << "      <param name=\"example_param_write_for_sec\">2</param>\n";
+      urdf << "    </hardware>\n";
+    }
+    urdf << "    <joint name=\"joint" << i << "\">\n";
+    urdf << "      <classType>ros2_control_components/MultiInterfaceJoint</classType>\n";
+    urdf << "      <commandInterfaceType>position</commandInterfaceType>\n";
+    urdf << "      <commandInterfaceType>velocity</commandInterfaceType>\n";
+    urdf << "      <stateInterfaceType>position</stateInterfaceType>\n";
+    urdf << "      <stateInterfaceType>velocity</stateInterfaceType>\n";
+    urdf << "      <param name=\"min_position_value\">-1</param>\n";
+    urdf << "      <param name=\"max_position_value\">1</param>\n";
+    urdf << "    </joint>\n";
+    if (i % kJointsPerSystem == kJointsPerSystem - 1 || i == joint_count - 1) {
+      urdf << "  </ros2_control>\n";
+    }
+  }
+  urdf << "</robot>\n";
+  return urdf.str();
+}
+}  // namespace
+
+static void BM_ParseControlResourcesFromUrdf(benchmark::State & state)
+{
+  const auto urdf = make_urdf(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(hardware_interface::parse_control_resources_from_urdf(urdf));
+  }
+  state.SetBytesProcessed(state.iterations() * urdf.size());
+}
+BENCHMARK(BM_ParseControlResourcesFromUrdf)->Arg(10)->Arg(100)->Arg(1000);
+
+/// Only the extraction of the resources, from a description already parsed to XML.
+static void BM_ParseControlResourcesFromDocument(benchmark::State & state)
+{
+  const hardware_interface::URDFDocument document(make_urdf(state));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(hardware_interface::parse_control_resources_from_urdf(document));
+  }
+}
+BENCHMARK(BM_ParseControlResourcesFromDocument)->Arg(10)->Arg(100)->Arg(1000);
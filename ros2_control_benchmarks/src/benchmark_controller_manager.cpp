@@ -0,0 +1,155 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "controller_interface/controller_interface.hpp"
+#include "controller_manager/controller_manager.hpp"
+#include "controller_manager_msgs/srv/switch_controller.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "test_robot_hardware/test_robot_hardware.hpp"
+
+namespace
+{
+constexpr auto STRICT = controller_manager_msgs::srv::SwitchController::Request::STRICT;
+constexpr char NO_OP_CONTROLLER_TYPE[] = "no_op_controller";
+
+/// A controller doing nothing, so that only the cost of the controller manager is measured.
+class NoOpController : public controller_interface::ControllerInterface
+{
+public:
+  controller_interface::return_type update() override
+  {
+    return controller_interface::return_type::SUCCESS;
+  }
+
+  rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn
+  on_configure(const rclcpp_lifecycle::State & /*previous_state*/) override
+  {
+    return rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn::SUCCESS;
+  }
+};
+
+/// A controller manager with its hardware and controllers, the controllers are not started.
+class ControllerManagerFixture
+{
+public:
+  explicit ControllerManagerFixture(size_t controller_count)
+  {
+    if (!rclcpp::ok()) {
+      rclcpp::init(0, nullptr);
+    }
+    robot_ = std::make_shared<test_robot_hardware::TestRobotHardware>();
+    robot_->init();
+    executor_ = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+    cm_ = std::make_shared<controller_manager::ControllerManager>(
+      robot_, executor_, "benchmark_controller_manager");
+    for (size_t i = 0; i < controller_count; ++i) {
+      controller_names_.push_back("no_op_controller_" + std::to_string(i));
+      cm_->add_controller(
+        std::make_shared<NoOpController>(), controller_names_.back(), NO_OP_CONTROLLER_TYPE);
+    }
+  }
+
+  /// Switch the controllers while updating the controller manager, as the real-time loop would.
+  controller_interface::return_type switch_controllers(
+    const std::vector<std::string> & start_controllers,
+    const std::vector<std::string> & stop_controllers)
+  {
+    if (start_controllers.empty() && stop_controllers.empty()) {
+      return controller_interface::return_type::SUCCESS;
+    }
+    auto switch_future = std::async(
+      std::launch::async,
+      &controller_manager::ControllerManager::switch_controller, cm_,
+      start_controllers, stop_controllers, STRICT, true, rclcpp::Duration(0, 0));
+    while (switch_future.wait_for(std::chrono::microseconds(100)) != std::future_status::ready) {
+      cm_->update();
+    }
+    // the first update after the switch rebuilds the schedule of the active controllers
+    cm_->update();
+    return switch_future.get();
+  }
+
+  std::shared_ptr<controller_manager::ControllerManager> cm_;
+  std::vector<std::string> controller_names_;
+
+private:
+  std::shared_ptr<test_robot_hardware::TestRobotHardware> robot_;
+  std::shared_ptr<rclcpp::Executor> executor_;
+};
+}  // namespace
+
+static void BM_ControllerManagerUpdate(benchmark::State & state)
+{
+  ControllerManagerFixture fixture(state.range(0));
+  if (fixture.switch_controllers(fixture.controller_names_, {}) !=
+    controller_interface::return_type::SUCCESS)
+  {
+    state.SkipWithError("could not start the controllers");
+    return;
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(fixture.cm_->update());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ControllerManagerUpdate)->Arg(0)->Arg(1)->Arg(10)->Arg(100);
+
+/// Time from the request of a switch until the real-time thread runs with the new controllers
+/// list, measured in the thread requesting the switch while another thread keeps updating.
+static void BM_ControllerSwitchLatency(benchmark::State & state)
+{
+  ControllerManagerFixture fixture(state.range(0));
+  // keep one controller aside to switch it on and off, the others keep running
+  const std::vector<std::string> switched_controller = {fixture.controller_names_.back()};
+  fixture.controller_names_.pop_back();
+  fixture.switch_controllers(fixture.controller_names_, {});
+
+  std::atomic<bool> done{false};
+  std::thread update_thread([&fixture, &done]() {
+      while (!done) {
+        fixture.cm_->update();
+      }
+    });
+
+  const std::vector<std::string> no_controllers;
+  const rclcpp::Duration no_timeout(0, 0);
+  bool started = false;
+  for (auto _ : state) {
+    const auto & start_controllers = started ? no_controllers : switched_controller;
+    const auto & stop_controllers = started ? switched_controller : no_controllers;
+    const auto result = fixture.cm_->switch_controller(
+      start_controllers, stop_controllers, STRICT, true, no_timeout);
+    if (result != controller_interface::return_type::SUCCESS) {
+      state.SkipWithError("could not switch the controller");
+      break;
+    }
+    started = !started;
+  }
+
+  done = true;
+  update_thread.join();
+}
+BENCHMARK(BM_ControllerSwitchLatency)->Arg(1)->Arg(10)->Arg(100)->UseRealTime();
@@ -0,0 +1,89 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "hardware_interface/components/interface_selector.hpp"
+#include "hardware_interface/components/joint.hpp"
+#include "hardware_interface/span.hpp"
+#include "hardware_interface/types/hardware_interface_type_values.hpp"
+
+namespace hw = hardware_interface;
+
+namespace
+{
+hw::components::Joint make_joint()
+{
+  hw::components::ComponentInfo joint_info;
+  joint_info.name = "joint1";
+  joint_info.command_interfaces = {hw::HW_IF_POSITION, hw::HW_IF_VELOCITY, hw::HW_IF_EFFORT};
+  joint_info.state_interfaces = {hw::HW_IF_POSITION, hw::HW_IF_VELOCITY, hw::HW_IF_EFFORT};
+  hw::components::Joint joint;
+  joint.configure(joint_info);
+  return joint;
+}
+}  // namespace
+
+static void BM_JointSetCommandByName(benchmark::State & state)
+{
+  auto joint = make_joint();
+  const std::vector<std::string> interfaces = {hw::HW_IF_POSITION, hw::HW_IF_VELOCITY};
+  std::vector<double> command = {1.0, 2.0};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(joint.set_command(command, interfaces));
+  }
+}
+BENCHMARK(BM_JointSetCommandByName);
+
+static void BM_JointGetCommandByName(benchmark::State & state)
+{
+  auto joint = make_joint();
+  const std::vector<std::string> interfaces = {hw::HW_IF_POSITION, hw::HW_IF_VELOCITY};
+  std::vector<double> command(interfaces.size());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(joint.get_command(command, interfaces));
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_JointGetCommandByName);
+
+static void BM_JointSetCommandBySelector(benchmark::State & state)
+{
+  auto joint = make_joint();
+  const std::vector<std::string> interfaces = {hw::HW_IF_POSITION, hw::HW_IF_VELOCITY};
+  hw::components::InterfaceSelector selector;
+  joint.get_command_interface_selector(selector, interfaces);
+  const std::vector<double> command = {1.0, 2.0};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(joint.set_command(hw::Span<const double>(command), selector));
+  }
+}
+BENCHMARK(BM_JointSetCommandBySelector);
+
+static void BM_JointGetCommandBySelector(benchmark::State & state)
+{
+  auto joint = make_joint();
+  const std::vector<std::string> interfaces = {hw::HW_IF_POSITION, hw::HW_IF_VELOCITY};
+  hw::components::InterfaceSelector selector;
+  joint.get_command_interface_selector(selector, interfaces);
+  std::vector<double> command(2);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(joint.get_command(hw::Span<double>(command), selector));
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_JointGetCommandBySelector);
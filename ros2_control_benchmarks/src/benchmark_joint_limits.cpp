@@ -0,0 +1,172 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "joint_limits_interface/joint_limits.hpp"
+#include "joint_limits_interface/joint_limits_enforcer.hpp"
+#include "joint_limits_interface/joint_limits_interface.hpp"
+#include "rclcpp/duration.hpp"
+
+using hardware_interface::JointHandle;
+using joint_limits_interface::JointLimits;
+using joint_limits_interface::SoftJointLimits;
+
+namespace
+{
+struct JointValues
+{
+  double position = 0.0;
+  double velocity = 0.0;
+  double command = 0.0;
+};
+
+JointLimits make_limits()
+{
+  JointLimits limits;
+  limits.has_position_limits = true;
+  limits.min_position = -1.0;
+  limits.max_position = 1.0;
+  limits.has_velocity_limits = true;
+  limits.max_velocity = 2.0;
+  limits.has_acceleration_limits = true;
+  limits.max_acceleration = 10.0;
+  limits.has_effort_limits = true;
+  limits.max_effort = 8.0;
+  return limits;
+}
+
+SoftJointLimits make_soft_limits()
+{
+  SoftJointLimits soft_limits;
+  soft_limits.min_position = -0.8;
+  soft_limits.max_position = 0.8;
+  soft_limits.k_position = 20.0;
+  soft_limits.k_velocity = 40.0;
+  return soft_limits;
+}
+
+/// Alternate the commands around the limits, so that every other joint gets clamped.
+void set_commands(std::vector<JointValues> & values)
+{
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i].command = i % 2 ? 3.0 : 0.5;
+  }
+}
+
+std::string joint_name(size_t index)
+{
+  return "joint" + std::to_string(index);
+}
+}  // namespace
+
+static void BM_PositionSaturationHandles(benchmark::State & state)
+{
+  const auto limits = make_limits();
+  const rclcpp::Duration period(0, 1000000);
+  std::vector<JointValues> values(state.range(0));
+  std::vector<joint_limits_interface::PositionJointSaturationHandle> handles;
+  for (size_t i = 0; i < values.size(); ++i) {
+    handles.emplace_back(
+      std::make_shared<JointHandle>(joint_name(i), "position", &values[i].position),
+      std::make_shared<JointHandle>(joint_name(i), "position_command", &values[i].command),
+      limits);
+  }
+
+  for (auto _ : state) {
+    set_commands(values);
+    for (auto & handle : handles) {
+      handle.enforceLimits(period);
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PositionSaturationHandles)->Arg(10)->Arg(100)->Arg(1000);
+
+static void BM_PositionSaturationEnforcer(benchmark::State & state)
+{
+  const auto limits = make_limits();
+  const rclcpp::Duration period(0, 1000000);
+  std::vector<JointValues> values(state.range(0));
+  joint_limits_interface::JointLimitsEnforcer enforcer;
+  for (size_t i = 0; i < values.size(); ++i) {
+    enforcer.add_position_saturation(
+      JointHandle(joint_name(i), "position", &values[i].position),
+      JointHandle(joint_name(i), "position_command", &values[i].command),
+      limits);
+  }
+
+  for (auto _ : state) {
+    set_commands(values);
+    enforcer.enforceLimits(period);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PositionSaturationEnforcer)->Arg(10)->Arg(100)->Arg(1000);
+
+static void BM_VelocitySoftLimitsHandles(benchmark::State & state)
+{
+  const auto limits = make_limits();
+  const auto soft_limits = make_soft_limits();
+  const rclcpp::Duration period(0, 1000000);
+  std::vector<JointValues> values(state.range(0));
+  std::vector<joint_limits_interface::VelocityJointSoftLimitsHandle> handles;
+  for (size_t i = 0; i < values.size(); ++i) {
+    handles.emplace_back(
+      std::make_shared<JointHandle>(joint_name(i), "position", &values[i].position),
+      std::make_shared<JointHandle>(joint_name(i), "velocity", &values[i].velocity),
+      std::make_shared<JointHandle>(joint_name(i), "velocity_command", &values[i].command),
+      limits, soft_limits);
+  }
+
+  for (auto _ : state) {
+    set_commands(values);
+    for (auto & handle : handles) {
+      handle.enforceLimits(period);
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_VelocitySoftLimitsHandles)->Arg(10)->Arg(100)->Arg(1000);
+
+static void BM_VelocitySoftLimitsEnforcer(benchmark::State & state)
+{
+  const auto limits = make_limits();
+  const auto soft_limits = make_soft_limits();
+  const rclcpp::Duration period(0, 1000000);
+  std::vector<JointValues> values(state.range(0));
+  joint_limits_interface::JointLimitsEnforcer enforcer;
+  for (size_t i = 0; i < values.size(); ++i) {
+    enforcer.add_velocity_soft_limits(
+      JointHandle(joint_name(i), "position", &values[i].position),
+      JointHandle(joint_name(i), "velocity", &values[i].velocity),
+      JointHandle(joint_name(i), "velocity_command", &values[i].command),
+      limits, soft_limits);
+  }
+
+  for (auto _ : state) {
+    set_commands(values);
+    enforcer.enforceLimits(period);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_VelocitySoftLimitsEnforcer)->Arg(10)->Arg(100)->Arg(1000);
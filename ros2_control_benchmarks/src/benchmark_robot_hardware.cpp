@@ -0,0 +1,112 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "hardware_interface/joint_handle.hpp"
+#include "hardware_interface/robot_hardware.hpp"
+#include "hardware_interface/types/hardware_interface_type_values.hpp"
+
+namespace hw = hardware_interface;
+
+namespace
+{
+class BenchmarkRobotHardware : public hw::RobotHardware
+{
+  hw::return_type init() override
+  {
+    return hw::return_type::OK;
+  }
+
+  hw::return_type read() override
+  {
+    return hw::return_type::OK;
+  }
+
+  hw::return_type write() override
+  {
+    return hw::return_type::OK;
+  }
+};
+
+/// A state and a command interface per joint, range(0) interfaces in total.
+std::vector<std::string> make_joint_names(const benchmark::State & state)
+{
+  std::vector<std::string> joint_names;
+  for (int64_t i = 0; i < state.range(0) / 2; ++i) {
+    joint_names.push_back("joint" + std::to_string(i));
+  }
+  return joint_names;
+}
+
+void register_joints(hw::RobotHardware & robot, const std::vector<std::string> & joint_names)
+{
+  for (const auto & joint_name : joint_names) {
+    robot.register_joint(joint_name, hw::HW_IF_POSITION);
+    robot.register_joint(joint_name, hw::HW_IF_POSITION_COMMAND);
+  }
+}
+}  // namespace
+
+static void BM_RobotHardwareRegistration(benchmark::State & state)
+{
+  const auto joint_names = make_joint_names(state);
+  for (auto _ : state) {
+    BenchmarkRobotHardware robot;
+    register_joints(robot, joint_names);
+    benchmark::DoNotOptimize(robot.freeze_registration());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RobotHardwareRegistration)->Arg(10)->Arg(100)->Arg(1000);
+
+static void BM_RobotHardwareLookupByName(benchmark::State & state)
+{
+  const auto joint_names = make_joint_names(state);
+  BenchmarkRobotHardware robot;
+  register_joints(robot, joint_names);
+  robot.freeze_registration();
+
+  size_t index = 0;
+  for (auto _ : state) {
+    hw::JointHandle handle(joint_names[index], hw::HW_IF_POSITION_COMMAND);
+    benchmark::DoNotOptimize(robot.get_joint_handle(handle));
+    index = (index + 1) % joint_names.size();
+  }
+}
+BENCHMARK(BM_RobotHardwareLookupByName)->Arg(10)->Arg(100)->Arg(1000);
+
+static void BM_RobotHardwareLookupById(benchmark::State & state)
+{
+  const auto joint_names = make_joint_names(state);
+  BenchmarkRobotHardware robot;
+  register_joints(robot, joint_names);
+  robot.freeze_registration();
+
+  std::vector<hw::InterfaceId> interface_ids(joint_names.size());
+  for (size_t i = 0; i < joint_names.size(); ++i) {
+    robot.get_joint_interface_id(joint_names[i], hw::HW_IF_POSITION_COMMAND, interface_ids[i]);
+  }
+
+  size_t index = 0;
+  hw::JointHandle handle("", "");
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(robot.get_joint_handle(interface_ids[index], handle));
+    index = (index + 1) % interface_ids.size();
+  }
+}
+BENCHMARK(BM_RobotHardwareLookupById)->Arg(10)->Arg(100)->Arg(1000);
@@ -0,0 +1,380 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// End-to-end latency harness: runs the real-time control loop over SyntheticRobotHardware with
+// synthetic controllers for a while, optionally loading and unloading controllers meanwhile, and
+// prints histograms of the cycle durations, of the wake up jitter and of the switch latencies as
+// JSON, to compare kernels, real-time configurations and versions of the libraries.
+//
+// Usage: ros2_control_latency_harness [--option=value]..., see print_usage() for the options.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "controller_interface/controller_interface.hpp"
+#include "controller_manager/controller_manager.hpp"
+#include "controller_manager/cycle_timing.hpp"
+#include "controller_manager/realtime_control_loop.hpp"
+#include "controller_manager_msgs/srv/switch_controller.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "test_robot_hardware/synthetic_robot_hardware.hpp"
+
+namespace
+{
+constexpr auto STRICT = controller_manager_msgs::srv::SwitchController::Request::STRICT;
+constexpr char SYNTHETIC_CONTROLLER_TYPE[] = "synthetic_controller";
+
+struct HarnessOptions
+{
+  std::chrono::seconds duration{60};
+  std::chrono::microseconds period{1000};
+  int priority = 0;
+  int cpu = -1;
+  bool lock_memory = false;
+  size_t controllers = 10;
+  std::chrono::microseconds controller_cost{10};
+  std::chrono::microseconds read_latency{50};
+  std::chrono::microseconds write_latency{50};
+  std::chrono::microseconds bus_jitter{20};
+  /// Period of the load, start, stop and unload of a controller, 0 to not switch under load
+  std::chrono::milliseconds churn_period{0};
+  /// File the results are written to, standard output if empty
+  std::string output;
+};
+
+void print_usage()
+{
+  std::cerr <<
+    "Usage: ros2_control_latency_harness [--option=value]...\n"
+    "  --duration_s          duration of the run (60)\n"
+    "  --period_us           period of the control loop (1000)\n"
+    "  --priority            SCHED_FIFO priority of the loop, 0 for the default scheduling (0)\n"
+    "  --cpu                 CPU the loop is pinned to, -1 to not pin it (-1)\n"
+    "  --lock_memory         lock the memory of the process, 0 or 1 (0)\n"
+    "  --controllers         number of running synthetic controllers (10)\n"
+    "  --controller_cost_us  compute time of each controller update (10)\n"
+    "  --read_latency_us     latency of the hardware read (50)\n"
+    "  --write_latency_us    latency of the hardware write (50)\n"
+    "  --bus_jitter_us       extra random latency of each read and write (20)\n"
+    "  --churn_period_ms     period of the load and unload of a controller, 0 to disable (0)\n"
+    "  --output              file the JSON results are written to, standard output if empty\n";
+}
+
+bool parse_options(int argc, char ** argv, HarnessOptions & options)
+{
+  for (int i = 1; i < argc; ++i) {
+    const std::string argument = argv[i];
+    const auto separator = argument.find('=');
+    if (argument.compare(0, 2, "--") != 0 || separator == std::string::npos) {
+      std::cerr << "Invalid argument '" << argument << "'\n";
+      return false;
+    }
+    const auto name = argument.substr(2, separator - 2);
+    const auto value = argument.substr(separator + 1);
+    const auto number = std::strtoll(value.c_str(), nullptr, 10);
+    if (name == "duration_s") {
+      options.duration = std::chrono::seconds(number);
+    } else if (name == "period_us") {
+      options.period = std::chrono::microseconds(number);
+    } else if (name == "priority") {
+      options.priority = static_cast<int>(number);
+    } else if (name == "cpu") {
+      options.cpu = static_cast<int>(number);
+    } else if (name == "lock_memory") {
+      options.lock_memory = number != 0;
+    } else if (name == "controllers") {
+      options.controllers = static_cast<size_t>(number);
+    } else if (name == "controller_cost_us") {
+      options.controller_cost = std::chrono::microseconds(number);
+    } else if (name == "read_latency_us") {
+      options.read_latency = std::chrono::microseconds(number);
+    } else if (name == "write_latency_us") {
+      options.write_latency = std::chrono::microseconds(number);
+    } else if (name == "bus_jitter_us") {
+      options.bus_jitter = std::chrono::microseconds(number);
+    } else if (name == "churn_period_ms") {
+      options.churn_period = std::chrono::milliseconds(number);
+    } else if (name == "output") {
+      options.output = value;
+    } else {
+      std::cerr << "Unknown option '" << name << "'\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Histogram of durations with fixed bins, recording is real-time safe.
+class LatencyHistogram
+{
+public:
+  LatencyHistogram(std::chrono::nanoseconds bin_width, size_t bin_count)
+  : bin_width_(bin_width), bins_(bin_count + 1, 0)
+  {}
+
+  void record(std::chrono::nanoseconds duration)
+  {
+    const auto bin = static_cast<size_t>(std::max<int64_t>(0, duration / bin_width_));
+    // the last bin counts everything beyond the range of the histogram
+    ++bins_[std::min(bin, bins_.size() - 1)];
+    ++count_;
+    max_ = std::max(max_, duration);
+  }
+
+  /// Upper bound of the bin holding the given fraction of the samples.
+  std::chrono::nanoseconds percentile(double fraction) const
+  {
+    const auto target = static_cast<uint64_t>(fraction * count_);
+    uint64_t cumulated = 0;
+    for (size_t bin = 0; bin < bins_.size() - 1; ++bin) {
+      cumulated += bins_[bin];
+      if (cumulated > target) {
+        return bin_width_ * (bin + 1);
+      }
+    }
+    return max_;
+  }
+
+  void to_json(std::ostream & out) const
+  {
+    out << "{\"count\": " << count_ <<
+      ", \"bin_width_ns\": " << bin_width_.count() <<
+      ", \"p50_ns\": " << percentile(0.5).count() <<
+      ", \"p99_ns\": " << percentile(0.99).count() <<
+      ", \"p999_ns\": " << percentile(0.999).count() <<
+      ", \"max_ns\": " << max_.count() <<
+      ", \"bins\": {";
+    // only the non empty bins, keyed by their lower bound
+    bool first = true;
+    for (size_t bin = 0; bin < bins_.size(); ++bin) {
+      if (bins_[bin] == 0) {
+        continue;
+      }
+      out << (first ? "" : ", ") << "\"" << (bin_width_ * bin).count() << "\": " << bins_[bin];
+      first = false;
+    }
+    out << "}}";
+  }
+
+private:
+  std::chrono::nanoseconds bin_width_;
+  std::vector<uint64_t> bins_;
+  uint64_t count_ = 0;
+  std::chrono::nanoseconds max_{0};
+};
+
+/// A controller computing for a fixed time in each update.
+class SyntheticController : public controller_interface::ControllerInterface
+{
+public:
+  explicit SyntheticController(std::chrono::nanoseconds cost)
+  : cost_(cost)
+  {}
+
+  controller_interface::return_type update() override
+  {
+    const auto end = std::chrono::steady_clock::now() + cost_;
+    while (std::chrono::steady_clock::now() < end) {
+    }
+    return controller_interface::return_type::SUCCESS;
+  }
+
+  rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn
+  on_configure(const rclcpp_lifecycle::State & /*previous_state*/) override
+  {
+    return rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn::SUCCESS;
+  }
+
+private:
+  std::chrono::nanoseconds cost_;
+};
+
+void statistics_to_json(std::ostream & out, const controller_manager::TimingStatistics & statistics)
+{
+  out << "{\"count\": " << statistics.count <<
+    ", \"mean_ns\": " << statistics.mean.count() <<
+    ", \"p99_ns\": " << statistics.p99.count() <<
+    ", \"max_ns\": " << statistics.max.count() << "}";
+}
+
+/// Load, start, stop and unload a controller periodically, timing the switches.
+void churn_controllers(
+  controller_manager::ControllerManager & cm, const HarnessOptions & options,
+  const std::atomic<bool> & done, LatencyHistogram & switch_latency, uint64_t & switch_errors)
+{
+  const rclcpp::Duration no_timeout(0, 0);
+  for (size_t index = 0; !done; ++index) {
+    const std::vector<std::string> controller = {"churn_controller_" + std::to_string(index)};
+    cm.add_controller(
+      std::make_shared<SyntheticController>(options.controller_cost), controller[0],
+      SYNTHETIC_CONTROLLER_TYPE);
+
+    auto start = std::chrono::steady_clock::now();
+    if (cm.switch_controller(controller, {}, STRICT, true, no_timeout) !=
+      controller_interface::return_type::SUCCESS)
+    {
+      ++switch_errors;
+    }
+    switch_latency.record(std::chrono::steady_clock::now() - start);
+
+    std::this_thread::sleep_for(options.churn_period / 2);
+
+    start = std::chrono::steady_clock::now();
+    if (cm.switch_controller({}, controller, STRICT, true, no_timeout) !=
+      controller_interface::return_type::SUCCESS)
+    {
+      ++switch_errors;
+    }
+    switch_latency.record(std::chrono::steady_clock::now() - start);
+    cm.unload_controller(controller[0]);
+
+    std::this_thread::sleep_for(options.churn_period / 2);
+  }
+}
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+  HarnessOptions options;
+  if (!parse_options(argc, argv, options)) {
+    print_usage();
+    return 1;
+  }
+  rclcpp::init(0, nullptr);
+
+  test_robot_hardware::SyntheticBusOptions bus_options;
+  bus_options.read_latency = options.read_latency;
+  bus_options.write_latency = options.write_latency;
+  bus_options.jitter = options.bus_jitter;
+  auto robot = std::make_shared<test_robot_hardware::SyntheticRobotHardware>(bus_options);
+  if (robot->init() != hardware_interface::return_type::OK) {
+    std::cerr << "Could not initialize the synthetic hardware\n";
+    return 1;
+  }
+  auto executor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot, executor, "latency_harness_controller_manager");
+
+  std::vector<std::string> controller_names;
+  for (size_t i = 0; i < options.controllers; ++i) {
+    controller_names.push_back("synthetic_controller_" + std::to_string(i));
+    cm->add_controller(
+      std::make_shared<SyntheticController>(options.controller_cost), controller_names.back(),
+      SYNTHETIC_CONTROLLER_TYPE);
+  }
+
+  // histograms of 1 us bins up to 10 periods, allocated before the loop starts
+  const auto bin_count = static_cast<size_t>(10 * options.period.count());
+  LatencyHistogram cycle_duration(std::chrono::microseconds(1), bin_count);
+  LatencyHistogram jitter(std::chrono::microseconds(1), bin_count);
+  LatencyHistogram switch_latency(std::chrono::microseconds(1), bin_count);
+  uint64_t switch_errors = 0;
+
+  controller_manager::RealtimeControlLoopOptions loop_options;
+  loop_options.period = options.period;
+  loop_options.priority = options.priority;
+  loop_options.cpu = options.cpu;
+  loop_options.lock_memory = options.lock_memory;
+  loop_options.stack_prefault_size = options.lock_memory ? 512 * 1024 : 0;
+  loop_options.on_cycle_end = [&cycle_duration, &jitter](
+    std::chrono::nanoseconds cycle_jitter, std::chrono::nanoseconds duration) {
+      jitter.record(cycle_jitter);
+      cycle_duration.record(duration);
+    };
+  controller_manager::RealtimeControlLoop control_loop(robot, cm, loop_options);
+  if (!control_loop.start()) {
+    return 1;
+  }
+  if (!controller_names.empty() &&
+    cm->switch_controller(controller_names, {}, STRICT, true, rclcpp::Duration(0, 0)) !=
+    controller_interface::return_type::SUCCESS)
+  {
+    std::cerr << "Could not start the synthetic controllers\n";
+    return 1;
+  }
+
+  std::atomic<bool> done{false};
+  std::thread churn_thread;
+  if (options.churn_period.count() > 0) {
+    churn_thread = std::thread(
+      churn_controllers, std::ref(*cm), std::cref(options), std::cref(done),
+      std::ref(switch_latency), std::ref(switch_errors));
+  }
+  std::this_thread::sleep_for(options.duration);
+  done = true;
+  if (churn_thread.joinable()) {
+    churn_thread.join();
+  }
+  control_loop.stop();
+
+  const auto statistics = control_loop.get_statistics();
+  auto & cycle_timing = cm->get_cycle_timing();
+  std::ostringstream results;
+  results << "{\n" <<
+    "  \"options\": {\"duration_s\": " << options.duration.count() <<
+    ", \"period_us\": " << options.period.count() <<
+    ", \"priority\": " << options.priority <<
+    ", \"cpu\": " << options.cpu <<
+    ", \"lock_memory\": " << (options.lock_memory ? "true" : "false") <<
+    ", \"controllers\": " << options.controllers <<
+    ", \"controller_cost_us\": " << options.controller_cost.count() <<
+    ", \"read_latency_us\": " << options.read_latency.count() <<
+    ", \"write_latency_us\": " << options.write_latency.count() <<
+    ", \"bus_jitter_us\": " << options.bus_jitter.count() <<
+    ", \"churn_period_ms\": " << options.churn_period.count() << "},\n" <<
+    "  \"cycles\": " << statistics.cycles << ",\n" <<
+    "  \"overruns\": " << statistics.overruns << ",\n" <<
+    "  \"errors\": " << statistics.errors << ",\n" <<
+    "  \"switch_errors\": " << switch_errors << ",\n";
+  results << "  \"cycle_duration\": ";
+  cycle_duration.to_json(results);
+  results << ",\n  \"jitter\": ";
+  jitter.to_json(results);
+  results << ",\n  \"switch_latency\": ";
+  switch_latency.to_json(results);
+  results << ",\n  \"phases\": {\"read\": ";
+  statistics_to_json(results, cycle_timing.read.get_statistics());
+  results << ", \"update\": ";
+  statistics_to_json(results, cycle_timing.update.get_statistics());
+  results << ", \"manage_switch\": ";
+  statistics_to_json(results, cycle_timing.manage_switch.get_statistics());
+  results << ", \"write\": ";
+  statistics_to_json(results, cycle_timing.write.get_statistics());
+  results << "}\n}\n";
+
+  if (options.output.empty()) {
+    std::cout << results.str();
+  } else {
+    std::ofstream output(options.output);
+    output << results.str();
+    if (!output) {
+      std::cerr << "Could not write the results to '" << options.output << "'\n";
+      return 1;
+    }
+  }
+
+  rclcpp::shutdown();
+  return 0;
+}
@@ -0,0 +1,158 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TEST_ROBOT_HARDWARE__REPLAY_SYSTEM_HARDWARE_HPP_
+#define TEST_ROBOT_HARDWARE__REPLAY_SYSTEM_HARDWARE_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "hardware_interface/components/joint.hpp"
+#include "hardware_interface/components/sensor.hpp"
+#include "hardware_interface/flight_record.hpp"
+#include "hardware_interface/hardware_info.hpp"
+#include "hardware_interface/system_hardware_interface.hpp"
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+#include "hardware_interface/types/hardware_interface_status_values.hpp"
+
+#include "test_robot_hardware/visibility_control.h"
+
+namespace test_robot_hardware
+{
+
+/// Error of the commands written to an interface against the recorded ones.
+struct ReplayCommandError
+{
+  /// Number of commands compared
+  uint64_t count = 0;
+  double mean_absolute = 0.0;
+  double root_mean_square = 0.0;
+  double max_absolute = 0.0;
+};
+
+/// Replays the joint states of a flight record, and compares the written commands to the recorded
+/// ones.
+/**
+ * Configured with the hardware parameters:
+ * - record_path: the flight record, dumped by the controller manager, required.
+ * - realtime_pacing: "true" to read each cycle at the time it was recorded at, relative to
+ *   start(); "false", the default, to replay the cycles as fast as they are read.
+ *
+ * The state interface "position" of the joint "joint1" is replayed from the recorded value
+ * "joint1/position", and its command interface "position" is compared to "joint1/position_command".
+ * read_joints() sets the states of the current cycle, write_joints() compares the commands to the
+ * ones recorded in that cycle and moves on to the next one. Once all the cycles are replayed,
+ * read_joints() returns ERROR.
+ */
+class ReplaySystemHardware : public hardware_interface::SystemHardwareInterface
+{
+public:
+  TEST_ROBOT_HARDWARE_PUBLIC
+  ReplaySystemHardware() = default;
+
+  /// Open the record and resolve the recorded values of the interfaces of the joints.
+  /**
+   * \param[in] system_info The joints of the system and its parameters.
+   * \return ERROR if the record cannot be opened or misses a state interface of a joint.
+   */
+  TEST_ROBOT_HARDWARE_PUBLIC
+  hardware_interface::return_type
+  configure(const hardware_interface::HardwareInfo & system_info) override;
+
+  TEST_ROBOT_HARDWARE_PUBLIC
+  hardware_interface::return_type
+  start() override;
+
+  TEST_ROBOT_HARDWARE_PUBLIC
+  hardware_interface::return_type
+  stop() override;
+
+  TEST_ROBOT_HARDWARE_PUBLIC
+  hardware_interface::status
+  get_status() const override;
+
+  /// The sensors are not recorded, their states are left as they are.
+  TEST_ROBOT_HARDWARE_PUBLIC
+  hardware_interface::return_type
+  read_sensors(std::vector<std::shared_ptr<hardware_interface::components::Sensor>> & sensors)
+  const override;
+
+  /// Set the states of the joints, in the order of the joints of the system info.
+  TEST_ROBOT_HARDWARE_PUBLIC
+  hardware_interface::return_type
+  read_joints(std::vector<std::shared_ptr<hardware_interface::components::Joint>> & joints)
+  const override;
+
+  /// Compare the commands of the joints to the recorded ones, then move on to the next cycle.
+  TEST_ROBOT_HARDWARE_PUBLIC
+  hardware_interface::return_type
+  write_joints(const std::vector<std::shared_ptr<hardware_interface::components::Joint>> & joints)
+  override;
+
+  /// Whether all the cycles of the record were replayed.
+  TEST_ROBOT_HARDWARE_PUBLIC
+  bool is_finished() const;
+
+  TEST_ROBOT_HARDWARE_PUBLIC
+  size_t get_cycle_count() const;
+
+  /// Number of cycles replayed, the index of the current cycle.
+  TEST_ROBOT_HARDWARE_PUBLIC
+  size_t get_replayed_cycle_count() const;
+
+  /// Time the current cycle was recorded at, to update the controllers with.
+  TEST_ROBOT_HARDWARE_PUBLIC
+  int64_t get_cycle_time_ns() const;
+
+  /// Errors of the commands compared so far, by "joint/interface".
+  TEST_ROBOT_HARDWARE_PUBLIC
+  std::map<std::string, ReplayCommandError> get_command_errors() const;
+
+  TEST_ROBOT_HARDWARE_PUBLIC
+  void reset_command_errors();
+
+private:
+  struct ErrorSums
+  {
+    uint64_t count = 0;
+    double absolute = 0.0;
+    double squared = 0.0;
+    double max_absolute = 0.0;
+  };
+
+  /// A command interface which was not recorded.
+  static constexpr size_t NOT_RECORDED = static_cast<size_t>(-1);
+
+  hardware_interface::HardwareInfo info_;
+  hardware_interface::status status_ = hardware_interface::status::UNKNOWN;
+  bool realtime_pacing_ = false;
+  hardware_interface::FlightRecordReader reader_;
+  /// Index in the recorded joint values, by joint and by interface.
+  std::vector<std::vector<size_t>> state_indices_;
+  std::vector<std::vector<size_t>> command_indices_;
+  /// Preallocated by configure(), read_joints() stays allocation free.
+  mutable std::vector<std::vector<double>> states_;
+  std::vector<double> commands_;
+  std::vector<std::vector<ErrorSums>> command_errors_;
+  size_t cycle_ = 0;
+  std::chrono::steady_clock::time_point start_time_;
+};
+
+}  // namespace test_robot_hardware
+#endif  // TEST_ROBOT_HARDWARE__REPLAY_SYSTEM_HARDWARE_HPP_
@@ -0,0 +1,72 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TEST_ROBOT_HARDWARE__SYNTHETIC_ROBOT_HARDWARE_HPP_
+#define TEST_ROBOT_HARDWARE__SYNTHETIC_ROBOT_HARDWARE_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+
+#include "test_robot_hardware/test_robot_hardware.hpp"
+#include "test_robot_hardware/visibility_control.h"
+
+namespace test_robot_hardware
+{
+
+/// Latency of the simulated bus, applied to every read and write.
+struct SyntheticBusOptions
+{
+  std::chrono::nanoseconds read_latency{0};
+  std::chrono::nanoseconds write_latency{0};
+  /// Extra latency drawn uniformly in [0, jitter] for each read and write
+  std::chrono::nanoseconds jitter{0};
+  /// Seed of the jitter, so that runs can be repeated
+  uint32_t seed = 42;
+};
+
+/// The joints of TestRobotHardware behind a simulated bus.
+/**
+ * Each read and write busy-waits for the latency of the bus, as a driver blocking on a bus
+ * transaction would, so that the control loop can be measured against a known hardware cost.
+ */
+class SyntheticRobotHardware : public TestRobotHardware
+{
+public:
+  TEST_ROBOT_HARDWARE_PUBLIC
+  explicit SyntheticRobotHardware(const SyntheticBusOptions & options = SyntheticBusOptions());
+
+  TEST_ROBOT_HARDWARE_PUBLIC
+  hardware_interface::return_type
+  read();
+
+  TEST_ROBOT_HARDWARE_PUBLIC
+  hardware_interface::return_type
+  write();
+
+  TEST_ROBOT_HARDWARE_PUBLIC
+  const SyntheticBusOptions & get_options() const;
+
+private:
+  void wait_for_bus(std::chrono::nanoseconds latency);
+
+  SyntheticBusOptions options_;
+  std::minstd_rand random_;
+  std::uniform_int_distribution<int64_t> jitter_;
+};
+
+}  // namespace test_robot_hardware
+#endif  // TEST_ROBOT_HARDWARE__SYNTHETIC_ROBOT_HARDWARE_HPP_
@@ -0,0 +1,266 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "test_robot_hardware/replay_system_hardware.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hardware_interface/interface_value_arena.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+
+using hardware_interface::InterfaceValueArena;
+using hardware_interface::return_type;
+using hardware_interface::status;
+
+namespace
+{
+constexpr auto kLoggerName = "replay_system_hardware";
+constexpr auto kRecordPathParameter = "record_path";
+constexpr auto kRealtimePacingParameter = "realtime_pacing";
+}  // namespace
+
+namespace test_robot_hardware
+{
+
+constexpr size_t ReplaySystemHardware::NOT_RECORDED;
+
+return_type
+ReplaySystemHardware::configure(const hardware_interface::HardwareInfo & system_info)
+{
+  const auto logger = rclcpp::get_logger(kLoggerName);
+  const auto record_path = system_info.hardware_parameters.find(kRecordPathParameter);
+  if (record_path == system_info.hardware_parameters.end()) {
+    RCLCPP_ERROR(logger, "parameter '%s' is required", kRecordPathParameter);
+    return return_type::ERROR;
+  }
+  const auto realtime_pacing = system_info.hardware_parameters.find(kRealtimePacingParameter);
+  realtime_pacing_ = realtime_pacing != system_info.hardware_parameters.end() &&
+    realtime_pacing->second == "true";
+  if (reader_.open(record_path->second) != return_type::OK) {
+    return return_type::ERROR;
+  }
+
+  const auto & recorded_names = reader_.get_joint_value_names();
+  auto find_recorded = [&recorded_names](const std::string & name) {
+      const auto found = std::find(recorded_names.begin(), recorded_names.end(), name);
+      return found == recorded_names.end() ?
+             NOT_RECORDED : static_cast<size_t>(found - recorded_names.begin());
+    };
+  state_indices_.clear();
+  command_indices_.clear();
+  states_.clear();
+  command_errors_.clear();
+  size_t max_command_count = 0;
+  for (const auto & joint : system_info.joints) {
+    state_indices_.emplace_back();
+    for (const auto & interface : joint.state_interfaces) {
+      const auto index = find_recorded(joint.name + "/" + interface);
+      if (index == NOT_RECORDED) {
+        RCLCPP_ERROR(
+          logger, "state '%s' of joint '%s' is not in record '%s'", interface.c_str(),
+          joint.name.c_str(), record_path->second.c_str());
+        reader_.close();
+        return return_type::ERROR;
+      }
+      state_indices_.back().push_back(index);
+    }
+    states_.emplace_back(joint.state_interfaces.size(), 0.0);
+
+    command_indices_.emplace_back();
+    for (const auto & interface : joint.command_interfaces) {
+      const auto recorded_name = InterfaceValueArena::is_command_interface(interface) ?
+        interface : interface + InterfaceValueArena::COMMAND_INTERFACE_SUFFIX;
+      const auto index = find_recorded(joint.name + "/" + recorded_name);
+      if (index == NOT_RECORDED) {
+        RCLCPP_WARN(
+          logger, "command '%s' of joint '%s' is not in record '%s', it is not compared",
+          interface.c_str(), joint.name.c_str(), record_path->second.c_str());
+      }
+      command_indices_.back().push_back(index);
+    }
+    command_errors_.emplace_back(joint.command_interfaces.size());
+    max_command_count = std::max(max_command_count, joint.command_interfaces.size());
+  }
+  commands_.reserve(max_command_count);
+
+  info_ = system_info;
+  cycle_ = 0;
+  status_ = status::CONFIGURED;
+  return return_type::OK;
+}
+
+return_type
+ReplaySystemHardware::start()
+{
+  if (status_ != status::CONFIGURED && status_ != status::STOPPED) {
+    return return_type::ERROR;
+  }
+  start_time_ = std::chrono::steady_clock::now();
+  status_ = status::STARTED;
+  return return_type::OK;
+}
+
+return_type
+ReplaySystemHardware::stop()
+{
+  if (status_ != status::STARTED) {
+    return return_type::ERROR;
+  }
+  status_ = status::STOPPED;
+  return return_type::OK;
+}
+
+status
+ReplaySystemHardware::get_status() const
+{
+  return status_;
+}
+
+return_type
+ReplaySystemHardware::read_sensors(
+  std::vector<std::shared_ptr<hardware_interface::components::Sensor>> & sensors) const
+{
+  (void) sensors;
+  return return_type::OK;
+}
+
+return_type
+ReplaySystemHardware::read_joints(
+  std::vector<std::shared_ptr<hardware_interface::components::Joint>> & joints) const
+{
+  if (status_ != status::STARTED || is_finished() || joints.size() != states_.size()) {
+    return return_type::ERROR;
+  }
+  if (realtime_pacing_) {
+    const auto recorded_time = std::chrono::nanoseconds(
+      reader_.get_cycle(cycle_).time_ns - reader_.get_cycle(0).time_ns);
+    std::this_thread::sleep_until(start_time_ + recorded_time);
+  }
+
+  const double * recorded_values = reader_.get_joint_values(cycle_);
+  for (size_t joint = 0; joint < joints.size(); ++joint) {
+    auto & states = states_[joint];
+    for (size_t interface = 0; interface < states.size(); ++interface) {
+      states[interface] = recorded_values[state_indices_[joint][interface]];
+    }
+    const auto ret = joints[joint]->set_state(states);
+    if (ret != return_type::OK) {
+      return ret;
+    }
+  }
+  return return_type::OK;
+}
+
+return_type
+ReplaySystemHardware::write_joints(
+  const std::vector<std::shared_ptr<hardware_interface::components::Joint>> & joints)
+{
+  if (status_ != status::STARTED || is_finished() || joints.size() != command_indices_.size()) {
+    return return_type::ERROR;
+  }
+
+  const double * recorded_values = reader_.get_joint_values(cycle_);
+  for (size_t joint = 0; joint < joints.size(); ++joint) {
+    const auto ret = joints[joint]->get_command(commands_);
+    if (ret != return_type::OK) {
+      return ret;
+    }
+    const auto & indices = command_indices_[joint];
+    for (size_t interface = 0; interface < indices.size() && interface < commands_.size();
+      ++interface)
+    {
+      if (indices[interface] == NOT_RECORDED) {
+        continue;
+      }
+      const double error = std::abs(commands_[interface] - recorded_values[indices[interface]]);
+      auto & sums = command_errors_[joint][interface];
+      ++sums.count;
+      sums.absolute += error;
+      sums.squared += error * error;
+      sums.max_absolute = std::max(sums.max_absolute, error);
+    }
+  }
+  ++cycle_;
+  return return_type::OK;
+}
+
+bool
+ReplaySystemHardware::is_finished() const
+{
+  return cycle_ >= reader_.get_cycle_count();
+}
+
+size_t
+ReplaySystemHardware::get_cycle_count() const
+{
+  return reader_.get_cycle_count();
+}
+
+size_t
+ReplaySystemHardware::get_replayed_cycle_count() const
+{
+  return cycle_;
+}
+
+int64_t
+ReplaySystemHardware::get_cycle_time_ns() const
+{
+  return is_finished() ? 0 : reader_.get_cycle(cycle_).time_ns;
+}
+
+std::map<std::string, ReplayCommandError>
+ReplaySystemHardware::get_command_errors() const
+{
+  std::map<std::string, ReplayCommandError> errors;
+  for (size_t joint = 0; joint < command_errors_.size(); ++joint) {
+    const auto & joint_info = info_.joints[joint];
+    for (size_t interface = 0; interface < command_errors_[joint].size(); ++interface) {
+      const auto & sums = command_errors_[joint][interface];
+      if (command_indices_[joint][interface] == NOT_RECORDED) {
+        continue;
+      }
+      ReplayCommandError error;
+      error.count = sums.count;
+      if (sums.count > 0) {
+        error.mean_absolute = sums.absolute / static_cast<double>(sums.count);
+        error.root_mean_square = std::sqrt(sums.squared / static_cast<double>(sums.count));
+        error.max_absolute = sums.max_absolute;
+      }
+      errors[joint_info.name + "/" + joint_info.command_interfaces[interface]] = error;
+    }
+  }
+  return errors;
+}
+
+void
+ReplaySystemHardware::reset_command_errors()
+{
+  for (auto & joint_errors : command_errors_) {
+    std::fill(joint_errors.begin(), joint_errors.end(), ErrorSums());
+  }
+}
+
+}  // namespace test_robot_hardware
+
+#include "pluginlib/class_list_macros.hpp"
+
+PLUGINLIB_EXPORT_CLASS(
+  test_robot_hardware::ReplaySystemHardware, hardware_interface::SystemHardwareInterface)
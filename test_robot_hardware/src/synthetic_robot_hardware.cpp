@@ -0,0 +1,67 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "test_robot_hardware/synthetic_robot_hardware.hpp"
+
+#include <chrono>
+
+namespace test_robot_hardware
+{
+
+SyntheticRobotHardware::SyntheticRobotHardware(const SyntheticBusOptions & options)
+: options_(options),
+  random_(options.seed),
+  jitter_(0, options.jitter.count())
+{}
+
+hardware_interface::return_type
+SyntheticRobotHardware::read()
+{
+  wait_for_bus(options_.read_latency);
+  return TestRobotHardware::read();
+}
+
+hardware_interface::return_type
+SyntheticRobotHardware::write()
+{
+  wait_for_bus(options_.write_latency);
+  return TestRobotHardware::write();
+}
+
+const SyntheticBusOptions &
+SyntheticRobotHardware::get_options() const
+{
+  return options_;
+}
+
+void
+SyntheticRobotHardware::wait_for_bus(std::chrono::nanoseconds latency)
+{
+  if (options_.jitter.count() > 0) {
+    latency += std::chrono::nanoseconds(jitter_(random_));
+  }
+  if (latency.count() <= 0) {
+    return;
+  }
+  const auto end = std::chrono::steady_clock::now() + latency;
+  while (std::chrono::steady_clock::now() < end) {
+  }
+}
+
+}  // namespace test_robot_hardware
+
+#include "pluginlib/class_list_macros.hpp"
+
+PLUGINLIB_EXPORT_CLASS(
+  test_robot_hardware::SyntheticRobotHardware, hardware_interface::RobotHardware)
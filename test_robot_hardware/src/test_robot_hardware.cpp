@@ -16,8 +16,11 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "hardware_interface/types/hardware_interface_type_values.hpp"
+
 namespace test_robot_hardware
 {
 
@@ -26,36 +29,28 @@ TestRobotHardware::init()
 {
   auto ret = hardware_interface::return_type::ERROR;
 
-  read_op_handle1 = hardware_interface::OperationModeHandle(
-    read_op_handle_name1,
-    reinterpret_cast<hardware_interface::OperationMode *>(&read1));
+  read_op_handle1 = hardware_interface::OperationModeHandle(read_op_handle_name1, &read1);
   ret = register_operation_mode_handle(&read_op_handle1);
   if (ret != hardware_interface::return_type::OK) {
     RCLCPP_WARN(logger, "can't register operation mode handle %s", read_op_handle_name1.c_str());
     return ret;
   }
 
-  read_op_handle2 = hardware_interface::OperationModeHandle(
-    read_op_handle_name2,
-    reinterpret_cast<hardware_interface::OperationMode *>(&read2));
+  read_op_handle2 = hardware_interface::OperationModeHandle(read_op_handle_name2, &read2);
   ret = register_operation_mode_handle(&read_op_handle2);
   if (ret != hardware_interface::return_type::OK) {
     RCLCPP_WARN(logger, "can't register operation mode handle %s", read_op_handle_name2.c_str());
     return ret;
   }
 
-  write_op_handle1 = hardware_interface::OperationModeHandle(
-    write_op_handle_name1,
-    reinterpret_cast<hardware_interface::OperationMode *>(&write1));
+  write_op_handle1 = hardware_interface::OperationModeHandle(write_op_handle_name1, &write1);
   ret = register_operation_mode_handle(&write_op_handle1);
   if (ret != hardware_interface::return_type::OK) {
     RCLCPP_WARN(logger, "can't register operation mode handle %s", write_op_handle_name1.c_str());
     return ret;
   }
 
-  write_op_handle2 = hardware_interface::OperationModeHandle(
-    write_op_handle_name2,
-    reinterpret_cast<hardware_interface::OperationMode *>(&write2));
+  write_op_handle2 = hardware_interface::OperationModeHandle(write_op_handle_name2, &write2);
   ret = register_operation_mode_handle(&write_op_handle2);
   if (ret != hardware_interface::return_type::OK) {
     RCLCPP_WARN(logger, "can't register operation mode handle %s", write_op_handle_name2.c_str());
@@ -63,20 +58,61 @@ TestRobotHardware::init()
   }
 
   // register actuators and joints
+  using hardware_interface::HW_IF_POSITION_ID;
+  using hardware_interface::HW_IF_VELOCITY_ID;
+  using hardware_interface::HW_IF_EFFORT_ID;
+  using hardware_interface::HW_IF_POSITION_COMMAND_ID;
+  using hardware_interface::HW_IF_VELOCITY_COMMAND_ID;
+  using hardware_interface::HW_IF_EFFORT_COMMAND_ID;
   for (auto index = 0u; index < 3u; ++index) {
-    register_actuator(actuator_names[index], "position", pos_dflt_values[index]);
-    register_actuator(actuator_names[index], "velocity", vel_dflt_values[index]);
-    register_actuator(actuator_names[index], "effort", eff_dflt_values[index]);
-    register_actuator(actuator_names[index], "position_command", pos_dflt_values[index]);
-    register_actuator(actuator_names[index], "velocity_command", vel_dflt_values[index]);
-    register_actuator(actuator_names[index], "effort_command", eff_dflt_values[index]);
-
-    register_joint(joint_names[index], "position", pos_dflt_values[index]);
-    register_joint(joint_names[index], "velocity", vel_dflt_values[index]);
-    register_joint(joint_names[index], "effort", eff_dflt_values[index]);
-    register_joint(joint_names[index], "position_command", pos_dflt_values[index]);
-    register_joint(joint_names[index], "velocity_command", vel_dflt_values[index]);
-    register_joint(joint_names[index], "effort_command", eff_dflt_values[index]);
+    register_actuator(actuator_names[index], HW_IF_POSITION_ID, pos_dflt_values[index]);
+    register_actuator(actuator_names[index], HW_IF_VELOCITY_ID, vel_dflt_values[index]);
+    register_actuator(actuator_names[index], HW_IF_EFFORT_ID, eff_dflt_values[index]);
+    register_actuator(actuator_names[index], HW_IF_POSITION_COMMAND_ID, pos_dflt_values[index]);
+    register_actuator(actuator_names[index], HW_IF_VELOCITY_COMMAND_ID, vel_dflt_values[index]);
+    register_actuator(actuator_names[index], HW_IF_EFFORT_COMMAND_ID, eff_dflt_values[index]);
+
+    register_joint(joint_names[index], HW_IF_POSITION_ID, pos_dflt_values[index]);
+    register_joint(joint_names[index], HW_IF_VELOCITY_ID, vel_dflt_values[index]);
+    register_joint(joint_names[index], HW_IF_EFFORT_ID, eff_dflt_values[index]);
+    register_joint(joint_names[index], HW_IF_POSITION_COMMAND_ID, pos_dflt_values[index]);
+    register_joint(joint_names[index], HW_IF_VELOCITY_COMMAND_ID, vel_dflt_values[index]);
+    register_joint(joint_names[index], HW_IF_EFFORT_COMMAND_ID, eff_dflt_values[index]);
+  }
+
+  ret = freeze_registration();
+  if (ret != hardware_interface::return_type::OK) {
+    return ret;
+  }
+
+  // resolve the handles used in write() once, the frozen values never move, the commands are
+  // read from their published copy
+  joint_state_handles.clear();
+  joint_command_handles.clear();
+  const std::pair<hardware_interface::InterfaceTypeId, hardware_interface::InterfaceTypeId>
+  interface_types[] = {
+    {HW_IF_POSITION_ID, HW_IF_POSITION_COMMAND_ID},
+    {HW_IF_VELOCITY_ID, HW_IF_VELOCITY_COMMAND_ID},
+    {HW_IF_EFFORT_ID, HW_IF_EFFORT_COMMAND_ID}};
+  for (const auto & joint_name : joint_names) {
+    for (const auto & interface_type : interface_types) {
+      hardware_interface::InterfaceId state_id;
+      hardware_interface::InterfaceId command_id;
+      hardware_interface::JointHandle state_handle("", "");
+      hardware_interface::JointHandle command_handle("", "");
+      if (get_joint_interface_id(joint_name, interface_type.first, state_id) !=
+        hardware_interface::return_type::OK ||
+        get_joint_interface_id(joint_name, interface_type.second, command_id) !=
+        hardware_interface::return_type::OK ||
+        get_joint_handle(state_id, state_handle) != hardware_interface::return_type::OK ||
+        get_published_joint_handle(command_id, command_handle) !=
+        hardware_interface::return_type::OK)
+      {
+        return hardware_interface::return_type::ERROR;
+      }
+      joint_state_handles.push_back(state_handle.bind());
+      joint_command_handles.push_back(command_handle.bind());
+    }
   }
 
   return hardware_interface::return_type::OK;
@@ -91,34 +127,16 @@ TestRobotHardware::read()
 hardware_interface::return_type
 TestRobotHardware::write()
 {
-  auto update_handle = [&](const std::string & joint_name, const std::string & interface_name)
-    {
-      auto get_handle = [&](const std::string & joint_name, const std::string & interface_name)
-        {
-          auto joint_handle = std::make_shared<hardware_interface::JointHandle>(
-            joint_name,
-            interface_name);
-          get_joint_handle(*joint_handle);
-          return joint_handle;
-        };
-
-      get_handle(
-        joint_name,
-        interface_name)->set_value(
-        get_handle(
-          joint_name,
-          interface_name + "_command")->get_value());
-    };
-
   // update all the joint state handles with their respectives command values
-  const std::vector<std::string> interface_names = {"position", "velocity", "effort"};
-  for (const auto & joint_name : joint_names) {
-    for (const auto & interface_name : interface_names) {
-      update_handle(joint_name, interface_name);
-    }
+  for (size_t i = 0; i < joint_state_handles.size(); ++i) {
+    joint_state_handles[i].set_value(joint_command_handles[i].get_value());
   }
 
   return hardware_interface::return_type::OK;
 }
 
 }  // namespace test_robot_hardware
+
+#include "pluginlib/class_list_macros.hpp"
+
+PLUGINLIB_EXPORT_CLASS(test_robot_hardware::TestRobotHardware, hardware_interface::RobotHardware)
@@ -0,0 +1,227 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "hardware_interface/components/joint.hpp"
+#include "hardware_interface/flight_record.hpp"
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+#include "hardware_interface/types/hardware_interface_status_values.hpp"
+
+#include "test_robot_hardware/replay_system_hardware.hpp"
+
+using hw_ret = hardware_interface::return_type;
+using hardware_interface::FlightRecordCycle;
+using hardware_interface::FlightRecordHeader;
+using hardware_interface::components::ComponentInfo;
+using hardware_interface::components::Joint;
+using test_robot_hardware::ReplaySystemHardware;
+
+namespace
+{
+/// Recorded joint values: the position of joint1 and of joint2, then their position commands
+const std::vector<std::string> kRecordedNames = {
+  "joint1/position", "joint2/position", "", "joint1/position_command", "joint2/position_command"};
+
+class TestReplaySystemHardware : public ::testing::Test
+{
+public:
+  void SetUp() override
+  {
+    path_ = ::testing::TempDir() + "test_replay_system_hardware_" + std::to_string(getpid()) +
+      ".bin";
+    info_.name = "replay";
+    info_.type = "system";
+    info_.hardware_class_type = "test_robot_hardware/ReplaySystemHardware";
+    info_.hardware_parameters["record_path"] = path_;
+    for (const auto & name : {"joint1", "joint2"}) {
+      ComponentInfo joint_info;
+      joint_info.name = name;
+      joint_info.type = "joint";
+      joint_info.command_interfaces = {"position"};
+      joint_info.state_interfaces = {"position"};
+      info_.joints.push_back(joint_info);
+      auto joint = std::make_shared<Joint>();
+      ASSERT_EQ(hw_ret::OK, joint->configure(joint_info));
+      joints_.push_back(joint);
+    }
+  }
+
+  void TearDown() override
+  {
+    std::remove(path_.c_str());
+  }
+
+  /// Writes a record of one cycle per 10 ms, where joint1 is at i and joint2 at -i in cycle i,
+  /// commanded to i + 1 and -i - 1
+  void write_record(size_t cycle_count)
+  {
+    std::string names;
+    for (const auto & name : kRecordedNames) {
+      names.append(name).push_back('\0');
+    }
+    FlightRecordHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = FlightRecordHeader::MAGIC;
+    header.layout_version = FlightRecordHeader::LAYOUT_VERSION;
+    header.joint_value_count = kRecordedNames.size();
+    header.cycle_size = sizeof(FlightRecordCycle) + kRecordedNames.size() * sizeof(double);
+    header.cycle_count = cycle_count;
+    header.names_offset = sizeof(header);
+    header.names_size = names.size();
+    header.cycles_offset = (sizeof(header) + names.size() + 7) / 8 * 8;
+
+    std::ofstream file(path_, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(names.data(), static_cast<std::streamsize>(names.size()));
+    const std::string padding(header.cycles_offset - sizeof(header) - names.size(), '\0');
+    file.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+    for (size_t i = 0; i < cycle_count; ++i) {
+      FlightRecordCycle cycle;
+      std::memset(&cycle, 0, sizeof(cycle));
+      cycle.time_ns = 1000000000 + static_cast<int64_t>(i) * 10000000;
+      cycle.period_ns = 10000000;
+      file.write(reinterpret_cast<const char *>(&cycle), sizeof(cycle));
+      const double position = static_cast<double>(i);
+      const double values[] = {position, -position, 0.0, position + 1.0, -position - 1.0};
+      file.write(reinterpret_cast<const char *>(values), sizeof(values));
+    }
+    ASSERT_TRUE(file.good());
+  }
+
+  double get_position(size_t joint)
+  {
+    std::vector<double> state;
+    joints_[joint]->get_state(state);
+    return state.at(0);
+  }
+
+  void set_position_command(size_t joint, double command)
+  {
+    ASSERT_EQ(hw_ret::OK, joints_[joint]->set_command({command}, {"position"}));
+  }
+
+  std::string path_;
+  hardware_interface::HardwareInfo info_;
+  std::vector<std::shared_ptr<Joint>> joints_;
+};
+}  // namespace
+
+TEST_F(TestReplaySystemHardware, needs_a_compatible_record) {
+  ReplaySystemHardware replay;
+  auto info = info_;
+  info.hardware_parameters.clear();
+  EXPECT_EQ(hw_ret::ERROR, replay.configure(info));
+  // not written yet
+  EXPECT_EQ(hw_ret::ERROR, replay.configure(info_));
+
+  write_record(3);
+  info = info_;
+  info.joints[1].state_interfaces = {"velocity"};
+  EXPECT_EQ(hw_ret::ERROR, replay.configure(info));
+  EXPECT_EQ(hardware_interface::status::UNKNOWN, replay.get_status());
+
+  // the commands which were not recorded are not compared
+  info = info_;
+  info.joints[1].command_interfaces = {"velocity"};
+  ASSERT_EQ(hw_ret::OK, replay.configure(info));
+  EXPECT_EQ(1u, replay.get_command_errors().count("joint1/position"));
+  EXPECT_EQ(0u, replay.get_command_errors().count("joint2/velocity"));
+}
+
+TEST_F(TestReplaySystemHardware, replays_the_recorded_states) {
+  write_record(3);
+  ReplaySystemHardware replay;
+  ASSERT_EQ(hw_ret::OK, replay.configure(info_));
+  EXPECT_EQ(hardware_interface::status::CONFIGURED, replay.get_status());
+  EXPECT_EQ(3u, replay.get_cycle_count());
+  // only once started
+  EXPECT_EQ(hw_ret::ERROR, replay.read_joints(joints_));
+  ASSERT_EQ(hw_ret::OK, replay.start());
+
+  for (size_t i = 0; i < 3; ++i) {
+    EXPECT_FALSE(replay.is_finished());
+    EXPECT_EQ(i, replay.get_replayed_cycle_count());
+    EXPECT_EQ(1000000000 + static_cast<int64_t>(i) * 10000000, replay.get_cycle_time_ns());
+    ASSERT_EQ(hw_ret::OK, replay.read_joints(joints_));
+    EXPECT_EQ(static_cast<double>(i), get_position(0));
+    EXPECT_EQ(-static_cast<double>(i), get_position(1));
+    // reading again replays the same cycle
+    ASSERT_EQ(hw_ret::OK, replay.read_joints(joints_));
+    EXPECT_EQ(static_cast<double>(i), get_position(0));
+    ASSERT_EQ(hw_ret::OK, replay.write_joints(joints_));
+  }
+  EXPECT_TRUE(replay.is_finished());
+  EXPECT_EQ(hw_ret::ERROR, replay.read_joints(joints_));
+  EXPECT_EQ(hw_ret::ERROR, replay.write_joints(joints_));
+  EXPECT_EQ(hw_ret::OK, replay.stop());
+}
+
+TEST_F(TestReplaySystemHardware, compares_the_commands_to_the_recorded_ones) {
+  write_record(4);
+  ReplaySystemHardware replay;
+  ASSERT_EQ(hw_ret::OK, replay.configure(info_));
+  ASSERT_EQ(hw_ret::OK, replay.start());
+
+  // joint1 as recorded, joint2 off by 1, 1, 3 and 3
+  const double joint2_errors[] = {1.0, -1.0, 3.0, -3.0};
+  for (size_t i = 0; i < 4; ++i) {
+    ASSERT_EQ(hw_ret::OK, replay.read_joints(joints_));
+    const double position = static_cast<double>(i);
+    set_position_command(0, position + 1.0);
+    set_position_command(1, -position - 1.0 + joint2_errors[i]);
+    ASSERT_EQ(hw_ret::OK, replay.write_joints(joints_));
+  }
+
+  auto errors = replay.get_command_errors();
+  ASSERT_EQ(2u, errors.size());
+  EXPECT_EQ(4u, errors["joint1/position"].count);
+  EXPECT_EQ(0.0, errors["joint1/position"].max_absolute);
+  EXPECT_EQ(0.0, errors["joint1/position"].root_mean_square);
+  EXPECT_EQ(4u, errors["joint2/position"].count);
+  EXPECT_DOUBLE_EQ(2.0, errors["joint2/position"].mean_absolute);
+  EXPECT_DOUBLE_EQ(std::sqrt(5.0), errors["joint2/position"].root_mean_square);
+  EXPECT_DOUBLE_EQ(3.0, errors["joint2/position"].max_absolute);
+
+  replay.reset_command_errors();
+  EXPECT_EQ(0u, replay.get_command_errors()["joint2/position"].count);
+}
+
+TEST_F(TestReplaySystemHardware, paces_the_cycles_as_recorded) {
+  write_record(4);
+  auto info = info_;
+  info.hardware_parameters["realtime_pacing"] = "true";
+  ReplaySystemHardware replay;
+  ASSERT_EQ(hw_ret::OK, replay.configure(info));
+  ASSERT_EQ(hw_ret::OK, replay.start());
+
+  const auto start = std::chrono::steady_clock::now();
+  while (!replay.is_finished()) {
+    ASSERT_EQ(hw_ret::OK, replay.read_joints(joints_));
+    ASSERT_EQ(hw_ret::OK, replay.write_joints(joints_));
+  }
+  // the last cycle was recorded 30 ms after the first one
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(30));
+}
@@ -0,0 +1,40 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "hardware_interface/robot_hardware.hpp"
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+#include "pluginlib/class_loader.hpp"
+
+using hw_ret = hardware_interface::return_type;
+
+// the robot hardware plugins the ros2_control_node can run
+TEST(TestRobotHardwarePlugins, loads_the_robot_hardware) {
+  pluginlib::ClassLoader<hardware_interface::RobotHardware> loader(
+    "hardware_interface", "hardware_interface::RobotHardware");
+  for (const std::string name :
+    {"test_robot_hardware/TestRobotHardware", "test_robot_hardware/SyntheticRobotHardware"})
+  {
+    ASSERT_TRUE(loader.isClassAvailable(name)) << name;
+    auto robot = loader.createSharedInstance(name);
+    ASSERT_NE(nullptr, robot);
+    EXPECT_EQ(hw_ret::OK, robot->init()) << name;
+    EXPECT_EQ(hw_ret::OK, robot->read()) << name;
+    EXPECT_EQ(hw_ret::OK, robot->write()) << name;
+  }
+}
@@ -0,0 +1,56 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+
+#include "gtest/gtest.h"
+
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+
+#include "test_robot_hardware/synthetic_robot_hardware.hpp"
+
+using hw_ret = hardware_interface::return_type;
+using test_robot_hardware::SyntheticBusOptions;
+using test_robot_hardware::SyntheticRobotHardware;
+
+TEST(TestSyntheticRobotHardware, without_latency_behaves_as_test_robot_hardware) {
+  SyntheticRobotHardware robot;
+  ASSERT_EQ(hw_ret::OK, robot.init());
+
+  robot.joint_command_handles[0].set_value(5.0);
+  EXPECT_EQ(hw_ret::OK, robot.read());
+  EXPECT_EQ(hw_ret::OK, robot.write());
+  EXPECT_EQ(5.0, robot.joint_state_handles[0].get_value());
+}
+
+TEST(TestSyntheticRobotHardware, waits_for_the_bus) {
+  SyntheticBusOptions options;
+  options.read_latency = std::chrono::microseconds(200);
+  options.write_latency = std::chrono::microseconds(300);
+  options.jitter = std::chrono::microseconds(100);
+  SyntheticRobotHardware robot(options);
+  ASSERT_EQ(hw_ret::OK, robot.init());
+
+  for (int i = 0; i < 10; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(hw_ret::OK, robot.read());
+    const auto read_duration = std::chrono::steady_clock::now() - start;
+    EXPECT_GE(read_duration, options.read_latency);
+
+    start = std::chrono::steady_clock::now();
+    EXPECT_EQ(hw_ret::OK, robot.write());
+    const auto write_duration = std::chrono::steady_clock::now() - start;
+    EXPECT_GE(write_duration, options.write_latency);
+  }
+}
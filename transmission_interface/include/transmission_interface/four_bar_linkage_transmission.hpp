@@ -0,0 +1,118 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TRANSMISSION_INTERFACE__FOUR_BAR_LINKAGE_TRANSMISSION_HPP_
+#define TRANSMISSION_INTERFACE__FOUR_BAR_LINKAGE_TRANSMISSION_HPP_
+
+#include <stdexcept>
+#include <vector>
+
+#include "transmission_interface/transmission.hpp"
+
+namespace transmission_interface
+{
+/// A four-bar linkage between two actuators and two joints, the second joint being driven
+/// relatively to the first one.
+/**
+ * With actuator reductions ar and joint reductions jr:
+ * joint_effort[0] = jr[0] * ar[0] * actuator_effort[0]
+ * joint_effort[1] = jr[1] * (ar[1] * actuator_effort[1] - jr[0] * ar[0] * actuator_effort[0])
+ * joint_velocity[0] = actuator_velocity[0] / (jr[0] * ar[0])
+ * joint_velocity[1] =
+ *   (actuator_velocity[1] / ar[1] - actuator_velocity[0] / (jr[0] * ar[0])) / jr[1]
+ * and the joint positions as the velocities, plus the joint offsets.
+ */
+class FourBarLinkageTransmission : public Transmission
+{
+public:
+  /**
+   * \param actuator_reduction The reduction ratios of the two actuators.
+   * \param joint_reduction The reduction ratios of the two joints.
+   * \param joint_offset The joint positions when the actuator positions are zero.
+   * \throws std::invalid_argument if there are not two of each value or a reduction is zero.
+   */
+  FourBarLinkageTransmission(
+    const std::vector<double> & actuator_reduction, const std::vector<double> & joint_reduction,
+    const std::vector<double> & joint_offset = {0.0, 0.0})
+  : actuator_reduction_(actuator_reduction),
+    joint_reduction_(joint_reduction),
+    joint_offset_(joint_offset)
+  {
+    if (actuator_reduction_.size() != 2 || joint_reduction_.size() != 2 ||
+      joint_offset_.size() != 2)
+    {
+      throw std::invalid_argument(
+              "four-bar linkage transmission needs two actuators and two joints");
+    }
+    for (size_t i = 0; i < 2; ++i) {
+      if (actuator_reduction_[i] == 0.0 || joint_reduction_[i] == 0.0) {
+        throw std::invalid_argument("transmission reduction ratios cannot be zero");
+      }
+    }
+  }
+
+  size_t num_actuators() const override {return 2;}
+
+  size_t num_joints() const override {return 2;}
+
+  std::vector<double> get_actuator_to_joint_map() const override
+  {
+    const auto & ar = actuator_reduction_;
+    const auto & jr = joint_reduction_;
+    return {
+      1.0 / (jr[0] * ar[0]), 0.0,
+      -1.0 / (jr[1] * jr[0] * ar[0]), 1.0 / (jr[1] * ar[1])};
+  }
+
+  std::vector<double> get_joint_to_actuator_map() const override
+  {
+    const auto & ar = actuator_reduction_;
+    const auto & jr = joint_reduction_;
+    return {
+      jr[0] * ar[0], 0.0,
+      ar[1], jr[1] * ar[1]};
+  }
+
+  std::vector<double> get_actuator_to_joint_effort_map() const override
+  {
+    const auto & ar = actuator_reduction_;
+    const auto & jr = joint_reduction_;
+    return {
+      jr[0] * ar[0], 0.0,
+      -jr[1] * jr[0] * ar[0], jr[1] * ar[1]};
+  }
+
+  std::vector<double> get_joint_to_actuator_effort_map() const override
+  {
+    const auto & ar = actuator_reduction_;
+    const auto & jr = joint_reduction_;
+    return {
+      1.0 / (ar[0] * jr[0]), 0.0,
+      1.0 / ar[1], 1.0 / (jr[1] * ar[1])};
+  }
+
+  std::vector<double> get_joint_offsets() const override {return joint_offset_;}
+
+  const std::vector<double> & get_actuator_reduction() const {return actuator_reduction_;}
+
+  const std::vector<double> & get_joint_reduction() const {return joint_reduction_;}
+
+private:
+  std::vector<double> actuator_reduction_;
+  std::vector<double> joint_reduction_;
+  std::vector<double> joint_offset_;
+};
+
+}  // namespace transmission_interface
+#endif  // TRANSMISSION_INTERFACE__FOUR_BAR_LINKAGE_TRANSMISSION_HPP_
@@ -0,0 +1,74 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TRANSMISSION_INTERFACE__SIMPLE_TRANSMISSION_HPP_
+#define TRANSMISSION_INTERFACE__SIMPLE_TRANSMISSION_HPP_
+
+#include <stdexcept>
+#include <vector>
+
+#include "transmission_interface/transmission.hpp"
+
+namespace transmission_interface
+{
+/// A reducer between one actuator and one joint, e.g. a gearbox or a belt.
+/**
+ * joint_position = actuator_position / reduction + joint_offset
+ * joint_velocity = actuator_velocity / reduction
+ * joint_effort = actuator_effort * reduction
+ */
+class SimpleTransmission : public Transmission
+{
+public:
+  /**
+   * \param reduction The reduction ratio, negative if the joint turns the opposite way.
+   * \param joint_offset The joint position when the actuator position is zero.
+   * \throws std::invalid_argument if the reduction is zero.
+   */
+  explicit SimpleTransmission(double reduction, double joint_offset = 0.0)
+  : reduction_(reduction), joint_offset_(joint_offset)
+  {
+    if (reduction == 0.0) {
+      throw std::invalid_argument("transmission reduction ratio cannot be zero");
+    }
+  }
+
+  size_t num_actuators() const override {return 1;}
+
+  size_t num_joints() const override {return 1;}
+
+  std::vector<double> get_actuator_to_joint_map() const override {return {1.0 / reduction_};}
+
+  std::vector<double> get_joint_to_actuator_map() const override {return {reduction_};}
+
+  std::vector<double> get_actuator_to_joint_effort_map() const override {return {reduction_};}
+
+  std::vector<double> get_joint_to_actuator_effort_map() const override
+  {
+    return {1.0 / reduction_};
+  }
+
+  std::vector<double> get_joint_offsets() const override {return {joint_offset_};}
+
+  double get_reduction() const {return reduction_;}
+
+  double get_joint_offset() const {return joint_offset_;}
+
+private:
+  double reduction_;
+  double joint_offset_;
+};
+
+}  // namespace transmission_interface
+#endif  // TRANSMISSION_INTERFACE__SIMPLE_TRANSMISSION_HPP_
@@ -0,0 +1,62 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TRANSMISSION_INTERFACE__TRANSMISSION_HPP_
+#define TRANSMISSION_INTERFACE__TRANSMISSION_HPP_
+
+#include <cstddef>
+#include <vector>
+
+namespace transmission_interface
+{
+/// A mechanical transmission between actuators and joints.
+/**
+ * Transmissions are described by the linear maps between their actuator and joint values, so the
+ * TransmissionEngine can compile all of them into one mapping, instead of converting the values
+ * joint by joint.
+ * Maps are dense, row-major, with one row per output value and one coefficient per input value:
+ * the maps from actuators to joints have num_joints() rows of num_actuators() coefficients and
+ * the maps from joints to actuators the opposite.
+ * Positions and velocities go through the same maps, the positions being offset:
+ * joint_position = actuator_to_joint * actuator_position + joint_offset.
+ */
+class Transmission
+{
+public:
+  virtual ~Transmission() = default;
+
+  virtual size_t num_actuators() const = 0;
+
+  virtual size_t num_joints() const = 0;
+
+  /// Map from the actuator positions and velocities to the joint ones.
+  virtual std::vector<double> get_actuator_to_joint_map() const = 0;
+
+  /// Map from the joint positions and velocities to the actuator ones, the inverse of
+  /// get_actuator_to_joint_map().
+  virtual std::vector<double> get_joint_to_actuator_map() const = 0;
+
+  /// Map from the actuator efforts to the joint efforts.
+  virtual std::vector<double> get_actuator_to_joint_effort_map() const = 0;
+
+  /// Map from the joint efforts to the actuator efforts, the inverse of
+  /// get_actuator_to_joint_effort_map().
+  virtual std::vector<double> get_joint_to_actuator_effort_map() const = 0;
+
+  /// Offsets of the joint positions, one per joint.
+  virtual std::vector<double> get_joint_offsets() const = 0;
+};
+
+}  // namespace transmission_interface
+#endif  // TRANSMISSION_INTERFACE__TRANSMISSION_HPP_
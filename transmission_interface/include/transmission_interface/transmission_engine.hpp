@@ -0,0 +1,148 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TRANSMISSION_INTERFACE__TRANSMISSION_ENGINE_HPP_
+#define TRANSMISSION_INTERFACE__TRANSMISSION_ENGINE_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "hardware_interface/robot_hardware.hpp"
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+#include "transmission_interface/transmission.hpp"
+#include "transmission_interface/visibility_control.h"
+
+namespace transmission_interface
+{
+/// Propagate the values of a RobotHardware between its actuators and its joints.
+/**
+ * All the transmissions are compiled into two sparse linear maps between the actuator and joint
+ * arenas of the hardware: one from the actuator states to the joint states, one from the joint
+ * commands to the actuator commands. Each map is applied to all the values in a single pass,
+ * without virtual calls nor branches per joint.
+ * The "position", "velocity" and "effort" interfaces are mapped, states as they are and commands
+ * with the COMMAND_INTERFACE_SUFFIX of the arena, e.g. "position_command". A value is mapped if
+ * it is registered, as well as all the values it depends on.
+ */
+class TransmissionEngine
+{
+public:
+  TRANSMISSION_INTERFACE_PUBLIC
+  TransmissionEngine() = default;
+
+  /// Add a transmission between actuators and joints of the hardware.
+  /**
+   * \param[in] transmission The transmission, shared with the engine.
+   * \param[in] actuator_names The names of the actuators, in the order of the transmission.
+   * \param[in] joint_names The names of the joints, in the order of the transmission.
+   * \return The return code, one of `OK` or `ERROR` if the names do not match the numbers of
+   * actuators and joints of the transmission or the engine is already configured.
+   */
+  TRANSMISSION_INTERFACE_PUBLIC
+  hardware_interface::return_type add_transmission(
+    std::shared_ptr<const Transmission> transmission,
+    const std::vector<std::string> & actuator_names,
+    const std::vector<std::string> & joint_names);
+
+  /// Compile the transmissions against the arenas of a hardware.
+  /**
+   * Called in a non real-time thread.
+   * \param[in] robot_hardware The hardware, its registration must be frozen and it must outlive
+   * the engine.
+   * \return The return code, one of `OK` or `ERROR` if the registration is not frozen or an
+   * actuator or a joint of a transmission is not registered.
+   */
+  TRANSMISSION_INTERFACE_PUBLIC
+  hardware_interface::return_type configure(hardware_interface::RobotHardware & robot_hardware);
+
+  TRANSMISSION_INTERFACE_PUBLIC
+  bool is_configured() const;
+
+  /// Compute the joint states from the actuator states, e.g. at the end of read().
+  /**
+   * Real-time safe, does nothing if the engine is not configured.
+   */
+  TRANSMISSION_INTERFACE_PUBLIC
+  void actuator_to_joint();
+
+  /// Compute the actuator commands from the joint commands, e.g. at the begin of write().
+  /**
+   * Maps the published copies of the commands, so that it runs after publish_commands() and the
+   * hardware reads the actuator commands of the current cycle through its published handles.
+   * Real-time safe, does nothing if the engine is not configured.
+   */
+  TRANSMISSION_INTERFACE_PUBLIC
+  void joint_to_actuator();
+
+  /// Number of joint states computed by actuator_to_joint().
+  TRANSMISSION_INTERFACE_PUBLIC
+  size_t get_state_map_size() const;
+
+  /// Number of actuator commands computed by joint_to_actuator().
+  TRANSMISSION_INTERFACE_PUBLIC
+  size_t get_command_map_size() const;
+
+private:
+  /// Sparse linear map between two arenas, output = constant + sum(coefficient * input).
+  /**
+   * Rows are grouped by their number of terms and stored term by term, so each group is applied
+   * with straight loops over contiguous arrays, without padding terms.
+   */
+  struct LinearMap
+  {
+    struct Row
+    {
+      size_t output;
+      double constant;
+      std::vector<std::pair<size_t, double>> terms;
+    };
+
+    struct Block
+    {
+      size_t term_count = 0;
+      std::vector<size_t> outputs;
+      std::vector<double> constants;
+      /// Offsets of the inputs and coefficients, term by term: outputs.size() entries per term.
+      std::vector<size_t> inputs;
+      std::vector<double> coefficients;
+      /// Scratch storage of the results, as the outputs are scattered.
+      std::vector<double> results;
+    };
+
+    void compile(const std::vector<Row> & rows);
+
+    void apply(const double * input, double * output);
+
+    size_t size = 0;
+    std::vector<Block> blocks;
+  };
+
+  struct TransmissionSpec
+  {
+    std::shared_ptr<const Transmission> transmission;
+    std::vector<std::string> actuator_names;
+    std::vector<std::string> joint_names;
+  };
+
+  std::vector<TransmissionSpec> transmissions_;
+  hardware_interface::RobotHardware * robot_hardware_ = nullptr;
+  LinearMap state_map_;
+  LinearMap command_map_;
+};
+
+}  // namespace transmission_interface
+#endif  // TRANSMISSION_INTERFACE__TRANSMISSION_ENGINE_HPP_
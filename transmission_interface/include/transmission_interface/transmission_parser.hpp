@@ -18,6 +18,7 @@
 #include <string>
 #include <vector>
 
+#include "hardware_interface/urdf_document.hpp"
 #include "transmission_interface/transmission_info.hpp"
 #include "transmission_interface/visibility_control.h"
 
@@ -31,5 +32,15 @@ namespace transmission_interface
  */
 TRANSMISSION_INTERFACE_PUBLIC
 std::vector<TransmissionInfo> parse_transmissions_from_urdf(const std::string & urdf);
+
+/**
+ * \brief Parse transmission information from an already parsed URDF
+ * \param urdf The URDF, that may be shared with the other parsers
+ * \return parsed transmission information
+ * \throws std::runtime_error on malformed transmissions
+ */
+TRANSMISSION_INTERFACE_PUBLIC
+std::vector<TransmissionInfo> parse_transmissions_from_urdf(
+  const hardware_interface::URDFDocument & urdf);
 }  // namespace transmission_interface
 #endif  // TRANSMISSION_INTERFACE__TRANSMISSION_PARSER_HPP_
@@ -0,0 +1,320 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "transmission_interface/transmission_engine.hpp"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace
+{
+constexpr auto kLoggerName = "transmission engine";
+constexpr const char * kMappedInterfaces[] = {"position", "velocity", "effort"};
+
+/// Find the offsets of the interface values of handles in their arena.
+class ArenaOffsets
+{
+public:
+  template<typename GetInterfaceNames>
+  ArenaOffsets(
+    hardware_interface::InterfaceValueArena & arena, const std::vector<std::string> & handle_names,
+    GetInterfaceNames get_interface_names, bool published = false)
+  : arena_(arena), published_(published)
+  {
+    for (size_t handle = 0; handle < handle_names.size(); ++handle) {
+      auto & interfaces = handles_[handle_names[handle]];
+      interfaces.first = handle;
+      const auto & interface_names = get_interface_names(handle_names[handle]);
+      for (size_t interface = 0; interface < interface_names.size(); ++interface) {
+        interfaces.second.emplace(interface_names[interface], interface);
+      }
+    }
+  }
+
+  bool has_handle(const std::string & handle_name) const
+  {
+    return handles_.count(handle_name) > 0;
+  }
+
+  bool find(const std::string & handle_name, const std::string & interface_name, size_t & offset)
+  const
+  {
+    const auto handle = handles_.find(handle_name);
+    if (handle == handles_.end()) {
+      return false;
+    }
+    const auto interface = handle->second.second.find(interface_name);
+    if (interface == handle->second.second.end()) {
+      return false;
+    }
+    offset = published_ ?
+      arena_.get_published_value_ptr(handle->second.first, interface->second) - arena_.data() :
+      arena_.get_offset(handle->second.first, interface->second);
+    return true;
+  }
+
+private:
+  hardware_interface::InterfaceValueArena & arena_;
+  /// Whether the offsets of the command values are the ones of their published copy.
+  bool published_;
+  /// Index of each handle and of each of its interfaces, by name.
+  std::unordered_map<std::string, std::pair<size_t, std::unordered_map<std::string, size_t>>>
+  handles_;
+};
+}  // namespace
+
+namespace transmission_interface
+{
+
+hardware_interface::return_type TransmissionEngine::add_transmission(
+  std::shared_ptr<const Transmission> transmission,
+  const std::vector<std::string> & actuator_names,
+  const std::vector<std::string> & joint_names)
+{
+  if (is_configured()) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger(kLoggerName), "cannot add a transmission to a configured engine");
+    return hardware_interface::return_type::ERROR;
+  }
+  if (!transmission || actuator_names.size() != transmission->num_actuators() ||
+    joint_names.size() != transmission->num_joints())
+  {
+    RCLCPP_ERROR(
+      rclcpp::get_logger(kLoggerName),
+      "the actuators and joints do not match the transmission");
+    return hardware_interface::return_type::ERROR;
+  }
+  transmissions_.push_back({std::move(transmission), actuator_names, joint_names});
+  return hardware_interface::return_type::OK;
+}
+
+hardware_interface::return_type TransmissionEngine::configure(
+  hardware_interface::RobotHardware & robot_hardware)
+{
+  if (!robot_hardware.is_registration_frozen()) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger(kLoggerName),
+      "cannot configure the transmissions before the registration is frozen");
+    return hardware_interface::return_type::ERROR;
+  }
+
+  const ArenaOffsets actuators(
+    robot_hardware.get_actuator_values(), robot_hardware.get_registered_actuator_names(),
+    [&robot_hardware](const std::string & name) -> const std::vector<std::string> & {
+      return robot_hardware.get_registered_actuator_interface_names(name);
+    });
+  const ArenaOffsets joints(
+    robot_hardware.get_joint_values(), robot_hardware.get_registered_joint_names(),
+    [&robot_hardware](const std::string & name) -> const std::vector<std::string> & {
+      return robot_hardware.get_registered_joint_interface_names(name);
+    });
+  // the commands are mapped between the published copies, read by the hardware after
+  // publish_commands()
+  const ArenaOffsets published_actuators(
+    robot_hardware.get_actuator_values(), robot_hardware.get_registered_actuator_names(),
+    [&robot_hardware](const std::string & name) -> const std::vector<std::string> & {
+      return robot_hardware.get_registered_actuator_interface_names(name);
+    }, true);
+  const ArenaOffsets published_joints(
+    robot_hardware.get_joint_values(), robot_hardware.get_registered_joint_names(),
+    [&robot_hardware](const std::string & name) -> const std::vector<std::string> & {
+      return robot_hardware.get_registered_joint_interface_names(name);
+    }, true);
+
+  std::vector<LinearMap::Row> state_rows;
+  std::vector<LinearMap::Row> command_rows;
+  for (const auto & spec : transmissions_) {
+    for (const auto & name : spec.actuator_names) {
+      if (!actuators.has_handle(name)) {
+        RCLCPP_ERROR(
+          rclcpp::get_logger(kLoggerName), "transmission actuator '%s' is not registered",
+          name.c_str());
+        return hardware_interface::return_type::ERROR;
+      }
+    }
+    for (const auto & name : spec.joint_names) {
+      if (!joints.has_handle(name)) {
+        RCLCPP_ERROR(
+          rclcpp::get_logger(kLoggerName), "transmission joint '%s' is not registered",
+          name.c_str());
+        return hardware_interface::return_type::ERROR;
+      }
+    }
+
+    const auto & transmission = *spec.transmission;
+    const size_t actuator_count = transmission.num_actuators();
+    const size_t joint_count = transmission.num_joints();
+    const auto joint_offsets = transmission.get_joint_offsets();
+    for (const std::string interface_name : kMappedInterfaces) {
+      const bool is_effort = interface_name == "effort";
+      const bool is_position = interface_name == "position";
+      const std::string command_interface_name =
+        interface_name + hardware_interface::InterfaceValueArena::COMMAND_INTERFACE_SUFFIX;
+
+      // actuator states to joint states
+      const auto to_joint = is_effort ?
+        transmission.get_actuator_to_joint_effort_map() : transmission.get_actuator_to_joint_map();
+      for (size_t joint = 0; joint < joint_count; ++joint) {
+        LinearMap::Row row;
+        if (!joints.find(spec.joint_names[joint], interface_name, row.output)) {
+          continue;
+        }
+        row.constant = is_position ? joint_offsets[joint] : 0.0;
+        bool complete = true;
+        for (size_t actuator = 0; actuator < actuator_count && complete; ++actuator) {
+          const double coefficient = to_joint[joint * actuator_count + actuator];
+          size_t input;
+          if (coefficient == 0.0) {
+            continue;
+          }
+          complete = actuators.find(spec.actuator_names[actuator], interface_name, input);
+          row.terms.emplace_back(input, coefficient);
+        }
+        if (complete) {
+          state_rows.push_back(std::move(row));
+        }
+      }
+
+      // joint commands to actuator commands, the joint offsets are removed from the positions
+      const auto to_actuator = is_effort ?
+        transmission.get_joint_to_actuator_effort_map() :
+        transmission.get_joint_to_actuator_map();
+      for (size_t actuator = 0; actuator < actuator_count; ++actuator) {
+        LinearMap::Row row;
+        if (!published_actuators.find(
+            spec.actuator_names[actuator], command_interface_name, row.output))
+        {
+          continue;
+        }
+        row.constant = 0.0;
+        bool complete = true;
+        for (size_t joint = 0; joint < joint_count && complete; ++joint) {
+          const double coefficient = to_actuator[actuator * joint_count + joint];
+          size_t input;
+          if (coefficient == 0.0) {
+            continue;
+          }
+          complete =
+            published_joints.find(spec.joint_names[joint], command_interface_name, input);
+          row.terms.emplace_back(input, coefficient);
+          if (is_position) {
+            row.constant -= coefficient * joint_offsets[joint];
+          }
+        }
+        if (complete) {
+          command_rows.push_back(std::move(row));
+        }
+      }
+    }
+  }
+
+  state_map_.compile(state_rows);
+  command_map_.compile(command_rows);
+  robot_hardware_ = &robot_hardware;
+  return hardware_interface::return_type::OK;
+}
+
+bool TransmissionEngine::is_configured() const
+{
+  return robot_hardware_ != nullptr;
+}
+
+void TransmissionEngine::actuator_to_joint()
+{
+  if (robot_hardware_) {
+    state_map_.apply(
+      robot_hardware_->get_actuator_values().data(), robot_hardware_->get_joint_values().data());
+  }
+}
+
+void TransmissionEngine::joint_to_actuator()
+{
+  if (robot_hardware_) {
+    command_map_.apply(
+      robot_hardware_->get_joint_values().data(), robot_hardware_->get_actuator_values().data());
+  }
+}
+
+size_t TransmissionEngine::get_state_map_size() const
+{
+  return state_map_.size;
+}
+
+size_t TransmissionEngine::get_command_map_size() const
+{
+  return command_map_.size;
+}
+
+void TransmissionEngine::LinearMap::compile(const std::vector<Row> & rows)
+{
+  std::map<size_t, std::vector<const Row *>> rows_by_term_count;
+  for (const auto & row : rows) {
+    rows_by_term_count[row.terms.size()].push_back(&row);
+  }
+
+  size = rows.size();
+  blocks.clear();
+  blocks.reserve(rows_by_term_count.size());
+  for (const auto & group : rows_by_term_count) {
+    const size_t row_count = group.second.size();
+    Block block;
+    block.term_count = group.first;
+    block.outputs.reserve(row_count);
+    block.constants.reserve(row_count);
+    block.inputs.resize(block.term_count * row_count);
+    block.coefficients.resize(block.term_count * row_count);
+    block.results.resize(row_count);
+    for (size_t i = 0; i < row_count; ++i) {
+      const auto & row = *group.second[i];
+      block.outputs.push_back(row.output);
+      block.constants.push_back(row.constant);
+      for (size_t term = 0; term < block.term_count; ++term) {
+        block.inputs[term * row_count + i] = row.terms[term].first;
+        block.coefficients[term * row_count + i] = row.terms[term].second;
+      }
+    }
+    blocks.push_back(std::move(block));
+  }
+}
+
+void TransmissionEngine::LinearMap::apply(const double * input, double * output)
+{
+  for (auto & block : blocks) {
+    const size_t row_count = block.outputs.size();
+    double * results = block.results.data();
+    const double * constants = block.constants.data();
+    for (size_t i = 0; i < row_count; ++i) {
+      results[i] = constants[i];
+    }
+    for (size_t term = 0; term < block.term_count; ++term) {
+      const size_t * inputs = block.inputs.data() + term * row_count;
+      const double * coefficients = block.coefficients.data() + term * row_count;
+      for (size_t i = 0; i < row_count; ++i) {
+        results[i] += coefficients[i] * input[inputs[i]];
+      }
+    }
+    const size_t * outputs = block.outputs.data();
+    for (size_t i = 0; i < row_count; ++i) {
+      output[outputs[i]] = results[i];
+    }
+  }
+}
+
+}  // namespace transmission_interface
@@ -15,6 +15,8 @@
 #include "transmission_interface/transmission_parser.hpp"
 #include "transmission_interface/transmission_info.hpp"
 
+#include <hardware_interface/tracing.hpp>
+#include <hardware_interface/urdf_document.hpp>
 #include <tinyxml2.h>
 #include <stdexcept>
 #include <string>
@@ -35,42 +37,42 @@ std::vector<TransmissionInfo> parse_transmissions_from_urdf(const std::string &
   if (urdf.empty()) {
     throw std::runtime_error("empty URDF passed in to transmission parser");
   }
+  return parse_transmissions_from_urdf(hardware_interface::URDFDocument(urdf));
+}
 
-  tinyxml2::XMLDocument doc;
-  if (!doc.Parse(urdf.c_str()) && doc.Error()) {
-    throw std::runtime_error("invalid URDF passed in to transmission parser");
-  }
-
+std::vector<TransmissionInfo> parse_transmissions_from_urdf(
+  const hardware_interface::URDFDocument & urdf)
+{
+  HARDWARE_INTERFACE_TRACE_SCOPE("parse_transmissions", "");
   std::vector<TransmissionInfo> transmissions;
+  transmissions.reserve(urdf.get_transmission_elements().size());
   // Find joints in transmission tags
-  const tinyxml2::XMLElement * root_it = doc.RootElement();
-  const tinyxml2::XMLElement * trans_it = root_it->FirstChildElement(kTransmissionTag);
-  while (trans_it) {
+  for (const auto * trans_it : urdf.get_transmission_elements()) {
     // Joint name
     auto joint_it = trans_it->FirstChildElement(kJointTag);
     if (!joint_it) {
       throw std::runtime_error("no joint child element found");
     }
 
-    const std::string joint_name = joint_it->Attribute("name");
-    if (joint_name.empty()) {
+    const char * joint_name = joint_it->Attribute("name");
+    if (!joint_name || !*joint_name) {
       throw std::runtime_error("no joint name attribute set");
     }
 
     const auto hardware_interface_it = joint_it->FirstChildElement(kHardwareInterfaceTag);
     if (!hardware_interface_it) {
       throw std::runtime_error(
-              "no hardware interface tag found under transmission joint" + joint_name);
+              "no hardware interface tag found under transmission joint" +
+              std::string(joint_name));
     }
 
-    const std::string interface_name = hardware_interface_it->GetText();
-    if (interface_name.empty()) {
-      throw std::runtime_error("no hardware interface specified in joint " + joint_name);
+    const char * interface_name = hardware_interface_it->GetText();
+    if (!interface_name || !*interface_name) {
+      throw std::runtime_error(
+              "no hardware interface specified in joint " + std::string(joint_name));
     }
 
     transmissions.push_back({joint_name, interface_name});
-
-    trans_it = trans_it->NextSiblingElement(kTransmissionTag);
   }
 
   return transmissions;
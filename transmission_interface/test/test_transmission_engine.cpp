@@ -0,0 +1,269 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "hardware_interface/robot_hardware.hpp"
+#include "transmission_interface/differential_transmission.hpp"
+#include "transmission_interface/four_bar_linkage_transmission.hpp"
+#include "transmission_interface/simple_transmission.hpp"
+#include "transmission_interface/transmission_engine.hpp"
+
+namespace hw = hardware_interface;
+using transmission_interface::DifferentialTransmission;
+using transmission_interface::FourBarLinkageTransmission;
+using transmission_interface::SimpleTransmission;
+using transmission_interface::TransmissionEngine;
+
+namespace
+{
+class DummyRobotHardware : public hw::RobotHardware
+{
+  hw::return_type init() override
+  {
+    return hw::return_type::OK;
+  }
+
+  hw::return_type read() override
+  {
+    return hw::return_type::OK;
+  }
+
+  hw::return_type write() override
+  {
+    return hw::return_type::OK;
+  }
+};
+
+const std::vector<std::string> kInterfaces = {
+  "position", "velocity", "effort", "position_command", "velocity_command", "effort_command"};
+}  // namespace
+
+class TestTransmissionEngine : public testing::Test
+{
+public:
+  TestTransmissionEngine()
+  {
+    for (const auto & name : {"motor1", "motor2", "motor3", "motor4", "motor5"}) {
+      for (const auto & interface : kInterfaces) {
+        robot_.register_actuator(name, interface, 0.0);
+      }
+    }
+    for (const auto & name : {"wheel", "wrist1", "wrist2", "finger1", "finger2"}) {
+      for (const auto & interface : kInterfaces) {
+        robot_.register_joint(name, interface, 0.0);
+      }
+    }
+  }
+
+protected:
+  double & actuator(const std::string & name, const std::string & interface)
+  {
+    return value(
+      robot_.get_actuator_values(), robot_.get_registered_actuator_names(), name,
+      robot_.get_registered_actuator_interface_names(name), interface);
+  }
+
+  double & joint(const std::string & name, const std::string & interface)
+  {
+    return value(
+      robot_.get_joint_values(), robot_.get_registered_joint_names(), name,
+      robot_.get_registered_joint_interface_names(name), interface);
+  }
+
+  /// Actuator value as read by the hardware, after publish_commands().
+  double & published_actuator(const std::string & name, const std::string & interface)
+  {
+    return value(
+      robot_.get_actuator_values(), robot_.get_registered_actuator_names(), name,
+      robot_.get_registered_actuator_interface_names(name), interface, true);
+  }
+
+  void add_transmissions()
+  {
+    ASSERT_EQ(
+      hw::return_type::OK,
+      engine_.add_transmission(
+        std::make_shared<SimpleTransmission>(-10.0, 0.5), {"motor1"}, {"wheel"}));
+    ASSERT_EQ(
+      hw::return_type::OK,
+      engine_.add_transmission(
+        std::make_shared<DifferentialTransmission>(
+          std::vector<double>{10.0, 20.0}, std::vector<double>{2.0, 4.0},
+          std::vector<double>{0.1, -0.2}),
+        {"motor2", "motor3"}, {"wrist1", "wrist2"}));
+    ASSERT_EQ(
+      hw::return_type::OK,
+      engine_.add_transmission(
+        std::make_shared<FourBarLinkageTransmission>(
+          std::vector<double>{5.0, -8.0}, std::vector<double>{1.5, 3.0}),
+        {"motor4", "motor5"}, {"finger1", "finger2"}));
+  }
+
+  DummyRobotHardware robot_;
+  TransmissionEngine engine_;
+
+private:
+  double & value(
+    hw::InterfaceValueArena & arena, const std::vector<std::string> & handle_names,
+    const std::string & name, const std::vector<std::string> & interface_names,
+    const std::string & interface, bool published = false)
+  {
+    const auto handle = std::find(handle_names.begin(), handle_names.end(), name);
+    const auto index = std::find(interface_names.begin(), interface_names.end(), interface);
+    if (published) {
+      return *arena.get_published_value_ptr(
+        handle - handle_names.begin(), index - interface_names.begin());
+    }
+    return arena.data()[
+      arena.get_offset(handle - handle_names.begin(), index - interface_names.begin())];
+  }
+};
+
+TEST_F(TestTransmissionEngine, requires_frozen_registration)
+{
+  add_transmissions();
+  EXPECT_EQ(hw::return_type::ERROR, engine_.configure(robot_));
+  EXPECT_FALSE(engine_.is_configured());
+
+  // propagating without a configuration is a no-op
+  ASSERT_EQ(hw::return_type::OK, robot_.freeze_registration());
+  actuator("motor1", "position") = 1.0;
+  engine_.actuator_to_joint();
+  engine_.joint_to_actuator();
+  EXPECT_EQ(0.0, joint("wheel", "position"));
+}
+
+TEST_F(TestTransmissionEngine, rejects_invalid_transmissions)
+{
+  auto simple = std::make_shared<SimpleTransmission>(2.0);
+  EXPECT_EQ(
+    hw::return_type::ERROR, engine_.add_transmission(simple, {"motor1", "motor2"}, {"wheel"}));
+  EXPECT_EQ(hw::return_type::ERROR, engine_.add_transmission(nullptr, {"motor1"}, {"wheel"}));
+
+  ASSERT_EQ(hw::return_type::OK, engine_.add_transmission(simple, {"motor1"}, {"unknown"}));
+  ASSERT_EQ(hw::return_type::OK, robot_.freeze_registration());
+  EXPECT_EQ(hw::return_type::ERROR, engine_.configure(robot_));
+
+  TransmissionEngine configured;
+  ASSERT_EQ(hw::return_type::OK, configured.add_transmission(simple, {"motor1"}, {"wheel"}));
+  ASSERT_EQ(hw::return_type::OK, configured.configure(robot_));
+  EXPECT_EQ(hw::return_type::ERROR, configured.add_transmission(simple, {"motor2"}, {"wrist1"}));
+}
+
+TEST_F(TestTransmissionEngine, matches_the_transmissions)
+{
+  add_transmissions();
+  ASSERT_EQ(hw::return_type::OK, robot_.freeze_registration());
+  ASSERT_EQ(hw::return_type::OK, engine_.configure(robot_));
+  ASSERT_TRUE(engine_.is_configured());
+  // 3 interfaces of 5 joints, in both directions
+  EXPECT_EQ(15u, engine_.get_state_map_size());
+  EXPECT_EQ(15u, engine_.get_command_map_size());
+
+  actuator("motor1", "position") = 2.0;
+  actuator("motor1", "velocity") = -3.0;
+  actuator("motor1", "effort") = 0.25;
+  actuator("motor2", "position") = 4.0;
+  actuator("motor3", "position") = 8.0;
+  actuator("motor2", "effort") = 1.0;
+  actuator("motor3", "effort") = 0.5;
+  actuator("motor4", "velocity") = 3.0;
+  actuator("motor5", "velocity") = 6.0;
+  engine_.actuator_to_joint();
+
+  EXPECT_DOUBLE_EQ(-0.2 + 0.5, joint("wheel", "position"));
+  EXPECT_DOUBLE_EQ(0.3, joint("wheel", "velocity"));
+  EXPECT_DOUBLE_EQ(-2.5, joint("wheel", "effort"));
+  EXPECT_DOUBLE_EQ(4.0 / 40.0 + 8.0 / 80.0 + 0.1, joint("wrist1", "position"));
+  EXPECT_DOUBLE_EQ(4.0 / 80.0 - 8.0 / 160.0 - 0.2, joint("wrist2", "position"));
+  EXPECT_DOUBLE_EQ(20.0 * 1.0 + 40.0 * 0.5, joint("wrist1", "effort"));
+  EXPECT_DOUBLE_EQ(40.0 * 1.0 - 80.0 * 0.5, joint("wrist2", "effort"));
+  EXPECT_DOUBLE_EQ(3.0 / 7.5, joint("finger1", "velocity"));
+  EXPECT_DOUBLE_EQ(-3.0 / 22.5 + 6.0 / -24.0, joint("finger2", "velocity"));
+
+  // commanding the joint states back gives the actuator states
+  for (const auto & name : robot_.get_registered_joint_names()) {
+    for (const std::string interface : {"position", "velocity", "effort"}) {
+      joint(name, interface + "_command") = joint(name, interface);
+    }
+  }
+  robot_.publish_commands();
+  engine_.joint_to_actuator();
+  for (const auto & name : robot_.get_registered_actuator_names()) {
+    for (const std::string interface : {"position", "velocity", "effort"}) {
+      EXPECT_NEAR(
+        actuator(name, interface), published_actuator(name, interface + "_command"), 1e-12) <<
+        name << "/" << interface;
+    }
+  }
+}
+
+TEST_F(TestTransmissionEngine, maps_the_commands_published_in_the_cycle)
+{
+  ASSERT_EQ(
+    hw::return_type::OK,
+    engine_.add_transmission(std::make_shared<SimpleTransmission>(2.0), {"motor1"}, {"wheel"}));
+  ASSERT_EQ(hw::return_type::OK, robot_.freeze_registration());
+  ASSERT_EQ(hw::return_type::OK, engine_.configure(robot_));
+
+  // the control loop updates the controllers, publishes their commands then writes
+  joint("wheel", "position_command") = 1.5;
+  robot_.publish_commands();
+  engine_.joint_to_actuator();
+  EXPECT_DOUBLE_EQ(3.0, published_actuator("motor1", "position_command"));
+
+  // the commands of the next cycle are not seen before they are published
+  joint("wheel", "position_command") = 4.0;
+  engine_.joint_to_actuator();
+  EXPECT_DOUBLE_EQ(3.0, published_actuator("motor1", "position_command"));
+  robot_.publish_commands();
+  engine_.joint_to_actuator();
+  EXPECT_DOUBLE_EQ(8.0, published_actuator("motor1", "position_command"));
+}
+
+TEST_F(TestTransmissionEngine, skips_unregistered_values)
+{
+  DummyRobotHardware robot;
+  robot.register_actuator("motor1", "position", 1.0);
+  robot.register_actuator("motor2", "position", 3.0);
+  robot.register_actuator("motor1", "velocity", 1.0);
+  robot.register_joint("wrist1", "position", 0.0);
+  robot.register_joint("wrist2", "position", 0.0);
+  robot.register_joint("wrist1", "velocity", 0.0);
+  robot.register_joint("wrist2", "position_command", 0.0);
+  ASSERT_EQ(hw::return_type::OK, robot.freeze_registration());
+
+  ASSERT_EQ(
+    hw::return_type::OK,
+    engine_.add_transmission(
+      std::make_shared<DifferentialTransmission>(
+        std::vector<double>{1.0, 1.0}, std::vector<double>{1.0, 1.0}),
+      {"motor1", "motor2"}, {"wrist1", "wrist2"}));
+  ASSERT_EQ(hw::return_type::OK, engine_.configure(robot));
+  // the velocity of wrist1 needs the one of motor2, the actuators have no command
+  EXPECT_EQ(2u, engine_.get_state_map_size());
+  EXPECT_EQ(0u, engine_.get_command_map_size());
+
+  engine_.actuator_to_joint();
+  const double * joint_values = robot.get_joint_values().data();
+  EXPECT_DOUBLE_EQ(2.0, joint_values[robot.get_joint_values().get_offset(0, 0)]);
+  EXPECT_DOUBLE_EQ(-1.0, joint_values[robot.get_joint_values().get_offset(1, 0)]);
+  EXPECT_EQ(0.0, joint_values[robot.get_joint_values().get_offset(0, 1)]);
+}
@@ -410,3 +410,21 @@ TEST_F(TestTransmissionParser, wrong_urdf_throws_error)
 {
   ASSERT_THROW(parse_transmissions_from_urdf(wrong_urdf_xml_), std::runtime_error);
 }
+
+TEST_F(TestTransmissionParser, successfully_parse_shared_urdf_document)
+{
+  const hardware_interface::URDFDocument urdf(valid_urdf_xml_);
+  const auto transmissions = parse_transmissions_from_urdf(urdf);
+
+  ASSERT_THAT(transmissions, SizeIs(2));
+  EXPECT_EQ("rrbot_joint1", transmissions[0].joint_name);
+  EXPECT_EQ(hardware_interface::joint_control_type::POSITION, transmissions[0].joint_control_type);
+  EXPECT_EQ("rrbot_joint2", transmissions[1].joint_name);
+  EXPECT_EQ(hardware_interface::joint_control_type::VELOCITY, transmissions[1].joint_control_type);
+
+  // the joints of the transmissions are found in the same document
+  for (const auto & transmission : transmissions) {
+    EXPECT_NE(nullptr, urdf.find_joint_element(transmission.joint_name));
+  }
+  EXPECT_THAT(parse_transmissions_from_urdf(urdf), SizeIs(2));
+}
@@ -0,0 +1,126 @@
+// Copyright 2020 ros2_control Development Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "transmission_interface/differential_transmission.hpp"
+#include "transmission_interface/four_bar_linkage_transmission.hpp"
+#include "transmission_interface/simple_transmission.hpp"
+
+using transmission_interface::DifferentialTransmission;
+using transmission_interface::FourBarLinkageTransmission;
+using transmission_interface::SimpleTransmission;
+using transmission_interface::Transmission;
+using testing::DoubleNear;
+using testing::ElementsAre;
+
+namespace
+{
+/// Multiply a square row-major matrix by another.
+std::vector<double> multiply(const std::vector<double> & lhs, const std::vector<double> & rhs)
+{
+  const size_t n = static_cast<size_t>(std::sqrt(lhs.size()) + 0.5);
+  std::vector<double> product(n * n, 0.0);
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      for (size_t k = 0; k < n; ++k) {
+        product[i * n + j] += lhs[i * n + k] * rhs[k * n + j];
+      }
+    }
+  }
+  return product;
+}
+
+void expect_identity(const std::vector<double> & matrix)
+{
+  const size_t n = static_cast<size_t>(std::sqrt(matrix.size()) + 0.5);
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      EXPECT_NEAR(i == j ? 1.0 : 0.0, matrix[i * n + j], 1e-12) << i << ", " << j;
+    }
+  }
+}
+
+void expect_inverse_maps(const Transmission & transmission)
+{
+  expect_identity(
+    multiply(transmission.get_actuator_to_joint_map(), transmission.get_joint_to_actuator_map()));
+  expect_identity(
+    multiply(
+      transmission.get_actuator_to_joint_effort_map(),
+      transmission.get_joint_to_actuator_effort_map()));
+}
+}  // namespace
+
+TEST(TestTransmissions, simple_transmission)
+{
+  const SimpleTransmission transmission(10.0, 0.5);
+  EXPECT_EQ(1u, transmission.num_actuators());
+  EXPECT_EQ(1u, transmission.num_joints());
+  EXPECT_THAT(transmission.get_actuator_to_joint_map(), ElementsAre(0.1));
+  EXPECT_THAT(transmission.get_actuator_to_joint_effort_map(), ElementsAre(10.0));
+  EXPECT_THAT(transmission.get_joint_offsets(), ElementsAre(0.5));
+  expect_inverse_maps(transmission);
+
+  EXPECT_THROW(SimpleTransmission(0.0), std::invalid_argument);
+}
+
+TEST(TestTransmissions, differential_transmission)
+{
+  const DifferentialTransmission transmission({10.0, 20.0}, {2.0, 4.0});
+  EXPECT_EQ(2u, transmission.num_actuators());
+  EXPECT_EQ(2u, transmission.num_joints());
+  // the joint positions are the half sum and difference of the actuator positions
+  EXPECT_THAT(
+    transmission.get_actuator_to_joint_map(),
+    ElementsAre(
+      DoubleNear(1.0 / 40.0, 1e-15), DoubleNear(1.0 / 80.0, 1e-15),
+      DoubleNear(1.0 / 80.0, 1e-15), DoubleNear(-1.0 / 160.0, 1e-15)));
+  EXPECT_THAT(
+    transmission.get_actuator_to_joint_effort_map(), ElementsAre(20.0, 40.0, 40.0, -80.0));
+  expect_inverse_maps(transmission);
+
+  const DifferentialTransmission asymmetric({-3.0, 7.0}, {0.5, 1.5}, {0.1, -0.2});
+  expect_inverse_maps(asymmetric);
+  EXPECT_THAT(asymmetric.get_joint_offsets(), ElementsAre(0.1, -0.2));
+
+  EXPECT_THROW(DifferentialTransmission({1.0}, {1.0, 1.0}), std::invalid_argument);
+  EXPECT_THROW(DifferentialTransmission({1.0, 1.0}, {0.0, 1.0}), std::invalid_argument);
+  EXPECT_THROW(
+    DifferentialTransmission({1.0, 1.0}, {1.0, 1.0}, {0.0}), std::invalid_argument);
+}
+
+TEST(TestTransmissions, four_bar_linkage_transmission)
+{
+  const FourBarLinkageTransmission transmission({10.0, 20.0}, {2.0, 4.0});
+  EXPECT_EQ(2u, transmission.num_actuators());
+  EXPECT_EQ(2u, transmission.num_joints());
+  // the first joint only depends on the first actuator
+  const auto actuator_to_joint = transmission.get_actuator_to_joint_map();
+  EXPECT_DOUBLE_EQ(1.0 / 20.0, actuator_to_joint[0]);
+  EXPECT_EQ(0.0, actuator_to_joint[1]);
+  EXPECT_DOUBLE_EQ(-1.0 / 80.0, actuator_to_joint[2]);
+  EXPECT_DOUBLE_EQ(1.0 / 80.0, actuator_to_joint[3]);
+  expect_inverse_maps(transmission);
+
+  expect_inverse_maps(FourBarLinkageTransmission({-3.0, 7.0}, {0.5, 1.5}, {0.1, -0.2}));
+
+  EXPECT_THROW(FourBarLinkageTransmission({1.0, 0.0}, {1.0, 1.0}), std::invalid_argument);
+  EXPECT_THROW(FourBarLinkageTransmission({1.0, 1.0}, {1.0}), std::invalid_argument);
+}